@@ -44,6 +44,9 @@ LOCAL_SRC_FILES := \
 
 LOCAL_CFLAGS += -DGL_GLEXT_PROTOTYPES
 
+# vorbisfile is exported by the SDL2_mixer shared library
+LOCAL_CFLAGS += -DCU_AUDIO_STREAMING
+
 LOCAL_LDLIBS := 
 LOCAL_EXPORT_LDLIBS := -Wl,--undefined=Java_org_libsdl_app_SDLActivity_nativeInit -ldl -lGLESv1_CM -lGLESv2 -lGLESv3 -llog -landroid
 
@@ -72,7 +72,9 @@ b2BlockAllocator::b2BlockAllocator()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 
-	if (s_blockSizeLookupInitialized == false)
+	// Alteration: a static local is initialized exactly once, even if
+	// separate worlds are created in parallel
+	static const bool initialized = []()
 	{
 		int32 j = 0;
 		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
@@ -90,7 +92,9 @@ b2BlockAllocator::b2BlockAllocator()
 		}
 
 		s_blockSizeLookupInitialized = true;
-	}
+		return true;
+	}();
+	B2_NOT_USED(initialized);
 
 	// Alteration to make references safe
 	m_blockSizeLookup = &(s_blockSizeLookup[0]);
@@ -110,10 +110,10 @@ namespace cugl {
 class PathNode : public TexturedNode {
 #pragma mark Values
 protected:
-    /** An extruder for those incomplete polygons */
-    static PathExtruder _extruder;
-    /** An outliner for those incomplete polygons */
-    static PathOutliner _outliner;
+    /** An extruder for those incomplete polygons (one per thread) */
+    static thread_local PathExtruder _extruder;
+    /** An outliner for those incomplete polygons (one per thread) */
+    static thread_local PathOutliner _outliner;
 
     /** The extrusion polygon, when the stroke > 0 */
     Poly2 _extrusion;
@@ -161,8 +161,8 @@ public:
      * The polygon will be extruded using the given sequence of vertices. 
      * First it will traverse the vertices using either a closed or open
      * traveral.  Then it will extrude that polygon with the given joint
-     * and cap. PathNode objects share a single extruder, so this initializer 
-     * is not thread safe.
+     * and cap. Each thread has its own extruder, so the geometry for this
+     * initializer may be computed on a worker thread.
      *
      * @param vertices  The vertices to texture (expressed in image space)
      * @param stroke    The stroke width of the extruded path.
@@ -186,8 +186,8 @@ public:
      * The polygon will be extruded using the given polygon, assuming that it
      * is a (connected) path. It will extrude that polygon with the given joint
      * and cap.  It will assume the polygon is closed if the number of indices
-     * is twice the number of vertices. PathNode objects share a single extruder, 
-     * so this initializer is not thread safe.
+     * is twice the number of vertices. Each thread has its own extruder, so the
+     * geometry for this initializer may be computed on a worker thread.
      *
      * @param poly      The polygon to texture (expressed in image space)
      * @param stroke    The stroke width of the extruded path.
@@ -219,8 +219,8 @@ public:
      * The polygon will be extruded using the given sequence of vertices.
      * First it will traverse the vertices using either a closed or open
      * traveral.  Then it will extrude that polygon with the given joint
-     * and cap. PathNode objects share a single extruder, so this constructor
-     * is not thread safe.
+     * and cap. Each thread has its own extruder, so the geometry for this
+     * constructor may be computed on a worker thread.
      *
      * @param vertices  The vertices to texture (expressed in image space)
      * @param stroke    The stroke width of the extruded path.
@@ -243,8 +243,8 @@ public:
      * The polygon will be extruded using the given polygon, assuming that it
      * is a (connected) path. It will extrude that polygon with the given joint
      * and cap.  It will assume the polygon is closed if the number of indices
-     * is twice the number of vertices. PathNode objects share a single extruder, 
-     * so this constructor is not thread safe.
+     * is twice the number of vertices. Each thread has its own extruder, so the
+     * geometry for this constructor may be computed on a worker thread.
      *
      * @param poly      The polygon to texture (expressed in image space)
      * @param stroke    The stroke width of the extruded path.
@@ -265,8 +265,9 @@ public:
      *
      * The rectangle will be converted into a Poly2, using the standard outline.
      * This is the same as passing Poly2(rect,false).  The traversal will be
-     * CLOSED. It will then be extruded with the current joint and cap. PathNode
-     * objects share a single extruder, so this constructor is not thread safe.
+     * CLOSED. It will then be extruded with the current joint and cap. Each
+     * thread has its own extruder, so the geometry for this constructor may be
+     * computed on a worker thread.
      *
      * @param rect      The rectangle for to texture.
      * @param stroke    The stroke width of the extruded path.
@@ -285,8 +286,8 @@ public:
     /**
      * Returns a path node that is a line from origin to destination.
      *
-     * The path will be OPEN. PathNode objects share a single extruder, so this
-     * constructor is not thread safe.
+     * The path will be OPEN. Each thread has its own extruder, so the geometry
+     * for this constructor may be computed on a worker thread.
      *
      * @param origin    The line origin
      * @param dest      The line destination
@@ -307,8 +308,8 @@ public:
      * Returns a path node that is an ellipse with given the center and dimensions.
      *
      * The path node will draw around the boundary of the ellipse, and will be
-     * CLOSED. PathNode objects share a single extruder, so this constructor is 
-     * not thread safe.
+     * CLOSED. Each thread has its own extruder, so the geometry for this
+     * constructor may be computed on a worker thread.
      *
      * @param   center      The ellipse center point
      * @param   size        The size of the ellipse
@@ -406,8 +407,9 @@ public:
      *
      * The polygon will be extruded using the given sequence of vertices.
      * First it will traverse the vertices using the current traversal. Then
-     * it will extrude that polygon with the current joint and cap. PathNode 
-     * objects share a single extruder, so this method is not thread safe.
+     * it will extrude that polygon with the current joint and cap. Each thread
+     * has its own extruder, so the geometry for this method may be computed on
+     * a worker thread.
      *
      * @param vertices  The vertices to texture
      */
@@ -418,8 +420,8 @@ public:
      *
      * This method will extrude that polygon with the current joint and cap.
      * The polygon is assumed to be closed if the number of indices is twice
-     * the number of vertices. PathNode objects share a single extruder, so
-     * this method is not thread safe.
+     * the number of vertices. Each thread has its own extruder, so the geometry
+     * for this method may be computed on a worker thread.
      *
      * @param poly  The polygon to texture
      */
@@ -430,8 +432,8 @@ public:
      *
      * The rectangle will be converted into a Poly2, using the standard outline.
      * This is the same as passing Poly2(rect,false). It will then be extruded 
-     * with the current joint and cap. PathNode objects share a single extruder,
-     * so this method is not thread safe.
+     * with the current joint and cap. Each thread has its own extruder, so the
+     * geometry for this method may be computed on a worker thread.
      *
      * @param rect  The rectangle to texture
      */
@@ -79,8 +79,8 @@ namespace cugl {
 class PolygonNode : public TexturedNode {
 #pragma mark Values
 protected:
-    /** A triangulator for those incomplete polygons */
-    static SimpleTriangulator _triangulator;
+    /** A triangulator for those incomplete polygons (one per thread) */
+    static thread_local SimpleTriangulator _triangulator;
 
 public:
 #pragma mark -
@@ -131,8 +131,8 @@ public:
      * color.
      *
      * The polygon will be triangulated using the rules of SimpleTriangulator.
-     * All PolygonNode objects share a single triangulator, so this allocator is
-     * not thread safe.
+     * Each thread has its own triangulator, so the geometry for this allocator
+     * may be computed on a worker thread.
      *
      * @param vertices  The vertices to texture (expressed in image space)
      *
@@ -197,8 +197,8 @@ public:
      * Returns a textured polygon from the image filename and the given vertices.
      *
      * The polygon will be triangulated using the rules of SimpleTriangulator.
-     * All PolygonNode objects share a single triangulator, so this allocator is
-     * not thread safe.
+     * Each thread has its own triangulator, so the geometry for this allocator
+     * may be computed on a worker thread.
      *
      * @param filename  A path to image file, e.g., "scene1/earthtile.png"
      * @param vertices  The vertices to texture (expressed in image space)
@@ -259,8 +259,8 @@ public:
      * Returns a textured polygon from a Texture object and the given vertices.
      *
      * The polygon will be triangulated using the rules of SimpleTriangulator.
-     * All PolygonNode objects share a single triangulator, so this method is
-     * not thread safe.
+     * Each thread has its own triangulator, so the geometry for this method may
+     * be computed on a worker thread.
      *
      * @param texture   A shared pointer to a Texture object.
      * @param vertices  The vertices to texture (expressed in image space)
@@ -309,8 +309,8 @@ public:
      * Sets the polgon to the vertices expressed in texture space.
      *
      * The polygon will be triangulated using the rules of SimpleTriangulator.
-     * All PolygonNode objects share a single triangulator, so this method is
-     * not thread safe.
+     * Each thread has its own triangulator, so the geometry for this method may
+     * be computed on a worker thread.
      *
      * @param vertices  The vertices to texture
      */
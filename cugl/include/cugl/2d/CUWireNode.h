@@ -107,8 +107,8 @@ namespace cugl {
 class WireNode : public TexturedNode {
 #pragma mark Values
 protected:
-    /** An outliner for those incomplete polygons */
-    static PathOutliner _outliner;
+    /** An outliner for those incomplete polygons (one per thread) */
+    static thread_local PathOutliner _outliner;
     
     /** The current (known) traversal of this wireframe */
     PathTraversal _traversal;
@@ -146,8 +146,8 @@ public:
      * color.
      *
      * The polygon will be outlined using the given traversal in PathOutliner.
-     * WireNode objects share a single path outliner, so this initializer is
-     * not thread safe.
+     * Each thread has its own path outliner, so the geometry for this
+     * initializer may be computed on a worker thread.
      *
      * @param vertices  The vertices to texture (expressed in image space)
      * @param traversal The path traversal for index generation
@@ -198,8 +198,8 @@ public:
      *
      * The polygon will be outlined using a CLOSED traversal in PathOutliner.
      * To create a different traversal, use the alternate allocWithVertices()
-     * constructor. All WireNode objects share a single path outliner, so this
-     * method is not thread safe.
+     * constructor. Each thread has its own path outliner, so the geometry for
+     * this method may be computed on a worker thread.
      *
      * @param vertices  The vertices forming the wireframe path
      *
@@ -214,8 +214,8 @@ public:
      * Returns a (closed) wireframe with the given vertices.
      *
      * The polygon will be outlined using the given traversal in PathOutliner.
-     * WireNode objects share a single path outliner, so this constructor is
-     * not thread safe.
+     * Each thread has its own path outliner, so the geometry for this
+     * constructor may be computed on a worker thread.
      *
      * @param vertices  The vertices forming the wireframe path
      * @param traversal The path traversal for index generation
@@ -294,8 +294,9 @@ public:
      * Sets the traversal of this path.
      *
      * If the traversal is different from the current known traversal, it will
-     * recompute the traveral using the PathOutliner. All WireNode objects share 
-     * a single path outliner, so this method is not thread safe.
+     * recompute the traveral using the PathOutliner. Each thread has its own
+     * path outliner, so the geometry for this method may be computed on a
+     * worker thread.
      *
      * @param traversal The new wireframe traversal
      */
@@ -316,8 +317,8 @@ public:
      *
      * The polygon will be outlined using a CLOSED traversal in PathOutliner.
      * To create a different traversal, use the alternate setPolygon()  method. 
-     * All WireNode objects share a single path outliner, so this method is not
-     * thread safe.
+     * Each thread has its own path outliner, so the geometry for this method
+     * may be computed on a worker thread.
      *
      * @param vertices  The vertices to draw
      */
@@ -327,8 +328,8 @@ public:
      * Sets the wireframe polgon to the vertices expressed in texture space.
      *
      * The polygon will be outlined using the given traversal in PathOutliner.
-     * All WireNode objects share a single path outliner, so this method is not
-     * thread safe.
+     * Each thread has its own path outliner, so the geometry for this method
+     * may be computed on a worker thread.
      *
      * @param vertices  The vertices to draw
      */
@@ -53,6 +53,9 @@
 #include <cugl/2d/CUWireNode.h>
 
 namespace cugl {
+
+// Forward declaration of the world class
+class ObstacleWorld;
     
 #pragma mark -
 #pragma mark Obstacle
@@ -124,6 +127,19 @@ private:
     /** Whether the object has changed shape and needs a new fixture */
     bool _dirty;
     
+    /// Track synchronization status (managed by ObstacleWorld)
+    /** The world that owns this obstacle (nullptr if not a top-level obstacle) */
+    ObstacleWorld* _owner;
+    /** The linked scene graph node, positioned by the world after each step */
+    std::shared_ptr<Node> _linked;
+    /** The world step at which this obstacle was last synchronized */
+    unsigned int _syncstep;
+    /** Whether this obstacle is queued for synchronization at the next step */
+    bool _syncwait;
+    
+    // The world accesses the synchronization state directly
+    friend class ObstacleWorld;
+    
 
 #pragma mark -
 #pragma mark Constructors
@@ -806,9 +822,29 @@ public:
      * collisions to complete before they are reset.  Shapes (and their properties)
      * are reset in the update method.
      *
+     * If the value is true, this obstacle will also be marked for
+     * synchronization, so that the shapes are rebuilt even if the body is
+     * asleep or static.
+     *
      * @param value  whether the shape information must be updated.
      */
-    void markDirty(bool value) { _dirty = value; }
+    void markDirty(bool value) {
+        _dirty = value;
+        if (value) { markSync(); }
+    }
+    
+    /**
+     * Marks this obstacle for synchronization at the next world update.
+     *
+     * An {@link ObstacleWorld} only synchronizes (e.g. calls {@link update})
+     * the obstacles whose bodies are awake.  Sleeping and static bodies are
+     * skipped.  If you change the state of such a body by hand, you should
+     * call this method so that its scene graph nodes are repositioned.  The
+     * setters for position and angle do this automatically.
+     *
+     * This method does nothing if the obstacle is not in a world.
+     */
+    void markSync();
     
 #pragma mark -
 #pragma mark Physics Methods
@@ -54,6 +54,10 @@ namespace cugl {
 
 // Forward declaration of the Obstacle class
 class Obstacle;
+// Forward declaration of the scene graph node
+class Node;
+// Forward declaration of the thread pool
+class ThreadPool;
 
 /** Default amount of time for a physics engine step. */
 #define DEFAULT_WORLD_STEP  1/60.0f
@@ -61,6 +65,88 @@ class Obstacle;
 #define DEFAULT_WORLD_VELOC 6
 /** Default number of position iterations for the constrain solvers */
 #define DEFAULT_WORLD_POSIT 2
+/** Default number of contact events buffered in a single step */
+#define DEFAULT_WORLD_EVENTS 256
+/** Default number of queries in a single parallel batch task */
+#define DEFAULT_WORLD_GRAIN 32
+
+
+#pragma mark -
+#pragma mark Contact Event
+/**
+ * This class/struct represents a contact recorded during a physics step.
+ *
+ * When contact buffering is active, an {@link ObstacleWorld} does not invoke
+ * any closures in the middle of a Box2D step. Instead, it records a flat
+ * array of these events, which is available after the call to update.  At
+ * that time it is safe to modify the world (e.g. add or remove obstacles).
+ *
+ * The class is intended to be used as a struct.  The Box2D contact itself is
+ * not stored, as it may be destroyed by the end of the step. The fixtures 
+ * are only valid until the next time an obstacle is removed from the world.
+ *
+ * Removing an obstacle between steps also ends its contacts.  These END
+ * events are held back and reported at the start of the next step.  As the
+ * fixtures no longer exist, both fixtures of these events are nullptr. The
+ * world keeps the removed obstacles alive until the step after that, so the
+ * obstacle pointers remain valid while the events are read.
+ */
+class ContactEvent {
+public:
+    /** The type of contact event */
+    enum class Type : int {
+        /** Two fixtures began to touch */
+        BEGIN,
+        /** Two fixtures ceased to touch */
+        END,
+        /** The solver finished with a touching contact (impulses are valid) */
+        SOLVE
+    };
+    
+    /** The event type */
+    Type type;
+    /** The obstacle attached to the first fixture (may be nullptr) */
+    Obstacle* obstacleA;
+    /** The obstacle attached to the second fixture (may be nullptr) */
+    Obstacle* obstacleB;
+    /** The first colliding fixture */
+    b2Fixture* fixtureA;
+    /** The second colliding fixture */
+    b2Fixture* fixtureB;
+    /** The number of manifold points (0 if the fixtures are not touching) */
+    int points;
+    /** The world normal pointing from A to B */
+    Vec2 normal;
+    /** The world contact points (only the first points values are valid) */
+    Vec2 point[b2_maxManifoldPoints];
+    /** The normal impulses at each point (only valid for SOLVE events) */
+    float normalImpulse[b2_maxManifoldPoints];
+    /** The tangent impulses at each point (only valid for SOLVE events) */
+    float tangentImpulse[b2_maxManifoldPoints];
+};
+
+
+#pragma mark -
+#pragma mark Raycast Hit
+/**
+ * This class/struct represents a single hit of a batched ray cast.
+ *
+ * The class is intended to be used as a struct.  If the ray did not hit
+ * anything, the fixture is nullptr and the fraction is 1.
+ */
+class RaycastHit {
+public:
+    /** The obstacle that was hit (may be nullptr for raw Box2D bodies) */
+    Obstacle* obstacle;
+    /** The fixture that was hit (nullptr if there was no hit) */
+    b2Fixture* fixture;
+    /** The point of initial intersection */
+    Vec2 point;
+    /** The normal vector at the point of intersection */
+    Vec2 normal;
+    /** The fraction along the ray of the intersection */
+    float fraction;
+};
 
 
 #pragma mark -
@@ -95,6 +181,46 @@ protected:
     /** The list of objects in this world */
     std::vector<std::shared_ptr<Obstacle>> _objects;
     
+    /** Whether to skip sleeping and static obstacles when synchronizing */
+    bool _sleepsync;
+    /** The number of steps taken so far (used to stamp synchronized obstacles) */
+    unsigned int _stepcount;
+    /** The obstacles whose bodies were awake after the last step */
+    std::vector<Obstacle*> _awake;
+    /** The complex obstacles, which are synchronized every step */
+    std::vector<Obstacle*> _complex;
+    /** The obstacles marked for synchronization regardless of sleep state */
+    std::vector<Obstacle*> _pending;
+    /** The obstacles to synchronize in the current step (scratch buffer) */
+    std::vector<Obstacle*> _synclist;
+    /** The number of obstacles synchronized in the last step */
+    size_t _syncount;
+    /** The number of awake obstacles in the last step */
+    size_t _awakecount;
+    /** The number of obstacles skipped in the last step */
+    size_t _skipcount;
+    /** The scale from physics coordinates to the linked scene graph nodes */
+    Vec2 _drawscale;
+    
+    /** The thread pool for parallel batched queries (may be nullptr) */
+    std::shared_ptr<ThreadPool> _pool;
+    /** The number of queries in a single parallel batch task */
+    size_t _grain;
+    
+    /** The bodies sorted by address, for indexing contacts in a snapshot */
+    std::vector<std::pair<b2Body*,Uint32>> _snapindex;
+    /** The bodies in world order, for restoring a snapshot */
+    std::vector<b2Body*> _snapbodies;
+    /** Whether each body changed since the base of a delta snapshot */
+    std::vector<Uint8> _snapchanged;
+    
+    /**
+     * Rebuilds the body index used by snapshots.
+     *
+     * Bodies are identified by their position in the Box2D body list.
+     */
+    void indexBodies();
+    
     /** The boundary of the world */
     Rect _bounds;
     
@@ -104,6 +230,71 @@ protected:
     bool _filters;
     /** Whether or not to activate the destruction listener */
     bool _destroy;
+    /** Whether or not to record contacts in the event buffer */
+    bool _buffered;
+    /** Whether or not to record SOLVE events in the event buffer */
+    bool _solveevents;
+    /** The collision categories to record in the event buffer */
+    uint16 _eventmask;
+    /** The contact events recorded in the last step */
+    std::vector<ContactEvent> _events;
+    /** The maximum number of contact events recorded in a single step */
+    size_t _eventcap;
+    /** The number of contact events dropped in the last step */
+    size_t _dropped;
+    /** The END events of contacts destroyed between steps */
+    std::vector<ContactEvent> _lateevents;
+    /** The number of events dropped between steps */
+    size_t _latedropped;
+    /** The obstacles removed since the last step (to keep late events valid) */
+    std::vector<std::shared_ptr<Obstacle>> _removed;
+    /** The obstacles removed before the last step (referenced by its events) */
+    std::vector<std::shared_ptr<Obstacle>> _retained;
+    
+    /**
+     * Records a contact in the event buffer.
+     *
+     * The event is ignored if neither fixture matches the event mask. If the
+     * buffer is full, the event is dropped and counted.
+     *
+     * Contacts reported outside of a step (e.g. when a body is destroyed)
+     * are recorded in a separate buffer, which is delivered with the events
+     * of the next step.  This keeps the current events stable while they are
+     * being processed.
+     *
+     * @param type      The event type
+     * @param contact   The Box2D contact
+     * @param impulse   The solver impulse (nullptr unless type is SOLVE)
+     */
+    void recordContact(ContactEvent::Type type, b2Contact* contact, const b2ContactImpulse* impulse);
+    
+    /**
+     * Resets the Box2D contact listener to agree with the active callbacks.
+     */
+    void resetContactListener();
+    
+    /**
+     * Adds the obstacle to the synchronization list for this step.
+     *
+     * The obstacle is stamped with the current step, so that it is only
+     * added once, no matter how many reasons it has to be synchronized.
+     *
+     * @param obj   The obstacle to synchronize
+     */
+    void collectSync(Obstacle* obj);
+    
+    /**
+     * Removes all references to the given obstacle from the synchronization lists.
+     *
+     * This method must be called before a world releases ownership of an 
+     * obstacle, as the synchronization lists only store weak references.
+     *
+     * @param obj   The obstacle to forget
+     */
+    void releaseSync(Obstacle* obj);
+    
+    // Obstacles queue themselves for synchronization
+    friend class Obstacle;
     
     
 #pragma mark -
@@ -316,10 +507,48 @@ public:
      * physics.  The primary method is the step() method in world.  This implementation
      * works for all applications and should not need to be overwritten.
      *
+     * After the step, the world synchronizes its obstacles. Unless sleep sync
+     * is disabled, only awake, dirty, and complex obstacles are synchronized.
+     * See {@link setSleepSync} for more information.
+     *
+     * This method is equivalent to calling {@link step} followed by
+     * {@link synchronize}.
+     *
      * @param dt Number of seconds since last animation frame
      */
     void update(float dt);
     
+    /**
+     * Advances the Box2D world without synchronizing the obstacles.
+     *
+     * This is the first half of {@link update}.  It clears the contact event
+     * buffer and steps the physics engine, but it does not call the update
+     * method of any obstacle, nor does it touch any linked scene graph node.
+     * The world is not ready to be drawn until {@link synchronize} is called.
+     *
+     * This method only touches the state of this world, so it is safe to step
+     * distinct worlds on different threads at the same time (see
+     * {@link WorldGroup}).  However, the collision, filter, and destruction
+     * callbacks are invoked on the thread that calls this method. Callbacks
+     * used this way must not access any state shared with other worlds.
+     *
+     * @param dt Number of seconds since last animation frame
+     */
+    void step(float dt);
+    
+    /**
+     * Synchronizes the obstacles with the Box2D world.
+     *
+     * This is the second half of {@link update}.  It calls the update method
+     * of every obstacle that needs it (see {@link setSleepSync}) and writes
+     * the position and angle of every linked scene graph node. Obstacle
+     * update methods may do arbitrary work, so this method should be called
+     * on the main thread.
+     *
+     * @param dt Number of seconds since last animation frame
+     */
+    void synchronize(float dt);
+    
     /**
      * Returns the bounds for the world controller.
      *
@@ -339,6 +568,116 @@ public:
     bool inBounds(Obstacle* obj);
     
     
+#pragma mark -
+#pragma mark Synchronization
+    /**
+     * Returns true if sleeping and static obstacles are skipped on update.
+     *
+     * After each physics step, the world synchronizes its obstacles, calling
+     * {@link Obstacle#update} and repositioning any linked scene graph nodes.
+     * If this value is true (the default), only obstacles whose bodies are 
+     * awake (or that have fallen asleep this step) are synchronized.  In
+     * addition, any obstacle that is dirty or has been marked with
+     * {@link Obstacle#markSync} is synchronized.  Complex obstacles are
+     * always synchronized.
+     *
+     * If this value is false, every obstacle is synchronized every step.
+     * This is only necessary if an obstacle listener must be called even
+     * when nothing has moved.
+     *
+     * @return true if sleeping and static obstacles are skipped on update.
+     */
+    bool isSleepSync() const { return _sleepsync; }
+    
+    /**
+     * Sets whether sleeping and static obstacles are skipped on update.
+     *
+     * After each physics step, the world synchronizes its obstacles, calling
+     * {@link Obstacle#update} and repositioning any linked scene graph nodes.
+     * If this value is true (the default), only obstacles whose bodies are
+     * awake (or that have fallen asleep this step) are synchronized.  In
+     * addition, any obstacle that is dirty or has been marked with
+     * {@link Obstacle#markSync} is synchronized.  Complex obstacles are
+     * always synchronized.
+     *
+     * If this value is false, every obstacle is synchronized every step.
+     * This is only necessary if an obstacle listener must be called even
+     * when nothing has moved.
+     *
+     * @param flag  whether sleeping and static obstacles are skipped on update.
+     */
+    void setSleepSync(bool flag) { _sleepsync = flag; }
+    
+    /**
+     * Returns the number of obstacles synchronized in the last update.
+     *
+     * This value only counts top-level obstacles (e.g. not the components of
+     * a complex obstacle).
+     *
+     * @return the number of obstacles synchronized in the last update.
+     */
+    size_t getSyncCount() const { return _syncount; }
+    
+    /**
+     * Returns the number of obstacles that were awake in the last update.
+     *
+     * This value only counts top-level obstacles with awake, non-static bodies.
+     * It does not include complex obstacles unless their root body is awake.
+     *
+     * @return the number of obstacles that were awake in the last update.
+     */
+    size_t getAwakeCount() const { return _awakecount; }
+    
+    /**
+     * Returns the number of obstacles skipped in the last update.
+     *
+     * These are the obstacles that were asleep or static, and so were not
+     * synchronized.
+     *
+     * @return the number of obstacles skipped in the last update.
+     */
+    size_t getSkipCount() const { return _skipcount; }
+    
+    /**
+     * Returns the scale from physics coordinates to linked scene graph nodes.
+     *
+     * The position of a linked node is the position of its obstacle times 
+     * this scale.  The default scale is (1,1).
+     *
+     * @return the scale from physics coordinates to linked scene graph nodes.
+     */
+    const Vec2& getDrawScale() const { return _drawscale; }
+    
+    /**
+     * Sets the scale from physics coordinates to linked scene graph nodes.
+     *
+     * The position of a linked node is the position of its obstacle times
+     * this scale.  The default scale is (1,1).  Changing the scale will
+     * immediately reposition all linked nodes.
+     *
+     * @param scale the scale from physics coordinates to linked scene graph nodes.
+     */
+    void setDrawScale(const Vec2& scale);
+    
+    /**
+     * Links a scene graph node to the given obstacle.
+     *
+     * A linked node is positioned and rotated by the world whenever the
+     * obstacle is synchronized.  This is done in a single batch after all
+     * obstacles are updated, which is much faster than repositioning nodes
+     * with an obstacle listener.  The node position is the obstacle position
+     * times the draw scale, and so the node should be anchored at its center.
+     *
+     * The obstacle must be in this world.  Each obstacle has at most one
+     * linked node; linking a new node replaces the previous one. Passing
+     * nullptr unlinks the obstacle.
+     *
+     * @param obj   The obstacle to link
+     * @param node  The scene graph node to position
+     */
+    void linkSceneNode(Obstacle* obj, const std::shared_ptr<Node>& node);
+    
+    
 #pragma mark -
 #pragma mark Object Management
     /**
@@ -374,7 +713,9 @@ public:
      *
      * Removing an obstacle does not automatically delete the obstacle itself.
      * However, this world releases ownership, which may lead to it being
-     * garbage collected.
+     * garbage collected.  If the contact buffer is active, this release is
+     * delayed until the end of the second step after the removal, so that
+     * the END events for the obstacle remain valid.
      *
      * param obj The obstacle to remove
      */
@@ -388,9 +729,16 @@ public:
      *
      * Removing an obstacle does not automatically delete the obstacle itself.
      * However, this world releases ownership, which may lead to it being
-     * garbage collected.
+     * garbage collected.  If the contact buffer is active, this release is
+     * delayed until the end of the second step after the removal, so that
+     * the END events for the obstacle remain valid.
      *
      * This method is the efficient, preferred way to remove objects.
+     *
+     * This method (like {@link addObstacle} and {@link removeObstacle}) is not
+     * thread-safe.  It must never be called while the world is stepping. When
+     * the world is part of a {@link WorldGroup}, call it on the main thread
+     * after the group update has returned.
      */
     void garbageCollect();
 
@@ -403,6 +751,72 @@ public:
     void clear();
 
     
+#pragma mark -
+#pragma mark State Snapshots
+    /**
+     * Stores the current simulation state in the given buffer.
+     *
+     * The snapshot is a compact binary record of every body in the world:
+     * its transform, its velocities, and whether it is awake.  It also
+     * records the target of every mouse joint, and the contact impulses 
+     * used by Box2D to warm start the solver. The contents of buffer are 
+     * replaced, but its capacity is reused, so repeated snapshots into the 
+     * same buffer do not allocate.
+     *
+     * A snapshot does not record the bodies themselves.  It can only be
+     * restored to this world (or an identical copy) with the same obstacles,
+     * added in the same order.  The data is in native byte order.
+     *
+     * Box2D does not expose the warm start impulses of joints or the sleep
+     * timers of bodies, so these are not recorded.  A restored simulation
+     * will not be bit-for-bit identical when joints are under load or when
+     * bodies are about to fall asleep.
+     *
+     * @param buffer    The buffer to store the snapshot
+     */
+    void snapshot(std::vector<Uint8>& buffer);
+    
+    /**
+     * Stores the changes to the simulation state since base in the given buffer.
+     *
+     * The base must be a full snapshot of this world (e.g. one created by
+     * {@link snapshot(std::vector<Uint8>&)}).  The delta only stores those
+     * bodies whose state differs from the base, and the contacts that touch
+     * one of those bodies.  Mostly sleeping worlds produce very small deltas.
+     *
+     * To restore a delta snapshot, you must first restore the base (unless
+     * the world is already in that state).  If the base is not compatible
+     * with this world, this method stores a full snapshot instead.
+     *
+     * @param buffer    The buffer to store the snapshot
+     * @param base      The full snapshot to compare against
+     */
+    void snapshot(std::vector<Uint8>& buffer, const std::vector<Uint8>& base);
+    
+    /**
+     * Restores the simulation state from the given snapshot.
+     *
+     * The snapshot may be either a full or a delta snapshot.  A delta only
+     * restores the bodies that changed, and so the world should be in the
+     * state of the base snapshot beforehand.
+     *
+     * Contact impulses are only restored for contacts that currently exist
+     * in the world.  When restoring a full snapshot, any contact that is not
+     * in the snapshot has its impulses cleared, so that it is treated as a
+     * new contact by the solver.  All restored obstacles are marked for 
+     * synchronization at the next update.
+     *
+     * This method returns false (and does nothing) if the snapshot does not
+     * match the bodies and joints in this world, or if any of its records are
+     * truncated or out of range.
+     *
+     * @param buffer    The snapshot to restore
+     *
+     * @return true if the snapshot was restored
+     */
+    bool restore(const std::vector<Uint8>& buffer);
+    
+    
 #pragma mark -
 #pragma mark Collision Callback Functions
     /**
@@ -411,6 +825,12 @@ public:
      * If flag is false, then the collision callbacks (even if defined) will be ignored.
      * Otherwise, the callbacks will be executed (on collision) if they are defined.
      *
+     * The callbacks are invoked during the physics step, on the thread that
+     * called {@link step}.  For a world stepped in a {@link WorldGroup}, this
+     * is a worker thread, and the callbacks must not touch shared state.  In
+     * that case, the contact event buffer is the safer alternative, as its
+     * events are read on the main thread once the step is complete.
+     *
      * @param  flag whether to activate the collision callbacks.
      */
     void activateCollisionCallbacks(bool flag);
@@ -496,7 +916,10 @@ public:
      * @param  contact  the contact information
      */
     void BeginContact(b2Contact* contact) override {
-        if (onBeginContact != nullptr) {
+        if (_buffered) {
+            recordContact(ContactEvent::Type::BEGIN,contact,nullptr);
+        }
+        if (_collide && onBeginContact != nullptr) {
             onBeginContact(contact);
         }
     }
@@ -510,7 +933,10 @@ public:
      * @param  contact  the contact information
      */
     void EndContact(b2Contact* contact) override {
-        if (onEndContact != nullptr) {
+        if (_buffered) {
+            recordContact(ContactEvent::Type::END,contact,nullptr);
+        }
+        if (_collide && onEndContact != nullptr) {
             onEndContact(contact);
         }
     }
@@ -537,7 +963,7 @@ public:
      * @param  oldManifold  the contact manifold last iteration
      */
     void PreSolve(b2Contact* contact, const b2Manifold* oldManifold) override {
-        if (beforeSolve != nullptr) {
+        if (_collide && beforeSolve != nullptr) {
             beforeSolve(contact,oldManifold);
         }
     }
@@ -560,12 +986,137 @@ public:
      * @param  impulse  the impulse produced by the solver
      */
     void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override {
-        if (afterSolve != nullptr) {
+        if (_buffered && _solveevents) {
+            recordContact(ContactEvent::Type::SOLVE,contact,impulse);
+        }
+        if (_collide && afterSolve != nullptr) {
             afterSolve(contact,impulse);
         }
     }
 
     
+#pragma mark -
+#pragma mark Contact Buffering
+    /**
+     * Activates the contact event buffer.
+     *
+     * If flag is true, the world records every begin and end contact during
+     * a step into a flat, preallocated buffer of {@link ContactEvent} values.
+     * This buffer is cleared at the start of each call to {@link update}, and
+     * may be read with {@link getContactEvents} once update returns.  Unlike
+     * the collision callbacks, it is safe to modify the world while processing
+     * these events.  Removing an obstacle ends its contacts, but the END events
+     * are not added to the current buffer.  They are reported (with nullptr
+     * fixtures) at the start of the next step.
+     *
+     * Contact buffering is independent of the collision callbacks.  If both
+     * are active, the callbacks are invoked and the events are recorded.
+     *
+     * @param flag  whether to activate the contact event buffer.
+     */
+    void activateContactBuffer(bool flag);
+    
+    /**
+     * Returns true if the contact event buffer is active
+     *
+     * If this value is true, the world records every begin and end contact
+     * during a step into a flat, preallocated buffer of {@link ContactEvent}
+     * values.  See {@link activateContactBuffer} for more information.
+     *
+     * @return true if the contact event buffer is active
+     */
+    bool enabledContactBuffer() const { return _buffered; }
+    
+    /**
+     * Returns true if the contact event buffer records solver results.
+     *
+     * If this value is true, the buffer also records a SOLVE event (with the
+     * contact impulses) each time the solver finishes with a touching contact.
+     * As this can happen several times per step for the same contact, this
+     * value is false by default.
+     *
+     * @return true if the contact event buffer records solver results.
+     */
+    bool isBufferingSolves() const { return _solveevents; }
+    
+    /**
+     * Sets whether the contact event buffer records solver results.
+     *
+     * If this value is true, the buffer also records a SOLVE event (with the
+     * contact impulses) each time the solver finishes with a touching contact.
+     * As this can happen several times per step for the same contact, this
+     * value is false by default.
+     *
+     * @param flag  whether the contact event buffer records solver results.
+     */
+    void setBufferingSolves(bool flag);
+    
+    /**
+     * Returns the collision categories recorded in the event buffer.
+     *
+     * A contact is only recorded if the category bits of at least one of its
+     * fixtures intersect this mask.  By default, all categories are recorded.
+     *
+     * @return the collision categories recorded in the event buffer.
+     */
+    uint16 getContactEventMask() const { return _eventmask; }
+    
+    /**
+     * Sets the collision categories recorded in the event buffer.
+     *
+     * A contact is only recorded if the category bits of at least one of its
+     * fixtures intersect this mask.  By default, all categories are recorded.
+     * Use this to keep the buffer small when only a few fixture types (e.g.
+     * the player or projectiles) are of interest.
+     *
+     * @param mask  the collision categories recorded in the event buffer.
+     */
+    void setContactEventMask(uint16 mask) { _eventmask = mask; }
+    
+    /**
+     * Returns the maximum number of events recorded in a single step.
+     *
+     * The event buffer is preallocated to this size, and never grows during
+     * a step.  Any events past this capacity are dropped.
+     *
+     * @return the maximum number of events recorded in a single step.
+     */
+    size_t getContactEventCapacity() const { return _eventcap; }
+    
+    /**
+     * Sets the maximum number of events recorded in a single step.
+     *
+     * The event buffer is preallocated to this size, and never grows during
+     * a step.  Any events past this capacity are dropped.  This method should
+     * not be called during a step.
+     *
+     * @param capacity  the maximum number of events recorded in a single step.
+     */
+    void setContactEventCapacity(size_t capacity);
+    
+    /**
+     * Returns the contact events recorded in the last step.
+     *
+     * These events are in the order that Box2D reported them.  The buffer is
+     * valid until the next call to {@link update}.  It begins with the END
+     * events of any obstacles removed since the previous step.
+     *
+     * @return the contact events recorded in the last step.
+     */
+    const std::vector<ContactEvent>& getContactEvents() const { return _events; }
+    
+    /**
+     * Returns the number of contact events dropped in the last step.
+     *
+     * Events are dropped when the buffer exceeds its capacity.  If this value
+     * is nonzero, you should increase the capacity with 
+     * {@link setContactEventCapacity}.
+     *
+     * @return the number of contact events dropped in the last step.
+     */
+    size_t getDroppedContactEvents() const { return _dropped; }
+
+    
 #pragma mark -
 #pragma mark Filter Callback Functions
     /**
@@ -718,6 +1269,128 @@ public:
                                      const Vec2& normal, float fraction)> callback,
                  const Vec2& point1, const Vec2& point2) const;
     
+    
+#pragma mark -
+#pragma mark Batched Queries
+    /**
+     * Returns the thread pool for batched queries.
+     *
+     * If this value is not nullptr, large query batches are split between
+     * the threads of this pool.  This is safe because Box2D queries do not
+     * modify the world.  However, batched queries must not be run at the 
+     * same time as {@link update}, or any method that modifies the world.
+     *
+     * @return the thread pool for batched queries.
+     */
+    const std::shared_ptr<ThreadPool>& getThreadPool() const { return _pool; }
+    
+    /**
+     * Sets the thread pool for batched queries.
+     *
+     * If this value is not nullptr, large query batches are split between
+     * the threads of this pool.  This is safe because Box2D queries do not
+     * modify the world.  However, batched queries must not be run at the
+     * same time as {@link update}, or any method that modifies the world.
+     *
+     * @param pool  the thread pool for batched queries.
+     */
+    void setThreadPool(const std::shared_ptr<ThreadPool>& pool) { _pool = pool; }
+    
+    /**
+     * Returns the number of queries in a single parallel batch task.
+     *
+     * Batches smaller than this value are always run on the calling thread.
+     *
+     * @return the number of queries in a single parallel batch task.
+     */
+    size_t getQueryGrain() const { return _grain; }
+    
+    /**
+     * Sets the number of queries in a single parallel batch task.
+     *
+     * Batches smaller than this value are always run on the calling thread.
+     *
+     * @param grain the number of queries in a single parallel batch task.
+     */
+    void setQueryGrain(size_t grain) { _grain = grain; }
+    
+    /**
+     * Ray-casts the world for the closest hit along each of the given rays.
+     *
+     * The ray ii starts at origins[ii] and ends at targets[ii].  The closest
+     * hit for that ray is written to hits[ii].  If the ray hits nothing, the
+     * fixture of that hit is nullptr.  Only fixtures whose category bits
+     * intersect the mask are considered.  As with {@link rayCast}, this
+     * ignores shapes that contain the starting point.
+     *
+     * Unlike {@link rayCast}, this method does not allocate or invoke any 
+     * closures per query.  If there is a thread pool, the rays are processed
+     * in parallel.
+     *
+     * @param origins   The ray starting points
+     * @param targets   The ray ending points
+     * @param count     The number of rays
+     * @param hits      The buffer to store the hits (must have count elements)
+     * @param mask      The collision categories to consider
+     *
+     * @return the number of rays that hit a fixture
+     */
+    size_t rayCastClosest(const Vec2* origins, const Vec2* targets, size_t count,
+                          RaycastHit* hits, uint16 mask = 0xFFFF) const;
+    
+    /**
+     * Ray-casts the world for all hits along each of the given rays.
+     *
+     * The ray ii starts at origins[ii] and ends at targets[ii].  The hits of
+     * that ray are written to hits[ii*limit], ..., hits[ii*limit+counts[ii]-1]
+     * in no particular order.  Any hits past the limit are ignored.  Only 
+     * fixtures whose category bits intersect the mask are considered.  As
+     * with {@link rayCast}, this ignores shapes that contain the starting 
+     * point.
+     *
+     * Unlike {@link rayCast}, this method does not allocate or invoke any
+     * closures per query.  If there is a thread pool, the rays are processed
+     * in parallel.
+     *
+     * @param origins   The ray starting points
+     * @param targets   The ray ending points
+     * @param count     The number of rays
+     * @param hits      The buffer to store the hits (must have count*limit elements)
+     * @param limit     The maximum number of hits per ray
+     * @param counts    The buffer to store the hits per ray (must have count elements)
+     * @param mask      The collision categories to consider
+     *
+     * @return the total number of hits
+     */
+    size_t rayCastAll(const Vec2* origins, const Vec2* targets, size_t count,
+                      RaycastHit* hits, size_t limit, size_t* counts,
+                      uint16 mask = 0xFFFF) const;
+    
+    /**
+     * Queries the world for the fixtures that potentially overlap each box.
+     *
+     * The fixtures for boxes[ii] are written to fixtures[ii*limit], ...,
+     * fixtures[ii*limit+counts[ii]-1].  Any fixtures past the limit are
+     * ignored.  Only fixtures whose category bits intersect the mask are 
+     * considered.  As with {@link queryAABB}, this test is against the
+     * fixture bounding boxes, not the fixture shapes.
+     *
+     * Unlike {@link queryAABB}, this method does not allocate or invoke any
+     * closures per query.  If there is a thread pool, the boxes are processed
+     * in parallel.
+     *
+     * @param boxes     The axis-aligned bounding boxes
+     * @param count     The number of boxes
+     * @param fixtures  The buffer to store the fixtures (must have count*limit elements)
+     * @param limit     The maximum number of fixtures per box
+     * @param counts    The buffer to store the fixtures per box (must have count elements)
+     * @param mask      The collision categories to consider
+     *
+     * @return the total number of fixtures found
+     */
+    size_t queryAABBs(const Rect* boxes, size_t count, b2Fixture** fixtures,
+                      size_t limit, size_t* counts, uint16 mask = 0xFFFF) const;
+    
 };
 
 }
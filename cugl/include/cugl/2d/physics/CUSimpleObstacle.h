@@ -132,6 +132,7 @@ public:
     virtual void setBodyType(b2BodyType value) override {
         if (_body != nullptr) {
             _body->SetType(value);
+            markSync();
         } else {
             _bodyinfo.type = value;
         }
@@ -173,6 +174,7 @@ public:
     virtual void setPosition(float x, float y) override {
         if (_body != nullptr) {
             _body->SetTransform(b2Vec2(x,y),_body->GetAngle());
+            markSync();
         } else {
             _bodyinfo.position.Set(x,y);
         }
@@ -195,6 +197,7 @@ public:
     virtual void setX(float value) override {
         if (_body != nullptr) {
             _body->SetTransform(b2Vec2(value,_body->GetPosition().y),_body->GetAngle());
+            markSync();
         } else {
             _bodyinfo.position.x = value;
         }
@@ -217,6 +220,7 @@ public:
     virtual void setY(float value) override {
         if (_body != nullptr) {
             _body->SetTransform(b2Vec2(_body->GetPosition().y,value),_body->GetAngle());
+            markSync();
         } else {
             _bodyinfo.position.y = value;
         }
@@ -241,6 +245,7 @@ public:
     virtual void setAngle(float value) override {
         if (_body != nullptr) {
             _body->SetTransform(_body->GetPosition(),value);
+            markSync();
         } else {
             _bodyinfo.angle = value;
         }
@@ -0,0 +1,304 @@
+//
+//  CUWorldGroup.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for stepping several independent physics
+//  worlds at once.  Distinct Box2D worlds may be stepped in parallel on a
+//  thread pool, as our copy of Box2D keeps its global statistics in thread
+//  local storage and initializes its shared tables exactly once.  The group waits for
+//  every world to finish its step (a barrier) before synchronizing any of the
+//  obstacles.  That way, obstacle updates, scene graph nodes, and buffered
+//  contact events are all processed on the main thread.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+#ifndef __CU_PHYSICS_WORLD_GROUP_H__
+#define __CU_PHYSICS_WORLD_GROUP_H__
+
+#include <cugl/base/CUBase.h>
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace cugl {
+
+// Forward declaration of the physics world
+class ObstacleWorld;
+// Forward declaration of the thread pool
+class ThreadPool;
+
+#pragma mark -
+#pragma mark World Group
+/**
+ * Class to step a collection of independent physics worlds.
+ *
+ * Many games run several physics worlds at once: split-screen play, AI
+ * lookahead, or server-side rooms.  These worlds may be stepped at the same
+ * time on a {@link ThreadPool}.  The method
+ * {@link update} steps every world in parallel and then waits until all of
+ * them are done.  Only after this barrier does it synchronize the obstacles
+ * (see {@link ObstacleWorld#synchronize}) and invoke {@link onStep}, both
+ * on the calling thread.  Hence obstacle listeners, linked scene graph nodes,
+ * and contact event buffers may all be processed as if the worlds had been
+ * stepped serially.
+ *
+ * The Box2D callbacks of a world (collision, filter, and destruction) are
+ * different.  They are invoked during the step, and so run on a worker
+ * thread.  They are safe only if they touch no state outside of their own
+ * world.  In general, worlds in a group should use the contact event buffer
+ * (see {@link ObstacleWorld#activateContactBuffer}) instead of the collision
+ * callbacks.
+ *
+ * Modifying a world (adding or removing obstacles, calling garbageCollect)
+ * is not thread-safe.  These methods should only be called on the main
+ * thread, outside of a call to {@link update}.  In particular, this is the
+ * appropriate time to call {@link garbageCollect}.
+ *
+ * Stock Box2D is not safe for this.  It keeps global (non-atomic) counters
+ * for its distance and time of impact solvers, and it lazily initializes
+ * its contact and allocator tables on first use.  The copy of Box2D in CUGL
+ * makes the counters thread local and initializes the tables exactly once.
+ * The counters are then per thread, not per world, and so are only useful
+ * for profiling serial simulations.  If you replace Box2D, you should use
+ * {@link checkDeterminism} to verify that parallel steps match serial ones.
+ *
+ * A world should belong to at most one group.  If the group has no thread
+ * pool, the worlds are stepped serially, which is convenient for debugging.
+ */
+class WorldGroup {
+protected:
+    /** The worlds in this group, in the order they are synchronized */
+    std::vector<std::shared_ptr<ObstacleWorld>> _worlds;
+    /** The thread pool for stepping the worlds (may be nullptr) */
+    std::shared_ptr<ThreadPool> _pool;
+    /** Whether this group has been initialized */
+    bool _active;
+
+public:
+    /**
+     * Called once for each world after the group has stepped.
+     *
+     * This callback is invoked on the calling thread after the barrier, and
+     * after the world has been synchronized.  It is the appropriate place to
+     * process the contact events of the world.  The callback is invoked for
+     * each world in the order in which the worlds were added.
+     *
+     * This attribute is a dynamically assignable callback and may be changed
+     * at any given time (except during {@link update}).
+     *
+     * @param world The world that was just stepped
+     */
+    std::function<void(ObstacleWorld* world)> onStep;
+
+#pragma mark Constructors
+    /**
+     * Creates a new degenerate WorldGroup on the stack.
+     *
+     * The group must be initialized before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    WorldGroup();
+
+    /**
+     * Deletes this group, disposing all resources
+     */
+    ~WorldGroup() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this group.
+     *
+     * The worlds are released, but not disposed.  A disposed WorldGroup can
+     * be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes a group that steps its worlds on the given thread pool.
+     *
+     * If the thread pool is nullptr, the worlds are stepped serially on the
+     * calling thread.  The group does not take ownership of the pool, and
+     * the pool may be shared with other systems (such as the world queries).
+     * However, the pool should not be busy with long running tasks, as
+     * {@link update} blocks until all worlds have been stepped.
+     *
+     * @param pool  The thread pool to step the worlds
+     *
+     * @return true if the group is initialized properly, false otherwise.
+     */
+    bool init(const std::shared_ptr<ThreadPool>& pool);
+
+    /**
+     * Returns a newly allocated group that steps its worlds on the given pool.
+     *
+     * If the thread pool is nullptr, the worlds are stepped serially on the
+     * calling thread.  The group does not take ownership of the pool, and
+     * the pool may be shared with other systems (such as the world queries).
+     *
+     * @param pool  The thread pool to step the worlds
+     *
+     * @return a newly allocated group that steps its worlds on the given pool.
+     */
+    static std::shared_ptr<WorldGroup> alloc(const std::shared_ptr<ThreadPool>& pool) {
+        std::shared_ptr<WorldGroup> result = std::make_shared<WorldGroup>();
+        return (result->init(pool) ? result : nullptr);
+    }
+
+
+#pragma mark Worlds
+    /**
+     * Adds a world to this group.
+     *
+     * The world will be stepped on the next call to {@link update}.  Adding
+     * a world that is already in the group has no effect.
+     *
+     * This method may not be called during {@link update}.
+     *
+     * @param world The world to add
+     */
+    void addWorld(const std::shared_ptr<ObstacleWorld>& world);
+
+    /**
+     * Removes a world from this group.
+     *
+     * The world is released but not disposed.  It is safe to step it on
+     * its own after removal.
+     *
+     * This method may not be called during {@link update}.
+     *
+     * @param world The world to remove
+     */
+    void removeWorld(const std::shared_ptr<ObstacleWorld>& world);
+
+    /**
+     * Removes all worlds from this group.
+     *
+     * The worlds are released but not disposed.
+     */
+    void clear() { _worlds.clear(); }
+
+    /**
+     * Returns the worlds in this group.
+     *
+     * The worlds are listed in the order in which they are synchronized.
+     *
+     * @return the worlds in this group.
+     */
+    const std::vector<std::shared_ptr<ObstacleWorld>>& getWorlds() const { return _worlds; }
+
+    /**
+     * Returns the number of worlds in this group.
+     *
+     * @return the number of worlds in this group.
+     */
+    size_t size() const { return _worlds.size(); }
+
+    /**
+     * Returns the thread pool for stepping the worlds.
+     *
+     * If this value is nullptr, the worlds are stepped serially.
+     *
+     * @return the thread pool for stepping the worlds.
+     */
+    std::shared_ptr<ThreadPool> getThreadPool() const { return _pool; }
+
+    /**
+     * Sets the thread pool for stepping the worlds.
+     *
+     * If this value is nullptr, the worlds are stepped serially.
+     *
+     * This method may not be called during {@link update}.
+     *
+     * @param pool  The thread pool for stepping the worlds.
+     */
+    void setThreadPool(const std::shared_ptr<ThreadPool>& pool) { _pool = pool; }
+
+
+#pragma mark Physics Handling
+    /**
+     * Executes a single step of every world in this group.
+     *
+     * The worlds are stepped in parallel (see {@link ObstacleWorld#step}).
+     * This method blocks until every world has finished.  It then visits the
+     * worlds on the calling thread, in order, synchronizing the obstacles
+     * and invoking the {@link onStep} callback.
+     *
+     * The calling thread participates in the step, so this method is safe
+     * to call even if the pool has fewer threads than the group has worlds.
+     *
+     * @param dt Number of seconds since last animation frame
+     */
+    void update(float dt);
+
+    /**
+     * Removes all objects marked for removal in every world.
+     *
+     * This method must be called on the main thread, outside of a call to
+     * {@link update}.  See {@link ObstacleWorld#garbageCollect}.
+     */
+    void garbageCollect();
+
+#pragma mark Debugging
+    /**
+     * Returns true if stepping worlds in parallel matches stepping them serially.
+     *
+     * This method builds count pairs of worlds with the factory.  It steps
+     * one world of each pair in a group on the given pool, and the other
+     * world on its own.  After every step, it compares the full snapshots
+     * (see {@link ObstacleWorld#snapshot}) of each pair.  Any difference
+     * means that the worlds share state, and the method logs the first
+     * mismatch and returns false.
+     *
+     * The factory must build the same world (with the same obstacles added
+     * in the same order) each time it is called.  Only the worlds built by
+     * the factory are stepped, so this check may be run at any time.  But
+     * it is expensive, and is intended for debugging.
+     *
+     * @param pool      The thread pool to step the worlds
+     * @param factory   The function to build a world
+     * @param count     The number of worlds to step in parallel
+     * @param steps     The number of steps to compare
+     * @param dt        The time of each step in seconds
+     *
+     * @return true if stepping worlds in parallel matches stepping them serially.
+     */
+    static bool checkDeterminism(const std::shared_ptr<ThreadPool>& pool,
+                                 const std::function<std::shared_ptr<ObstacleWorld>()>& factory,
+                                 size_t count, Uint32 steps, float dt);
+
+};
+
+}
+
+#endif /* __CU_PHYSICS_WORLD_GROUP_H__ */
@@ -30,6 +30,7 @@
 
 #include "CUObstacle.h"
 #include "CUObstacleWorld.h"
+#include "CUWorldGroup.h"
 #include "CUSimpleObstacle.h"
 #include "CUComplexObstacle.h"
 #include "CUBoxObstacle.h"
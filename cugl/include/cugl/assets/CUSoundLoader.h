@@ -90,10 +90,11 @@ protected:
      * @param key       The key to access the asset after loading
      * @param sound     The sound asset partially loaded
      * @param volume    The volume to set for the sound asset
+     * @param priority  The playback priority for the sound asset
      * @param callback  An optional callback for asynchronous loading
      */
     void materialize(const std::string& key, const std::shared_ptr<Sound>& sound,
-                     float volume, LoaderCallback callback);
+                     float volume, int priority, LoaderCallback callback);
 
     /**
      * Internal method to support asset loading.
@@ -132,6 +133,10 @@ protected:
      *
      *      "file":         The path to the asset
      *      "volume":       This default sound volume (float)
+     *      "priority":     The sound playback priority (int)
+     *      "stream":       Whether to stream the sound from its file (bool)
+     *      "prebuffer":    The number of frames to decode before streaming (int)
+     *      "compressed":   Whether to keep the sound compressed until played (bool)
      *
      * @param json      The directory entry for the asset
      * @param callback  An optional callback for asynchronous loading
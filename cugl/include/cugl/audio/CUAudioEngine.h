@@ -40,11 +40,11 @@
 #define __CU_AUDIO_ENGINE_H__
 #include <cugl/audio/CUSound.h>
 #include <cugl/audio/CUMusic.h>
+#include <cugl/audio/CUAudioNode.h>
 #include <cugl/util/CUTimestamp.h>
 #include <functional>
 #include <unordered_map>
 #include <vector>
-#include <deque>
 
 /** The maximum number of buffer channels */
 #define AUDIO_INPUT_CHANNELS  24
@@ -52,6 +52,8 @@
 #define AUDIO_OUTPUT_CHANNELS 2
 /** The default sampling frequency */
 #define AUDIO_FREQUENCY 44100
+/** The default byte budget for decoded compressed sounds */
+#define AUDIO_CACHE_BUDGET  (4*1024*1024)
 
 /** Comment this out to use SDL sound on Mac/iOS (not recommended) */
 #if defined (__MACOSX__) || defined (__IPHONEOS__)
@@ -79,6 +81,19 @@ class MusicQueue;
  * a single asset) by a predefined key.  This cuts down on the overhead of 
  * managing the sound identifier. 
  *
+ * Alternatively, a sound effect may be played without a key, in which case
+ * {@link playEffect} returns an integer handle for the sound instance.  Handles
+ * are much cheaper than keys, and should be preferred for rapid-fire effects.
+ * A handle is never reused while its sound is active, and it becomes invalid
+ * once the sound completes.
+ *
+ * Every sound instance is a voice, and the engine keeps more voices than it
+ * has channels.  When all channels are in use, a new sound steals the channel
+ * of the least important voice, as determined by {@link Sound#getPriority}
+ * and then volume.  The voice that lost its channel becomes virtual.  A virtual
+ * voice is silent, but the engine continues to track its position.  It gets
+ * a channel back (at its current position) as soon as one is available.
+ *
  * You cannot create new instances of this class.  Instead, you should access 
  * the singleton through the three static methods: start(), stop() and get().
  *
@@ -115,12 +130,64 @@ private:
     
     /** The number of supported audio channels */
     unsigned int _capacity;
+    /** The number of audio frames in a mixer block */
+    unsigned int _blocksize;
     /** The channel objects for managing sounds */
     std::vector<std::shared_ptr<SoundChannel>> _channels;
-    /** Map keys to identifiers */
-    std::unordered_map<std::string,int> _effects;
-    /** The queue for subsequent sound loops */
-    std::deque<std::string> _equeue;
+    /** Map keys to voice handles */
+    std::unordered_map<std::string,Uint32> _effects;
+    
+    /**
+     * A single sound instance, which may or may not have a channel.
+     *
+     * A voice without a channel is virtual. The engine continues to track its
+     * position, but it is not heard.  The position of a virtual voice is the
+     * offset plus the time since the stamp, scaled by the playback rate (unless
+     * it is paused).
+     */
+    struct Voice {
+        /** The sound asset for this voice */
+        std::shared_ptr<Sound> sound;
+        /** The key for this voice (empty if it only has a handle) */
+        std::string key;
+        /** The handle for this voice (0 if it is unused) */
+        Uint32 handle;
+        /** The generation of this voice, used to make unique handles */
+        Uint32 serial;
+        /** The channel for this voice (-1 if it is virtual) */
+        Sint32 channel;
+        /** The playback priority for this voice */
+        int    priority;
+        /** The volume of this voice */
+        float  volume;
+        /** The playback rate of this voice */
+        float  rate;
+        /** Whether this voice is in a continuous loop */
+        bool   loop;
+        /** Whether this voice is paused */
+        bool   paused;
+        /** The position of a virtual voice at the time stamp, in seconds */
+        double offset;
+        /** The time stamp (in milliseconds) of a virtual voice offset */
+        Uint32 stamp;
+        /** The next voice in the free list (-1 if none) */
+        Sint32 next;
+    };
+    
+    /** The voice pool (both physical and virtual) */
+    std::vector<Voice> _voices;
+    /** The head of the voice free list (-1 if the pool is exhausted) */
+    Sint32 _freeVoice;
+    /** The voice handle for each channel (0 if the channel is free) */
+    std::vector<Uint32> _playing;
+    /** The stack of channels with no voice */
+    std::vector<Sint32> _freeChannels;
+    /** The number of virtual voices */
+    unsigned int _virtuals;
+    /** Whether the virtual voice sweep is scheduled */
+    bool   _sweeping;
+    /** The callback identifier for the virtual voice sweep */
+    Uint32 _sweeper;
     
     /** 
      * Callback function for background music
@@ -148,6 +215,19 @@ private:
      */
     std::function<void(const std::string& key , bool status)> _soundCB;
     
+    /**
+     * Callback function for the sound effect handles
+     *
+     * This function is called whenever a sound effect completes, whether it
+     * has a key or not. It is called whether or not the sound completed
+     * normally or if it was terminated manually.  However, the second
+     * parameter can be used to distinguish the two cases.
+     *
+     * @param handle    The handle identifying this sound effect
+     * @param status    True if the music terminated normally, false otherwise.
+     */
+    std::function<void(Uint32 handle, bool status)> _handleCB;
+    
 #pragma mark -
 #pragma mark Constructors (Private)
     /**
@@ -155,7 +235,8 @@ private:
      *
      * The engine must be initialized before is can be used.
      */
-    AudioEngine() : _capacity(0) {}
+    AudioEngine() : _capacity(0), _blocksize(0), _freeVoice(-1), _virtuals(0),
+    _sweeping(false), _sweeper(0) {}
     
     /**
      * Disposes of the singleton audio engine.
@@ -172,11 +253,16 @@ private:
      * the mixer graph for the sound effect channels.  The provided parameter
      * indicates the number of simultaneously supported sounds.
      *
+     * The block size is the number of audio frames mixed in a single pass of
+     * the audio callback.  Smaller blocks have less latency, but more CPU
+     * overhead.
+     *
      * @param channels  The maximum number of sound effect channels to support
+     * @param blocksize The number of audio frames in a mixer block
      *
      * @return true if the audio engine was successfully initialized.
      */
-    bool init(unsigned int channels=AUDIO_INPUT_CHANNELS);
+    bool init(unsigned int channels=AUDIO_INPUT_CHANNELS, unsigned int blocksize=AUDIO_BLOCK_SIZE);
     
     /**
      * Releases all resources for this singleton audio engine.
@@ -190,14 +276,155 @@ private:
 #pragma mark -
 #pragma mark Internal Helpers
     /**
-     * Purges this key from the list of active effects.
+     * Returns the active voice for the given handle.
+     *
+     * If the handle is stale (or 0), this method returns nullptr.
+     *
+     * @param handle    The voice handle
+     *
+     * @return the active voice for the given handle.
+     */
+    Voice* getVoice(Uint32 handle);
+    
+    /**
+     * Returns the active voice for the given handle.
+     *
+     * If the handle is stale (or 0), this method returns nullptr.
+     *
+     * @param handle    The voice handle
+     *
+     * @return the active voice for the given handle.
+     */
+    const Voice* getVoice(Uint32 handle) const;
+    
+    /**
+     * Returns a fresh voice from the free list, or nullptr if there is none.
+     *
+     * The voice has a new handle, but no other attributes are set.
+     *
+     * @return a fresh voice from the free list, or nullptr if there is none.
+     */
+    Voice* acquireVoice();
+    
+    /**
+     * Returns the voice to the free list, invalidating its handle.
+     *
+     * The voice must be virtual, so any channel must be released beforehand.
+     * This method does not call the effect listeners.
+     *
+     * @param voice     The voice to release
+     */
+    void releaseVoice(Voice* voice);
+    
+    /**
+     * Returns the voice channel to the free stack, making the voice virtual.
+     *
+     * This method does not stop the channel.  It is only bookkeeping.
+     *
+     * @param voice     The voice to update
+     */
+    void freeChannel(Voice* voice);
+    
+    /**
+     * Stops the voice channel, making the voice virtual.
+     *
+     * If the voice has not started yet (because its channel was still fading
+     * out a previous sound) it is removed from the channel.  Otherwise, the
+     * channel is stopped.
+     *
+     * @param voice     The voice to update
+     */
+    void unbindVoice(Voice* voice);
+    
+    /**
+     * Plays the voice on the given channel, starting at the given time.
+     *
+     * If the channel is still fading out a stopped sound, the voice will start
+     * in the next animation frame.
+     *
+     * @param voice     The voice to play
+     * @param id        The channel identifier
+     * @param time      The start position in seconds
+     */
+    void bindVoice(Voice* voice, Sint32 id, float time);
+    
+    /**
+     * Moves the voice to a virtual voice at its current position.
+     *
+     * @param voice     The voice to make virtual
+     */
+    void demoteVoice(Voice* voice);
+    
+    /**
+     * Attempts to give a virtual voice a channel.
+     *
+     * If there is no free channel, this method will steal the channel of the
+     * least important voice, provided that voice is less important than this
+     * one (or force is true).
+     *
+     * @param voice     The virtual voice
+     * @param force     Whether to steal a channel from a more important voice
+     *
+     * @return true if the voice now has a channel.
+     */
+    bool realizeVoice(Voice* voice, bool force);
+    
+    /**
+     * Assigns the free channels to the most important virtual voices.
+     */
+    void realizeVirtuals();
+    
+    /**
+     * Returns the least important voice with a channel.
+     *
+     * @return the least important voice with a channel.
+     */
+    Voice* findVictim();
+    
+    /**
+     * Returns the current position of the voice in seconds.
      *
-     * This method is not the same as stopping the channel. A channel may play a
-     * little longer after the key is removed.  This is simply a clean-up method.
+     * @param voice     The voice to query
      *
-     * @remove key  The key to purge from the list of active effects.
+     * @return the current position of the voice in seconds.
      */
-    void removeKey(std::string key);
+    float getVoiceTime(const Voice* voice) const;
+    
+    /**
+     * Returns true if voice a is more important than voice b
+     *
+     * A voice is more important if it has higher priority.  For voices of
+     * equal priority, the louder voice is more important.  Paused voices are
+     * considered silent.
+     *
+     * @param a     The first voice
+     * @param b     The second voice
+     *
+     * @return true if voice a is more important than voice b
+     */
+    static bool outranks(const Voice* a, const Voice* b);
+    
+    /**
+     * Ends all virtual voices that have played to completion.
+     *
+     * Virtual voices have no channel to report their completion. Hence this
+     * method is called periodically while there are virtual voices.
+     */
+    void sweepVoices();
+    
+    /**
+     * Schedules {@link sweepVoices} if there are any virtual voices.
+     */
+    void scheduleSweep();
+    
+    /**
+     * Calls the effect listeners for a completed voice.
+     *
+     * @param handle    The handle of the completed voice
+     * @param key       The key of the completed voice (may be empty)
+     * @param status    True if the voice terminated normally, false otherwise.
+     */
+    void notifyEffect(Uint32 handle, const std::string& key, bool status);
     
     
 #pragma mark -
@@ -224,11 +451,15 @@ public:
      * They depend on this engine for asset management.
      * 
      * The provided parameter indicates the number of simultaneously supported 
-     * sounds.
+     * sounds.  The block size is the number of audio frames mixed in a single
+     * pass of the audio callback.  Smaller blocks have less latency, but more
+     * CPU overhead.
      *
      * @param channels  The maximum number of sound effect channels to support
+     * @param blocksize The number of audio frames in a mixer block
      */
-    static void start(unsigned int channels=AUDIO_INPUT_CHANNELS);
+    static void start(unsigned int channels=AUDIO_INPUT_CHANNELS,
+                      unsigned int blocksize=AUDIO_BLOCK_SIZE);
     
     /**
      * Stops the singleton audio engine, releasing all resources.
@@ -241,6 +472,30 @@ public:
      * again. They depend on this engine for asset management.
      */
     static void stop();
+
+    /**
+     * Returns the number of audio frames in a mixer block.
+     *
+     * @return the number of audio frames in a mixer block.
+     */
+    unsigned int getBlockSize() const { return _blocksize; }
+    
+    /**
+     * Returns true if the number of audio frames in a mixer block was changed.
+     *
+     * Smaller blocks have less latency, but more CPU overhead.  Changing the
+     * block size reopens the audio device.  Sound effects keep playing across
+     * the change, but the music is stopped (and the music queue cleared).
+     * The diagnostic counters are reset by a successful change.
+     *
+     * Not all platforms support this method.  If the block size cannot be
+     * changed, the old block size is kept and this method returns false.
+     *
+     * @param blocksize The number of audio frames in a mixer block
+     *
+     * @return true if the number of audio frames in a mixer block was changed.
+     */
+    bool setBlockSize(unsigned int blocksize);
     
     
 #pragma mark -
@@ -561,18 +816,20 @@ public:
      * method will stop the existing sound and replace it with this one.  It 
      * is the responsibility of the application layer to manage key usage.
      *
-     * There are a limited number of channels available for sound effects.  If 
-     * you go over the number available, the sound will not play unless force 
-     * is true. In that case, it will grab the channel from the longest playing 
-     * sound effect.
+     * There are a limited number of channels available for sound effects.  If
+     * you go over the number available, the sound will steal the channel of
+     * the least important sound effect, provided that sound is less important
+     * than this one (or force is true). Otherwise, the sound will start as a
+     * virtual voice, and will be heard once a channel is available.  The sound
+     * only fails to play if there are no more voices.
      *
      * @param  key      The reference key for the sound effect
      * @param  sound    The sound effect to play
      * @param  loop     Whether to loop the sound effect continuously
      * @param  volume   The sound effect (< 0 to use asset default volume)
-     * @param  force    Whether to force another sound to stop.
+     * @param  force    Whether to force another sound to lose its channel.
      *
-     * @return true if there was an available channel for the sound
+     * @return true if there was an available voice for the sound
      */
     bool playEffect(const std::string& key, const std::shared_ptr<Sound>& sound,
                     bool loop=false, float volume=-1.0f, bool force=false);
@@ -589,17 +846,19 @@ public:
      * is the responsibility of the application layer to manage key usage.
      *
      * There are a limited number of channels available for sound effects.  If
-     * you go over the number available, the sound will not play unless force
-     * is true. In that case, it will grab the channel from the longest playing
-     * sound effect.
+     * you go over the number available, the sound will steal the channel of
+     * the least important sound effect, provided that sound is less important
+     * than this one (or force is true). Otherwise, the sound will start as a
+     * virtual voice, and will be heard once a channel is available.  The sound
+     * only fails to play if there are no more voices.
      *
      * @param  key      The reference key for the sound effect
      * @param  sound    The sound effect to play
      * @param  loop     Whether to loop the sound effect continuously
      * @param  volume   The sound effect (< 0 to use asset default volume)
-     * @param  force    Whether to force another sound to stop.
+     * @param  force    Whether to force another sound to lose its channel.
      *
-     * @return true if there was an available channel for the sound
+     * @return true if there was an available voice for the sound
      */
     bool playEffect(const char* key, const std::shared_ptr<Sound>& sound,
                     bool loop=false, float volume=-1.0f, bool force=false) {
@@ -611,13 +870,26 @@ public:
      *
      * There are a limited number of channels available for sound effects.  If
      * all channels are in use, this method will return 0. If you go over the 
-     * number available, you cannot play another sound unless you force it. In 
-     * that case, it will grab the channel from the longest playing sound effect.
+     * number available, a new sound will either steal a channel or start as
+     * a virtual voice.
      *
      * @return the number of channels available for sound effects.
      */
     size_t getAvailableChannels() const {
-        return (size_t)_capacity-_effects.size();
+        return _freeChannels.size();
+    }
+    
+    /**
+     * Returns the number of virtual sound effects.
+     *
+     * A virtual sound effect is one that lost its channel to a more important
+     * sound (or never had one).  It is not heard, but its position is tracked
+     * so that it can resume once a channel is available.
+     *
+     * @return the number of virtual sound effects.
+     */
+    size_t getVirtualEffects() const {
+        return _virtuals;
     }
     
     /**
@@ -786,6 +1058,60 @@ public:
         setEffectVolume(std::string(key),volume);
     }
 
+    /**
+     * Returns the current playback rate of the sound effect.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the current playback rate of the sound effect
+     */
+    float getEffectRate(const std::string& key) const;
+    
+    /**
+     * Returns the current playback rate of the sound effect.
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the current playback rate of the sound effect
+     */
+    float getEffectRate(const char* key) const {
+        return getEffectRate(std::string(key));
+    }
+    
+    /**
+     * Sets the current playback rate of the sound effect.
+     *
+     * A rate of 1 plays the sound at its natural speed and pitch.  A rate of 2
+     * plays it twice as fast (an octave higher), while a rate of 0.5 plays it
+     * at half speed (an octave lower).  The rate must be in the range [1/8, 8].
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  rate     the current playback rate of the sound effect
+     */
+    void setEffectRate(const std::string& key, float rate);
+    
+    /**
+     * Sets the current playback rate of the sound effect.
+     *
+     * A rate of 1 plays the sound at its natural speed and pitch.  A rate of 2
+     * plays it twice as fast (an octave higher), while a rate of 0.5 plays it
+     * at half speed (an octave lower).  The rate must be in the range [1/8, 8].
+     *
+     * If the key does not correspond to a channel, this method raises an error.
+     *
+     * @param  key      the reference key for the sound effect
+     * @param  rate     the current playback rate of the sound effect
+     */
+    void setEffectRate(const char* key, float rate) {
+        setEffectRate(std::string(key),rate);
+    }
+
     /**
      * Returns the duration of the sound effect, in seconds.
      *
@@ -1074,6 +1400,450 @@ public:
     void gcEffect(int id, bool status);
     
     
+#pragma mark -
+#pragma mark Sound Effect Handles
+    /**
+     * Plays the given sound effect, returning a handle for the sound instance.
+     *
+     * This method is the same as the keyed version of playEffect, except that
+     * the sound is identified by the returned handle instead.  Handles are
+     * much cheaper than keys, and are preferred for rapid-fire sound effects.
+     *
+     * There are a limited number of channels available for sound effects.  If
+     * you go over the number available, the sound will steal the channel of
+     * the least important sound effect, provided that sound is less important
+     * than this one (or force is true). Otherwise, the sound will start as a
+     * virtual voice, and will be heard once a channel is available.  The sound
+     * only fails to play if there are no more voices.
+     *
+     * @param  sound    The sound effect to play
+     * @param  loop     Whether to loop the sound effect continuously
+     * @param  volume   The sound effect (< 0 to use asset default volume)
+     * @param  force    Whether to force another sound to lose its channel.
+     *
+     * @return the handle for the sound effect (0 if it failed to play)
+     */
+    Uint32 playEffect(const std::shared_ptr<Sound>& sound, bool loop=false,
+                      float volume=-1.0f, bool force=false);
+    
+    /**
+     * Returns the handle for the sound effect with the given key.
+     *
+     * If there is no active sound effect for the given key, this method
+     * returns 0.
+     *
+     * @param  key      the reference key for the sound effect
+     *
+     * @return the handle for the sound effect with the given key.
+     */
+    Uint32 getEffectHandle(const std::string& key) const {
+        auto it = _effects.find(key);
+        return it == _effects.end() ? 0 : it->second;
+    }
+    
+    /**
+     * Returns the current state of the sound effect for the given handle.
+     *
+     * If there is no sound effect for the given handle, it returns
+     * State::INACTIVE.  Virtual sound effects are PLAYING (or PAUSED).
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the current state of the sound effect for the given handle.
+     */
+    State getEffectState(Uint32 handle) const;
+    
+    /**
+     * Returns true if the handle is associated with an active sound effect.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the handle is associated with an active sound effect.
+     */
+    bool isActiveEffect(Uint32 handle) const {
+        return getVoice(handle) != nullptr;
+    }
+    
+    /**
+     * Returns true if the sound effect for the given handle is virtual.
+     *
+     * A virtual sound effect is one that lost its channel to a more important
+     * sound (or never had one).  It is not heard, but its position is tracked
+     * so that it can resume once a channel is available.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the sound effect for the given handle is virtual.
+     */
+    bool isVirtualEffect(Uint32 handle) const {
+        const Voice* voice = getVoice(handle);
+        return voice != nullptr && voice->channel == -1;
+    }
+    
+    /**
+     * Returns the sound asset attached to the given handle.
+     *
+     * If there is no active sound effect for the given handle, this method
+     * returns nullptr.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the sound asset attached to the given handle.
+     */
+    const Sound* currentEffect(Uint32 handle) const {
+        const Voice* voice = getVoice(handle);
+        return voice == nullptr ? nullptr : voice->sound.get();
+    }
+    
+    /**
+     * Returns true if the sound effect is in a continuous loop.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return true if the sound effect is in a continuous loop.
+     */
+    bool isEffectLoop(Uint32 handle) const;
+    
+    /**
+     * Sets whether the sound effect is in a continuous loop.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  loop     whether the sound effect is in a continuous loop
+     */
+    void setEffectLoop(Uint32 handle, bool loop);
+    
+    /**
+     * Returns the current volume of the sound effect.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the current volume of the sound effect
+     */
+    float getEffectVolume(Uint32 handle) const;
+    
+    /**
+     * Sets the current volume of the sound effect.
+     *
+     * Raising the volume of a virtual sound effect may allow it to steal a
+     * channel from a less important sound.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  volume   the current volume of the sound effect
+     */
+    void setEffectVolume(Uint32 handle, float volume);
+    
+    /**
+     * Returns the current playback rate of the sound effect.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the current playback rate of the sound effect
+     */
+    float getEffectRate(Uint32 handle) const;
+    
+    /**
+     * Sets the current playback rate of the sound effect.
+     *
+     * A rate of 1 plays the sound at its natural speed and pitch.  A rate of 2
+     * plays it twice as fast (an octave higher), while a rate of 0.5 plays it
+     * at half speed (an octave lower).  The rate must be in the range [1/8, 8].
+     * Rates are ignored by the AVFoundation engine.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  rate     the current playback rate of the sound effect
+     */
+    void setEffectRate(Uint32 handle, float rate);
+    
+    /**
+     * Returns the duration of the sound effect, in seconds.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the duration of the sound effect, in seconds.
+     */
+    float getEffectDuration(Uint32 handle) const;
+    
+    /**
+     * Returns the elapsed time of the sound effect, in seconds
+     *
+     * The elapsed time is the current position of the sound from the beginning.
+     * It does not include any time spent on a continuous loop.  The position
+     * of a virtual sound effect is only accurate to the animation frame.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the elapsed time of the sound effect, in seconds
+     */
+    float getEffectElapsed(Uint32 handle) const;
+    
+    /**
+     * Returns the time remaining for the sound effect, in seconds
+     *
+     * The time remaining is just duration-elapsed.  This method does not take
+     * into account whether the sound is on a loop.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     *
+     * @return the time remaining for the sound effect, in seconds
+     */
+    float getEffectRemaining(Uint32 handle) const {
+        return getEffectDuration(handle)-getEffectElapsed(handle);
+    }
+    
+    /**
+     * Sets the elapsed time of the sound effect, in seconds
+     *
+     * The elapsed time is the current position of the sound from the beginning.
+     * It does not include any time spent on a continuous loop.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  time     the new position of the sound effect
+     */
+    void setEffectElapsed(Uint32 handle, float time);
+    
+    /**
+     * Sets the time remaining for the sound effect, in seconds
+     *
+     * The time remaining is just duration-elapsed.  This method does not take
+     * into account whether the sound is on a loop.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     * @param  time     the new time remaining for the sound effect
+     */
+    void setEffectRemaining(Uint32 handle, float time) {
+        setEffectElapsed(handle,getEffectDuration(handle)-time);
+    }
+    
+    /**
+     * Stops the sound effect for the given handle, removing it.
+     *
+     * If the handle is not active, this method raises an error.  Once the
+     * sound is stopped, the handle is no longer valid.
+     *
+     * @param  handle   the handle for the sound effect
+     */
+    void stopEffect(Uint32 handle);
+    
+    /**
+     * Pauses the sound effect for the given handle.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     */
+    void pauseEffect(Uint32 handle);
+    
+    /**
+     * Resumes the sound effect for the given handle.
+     *
+     * If the handle is not active, this method raises an error.
+     *
+     * @param  handle   the handle for the sound effect
+     */
+    void resumeEffect(Uint32 handle);
+    
+    /**
+     * Sets the handle callback for sound effects
+     *
+     * This callback function is called whenever a sound effect completes,
+     * whether or not it has a key. It is called whether or not the sound
+     * completed normally or if it was terminated manually.  However, the
+     * second parameter can be used to distinguish the two cases.
+     *
+     * @param callback  The handle callback for sound effects
+     */
+    void setEffectHandleListener(std::function<void(Uint32 handle,bool)> callback) {
+        _handleCB = callback;
+    }
+    
+    /**
+     * Returns the handle callback for sound effects
+     *
+     * This callback function is called whenever a sound effect completes,
+     * whether or not it has a key. It is called whether or not the sound
+     * completed normally or if it was terminated manually.  However, the
+     * second parameter can be used to distinguish the two cases.
+     *
+     * @return the handle callback for sound effects
+     */
+    std::function<void(Uint32 handle,bool)> getEffectHandleListener() const {
+        return _handleCB;
+    }
+    
+    
+#pragma mark -
+#pragma mark Sound Cache
+    /**
+     * Returns the byte budget for decoded compressed sounds.
+     *
+     * A compressed sound (see {@link Sound#allocCompressed}) keeps its encoded
+     * file in memory, and is only decoded when it is played.  The decoded
+     * audio is kept in a cache until it exceeds this budget.  At that point
+     * the least recently played sounds are evicted.  Sounds that are currently
+     * playing are never evicted, so the cache may temporarily exceed its
+     * budget.
+     *
+     * @return the byte budget for decoded compressed sounds.
+     */
+    size_t getCacheBudget() const;
+    
+    /**
+     * Sets the byte budget for decoded compressed sounds.
+     *
+     * A compressed sound (see {@link Sound#allocCompressed}) keeps its encoded
+     * file in memory, and is only decoded when it is played.  The decoded
+     * audio is kept in a cache until it exceeds this budget.  At that point
+     * the least recently played sounds are evicted.  Sounds that are currently
+     * playing are never evicted, so the cache may temporarily exceed its
+     * budget.
+     *
+     * @param bytes The byte budget for decoded compressed sounds.
+     */
+    void setCacheBudget(size_t bytes);
+    
+    /**
+     * Returns the number of bytes of decoded compressed sounds.
+     *
+     * This is the memory currently used by the cache.  It does not include
+     * the encoded data of the compressed sounds.
+     *
+     * @return the number of bytes of decoded compressed sounds.
+     */
+    size_t getCacheResident() const;
+    
+    /**
+     * Returns the number of plays that found their compressed sound decoded.
+     *
+     * @return the number of plays that found their compressed sound decoded.
+     */
+    Uint64 getCacheHits() const;
+    
+    /**
+     * Returns the number of plays that had to decode their compressed sound.
+     *
+     * @return the number of plays that had to decode their compressed sound.
+     */
+    Uint64 getCacheMisses() const;
+    
+    
+#pragma mark -
+#pragma mark Diagnostics
+    /**
+     * Returns the number of blocks mixed since the diagnostics were reset.
+     *
+     * Each block is one pass of the audio callback.  On platforms that do
+     * their own mixing, this value is always 0.
+     *
+     * @return the number of blocks mixed since the diagnostics were reset.
+     */
+    Uint64 getMixedBlocks() const;
+    
+    /**
+     * Returns the number of underruns since the diagnostics were reset.
+     *
+     * An underrun is a block that took longer to mix than it takes to play.
+     * Each underrun is likely heard as a dropout.
+     *
+     * @return the number of underruns since the diagnostics were reset.
+     */
+    Uint64 getUnderruns() const;
+    
+    /**
+     * Returns the number of sound effects currently assigned a channel.
+     *
+     * This does not include virtual sound effects, which are not mixed.
+     *
+     * @return the number of sound effects currently assigned a channel.
+     */
+    unsigned int getActiveVoices() const;
+    
+    /**
+     * Returns the fastest time to mix a block in milliseconds.
+     *
+     * @return the fastest time to mix a block in milliseconds.
+     */
+    double getMixTimeMin() const;
+    
+    /**
+     * Returns the average time to mix a block in milliseconds.
+     *
+     * @return the average time to mix a block in milliseconds.
+     */
+    double getMixTimeAverage() const;
+    
+    /**
+     * Returns the slowest time to mix a block in milliseconds.
+     *
+     * @return the slowest time to mix a block in milliseconds.
+     */
+    double getMixTimeMax() const;
+    
+    /**
+     * Returns the given percentile of the time to mix a block in milliseconds.
+     *
+     * The percentile is a value in [0,100], so 50 is the median.  The mix
+     * times are kept in a logarithmic histogram, so the result is only
+     * accurate to within a fifth of its value.
+     *
+     * @param percent   The percentile to compute
+     *
+     * @return the given percentile of the time to mix a block in milliseconds.
+     */
+    double getMixTimePercentile(float percent) const;
+    
+    /**
+     * Returns the fraction of the available time spent mixing.
+     *
+     * This is the time to mix a block divided by the time to play it,
+     * smoothed over recent blocks.  A value approaching 1 means that the
+     * mixer is about to underrun.
+     *
+     * @return the fraction of the available time spent mixing.
+     */
+    double getMixLoad() const;
+    
+    /**
+     * Returns the estimated output latency in milliseconds.
+     *
+     * This is the time between mixing a block and hearing it, as estimated
+     * from the device block size.  It does not include any latency added by
+     * the operating system or the hardware.
+     *
+     * @return the estimated output latency in milliseconds.
+     */
+    double getOutputLatency() const;
+    
+    /**
+     * Resets the diagnostic counters.
+     *
+     * The counters are cleared by the audio thread before it mixes its next
+     * block, so they may still hold old values immediately after this call.
+     */
+    void resetDiagnostics();
+    
+    
 #pragma mark -
 #pragma mark Global Management
     /**
@@ -0,0 +1,819 @@
+//
+//  CUAudioNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the nodes of the software mixer graph.  Audio is
+//  pulled through the graph from an AudioOutput, which is the root of the
+//  graph.  Each node renders a block of interleaved float samples on demand.
+//  Sources are the leaves, while panners and buses combine and transform the
+//  audio of their inputs.  Every node has a gain, which is ramped across a
+//  block to prevent zipper noise.
+//
+//  The graph is independent of the audio device.  The SDL audio engine pulls
+//  from an AudioOutput in the device callback, but it is also possible to
+//  render the graph offline to a memory buffer.  This makes it possible to
+//  test (and time) the mixer without any audio device at all.
+//
+//  The mixing kernels are vectorized with SSE (or AVX2, if it is enabled by
+//  the compiler).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_AUDIO_NODE_H__
+#define __CU_AUDIO_NODE_H__
+#include <cugl/base/CUBase.h>
+#include <SDL/SDL_audio.h>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/** The default number of frames mixed in a single block */
+#define AUDIO_BLOCK_SIZE  1024
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Audio Node
+/**
+ * This class is the base class of a node in the mixer graph.
+ *
+ * A node produces interleaved float samples on demand.  The number of
+ * channels and the sample rate are fixed when the node is initialized.  The
+ * audio thread pulls samples with the method {@link read}, which applies the
+ * node gain.  Subclasses only need to implement {@link fill}.
+ *
+ * The gain and the pause state may be changed from any thread.  A change in
+ * gain is ramped linearly across the next block, so that it does not click.
+ * Structural changes (such as attaching an input) are the responsibility of
+ * the individual subclasses.
+ */
+class AudioNode {
+protected:
+    /** The number of channels output by this node */
+    Uint32 _channels;
+    /** The sample rate (in HZ) of this node */
+    Uint32 _sampling;
+    /** The (target) gain of this node */
+    std::atomic<float> _gain;
+    /** The gain applied at the end of the last block (audio thread only) */
+    float _ramp;
+    /** Whether this node is paused */
+    std::atomic<bool> _paused;
+    /** Whether this node has been initialized */
+    bool _booted;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio node.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioNode();
+
+    /**
+     * Deletes this audio node, disposing of all resources.
+     */
+    virtual ~AudioNode() { dispose(); }
+
+    /**
+     * Initializes this node with the given channels and sample rate.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     *
+     * @return true if the node was initialized successfully
+     */
+    virtual bool init(Uint32 channels, Uint32 sampling);
+
+    /**
+     * Disposes all of the resources used by this node.
+     *
+     * A disposed node can be safely reinitialized.
+     */
+    virtual void dispose();
+
+#pragma mark Attributes
+    /**
+     * Returns the number of channels output by this node.
+     *
+     * @return the number of channels output by this node.
+     */
+    Uint32 getChannels() const { return _channels; }
+
+    /**
+     * Returns the sample rate (in HZ) of this node.
+     *
+     * @return the sample rate (in HZ) of this node.
+     */
+    Uint32 getSampling() const { return _sampling; }
+
+    /**
+     * Returns the gain of this node.
+     *
+     * @return the gain of this node.
+     */
+    float getGain() const { return _gain.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the gain of this node.
+     *
+     * The change is ramped over the next block.  This method is safe to call
+     * from any thread.
+     *
+     * @param gain  The gain of this node
+     */
+    void setGain(float gain) { _gain.store(gain, std::memory_order_relaxed); }
+
+    /**
+     * Returns true if this node is paused.
+     *
+     * @return true if this node is paused.
+     */
+    bool isPaused() const { return _paused.load(std::memory_order_relaxed); }
+
+    /**
+     * Pauses this node, returning false if it was already paused.
+     *
+     * A paused node outputs silence, and does not advance.
+     *
+     * @return false if the node was already paused.
+     */
+    bool pause() { return !_paused.exchange(true); }
+
+    /**
+     * Resumes this node, returning false if it was not paused.
+     *
+     * @return false if the node was not paused.
+     */
+    bool resume() { return _paused.exchange(false); }
+
+    /**
+     * Returns true if this node will produce no more audio.
+     *
+     * Parent nodes skip completed inputs.  By default, a node never
+     * completes.
+     *
+     * @return true if this node will produce no more audio.
+     */
+    virtual bool completed() { return false; }
+
+#pragma mark Audio Processing
+    /**
+     * Reads up to the given number of frames into the buffer.
+     *
+     * The buffer must have room for frames*channels samples, and its
+     * contents are overwritten.  If the node produces fewer frames than
+     * requested (because it completed), the remainder of the buffer is set
+     * to silence.  A paused node produces silence for the full request.
+     *
+     * This method should only be called by the audio thread (or by an
+     * offline render).
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to read
+     *
+     * @return the number of frames actually produced
+     */
+    Uint32 read(float* buffer, Uint32 frames);
+
+protected:
+    /**
+     * Produces up to the given number of frames in the buffer.
+     *
+     * This method does not need to apply the gain, or to clear any unused
+     * portion of the buffer.  Returning fewer than frames indicates that the
+     * node has completed.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to produce
+     *
+     * @return the number of frames actually produced
+     */
+    virtual Uint32 fill(float* buffer, Uint32 frames) = 0;
+};
+
+
+#pragma mark -
+#pragma mark Audio Source
+/**
+ * This class is a leaf node that plays an in-memory PCM buffer.
+ *
+ * The PCM data is interleaved, either as 16-bit signed integers or as
+ * floats, and must have the same sample rate as the node.  The source does
+ * not own the data.  The data must outlive the time that the source is part
+ * of a graph.
+ *
+ * The playback position, loop setting and expiration may be changed from any
+ * thread.  The changes take effect on the next block.  When the source runs
+ * out of data, it calls its listener (on the audio thread) exactly once.
+ */
+class AudioSource : public AudioNode {
+protected:
+    /** The 16-bit PCM data (or nullptr if float) */
+    const Sint16* _pcm16;
+    /** The float PCM data (or nullptr if 16-bit) */
+    const float*  _pcm32;
+    /** The length of the PCM data in frames */
+    Uint64 _length;
+    /** The current playback position in frames */
+    std::atomic<Uint64> _offset;
+    /** A pending seek position, or -1 if there is none */
+    std::atomic<Sint64> _jump;
+    /** The number of frames until expiration, or -1 if there is none */
+    std::atomic<Sint64> _expire;
+    /** Whether to loop the data */
+    std::atomic<bool> _loop;
+    /** Whether the source has completed */
+    std::atomic<bool> _done;
+    /** The listener for source completion */
+    std::function<void(AudioSource*)> _listener;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio source.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioSource();
+
+    /**
+     * Deletes this audio source, disposing of all resources.
+     */
+    ~AudioSource() { dispose(); }
+
+    /**
+     * Initializes a source for the given 16-bit PCM data.
+     *
+     * @param data      The interleaved PCM data
+     * @param frames    The length of the data in frames
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     *
+     * @return true if the source was initialized successfully
+     */
+    bool init(const Sint16* data, Uint64 frames, Uint32 channels, Uint32 sampling);
+
+    /**
+     * Initializes a source for the given float PCM data.
+     *
+     * @param data      The interleaved PCM data
+     * @param frames    The length of the data in frames
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     *
+     * @return true if the source was initialized successfully
+     */
+    bool init(const float* data, Uint64 frames, Uint32 channels, Uint32 sampling);
+
+    /**
+     * Disposes all of the resources used by this source.
+     *
+     * A disposed source can be safely reinitialized.
+     */
+    void dispose() override;
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated source for the given 16-bit PCM data.
+     *
+     * @param data      The interleaved PCM data
+     * @param frames    The length of the data in frames
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     *
+     * @return a newly allocated source for the given 16-bit PCM data.
+     */
+    static std::shared_ptr<AudioSource> alloc(const Sint16* data, Uint64 frames,
+                                              Uint32 channels, Uint32 sampling) {
+        std::shared_ptr<AudioSource> result = std::make_shared<AudioSource>();
+        return (result->init(data,frames,channels,sampling) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated source for the given float PCM data.
+     *
+     * @param data      The interleaved PCM data
+     * @param frames    The length of the data in frames
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     *
+     * @return a newly allocated source for the given float PCM data.
+     */
+    static std::shared_ptr<AudioSource> alloc(const float* data, Uint64 frames,
+                                              Uint32 channels, Uint32 sampling) {
+        std::shared_ptr<AudioSource> result = std::make_shared<AudioSource>();
+        return (result->init(data,frames,channels,sampling) ? result : nullptr);
+    }
+
+#pragma mark Playback Control
+    /**
+     * Returns the length of the PCM data in frames.
+     *
+     * @return the length of the PCM data in frames.
+     */
+    Uint64 getLength() const { return _length; }
+
+    /**
+     * Returns the current playback position in frames.
+     *
+     * @return the current playback position in frames.
+     */
+    virtual Uint64 getPosition() const;
+
+    /**
+     * Sets the current playback position in frames.
+     *
+     * The position takes effect on the next block.
+     *
+     * @param frame The playback position in frames
+     */
+    virtual void setPosition(Uint64 frame);
+
+    /**
+     * Returns true if this source loops its data.
+     *
+     * @return true if this source loops its data.
+     */
+    bool isLoop() const { return _loop.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets whether this source loops its data.
+     *
+     * @param loop  Whether this source loops its data.
+     */
+    void setLoop(bool loop) { _loop.store(loop, std::memory_order_relaxed); }
+
+    /**
+     * Completes this source after the given number of frames.
+     *
+     * This stops the source even if it is looping.  The listener is called
+     * as if the source had completed normally.
+     *
+     * @param frames    The number of frames until completion
+     */
+    void expire(Uint64 frames) { _expire.store((Sint64)frames); }
+
+    /**
+     * Returns true if this source will produce no more audio.
+     *
+     * @return true if this source will produce no more audio.
+     */
+    bool completed() override { return _done.load(); }
+
+    /**
+     * Sets the listener for source completion.
+     *
+     * The listener is called on the audio thread.  Therefore it should do as
+     * little work as possible.  The listener should be set before the source
+     * is attached to a graph.
+     *
+     * @param listener  The listener for source completion
+     */
+    void setListener(std::function<void(AudioSource*)> listener) {
+        _listener = listener;
+    }
+
+protected:
+    /**
+     * Produces up to the given number of frames in the buffer.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to produce
+     *
+     * @return the number of frames actually produced
+     */
+    Uint32 fill(float* buffer, Uint32 frames) override;
+};
+
+
+#pragma mark -
+#pragma mark Audio Panner
+/**
+ * This class is a node that pans its input across the output channels.
+ *
+ * A panner has a single input, which must be either mono or stereo.  The
+ * output is either mono or stereo.  A mono output is the average of the
+ * channels.  A stereo output uses a balance law: the pan value -1 is hard
+ * left, 1 is hard right, and 0 leaves the input unchanged.  In particular,
+ * a centered mono input is copied to both channels at full volume.
+ *
+ * The pan value may be changed from any thread.  The input may also be
+ * changed from any thread, though that acquires a lock.
+ */
+class AudioPanner : public AudioNode {
+private:
+    /** The input node */
+    std::shared_ptr<AudioNode> _input;
+    /** The pan value (from -1 to 1) */
+    std::atomic<float> _pan;
+    /** A buffer to read the input */
+    float* _scratch;
+    /** A lock protecting the input */
+    std::mutex _mutex;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio panner.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioPanner();
+
+    /**
+     * Deletes this audio panner, disposing of all resources.
+     */
+    ~AudioPanner() { dispose(); }
+
+    /**
+     * Initializes a panner with the given output channels and sample rate.
+     *
+     * @param channels  The number of output channels (1 or 2)
+     * @param sampling  The sample rate in HZ
+     *
+     * @return true if the panner was initialized successfully
+     */
+    bool init(Uint32 channels, Uint32 sampling) override;
+
+    /**
+     * Disposes all of the resources used by this panner.
+     *
+     * A disposed panner can be safely reinitialized.
+     */
+    void dispose() override;
+
+    /**
+     * Returns a newly allocated panner with the given channels and sample rate.
+     *
+     * @param channels  The number of output channels (1 or 2)
+     * @param sampling  The sample rate in HZ
+     *
+     * @return a newly allocated panner with the given channels and sample rate.
+     */
+    static std::shared_ptr<AudioPanner> alloc(Uint32 channels, Uint32 sampling) {
+        std::shared_ptr<AudioPanner> result = std::make_shared<AudioPanner>();
+        return (result->init(channels,sampling) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the pan value of this panner.
+     *
+     * @return the pan value of this panner.
+     */
+    float getPan() const { return _pan.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the pan value of this panner.
+     *
+     * The value -1 is hard left, and 1 is hard right.
+     *
+     * @param pan   The pan value of this panner.
+     */
+    void setPan(float pan);
+
+    /**
+     * Attaches an input to this panner, returning the previous input.
+     *
+     * The input must be mono or stereo, and must have the same sample rate
+     * as this panner.  Passing nullptr detaches the current input.
+     *
+     * @param node  The input node
+     *
+     * @return the previous input node
+     */
+    std::shared_ptr<AudioNode> attach(const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Detaches the input of this panner, returning the previous input.
+     *
+     * @return the previous input node
+     */
+    std::shared_ptr<AudioNode> detach() { return attach(nullptr); }
+
+    /**
+     * Returns the input of this panner.
+     *
+     * @return the input of this panner.
+     */
+    std::shared_ptr<AudioNode> getInput();
+
+    /**
+     * Returns true if this panner has no input, or its input has completed.
+     *
+     * @return true if this panner will produce no more audio.
+     */
+    bool completed() override;
+
+protected:
+    /**
+     * Produces up to the given number of frames in the buffer.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to produce
+     *
+     * @return the number of frames actually produced
+     */
+    Uint32 fill(float* buffer, Uint32 frames) override;
+};
+
+
+#pragma mark -
+#pragma mark Audio Bus
+/**
+ * This class is a node that sums a fixed number of input slots.
+ *
+ * A bus is used as a submix.  All inputs must have the same channels and
+ * sample rate as the bus.  Empty slots and completed inputs are skipped.
+ * The inputs may be changed from any thread, though that acquires a lock.
+ * A bus never completes on its own.
+ */
+class AudioBus : public AudioNode {
+private:
+    /** The input slots */
+    std::vector<std::shared_ptr<AudioNode>> _inputs;
+    /** A buffer to read the inputs */
+    float* _scratch;
+    /** A lock protecting the inputs */
+    std::mutex _mutex;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio bus.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioBus();
+
+    /**
+     * Deletes this audio bus, disposing of all resources.
+     */
+    ~AudioBus() { dispose(); }
+
+    /**
+     * Initializes a bus with the given channels, sample rate and slots.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param slots     The number of input slots
+     *
+     * @return true if the bus was initialized successfully
+     */
+    bool init(Uint32 channels, Uint32 sampling, Uint32 slots);
+
+    /**
+     * Disposes all of the resources used by this bus.
+     *
+     * A disposed bus can be safely reinitialized.
+     */
+    void dispose() override;
+
+    /**
+     * Returns a newly allocated bus with the given channels, rate and slots.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param slots     The number of input slots
+     *
+     * @return a newly allocated bus with the given channels, rate and slots.
+     */
+    static std::shared_ptr<AudioBus> alloc(Uint32 channels, Uint32 sampling, Uint32 slots) {
+        std::shared_ptr<AudioBus> result = std::make_shared<AudioBus>();
+        return (result->init(channels,sampling,slots) ? result : nullptr);
+    }
+
+#pragma mark Inputs
+    /**
+     * Returns the number of input slots.
+     *
+     * @return the number of input slots.
+     */
+    Uint32 getCapacity() const { return (Uint32)_inputs.size(); }
+
+    /**
+     * Attaches an input to the given slot, returning the previous input.
+     *
+     * The input must have the same channels and sample rate as this bus.
+     * Passing nullptr empties the slot.
+     *
+     * @param slot  The input slot
+     * @param node  The input node
+     *
+     * @return the previous input node
+     */
+    std::shared_ptr<AudioNode> attach(Uint32 slot, const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Empties the given slot, returning the previous input.
+     *
+     * @param slot  The input slot
+     *
+     * @return the previous input node
+     */
+    std::shared_ptr<AudioNode> detach(Uint32 slot) { return attach(slot,nullptr); }
+
+    /**
+     * Returns the input in the given slot.
+     *
+     * @param slot  The input slot
+     *
+     * @return the input in the given slot.
+     */
+    std::shared_ptr<AudioNode> getInput(Uint32 slot);
+
+protected:
+    /**
+     * Produces the given number of frames in the buffer.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to produce
+     *
+     * @return the number of frames actually produced
+     */
+    Uint32 fill(float* buffer, Uint32 frames) override;
+};
+
+
+#pragma mark -
+#pragma mark Audio Output
+/**
+ * This class is the root of a mixer graph.
+ *
+ * An output pulls audio from its input one block at a time.  It can either
+ * render to a float buffer (offline) or mix into an audio device stream.  The
+ * latter is used by the SDL audio engine in the device callback.  The two
+ * methods use the same code path, so an offline render is an accurate
+ * measure of the cost of the mix.
+ */
+class AudioOutput {
+private:
+    /** The number of output channels */
+    Uint32 _channels;
+    /** The sample rate in HZ */
+    Uint32 _sampling;
+    /** The number of frames in a block */
+    Uint32 _blocksize;
+    /** The block buffer */
+    float* _buffer;
+    /** The input node */
+    std::shared_ptr<AudioNode> _input;
+    /** A lock protecting the input */
+    std::mutex _mutex;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio output.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioOutput();
+
+    /**
+     * Deletes this audio output, disposing of all resources.
+     */
+    ~AudioOutput() { dispose(); }
+
+    /**
+     * Initializes an output with the given channels, rate and block size.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param blocksize The number of frames in a block
+     *
+     * @return true if the output was initialized successfully
+     */
+    bool init(Uint32 channels, Uint32 sampling, Uint32 blocksize=AUDIO_BLOCK_SIZE);
+
+    /**
+     * Disposes all of the resources used by this output.
+     *
+     * A disposed output can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Returns a newly allocated output with the given channels, rate and block size.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param blocksize The number of frames in a block
+     *
+     * @return a newly allocated output with the given channels, rate and block size.
+     */
+    static std::shared_ptr<AudioOutput> alloc(Uint32 channels, Uint32 sampling,
+                                              Uint32 blocksize=AUDIO_BLOCK_SIZE) {
+        std::shared_ptr<AudioOutput> result = std::make_shared<AudioOutput>();
+        return (result->init(channels,sampling,blocksize) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the number of output channels.
+     *
+     * @return the number of output channels.
+     */
+    Uint32 getChannels() const { return _channels; }
+
+    /**
+     * Returns the sample rate (in HZ) of this output.
+     *
+     * @return the sample rate (in HZ) of this output.
+     */
+    Uint32 getSampling() const { return _sampling; }
+
+    /**
+     * Returns the number of frames in a block.
+     *
+     * @return the number of frames in a block.
+     */
+    Uint32 getBlockSize() const { return _blocksize; }
+
+    /**
+     * Attaches an input to this output, returning the previous input.
+     *
+     * The input must have the same channels and sample rate as this output.
+     *
+     * @param node  The input node
+     *
+     * @return the previous input node
+     */
+    std::shared_ptr<AudioNode> attach(const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Returns the input of this output.
+     *
+     * @return the input of this output.
+     */
+    std::shared_ptr<AudioNode> getInput();
+
+#pragma mark Rendering
+    /**
+     * Renders the given number of frames to the buffer.
+     *
+     * This is the offline entry point to the mixer graph.  The buffer must
+     * have room for frames*channels samples.  The graph is processed one
+     * block at a time, exactly as it is in the device callback.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to render
+     */
+    void render(float* buffer, Uint32 frames);
+
+    /**
+     * Mixes the graph into the given device stream.
+     *
+     * The output is added to (not written over) the existing stream.  Only
+     * the formats AUDIO_S16SYS and AUDIO_F32SYS are supported.  The 16-bit
+     * mix saturates on overflow.
+     *
+     * @param stream    The device stream
+     * @param len       The length of the stream in bytes
+     * @param format    The device format
+     */
+    void mix(Uint8* stream, int len, SDL_AudioFormat format);
+};
+
+}
+
+#endif /* __CU_AUDIO_NODE_H__ */
@@ -0,0 +1,306 @@
+//
+//  CUAudioQueue.h
+//  Cornell University Game Library (CUGL)
+//
+//  This header provides a template for a fixed-capacity, lock-free queue.
+//  This queue is used to pass messages between the audio thread and the
+//  rest of the application.  The audio thread must never block on a lock
+//  held by another thread, nor may it allocate memory, as either can cause
+//  the audio callback to miss its deadline (which is heard as a dropout).
+//
+//  The queue is a ring of slots, each with its own sequence number.  Any
+//  number of threads may push and pop at the same time.  All memory is
+//  allocated when the queue is initialized, so pushing and popping never
+//  allocate (provided that copying or moving the element does not).
+//
+//  This is not a class. It is a class template. Templates do not have cpp
+//  files. They only have a header file.  When you include the header, it
+//  compiles the specific template used by your program. Hence all of the code
+//  for this templated class is in this header.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_AUDIO_QUEUE_H__
+#define __CU_AUDIO_QUEUE_H__
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <utility>
+
+/** The size of a cache line, used to keep the queue ends apart */
+#define AUDIO_QUEUE_PADDING 64
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark AudioQueue Template
+/**
+ * Template for a fixed-capacity, lock-free queue
+ *
+ * This queue is designed for messages to and from the audio thread.  Any
+ * number of threads may push or pop simultaneously, and no operation ever
+ * blocks or allocates memory.  When the queue is full, {@link push} fails
+ * and returns false.  It is up to the caller to decide what to do in that
+ * case (e.g. drop the message or try again later).
+ *
+ * The capacity is rounded up to a power of two.  Each slot stores an element
+ * and a sequence number.  A thread claims a slot by advancing the head (or
+ * tail) counter, and the sequence number tells it whether the slot has been
+ * written (or read) by the previous owner.
+ *
+ * The element type must have a default constructor and be move assignable.
+ * Elements are moved out when they are popped.  Hence an element type with
+ * ownership (such as a shared pointer) is released by the popping thread,
+ * not by the queue.
+ */
+template <class T>
+class AudioQueue {
+private:
+    /** A slot in the ring */
+    struct Slot {
+        /** The sequence number of this slot */
+        std::atomic<size_t> sequence;
+        /** The element stored in this slot */
+        T value;
+    };
+
+    /** The ring of slots */
+    Slot* _slots;
+    /** The capacity minus one (the capacity is a power of two) */
+    size_t _mask;
+    /** Padding to keep the push counter on its own cache line */
+    char _pad0[AUDIO_QUEUE_PADDING];
+    /** The number of slots claimed for pushing */
+    std::atomic<size_t> _head;
+    /** Padding to keep the pop counter on its own cache line */
+    char _pad1[AUDIO_QUEUE_PADDING];
+    /** The number of slots claimed for popping */
+    std::atomic<size_t> _tail;
+    /** Padding to keep the pop counter apart from other data */
+    char _pad2[AUDIO_QUEUE_PADDING];
+
+#pragma mark Constructors
+public:
+    /**
+     * Creates a new queue with no capacity.
+     *
+     * You must initialize this queue before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a queue on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioQueue() : _slots(nullptr), _mask(0), _head(0), _tail(0) {}
+
+    /**
+     * Deletes this queue, releasing all memory.
+     */
+    ~AudioQueue() { dispose(); }
+
+    /**
+     * Disposes this queue, releasing all memory.
+     *
+     * Any elements still in the queue are destroyed.  This method is not
+     * thread-safe.  A disposed queue can be safely reinitialized.
+     */
+    void dispose() {
+        if (_slots != nullptr) {
+            delete[] _slots;
+            _slots = nullptr;
+        }
+        _mask = 0;
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Initializes a queue with the given capacity.
+     *
+     * The capacity is rounded up to the next power of two.  This method is
+     * the only one that allocates memory.
+     *
+     * @param capacity  The minimum number of elements in the queue
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(size_t capacity) {
+        if (_slots != nullptr || capacity == 0) {
+            return false;
+        }
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _slots = new Slot[size];
+        for(size_t ii = 0; ii < size; ii++) {
+            _slots[ii].sequence.store(ii, std::memory_order_relaxed);
+        }
+        _mask = size-1;
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated queue with the given capacity.
+     *
+     * The capacity is rounded up to the next power of two.
+     *
+     * @param capacity  The minimum number of elements in the queue
+     *
+     * @return a newly allocated queue with the given capacity.
+     */
+    static std::shared_ptr<AudioQueue<T>> alloc(size_t capacity) {
+        std::shared_ptr<AudioQueue<T>> result = std::make_shared<AudioQueue<T>>();
+        return (result->init(capacity) ? result : nullptr);
+    }
+
+#pragma mark Accessors
+    /**
+     * Returns the maximum number of elements in this queue.
+     *
+     * @return the maximum number of elements in this queue.
+     */
+    size_t getCapacity() const { return _slots == nullptr ? 0 : _mask+1; }
+
+    /**
+     * Returns the number of elements in this queue.
+     *
+     * If other threads are using the queue, this value is only approximate.
+     *
+     * @return the number of elements in this queue.
+     */
+    size_t getSize() const {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_relaxed);
+        return (head > tail ? head-tail : 0);
+    }
+
+    /**
+     * Returns true if this queue has no elements.
+     *
+     * If other threads are using the queue, this value is only approximate.
+     *
+     * @return true if this queue has no elements.
+     */
+    bool isEmpty() const { return getSize() == 0; }
+
+#pragma mark Queue Operations
+    /**
+     * Returns true if the element was added to the end of the queue.
+     *
+     * If the queue is full, this method does nothing and returns false.
+     *
+     * @param value The element to add
+     *
+     * @return true if the element was added to the end of the queue.
+     */
+    bool push(const T& value) {
+        size_t pos;
+        Slot* slot = claim(_head, 0, pos);
+        if (slot == nullptr) {
+            return false;
+        }
+        slot->value = value;
+        slot->sequence.store(pos+1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns true if the element was moved to the end of the queue.
+     *
+     * If the queue is full, this method does nothing and returns false. In
+     * that case the element is not moved.
+     *
+     * @param value The element to add
+     *
+     * @return true if the element was moved to the end of the queue.
+     */
+    bool push(T&& value) {
+        size_t pos;
+        Slot* slot = claim(_head, 0, pos);
+        if (slot == nullptr) {
+            return false;
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(pos+1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns true if an element was removed from the front of the queue.
+     *
+     * The element is moved into the given value.  If the queue is empty, this
+     * method does nothing and returns false.
+     *
+     * @param value The element removed
+     *
+     * @return true if an element was removed from the front of the queue.
+     */
+    bool pop(T& value) {
+        size_t pos;
+        Slot* slot = claim(_tail, 1, pos);
+        if (slot == nullptr) {
+            return false;
+        }
+        value = std::move(slot->value);
+        slot->sequence.store(pos+_mask+1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    /**
+     * Returns the slot claimed by advancing the given counter.
+     *
+     * A slot at position pos is ready to push when its sequence is pos, and
+     * ready to pop when its sequence is pos+1.  If the slot at the counter is
+     * not ready, the queue is full (or empty) and this method returns nullptr.
+     *
+     * @param counter   The counter to advance (_head or _tail)
+     * @param offset    The sequence offset of a ready slot (0 or 1)
+     * @param pos       The position of the claimed slot
+     *
+     * @return the slot claimed by advancing the given counter.
+     */
+    Slot* claim(std::atomic<size_t>& counter, size_t offset, size_t& pos) {
+        pos = counter.load(std::memory_order_relaxed);
+        while (true) {
+            Slot* slot = _slots+(pos & _mask);
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence-(intptr_t)(pos+offset);
+            if (diff == 0) {
+                if (counter.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                    return slot;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = counter.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}
+
+#endif /* __CU_AUDIO_QUEUE_H__ */
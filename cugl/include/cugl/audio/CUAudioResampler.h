@@ -0,0 +1,267 @@
+//
+//  CUAudioResampler.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a node that converts the sample rate of its input.
+//  This allows sound assets to be kept at their native sample rate, and to be
+//  converted to the device rate at mix time.  As the conversion ratio may be
+//  changed at any time, this node also provides pitch (playback rate) control.
+//
+//  The default conversion is a polyphase windowed-sinc filter.  The filter
+//  coefficients are tabulated, and interpolated between phases, so the ratio
+//  does not need to be rational.  The tables for a fixed set of cutoffs are
+//  shared by all resamplers, so a rate change never rebuilds a table on the
+//  audio thread.  There is also a linear interpolation option, which is
+//  much cheaper, but has audible aliasing.  The filter kernels are vectorized
+//  with SSE (or AVX2, if it is enabled by the compiler).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_AUDIO_RESAMPLER_H__
+#define __CU_AUDIO_RESAMPLER_H__
+#include <cugl/audio/CUAudioNode.h>
+
+/** The number of filter taps for windowed-sinc conversion (a multiple of 8) */
+#define AUDIO_RESAMPLER_TAPS    32
+/** The number of tabulated filter phases between two input frames */
+#define AUDIO_RESAMPLER_PHASES  128
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Audio Resampler
+/**
+ * This class is a node that converts the sample rate of its input.
+ *
+ * The input may have any sample rate, while the output has the sample rate
+ * of this node.  In addition, the input may be played faster or slower with
+ * {@link setRate}, which changes both speed and pitch.
+ *
+ * The input must have the same number of channels as this node.  The input
+ * may be attached or detached at any time (on the main thread).  This is
+ * safe because the input is protected by a mutex that is only held for the
+ * duration of a block.
+ *
+ * The conversion introduces no delay.  The first output frame is the first
+ * input frame.  However, the filter is not causal, so the node reads a few
+ * frames ahead of its current position.
+ */
+class AudioResampler : public AudioNode {
+public:
+    /**
+     * The conversion algorithm.
+     */
+    enum class Quality {
+        /** Linear interpolation between neighboring frames (fast, aliased) */
+        LINEAR,
+        /** Polyphase windowed-sinc interpolation (the default) */
+        SINC
+    };
+
+private:
+    /** The input node */
+    std::shared_ptr<AudioNode> _input;
+    /** The conversion algorithm */
+    std::atomic<Quality> _quality;
+    /** The playback rate applied on top of the sample rate conversion */
+    std::atomic<float> _rate;
+    /** The filter coefficients for the current step (shared by all resamplers) */
+    const float* _kernel;
+    /** The deinterleaved input history (one row per channel) */
+    float* _history;
+    /** The interleaved input block */
+    float* _scratch;
+    /** The number of frames in the input history */
+    Uint32 _filled;
+    /** The position of the next output frame in the input history */
+    double _position;
+    /** The position of the end of the input, or -1 if not reached */
+    double _end;
+    /** The mutex protecting the input */
+    std::mutex _mutex;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio resampler.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioResampler();
+
+    /**
+     * Deletes this audio resampler, disposing of all resources.
+     */
+    ~AudioResampler() { dispose(); }
+
+    /**
+     * Initializes a resampler with the given channels and output sample rate.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The output sample rate in HZ
+     *
+     * @return true if the resampler was initialized successfully
+     */
+    bool init(Uint32 channels, Uint32 sampling) override;
+
+    /**
+     * Disposes all of the resources used by this resampler.
+     *
+     * A disposed resampler can be safely reinitialized.
+     */
+    void dispose() override;
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated resampler with the given channels and rate.
+     *
+     * @param channels  The number of audio channels
+     * @param sampling  The output sample rate in HZ
+     *
+     * @return a newly allocated resampler with the given channels and rate.
+     */
+    static std::shared_ptr<AudioResampler> alloc(Uint32 channels, Uint32 sampling) {
+        std::shared_ptr<AudioResampler> result = std::make_shared<AudioResampler>();
+        return (result->init(channels,sampling) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the playback rate of the input.
+     *
+     * A rate of 1 plays the input at its natural speed.  A rate of 2 plays it
+     * twice as fast (an octave higher), while a rate of 0.5 plays it at half
+     * speed (an octave lower).
+     *
+     * @return the playback rate of the input.
+     */
+    float getRate() const { return _rate.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the playback rate of the input.
+     *
+     * A rate of 1 plays the input at its natural speed.  A rate of 2 plays it
+     * twice as fast (an octave higher), while a rate of 0.5 plays it at half
+     * speed (an octave lower). The rate is clamped to the range [1/8, 8].
+     * The change takes effect at the next block.
+     *
+     * @param rate  The playback rate of the input.
+     */
+    void setRate(float rate);
+
+    /**
+     * Returns the conversion algorithm.
+     *
+     * @return the conversion algorithm.
+     */
+    Quality getQuality() const { return _quality.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the conversion algorithm.
+     *
+     * The change takes effect at the next block.
+     *
+     * @param quality   The conversion algorithm.
+     */
+    void setQuality(Quality quality) { _quality.store(quality, std::memory_order_relaxed); }
+
+    /**
+     * Attaches an input node, returning the previous one.
+     *
+     * The input must have the same number of channels as this node.  The
+     * conversion state is reset, so the new input starts at its current
+     * position.  Passing nullptr detaches the current input.
+     *
+     * @param node  The input node
+     *
+     * @return the previous input node (or nullptr)
+     */
+    std::shared_ptr<AudioNode> attach(const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Detaches the input node, returning it.
+     *
+     * @return the previous input node (or nullptr)
+     */
+    std::shared_ptr<AudioNode> detach() { return attach(nullptr); }
+
+    /**
+     * Returns the input node (or nullptr if there is none).
+     *
+     * @return the input node (or nullptr if there is none).
+     */
+    std::shared_ptr<AudioNode> getInput();
+
+    /**
+     * Returns true if this node will produce no more audio.
+     *
+     * A resampler completes when it has no input, or when its input has
+     * completed and the remaining history has been converted.
+     *
+     * @return true if this node will produce no more audio.
+     */
+    bool completed() override;
+
+protected:
+    /**
+     * Produces up to the given number of frames in the buffer.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to produce
+     *
+     * @return the number of frames actually produced
+     */
+    Uint32 fill(float* buffer, Uint32 frames) override;
+
+private:
+    /**
+     * Resets the conversion state for a new input.
+     *
+     * This method must be called with the mutex held.
+     */
+    void reset();
+
+    /**
+     * Reads another block of input into the history.
+     *
+     * Older frames that are no longer needed are discarded first.  Once the
+     * input has completed, the history is padded with silence.
+     */
+    void refill();
+};
+
+}
+
+#endif /* __CU_AUDIO_RESAMPLER_H__ */
@@ -0,0 +1,423 @@
+//
+//  CUAudioStreamer.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a source node that streams an Ogg Vorbis file.
+//  Unlike AudioSource, the file is never decoded completely into memory.
+//  Instead, a worker thread (shared by all streams) decodes the file
+//  incrementally into a ring buffer, which is consumed by the mixer.  Only
+//  the ring buffer is resident, so this is much cheaper than a fully decoded
+//  sound for long assets like ambience.
+//
+//  The ring buffer has a single producer (the worker thread) and a single
+//  consumer (the audio thread), so it is lock-free.  The audio thread never
+//  blocks on the decoder.  If the decoder falls behind, the node produces
+//  silence and counts an underrun.
+//
+//  The decoder requires vorbisfile, which is not linked on every platform.
+//  This class is only compiled when CU_AUDIO_STREAMING is defined, which the
+//  Windows and Android projects do.  It is only used by the SDL backend, so
+//  it is never compiled with AVFoundation.  Otherwise, streaming sounds fall
+//  back to a buffer decoded completely into memory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_AUDIO_STREAMER_H__
+#define __CU_AUDIO_STREAMER_H__
+#include <cugl/audio/CUAudioNode.h>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <vector>
+
+/** The default number of frames decoded before playback starts */
+#define AUDIO_STREAM_PREBUFFER  8192
+
+/** Define this in the project settings on any SDL platform that links vorbisfile */
+#if defined (CU_AUDIO_STREAMING) && (defined (__MACOSX__) || defined (__IPHONEOS__))
+    // Mac/iOS use the AVFoundation backend (see CUAudioEngine.h)
+    #undef CU_AUDIO_STREAMING
+#endif
+
+#if defined (CU_AUDIO_STREAMING)
+/** Opaque reference to the Vorbis decoder state */
+struct OggVorbis_File;
+
+namespace cugl {
+
+class AudioStreamer;
+
+#pragma mark -
+#pragma mark Audio Stream Decoder
+/**
+ * This class is a worker thread that decodes every active audio streamer.
+ *
+ * Streamers are attached to the decoder when they are initialized, and are
+ * detached when they are disposed.  The worker visits the attached streamers
+ * in turn, decoding one chunk (or performing one seek) for each of them. It
+ * sleeps when there is no work to do, and is woken by the audio thread as
+ * it consumes audio.
+ *
+ * A single decoder is intended to last as long as the audio engine, so that
+ * playing a stream never starts a thread.
+ */
+class AudioStreamDecoder {
+private:
+    /** The attached streamers */
+    std::vector<AudioStreamer*> _streams;
+    /** The worker thread for decoding */
+    std::thread* _worker;
+    /** Whether the worker thread should continue to run */
+    bool _running;
+    /** The mutex guarding the attached streamers */
+    std::mutex _mutex;
+    /** The condition variable for waking the worker thread */
+    std::condition_variable _ready;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate stream decoder.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioStreamDecoder();
+
+    /**
+     * Deletes this stream decoder, disposing of all resources.
+     */
+    ~AudioStreamDecoder() { dispose(); }
+
+    /**
+     * Initializes the stream decoder, starting its worker thread.
+     *
+     * @return true if the decoder was initialized successfully
+     */
+    bool init();
+
+    /**
+     * Disposes all of the resources used by this decoder.
+     *
+     * This method stops the worker thread.  Any streamers still attached are
+     * no longer decoded.  A disposed decoder can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Returns a newly allocated stream decoder.
+     *
+     * @return a newly allocated stream decoder.
+     */
+    static std::shared_ptr<AudioStreamDecoder> alloc() {
+        std::shared_ptr<AudioStreamDecoder> result = std::make_shared<AudioStreamDecoder>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark Streamers
+    /**
+     * Attaches a streamer to this decoder.
+     *
+     * @param stream    The streamer to decode
+     */
+    void attach(AudioStreamer* stream);
+
+    /**
+     * Detaches a streamer from this decoder.
+     *
+     * When this method returns, the worker thread is guaranteed to no longer
+     * access the streamer.
+     *
+     * @param stream    The streamer to detach
+     */
+    void detach(AudioStreamer* stream);
+
+    /**
+     * Wakes the worker thread if it is asleep.
+     *
+     * This method does not block, and is safe to call from the audio thread.
+     */
+    void wake() { _ready.notify_one(); }
+
+private:
+    /**
+     * Runs the worker thread until the decoder is disposed.
+     */
+    void run();
+};
+
+#pragma mark -
+#pragma mark Audio Streamer
+/**
+ * This class is a leaf node that streams an Ogg Vorbis file.
+ *
+ * The file is decoded incrementally by an {@link AudioStreamDecoder} into a
+ * lock-free ring buffer.  The ring buffer holds twice the prebuffer size
+ * (rounded up to a power of two).  The prebuffer is decoded ahead of time
+ * with {@link #preload}, and is copied into the ring buffer when the streamer
+ * is initialized.  So the first block is available immediately, and the
+ * decoder opens the file and resumes after the prebuffer in the background.
+ *
+ * As a subclass of {@link AudioSource}, this node supports looping, seeking,
+ * expiration and a completion listener.  A seek is performed by the worker
+ * thread, and the node is silent until the decoder has caught up with it.
+ *
+ * The stream is played at its native sample rate and channel layout. It is
+ * the responsibility of the caller to make sure that these are compatible
+ * with the mixer graph.
+ */
+class AudioStreamer : public AudioSource {
+private:
+    /** The decoder servicing this streamer */
+    std::shared_ptr<AudioStreamDecoder> _decoder;
+    /** The path to the Ogg Vorbis file */
+    std::string _file;
+    /** The number of frames copied from the prebuffer */
+    Uint64 _start;
+    /** Whether the decoder has tried to open the file */
+    bool _opened;
+    /** The Vorbis decoder state (owned by the worker thread) */
+    OggVorbis_File* _vorbis;
+    /** The interleaved ring buffer */
+    float* _ring;
+    /** The capacity of the ring buffer in frames (a power of two) */
+    Uint64 _capacity;
+    /** The total number of frames written to the ring buffer */
+    std::atomic<Uint64> _head;
+    /** The total number of frames read from the ring buffer */
+    std::atomic<Uint64> _tail;
+    /** The head position at the end of the file, or -1 if not reached */
+    std::atomic<Sint64> _finish;
+    /** Whether the decoder has reached the end of the file */
+    bool _eof;
+
+    /** The target of the most recent seek request */
+    std::atomic<Uint64> _target;
+    /** The number of seek requests */
+    std::atomic<Uint32> _requests;
+    /** The last seek request performed by the decoder */
+    Uint32 _sought;
+    /** The last seek request applied by the audio thread */
+    std::atomic<Uint32> _served;
+    /** The head position of the most recent seek */
+    Uint64 _markHead;
+    /** The file position of the most recent seek */
+    Uint64 _markFrame;
+    /** The seek request of the most recent seek */
+    Uint32 _markRequest;
+    /** The number of seeks published by the decoder */
+    std::atomic<Uint32> _markSerial;
+    /** The number of seeks acknowledged by the audio thread */
+    std::atomic<Uint32> _markAck;
+
+    /** The number of blocks that the decoder could not fill */
+    std::atomic<Uint32> _underruns;
+
+    /** Allow the decoder to access the decoding step */
+    friend class AudioStreamDecoder;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate audio streamer.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioStreamer();
+
+    /**
+     * Deletes this audio streamer, disposing of all resources.
+     */
+    ~AudioStreamer() { dispose(); }
+
+    /**
+     * Initializes a streamer for the given Ogg Vorbis file.
+     *
+     * The format of the file should come from {@link #query}, and the prefix
+     * from {@link #preload}.  The prefix is copied into the ring buffer, and
+     * the streamer is attached to the decoder, which opens the file and
+     * resumes decoding after the prefix.  This method does not access the
+     * file.  If file is a relative path, it is relative to the working
+     * directory (as with SDL_RWFromFile).
+     *
+     * @param decoder   The decoder to service this streamer
+     * @param file      The path to the Ogg Vorbis file
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param frames    The length of the file in frames
+     * @param prefix    The interleaved audio at the start of the file
+     *
+     * @return true if the streamer was initialized successfully
+     */
+    bool init(const std::shared_ptr<AudioStreamDecoder>& decoder, const std::string& file,
+              Uint32 channels, Uint32 sampling, Uint64 frames, const std::vector<float>& prefix);
+
+    /**
+     * Disposes all of the resources used by this streamer.
+     *
+     * This method detaches the streamer from its decoder.  A disposed
+     * streamer can be safely reinitialized.
+     */
+    void dispose() override;
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated streamer for the given Ogg Vorbis file.
+     *
+     * The format of the file should come from {@link #query}, and the prefix
+     * from {@link #preload}.  The prefix is copied into the ring buffer, and
+     * the streamer is attached to the decoder, which opens the file and
+     * resumes decoding after the prefix.  This method does not access the
+     * file.  If file is a relative path, it is relative to the working
+     * directory (as with SDL_RWFromFile).
+     *
+     * @param decoder   The decoder to service this streamer
+     * @param file      The path to the Ogg Vorbis file
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param frames    The length of the file in frames
+     * @param prefix    The interleaved audio at the start of the file
+     *
+     * @return a newly allocated streamer for the given Ogg Vorbis file.
+     */
+    static std::shared_ptr<AudioStreamer> alloc(const std::shared_ptr<AudioStreamDecoder>& decoder,
+                                                const std::string& file,
+                                                Uint32 channels, Uint32 sampling, Uint64 frames,
+                                                const std::vector<float>& prefix) {
+        std::shared_ptr<AudioStreamer> result = std::make_shared<AudioStreamer>();
+        return (result->init(decoder,file,channels,sampling,frames,prefix) ? result : nullptr);
+    }
+
+    /**
+     * Returns true if the file is a streamable Ogg Vorbis file.
+     *
+     * If successful, this method stores the format of the file in the given
+     * parameters.  It does not decode any audio.
+     *
+     * @param file      The path to the Ogg Vorbis file
+     * @param channels  The number of audio channels
+     * @param sampling  The sample rate in HZ
+     * @param frames    The length of the file in frames
+     *
+     * @return true if the file is a streamable Ogg Vorbis file.
+     */
+    static bool query(const std::string& file, Uint32& channels, Uint32& sampling, Uint64& frames);
+
+    /**
+     * Returns true if the start of the file was decoded successfully.
+     *
+     * This method decodes up to the given number of frames from the start
+     * of the file, storing them interleaved in prefix.  It is the prebuffer
+     * of any streamer for this file, and should be decoded once, when the
+     * sound is loaded.
+     *
+     * @param file      The path to the Ogg Vorbis file
+     * @param frames    The number of frames to decode
+     * @param prefix    The vector to store the audio
+     *
+     * @return true if the start of the file was decoded successfully.
+     */
+    static bool preload(const std::string& file, Uint32 frames, std::vector<float>& prefix);
+
+#pragma mark Playback Control
+    /**
+     * Returns the current playback position in frames.
+     *
+     * If there is a seek in progress, this is the seek target.
+     *
+     * @return the current playback position in frames.
+     */
+    Uint64 getPosition() const override;
+
+    /**
+     * Sets the current playback position in frames.
+     *
+     * The seek is performed by the decoder.  The streamer is silent
+     * until the decoder has caught up with the new position.
+     *
+     * @param frame The playback position in frames
+     */
+    void setPosition(Uint64 frame) override;
+
+    /**
+     * Returns the number of frames decoded ahead of playback.
+     *
+     * @return the number of frames decoded ahead of playback.
+     */
+    Uint64 getBuffered() const {
+        return _head.load(std::memory_order_relaxed)-_tail.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the capacity of the ring buffer in frames.
+     *
+     * @return the capacity of the ring buffer in frames.
+     */
+    Uint64 getCapacity() const { return _capacity; }
+
+    /**
+     * Returns the number of blocks that the decoder could not fill in time.
+     *
+     * @return the number of blocks that the decoder could not fill in time.
+     */
+    Uint32 getUnderruns() const { return _underruns.load(std::memory_order_relaxed); }
+
+protected:
+    /**
+     * Produces up to the given number of frames in the buffer.
+     *
+     * @param buffer    The buffer to store the audio
+     * @param frames    The number of frames to produce
+     *
+     * @return the number of frames actually produced
+     */
+    Uint32 fill(float* buffer, Uint32 frames) override;
+
+private:
+    /**
+     * Performs a single unit of work for the decoder.
+     *
+     * This is either a pending seek, or the decoding of a chunk of audio into
+     * the ring buffer.  It returns false if there was no work to do.
+     *
+     * @return true if the decoder performed any work
+     */
+    bool decode();
+};
+
+}
+
+#endif /* CU_AUDIO_STREAMING */
+#endif /* __CU_AUDIO_STREAMER_H__ */
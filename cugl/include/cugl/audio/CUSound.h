@@ -48,6 +48,7 @@
 #ifndef __CU_SOUND_H__
 #define __CU_SOUND_H__
 #include <cugl/base/CUBase.h>
+#include <cugl/audio/CUAudioStreamer.h>
 
 #pragma mark -
 #pragma mark Sound Class
@@ -69,10 +70,19 @@ namespace impl {
 /**
  * Class provides a reference to a pre-loaded asset.
  *
- * Sound assets are loaded entirely into memory.  They are not streamed. 
- * Therefore, this type of asset should be reserved for low-memory footprint
- * sounds such as sound effects. Music files should be streamed and processed
- * as a {@link Music} asset instead.
+ * Sound assets are normally loaded entirely into memory.  Therefore, this
+ * type of asset should be reserved for low-memory footprint sounds such as
+ * sound effects. Music files should be streamed and processed as a 
+ * {@link Music} asset instead.
+ *
+ * Long OGG Vorbis assets (such as ambience) may be streamed instead.  A
+ * streamed sound is decoded incrementally each time it is played, so only a
+ * small ring buffer is resident.  Streaming is platform-dependent, and falls
+ * back to an in-memory buffer when it is not supported.
+ *
+ * Alternatively, short effects may be kept compressed in memory, and only 
+ * decoded on play. The decoded audio is cached by the {@link AudioEngine},
+ * which evicts the least recently played sounds to stay within a budget.
  *
  * As a general rule, it is best for these assets to be WAV files. There are
  * no cross-platform lossless encodings for both Androi and iOS.  For lossy
@@ -92,6 +102,12 @@ private:
     impl::AudioBuffer* _buffer;
     /** The default volume for this sound */
     float _volume;
+    /** The playback priority for this sound */
+    int _priority;
+    /** Whether this sound is streamed from its file */
+    bool _streamed;
+    /** Whether this sound is kept compressed in memory */
+    bool _compressed;
     
 #pragma mark -
 #pragma mark Constructors
@@ -102,7 +118,8 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an asset on
      * the heap, use one of the static constructors instead.
      */
-    Sound() : _source(""), _buffer(nullptr), _volume(1) {}
+    Sound() : _source(""), _buffer(nullptr), _volume(1), _priority(0), _streamed(false),
+              _compressed(false) {}
     
     /**
      * Deletes this sound asset, disposing of all resources.
@@ -122,25 +139,63 @@ public:
      *
      * The sound will be decompressed into PCM (e.g. WAV data) which is 
      * possibly large. This will be stored in a platform specific buffer.
+     * If stream is true, the sound is instead decoded incrementally on 
+     * playback, with the given number of frames decoded up front.
      *
-     * @param  source   the source file for the sound
+     * @param  source       the source file for the sound
+     * @param  stream       whether to stream the sound from its file
+     * @param  prebuffer    the number of frames to decode before playback
      *
      * @return true if the sound was initialized successfully
      */
-    bool init(const std::string& source);
+    bool init(const std::string& source, bool stream=false, Uint32 prebuffer=AUDIO_STREAM_PREBUFFER);
 
     /**
      * Initializes a new sound asset for the given source file.
      *
      * The sound will be decompressed into PCM (e.g. WAV data) which is
      * possibly large. This will be stored in a platform specific buffer.
+     * If stream is true, the sound is instead decoded incrementally on
+     * playback, with the given number of frames decoded up front.
      *
-     * @param  source   the source file for the sound asset
+     * @param  source       the source file for the sound asset
+     * @param  stream       whether to stream the sound from its file
+     * @param  prebuffer    the number of frames to decode before playback
      *
      * @return true if the sound asset was initialized successfully
      */
-    bool init(const char* source) {
-        return init(std::string(source));
+    bool init(const char* source, bool stream=false, Uint32 prebuffer=AUDIO_STREAM_PREBUFFER) {
+        return init(std::string(source),stream,prebuffer);
+    }
+    
+    /**
+     * Initializes a new compressed sound asset for the given source file.
+     *
+     * The encoded file is kept in memory, and is only decompressed into PCM
+     * when it is played.  The decompressed data is cached by the audio engine
+     * (see {@link AudioEngine#setCacheBudget}).  This is best for short sound
+     * effects that are played infrequently.
+     *
+     * @param  source   the source file for the sound
+     *
+     * @return true if the sound was initialized successfully
+     */
+    bool initCompressed(const std::string& source);
+    
+    /**
+     * Initializes a new compressed sound asset for the given source file.
+     *
+     * The encoded file is kept in memory, and is only decompressed into PCM
+     * when it is played.  The decompressed data is cached by the audio engine
+     * (see {@link AudioEngine#setCacheBudget}).  This is best for short sound
+     * effects that are played infrequently.
+     *
+     * @param  source   the source file for the sound
+     *
+     * @return true if the sound was initialized successfully
+     */
+    bool initCompressed(const char* source) {
+        return initCompressed(std::string(source));
     }
 
 #pragma mark -
@@ -150,14 +205,19 @@ public:
      *
      * The sound will be decompressed into PCM (e.g. WAV data) which is
      * possibly large. This will be stored in a platform specific buffer.
+     * If stream is true, the sound is instead decoded incrementally on
+     * playback, with the given number of frames decoded up front.
      *
-     * @param  source   the source file for the sound asset
+     * @param  source       the source file for the sound asset
+     * @param  stream       whether to stream the sound from its file
+     * @param  prebuffer    the number of frames to decode before playback
      *
      * @return a newly allocated sound asset for the given source file.
      */
-    static std::shared_ptr<Sound> alloc(const std::string& source) {
+    static std::shared_ptr<Sound> alloc(const std::string& source, bool stream=false,
+                                        Uint32 prebuffer=AUDIO_STREAM_PREBUFFER) {
         std::shared_ptr<Sound> result = std::make_shared<Sound>();
-        return (result->init(source) ? result : nullptr);
+        return (result->init(source,stream,prebuffer) ? result : nullptr);
     }
     
     /**
@@ -165,14 +225,53 @@ public:
      *
      * The sound will be decompressed into PCM (e.g. WAV data) which is
      * possibly large. This will be stored in a platform specific buffer.
+     * If stream is true, the sound is instead decoded incrementally on
+     * playback, with the given number of frames decoded up front.
      *
-     * @param  source   the source file for the sound asset
+     * @param  source       the source file for the sound asset
+     * @param  stream       whether to stream the sound from its file
+     * @param  prebuffer    the number of frames to decode before playback
      *
      * @return a newly allocated sound asset for the given source file.
      */
-    static std::shared_ptr<Sound> alloc(const char* source) {
+    static std::shared_ptr<Sound> alloc(const char* source, bool stream=false,
+                                        Uint32 prebuffer=AUDIO_STREAM_PREBUFFER) {
         std::shared_ptr<Sound> result = std::make_shared<Sound>();
-        return (result->init(source) ? result : nullptr);
+        return (result->init(source,stream,prebuffer) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated compressed sound asset for the given file.
+     *
+     * The encoded file is kept in memory, and is only decompressed into PCM
+     * when it is played.  The decompressed data is cached by the audio engine
+     * (see {@link AudioEngine#setCacheBudget}).  This is best for short sound
+     * effects that are played infrequently.
+     *
+     * @param  source   the source file for the sound asset
+     *
+     * @return a newly allocated compressed sound asset for the given file.
+     */
+    static std::shared_ptr<Sound> allocCompressed(const std::string& source) {
+        std::shared_ptr<Sound> result = std::make_shared<Sound>();
+        return (result->initCompressed(source) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated compressed sound asset for the given file.
+     *
+     * The encoded file is kept in memory, and is only decompressed into PCM
+     * when it is played.  The decompressed data is cached by the audio engine
+     * (see {@link AudioEngine#setCacheBudget}).  This is best for short sound
+     * effects that are played infrequently.
+     *
+     * @param  source   the source file for the sound asset
+     *
+     * @return a newly allocated compressed sound asset for the given file.
+     */
+    static std::shared_ptr<Sound> allocCompressed(const char* source) {
+        std::shared_ptr<Sound> result = std::make_shared<Sound>();
+        return (result->initCompressed(source) ? result : nullptr);
     }
     
 #pragma mark Attributes
@@ -195,6 +294,28 @@ public:
         size_t pos = _source.rfind(".");
         return (pos == std::string::npos ? "" : _source.substr(pos));
     }
+    
+    /**
+     * Returns true if this sound asset was requested as a stream.
+     *
+     * A streamed sound is decoded incrementally each time it is played.
+     * Depending on the platform and file format, the asset may still be
+     * decoded into memory.
+     *
+     * @return true if this sound asset was requested as a stream.
+     */
+    bool isStreamed() const { return _streamed; }
+    
+    /**
+     * Returns true if this sound asset was requested to stay compressed.
+     *
+     * A compressed sound is decoded on play into a cache managed by the audio
+     * engine. Depending on the platform, the asset may still be decoded into
+     * memory when it is loaded.
+     *
+     * @return true if this sound asset was requested to stay compressed.
+     */
+    bool isCompressed() const { return _compressed; }
 
     /**
      * Returns the length of this sound asset in seconds.
@@ -255,6 +376,32 @@ public:
      */
     void setVolume(float volume);
     
+    /**
+     * Returns the playback priority of this sound asset.
+     *
+     * When there are no free channels, the {@link AudioEngine} steals the
+     * channel of the least important sound effect.  Sounds with a higher
+     * priority are always more important than sounds with a lower priority.
+     * Among sounds of equal priority, the louder sound is more important.
+     * The default priority is 0.
+     *
+     * @return the playback priority of this sound asset.
+     */
+    int getPriority() const { return _priority; }
+    
+    /**
+     * Sets the playback priority of this sound asset.
+     *
+     * When there are no free channels, the {@link AudioEngine} steals the
+     * channel of the least important sound effect.  Sounds with a higher
+     * priority are always more important than sounds with a lower priority.
+     * Among sounds of equal priority, the louder sound is more important.
+     * The default priority is 0.
+     *
+     * @param priority  The playback priority of this sound asset.
+     */
+    void setPriority(int priority) { _priority = priority; }
+    
     /** Allow a sound channel to access the internal buffers */
     friend class SoundChannel;
 };
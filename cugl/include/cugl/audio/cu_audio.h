@@ -30,6 +30,10 @@
 
 #include "CUSound.h"
 #include "CUMusic.h"
+#include "CUAudioQueue.h"
+#include "CUAudioNode.h"
+#include "CUAudioStreamer.h"
+#include "CUAudioResampler.h"
 #include "CUAudioEngine.h"
 
 #endif /* __CU_AUDIO_PKG_H__ */
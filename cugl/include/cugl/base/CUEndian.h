@@ -9,6 +9,9 @@
 //  All of the functions in this header are idempotent. To decode a previously
 //  encoded piece of data, use the function again.
 //
+//  There are also bulk functions to reverse the bytes of whole arrays.  These
+//  are not inline, as they are vectorized (with SSE or NEON) where available.
+//
 //  CUGL zlib License:
 //      This software is provided 'as-is', without any express or implied
 //      warranty.  In no event will the authors be held liable for any damages
@@ -219,5 +222,50 @@ SDL_FORCE_INLINE double marshall(double value) {
 #endif
 }
 
+/**
+ * Copies count 16 bit values from src to dst, reversing the bytes of each
+ *
+ * Unlike marshall, this function swaps the bytes on every platform.  It is
+ * intended for converting whole arrays between byte orders.
+ *
+ * Neither array needs to be aligned.  The arrays may be the same (to swap
+ * in place), but they may not otherwise overlap.
+ *
+ * @param dst   The array to store the swapped values
+ * @param src   The array of values to swap
+ * @param count The number of values to swap
+ */
+void swapBytes16(void* dst, const void* src, size_t count);
+
+/**
+ * Copies count 32 bit values from src to dst, reversing the bytes of each
+ *
+ * Unlike marshall, this function swaps the bytes on every platform.  It is
+ * intended for converting whole arrays between byte orders.
+ *
+ * Neither array needs to be aligned.  The arrays may be the same (to swap
+ * in place), but they may not otherwise overlap.
+ *
+ * @param dst   The array to store the swapped values
+ * @param src   The array of values to swap
+ * @param count The number of values to swap
+ */
+void swapBytes32(void* dst, const void* src, size_t count);
+
+/**
+ * Copies count 64 bit values from src to dst, reversing the bytes of each
+ *
+ * Unlike marshall, this function swaps the bytes on every platform.  It is
+ * intended for converting whole arrays between byte orders.
+ *
+ * Neither array needs to be aligned.  The arrays may be the same (to swap
+ * in place), but they may not otherwise overlap.
+ *
+ * @param dst   The array to store the swapped values
+ * @param src   The array of values to swap
+ * @param count The number of values to swap
+ */
+void swapBytes64(void* dst, const void* src, size_t count);
+
 }
 #endif /* __CU_ENDIAN_H__ */
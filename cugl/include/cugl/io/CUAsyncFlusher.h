@@ -0,0 +1,311 @@
+//
+//  CUAsyncFlusher.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a background thread for writing buffers to a file.
+//  It is used by the asynchronous modes of BinaryWriter and TextWriter, so
+//  that a flush does not block the writing thread on the file system.  The
+//  writers are double buffered.  They fill one buffer while this thread writes
+//  the other.  A writer only blocks (stalls) if it fills its buffer before
+//  the previous one has been written.
+//
+//  This module also provides the platform specific code to commit a stream
+//  to the storage device (e.g. fsync).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#ifndef __CU_ASYNC_FLUSHER_H__
+#define __CU_ASYNC_FLUSHER_H__
+#include <cugl/base/CUBase.h>
+#include <SDL/SDL.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/** The number of bins in the stall histogram (powers of two microseconds) */
+#define FLUSHER_STALL_BINS  24
+
+namespace cugl {
+
+/**
+ * Background thread for writing buffers to a file.
+ *
+ * A flusher writes at most one buffer at a time.  When a buffer is submitted,
+ * the flusher takes ownership of it until the write is complete.  The caller
+ * must not modify the buffer until {@link wait} returns.  Hence a writer
+ * should alternate between two buffers, submitting one and filling the other.
+ *
+ * If the caller submits a buffer (or waits) while the previous write is
+ * still in progress, the caller blocks.  This is a stall, and the flusher
+ * records its duration.  These statistics are only safe to query from the
+ * thread that submits the buffers.
+ *
+ * The flusher does not own the stream.  It is the responsibility of the
+ * caller to dispose of the flusher before closing the stream.
+ */
+class AsyncFlusher {
+protected:
+    /** The SDL I/O stream to write to */
+    SDL_RWops* _stream;
+    /** The buffer currently submitted for writing */
+    const char* _pending;
+    /** The number of bytes in the pending buffer */
+    size_t _amount;
+    /** Whether the stream should be committed after the pending write */
+    bool _syncing;
+    /** Whether the worker thread is writing (or about to write) */
+    bool _busy;
+    /** Whether a write or commit has failed since the last wait */
+    bool _failed;
+    /** Whether the worker thread should continue to run */
+    bool _running;
+
+    /** The worker thread for writing */
+    std::thread* _worker;
+    /** The mutex protecting the pending write */
+    std::mutex _mutex;
+    /** The condition variable for waking the worker thread */
+    std::condition_variable _ready;
+    /** The condition variable for waking a stalled writer */
+    std::condition_variable _idle;
+
+    /** The number of buffers submitted */
+    Uint64 _writes;
+    /** The number of submissions or waits that had to block */
+    Uint64 _stalls;
+    /** The total time spent stalled in microseconds */
+    Uint64 _stalltime;
+    /** The longest stall in microseconds */
+    Uint64 _maxstall;
+    /** The stall durations, binned by powers of two microseconds */
+    Uint64 _histogram[FLUSHER_STALL_BINS];
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a flusher with no assigned stream.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AsyncFlusher();
+
+    /**
+     * Deletes this flusher, waiting for any pending write.
+     */
+    ~AsyncFlusher() { dispose(); }
+
+    /**
+     * Initializes a flusher for the given stream.
+     *
+     * This method starts the worker thread.  The stream must be open for
+     * writing, and must remain open until this flusher is disposed.
+     *
+     * @param stream    The SDL I/O stream to write to
+     *
+     * @return true if the flusher is initialized properly, false otherwise.
+     */
+    bool init(SDL_RWops* stream);
+
+    /**
+     * Disposes this flusher, stopping the worker thread.
+     *
+     * This method waits for any pending write to complete.  It does not close
+     * the stream.  A disposed flusher can be safely reinitialized.
+     */
+    void dispose();
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated flusher for the given stream.
+     *
+     * The stream must be open for writing, and must remain open until the
+     * flusher is disposed.
+     *
+     * @param stream    The SDL I/O stream to write to
+     *
+     * @return a newly allocated flusher for the given stream.
+     */
+    static std::shared_ptr<AsyncFlusher> alloc(SDL_RWops* stream) {
+        std::shared_ptr<AsyncFlusher> result = std::make_shared<AsyncFlusher>();
+        return (result->init(stream) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Writing
+    /**
+     * Submits a buffer to be written in the background.
+     *
+     * If the previous write is still in progress, this method blocks until
+     * it completes.  The flusher takes ownership of the buffer until the next
+     * call to {@link wait} (or the next submission).  The caller must not
+     * modify or delete the buffer before then.
+     *
+     * @param buffer    The bytes to write
+     * @param amount    The number of bytes to write
+     * @param commit    Whether to commit the stream to the device afterwards
+     */
+    void submit(const char* buffer, size_t amount, bool commit=false);
+
+    /**
+     * Returns true if all writes since the last wait were successful.
+     *
+     * This method blocks until the pending write (if any) completes.  Once it
+     * returns, the caller has ownership of all submitted buffers again.
+     *
+     * @return true if all writes since the last wait were successful.
+     */
+    bool wait();
+
+    /**
+     * Returns true if the worker thread is writing a buffer.
+     *
+     * This value is only a snapshot, and may change immediately.
+     *
+     * @return true if the worker thread is writing a buffer.
+     */
+    bool isBusy();
+
+    /**
+     * Returns true if the stream was committed to the storage device.
+     *
+     * This flushes any buffering in the C library and asks the operating
+     * system to write the file to the device (fsync on POSIX platforms and
+     * FlushFileBuffers on Windows).  This guarantees that the data survives
+     * a crash or power failure, but it is very slow.  Streams that are not
+     * backed by a file are trivially committed.
+     *
+     * This method is synchronous.  To commit in the background, pass true to
+     * the commit argument of {@link submit}.
+     *
+     * @param stream    The SDL I/O stream to commit
+     *
+     * @return true if the stream was committed to the storage device.
+     */
+    static bool commit(SDL_RWops* stream);
+
+#pragma mark -
+#pragma mark Statistics
+    /**
+     * Returns the number of buffers submitted to this flusher.
+     *
+     * @return the number of buffers submitted to this flusher.
+     */
+    Uint64 getWrites() const { return _writes; }
+
+    /**
+     * Returns the number of times the writer blocked on a pending write.
+     *
+     * @return the number of times the writer blocked on a pending write.
+     */
+    Uint64 getStalls() const { return _stalls; }
+
+    /**
+     * Returns the total time the writer blocked on pending writes in ms.
+     *
+     * @return the total time the writer blocked on pending writes in ms.
+     */
+    double getStallTime() const { return _stalltime/1000.0; }
+
+    /**
+     * Returns the longest time the writer blocked on a pending write in ms.
+     *
+     * @return the longest time the writer blocked on a pending write in ms.
+     */
+    double getStallMaximum() const { return _maxstall/1000.0; }
+
+    /**
+     * Returns the given percentile of the stall durations in ms.
+     *
+     * The percentile is a value in [0,1] (so 0.99 is the 99th percentile).
+     * The stall durations are binned by powers of two, so this value is only
+     * an upper bound (clamped to the longest stall).  If there have been no
+     * stalls, this method returns 0.
+     *
+     * @param percentile    The percentile in [0,1]
+     *
+     * @return the given percentile of the stall durations in ms.
+     */
+    double getStallPercentile(float percentile) const;
+
+    /**
+     * Returns the number of stalls in the given histogram bin.
+     *
+     * Bin 0 holds stalls of less than 1 microsecond.  Bin k > 0 holds stalls
+     * of at least 2^(k-1) and less than 2^k microseconds.  The last bin holds
+     * all longer stalls.
+     *
+     * @param bin   The histogram bin
+     *
+     * @return the number of stalls in the given histogram bin.
+     */
+    Uint64 getStallHistogram(Uint32 bin) const {
+        return bin < FLUSHER_STALL_BINS ? _histogram[bin] : 0;
+    }
+
+    /**
+     * Resets all of the statistics of this flusher.
+     */
+    void resetStatistics();
+
+private:
+    /**
+     * Records a stall of the given duration.
+     *
+     * @param micros    The stall duration in microseconds
+     */
+    void record(Uint64 micros);
+
+    /**
+     * Blocks until the worker thread is idle.
+     *
+     * This method must be called with the mutex held.  It records a stall if
+     * it has to block.
+     *
+     * @param lock  The lock holding the mutex
+     */
+    void block(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Runs the worker thread, writing buffers as they are submitted.
+     */
+    void run();
+};
+
+}
+
+#endif /* __CU_ASYNC_FLUSHER_H__ */
@@ -17,6 +17,12 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A reader may also be memory mapped.  In that case, the file is never copied
+//  into a buffer.  Array reads convert directly from the mapping, and arrays
+//  in the host byte order may be viewed in place.  This is much faster for
+//  large files.  Mapping is not possible for every file (e.g. assets in an
+//  Android APK), in which case the reader falls back to buffered reads.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -76,6 +82,13 @@ namespace cugl {
  * for the file name.  Keep in mind that absolute paths are very dangerous on
  * mobile devices, because they do not have proper file systems.  You should
  * confine all files to either the asset or the save directory.
+ *
+ * A reader initialized with {@link initMapped} maps the file into memory
+ * instead of reading it in chunks.  The array reads then convert directly
+ * from the mapping (with vectorized byte swaps), and the {@link view} methods
+ * return arrays in the mapping without copying them.  As network order is
+ * not the host order on most platforms, typed views are only possible for
+ * files written in the host order (see {@link setByteOrder}).
  */
 class BinaryReader {
 protected:
@@ -97,18 +110,66 @@ protected:
     /** The current offset in the read buffer */
     Sint32      _bufoff;
     
+    /** The memory mapped file (or nullptr if the reader is buffered) */
+    char*       _mapping;
+    /** The size of the memory mapped file */
+    size_t      _mapsize;
+    /** The byte order of the file (SDL_BIG_ENDIAN or SDL_LIL_ENDIAN) */
+    int         _byteorder;
+    
 #pragma mark -
 #pragma mark Internal Methods
     /**
      * Fills the storage buffer to capacity
      *
      * This cuts down on the number of reads to the file by allowing us
-     * to read from the file in predefined chunks.
+     * to read from the file in predefined chunks.  If the file is memory
+     * mapped, the buffer is a window into the mapping, and this method
+     * simply slides the window forward.
      *
      * @param bytes The minimum number of bytes to ensure in the stream
      */
     void fill(unsigned int bytes=1);
     
+    /**
+     * Returns true if the file was successfully mapped into memory
+     *
+     * The file is the one specified by the current name.  If this method
+     * fails, the reader is unchanged.
+     *
+     * @return true if the file was successfully mapped into memory
+     */
+    bool map();
+    
+    /**
+     * Reads a sequence of elements of the given size from the stream.
+     *
+     * The bytes of each element are reversed if the file byte order is not
+     * the host byte order. This method returns the number of elements read.
+     *
+     * @param buffer    The array to store the data when read
+     * @param maximum   The maximum number of elements to read from the stream
+     * @param size      The number of bytes in a single element
+     *
+     * @return the number of elements read from the stream
+     */
+    size_t readArray(void* buffer, size_t maximum, unsigned int size);
+    
+    /**
+     * Views a sequence of elements of the given size in the memory mapping.
+     *
+     * This method returns 0 (and leaves data unchanged) if the stream is not
+     * mapped, if the elements need their bytes reversed, or if the current
+     * position is not aligned to the element size.
+     *
+     * @param data      The pointer to the viewed elements
+     * @param maximum   The maximum number of elements to view
+     * @param size      The number of bytes in a single element
+     *
+     * @return the number of elements viewed
+     */
+    size_t viewArray(const void** data, size_t maximum, unsigned int size);
+    
     
 #pragma mark -
 #pragma mark Constructors
@@ -120,7 +181,8 @@ public:
      * the heap, use one of the static constructors instead.
      */
     BinaryReader() : _name(""), _stream(nullptr), _ssize(-1), _scursor(-1),
-                     _buffer(nullptr), _capacity(0), _bufoff(-1), _bufsize(0) {}
+                     _buffer(nullptr), _capacity(0), _bufoff(-1), _bufsize(0),
+                     _mapping(nullptr), _mapsize(0), _byteorder(SDL_BIG_ENDIAN) {}
     
     /**
      * Deletes this reader and all of its resources.
@@ -297,6 +359,105 @@ public:
      */
     bool initWithAsset(const char* file, unsigned int capacity);
     
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * The file is mapped into memory, rather than read in chunks.  If the
+     * file cannot be mapped (e.g. it is empty, or the platform does not
+     * support it), the reader falls back to buffered reads with the default
+     * capacity.  Use {@link isMapped} to tell the two apart.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const std::string& file) {
+        return initMapped(Pathname(file));
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * The file is mapped into memory, rather than read in chunks.  If the
+     * file cannot be mapped (e.g. it is empty, or the platform does not
+     * support it), the reader falls back to buffered reads with the default
+     * capacity.  Use {@link isMapped} to tell the two apart.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const char* file) {
+        return initMapped(Pathname(file));
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * The file is mapped into memory, rather than read in chunks.  If the
+     * file cannot be mapped (e.g. it is empty, or the platform does not
+     * support it), the reader falls back to buffered reads with the default
+     * capacity.  Use {@link isMapped} to tell the two apart.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMapped(const Pathname& file);
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * The file is mapped into memory, rather than read in chunks.  If the
+     * file cannot be mapped (e.g. it is in an Android APK), the reader falls
+     * back to buffered reads with the default capacity.  Use {@link isMapped}
+     * to tell the two apart.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMappedWithAsset(const std::string& file) {
+        return initMappedWithAsset(file.c_str());
+    }
+    
+    /**
+     * Initializes a memory mapped reader for the given file.
+     *
+     * The file is mapped into memory, rather than read in chunks.  If the
+     * file cannot be mapped (e.g. it is in an Android APK), the reader falls
+     * back to buffered reads with the default capacity.  Use {@link isMapped}
+     * to tell the two apart.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initMappedWithAsset(const char* file);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -450,6 +611,86 @@ public:
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
     
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * If the file cannot be mapped (e.g. it is empty, or the platform does
+     * not support it), the reader falls back to buffered reads with the
+     * default capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMapped(const std::string& file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * If the file cannot be mapped (e.g. it is empty, or the platform does
+     * not support it), the reader falls back to buffered reads with the
+     * default capacity.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMapped(const char* file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMapped(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * If the file cannot be mapped (e.g. it is in an Android APK), the reader
+     * falls back to buffered reads with the default capacity.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMappedWithAsset(const std::string& file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMappedWithAsset(file) ? result : nullptr);
+    }
+    
+    /**
+     * Returns a newly allocated memory mapped reader for the given file.
+     *
+     * If the file cannot be mapped (e.g. it is in an Android APK), the reader
+     * falls back to buffered reads with the default capacity.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated memory mapped reader for the given file.
+     */
+    static std::shared_ptr<BinaryReader> allocMappedWithAsset(const char* file) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initMappedWithAsset(file) ? result : nullptr);
+    }
+    
     
 #pragma mark -
 #pragma mark Stream Management
@@ -481,6 +722,38 @@ public:
      */
     bool ready(unsigned int bytes=1) const;
     
+    /**
+     * Returns true if this reader is memory mapped.
+     *
+     * A memory mapped reader supports the {@link view} methods.
+     *
+     * @return true if this reader is memory mapped.
+     */
+    bool isMapped() const { return _mapping != nullptr; }
+    
+    /**
+     * Returns the byte order of the file.
+     *
+     * The value is either SDL_BIG_ENDIAN or SDL_LIL_ENDIAN.  By default, all
+     * files are in network (big-endian) order.
+     *
+     * @return the byte order of the file.
+     */
+    int getByteOrder() const { return _byteorder; }
+    
+    /**
+     * Sets the byte order of the file.
+     *
+     * The value must be either SDL_BIG_ENDIAN or SDL_LIL_ENDIAN.  By default,
+     * all files are in network (big-endian) order.  A file in the host byte
+     * order (SDL_BYTEORDER) needs no conversion, and so its arrays may be
+     * viewed without copying.  The order may be changed at any time, and
+     * affects all subsequent reads.
+     *
+     * @param order The byte order of the file.
+     */
+    void setByteOrder(int order);
+    
     
 #pragma mark -
 #pragma mark Single Element Reads
@@ -501,8 +774,9 @@ public:
     /**
      * Returns a single 16 bit signed integer from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single 16 bit signed integer from the stream
      */
@@ -511,8 +785,9 @@ public:
     /**
      * Returns a single 16 bit unsigned integer from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single 16 bit unsigned integer from the stream
      */
@@ -521,8 +796,9 @@ public:
     /**
      * Returns a single 32 bit signed integer from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single 32 bit signed integer from the stream
      */
@@ -531,8 +807,9 @@ public:
     /**
      * Returns a single 32 bit unsigned integer from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single 32 bit unsigned integer from the stream
      */
@@ -541,8 +818,9 @@ public:
     /**
      * Returns a single 32 bit signed integer from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single 32 bit signed integer from the stream
      */
@@ -551,8 +829,9 @@ public:
     /**
      * Returns a single 32 bit unsigned integer from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single 32 bit unsigned integer from the stream
      */
@@ -561,8 +840,9 @@ public:
     /**
      * Returns a single float from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single float from the stream
      */
@@ -571,8 +851,9 @@ public:
     /**
      * Returns a single double from the stream
      *
-     * The value is marshalled from network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @return a single double from the stream
      */
@@ -615,8 +896,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary 
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -632,8 +914,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -649,8 +932,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -666,8 +950,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -683,8 +968,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -700,8 +986,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -717,8 +1004,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -734,8 +1022,9 @@ public:
      * The function will attempt to read up to maximum number of elements.
      * It will return the actual number of elements read (which may be 0).
      *
-     * The values are marshalled from network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled from the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * @param buffer    The array to store the data when read
      * @param maximum   The maximum number of elements to read from the stream
@@ -743,7 +1032,217 @@ public:
      *
      * @return the number of doubles read from the stream
      */
-    size_t read(double* buffer, size_t maximum, size_t offset=0);
+    size_t read(double* buffer, size_t maximum, size_t offset=0);    
+    
+#pragma mark -
+#pragma mark Zero-Copy Views
+    /**
+     * Views a sequence of characters in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped.  Otherwise,
+     * it is always successful (provided that the stream is not finished).
+     *
+     * @param data      The pointer to the viewed characters
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of characters viewed
+     */
+    size_t view(const char*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 1);
+    }
+    
+    /**
+     * Views a sequence of bytes in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped.  Otherwise,
+     * it is always successful (provided that the stream is not finished).
+     *
+     * @param data      The pointer to the viewed bytes
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of bytes viewed
+     */
+    size_t view(const Uint8*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 1);
+    }
+    
+    /**
+     * Views a sequence of 16 bit signed integers in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed 16 bit signed integers
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of 16 bit signed integers viewed
+     */
+    size_t view(const Sint16*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 2);
+    }
+    
+    /**
+     * Views a sequence of 16 bit unsigned integers in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed 16 bit unsigned integers
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of 16 bit unsigned integers viewed
+     */
+    size_t view(const Uint16*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 2);
+    }
+    
+    /**
+     * Views a sequence of 32 bit signed integers in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed 32 bit signed integers
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of 32 bit signed integers viewed
+     */
+    size_t view(const Sint32*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 4);
+    }
+    
+    /**
+     * Views a sequence of 32 bit unsigned integers in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed 32 bit unsigned integers
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of 32 bit unsigned integers viewed
+     */
+    size_t view(const Uint32*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 4);
+    }
+    
+    /**
+     * Views a sequence of 64 bit signed integers in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed 64 bit signed integers
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of 64 bit signed integers viewed
+     */
+    size_t view(const Sint64*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 8);
+    }
+    
+    /**
+     * Views a sequence of 64 bit unsigned integers in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed 64 bit unsigned integers
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of 64 bit unsigned integers viewed
+     */
+    size_t view(const Uint64*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 8);
+    }
+    
+    /**
+     * Views a sequence of floats in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed floats
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of floats viewed
+     */
+    size_t view(const float*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 4);
+    }
+    
+    /**
+     * Views a sequence of doubles in the stream without copying them.
+     *
+     * On success, data points to the elements inside the memory mapping, and
+     * the stream advances past them.  The pointer is valid until the reader is
+     * closed or reset.  This method may view fewer than maximum elements,
+     * so large arrays may require several calls.
+     *
+     * This method returns 0 if the reader is not memory mapped, if the file
+     * byte order is not the host byte order, or if the current position is
+     * not aligned for this type.  In that case, use {@link read} instead.
+     *
+     * @param data      The pointer to the viewed doubles
+     * @param maximum   The maximum number of elements to view
+     *
+     * @return the number of doubles viewed
+     */
+    size_t view(const double*& data, size_t maximum) {
+        return viewArray((const void**)&data, maximum, 8);
+    }
 };
 
 }
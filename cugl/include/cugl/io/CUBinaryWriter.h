@@ -10,6 +10,10 @@
 //  long, etc.  Those types are NOT cross-platform.  For example, a long is
 //  8 bytes on Unix/OS X, but 4 bytes on Win32 platforms.
 //
+//  Arrays are converted a buffer at a time with vectorized byte swaps (see
+//  CUEndian.h).  Files may also be written in the host byte order, in which
+//  case arrays are copied without any conversion.
+//
 //  By default, this module (and every module in the io package) accesses the
 //  application save directory.  If you want to access another directory, you
 //  will need to specify an absolute path for the file name.  Keep in mind that
@@ -17,6 +21,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A writer may also be asynchronous.  An asynchronous writer is double
+//  buffered, and full buffers are written to the file on a background thread.
+//  This keeps large saves from stalling the game loop.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -55,7 +63,9 @@
 #include <cugl/base/CUBase.h>
 #include <SDL/SDL.h>
 #include <cugl/io/CUPathname.h>
+#include <cugl/io/CUAsyncFlusher.h>
 #include <string>
+#include <vector>
 
 namespace cugl {
     
@@ -76,6 +86,10 @@ namespace cugl {
  * for the file name.  Keep in mind that absolute paths are very dangerous on
  * mobile devices, because they do not have proper file systems.  You should
  * confine all files to either the asset or the save directory.
+ *
+ * Arrays are converted to the file byte order a buffer at a time (with
+ * vectorized byte swaps), or copied directly if the file is written in the
+ * host order (see {@link setByteOrder}).
  */
 class BinaryWriter {
 protected:
@@ -90,6 +104,27 @@ protected:
     Uint32      _capacity;
     /** The current offset in the writer buffer */
     Sint32      _bufoff;
+    /** The spare buffer, filled while the other one is written (async only) */
+    char*       _sbuffer;
+    /** The background thread for writing full buffers (async only) */
+    std::shared_ptr<AsyncFlusher> _flusher;
+    /** The byte order of the file (SDL_BIG_ENDIAN or SDL_LIL_ENDIAN) */
+    int         _byteorder;
+    
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Writes a sequence of elements of the given size to the stream.
+     *
+     * The bytes of each element are reversed if the file byte order is not
+     * the host byte order.  The elements are converted a buffer at a time,
+     * so there is no per-element work beyond the conversion itself.
+     *
+     * @param array     The array of elements to write
+     * @param length    The number of elements to write
+     * @param size      The number of bytes in a single element
+     */
+    void writeArray(const void* array, size_t length, unsigned int size);
 
     
 #pragma mark -
@@ -101,7 +136,8 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
      * the heap, use one of the static constructors instead.
      */
-    BinaryWriter() : _name(""), _stream(nullptr), _cbuffer(nullptr), _bufoff(-1) {}
+    BinaryWriter() : _name(""), _stream(nullptr), _cbuffer(nullptr), _bufoff(-1), _sbuffer(nullptr),
+                     _byteorder(SDL_BIG_ENDIAN) {}
     
     /**
      * Deletes this writer and all of its resources.
@@ -219,6 +255,140 @@ public:
      * @return true if the writer is initialized properly, false otherwise.
      */
     bool init(const Pathname& file, unsigned int capacity);
+
+    /**
+     * Initializes an asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const std::string& file) {
+        return initAsync(Pathname(file));
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const char* file) {
+        return initAsync(Pathname(file));
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const Pathname& file);
+
+    /**
+     * Initializes an asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const std::string& file, unsigned int capacity) {
+        return initAsync(Pathname(file),capacity);
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const char* file, unsigned int capacity) {
+        return initAsync(Pathname(file),capacity);
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const Pathname& file, unsigned int capacity);
     
     
 #pragma mark -
@@ -342,26 +512,267 @@ public:
         std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
         return (result->init(file,capacity) ? result : nullptr);
     }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated asynchronous writer for the given file.
+     */
+    static std::shared_ptr<BinaryWriter> allocAsync(const std::string& file) {
+        std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
+        return (result->initAsync(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated asynchronous writer for the given file.
+     */
+    static std::shared_ptr<BinaryWriter> allocAsync(const char* file) {
+        std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
+        return (result->initAsync(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated asynchronous writer for the given file.
+     */
+    static std::shared_ptr<BinaryWriter> allocAsync(const Pathname& file) {
+        std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
+        return (result->initAsync(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return a newly allocated asynchronous writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<BinaryWriter> allocAsync(const std::string& file, unsigned int capacity) {
+        std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
+        return (result->initAsync(file,capacity) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return a newly allocated asynchronous writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<BinaryWriter> allocAsync(const char* file, unsigned int capacity) {
+        std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
+        return (result->initAsync(file,capacity) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return a newly allocated asynchronous writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<BinaryWriter> allocAsync(const Pathname& file, unsigned int capacity) {
+        std::shared_ptr<BinaryWriter> result = std::make_shared<BinaryWriter>();
+        return (result->initAsync(file,capacity) ? result : nullptr);
+    }
     
     
 #pragma mark -
 #pragma mark Stream Management
+    /**
+     * Returns true if this writer flushes its buffers in the background.
+     *
+     * @return true if this writer flushes its buffers in the background.
+     */
+    bool isAsync() const { return _flusher != nullptr; }
+
+    /**
+     * Returns the byte order of the file.
+     *
+     * The value is either SDL_BIG_ENDIAN or SDL_LIL_ENDIAN.  By default, all
+     * files are in network (big-endian) order.
+     *
+     * @return the byte order of the file.
+     */
+    int getByteOrder() const { return _byteorder; }
+
+    /**
+     * Sets the byte order of the file.
+     *
+     * The value must be either SDL_BIG_ENDIAN or SDL_LIL_ENDIAN.  By default,
+     * all files are in network (big-endian) order.  Writing a file in the host
+     * byte order (SDL_BYTEORDER) needs no conversion, so arrays are copied
+     * directly.  The order may be changed at any time, and affects all
+     * subsequent writes.
+     *
+     * @param order The byte order of the file.
+     */
+    void setByteOrder(int order);
+
     /**
      * Flushes the contents of the write buffer to the file.
      *
      * It is usually unnecessary to call this method. It is called automatically
      * when the buffer fills, or just before the file is closed.
+     *
+     * If this writer is asynchronous, the buffer is handed to the background
+     * thread and this method returns immediately (unless the previous buffer
+     * is still being written).  The data is not guaranteed to be in the file
+     * until a call to {@link sync} or {@link close}.
      */
     void flush();
-    
+
+    /**
+     * Returns true if all data written so far is safely on the storage device.
+     *
+     * This method flushes the buffer and waits for any background writes to
+     * complete.  It then commits the file to the device (e.g. fsync), so that
+     * the data survives a crash or power failure.  This is slow, and should
+     * only be used at important save points.
+     *
+     * @return true if all data written so far is safely on the storage device.
+     */
+    bool sync();
+
     /**
      * Closes the stream, releasing all resources
      *
      * The contents of the buffer are flushed before the file is closed.  Any
      * attempts to write to a closed stream will fail.  Calling this method
      * on a previously closed stream has no effect.
+     *
+     * If this writer is asynchronous, this method blocks until all background
+     * writes are complete.  The return value reports whether every write to
+     * the file (including those in the background) was successful.
+     *
+     * @return true if all data was successfully written to the file
+     */
+    bool close();
+
+
+#pragma mark -
+#pragma mark Write Statistics
+    /**
+     * Returns the number of times that a flush blocked on a background write.
+     *
+     * A flush (or close) stalls if the writer fills a buffer before the
+     * previous one has been written.  Synchronous writers never stall, as
+     * they always block.  These statistics are reset when the writer is
+     * initialized.
+     *
+     * @return the number of times that a flush blocked on a background write.
+     */
+    Uint64 getStalls() const { return _flusher ? _flusher->getStalls() : 0; }
+
+    /**
+     * Returns the total time spent blocked on background writes in ms.
+     *
+     * @return the total time spent blocked on background writes in ms.
+     */
+    double getStallTime() const { return _flusher ? _flusher->getStallTime() : 0; }
+
+    /**
+     * Returns the longest time spent blocked on a background write in ms.
+     *
+     * @return the longest time spent blocked on a background write in ms.
+     */
+    double getStallMaximum() const { return _flusher ? _flusher->getStallMaximum() : 0; }
+
+    /**
+     * Returns the given percentile of the stall durations in ms.
+     *
+     * The percentile is a value in [0,1] (so 0.99 is the 99th percentile).
+     * The stall durations are kept in a histogram with power of two bins, so
+     * this value is only an upper bound.
+     *
+     * @param percentile    The percentile in [0,1]
+     *
+     * @return the given percentile of the stall durations in ms.
      */
-    void close();
+    double getStallPercentile(float percentile) const {
+        return _flusher ? _flusher->getStallPercentile(percentile) : 0;
+    }
 
 
 #pragma mark -
@@ -391,8 +802,9 @@ public:
     /**
      * Writes a single 16 bit signed integer to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -405,8 +817,9 @@ public:
     /**
      * Writes a single 16 bit unsigned integer to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -419,8 +832,9 @@ public:
     /**
      * Writes a single 32 bit signed integer to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -433,8 +847,9 @@ public:
     /**
      * Writes a single 32 bit unsigned integer to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -447,8 +862,9 @@ public:
     /**
      * Writes a single 64 bit signed integer to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -461,8 +877,9 @@ public:
     /**
      * Writes a single 64 bit unsigned integer to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -475,8 +892,9 @@ public:
     /**
      * Writes a float to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -489,8 +907,9 @@ public:
     /**
      * Writes a double to the binary file.
      *
-     * The value is marshalled to network order, ensuring that the binary file
-     * is compatible against all platforms.
+     * The value is marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The value is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -532,8 +951,9 @@ public:
     /**
      * Writes an array of 16 bit signed integers to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -548,8 +968,9 @@ public:
     /**
      * Writes an array of 16 bit unsigned integers to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -564,8 +985,9 @@ public:
     /**
      * Writes an array of 32 bit signed integers to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -580,8 +1002,9 @@ public:
     /**
      * Writes an array of 32 bit unsigned integers to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -596,8 +1019,9 @@ public:
     /**
      * Writes an array of 64 bit signed integers to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -612,8 +1036,9 @@ public:
     /**
      * Writes an array of 64 bit unsigned integers to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -628,8 +1053,9 @@ public:
     /**
      * Writes an array of floats to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -644,8 +1070,9 @@ public:
     /**
      * Writes an array of doubles to the binary file.
      *
-     * The values are marshalled to network order, ensuring that the binary
-     * file is compatible against all platforms.
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
      *
      * The array is written to the internal buffer, but is not necessarily
      * flushed automatically.  It will be written when the buffer reaches
@@ -656,7 +1083,152 @@ public:
      * @param offset the initial offset into the array
      */
     void write(const double* array, size_t length, size_t offset=0);
-    
+
+#pragma mark -
+#pragma mark Vector Writes
+
+    /**
+     * Writes a vector of characters to the binary file.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of characters to write
+     */
+    void write(const std::vector<char>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of bytes to the binary file.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of bytes to write
+     */
+    void write(const std::vector<Uint8>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of 16 bit signed integers to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of 16 bit signed integers to write
+     */
+    void write(const std::vector<Sint16>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of 16 bit unsigned integers to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of 16 bit unsigned integers to write
+     */
+    void write(const std::vector<Uint16>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of 32 bit signed integers to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of 32 bit signed integers to write
+     */
+    void write(const std::vector<Sint32>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of 32 bit unsigned integers to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of 32 bit unsigned integers to write
+     */
+    void write(const std::vector<Uint32>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of 64 bit signed integers to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of 64 bit signed integers to write
+     */
+    void write(const std::vector<Sint64>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of 64 bit unsigned integers to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of 64 bit unsigned integers to write
+     */
+    void write(const std::vector<Uint64>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of floats to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of floats to write
+     */
+    void write(const std::vector<float>& data) { write(data.data(), data.size()); }
+
+    /**
+     * Writes a vector of doubles to the binary file.
+     *
+     * The values are marshalled to the file byte order (network order by
+     * default), ensuring that the binary file is compatible against all
+     * platforms.
+     *
+     * The vector is written to the internal buffer, but is not necessarily
+     * flushed automatically.  It will be written when the buffer reaches
+     * capacity or the file is closed.
+     *
+     * @param data the vector of doubles to write
+     */
+    void write(const std::vector<double>& data) { write(data.data(), data.size()); }
+
 };
 
 }
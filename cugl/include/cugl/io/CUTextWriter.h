@@ -13,6 +13,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A writer may also be asynchronous.  An asynchronous writer is double
+//  buffered, and full buffers are written to the file on a background thread.
+//  This keeps large saves from stalling the game loop.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -51,6 +55,7 @@
 #include <cugl/base/CUBase.h>
 #include <cugl/util/CUStrings.h>
 #include <cugl/io/CUPathname.h>
+#include <cugl/io/CUAsyncFlusher.h>
 #include <SDL/SDL.h>
 #include <string>
 
@@ -83,6 +88,10 @@ protected:
     Uint32      _capacity;
     /** The current offset in the writer buffer */
     Sint32      _bufoff;
+    /** The spare buffer, filled while the other one is written (async only) */
+    char*       _sbuffer;
+    /** The background thread for writing full buffers (async only) */
+    std::shared_ptr<AsyncFlusher> _flusher;
     
 #pragma mark -
 #pragma mark Constructors
@@ -93,7 +102,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
      * the heap, use one of the static constructors instead.
      */
-    TextWriter() : _name(""), _stream(nullptr), _cbuffer(nullptr), _bufoff(-1) {}
+    TextWriter() : _name(""), _stream(nullptr), _cbuffer(nullptr), _bufoff(-1), _sbuffer(nullptr) {}
 
     /**
      * Deletes this writer and all of its resources.
@@ -212,6 +221,140 @@ public:
      * @return true if the writer is initialized properly, false otherwise.
      */
     bool init(const Pathname& file, unsigned int capacity);
+
+    /**
+     * Initializes an asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const std::string& file) {
+        return initAsync(Pathname(file));
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const char* file) {
+        return initAsync(Pathname(file));
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const Pathname& file);
+
+    /**
+     * Initializes an asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const std::string& file, unsigned int capacity) {
+        return initAsync(Pathname(file),capacity);
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const char* file, unsigned int capacity) {
+        return initAsync(Pathname(file),capacity);
+    }
+
+    /**
+     * Initializes an asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool initAsync(const Pathname& file, unsigned int capacity);
     
     
 #pragma mark -
@@ -335,26 +478,244 @@ public:
         std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
         return (result->init(file,capacity) ? result : nullptr);
     }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated asynchronous writer for the given file.
+     */
+    static std::shared_ptr<TextWriter> allocAsync(const std::string& file) {
+        std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
+        return (result->initAsync(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated asynchronous writer for the given file.
+     */
+    static std::shared_ptr<TextWriter> allocAsync(const char* file) {
+        std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
+        return (result->initAsync(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * Each buffer will have the default capacity for writing chunks to the
+     * file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated asynchronous writer for the given file.
+     */
+    static std::shared_ptr<TextWriter> allocAsync(const Pathname& file) {
+        std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
+        return (result->initAsync(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return a newly allocated asynchronous writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<TextWriter> allocAsync(const std::string& file, unsigned int capacity) {
+        std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
+        return (result->initAsync(file,capacity) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return a newly allocated asynchronous writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<TextWriter> allocAsync(const char* file, unsigned int capacity) {
+        std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
+        return (result->initAsync(file,capacity) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated asynchronous writer for the given file with the specified capacity.
+     *
+     * The writer is double buffered.  Writes fill one buffer while a
+     * background thread writes the other buffer to the file.  Hence a flush
+     * only blocks if the previous buffer has not been written yet.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file      the path (absolute or relative) to the file
+     * @param capacity  the capacity of each buffer
+     *
+     * @return a newly allocated asynchronous writer for the given file with the specified capacity.
+     */
+    static std::shared_ptr<TextWriter> allocAsync(const Pathname& file, unsigned int capacity) {
+        std::shared_ptr<TextWriter> result = std::make_shared<TextWriter>();
+        return (result->initAsync(file,capacity) ? result : nullptr);
+    }
     
     
 #pragma mark -
 #pragma mark Stream Management
+    /**
+     * Returns true if this writer flushes its buffers in the background.
+     *
+     * @return true if this writer flushes its buffers in the background.
+     */
+    bool isAsync() const { return _flusher != nullptr; }
+
     /**
      * Flushes the contents of the write buffer to the file.
      *
      * It is usually unnecessary to call this method. It is called automatically
      * when the buffer fills, or just before the file is closed.
+     *
+     * If this writer is asynchronous, the buffer is handed to the background
+     * thread and this method returns immediately (unless the previous buffer
+     * is still being written).  The data is not guaranteed to be in the file
+     * until a call to {@link sync} or {@link close}.
      */
     void flush();
-    
+
+    /**
+     * Returns true if all data written so far is safely on the storage device.
+     *
+     * This method flushes the buffer and waits for any background writes to
+     * complete.  It then commits the file to the device (e.g. fsync), so that
+     * the data survives a crash or power failure.  This is slow, and should
+     * only be used at important save points.
+     *
+     * @return true if all data written so far is safely on the storage device.
+     */
+    bool sync();
+
     /**
      * Closes the stream, releasing all resources
      *
-     * The contents of the buffer are flushed before the file is closed.  Any 
+     * The contents of the buffer are flushed before the file is closed.  Any
      * attempts to write to a closed stream will fail.  Calling this method
      * on a previously closed stream has no effect.
+     *
+     * If this writer is asynchronous, this method blocks until all background
+     * writes are complete.  The return value reports whether every write to
+     * the file (including those in the background) was successful.
+     *
+     * @return true if all data was successfully written to the file
+     */
+    bool close();
+
+
+#pragma mark -
+#pragma mark Write Statistics
+    /**
+     * Returns the number of times that a flush blocked on a background write.
+     *
+     * A flush (or close) stalls if the writer fills a buffer before the
+     * previous one has been written.  Synchronous writers never stall, as
+     * they always block.  These statistics are reset when the writer is
+     * initialized.
+     *
+     * @return the number of times that a flush blocked on a background write.
      */
-    void close();
+    Uint64 getStalls() const { return _flusher ? _flusher->getStalls() : 0; }
+
+    /**
+     * Returns the total time spent blocked on background writes in ms.
+     *
+     * @return the total time spent blocked on background writes in ms.
+     */
+    double getStallTime() const { return _flusher ? _flusher->getStallTime() : 0; }
+
+    /**
+     * Returns the longest time spent blocked on a background write in ms.
+     *
+     * @return the longest time spent blocked on a background write in ms.
+     */
+    double getStallMaximum() const { return _flusher ? _flusher->getStallMaximum() : 0; }
+
+    /**
+     * Returns the given percentile of the stall durations in ms.
+     *
+     * The percentile is a value in [0,1] (so 0.99 is the 99th percentile).
+     * The stall durations are kept in a histogram with power of two bins, so
+     * this value is only an upper bound.
+     *
+     * @param percentile    The percentile in [0,1]
+     *
+     * @return the given percentile of the stall durations in ms.
+     */
+    double getStallPercentile(float percentile) const {
+        return _flusher ? _flusher->getStallPercentile(percentile) : 0;
+    }
 
 
 #pragma mark -
@@ -517,8 +878,10 @@ public:
      * Writes a string (ASCII or UTF8) to the file, followed by a newline
      *
      * The newline used is a standard Unix newline '\n'. You should not expect
-     * Windows-style carriage returns (e.g. '\r'). This method automatically
-     * flushes the buffer when done.
+     * Windows-style carriage returns (e.g. '\r'). A synchronous writer
+     * automatically flushes the buffer when done.  An asynchronous writer
+     * only flushes when the buffer fills (or on {@link sync} or {@link close}),
+     * so that each line is not a separate background write.
      *
      * @param s  the string to write
      */
@@ -528,8 +891,10 @@ public:
      * Writes a string (ASCII or UTF8) to the file, followed by a newline
      *
      * The newline used is a standard Unix newline '\n'. You should not expect
-     * Windows-style carriage returns (e.g. '\r'). This method automatically
-     * flushes the buffer when done.
+     * Windows-style carriage returns (e.g. '\r'). A synchronous writer
+     * automatically flushes the buffer when done.  An asynchronous writer
+     * only flushes when the buffer fills (or on {@link sync} or {@link close}),
+     * so that each line is not a separate background write.
      *
      * @param s  the string to write
      */
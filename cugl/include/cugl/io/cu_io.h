@@ -29,6 +29,7 @@
 #define __CU_IO_PKG_H__
 
 #include "CUPathname.h"
+#include "CUAsyncFlusher.h"
 #include "CUTextReader.h"
 #include "CUTextWriter.h"
 #include "CUJsonReader.h"
@@ -822,6 +822,25 @@ public:
      * @return A reference to dst for chaining
      */
     static Rect* transform(const Affine2& aff, const Rect& rect, Rect* dst);
+
+    /**
+     * Transforms the array of points and stores the result in output.
+     *
+     * The output array must have room for size elements.  It is safe for
+     * output to be the same as input (to transform the points in place),
+     * but the arrays may not otherwise overlap.
+     *
+     * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+     * than transforming the points one at a time.
+     *
+     * @param aff       The affine transform.
+     * @param input     The points to transform.
+     * @param size      The number of points to transform.
+     * @param output    The array to store the transformed points.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Affine2& aff, const Vec2* input, size_t size, Vec2* output);
     
     /**
      * Returns a copy of the given point transformed.
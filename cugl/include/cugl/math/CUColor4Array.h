@@ -0,0 +1,403 @@
+//
+//  CUColor4Array.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for a structure-of-arrays collection of
+//  colors.  It is the companion to Vec2Array, and is intended for particle
+//  systems and procedural meshes that fade or tint thousands of vertices each
+//  frame.  The color channels are stored as floats in separate arrays, so that
+//  the bulk operations can process 4 (SSE2, NEON) or 8 (AVX2) colors at once.
+//
+//  The instruction set is chosen at runtime the first time that a bulk
+//  operation is used.  The results are the same as the Color4f methods.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#ifndef __CU_COLOR4_ARRAY_H__
+#define __CU_COLOR4_ARRAY_H__
+
+#include <vector>
+#include "CUMathBase.h"
+#include "CUColor4.h"
+
+namespace cugl {
+
+// Forward references
+class Vertex2;
+
+/**
+ * This class is a structure-of-arrays collection of colors.
+ *
+ * The colors are stored as floats (like {@link Color4f}), with each channel
+ * in a separate array.  Individual elements may be accessed with {@link get}
+ * and {@link set}, but this class is intended for bulk operations which apply
+ * to every element at once.  These bulk operations are vectorized, choosing
+ * between SSE2, AVX2 and NEON at runtime.  The result of each bulk operation
+ * is the same as calling the corresponding {@link Color4f} method on each
+ * element.  In particular, most operations clamp the channels to [0,1] and
+ * leave the alpha channel alone unless asked.
+ *
+ * Bulk operations that combine two arrays require that the arrays have the
+ * same size.  It is safe for an array to be combined with itself.
+ *
+ * When it is time to draw, the method {@link pack} converts the colors to
+ * bytes and copies them into an array-of-structures format, such as the
+ * colors of a mesh of {@link Vertex2} objects.
+ */
+class Color4Array {
+private:
+    /** The red channel */
+    std::vector<float> _r;
+    /** The green channel */
+    std::vector<float> _g;
+    /** The blue channel */
+    std::vector<float> _b;
+    /** The alpha channel */
+    std::vector<float> _a;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty array of colors.
+     */
+    Color4Array() {}
+
+    /**
+     * Creates an array of size colors, all initialized to clear.
+     *
+     * @param size  The number of colors
+     */
+    Color4Array(size_t size) : _r(size,0.0f), _g(size,0.0f), _b(size,0.0f), _a(size,0.0f) {}
+
+    /**
+     * Creates an array with a copy of the given colors.
+     *
+     * @param colors    The colors to copy
+     */
+    Color4Array(const std::vector<Color4f>& colors) { set(colors.data(),colors.size()); }
+
+    /**
+     * Creates an array with a copy of the given colors.
+     *
+     * The colors are converted to floats in the range [0,1].
+     *
+     * @param colors    The colors to copy
+     */
+    Color4Array(const std::vector<Color4>& colors) { set(colors.data(),colors.size()); }
+
+    /**
+     * Deletes this array, releasing all resources.
+     */
+    ~Color4Array() {}
+
+
+#pragma mark Setters
+    /**
+     * Sets this array to a copy of the given colors.
+     *
+     * @param colors    The colors to copy
+     * @param size      The number of colors to copy
+     *
+     * @return This array, after assignment
+     */
+    Color4Array& set(const Color4f* colors, size_t size);
+
+    /**
+     * Sets this array to a copy of the given colors.
+     *
+     * The colors are converted to floats in the range [0,1].
+     *
+     * @param colors    The colors to copy
+     * @param size      The number of colors to copy
+     *
+     * @return This array, after assignment
+     */
+    Color4Array& set(const Color4* colors, size_t size);
+
+    /**
+     * Sets every element of this array to the given color.
+     *
+     * The size of this array is unchanged.
+     *
+     * @param c     The color value
+     *
+     * @return This array, after assignment
+     */
+    Color4Array& fill(const Color4f& c);
+
+
+#pragma mark Element Access
+    /**
+     * Returns the number of colors in this array.
+     *
+     * @return the number of colors in this array.
+     */
+    size_t size() const { return _r.size(); }
+
+    /**
+     * Returns true if this array is empty.
+     *
+     * @return true if this array is empty.
+     */
+    bool empty() const { return _r.empty(); }
+
+    /**
+     * Resizes this array to hold size colors.
+     *
+     * New colors are initialized to clear.
+     *
+     * @param size  The new number of colors
+     */
+    void resize(size_t size);
+
+    /**
+     * Reserves room for at least capacity colors.
+     *
+     * @param capacity  The number of colors to reserve
+     */
+    void reserve(size_t capacity);
+
+    /**
+     * Removes all colors from this array.
+     */
+    void clear();
+
+    /**
+     * Appends a color to the end of this array.
+     *
+     * @param c     The color to append
+     */
+    void push_back(const Color4f& c) {
+        _r.push_back(c.r); _g.push_back(c.g); _b.push_back(c.b); _a.push_back(c.a);
+    }
+
+    /**
+     * Removes the element at the given position, replacing it with the last.
+     *
+     * This is the standard way to kill a particle in O(1) time.  It does not
+     * preserve the order of the elements.
+     *
+     * @param index The position to remove
+     */
+    void swapRemove(size_t index);
+
+    /**
+     * Returns the color at the given position.
+     *
+     * @param index The color position
+     *
+     * @return the color at the given position.
+     */
+    Color4f get(size_t index) const {
+        return Color4f(_r[index],_g[index],_b[index],_a[index]);
+    }
+
+    /**
+     * Sets the color at the given position.
+     *
+     * @param index The color position
+     * @param c     The color value
+     */
+    void set(size_t index, const Color4f& c) {
+        _r[index] = c.r; _g[index] = c.g; _b[index] = c.b; _a[index] = c.a;
+    }
+
+    /**
+     * Returns the array of red values.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of red values.
+     */
+    float* getRed() { return _r.data(); }
+
+    /**
+     * Returns the array of green values.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of green values.
+     */
+    float* getGreen() { return _g.data(); }
+
+    /**
+     * Returns the array of blue values.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of blue values.
+     */
+    float* getBlue() { return _b.data(); }
+
+    /**
+     * Returns the array of alpha values.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of alpha values.
+     */
+    float* getAlpha() { return _a.data(); }
+
+
+#pragma mark Arithmetic
+    /**
+     * Adds the given color to every element of this array.
+     *
+     * The channels are clamped to [0,1].  Alpha is only added if the
+     * parameter alpha is true.
+     *
+     * @param c         The color to add
+     * @param alpha     Whether to add the alpha value
+     *
+     * @return This array, after the addition
+     */
+    Color4Array& add(const Color4f& c, bool alpha = false);
+
+    /**
+     * Adds the elements of the given array to this one.
+     *
+     * The channels are clamped to [0,1].  Alpha is only added if the
+     * parameter alpha is true.  The arrays must be the same size.
+     *
+     * @param other     The array to add
+     * @param alpha     Whether to add the alpha values
+     *
+     * @return This array, after the addition
+     */
+    Color4Array& add(const Color4Array& other, bool alpha = false);
+
+    /**
+     * Subtracts the given color from every element of this array.
+     *
+     * The channels are clamped to [0,1].  Alpha is only subtracted if the
+     * parameter alpha is true.
+     *
+     * @param c         The color to subtract
+     * @param alpha     Whether to subtract the alpha value
+     *
+     * @return This array, after the subtraction
+     */
+    Color4Array& subtract(const Color4f& c, bool alpha = false);
+
+    /**
+     * Scales every element of this array uniformly by s.
+     *
+     * The channels are clamped to [0,1].  Alpha is only scaled if the
+     * parameter alpha is true.  Scaling alpha alone is the standard way
+     * to fade particles.
+     *
+     * @param s         The scale factor
+     * @param alpha     Whether to scale the alpha value
+     *
+     * @return This array, after the scaling
+     */
+    Color4Array& scale(float s, bool alpha = false);
+
+    /**
+     * Tints every element of this array by the given color.
+     *
+     * This is the component-wise product.  Alpha is only tinted if the
+     * parameter alpha is true.
+     *
+     * @param c         The color to tint by
+     * @param alpha     Whether to tint the alpha value
+     *
+     * @return This array, after the tinting
+     */
+    Color4Array& scale(const Color4f& c, bool alpha = false);
+
+    /**
+     * Clamps every element of this array to the given range.
+     *
+     * @param min   The minimum value
+     * @param max   The maximum value
+     *
+     * @return This array, after the clamping
+     */
+    Color4Array& clamp(const Color4f& min, const Color4f& max);
+
+    /**
+     * Linearly interpolates every element of this array with the other.
+     *
+     * If alpha is 0, the elements are unchanged.  If alpha is 1, the elements
+     * are the elements of other.  If alpha is outside of the range 0 to 1, it
+     * is clamped to the nearest value.  The arrays must be the same size.
+     *
+     * @param other The other end of the line segment
+     * @param alpha The interpolation value
+     *
+     * @return This array, after the interpolation
+     */
+    Color4Array& lerp(const Color4Array& other, float alpha);
+
+    /**
+     * Premultiplies every element of this array with its alpha.
+     *
+     * This class does not store whether the colors are already premultiplied.
+     * Hence premultiplying twice will have a compounding effect.
+     *
+     * @return This array, after premultiplication
+     */
+    Color4Array& premultiply();
+
+
+#pragma mark Conversion
+    /**
+     * Copies this array into the given array of colors.
+     *
+     * The channels are clamped to [0,1] and converted to bytes.  The output
+     * array must have room for {@link size} elements.
+     *
+     * @param output    The array to store the colors
+     *
+     * @return A reference to output for chaining
+     */
+    Color4* pack(Color4* output) const;
+
+    /**
+     * Copies this array into the colors of the given vertices.
+     *
+     * Only the vertex colors are modified.  The channels are clamped to
+     * [0,1] and converted to bytes.  The output array must have room for
+     * {@link size} elements.
+     *
+     * @param output    The vertices to store the colors
+     *
+     * @return A reference to output for chaining
+     */
+    Vertex2* pack(Vertex2* output) const;
+
+    /**
+     * Returns this array as a vector of Color4 objects.
+     *
+     * @return this array as a vector of Color4 objects.
+     */
+    operator std::vector<Color4>() const;
+};
+
+}
+
+#endif /* __CU_COLOR4_ARRAY_H__ */
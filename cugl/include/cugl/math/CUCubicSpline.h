@@ -48,6 +48,7 @@
 namespace cugl {
 
 class Polynomial;
+template <int D> class FixedPolynomial;
 
 /**
  * This class represents a spline of cubic beziers.
@@ -823,7 +824,7 @@ protected:
      * @param  point    the point to project
      * @param  segment  the bezier segment to project upon
      */
-    Polynomial getProjectionPolynomial(const Vec2& point, int segment) const;
+    FixedPolynomial<5> getProjectionPolynomial(const Vec2& point, int segment) const;
     
     /**
      * Returns the parameterization of the nearest point on the bezier segment.
@@ -834,8 +835,9 @@ protected:
      * This version does not use the projection polynomial.  Instead, it picks
      * a parameter resolution and walks the entire length of the curve.  The
      * result is both slow and inexact (as the actual point may be in-between
-     * chose parameters). This version is only picked when getProjectionFast
-     * fails because of an error with root finding.
+     * chose parameters). This version is no longer used by nearestParameter,
+     * as the root finder of getProjectionFast cannot fail.  It is kept as a
+     * reference for the accuracy of that method.
      *
      * The value returned is a pair of the parameter, and its distance value.
      * This allows us to compare this result to other segments, picking the
@@ -865,9 +867,9 @@ protected:
      * best value for the entire spline.
      *
      * This algorithm uses the projection polynomial, and searches for roots to
-     * find the best (max of 5) candidates.  However, root finding may fail,
-     * do to singularities in Bairstow's Method.  If the root finder fails, then
-     * the first element of the pair will be -1 (an invalid parameter).
+     * find the best (max of 5) candidates.  The roots are found with
+     * {@link QuinticPolynomial}, which does not allocate memory and cannot
+     * fail (unlike the Bairstow's Method of {@link Polynomial}).
      *
      * @param  point    the point to project
      * @param  segment  the bezier segment to project upon
@@ -0,0 +1,298 @@
+//
+//  CUFixedPolynomial.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a polynomial whose degree is fixed at compile time.
+//  Unlike Polynomial, it does not allocate any memory, and its root finder
+//  cannot fail.  The primary purpose of this class is to support the
+//  projection queries of CubicSpline, which solve a quintic for every
+//  segment.  However, we provide it publicly in case it is useful for other
+//  applications.
+//
+//  The batch evaluation methods are vectorized with SSE (or AVX2, if it is
+//  enabled by the compiler).
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#ifndef __CU_FIXED_POLYNOMIAL_H__
+#define __CU_FIXED_POLYNOMIAL_H__
+
+#include "CUMathBase.h"
+#include "CUPolynomial.h"
+#include "../util/CUDebug.h"
+#include <cstddef>
+
+namespace cugl {
+
+/**
+ * This class represents a polynomial of a fixed degree D.
+ *
+ * The coefficients are stored from highest degree to constant, just as in
+ * {@link Polynomial}.  For example, the cubic with coefficients [1, -1, 2, -3]
+ * is equivalent to
+ *
+ *    1*x^3  - 1*x^2  + 2*x - 3
+ *
+ * Unlike Polynomial, the leading coefficient may be zero.  In that case, the
+ * polynomial is treated as one of smaller degree.
+ *
+ * The method {@link roots} finds the real roots in an interval.  Linear and
+ * quadratic polynomials are solved in closed form.  Higher degrees find the
+ * roots of the derivative first (recursively, as the degree is known at
+ * compile time).  These critical points divide the interval into pieces on
+ * which the polynomial is monotone, so each piece has at most one root.  That
+ * root is found with a safeguarded Newton-bisection hybrid.  Unlike the
+ * Bairstow method of Polynomial, this method cannot fail, and it does not
+ * allocate any memory.  All computation is done in double precision.
+ *
+ * This class is implemented for the degrees 1 through 5.  The most common
+ * degrees have the type names {@link CubicPolynomial} and
+ * {@link QuinticPolynomial}.
+ */
+template <int D>
+class FixedPolynomial {
+public:
+    /** The coefficients, from highest degree to constant */
+    float c[D+1];
+
+#pragma mark Constructors
+    /**
+     * Creates a zero polynomial
+     */
+    FixedPolynomial() {
+        for(int ii = 0; ii <= D; ii++) { c[ii] = 0; }
+    }
+
+    /**
+     * Creates a polynomial with the given coefficients.
+     *
+     * The array must have D+1 elements, from highest degree to constant.
+     *
+     * @param coeffs    The polynomial coefficients
+     */
+    FixedPolynomial(const float* coeffs) {
+        for(int ii = 0; ii <= D; ii++) { c[ii] = coeffs[ii]; }
+    }
+
+    /**
+     * Creates a copy of the given polynomial.
+     *
+     * The polynomial may not have degree greater than D.  If it has smaller
+     * degree, the leading coefficients are 0.
+     *
+     * @param poly      The polynomial to copy
+     */
+    FixedPolynomial(const Polynomial& poly) {
+        CUAssertLog(poly.degree() <= D, "Polynomial has degree greater than %d", D);
+        int offset = D-(int)poly.degree();
+        for(int ii = 0; ii <= D; ii++) {
+            c[ii] = ii < offset ? 0 : poly[ii-offset];
+        }
+    }
+
+    /**
+     * Returns the degree of this polynomial type.
+     *
+     * The actual degree is smaller if the leading coefficient is 0.
+     *
+     * @return the degree of this polynomial type.
+     */
+    static constexpr int degree() { return D; }
+
+    /**
+     * Casts from FixedPolynomial to Polynomial.
+     *
+     * The leading zero coefficients are removed, so that the result is valid.
+     */
+    operator Polynomial() const {
+        Polynomial result(const_cast<float*>(c),D+1);
+        result.validate();
+        return result;
+    }
+
+
+#pragma mark Calculation Methods
+    /**
+     * Returns the derivative of this polynomial
+     *
+     * @return the derivative of this polynomial
+     */
+    FixedPolynomial<D-1> derivative() const {
+        static_assert(D > 0, "Constant polynomials have no derivative");
+        FixedPolynomial<D-1> result;
+        for(int ii = 0; ii < D; ii++) {
+            result.c[ii] = c[ii]*(D-ii);
+        }
+        return result;
+    }
+
+    /**
+     * Returns the evaluation of the polynomial on the given value.
+     *
+     * This uses Horner's method.
+     *
+     * @param value The value to evaluate
+     *
+     * @return the evaluation of the polynomial on the given value.
+     */
+    float evaluate(float value) const {
+        float result = c[0];
+        for(int ii = 1; ii <= D; ii++) {
+            result = result*value+c[ii];
+        }
+        return result;
+    }
+
+    /**
+     * Evaluates this polynomial on each of the given values.
+     *
+     * This method is vectorized, and is much faster than calling
+     * {@link evaluate} on each value.  The output array must have room for
+     * count elements.  It is safe for output to be the same as input.
+     *
+     * @param input     The values to evaluate
+     * @param output    The array to store the results
+     * @param count     The number of values
+     *
+     * @return A reference to output for chaining
+     */
+    float* evaluate(const float* input, float* output, size_t count) const;
+
+    /**
+     * Evaluates each polynomial on the corresponding value.
+     *
+     * That is, output[i] is polys[i] evaluated at input[i].  To evaluate many
+     * polynomials at the same value, simply fill the input with that value.
+     * This method is vectorized, and is much faster than calling
+     * {@link evaluate} on each polynomial.  The output array must have room
+     * for count elements.  It is safe for output to be the same as input.
+     *
+     * @param polys     The polynomials to evaluate
+     * @param input     The values to evaluate
+     * @param output    The array to store the results
+     * @param count     The number of polynomials
+     *
+     * @return A reference to output for chaining
+     */
+    static float* evaluate(const FixedPolynomial* polys, const float* input,
+                           float* output, size_t count);
+
+    /**
+     * Returns the number of real roots of this polynomial in [min,max].
+     *
+     * The roots are stored in the array in ascending order.  The array must
+     * have room for D elements.  Roots within epsilon of each other are
+     * reported once, so a root of higher multiplicity is only reported once.
+     * If this polynomial is 0, this method returns 0.
+     *
+     * @param roots     The array to store the roots
+     * @param min       The start of the interval
+     * @param max       The end of the interval
+     * @param epsilon   The error tolerance for the root values
+     *
+     * @return the number of real roots of this polynomial in [min,max].
+     */
+    int roots(float* roots, float min, float max, float epsilon=CU_MATH_EPSILON) const;
+
+    /**
+     * Returns the number of real roots of this polynomial.
+     *
+     * The roots are stored in the array in ascending order.  The array must
+     * have room for D elements.  Roots within epsilon of each other are
+     * reported once, so a root of higher multiplicity is only reported once.
+     * If this polynomial is 0, this method returns 0.
+     *
+     * @param roots     The array to store the roots
+     * @param epsilon   The error tolerance for the root values
+     *
+     * @return the number of real roots of this polynomial.
+     */
+    int roots(float* roots, float epsilon=CU_MATH_EPSILON) const;
+
+    /**
+     * Computes the real roots in [min,max] of each polynomial.
+     *
+     * The roots of polys[i] are stored in ascending order starting at
+     * roots[D*i], and the number of roots is stored in counts[i].  Hence the
+     * roots array must have room for D*count elements.
+     *
+     * @param polys     The polynomials to solve
+     * @param count     The number of polynomials
+     * @param roots     The array to store the roots
+     * @param counts    The array to store the number of roots
+     * @param min       The start of the interval
+     * @param max       The end of the interval
+     * @param epsilon   The error tolerance for the root values
+     */
+    static void roots(const FixedPolynomial* polys, size_t count, float* roots, int* counts,
+                      float min, float max, float epsilon=CU_MATH_EPSILON);
+
+#pragma mark -
+#pragma mark Internal Helpers
+private:
+    // The lower degrees use solve recursively
+    template <int E> friend class FixedPolynomial;
+
+    /**
+     * Returns the evaluation of the polynomial in double precision.
+     *
+     * @param value The value to evaluate
+     *
+     * @return the evaluation of the polynomial in double precision.
+     */
+    double evaluate(double value) const {
+        double result = c[0];
+        for(int ii = 1; ii <= D; ii++) {
+            result = result*value+c[ii];
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of real roots of this polynomial in [min,max].
+     *
+     * The roots are stored in the array in ascending order, and the array
+     * must have room for D elements.  If this polynomial is 0, this method
+     * returns 0.
+     *
+     * @param roots     The array to store the roots
+     * @param min       The start of the interval
+     * @param max       The end of the interval
+     * @param epsilon   The error tolerance for the root values
+     *
+     * @return the number of real roots of this polynomial in [min,max].
+     */
+    int solve(double* roots, double min, double max, double epsilon) const;
+};
+
+/** A cubic polynomial (such as a coordinate of a bezier segment) */
+typedef FixedPolynomial<3> CubicPolynomial;
+/** A quintic polynomial (such as the projection polynomial of a bezier segment) */
+typedef FixedPolynomial<5> QuinticPolynomial;
+
+}
+
+#endif /* __CU_FIXED_POLYNOMIAL_H__ */
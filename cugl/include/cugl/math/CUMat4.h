@@ -44,9 +44,6 @@
     #define VIMAGE_H
     #include <Accelerate/Accelerate.h>
 #endif
-    #ifdef CU_MATH_VECTOR_SSE
-    #include <xmmintrin.h>
-#endif
 
 #if defined (__WINDOWS__)
 #define NOMAXMIN
@@ -79,6 +76,10 @@ class Affine2;
  * This matrix class is directly compatible with OpenGL since its elements are
  * laid out in memory exactly as they are expected by OpenGL.
  *
+ * The vectorized (SSE and AVX2) operations use unaligned loads and stores.
+ * Hence this class has no alignment requirements beyond that of a float,
+ * and it is safe to store it on the heap or in a standard container.
+ *
  * The matrix uses column-major format such that array indices increase down 
  * column first. However, this is only a data representation format, and it 
  * should not have any affect on issues such as multiplication order.
@@ -97,11 +98,6 @@ public:
         vFloat col[4];
         float  m[16];
     };
-#elif defined CU_MATH_VECTOR_SSE
-	__declspec(align(16)) union {
-        __m128 col[4];
-        float m[16];
-    };
 #else
     float m[16];
 #endif
@@ -1477,6 +1473,69 @@ public:
      * @return A reference to dst for chaining
      */
     static Vec4* transform(const Mat4& mat, const Vec4& vec, Vec4* dst);
+
+    /**
+     * Transforms the array of points by the given matrix.
+     *
+     * The points are treated as points, which means that translation is
+     * applied to the result.  The result is stored in output, which must have
+     * room for size elements.  It is safe for output to be the same as input
+     * (to transform the points in place), but the arrays may not otherwise
+     * overlap.
+     *
+     * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+     * than transforming the points one at a time.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The points to transform.
+     * @param size      The number of points to transform.
+     * @param output    The array to store the transformed points.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Mat4& mat, const Vec2* input, size_t size, Vec2* output);
+
+    /**
+     * Transforms the array of points by the given matrix.
+     *
+     * The points are treated as points, which means that translation is
+     * applied to the result.  The result is stored in output, which must have
+     * room for size elements.  It is safe for output to be the same as input
+     * (to transform the points in place), but the arrays may not otherwise
+     * overlap.
+     *
+     * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+     * than transforming the points one at a time.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The points to transform.
+     * @param size      The number of points to transform.
+     * @param output    The array to store the transformed points.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec3* transform(const Mat4& mat, const Vec3* input, size_t size, Vec3* output);
+
+    /**
+     * Transforms the array of vectors by the given matrix.
+     *
+     * The vectors are treated as is.  Hence whether or not translation is
+     * applied depends on the value of w.  The result is stored in output,
+     * which must have room for size elements.  It is safe for output to be
+     * the same as input (to transform the vectors in place), but the arrays
+     * may not otherwise overlap.
+     *
+     * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+     * than transforming the vectors one at a time.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The vectors to transform.
+     * @param size      The number of vectors to transform.
+     * @param output    The array to store the transformed vectors.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec4* transform(const Mat4& mat, const Vec4* input, size_t size, Vec4* output);
     
 
 #pragma mark -
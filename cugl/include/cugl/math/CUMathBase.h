@@ -41,10 +41,14 @@
     #define CU_MATH_VECTOR_APPLE
 #elif defined (__IPHONE__)
     #define CU_MATH_VECTOR_IOS
-#elif defined (__SSE__)
-	// TODO: There is apparently an alignment error here
-	// I do not know enough SSE to debug this right now
-    // #define CU_MATH_VECTOR_SSE
+#elif defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+    // The SSE code uses unaligned loads, so math objects have no alignment
+    // requirements (they may be allocated on the heap or in containers)
+    #define CU_MATH_VECTOR_SSE
+    #if defined (__AVX2__)
+        // AVX2 must be enabled by the compiler (e.g. -mavx2 or /arch:AVX2)
+        #define CU_MATH_VECTOR_AVX2
+    #endif
 #endif
 
 /**
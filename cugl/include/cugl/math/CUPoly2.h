@@ -44,6 +44,7 @@
 #define __CU_POLY2_H__
 
 #include <vector>
+#include <memory>
 #include "CUVec2.h"
 #include "CURect.h"
 
@@ -90,9 +91,9 @@ class Affine2;
  * {@link SimpleTriangulator}: This is a simple earclipping-triangulator for
  * tesselating simple, solid polygons (e.g. no holes or self-intersections).
  *
- * {@link ComplexTriangulator}: This is a wrapper for the advanced Poly2Tri 
- * triangulator.  This triangulator can tesselate complex solid polygons (e.g. 
- * those with holes or self-intersections).
+ * {@link ComplexTriangulator}: This is a sweep-line triangulator for
+ * tesselating solid polygons with holes in O(n log n) time.  It can optionally
+ * refine the result into a constrained Delaunay triangulation.
  * 
  * {@link PathOutliner}: This is a tool is used to generate indices for a
  * path polygon.  It has several options, that allow it to make useful 
@@ -144,10 +145,19 @@ private:
     std::vector<Vec2> _vertices;
     /** The vector of indices in the triangulation */
     std::vector<unsigned short> _indices;
+    /** The vector of indices for a triangulation too large for 16 bits */
+    std::vector<Uint32> _wideindices;
+    /** Whether the triangulation is stored in the wide indices */
+    bool _wide;
     /** The bounding box for this polygon */
     Rect _bounds;
     /** The indexing style of polygon (determines normal form) */
     Type _type;
+
+    /** The (lazily built) spatial index for the geometry queries */
+    class Accelerator;
+    /** The spatial index, shared by copies (only access atomically in const methods) */
+    mutable std::shared_ptr<Accelerator> _accel;
     
 #pragma mark -
 #pragma mark Constructors
@@ -158,7 +168,7 @@ public:
      * The created polygon has no vertices and no triangulation.  The bounding 
      * box is trivial.
      */
-    Poly2() : _type(Type::UNDEFINED) { }
+    Poly2() : _wide(false), _type(Type::UNDEFINED) { }
     
     /**
      * Creates a polygon with the given vertices
@@ -188,6 +198,29 @@ public:
     Poly2(const std::vector<Vec2>& vertices, const std::vector<unsigned short>& indices) {
         set(vertices, indices);
     }
+
+    /**
+     * Creates a polygon with the given vertices and indices.
+     *
+     * A valid list of indices must only refer to vertices in the vertex array.
+     * That is, the indices should all be non-negative, and each value should be
+     * less than the number of vertices.
+     *
+     * This constructor will assign a type accoring to the multiplicity of the
+     * indices. If the number of indices n is correct for a closed or open path
+     * of all vertices (e.g. 2n or 2n-2), then the type will be PATH. Otherwise,
+     * if n is divisible by 3 it will be SOLID. All other values will be 
+     * UNDEFINED, and the user must manually set the type.
+     *
+     * The indices are stored in 16 bits unless they do not fit, in which case
+     * this polygon is {@link isWide wide}.
+     *
+     * @param vertices  The vector of vertices (as Vec2) in this polygon
+     * @param indices   The vector of indices for the rendering
+     */
+    Poly2(const std::vector<Vec2>& vertices, const std::vector<Uint32>& indices) {
+        set(vertices, indices);
+    }
     
     /**
      * Creates a polygon with the given vertices
@@ -282,6 +315,34 @@ public:
           int voffset=0, int ioffset=0) {
         set(vertices, vertsize, indices, indxsize, voffset, ioffset);
     }
+
+    /**
+     * Creates a polygon with the given vertices and indices.
+     *
+     * A valid list of indices must only refer to vertices in the vertex array.
+     * That is, the indices should all be non-negative, and each value should be
+     * less than the number of vertices.
+     *
+     * This constructor will assign a type accoring to the multiplicity of the
+     * indices. If the number of indices n is correct for a closed or open path
+     * of all vertices (e.g. 2n or 2n-2), then the type will be PATH. Otherwise,
+     * if n is divisible by 3 it will be SOLID. All other values will be
+     * UNDEFINED, and the user must manually set the type.
+     *
+     * The indices are stored in 16 bits unless they do not fit, in which case
+     * this polygon is {@link isWide wide}.
+     *
+     * @param vertices  The array of vertices (as Vec2) in this polygon
+     * @param vertsize  The number of elements to use from vertices
+     * @param indices   The array of indices for the rendering
+     * @param indxsize  The number of elements to use for the indices
+     * @param voffset   The offset in vertices to start the polygon
+     * @param ioffset   The offset in indices to start from
+     */
+    Poly2(Vec2* vertices,  int vertsize, Uint32* indices, int indxsize,
+          int voffset=0, int ioffset=0) {
+        set(vertices, vertsize, indices, indxsize, voffset, ioffset);
+    }
     
     /**
      * Creates a polygon with the given vertices and indices.
@@ -329,7 +390,9 @@ public:
      */
     Poly2(Poly2&& poly) :
         _vertices(std::move(poly._vertices)), _indices(std::move(poly._indices)),
-        _bounds(std::move(poly._bounds)), _type(poly._type) {}
+        _wideindices(std::move(poly._wideindices)), _wide(poly._wide),
+        _bounds(std::move(poly._bounds)), _type(poly._type),
+        _accel(std::move(poly._accel)) {}
     
     /**
      * Creates a polygon for the given rectangle.
@@ -475,8 +538,11 @@ public:
     Poly2& operator=(Poly2&& other) {
         _vertices = std::move(other._vertices);
         _indices = std::move(other._indices);
+        _wideindices = std::move(other._wideindices);
+        _wide = other._wide;
         _bounds = std::move(other._bounds);
         _type = other._type;
+        _accel = std::move(other._accel);
         return *this;
     }
 
@@ -526,6 +592,29 @@ public:
      * @return This polygon, returned for chaining
      */
     Poly2& set(const std::vector<Vec2>& vertices, const std::vector<unsigned short>& indices);
+
+    /**
+     * Sets the polygon to have the given vertices and indices.
+     *
+     * A valid list of indices must only refer to vertices in the vertex array.
+     * That is, the indices should all be non-negative, and each value should be
+     * less than the number of vertices.
+     *
+     * This method will assign a type accoring to the multiplicity of the
+     * indices. If the number of indices n is correct for a closed or open path
+     * of all vertices (e.g. 2n or 2n-2), then the type will be PATH. Otherwise,
+     * if n is divisible by 3 it will be SOLID. All other values will be
+     * UNDEFINED, and the user must manually set the type.
+     *
+     * The indices are stored in 16 bits unless they do not fit, in which case
+     * this polygon is {@link isWide wide}.
+     *
+     * @param vertices  The vector of vertices (as Vec2) in this polygon
+     * @param indices   The vector of indices for the rendering
+     *
+     * @return This polygon, returned for chaining
+     */
+    Poly2& set(const std::vector<Vec2>& vertices, const std::vector<Uint32>& indices);
     
     /**
      * Sets the polygon to have the given vertices
@@ -632,6 +721,36 @@ public:
      */
     Poly2& set(Vec2* vertices, int vertsize, unsigned short* indices, int indxsize,
                int voffset=0, int ioffset=0);
+
+    /**
+     * Sets the polygon to have the given vertices and indices.
+     *
+     * A valid list of indices must only refer to vertices in the vertex array.
+     * That is, the indices should all be non-negative, and each value should be
+     * less than the number of vertices.
+     *
+     * This method will assign a type accoring to the multiplicity of the
+     * indices. If the number of indices n is correct for a closed or open path
+     * of all vertices (e.g. 2n or 2n-2), then the type will be PATH. Otherwise,
+     * if n is divisible by 3 it will be SOLID. All other values will be
+     * UNDEFINED, and the user must manually set the type.
+     *
+     * This method returns a reference to this polygon for chaining.
+     *
+     * The indices are stored in 16 bits unless they do not fit, in which case
+     * this polygon is {@link isWide wide}.
+     *
+     * @param vertices  The array of vertices (as Vec2) in this polygon
+     * @param vertsize  The number of elements to use from vertices
+     * @param indices   The array of indices for the rendering
+     * @param indxsize  The number of elements to use for the indices
+     * @param voffset   The offset in vertices to start the polygon
+     * @param ioffset   The offset in indices to start from
+     *
+     * @return This polygon, returned for chaining
+     */
+    Poly2& set(Vec2* vertices, int vertsize, Uint32* indices, int indxsize,
+               int voffset=0, int ioffset=0);
     
     /**
      * Sets the polygon to have the given vertices and indices.
@@ -707,9 +826,10 @@ public:
      */
     Poly2& clear() {
         _vertices.clear();
-        _indices.clear();
+        resetIndices();
         _type = Type::UNDEFINED;
         _bounds = Rect::ZERO;
+        _accel = nullptr;
         return *this;
     }
 
@@ -735,6 +855,30 @@ public:
      * @return This polygon, returned for chaining
      */
     Poly2& setIndices(const std::vector<unsigned short>& indices);
+
+    /**
+     * Sets the indices for this polygon to the ones given.
+     *
+     * A valid list of indices must only refer to vertices in the vertex array.
+     * That is, the indices should all be non-negative, and each value should be
+     * less than the number of vertices.
+     *
+     * This method will assign a type accoring to the multiplicity of the
+     * indices. If the number of indices n is correct for a closed or open path
+     * of all vertices (e.g. 2n or 2n-2), then the type will be PATH. Otherwise,
+     * if n is divisible by 3 it will be SOLID. All other values will be
+     * UNDEFINED, and the user must manually set the type.
+     *
+     * This method returns a reference to this polygon for chaining.
+     *
+     * The indices are stored in 16 bits unless they do not fit, in which case
+     * this polygon is {@link isWide wide}.
+     *
+     * @param indices   The vector of indices for the shape
+     *
+     * @return This polygon, returned for chaining
+     */
+    Poly2& setIndices(const std::vector<Uint32>& indices);
     
     /**
      * Sets the indices for this polygon to the ones given.
@@ -760,6 +904,34 @@ public:
      * @return This polygon, returned for chaining
      */
     Poly2& setIndices(unsigned short* indices, int indxsize, int ioffset=0);
+
+    /**
+     * Sets the indices for this polygon to the ones given.
+     *
+     * A valid list of indices must only refer to vertices in the vertex array.
+     * That is, the indices should all be non-negative, and each value should be
+     * less than the number of vertices.
+     *
+     * The provided array is copied.  The polygon does not retain a reference.
+     *
+     * This method will assign a type accoring to the multiplicity of the
+     * indices. If the number of indices n is correct for a closed or open path
+     * of all vertices (e.g. 2n or 2n-2), then the type will be PATH. Otherwise,
+     * if n is divisible by 3 it will be SOLID. All other values will be
+     * UNDEFINED, and the user must manually set the type.
+     *
+     * This method returns a reference to this polygon for chaining.
+     *
+     * The indices are stored in 16 bits unless they do not fit, in which case
+     * this polygon is {@link isWide wide}.
+     *
+     * @param indices   The array of indices for the rendering
+     * @param indxsize  The number of elements to use for the indices
+     * @param ioffset   The offset in indices to start from
+     *
+     * @return This polygon, returned for chaining
+     */
+    Poly2& setIndices(Uint32* indices, int indxsize, int ioffset=0);
     
     /**
      * Returns true if the indices are in the proper normal form.
@@ -808,13 +980,14 @@ public:
      *
      * This accessor will allow you to change the (singular) vertex.  It is
      * intended to allow minor distortions to the polygon without changing
-     * the underlying mesh.
+     * the underlying mesh.  It discards the spatial index used by the
+     * geometry queries.
      *
      * @param index  The attribute index
      *
      * @return a reference to the attribute at the given index.
      */
-    Vec2& at(int index) { return _vertices.at(index); }
+    Vec2& at(int index) { _accel = nullptr; return _vertices.at(index); }
 
     /**
      * Returns the list of vertices
@@ -832,6 +1005,10 @@ public:
      * This accessor will not permit any changes to the index array.  To change
      * the array, you must change the polygon via a set() method.
      *
+     * If this polygon is {@link isWide wide}, this list is empty.  Use
+     * {@link getIndexCount} and {@link getIndex} to read the indices of
+     * a polygon of either width.
+     *
      * @return a reference to the vertex array
      */
     const std::vector<unsigned short>& getIndices() const  { return _indices; }
@@ -842,11 +1019,75 @@ public:
      * This accessor will not permit any changes to the index array.  To change
      * the array, you must change the polygon via a set() method.
      *
-     * This non-const version of the method is used by triangulators.
+     * This non-const version of the method is used by triangulators. It
+     * discards the spatial index used by the geometry queries.  If this
+     * polygon is {@link isWide wide}, it is narrowed to 16 bit indices
+     * first.  This requires that the polygon have at most 65536 vertices.
      *
      * @return a reference to the vertex array
      */
-    std::vector<unsigned short>& getIndices()  { return _indices; }
+    std::vector<unsigned short>& getIndices()  {
+        _accel = nullptr; narrow(); return _indices;
+    }
+
+    /**
+     * Returns a reference to list of wide (32 bit) indices.
+     *
+     * This list is only used if the polygon is {@link isWide wide}.  It is
+     * empty otherwise.
+     *
+     * @return a reference to list of wide (32 bit) indices.
+     */
+    const std::vector<Uint32>& getWideIndices() const  { return _wideindices; }
+
+    /**
+     * Returns a reference to list of wide (32 bit) indices.
+     *
+     * This non-const version of the method is used by triangulators. It
+     * discards the spatial index used by the geometry queries.  If this
+     * polygon is not {@link isWide wide}, it is widened first.
+     *
+     * @return a reference to list of wide (32 bit) indices.
+     */
+    std::vector<Uint32>& getWideIndices()  {
+        _accel = nullptr; widen(); return _wideindices;
+    }
+
+    /**
+     * Returns true if this polygon stores its indices in 32 bits.
+     *
+     * Polygons store their indices in 16 bits (see {@link getIndices}) unless
+     * they are given indices that do not fit, typically because the mesh has
+     * more than 65536 vertices.  Those polygons are wide, and store their
+     * indices in {@link getWideIndices} instead.
+     *
+     * @return true if this polygon stores its indices in 32 bits.
+     */
+    bool isWide() const { return _wide; }
+
+    /**
+     * Returns the number of indices in this polygon.
+     *
+     * This method works regardless of the width of the indices.
+     *
+     * @return the number of indices in this polygon.
+     */
+    size_t getIndexCount() const {
+        return _wide ? _wideindices.size() : _indices.size();
+    }
+
+    /**
+     * Returns the index at the given position.
+     *
+     * This method works regardless of the width of the indices.
+     *
+     * @param pos   The position in the index list
+     *
+     * @return the index at the given position.
+     */
+    Uint32 getIndex(size_t pos) const {
+        return _wide ? _wideindices[pos] : _indices[pos];
+    }
 
     /**
      * Returns the bounding box for the polygon
@@ -890,7 +1131,7 @@ public:
      *
      * @param type  The type of this polygon.
      */
-    void setType(Type type) { _type = type; }
+    void setType(Type type) { _type = type; _accel = nullptr; }
     
     
 #pragma mark -
@@ -1185,6 +1426,9 @@ public:
      * it checks for containment within the associated triangles.  It includes
      * points on the polygon border.
      *
+     * For large polygons, this method only checks the triangles near the
+     * point (see {@link accelerate}).
+     *
      * @param  point    The point to test
      *
      * @return true if this polygon contains the given point.
@@ -1200,7 +1444,8 @@ public:
      *
      * If it is solid, it checks that the point is within variance of the convex
      * hull.  The convex hull is not a fast computation, so this method should
-     * be used with care.
+     * be used with care.  For large polygons, the hull is computed once and
+     * cached with the spatial index (see {@link accelerate}).
      *
      * @param  point    The point to test
      * @param  variance The distance tolerance
@@ -1209,6 +1454,69 @@ public:
      */
     bool incident(const Vec2& point, float variance=CU_MATH_EPSILON) const;
 
+    /**
+     * Returns the distance from the point to the nearest boundary edge.
+     *
+     * If the polygon is a PATH, the edges are the segments of the path.  If
+     * it is SOLID, the edges are the boundary edges of the triangulation
+     * (those that belong to exactly one triangle).  This method returns -1
+     * if the polygon has no edges.
+     *
+     * If nearest is not null, it will store the point on the boundary that
+     * is closest to the given point.  If edge is not null, it must be an
+     * array of size two, and it will store the indices of the edge end points.
+     *
+     * @param  point    The point to test
+     * @param  nearest  The point to store the nearest boundary point
+     * @param  edge     The array to store the nearest edge indices
+     *
+     * @return the distance from the point to the nearest boundary edge.
+     */
+    float nearestEdge(const Vec2& point, Vec2* nearest=nullptr, Uint32* edge=nullptr) const;
+
+    /**
+     * Returns true if the given line segment crosses the polygon boundary.
+     *
+     * The boundary edges are the same as those for {@link nearestEdge}.  If
+     * hit is not null, it will store the boundary crossing that is closest to
+     * start.  Hence this method can be used as a ray cast against the shape.
+     *
+     * @param  start    The start of the line segment
+     * @param  end      The end of the line segment
+     * @param  hit      The point to store the first crossing
+     *
+     * @return true if the given line segment crosses the polygon boundary.
+     */
+    bool intersects(const Vec2& start, const Vec2& end, Vec2* hit=nullptr) const;
+
+    /**
+     * Builds the spatial index for the geometry queries.
+     *
+     * The geometry queries ({@link contains}, {@link incident}, {@link
+     * nearestEdge}, and {@link intersects}) use a uniform grid over the
+     * triangles and the boundary edges of a large polygon.  The grid is
+     * built the first time that it is needed, and it is discarded whenever
+     * the polygon is modified.  Small polygons are simply scanned instead.
+     *
+     * The index is published atomically, so the queries may be performed on
+     * several threads at once.  If several threads need the index at the
+     * same time, they may each build it, but only the first one is kept.
+     * Calling this method first avoids that wasted work, and forces the index
+     * to be built regardless of the polygon size.  Copies of this polygon
+     * share the index until either one is modified.  It is never safe to
+     * modify a polygon while another thread is querying it.
+     */
+    void accelerate() const;
+
+    /**
+     * Returns true if this polygon has a spatial index for its queries.
+     *
+     * See {@link accelerate} for a description of the spatial index.
+     *
+     * @return true if this polygon has a spatial index for its queries.
+     */
+    bool isAccelerated() const { return std::atomic_load(&_accel) != nullptr; }
+
     
 #pragma mark -
 #pragma mark Internal Helper Methods
@@ -1245,13 +1553,98 @@ private:
      *
      * @return the barycentric coordinates for a point relative to a triangle.
      */
-    Vec2 getBarycentric(const Vec2& point, unsigned short index) const;
+    Vec2 getBarycentric(const Vec2& point, Uint32 index) const;
+
+    /**
+     * Removes all indices, making this polygon narrow.
+     */
+    void resetIndices() {
+        _indices.clear();
+        _wideindices.clear();
+        _wide = false;
+    }
+
+    /**
+     * Moves the indices of this polygon to the wide (32 bit) list.
+     *
+     * This method does nothing if the polygon is already wide.
+     */
+    void widen();
+
+    /**
+     * Moves the indices of this polygon to the 16 bit list.
+     *
+     * This method does nothing if the polygon is not wide.  Otherwise, it
+     * requires that the polygon have at most 65536 vertices.
+     */
+    void narrow();
+
+    /**
+     * Reserves room for the given number of additional indices.
+     *
+     * The polygon is widened first if its vertices no longer fit in 16 bit
+     * indices.  Hence this method should be called after the vertices for
+     * the new indices have been added.
+     *
+     * @param count The number of indices to reserve
+     */
+    void reserveIndices(size_t count);
+
+    /**
+     * Appends the given index to this polygon, widening it if necessary.
+     *
+     * @param index The index to append
+     */
+    void pushIndex(Uint32 index) {
+        if (!_wide && index > 0xffff) {
+            widen();
+        }
+        if (_wide) {
+            _wideindices.push_back(index);
+        } else {
+            _indices.push_back((unsigned short)index);
+        }
+    }
+
+    /**
+     * Removes the last index from this polygon.
+     */
+    void popIndex() {
+        if (_wide) {
+            _wideindices.pop_back();
+        } else {
+            _indices.pop_back();
+        }
+    }
+
+    /**
+     * Appends the given indices to this polygon, widening it if necessary.
+     *
+     * The value offset is added to every index.
+     *
+     * @param indices   The array of indices to append
+     * @param count     The number of indices to append
+     * @param offset    The amount to add to each index
+     */
+    void appendIndices(const Uint32* indices, size_t count, Uint32 offset=0);
+
+    /**
+     * Returns the spatial index for this polygon, building it if necessary.
+     *
+     * This method returns nullptr if the polygon is too small to benefit
+     * from an index (and the index was not forced by {@link accelerate}).
+     *
+     * @return the spatial index for this polygon, building it if necessary.
+     */
+    const Accelerator* getAccelerator() const;
 
     // Make friends with the factory classes
     friend class CubicSplineApproximator;
     friend class SimpleTriangulator;
+    friend class ComplexTriangulator;
     friend class PathOutliner;
     friend class PathExtruder;
+    friend class PolyClipper;
 };
 
 }
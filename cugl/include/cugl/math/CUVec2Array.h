@@ -0,0 +1,462 @@
+//
+//  CUVec2Array.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for a structure-of-arrays collection of 2d
+//  vectors.  Particle systems and procedural meshes apply the same operation
+//  to thousands of points each frame.  Looping over a std::vector<Vec2> and
+//  calling the Vec2 methods one at a time wastes most of the vector unit.
+//  This class stores the x and y coordinates in separate arrays, so that the
+//  bulk operations can process 4 (SSE2, NEON) or 8 (AVX2) points at once.
+//
+//  The instruction set is chosen at runtime the first time that a bulk
+//  operation is used.  The results are the same as the Vec2 methods.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#ifndef __CU_VEC2_ARRAY_H__
+#define __CU_VEC2_ARRAY_H__
+
+#include <vector>
+#include "CUMathBase.h"
+#include "CUVec2.h"
+
+namespace cugl {
+
+// Forward references
+class Affine2;
+class Mat4;
+class Vertex2;
+
+/**
+ * This class is a structure-of-arrays collection of 2d vectors.
+ *
+ * The x and y coordinates are stored in separate float arrays.  Individual
+ * elements may be accessed with {@link get} and {@link set}, but this class
+ * is intended for bulk operations which apply to every element at once.
+ * These bulk operations are vectorized, choosing between SSE2, AVX2 and NEON
+ * at runtime.  The result of each bulk operation is the same as calling the
+ * corresponding {@link Vec2} method on each element.
+ *
+ * Bulk operations that combine two arrays require that the arrays have the
+ * same size.  It is safe for an array to be combined with itself.
+ *
+ * When it is time to draw, the method {@link pack} copies the points back
+ * into an array-of-structures format, such as the positions of a mesh of
+ * {@link Vertex2} objects.
+ */
+class Vec2Array {
+private:
+    /** The x-coordinates */
+    std::vector<float> _x;
+    /** The y-coordinates */
+    std::vector<float> _y;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty array of vectors.
+     */
+    Vec2Array() {}
+
+    /**
+     * Creates an array of size vectors, all initialized to the origin.
+     *
+     * @param size  The number of vectors
+     */
+    Vec2Array(size_t size) : _x(size,0.0f), _y(size,0.0f) {}
+
+    /**
+     * Creates an array with a copy of the given vectors.
+     *
+     * @param points    The vectors to copy
+     */
+    Vec2Array(const std::vector<Vec2>& points) { set(points); }
+
+    /**
+     * Creates an array with a copy of the given vectors.
+     *
+     * @param points    The vectors to copy
+     * @param size      The number of vectors to copy
+     */
+    Vec2Array(const Vec2* points, size_t size) { set(points,size); }
+
+    /**
+     * Deletes this array, releasing all resources.
+     */
+    ~Vec2Array() {}
+
+
+#pragma mark Setters
+    /**
+     * Sets this array to a copy of the given vectors.
+     *
+     * @param points    The vectors to copy
+     *
+     * @return This array, after assignment
+     */
+    Vec2Array& operator=(const std::vector<Vec2>& points) {
+        return set(points);
+    }
+
+    /**
+     * Sets this array to a copy of the given vectors.
+     *
+     * @param points    The vectors to copy
+     *
+     * @return This array, after assignment
+     */
+    Vec2Array& set(const std::vector<Vec2>& points) {
+        return set(points.data(),points.size());
+    }
+
+    /**
+     * Sets this array to a copy of the given vectors.
+     *
+     * @param points    The vectors to copy
+     * @param size      The number of vectors to copy
+     *
+     * @return This array, after assignment
+     */
+    Vec2Array& set(const Vec2* points, size_t size);
+
+    /**
+     * Sets every element of this array to the given vector.
+     *
+     * The size of this array is unchanged.
+     *
+     * @param v     The vector value
+     *
+     * @return This array, after assignment
+     */
+    Vec2Array& fill(const Vec2& v);
+
+
+#pragma mark Element Access
+    /**
+     * Returns the number of vectors in this array.
+     *
+     * @return the number of vectors in this array.
+     */
+    size_t size() const { return _x.size(); }
+
+    /**
+     * Returns true if this array is empty.
+     *
+     * @return true if this array is empty.
+     */
+    bool empty() const { return _x.empty(); }
+
+    /**
+     * Resizes this array to hold size vectors.
+     *
+     * New vectors are initialized to the origin.
+     *
+     * @param size  The new number of vectors
+     */
+    void resize(size_t size) { _x.resize(size,0.0f); _y.resize(size,0.0f); }
+
+    /**
+     * Reserves room for at least capacity vectors.
+     *
+     * @param capacity  The number of vectors to reserve
+     */
+    void reserve(size_t capacity) { _x.reserve(capacity); _y.reserve(capacity); }
+
+    /**
+     * Removes all vectors from this array.
+     */
+    void clear() { _x.clear(); _y.clear(); }
+
+    /**
+     * Appends a vector to the end of this array.
+     *
+     * @param v     The vector to append
+     */
+    void push_back(const Vec2& v) { _x.push_back(v.x); _y.push_back(v.y); }
+
+    /**
+     * Removes the element at the given position, replacing it with the last.
+     *
+     * This is the standard way to kill a particle in O(1) time.  It does not
+     * preserve the order of the elements.
+     *
+     * @param index The position to remove
+     */
+    void swapRemove(size_t index);
+
+    /**
+     * Returns the vector at the given position.
+     *
+     * @param index The vector position
+     *
+     * @return the vector at the given position.
+     */
+    Vec2 get(size_t index) const { return Vec2(_x[index],_y[index]); }
+
+    /**
+     * Sets the vector at the given position.
+     *
+     * @param index The vector position
+     * @param v     The vector value
+     */
+    void set(size_t index, const Vec2& v) { _x[index] = v.x; _y[index] = v.y; }
+
+    /**
+     * Returns the array of x-coordinates.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of x-coordinates.
+     */
+    float* getX() { return _x.data(); }
+
+    /**
+     * Returns the array of x-coordinates.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of x-coordinates.
+     */
+    const float* getX() const { return _x.data(); }
+
+    /**
+     * Returns the array of y-coordinates.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of y-coordinates.
+     */
+    float* getY() { return _y.data(); }
+
+    /**
+     * Returns the array of y-coordinates.
+     *
+     * This pointer is invalidated if the array is resized.
+     *
+     * @return the array of y-coordinates.
+     */
+    const float* getY() const { return _y.data(); }
+
+
+#pragma mark Arithmetic
+    /**
+     * Adds the given vector to every element of this array.
+     *
+     * @param v     The vector to add
+     *
+     * @return This array, after the addition
+     */
+    Vec2Array& add(const Vec2& v);
+
+    /**
+     * Adds the elements of the given array to this one.
+     *
+     * The arrays must be the same size.
+     *
+     * @param other The array to add
+     *
+     * @return This array, after the addition
+     */
+    Vec2Array& add(const Vec2Array& other);
+
+    /**
+     * Adds the elements of the given array, scaled by s, to this one.
+     *
+     * This is the standard Euler step (e.g. add the velocities times dt to
+     * the positions).  The arrays must be the same size.
+     *
+     * @param other The array to add
+     * @param s     The scale factor
+     *
+     * @return This array, after the addition
+     */
+    Vec2Array& add(const Vec2Array& other, float s);
+
+    /**
+     * Subtracts the given vector from every element of this array.
+     *
+     * @param v     The vector to subtract
+     *
+     * @return This array, after the subtraction
+     */
+    Vec2Array& subtract(const Vec2& v);
+
+    /**
+     * Subtracts the elements of the given array from this one.
+     *
+     * The arrays must be the same size.
+     *
+     * @param other The array to subtract
+     *
+     * @return This array, after the subtraction
+     */
+    Vec2Array& subtract(const Vec2Array& other);
+
+    /**
+     * Scales every element of this array uniformly by s.
+     *
+     * @param s     The scale factor
+     *
+     * @return This array, after the scaling
+     */
+    Vec2Array& scale(float s);
+
+    /**
+     * Scales every element of this array nonuniformly by v.
+     *
+     * @param v     The scale factor
+     *
+     * @return This array, after the scaling
+     */
+    Vec2Array& scale(const Vec2& v);
+
+    /**
+     * Clamps every element of this array to the given range.
+     *
+     * @param min   The minimum value
+     * @param max   The maximum value
+     *
+     * @return This array, after the clamping
+     */
+    Vec2Array& clamp(const Vec2& min, const Vec2& max);
+
+
+#pragma mark Linear Algebra
+    /**
+     * Normalizes every element of this array.
+     *
+     * As with {@link Vec2#normalize}, an element that is too close to the
+     * origin is left unchanged.
+     *
+     * @return This array, after normalization
+     */
+    Vec2Array& normalize();
+
+    /**
+     * Rotates every element of this array by the angle around the origin.
+     *
+     * @param angle The angle to rotate by (in radians)
+     *
+     * @return This array, after the rotation
+     */
+    Vec2Array& rotate(float angle);
+
+    /**
+     * Rotates every element of this array by the angle around the given point.
+     *
+     * @param angle The angle to rotate by (in radians)
+     * @param point The point to rotate around
+     *
+     * @return This array, after the rotation
+     */
+    Vec2Array& rotate(float angle, const Vec2& point);
+
+    /**
+     * Linearly interpolates every element of this array with the other.
+     *
+     * If alpha is 0, the elements are unchanged.  If alpha is 1, the elements
+     * are the elements of other.  The arrays must be the same size.
+     *
+     * @param other The other end of the line segment
+     * @param alpha The interpolation value
+     *
+     * @return This array, after the interpolation
+     */
+    Vec2Array& lerp(const Vec2Array& other, float alpha);
+
+    /**
+     * Stores the dot products of this array with the other in output.
+     *
+     * The arrays must be the same size.  The output array must have room
+     * for {@link size} elements.
+     *
+     * @param other     The array to dot with this one
+     * @param output    The array to store the dot products
+     *
+     * @return A reference to output for chaining
+     */
+    float* dot(const Vec2Array& other, float* output) const;
+
+
+#pragma mark Transforms
+    /**
+     * Transforms every element of this array by the given affine transform.
+     *
+     * @param aff   The affine transform
+     *
+     * @return This array, after the transform
+     */
+    Vec2Array& transform(const Affine2& aff);
+
+    /**
+     * Transforms every element of this array by the given matrix.
+     *
+     * The elements are treated as points (as in {@link Mat4#transform}),
+     * which means that translation is applied to the result.
+     *
+     * @param mat   The transform matrix
+     *
+     * @return This array, after the transform
+     */
+    Vec2Array& transform(const Mat4& mat);
+
+
+#pragma mark Conversion
+    /**
+     * Copies this array into the given array of vectors.
+     *
+     * The output array must have room for {@link size} elements.
+     *
+     * @param output    The array to store the vectors
+     *
+     * @return A reference to output for chaining
+     */
+    Vec2* pack(Vec2* output) const;
+
+    /**
+     * Copies this array into the positions of the given vertices.
+     *
+     * Only the vertex positions are modified.  The output array must have
+     * room for {@link size} elements.
+     *
+     * @param output    The vertices to store the positions
+     *
+     * @return A reference to output for chaining
+     */
+    Vertex2* pack(Vertex2* output) const;
+
+    /**
+     * Returns this array as a vector of Vec2 objects.
+     *
+     * @return this array as a vector of Vec2 objects.
+     */
+    operator std::vector<Vec2>() const;
+};
+
+}
+
+#endif /* __CU_VEC2_ARRAY_H__ */
@@ -0,0 +1,507 @@
+//
+//  CUComplexTriangulator.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for a triangulator that supports holes.  Unlike
+//  SimpleTriangulator (which uses ear clipping, and is quadratic in practice),
+//  this triangulator runs in O(n log n) time.  It first partitions the polygon
+//  into y-monotone pieces with a sweep line, and then triangulates each piece
+//  in linear time.  Optionally, it refines the result into a constrained
+//  Delaunay triangulation by edge flipping.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  The monotone partition follows the presentation in "Computational Geometry:
+//  Algorithms and Applications" by de Berg, Cheong, van Kreveld, and Overmars.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#ifndef __CU_COMPLEX_TRIANGULATOR_H__
+#define __CU_COMPLEX_TRIANGULATOR_H__
+
+#include "../CUPoly2.h"
+#include "../CUVec2.h"
+#include <vector>
+#include <set>
+
+namespace cugl {
+
+/**
+ * This class is a factory for producing solid Poly2 objects from a polygon with holes.
+ *
+ * This triangulator has the same interface as {@link SimpleTriangulator}, but
+ * it supports holes and it runs in O(n log n) time.  The outer boundary is set
+ * with the initialization methods, while holes are added with {@link addHole}.
+ * The boundary and holes may have either orientation, but they should not
+ * intersect themselves or each other.
+ *
+ * The triangulation is computed by partitioning the polygon into y-monotone
+ * pieces with a sweep line, and then triangulating each piece in linear time.
+ * This produces a valid triangulation, but one with many long, thin triangles.
+ * If Delaunay refinement is enabled (see {@link setDelaunay}), the result is
+ * then improved by edge flipping into a constrained Delaunay triangulation.
+ * Refinement never flips an edge of the boundary or the holes.
+ *
+ * As with all factories, the methods are broken up into three phases:
+ * initialization, calculation, and materialization.  To use the factory, you
+ * first set the data (in this case a set of vertices or another Poly2) with the
+ * initialization methods.  You then call the calculation method.  Finally,
+ * you use the materialization methods to access the data in several different
+ * ways.
+ *
+ * The vertices of the materialized polygon are the vertices of the outer
+ * boundary, followed by the vertices of each hole, in the order the holes
+ * were added.  The indices refer to this combined list.
+ *
+ * This division allows us to support multithreaded calculation if the data
+ * generation takes too long.  However, note that this factory is not thread
+ * safe in that you cannot access data while it is still in mid-calculation.
+ */
+class ComplexTriangulator {
+#pragma mark Values
+private:
+    /**
+     * Enumeration of vertex types (for the sweep line)
+     *
+     * A vertex type is classified by the position of its neighbors relative
+     * to the sweep line, and whether the interior angle is convex.
+     */
+    enum class VertexType {
+        /** Both neighbors below, convex interior angle */
+        START,
+        /** Both neighbors below, reflex interior angle */
+        SPLIT,
+        /** Both neighbors above, convex interior angle */
+        END,
+        /** Both neighbors above, reflex interior angle */
+        MERGE,
+        /** One neighbor above and one below */
+        REGULAR
+    };
+
+    /**
+     * Comparator ordering the edges crossing the sweep line from left to right.
+     *
+     * Edges are identified by the index of their first vertex.  Since the
+     * edges in the sweep status never cross, this order does not depend on
+     * the current position of the sweep line.
+     */
+    class EdgeOrder {
+    public:
+        /** The triangulator owning the edges */
+        const ComplexTriangulator* owner;
+        /** Returns true if edge a is strictly to the left of edge b */
+        bool operator()(int a, int b) const;
+    };
+
+    /** The set of vertices to use in the calculation (boundary, then holes) */
+    std::vector<Vec2> _input;
+    /** The number of vertices in each loop (the boundary, then holes) */
+    std::vector<size_t> _loops;
+    /** The next vertex in each loop, oriented with the interior on the left */
+    std::vector<int> _next;
+    /** The previous vertex in each loop, oriented with the interior on the left */
+    std::vector<int> _prev;
+    /** The vertices sorted in sweep order (top to bottom) */
+    std::vector<int> _sorted;
+    /** The classification of each vertex for the sweep line */
+    std::vector<VertexType> _types;
+    /** The helper vertex of each edge in the sweep status */
+    std::vector<int> _helper;
+    /** The position of each edge in the sweep status */
+    std::vector<std::set<int,EdgeOrder>::iterator> _position;
+    /** The diagonals splitting the polygon into monotone pieces */
+    std::vector<int> _diagonals;
+    /** The query point for searching the sweep status */
+    Vec2 _query;
+    /** The output results of the triangulation */
+    std::vector<unsigned int> _output;
+    /** Whether to refine the result into a constrained Delaunay triangulation */
+    bool _delaunay;
+    /** Whether or not the calculation has been run */
+    bool _calculated;
+
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a triangulator with no vertex data.
+     */
+    ComplexTriangulator() : _delaunay(false), _calculated(false) {}
+
+    /**
+     * Creates a triangulator with the given vertex data.
+     *
+     * The vertices define the outer boundary of the polygon.  The vertex data
+     * is copied.  The triangulator does not retain any references to the
+     * original data.
+     *
+     * @param points    The vertices to triangulate
+     */
+    ComplexTriangulator(const std::vector<Vec2>& points) : _delaunay(false), _calculated(false) {
+        set(points);
+    }
+
+    /**
+     * Creates a triangulator with the given vertex data.
+     *
+     * The triangulator only uses the vertex data from the polygon.  It ignores
+     * any existing indices.  The vertices define the outer boundary.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * @param poly    The vertices to triangulate
+     */
+    ComplexTriangulator(const Poly2& poly) : _delaunay(false), _calculated(false) {
+        set(poly._vertices);
+    }
+
+    /**
+     * Deletes this triangulator, releasing all resources.
+     */
+    ~ComplexTriangulator() {}
+
+#pragma mark -
+#pragma mark Initialization
+    /**
+     * Sets the vertex data for this triangulator.
+     *
+     * The triangulator only uses the vertex data from the polygon.  It ignores
+     * any existing indices.  The vertices define the outer boundary, and any
+     * previously added holes are removed.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param poly    The vertices to triangulate
+     */
+    void set(const Poly2& poly) {
+        set(poly._vertices);
+    }
+
+    /**
+     * Sets the vertex data for this triangulator.
+     *
+     * The vertices define the outer boundary, and any previously added holes
+     * are removed.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param points    The vertices to triangulate
+     */
+    void set(const std::vector<Vec2>& points) {
+        clear();
+        _input = points;
+        _loops.push_back(points.size());
+    }
+
+    /**
+     * Adds a hole to the polygon.
+     *
+     * The triangulator only uses the vertex data from the polygon.  It ignores
+     * any existing indices.  The hole should lie inside the outer boundary,
+     * and should not intersect it or any other hole.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param poly    The vertices of the hole
+     */
+    void addHole(const Poly2& poly) {
+        addHole(poly._vertices);
+    }
+
+    /**
+     * Adds a hole to the polygon.
+     *
+     * The hole should lie inside the outer boundary, and should not intersect
+     * it or any other hole.
+     *
+     * The vertex data is copied.  The triangulator does not retain any
+     * references to the original data.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param points    The vertices of the hole
+     */
+    void addHole(const std::vector<Vec2>& points);
+
+    /**
+     * Returns true if the triangulation is refined to be Delaunay.
+     *
+     * If this value is true, the monotone triangulation is refined by edge
+     * flipping into a constrained Delaunay triangulation.  This avoids long,
+     * thin triangles, at a cost of roughly doubling the calculation time.
+     * The edges of the boundary and holes are never flipped.
+     *
+     * @return true if the triangulation is refined to be Delaunay.
+     */
+    bool isDelaunay() const { return _delaunay; }
+
+    /**
+     * Sets whether the triangulation is refined to be Delaunay.
+     *
+     * If this value is true, the monotone triangulation is refined by edge
+     * flipping into a constrained Delaunay triangulation.  This avoids long,
+     * thin triangles, at a cost of roughly doubling the calculation time.
+     * The edges of the boundary and holes are never flipped.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param flag  Whether to refine the triangulation to be Delaunay.
+     */
+    void setDelaunay(bool flag) {
+        reset();
+        _delaunay = flag;
+    }
+
+    /**
+     * Clears all internal data, but still maintains the initial vertex data.
+     */
+    void reset() {
+        _calculated = false;
+        _output.clear();
+        _next.clear(); _prev.clear(); _sorted.clear(); _types.clear();
+        _helper.clear(); _position.clear(); _diagonals.clear();
+    }
+
+    /**
+     * Clears all internal data, the initial vertex data.
+     *
+     * When this method is called, you will need to set a new vertices before
+     * calling calculate.
+     */
+    void clear() {
+        reset();
+        _input.clear(); _loops.clear();
+    }
+
+#pragma mark -
+#pragma mark Calculation
+    /**
+     * Performs a triangulation of the current vertex data.
+     */
+    void calculate();
+
+#pragma mark -
+#pragma mark Materialization
+    /**
+     * Returns a list of indices representing the triangulation.
+     *
+     * The indices represent positions in the original vertex list, followed
+     * by the vertices of each hole.  If you have modified that list, these
+     * indices may no longer be valid.
+     *
+     * The triangulator does not retain a reference to the returned list; it
+     * is safe to modify it.
+     *
+     * The list uses 16 bit indices, so the number of vertices may not exceed
+     * 65536.  Use the buffer version of this method for larger meshes.
+     *
+     * If the calculation is not yet performed, this method will return the
+     * empty list.
+     *
+     * @return a list of indices representing the triangulation.
+     */
+    std::vector<unsigned short> getTriangulation();
+
+    /**
+     * Stores the triangulation indices in the given buffer.
+     *
+     * The indices represent positions in the original vertex list, followed
+     * by the vertices of each hole.  If you have modified that list, these
+     * indices may no longer be valid.
+     *
+     * The indices will be appended to the provided vector. You should clear
+     * the vector first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @return the number of elements added to the buffer
+     */
+    size_t getTriangulation(std::vector<Uint32>& buffer);
+
+    /**
+     * Stores the triangulation indices in the given 16-bit buffer.
+     *
+     * This version is for meshes that are known to be small, and which
+     * should be stored compactly (e.g. for upload to a 16-bit index buffer).
+     * The number of vertices (including holes) may not exceed 65536.
+     *
+     * The indices will be appended to the provided vector. You should clear
+     * the vector first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @return the number of elements added to the buffer
+     */
+    size_t getTriangulation(std::vector<unsigned short>& buffer);
+
+    /**
+     * Returns a polygon representing the triangulation.
+     *
+     * The polygon contains the original vertices (followed by those of the
+     * holes) together with the new indices defining a solid shape.  The
+     * triangulator does not maintain references to this polygon and it is
+     * safe to modify it.
+     *
+     * If the calculation is not yet performed, this method will return the
+     * empty polygon.
+     *
+     * @return a polygon representing the triangulation.
+     */
+    Poly2 getPolygon();
+
+    /**
+     * Stores the triangulation in the given buffer.
+     *
+     * This method will add both the original vertices (followed by those of
+     * the holes), and the corresponding indices to the new buffer.  If the
+     * buffer is not empty, the indices will be adjusted accordingly. You
+     * should clear the buffer first if you do not want to preserve the
+     * original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @param buffer    The buffer to store the triangulated polygon
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPolygon(Poly2* buffer);
+
+#pragma mark -
+#pragma mark Internal Data Generation
+private:
+    /**
+     * Returns true if vertex a comes before vertex b in the sweep order.
+     *
+     * The sweep line moves from top to bottom.  Vertices at the same height
+     * are ordered left to right, so that horizontal edges are handled as if
+     * tilted slightly downward.  Coincident vertices are ordered by index.
+     *
+     * @param a     The index of the first vertex
+     * @param b     The index of the second vertex
+     *
+     * @return true if vertex a comes before vertex b in the sweep order.
+     */
+    bool isAbove(int a, int b) const {
+        const Vec2& p = _input[a];
+        const Vec2& q = _input[b];
+        return (p.y > q.y || (p.y == q.y && (p.x < q.x || (p.x == q.x && a < b))));
+    }
+
+    /**
+     * Links the vertex loops with the interior of the polygon on the left.
+     *
+     * The outer boundary is oriented counter-clockwise, while the holes are
+     * oriented clockwise.  Loops with fewer than three vertices are ignored.
+     */
+    void computeLoops();
+
+    /**
+     * Classifies the vertex at the given index for the sweep line.
+     *
+     * @param index The vertex index
+     *
+     * @return the classification for the vertex at the given index
+     */
+    VertexType classifyVertex(int index) const;
+
+    /**
+     * Returns the edge in the sweep status directly to the left of a vertex.
+     *
+     * The edge is identified by the index of its first vertex.  If there is
+     * no such edge (which only happens for invalid input), this method
+     * returns -1.
+     *
+     * @param status  The sweep status
+     * @param index   The vertex index
+     *
+     * @return the edge in the sweep status directly to the left of a vertex.
+     */
+    int findLeftEdge(std::set<int,EdgeOrder>& status, int index);
+
+    /**
+     * Partitions the polygon into y-monotone pieces.
+     *
+     * This method performs the sweep, recording the diagonals that split
+     * the polygon in the attribute _diagonals.
+     */
+    void computeDiagonals();
+
+    /**
+     * Triangulates each monotone piece of the partition.
+     *
+     * This method walks the faces of the planar graph formed by the polygon
+     * edges and the diagonals, triangulating each in linear time.
+     */
+    void computeTriangulation();
+
+    /**
+     * Triangulates a single y-monotone polygon.
+     *
+     * The polygon is given as a list of vertex indices in counter-clockwise
+     * order.  The triangles are appended to the output.
+     *
+     * @param face  The vertex indices of the monotone polygon
+     * @param stack A scratch buffer for the triangulation
+     * @param chain A scratch buffer for the triangulation
+     */
+    void triangulateMonotone(const std::vector<int>& face, std::vector<int>& stack,
+                             std::vector<int>& chain);
+
+    /**
+     * Refines the triangulation into a constrained Delaunay triangulation.
+     *
+     * This method uses Lawson's edge flipping algorithm.  Only edges shared
+     * by two triangles are flipped, so the boundary and holes are preserved.
+     */
+    void computeDelaunay();
+
+    /**
+     * Removes degenerate triangles from the current triangulation.
+     *
+     * Colinear vertices may produce triangles with no area.  This will crash
+     * OpenGL, so we remove them.
+     */
+    void trimColinear();
+};
+
+}
+
+#endif /* __CU_COMPLEX_TRIANGULATOR_H__ */
@@ -8,6 +8,11 @@
 //  a simple math class.  By separating this out as a factory, we allow ourselves
 //  the option of moving these calculations to a worker thread if necessary.
 //
+//  The approximation also produces an arc-length table and a bounding volume
+//  hierarchy over the subdivided curve.  These support fast queries for path
+//  following, such as the point at a given distance along the spline, or the
+//  point on the spline nearest to a given position.
+//
 //  Because math objects are intended to be on the stack, we do not provide
 //  any shared pointer support in this class.
 //
@@ -40,12 +45,16 @@
 #include "../CUCubicSpline.h"
 #include "../CUVec2.h"
 #include <vector>
+#include <memory>
 
 /** The default tolerance for the polygon approximation functions */
 #define DEFAULT_TOLERANCE   0.25
 
 namespace cugl {
 
+// Forward reference to the thread pool
+class ThreadPool;
+
 /**
  * This class is a factory for producing Poly2 objects from a CubicSpline.
  *
@@ -66,6 +75,12 @@ namespace cugl {
  * to the spline, and it is unsafe to modify the spline while the calculation
  * is ongoing.  If you do multithread the calculation, you should force the
  * user to copy the spline first.
+ *
+ * The calculation also produces an arc-length table and a bounding volume
+ * hierarchy for the approximation.  Once the calculation is complete, the
+ * query methods (such as {@link getParameter} and {@link nearestParameter})
+ * take logarithmic time in the size of the approximation.  These methods are
+ * const, and are safe to call from several threads at once.
  */
 class CubicSplineApproximator {
 #pragma mark Values
@@ -76,6 +91,31 @@ private:
     std::vector<Vec2>  _pointbuff;
     /** The parameter data created by the approximation */
     std::vector<float> _parambuff;
+    /** The arc length (from the start) at each parameter in the approximation */
+    std::vector<float> _lengthbuff;
+
+    /**
+     * A node in the bounding volume hierarchy of the approximation
+     *
+     * Each node covers a contiguous range of the beziers in the approximation.
+     * The box contains the control points of those beziers, and hence (by the
+     * convex hull property) the curve itself.  The left child of an interior
+     * node immediately follows it in the hierarchy.
+     */
+    typedef struct {
+        /** The bottom left corner of the bounding box */
+        Vec2 min;
+        /** The top right corner of the bounding box */
+        Vec2 max;
+        /** The first bezier in this node */
+        Uint32 begin;
+        /** The bezier after the last one in this node */
+        Uint32 end;
+        /** The position of the right child (0 if this node is a leaf) */
+        Uint32 right;
+    } Bounds;
+    /** The bounding volume hierarchy of the approximation */
+    std::vector<Bounds> _bounds;
     /** Whether the approximation curve is closed */
     bool _closed;
     /** Whether or not the calculation has been run */
@@ -133,7 +173,7 @@ public:
     /**
      * Deletes this spline approximator, releasing all resources.
      */
-    ~CubicSplineApproximator();
+    ~CubicSplineApproximator() {}
     
 
 #pragma mark -
@@ -160,6 +200,7 @@ public:
     void reset() {
         _calculated = false;
         _pointbuff.clear(); _parambuff.clear();
+        _lengthbuff.clear(); _bounds.clear();
     }
 
     /**
@@ -172,6 +213,7 @@ public:
         _calculated = false;
         _spline = nullptr;
         _pointbuff.clear(); _parambuff.clear();
+        _lengthbuff.clear(); _bounds.clear();
     }
 
 
@@ -196,7 +238,112 @@ public:
      * @param  tolerance    the error tolerance of the stopping condition
      */
     void calculate(Criterion criterion=Criterion::DISTANCE, float tolerance=DEFAULT_TOLERANCE);
-    
+
+    /**
+     * Performs an approximation of the current spline in parallel.
+     *
+     * This method is the same as {@link calculate(Criterion,float)}, except
+     * that the spline segments are divided among the threads of the pool.
+     * Each segment is subdivided independently, so the result is identical
+     * to the serial calculation.  This method blocks until the calculation
+     * is complete.  If pool is nullptr, the calculation is serial.
+     *
+     * The calculation uses a reference to the spline; it does not copy it.
+     * The spline should not be modified until this method returns.
+     *
+     * @param  pool         the thread pool to perform the calculation
+     * @param  criterion    the stopping condition criterion
+     * @param  tolerance    the error tolerance of the stopping condition
+     */
+    void calculate(const std::shared_ptr<ThreadPool>& pool,
+                   Criterion criterion=Criterion::DISTANCE, float tolerance=DEFAULT_TOLERANCE);
+
+
+#pragma mark -
+#pragma mark Queries
+    /**
+     * Returns the arc length of the spline.
+     *
+     * The length is estimated from the beziers of the approximation, so its
+     * accuracy depends on the tolerance of the calculation.  If calculate has
+     * not been called, this method returns 0.
+     *
+     * @return the arc length of the spline.
+     */
+    float getLength() const {
+        return _lengthbuff.empty() ? 0.0f : _lengthbuff.back();
+    }
+
+    /**
+     * Returns the arc length from the start of the spline to the parameter.
+     *
+     * The parameter is clamped to the range of the spline.  This method
+     * performs a binary search of the arc-length table, and interpolates
+     * within a bezier of the approximation.  If calculate has not been
+     * called, this method returns 0.
+     *
+     * @param  tp   the parameter to measure to
+     *
+     * @return the arc length from the start of the spline to the parameter.
+     */
+    float getArcLength(float tp) const;
+
+    /**
+     * Returns the parameter at the given arc length along the spline.
+     *
+     * This is the inverse of {@link getArcLength}.  It allows a unit to move
+     * along the spline at constant speed.  The length is clamped to the range
+     * [0,{@link getLength}].  If calculate has not been called, this method
+     * returns 0.
+     *
+     * @param  length   the arc length from the start of the spline
+     *
+     * @return the parameter at the given arc length along the spline.
+     */
+    float getParameter(float length) const;
+
+    /**
+     * Returns the point at the given arc length along the spline.
+     *
+     * This method is the same as evaluating the spline at the parameter
+     * {@link getParameter}.  If calculate has not been called, this method
+     * returns the start of the spline.
+     *
+     * @param  length   the arc length from the start of the spline
+     *
+     * @return the point at the given arc length along the spline.
+     */
+    Vec2 getPointAtLength(float length) const;
+
+    /**
+     * Returns the parameter of the point on the spline nearest the given point.
+     *
+     * This method uses the bounding volume hierarchy of the approximation to
+     * skip every bezier that cannot contain the nearest point, and then solves
+     * the projection polynomial of the remaining ones.  Hence it is much faster
+     * than {@link CubicSpline#nearestParameter}, which solves a polynomial for
+     * every segment of the spline.  The result is exact for every criterion.
+     * If calculate has not been called, this method falls back to that slower
+     * method.
+     *
+     * @param  point    the point to project
+     *
+     * @return the parameter of the point on the spline nearest the given point.
+     */
+    float nearestParameter(const Vec2& point) const;
+
+    /**
+     * Returns the point on the spline nearest the given point.
+     *
+     * This method is the same as evaluating the spline at the parameter
+     * {@link nearestParameter}.  See that method for the performance details.
+     *
+     * @param  point    the point to project
+     *
+     * @return the point on the spline nearest the given point.
+     */
+    Vec2 nearestPoint(const Vec2& point) const;
+
 
 #pragma mark -
 #pragma mark Materialization
@@ -539,20 +686,53 @@ private:
      * Generates data via recursive use of de Castlejau's
      *
      * This method is the recursive helper for calculate(). It performs
-     * de Castlejau's algorithm and stores the data in the buffer.  You 
-     * will never call this method directly.
+     * de Castlejau's algorithm and stores the data in the buffers.  The
+     * subdivided beziers are kept on the stack, so this method does not
+     * allocate any memory other than the buffers.  You will never call this
+     * method directly.
      *
-     * @param  src          the control point list for the bezier
-     * @param  soff         the offset into the control point list
+     * @param  src          the four control points of the bezier
      * @param  tp           the parameter to split at
      * @param  tolerance    the error tolerance of the stopping condition
      * @param  criterion    the stopping condition criterion
      * @param  depth        the current depth of the recursive call
+     * @param  points       the buffer to store the control points
+     * @param  params       the buffer to store the parameters
      *
      * @return The number of (anchor) points generated by this recursive call.
      */
-    int generate(const std::vector<Vec2>& src, int soff, float tp,
-                 float tolerance, Criterion criterion, int depth);
+    static int generate(const Vec2* src, float tp, float tolerance, Criterion criterion,
+                        int depth, std::vector<Vec2>& points, std::vector<float>& params);
+
+    /**
+     * Computes the arc-length table for the approximation.
+     *
+     * The length of each bezier is estimated as the average of the length of
+     * its chord and the length of its control polygon.  This estimate is very
+     * accurate for the nearly flat beziers produced by the approximation.
+     */
+    void computeLengths();
+
+    /**
+     * Computes the bounding volume hierarchy for the approximation.
+     *
+     * The beziers of the approximation are ordered along the curve, so the
+     * hierarchy is built by repeatedly splitting the range of beziers in half.
+     */
+    void computeBounds();
+
+    /**
+     * Returns the position of the node covering the given range of beziers.
+     *
+     * This method is the recursive helper for {@link computeBounds}.  It
+     * appends the node and all of its descendants to the hierarchy.
+     *
+     * @param  begin    the first bezier in the range
+     * @param  end      the bezier after the last one in the range
+     *
+     * @return the position of the node covering the given range of beziers.
+     */
+    Uint32 buildBounds(Uint32 begin, Uint32 end);
 
     /**
      * Returns the currently "active" control points.
@@ -47,9 +47,13 @@
 #include "../CUPoly2.h"
 #include "../CUVec2.h"
 #include <vector>
+#include <memory>
 
 namespace cugl {
 
+// Forward reference to the thread pool
+class ThreadPool;
+
 // Forward reference to the opaque data class.
 class KivyData;
     
@@ -114,6 +118,15 @@ enum class PathCap :int {
  * generation takes too long.  However, note that this factory is not thread
  * safe in that you cannot access data while it is still in mid-calculation.
  *
+ * This factory also supports incremental extrusion of open paths.  Trails
+ * and ropes add a point at one end of the path (and drop one at the other)
+ * every frame.  Recalculating the extrusion each time is linear in the size
+ * of the path.  Instead, call {@link begin} once, and then use the methods
+ * {@link pushBack}, {@link popFront}, and {@link popBack}.  These update
+ * the extrusion in amortized constant time.  In addition, the extrusion
+ * can be written directly to a vertex and index buffer supplied by the
+ * caller, so that no polygon is allocated each frame.
+ *
  * CREDITS: This code is ported from the Kivy implementation of Line in package
  * kivy.vertex_instructions.  We believe that this port is acceptable within
  * the scope of the Kivy license.  There are no specific credits in that file,
@@ -129,6 +142,25 @@ enum class PathCap :int {
 class PathExtruder {
 #pragma mark Values
 private:
+    /**
+     * The layout of a single extruded segment in an incremental extrusion.
+     *
+     * Each segment is preceded by the joint connecting it to the previous
+     * segment (if any).  This order is the same for both vertices and
+     * indices, so that removing the first segment and the joint after it
+     * removes a prefix of the buffers.
+     */
+    typedef struct {
+        /** The position of the first joint vertex */
+        Uint32 vjoint;
+        /** The position of the first segment vertex */
+        Uint32 vquad;
+        /** The position of the first joint index */
+        Uint32 ijoint;
+        /** The position of the first segment index */
+        Uint32 iquad;
+    } Segment;
+    
     /** The set of vertices to use in the calculation */
     std::vector<Vec2> _input;
     /** Whether the path is closed */
@@ -137,17 +169,38 @@ private:
     /** The output results of extruded vertices */
     std::vector<Vec2> _outverts;
     /** The output results of extruded indices */
-    std::vector<unsigned short> _outindx;
+    std::vector<Uint32> _outindx;
     /** Whether or not the calculation has been run */
     bool _calculated;
     
+    /** Whether this extruder is performing an incremental extrusion */
+    bool _incremental;
+    /** The stroke width of the incremental extrusion */
+    float _stroke;
+    /** The joint type of the incremental extrusion */
+    PathJoint _joint;
+    /** The cap type of the incremental extrusion */
+    PathCap _cap;
+    /** The position of the first live input vertex (incremental only) */
+    size_t _infront;
+    /** The layout of the extruded segments (incremental only) */
+    std::vector<Segment> _segments;
+    /** The position of the first live segment (incremental only) */
+    size_t _segfront;
+    /** The number of output vertices before the caps (incremental only) */
+    size_t _bodyverts;
+    /** The number of output indices before the caps (incremental only) */
+    size_t _bodyindx;
+    
 #pragma mark -
 #pragma mark Constructors
 public:
     /**
      * Creates an extruder with no vertex data.
      */
-    PathExtruder() {}
+    PathExtruder() : _closed(false), _calculated(false), _incremental(false),
+    _stroke(0), _joint(PathJoint::NONE), _cap(PathCap::NONE),
+    _infront(0), _segfront(0), _bodyverts(0), _bodyindx(0) {}
     
     /**
      * Creates an extruder with the given vertex data.
@@ -158,7 +211,7 @@ public:
      * @param points    The vertices to extrude
      * @param closed    Whether the path is closed
      */
-    PathExtruder(const std::vector<Vec2>& points, bool closed) : _calculated(false) {
+    PathExtruder(const std::vector<Vec2>& points, bool closed) : PathExtruder() {
         _input = points; _closed = closed;
     }
     
@@ -174,7 +227,10 @@ public:
      *
      * @param poly    The vertices to extrude
      */
-    PathExtruder(const Poly2& poly) :  _calculated(false) { _input = poly._vertices; }
+    PathExtruder(const Poly2& poly) : PathExtruder() {
+        _input = poly._vertices;
+        _closed = poly.getIndexCount() == poly._vertices.size()*2;
+    }
     
     /**
      * Deletes this extruder, releasing all resources.
@@ -220,11 +276,11 @@ public:
     
     /**
      * Clears all internal data, but still maintains the initial vertex data.
+     *
+     * If this extruder is performing an incremental extrusion, this method
+     * ends it.  The vertex data is the current (live) path.
      */
-    void reset() {
-        _calculated = false;
-        _outverts.clear(); _outindx.clear();
-    }
+    void reset();
     
     /**
      * Clears all internal data, the initial vertex data.
@@ -233,8 +289,8 @@ public:
      * calling calculate.
      */
     void clear() {
-        _calculated = false;
-        _input.clear(); _outverts.clear(); _outindx.clear();
+        reset();
+        _input.clear();
     }
     
 #pragma mark -
@@ -265,6 +321,101 @@ public:
      */
     void calculate(float stroke, PathJoint joint=PathJoint::ROUND, PathCap cap = PathCap::ROUND);
     
+#pragma mark -
+#pragma mark Incremental Calculation
+    /**
+     * Starts an incremental extrusion of the current vertex data.
+     *
+     * This method extrudes the current vertex data, just like {@link calculate}.
+     * However, it also retains enough information to update the extrusion
+     * when a point is added or removed at either end of the path.  Use the
+     * methods {@link pushBack}, {@link popFront}, and {@link popBack} to
+     * modify the path.  Each of these methods takes amortized constant time,
+     * and the result is the same extrusion that calculate would produce for
+     * the new path (though the vertices may be in a different order).
+     *
+     * Incremental extrusion is only supported for open paths.  The stroke,
+     * joint, and cap are fixed until the extrusion is restarted.  Any call
+     * to {@link set}, {@link reset}, or {@link calculate} ends the
+     * incremental extrusion.
+     *
+     * @param stroke    The stroke width of the extrusion
+     * @param joint     The extrusion joint type.
+     * @param cap       The extrusion cap type.
+     */
+    void begin(float stroke, PathJoint joint=PathJoint::ROUND, PathCap cap = PathCap::ROUND);
+    
+    /**
+     * Returns true if this extruder is performing an incremental extrusion.
+     *
+     * @return true if this extruder is performing an incremental extrusion.
+     */
+    bool isIncremental() const { return _incremental; }
+    
+    /**
+     * Appends a point to the end of an incremental extrusion.
+     *
+     * This adds a new segment (and joint) to the extrusion, and moves the
+     * end cap.  It takes amortized constant time.
+     *
+     * @param point The point to append
+     */
+    void pushBack(const Vec2& point);
+    
+    /**
+     * Removes the first point of an incremental extrusion.
+     *
+     * This removes the first segment (and the joint after it), and moves
+     * the start cap.  It takes amortized constant time.  This is the
+     * appropriate way to shorten a trail.
+     */
+    void popFront();
+    
+    /**
+     * Removes the last point of an incremental extrusion.
+     *
+     * This removes the last segment (and the joint before it), and moves
+     * the end cap.  It takes constant time.
+     */
+    void popBack();
+    
+    /**
+     * Returns the number of points in the (live) path.
+     *
+     * In an incremental extrusion, this is the number of points after all
+     * of the push and pop operations.
+     *
+     * @return the number of points in the (live) path.
+     */
+    size_t getPathSize() const { return _input.size()-_infront; }
+    
+#pragma mark -
+#pragma mark Batch Calculation
+    /**
+     * Extrudes a batch of paths, storing the results in outputs.
+     *
+     * Each polygon in inputs must be a path.  As with {@link set}, a path is
+     * closed if the number of indices is twice the number of vertices.  Each
+     * path is extruded with the given stroke, joint, and cap, and the result
+     * is stored at the same position in outputs.  The outputs are resized to
+     * match the inputs, but any existing polygons are reused. Hence an output
+     * buffer kept between batches will not reallocate unless the polygons grow.
+     *
+     * The batch is divided among the threads of the pool (see {@link
+     * ThreadPool#parallelBatch}), with each chunk using its own extruder.
+     * This method blocks until the batch is complete.
+     *
+     * @param pool      The thread pool to perform the batch (may be nullptr)
+     * @param inputs    The paths to extrude
+     * @param outputs   The buffer to store the extruded polygons
+     * @param stroke    The stroke width of the extrusion
+     * @param joint     The extrusion joint type.
+     * @param cap       The extrusion end cap type.
+     */
+    static void extrude(const std::shared_ptr<ThreadPool>& pool,
+                        const std::vector<Poly2>& inputs, std::vector<Poly2>& outputs,
+                        float stroke, PathJoint joint=PathJoint::ROUND, PathCap cap = PathCap::ROUND);
+
 #pragma mark -
 #pragma mark Materialization
     /**
@@ -289,7 +440,8 @@ public:
      * will be adjusted accordingly. You should clear the buffer first if
      * you do not want to preserve the original data.
      *
-     * If the calculation is not yet performed, this method will do nothing.
+     * If the calculation is not yet performed, or the extrusion is empty,
+     * this method will do nothing.
      *
      * @param buffer    The buffer to store the extruded polygon
      *
@@ -297,6 +449,43 @@ public:
      */
     Poly2* getPolygon(Poly2* buffer);
     
+    /**
+     * Stores the path extrusion in the given vertex and index buffers.
+     *
+     * This method does not allocate any memory.  The vertex buffer must have
+     * room for {@link getVertexCount} elements, while the index buffer must
+     * have room for {@link getIndexCount} elements.  The value offset is added
+     * to every index.  This allows the extrusion to be written to the end of
+     * a larger mesh, such as the buffer of a {@link SpriteBatch}.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @param vertices  The buffer to store the extruded vertices
+     * @param indices   The buffer to store the extruded indices
+     * @param offset    The amount to add to each index
+     *
+     * @return the number of vertices written
+     */
+    size_t getPolygon(Vec2* vertices, Uint32* indices, Uint32 offset = 0) const;
+    
+    /**
+     * Returns the number of vertices in the path extrusion.
+     *
+     * If the calculation is not yet performed, this method will return 0.
+     *
+     * @return the number of vertices in the path extrusion.
+     */
+    size_t getVertexCount() const;
+    
+    /**
+     * Returns the number of indices in the path extrusion.
+     *
+     * If the calculation is not yet performed, this method will return 0.
+     *
+     * @return the number of indices in the path extrusion.
+     */
+    size_t getIndexCount() const;
+    
 #pragma mark -
 #pragma mark Internal Data Generation
 private:
@@ -329,6 +518,28 @@ private:
      */
     void makeSegment(const Vec2& a, const Vec2& b, KivyData* data);
 
+    /**
+     * Computes the extruded line segment from a to b without creating it.
+     *
+     * This method updates the algorithm state (including the previous
+     * segment), but does not modify _outvert or _outindx.
+     *
+     * @param a     The start of the line segment
+     * @param b     The end of the line segment.
+     * @param data  The data necessary to run the Kivy algorithm.
+     */
+    void computeSegment(const Vec2& a, const Vec2& b, KivyData* data);
+    
+    /**
+     * Creates the rectangle for the most recently computed segment.
+     *
+     * The new vertices are appended to _outvert, while the new _indices are
+     * appended to _outindx.
+     *
+     * @param data  The data necessary to run the Kivy algorithm.
+     */
+    void makeQuad(KivyData* data);
+
     /**
      * Creates a joint immediately before point a.
      *
@@ -390,10 +601,11 @@ private:
      * The new vertices are appended to _outvert, while the new _indices are
      * appended to _outindx.
      *
-     * @param count     The number of generating points in the path.
+     * @param start     The first generating point in the path.
+     * @param end       The last generating point in the path.
      * @param data      The data necessary to run the Kivy algorithm.
      */
-    void makeCaps(int count, KivyData* data);
+    void makeCaps(const Vec2& start, const Vec2& end, KivyData* data);
     
     /**
      * Creates square caps on the two ends of the open path.
@@ -401,10 +613,9 @@ private:
      * The new vertices are appended to _outvert, while the new _indices are
      * appended to _outindx.
      *
-     * @param count     The number of generating points in the path.
      * @param data      The data necessary to run the Kivy algorithm.
      */
-    void makeSquareCaps(int count, KivyData* data);
+    void makeSquareCaps(KivyData* data);
 
     /**
      * Creates round caps on the two ends of the open path.
@@ -412,10 +623,11 @@ private:
      * The new vertices are appended to _outvert, while the new _indices are
      * appended to _outindx.
      *
-     * @param count     The number of generating points in the path.
+     * @param start     The first generating point in the path.
+     * @param end       The last generating point in the path.
      * @param data      The data necessary to run the Kivy algorithm.
      */
-    void makeRoundCaps(int count, KivyData* data);
+    void makeRoundCaps(const Vec2& start, const Vec2& end, KivyData* data);
     
     /**
      * Creates the final joint at the end of a closed path.
@@ -428,6 +640,52 @@ private:
      * @return true if a joint was successfully created.
      */
     bool makeLastJoint(KivyData* data);
+    
+#pragma mark -
+#pragma mark Incremental Data Generation
+    /**
+     * Appends the segment ending at the given input position.
+     *
+     * The segment starts at the previous input vertex.  If there is a live
+     * segment before it, this method also creates the joint between them.
+     * The joint is placed before the segment in the output buffers.
+     *
+     * @param index The input position of the segment end
+     */
+    void appendSegment(size_t index);
+    
+    /**
+     * Removes the caps from the end of the output buffers.
+     */
+    void trimCaps();
+    
+    /**
+     * Appends the caps for the live path to the end of the output buffers.
+     */
+    void makeIncrementalCaps();
+    
+    /**
+     * Removes all data for vertices popped from the front of the path.
+     *
+     * This method is linear in the size of the path, but it is only called
+     * when at least half of the input is dead.  Hence it takes amortized
+     * constant time.  The caps must be trimmed before calling this method.
+     */
+    void compact();
+    
+    /**
+     * Returns the position of the first live output vertex.
+     *
+     * @return the position of the first live output vertex.
+     */
+    Uint32 getFrontVertex() const;
+    
+    /**
+     * Returns the position of the first live output index.
+     *
+     * @return the position of the first live output index.
+     */
+    Uint32 getFrontIndex() const;
 };
 }
 
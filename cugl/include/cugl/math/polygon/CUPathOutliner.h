@@ -38,8 +38,12 @@
 #include "../CUVec2.h"
 #include "CUSimpleTriangulator.h"
 #include <vector>
+#include <memory>
 
 namespace cugl {
+
+// Forward reference to the thread pool
+class ThreadPool;
     
 /** 
  * This enum lists the types of path traversal that are supported. 
@@ -81,7 +85,7 @@ private:
     /** The set of vertices to use in the calculation */
     std::vector<Vec2> _input;
     /** The output results of the path traversal */
-    std::vector<unsigned short> _output;
+    std::vector<Uint32> _output;
     /** Whether or not the calculation has been run */
     bool _calculated;
     
@@ -94,7 +98,7 @@ public:
     /**
      * Creates an outliner with no vertex data.
      */
-    PathOutliner() {}
+    PathOutliner() : _calculated(false) {}
     
     /**
      * Creates an outliner with the given vertex data.
@@ -191,6 +195,30 @@ public:
      */
     void calculate(PathTraversal traversal);
     
+#pragma mark -
+#pragma mark Batch Calculation
+    /**
+     * Outlines a batch of polygons, storing the results in outputs.
+     *
+     * Each polygon in inputs is outlined with the given traversal using only
+     * its vertex data, and the result is stored at the same position in
+     * outputs.  The outputs are resized to match the inputs, but any existing
+     * polygons are reused. Hence an output buffer kept between batches will
+     * not reallocate unless the polygons grow.
+     *
+     * The batch is divided among the threads of the pool (see {@link
+     * ThreadPool#parallelBatch}), with each chunk using its own outliner.
+     * This method blocks until the batch is complete.
+     *
+     * @param pool      The thread pool to perform the batch (may be nullptr)
+     * @param inputs    The polygons to outline
+     * @param outputs   The buffer to store the outlined polygons
+     * @param traversal The traversal type.
+     */
+    static void outline(const std::shared_ptr<ThreadPool>& pool,
+                        const std::vector<Poly2>& inputs, std::vector<Poly2>& outputs,
+                        PathTraversal traversal);
+
 #pragma mark -
 #pragma mark Materialization
     /**
@@ -202,6 +230,9 @@ public:
      * The outliner does not retain a reference to the returned list; it
      * is safe to modify it.
      *
+     * The list uses 16 bit indices, so the number of vertices may not exceed
+     * 65536.  Use the buffer version of this method for larger meshes.
+     *
      * If the calculation is not yet performed, this method will return the
      * empty list.
      *
@@ -222,6 +253,22 @@ public:
      *
      * @return the number of elements added to the buffer
      */
+    size_t getPath(std::vector<Uint32>& buffer);
+
+    /**
+     * Stores the path outline indices in the given 16-bit buffer.
+     *
+     * This version is for meshes that are known to be small, and which
+     * should be stored compactly (e.g. for upload to a 16-bit index buffer).
+     * The number of vertices may not exceed 65536.
+     *
+     * The indices will be appended to the provided vector. You should clear
+     * the vector first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @return the number of elements added to the buffer
+     */
     size_t getPath(std::vector<unsigned short>& buffer);
     
     /**
@@ -0,0 +1,586 @@
+//
+//  CUPolyClipper.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for boolean operations (union, intersection,
+//  difference, and exclusive-or) on polygons, as well as for offsetting
+//  (inflating or deflating) polygons.  This is the basis for destructible
+//  terrain, where an explosion is subtracted from the affected polygons.
+//
+//  The calculation is performed on an integer grid, in the style of Vatti's
+//  clipping algorithm.  The plane is divided into scanbeams at every vertex.
+//  Crossing edges are split at their (snapped) intersection points, so that
+//  the edges within a scanbeam are ordered.  The active edges then carry
+//  their winding numbers from one scanline to the next, and the result is
+//  assembled from the edges that bound the boolean operation.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#ifndef __CU_POLY_CLIPPER_H__
+#define __CU_POLY_CLIPPER_H__
+
+#include "../CUPoly2.h"
+#include "../CUVec2.h"
+#include "../../util/CUDebug.h"
+#include "CUPathExtruder.h"
+#include <vector>
+
+/** The default number of grid units per world unit for the clipper */
+#define DEFAULT_CLIP_PRECISION  1024.0f
+
+namespace cugl {
+
+/**
+ * The boolean operations supported by a polygon clipper.
+ *
+ * The operations combine the subject polygon with the clip polygon.
+ *
+ * This enumeration is used by {@link PolyClipper}.
+ */
+enum class ClipOperation : int {
+    /** The region inside either the subject or the clip */
+    UNION = 0,
+    /** The region inside both the subject and the clip */
+    INTERSECTION = 1,
+    /** The region inside the subject, but not the clip */
+    DIFFERENCE = 2,
+    /** The region inside exactly one of the subject and the clip */
+    XOR = 3
+};
+
+/**
+ * The fill rules supported by a polygon clipper.
+ *
+ * A fill rule determines which points are inside of a (possibly self-
+ * intersecting) polygon, based on its winding number.  The winding number
+ * of a point is the number of times the polygon outline travels counter-
+ * clockwise around it.
+ *
+ * This enumeration is used by {@link PolyClipper}.
+ */
+enum class FillRule : int {
+    /** A point is inside if its winding number is odd */
+    EVEN_ODD = 0,
+    /** A point is inside if its winding number is not zero */
+    NON_ZERO = 1,
+    /** A point is inside if its winding number is positive */
+    POSITIVE = 2
+};
+
+/**
+ * This class is a factory for boolean operations and offsets on polygons.
+ *
+ * A polygon clipper combines a subject polygon with a clip polygon.  Both
+ * polygons are a collection of closed outlines, which may have either
+ * orientation and may intersect themselves or each other.  The fill rule
+ * determines which points are inside of each polygon.  The clipper can also
+ * offset the subject polygon, growing (or shrinking) it by a fixed distance.
+ *
+ * The result is a collection of outlines that do not cross one another.
+ * The outer boundaries are counter-clockwise, while the holes are clockwise.
+ * Each outer boundary is followed by the holes inside of it.  This is the
+ * input expected by {@link ComplexTriangulator}, and the method
+ * {@link getPolygon} uses that triangulator to produce a solid polygon that
+ * can be used directly by a {@link PolygonObstacle}.
+ *
+ * The calculation is performed on an integer grid (in the style of Vatti's
+ * algorithm), which makes it robust against the floating point errors that
+ * plague most polygon clippers.  The vertices are snapped to the grid, so
+ * the precision of the result is the reciprocal of {@link getPrecision}.
+ * The grid coordinates must be less than 2^29 in absolute value.
+ *
+ * As with all factories, the methods are broken up into three phases:
+ * initialization, calculation, and materialization.  To use the factory, you
+ * first set the data (in this case the subject and clip polygons) with the
+ * initialization methods.  You then call the calculation method.  Finally,
+ * you use the materialization methods to access the data in several different
+ * ways.
+ *
+ * This division allows us to support multithreaded calculation if the data
+ * generation takes too long.  However, note that this factory is not thread
+ * safe in that you cannot access data while it is still in mid-calculation.
+ */
+class PolyClipper {
+#pragma mark Values
+private:
+    /** A point on the integer grid */
+    typedef struct {
+        /** The x-coordinate */
+        Sint64 x;
+        /** The y-coordinate */
+        Sint64 y;
+    } GridPoint;
+
+    /** An edge of the subject or clip, oriented bottom to top (or left to right) */
+    typedef struct {
+        /** The end point with the smaller y-coordinate */
+        GridPoint bot;
+        /** The end point with the larger y-coordinate */
+        GridPoint top;
+        /** The change in winding number when crossing left to right */
+        int wind;
+        /** Whether this edge belongs to the clip polygon */
+        bool clip;
+    } Edge;
+
+    /** A directed segment of the result boundary, with the interior on the left */
+    typedef struct {
+        /** The start of the segment */
+        GridPoint from;
+        /** The end of the segment */
+        GridPoint to;
+        /** The edge containing this segment (-1 if it is horizontal) */
+        int edge;
+    } Piece;
+
+    /** The vertices of the subject outlines */
+    std::vector<Vec2> _subject;
+    /** The number of vertices in each subject outline */
+    std::vector<size_t> _subloops;
+    /** The vertices of the clip outlines */
+    std::vector<Vec2> _clip;
+    /** The number of vertices in each clip outline */
+    std::vector<size_t> _cliploops;
+    /** The number of grid units per world unit */
+    float _precision;
+
+    /** The edges of the calculation */
+    std::vector<Edge> _edges;
+    /** The horizontal edges of the calculation, oriented left to right */
+    std::vector<Edge> _horizontals;
+    /** The pieces of the result boundary */
+    std::vector<Piece> _pieces;
+    /** The vertices of the result outlines (on the grid) */
+    std::vector<GridPoint> _gridverts;
+    /** The number of vertices in each result outline (on the grid) */
+    std::vector<size_t> _gridloops;
+
+    /** The vertices of the result outlines */
+    std::vector<Vec2> _output;
+    /** The number of vertices in each result outline */
+    std::vector<size_t> _outloops;
+    /** The number of outlines (the outer boundary and its holes) in each region */
+    std::vector<size_t> _outgroups;
+    /** Whether or not the calculation has been run */
+    bool _calculated;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a polygon clipper with no polygon data.
+     */
+    PolyClipper() : _precision(DEFAULT_CLIP_PRECISION), _calculated(false) {}
+
+    /**
+     * Creates a polygon clipper with the given subject polygon.
+     *
+     * See {@link setSubject} for how the outlines are extracted from the
+     * polygon.  The clipper does not retain any references to the original
+     * data.
+     *
+     * @param subject   The subject polygon
+     */
+    PolyClipper(const Poly2& subject) : _precision(DEFAULT_CLIP_PRECISION), _calculated(false) {
+        setSubject(subject);
+    }
+
+    /**
+     * Creates a polygon clipper with the given subject and clip polygons.
+     *
+     * See {@link setSubject} for how the outlines are extracted from the
+     * polygons.  The clipper does not retain any references to the original
+     * data.
+     *
+     * @param subject   The subject polygon
+     * @param clip      The clip polygon
+     */
+    PolyClipper(const Poly2& subject, const Poly2& clip) :
+    _precision(DEFAULT_CLIP_PRECISION), _calculated(false) {
+        setSubject(subject);
+        setClip(clip);
+    }
+
+    /**
+     * Deletes this polygon clipper, releasing all resources.
+     */
+    ~PolyClipper() {}
+
+
+#pragma mark -
+#pragma mark Initialization
+    /**
+     * Sets the subject polygon for this clipper.
+     *
+     * The outlines are extracted according to the polygon type.  If the
+     * polygon is SOLID, the outlines are the boundary edges of the
+     * triangulation (those edges that belong to exactly one triangle).  If
+     * it is a PATH, the outlines are the index segments, and any path that is
+     * open is treated as closed.  Otherwise, the vertices are treated as a
+     * single outline.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param poly  The subject polygon
+     */
+    void setSubject(const Poly2& poly);
+
+    /**
+     * Adds an outline to the subject polygon.
+     *
+     * The outline is closed, and may have either orientation.  This method
+     * resets all interal data.  You will need to reperform the calculation
+     * before accessing data.
+     *
+     * @param points    The vertices of the outline
+     */
+    void addSubject(const std::vector<Vec2>& points);
+
+    /**
+     * Sets the clip polygon for this clipper.
+     *
+     * The outlines are extracted as described in {@link setSubject}.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param poly  The clip polygon
+     */
+    void setClip(const Poly2& poly);
+
+    /**
+     * Adds an outline to the clip polygon.
+     *
+     * The outline is closed, and may have either orientation.  This method
+     * resets all interal data.  You will need to reperform the calculation
+     * before accessing data.
+     *
+     * @param points    The vertices of the outline
+     */
+    void addClip(const std::vector<Vec2>& points);
+
+    /**
+     * Returns the number of grid units per world unit.
+     *
+     * The vertices are snapped to a grid during the calculation.  Hence the
+     * reciprocal of this value is the precision of the result.
+     *
+     * @return the number of grid units per world unit.
+     */
+    float getPrecision() const { return _precision; }
+
+    /**
+     * Sets the number of grid units per world unit.
+     *
+     * The vertices are snapped to a grid during the calculation.  Hence the
+     * reciprocal of this value is the precision of the result.  The grid
+     * coordinates must be less than 2^29 in absolute value, so a larger
+     * precision limits the size of the polygons.
+     *
+     * This method resets all interal data.  You will need to reperform the
+     * calculation before accessing data.
+     *
+     * @param precision The number of grid units per world unit.
+     */
+    void setPrecision(float precision) {
+        CUAssertLog(precision > 0, "Precision must be positive");
+        reset();
+        _precision = precision;
+    }
+
+    /**
+     * Clears all computed data, but still maintains the settings.
+     *
+     * This method preserves the subject and clip polygons.  You will need to
+     * reperform the calculation before accessing data.
+     */
+    void reset() {
+        _calculated = false;
+        _output.clear(); _outloops.clear(); _outgroups.clear();
+    }
+
+    /**
+     * Clears all internal data, including the subject and clip polygons.
+     *
+     * When this method is called, you will need to set new polygons before
+     * calling calculate.
+     */
+    void clear() {
+        reset();
+        _subject.clear(); _subloops.clear();
+        _clip.clear(); _cliploops.clear();
+    }
+
+
+#pragma mark -
+#pragma mark Calculation
+    /**
+     * Performs a boolean operation on the subject and clip polygons.
+     *
+     * The fill rule determines which points are inside of the subject and
+     * the clip polygons.  Using {@link ClipOperation#UNION} with an empty
+     * clip polygon will simplify the subject polygon, removing any self-
+     * intersections.
+     *
+     * @param op    The boolean operation
+     * @param rule  The fill rule for the subject and clip polygons
+     */
+    void calculate(ClipOperation op, FillRule rule=FillRule::NON_ZERO);
+
+    /**
+     * Performs an offset of the subject polygon.
+     *
+     * If delta is positive, the polygon is grown by that distance (so holes
+     * will shrink).  If it is negative, the polygon is shrunk.  The joint
+     * determines the shape of the convex corners.  For a mitre joint, the
+     * limit is the maximum distance of the corner from the original vertex,
+     * as a multiple of delta.  A corner exceeding this limit is beveled.
+     * The other joints ignore this value.  The value {@link PathJoint#NONE}
+     * is treated as a bevel joint.
+     *
+     * The subject polygon is first simplified with the non-zero fill rule.
+     * The clip polygon is ignored.
+     *
+     * @param delta The distance to offset the outlines
+     * @param joint The shape of the convex corners
+     * @param limit The mitre limit
+     */
+    void offset(float delta, PathJoint joint=PathJoint::ROUND, float limit=2.0f);
+
+
+#pragma mark -
+#pragma mark Materialization
+    /**
+     * Returns the number of outlines in the result.
+     *
+     * If the calculation is not yet performed, this method will return 0.
+     *
+     * @return the number of outlines in the result.
+     */
+    size_t getOutlineCount() const { return _outloops.size(); }
+
+    /**
+     * Returns the number of regions in the result.
+     *
+     * A region is an outer boundary together with the holes inside of it.
+     * If the calculation is not yet performed, this method will return 0.
+     *
+     * @return the number of regions in the result.
+     */
+    size_t getRegionCount() const { return _outgroups.size(); }
+
+    /**
+     * Returns the outlines of the result.
+     *
+     * The outer boundaries are counter-clockwise, while the holes are
+     * clockwise.  Each outer boundary is followed by the holes inside of it.
+     * If the calculation is not yet performed, this method will return the
+     * empty list.
+     *
+     * @return the outlines of the result.
+     */
+    std::vector<std::vector<Vec2>> getOutlines() const;
+
+    /**
+     * Stores the outlines of the result in the given buffer.
+     *
+     * The outer boundaries are counter-clockwise, while the holes are
+     * clockwise.  Each outer boundary is followed by the holes inside of it.
+     * The outlines will be appended to the buffer.  You should clear the
+     * buffer first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @param buffer    The buffer to store the outlines
+     *
+     * @return the number of outlines added to the buffer
+     */
+    size_t getOutlines(std::vector<std::vector<Vec2>>& buffer) const;
+
+    /**
+     * Returns a wireframe polygon of the result outlines.
+     *
+     * The polygon is a PATH, with each outline closed.  The resulting polygon
+     * may be used as the subject or clip of another clipper.  If the
+     * calculation is not yet performed, this method will return the empty
+     * polygon.
+     *
+     * @return a wireframe polygon of the result outlines.
+     */
+    Poly2 getPath() const;
+
+    /**
+     * Stores a wireframe polygon of the result outlines in the buffer.
+     *
+     * The polygon is a PATH, with each outline closed.  The vertices (and
+     * indices) will be appended to the the Poly2 if it is not empty.  You
+     * should clear the Poly2 first if you do not want to preserve the
+     * original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @param buffer    The buffer to store the wireframe polygon
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPath(Poly2* buffer) const;
+
+    /**
+     * Returns a solid polygon of the result.
+     *
+     * Each region of the result is triangulated with a {@link ComplexTriangulator}.
+     * If the calculation is not yet performed, this method will return the
+     * empty polygon.
+     *
+     * @return a solid polygon of the result.
+     */
+    Poly2 getPolygon() const;
+
+    /**
+     * Stores a solid polygon of the result in the buffer.
+     *
+     * Each region of the result is triangulated with a {@link ComplexTriangulator}.
+     * The vertices (and indices) will be appended to the the Poly2 if it is
+     * not empty.  You should clear the Poly2 first if you do not want to
+     * preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @param buffer    The buffer to store the solid polygon
+     *
+     * @return a reference to the buffer for chaining.
+     */
+    Poly2* getPolygon(Poly2* buffer) const;
+
+
+#pragma mark -
+#pragma mark Internal Data Generation
+private:
+    /**
+     * Returns the grid point for the given vertex.
+     *
+     * @param point The vertex in world coordinates
+     *
+     * @return the grid point for the given vertex.
+     */
+    GridPoint toGrid(const Vec2& point) const;
+
+    /**
+     * Appends the edges of the given outlines to the calculation.
+     *
+     * Horizontal edges do not change the winding number of any scanbeam, so
+     * they are stored separately.  They are only needed to split the edges
+     * that cross them.
+     *
+     * @param points    The vertices of the outlines
+     * @param loops     The number of vertices in each outline
+     * @param clip      Whether the outlines belong to the clip polygon
+     */
+    void computeEdges(const std::vector<GridPoint>& points, const std::vector<size_t>& loops,
+                      bool clip);
+
+    /**
+     * Splits the edges of the calculation at their intersection points.
+     *
+     * This method sweeps the scanbeams, and finds every pair of edges that
+     * changes order within a scanbeam (or at a scanline that is not a vertex
+     * of either edge).  Both edges are split at their intersection point,
+     * snapped to the grid.  An edge is also split where it crosses the interior
+     * of a horizontal edge, as the winding numbers change there.  The active
+     * edges stay sorted from one scanbeam to the next, so each scanbeam is only
+     * an insertion sort of a nearly sorted list.  Snapping can (rarely) create
+     * new intersections, so this method should be called until it returns false.
+     *
+     * @return true if any edges were split
+     */
+    bool splitEdges();
+
+    /**
+     * Computes the pieces of the result boundary.
+     *
+     * This method sweeps the scanlines at the vertices of the edges.  The
+     * edges do not cross between scanlines, so the active edges keep their
+     * order, and each one keeps the winding numbers of the region to its right.
+     * At a scanline, only the edges through a vertex are reordered, and only
+     * their winding numbers change.  Each edge is a piece of the result
+     * boundary from one vertex to the next if it separates an included region
+     * from an excluded one.  The horizontal pieces are the spans between two
+     * vertices on a scanline where the region just below is included and the
+     * region just above is not (or vice versa).
+     *
+     * @param op    The boolean operation
+     * @param rule  The fill rule for the subject and clip polygons
+     */
+    void computePieces(ClipOperation op, FillRule rule);
+
+    /**
+     * Links the pieces of the result boundary into outlines.
+     *
+     * At a vertex shared by several outlines, the link turns as far left as
+     * possible.  Consecutive pieces of the same edge are merged, and colinear
+     * vertices are removed.
+     */
+    void computeLoops();
+
+    /**
+     * Sorts the result outlines into regions, and converts them to world space.
+     *
+     * Each hole is assigned to the smallest outer boundary containing it.
+     */
+    void computeRegions();
+
+    /**
+     * Performs a boolean operation on the current edges.
+     *
+     * The result is stored in the grid buffers.
+     *
+     * @param op    The boolean operation
+     * @param rule  The fill rule for the subject and clip polygons
+     */
+    void solve(ClipOperation op, FillRule rule);
+
+    /**
+     * Appends the offset of the given outline to the buffer.
+     *
+     * The offset is not simplified, and may intersect itself.  However, the
+     * winding number of the result is positive exactly on the offset region.
+     *
+     * @param points    The vertices of the outline
+     * @param size      The number of vertices in the outline
+     * @param delta     The offset distance (in grid units)
+     * @param joint     The shape of the convex corners
+     * @param limit     The mitre limit
+     * @param buffer    The buffer to store the offset outline
+     *
+     * @return the number of vertices added to the buffer
+     */
+    size_t offsetLoop(const GridPoint* points, size_t size, double delta,
+                      PathJoint joint, double limit, std::vector<GridPoint>& buffer);
+};
+
+}
+#endif /* __CU_POLY_CLIPPER_H__ */
@@ -41,8 +41,12 @@
 #include "../CUPoly2.h"
 #include "../CUVec2.h"
 #include <vector>
+#include <memory>
 
 namespace cugl {
+
+// Forward reference to the thread pool
+class ThreadPool;
     
 /**
  * This class is a factory for producing solid Poly2 objects from a set of vertices.
@@ -87,9 +91,9 @@ private:
     /** The classification type of each vertex in the triangulation */
     std::vector<VertexType> _types;
     /** A naive, intermediate triangulation.  The final triangulation builds from this */
-    std::vector<unsigned short> _naive;
+    std::vector<Uint32> _naive;
     /** The output results of the triangulation */
-    std::vector<unsigned short> _output;
+    std::vector<Uint32> _output;
     /** Whether or not the calculation has been run */
     bool _calculated;
 
@@ -100,7 +104,7 @@ public:
     /**
      * Creates a triangulator with no vertex data.
      */
-    SimpleTriangulator() {}
+    SimpleTriangulator() : _calculated(false) {}
 
     /**
      * Creates a triangulator with the given vertex data.
@@ -192,6 +196,28 @@ public:
      */
     void calculate();
     
+#pragma mark -
+#pragma mark Batch Calculation
+    /**
+     * Triangulates a batch of polygons, storing the results in outputs.
+     *
+     * Each polygon in inputs is triangulated using only its vertex data, and
+     * the result is stored at the same position in outputs.  The outputs are
+     * resized to match the inputs, but any existing polygons are reused.
+     * Hence an output buffer kept between batches will not reallocate unless
+     * the polygons grow.
+     *
+     * The batch is divided among the threads of the pool (see {@link
+     * ThreadPool#parallelBatch}), with each chunk using its own triangulator.
+     * This method blocks until the batch is complete.
+     *
+     * @param pool      The thread pool to perform the batch (may be nullptr)
+     * @param inputs    The polygons to triangulate
+     * @param outputs   The buffer to store the triangulated polygons
+     */
+    static void triangulate(const std::shared_ptr<ThreadPool>& pool,
+                            const std::vector<Poly2>& inputs, std::vector<Poly2>& outputs);
+
 #pragma mark -
 #pragma mark Materialization
     /**
@@ -203,6 +229,9 @@ public:
      * The triangulator does not retain a reference to the returned list; it
      * is safe to modify it.
      *
+     * The list uses 16 bit indices, so the number of vertices may not exceed
+     * 65536.  Use the buffer version of this method for larger meshes.
+     *
      * If the calculation is not yet performed, this method will return the
      * empty list.
      *
@@ -223,6 +252,22 @@ public:
      *
      * @return the number of elements added to the buffer
      */
+    size_t getTriangulation(std::vector<Uint32>& buffer);
+
+    /**
+     * Stores the triangulation indices in the given 16-bit buffer.
+     *
+     * This version is for meshes that are known to be small, and which
+     * should be stored compactly (e.g. for upload to a 16-bit index buffer).
+     * The number of vertices may not exceed 65536.
+     *
+     * The indices will be appended to the provided vector. You should clear
+     * the vector first if you do not want to preserve the original data.
+     *
+     * If the calculation is not yet performed, this method will do nothing.
+     *
+     * @return the number of elements added to the buffer
+     */
     size_t getTriangulation(std::vector<unsigned short>& buffer);
 
     /**
@@ -31,6 +31,8 @@
 #include "CUPathExtruder.h"
 #include "CUPathOutliner.h"
 #include "CUSimpleTriangulator.h"
+#include "CUComplexTriangulator.h"
 #include "CUCubicSplineApproximator.h"
+#include "CUPolyClipper.h"
 
 #endif /* __CU_POLYGON_PKG_H__ */
\ No newline at end of file
@@ -766,6 +766,31 @@ public:
         fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
 
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+              const Mat4& transform, bool tint = true) {
+        fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
+
     /**
      * Fills the triangulated vertices with the current texture.
      *
@@ -791,6 +816,31 @@ public:
         fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
 
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+              const Affine2& transform, bool tint = true) {
+        fill(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
+
     /**
      * Fills the triangulated vertices with the current texture.
      *
@@ -819,6 +869,34 @@ public:
               const unsigned short* indices, unsigned int isize, unsigned int ioffset,
               const Mat4& transform, bool tint = true);
 
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+              const Uint32* indices, unsigned int isize, unsigned int ioffset,
+              const Mat4& transform, bool tint = true);
+
     /**
      * Fills the triangulated vertices with the current texture.
      *
@@ -847,6 +925,34 @@ public:
               const unsigned short* indices, unsigned int isize, unsigned int ioffset,
               const Affine2& transform, bool tint = true);
 
+    /**
+     * Fills the triangulated vertices with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other fill methods.  The texture no longer needs to be
+     * drawn uniformly over the shape. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The triangulation will be determined by the given indices. If necessary,
+     * these can be generated via one of the triangulation factories
+     * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+              const Uint32* indices, unsigned int isize, unsigned int ioffset,
+              const Affine2& transform, bool tint = true);
+
 #pragma mark -
 #pragma mark Outlines
     /**
@@ -1101,6 +1207,32 @@ public:
         outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+                 const Mat4& transform, bool tint = true) {
+        outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
+    
+
     /**
      * Outlines the vertex path with the current texture.
      *
@@ -1126,6 +1258,32 @@ public:
         outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
     }
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The list of vertices
+     * @param indices   The triangulation list
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const std::vector<Vertex2>& vertices, const std::vector<Uint32>& indices,
+                 const Affine2& transform, bool tint = true) {
+        outline(vertices.data(),(unsigned int)vertices.size(),0,indices.data(),(unsigned int)indices.size(),0,transform,tint);
+    }
+    
+
     /**
      * Outlines the vertex path with the current texture.
      *
@@ -1154,6 +1312,35 @@ public:
                  const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                  const Mat4& transform, bool tint = true);
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                 const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                 const Mat4& transform, bool tint = true);
+    
+
     /**
      * Outlines the vertex path with the current texture.
      *
@@ -1182,6 +1369,35 @@ public:
                  const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                  const Affine2& transform, bool tint = true);
     
+    /**
+     * Outlines the vertex path with the current texture.
+     *
+     * This method provides more fine tuned control over texture coordinates
+     * that the other outline methods.  The texture no longer needs to be
+     * drawn uniformly over the wireframe. The transform will be applied to the
+     * vertex positions directly in world space.
+     *
+     * The vertex path will be determined by the provided indices. The indices
+     * should be a multiple of two, preferably generated by the factories
+     * {@link PathOutliner} or {@link CubicSplineApproximator}.
+     *
+     * The vertices use their own color values.  However, if tint is true, these
+     * values will be tinted (i.e. multiplied) by the current active color.
+     *
+     * @param vertices  The array of vertices
+     * @param vsize     The size of the vertex array
+     * @param voffset   The first element of the vertex array
+     * @param indices   The triangulation array
+     * @param isize     The size of the index array
+     * @param ioffset   The first element of the index array
+     * @param transform The coordinate transform
+     * @param tint      Whether to tint with the active color
+     */
+    void outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                 const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                 const Affine2& transform, bool tint = true);
+    
+
 #pragma mark -
 #pragma mark Convenience Methods
     /**
@@ -1859,6 +2075,19 @@ private:
      * @return true if the vertex buffer was successfully allocated.
      */
     bool validateBuffer(GLuint buffer, const char* message);
+
+    /**
+     * Reserves room in the drawing buffer for a mesh of the given size.
+     *
+     * If the mesh does not fit in the remaining space, the buffer is flushed.
+     * If the mesh is larger than the entire buffer, the buffer is grown to
+     * fit it.  Hence a single mesh may exceed the capacity of this sprite
+     * batch (the capacity is only the size at which the batch is flushed).
+     *
+     * @param vsize     The number of vertices to add
+     * @param isize     The number of indices to add
+     */
+    void reserve(unsigned int vsize, unsigned int isize);
     
     /**
      * Returns the number of vertices added to the drawing buffer.
@@ -1907,6 +2136,28 @@ private:
                          const unsigned short* indices, unsigned int isize, unsigned int ioffset,
                          bool solid, bool tint = true);
 
+
+    /**
+     * Returns the number of vertices added to the drawing buffer.
+     *
+     * This method adds the given vertices and indices to the drawing buffer, 
+     * but does not draw them.  You must call flush() to draw the mesh.
+     *
+     * @param vertices  The vertices to add to the buffer
+     * @param vsize     The number of vertices to add
+     * @param voffset   The position of the first vertex to add
+     * @param indices   The indices to add to the buffer
+     * @param isize     The number of indices to add
+     * @param ioffset   The position of the first index to add
+     * @param solid     Whether the vertex mesh is to be filled
+     * @param tint      Whether to tint with the active color
+     *
+     * @return the number of vertices added to the drawing buffer.
+     */
+    unsigned int prepare(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                         const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                         bool solid, bool tint = true);
+
 };
 
 }
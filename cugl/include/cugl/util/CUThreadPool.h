@@ -37,6 +37,9 @@
 #include <cugl/base/CUBase.h>
 #include <SDL/SDL.h>
 #include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <stdio.h>
 #include <queue>
 #include <vector>
@@ -47,6 +50,9 @@
     #define CU_SDL_THREADS 1
 #endif
 
+/** The default number of elements assigned to a thread at a time in a batch */
+#define DEFAULT_BATCH_GRAIN 8
+
 namespace cugl {
 
 #pragma mark -
@@ -191,6 +197,61 @@ public:
      */
     void addTask(const std::function<void()> &task);
     
+    /**
+     * Executes the given function over a range in parallel, blocking until done.
+     *
+     * The range [0,count) is split into chunks of grain elements, and the
+     * function is called once per chunk with the bounds [begin,end) of that
+     * chunk.  The chunks are shared between the worker threads and the calling
+     * thread, so this method makes progress even if all of the workers are
+     * busy with other tasks (e.g. asset loading).  It is also safe to call
+     * this method from within a task of this pool.
+     *
+     * This method returns only when every chunk has been processed. The
+     * function must be safe to call concurrently on disjoint ranges.  If the
+     * pool is stopped, or there is only one chunk, the function is executed 
+     * on the calling thread.
+     *
+     * @param count The number of elements to process
+     * @param grain The maximum number of elements in a chunk
+     * @param body  The function to call on each chunk
+     */
+    void parallelFor(size_t count, size_t grain,
+                     const std::function<void(size_t begin, size_t end)>& body);
+
+    /**
+     * Executes the given function on each element of a batch, blocking until done.
+     *
+     * This is a convenience wrapper around {@link parallelFor} for batches
+     * that need scratch state, such as the polygon factories.  Every chunk
+     * default constructs its own State, and calls body(state,ii) for each
+     * element ii of the chunk.  Hence the state is reused within a chunk,
+     * but is never shared between threads.
+     *
+     * If pool is nullptr, the batch is executed as a single chunk on the
+     * calling thread.
+     *
+     * @param pool  The thread pool to perform the batch (may be nullptr)
+     * @param count The number of elements to process
+     * @param body  The function to call on each element
+     * @param grain The maximum number of elements in a chunk
+     */
+    template <typename State, typename Body>
+    static void parallelBatch(const std::shared_ptr<ThreadPool>& pool, size_t count,
+                              const Body& body, size_t grain=DEFAULT_BATCH_GRAIN) {
+        auto chunk = [&](size_t begin, size_t end) {
+            State state;
+            for(size_t ii = begin; ii < end; ii++) {
+                body(state, ii);
+            }
+        };
+        if (pool != nullptr) {
+            pool->parallelFor(count, grain, chunk);
+        } else {
+            chunk(0, count);
+        }
+    }
+    
     /**
      * Stop the thread pool, marking it for shut down.
      *
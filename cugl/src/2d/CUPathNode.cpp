@@ -73,8 +73,8 @@ _endcap(PathCap::NONE) {
  * The polygon will be extruded using the given sequence of vertices.
  * First it will traverse the vertices using either a closed or open
  * traveral.  Then it will extrude that polygon with the given joint
- * and cap. PathNode objects share a single extruder, so this initializer
- * is not thread safe.
+ * and cap. Each thread has its own extruder, so the geometry for this
+ * initializer may be computed on a worker thread.
  *
  * @param vertices  The vertices to texture (expressed in image space)
  * @param stroke    The stroke width of the extruded path.
@@ -103,8 +103,8 @@ bool PathNode::initWithVertices(const std::vector<Vec2>& vertices, float stroke,
  * The polygon will be extruded using the given polygon, assuming that it
  * is a (connected) path. It will extrude that polygon with the given joint
  * and cap.  It will assume the polygon is closed if the number of indices
- * is twice the number of vertices. PathNode objects share a single extruder,
- * so this initializer is not thread safe.
+ * is twice the number of vertices. Each thread has its own extruder, so the
+ * geometry for this initializer may be computed on a worker thread.
  *
  * @param poly      The polygon to texture (expressed in image space)
  * @param stroke    The stroke width of the extruded path.
@@ -116,7 +116,7 @@ bool PathNode::initWithVertices(const std::vector<Vec2>& vertices, float stroke,
 bool PathNode::initWithPoly(const Poly2& poly, float stroke, PathJoint joint, PathCap cap) {
     _joint  = joint;
     _endcap = cap;
-    _closed = (poly.getVertices().size()*2 == poly.getIndices().size());
+    _closed = (poly.getVertices().size()*2 == poly.getIndexCount());
     _stroke = stroke;
     return init(poly);
 }
@@ -229,8 +229,9 @@ void PathNode::setCap(PathCap cap) {
  *
  * The polygon will be extruded using the given sequence of vertices.
  * First it will traverse the vertices using the current traversal. Then
- * it will extrude that polygon with the current joint and cap. PathNode
- * objects share a single extruder, so this method is not thread safe.
+ * it will extrude that polygon with the current joint and cap. Each thread has
+ * its own extruder, so the geometry for this method may be computed on a worker
+ * thread.
  *
  * @param vertices  The vertices to texture
  */
@@ -247,13 +248,13 @@ void PathNode::setPolygon(const std::vector<Vec2>& vertices) {
  *
  * This method will extrude that polygon with the current joint and cap.
  * The polygon is assumed to be closed if the number of indices is twice
- * the number of vertices. PathNode objects share a single extruder, so
- * this method is not thread safe.
+ * the number of vertices. Each thread has its own extruder, so the geometry for
+ * this method may be computed on a worker thread.
  *
  * @param poly  The polygon to texture
  */
 void PathNode::setPolygon(const Poly2& poly) {
-    _closed = poly.getVertices().size()*2 == poly.getIndices().size();
+    _closed = poly.getVertices().size()*2 == poly.getIndexCount();
     TexturedNode::setPolygon(poly);
     updateExtrusion();
 }
@@ -263,8 +264,8 @@ void PathNode::setPolygon(const Poly2& poly) {
  *
  * The rectangle will be converted into a Poly2, using the standard outline.
  * This is the same as passing Poly2(rect,false). It will then be extruded
- * with the current joint and cap. PathNode objects share a single extruder,
- * so this method is not thread safe.
+ * with the current joint and cap. Each thread has its own extruder, so the
+ * geometry for this method may be computed on a worker thread.
  *
  * @param rect  The rectangle to texture
  */
@@ -306,13 +307,22 @@ void PathNode::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& trans
     
     batch->setColor(tint);
     batch->setTexture(_texture);
-    if (_stroke > 0) {
+    const Poly2& poly = (_stroke > 0 ? _extrusion : _polygon);
+    if (_stroke > 0 && poly.isWide()) {
+        batch->fill(_vertices.data(),(unsigned int)_vertices.size(),0,
+                    poly.getWideIndices().data(),(unsigned int)poly.getIndexCount(),0,
+                    transform);
+    } else if (_stroke > 0) {
         batch->fill(_vertices.data(),(unsigned int)_vertices.size(),0,
-                    _extrusion.getIndices().data(),(unsigned int)_extrusion.getIndices().size(),0,
+                    poly.getIndices().data(),(unsigned int)poly.getIndexCount(),0,
                     transform);
+    } else if (poly.isWide()) {
+        batch->outline(_vertices.data(),(unsigned int)_vertices.size(),0,
+                       poly.getWideIndices().data(),(unsigned int)poly.getIndexCount(),0,
+                       transform);
     } else {
         batch->outline(_vertices.data(),(unsigned int)_vertices.size(),0,
-                       _polygon.getIndices().data(),(unsigned int)_polygon.getIndices().size(),0,
+                       poly.getIndices().data(),(unsigned int)poly.getIndexCount(),0,
                        transform);
     }
 }
@@ -350,8 +360,8 @@ void PathNode::generateRenderData() {
     _rendered = true;
 }
 
-/** An extruder for those incomplete polygons */
-PathExtruder PathNode::_extruder;
-/** An outliner for those incomplete polygons */
-PathOutliner PathNode::_outliner;
+/** An extruder for those incomplete polygons (one per thread) */
+thread_local PathExtruder PathNode::_extruder;
+/** An outliner for those incomplete polygons (one per thread) */
+thread_local PathOutliner PathNode::_outliner;
 
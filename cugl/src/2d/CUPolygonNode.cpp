@@ -49,8 +49,8 @@ using namespace cugl;
  * Sets the texture polgon to the vertices expressed in image space.
  *
  * The polygon will be triangulated using the rules of SimpleTriangulator.
- * All PolygonNode objects share a single triangulator, so this method is
- * not thread safe.
+ * Each thread has its own triangulator, so the geometry for this method may be
+ * computed on a worker thread.
  *
  * @param   vertices The vertices to texture
  * @param   offset   The offset in vertices
@@ -127,11 +127,18 @@ void PolygonNode::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& tr
     
     batch->setColor(tint);
     batch->setTexture(_texture);
-    batch->fill(_vertices.data(),(unsigned int)_vertices.size(),0,
-                _polygon.getIndices().data(),(unsigned int)_polygon.getIndices().size(),0,
-                transform);
+    const Poly2& poly = _polygon;
+    if (poly.isWide()) {
+        batch->fill(_vertices.data(),(unsigned int)_vertices.size(),0,
+                    poly.getWideIndices().data(),(unsigned int)poly.getIndexCount(),0,
+                    transform);
+    } else {
+        batch->fill(_vertices.data(),(unsigned int)_vertices.size(),0,
+                    poly.getIndices().data(),(unsigned int)poly.getIndexCount(),0,
+                    transform);
+    }
 }
 
-/** A triangulator for those incomplete polygons */
-SimpleTriangulator PolygonNode::_triangulator;
+/** A triangulator for those incomplete polygons (one per thread) */
+thread_local SimpleTriangulator PolygonNode::_triangulator;
 
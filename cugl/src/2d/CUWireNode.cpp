@@ -53,8 +53,8 @@ using namespace cugl;
  * color.
  *
  * The polygon will be outlined using the given traversal in PathOutliner.
- * WireNode objects share a single path outliner, so this initializer is
- * not thread safe.
+ * Each thread has its own path outliner, so the geometry for this initializer
+ * may be computed on a worker thread.
  *
  * @param vertices  The vertices to texture (expressed in image space)
  * @param traveral  The path traversal for index generation
@@ -112,8 +112,8 @@ bool WireNode::initWithEllipse(const Vec2& center, const Size& size, unsigned in
  * Sets the traversal of this path.
  *
  * If the traversal is different from the current known traversal, it will
- * recompute the traveral using the PathOutliner. All WireNode objects share
- * a single path outliner, so this method is not thread safe.
+ * recompute the traveral using the PathOutliner. Each thread has its own path
+ * outliner, so the geometry for this method may be computed on a worker thread.
  *
  * @param traversal The new wireframe traversal
  */
@@ -134,8 +134,8 @@ void WireNode::setTraversal(PathTraversal traversal) {
  *
  * The polygon will be outlined using a CLOSED traversal in PathOutliner.
  * To create a different traversal, use the alternate setPolygon() method.
- * All WireNode objects share a single path outliner, so this method is not
- * thread safe.
+ * Each thread has its own path outliner, so the geometry for this method may be
+ * computed on a worker thread.
  *
  * @param vertices  The vertices to draw
  */
@@ -153,8 +153,8 @@ void WireNode::setPolygon(const std::vector<Vec2>& vertices) {
  * Sets the wireframe polgon to the vertices expressed in texture space.
  *
  * The polygon will be outlined using the given traversal in PathOutliner.
- * All WireNode objects share a single path outliner, so this method is not
- * thread safe.
+ * Each thread has its own path outliner, so the geometry for this method may be
+ * computed on a worker thread.
  *
  * @param vertices  The vertices to draw
  */
@@ -262,12 +262,19 @@ void WireNode::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& trans
     
     batch->setColor(tint);
     batch->setTexture(_texture);
-    batch->outline(_vertices.data(),(unsigned int)_vertices.size(),0,
-                   _polygon.getIndices().data(),(unsigned int)_polygon.getIndices().size(),0,
-                   transform);
+    const Poly2& poly = _polygon;
+    if (poly.isWide()) {
+        batch->outline(_vertices.data(),(unsigned int)_vertices.size(),0,
+                       poly.getWideIndices().data(),(unsigned int)poly.getIndexCount(),0,
+                       transform);
+    } else {
+        batch->outline(_vertices.data(),(unsigned int)_vertices.size(),0,
+                       poly.getIndices().data(),(unsigned int)poly.getIndexCount(),0,
+                       transform);
+    }
 
 }
 
-/** An outliner for those incomplete polygons */
-PathOutliner WireNode::_outliner;
+/** An outliner for those incomplete polygons (one per thread) */
+thread_local PathOutliner WireNode::_outliner;
 
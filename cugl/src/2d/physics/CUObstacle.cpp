@@ -45,6 +45,7 @@
 //  Version: 11/6/16
 //
 #include <cugl/2d/physics/CUObstacle.h>
+#include <cugl/2d/physics/CUObstacleWorld.h>
 #include <memory>
 #include <iostream>
 #include <sstream>
@@ -63,7 +64,11 @@ using namespace cugl;
 Obstacle::Obstacle() :
 _scene(nullptr),
 _debug(nullptr),
-_listener(nullptr)
+_listener(nullptr),
+_owner(nullptr),
+_linked(nullptr),
+_syncstep(0),
+_syncwait(false)
 { }
 
 /**
@@ -126,6 +131,25 @@ void Obstacle::setBodyState(const b2Body& body) {
 }
 
 
+/**
+ * Marks this obstacle for synchronization at the next world update.
+ *
+ * An {@link ObstacleWorld} only synchronizes (e.g. calls {@link update})
+ * the obstacles whose bodies are awake.  Sleeping and static bodies are
+ * skipped.  If you change the state of such a body by hand, you should
+ * call this method so that its scene graph nodes are repositioned.  The
+ * setters for position and angle do this automatically.
+ *
+ * This method does nothing if the obstacle is not in a world.
+ */
+void Obstacle::markSync() {
+    if (_owner != nullptr && !_syncwait) {
+        _syncwait = true;
+        _owner->_pending.push_back(this);
+    }
+}
+
+
 #pragma mark -
 #pragma mark MassData Methods
 
@@ -46,8 +46,14 @@
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Dynamics/Joints/b2MouseJoint.h>
 #include <cugl/2d/physics/CUObstacleWorld.h>
 #include <cugl/2d/physics/CUObstacle.h>
+#include <cugl/2d/physics/CUComplexObstacle.h>
+#include <cugl/2d/CUNode.h>
+#include <cugl/util/CUThreadPool.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace cugl;
 
@@ -56,6 +62,117 @@ using namespace cugl;
 /** The default value of gravity (going down) */
 #define DEFAULT_GRAVITY -9.8f
 
+/** The magic number identifying a world snapshot ('CUSW') */
+#define SNAPSHOT_MAGIC   0x43555357
+/** The current snapshot format version */
+#define SNAPSHOT_VERSION 1
+/** The snapshot flag for delta snapshots */
+#define SNAPSHOT_DELTA   1
+/** The size of the snapshot header in bytes */
+#define SNAPSHOT_HEADER  24
+/** The size of a (full) body record in bytes */
+#define SNAPSHOT_BODY    (6*sizeof(float)+1)
+
+#pragma mark -
+#pragma mark Snapshot Encoding
+
+/**
+ * Appends the given value to the buffer in native byte order.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The value to append
+ */
+template <typename T>
+static void snapshot_put(std::vector<Uint8>& buffer, T value) {
+    size_t pos = buffer.size();
+    buffer.resize(pos+sizeof(T));
+    std::memcpy(buffer.data()+pos, &value, sizeof(T));
+}
+
+/**
+ * Overwrites the value in the buffer at the given position.
+ *
+ * @param buffer    The buffer to write to
+ * @param pos       The byte position to write at
+ * @param value     The value to write
+ */
+template <typename T>
+static void snapshot_set(std::vector<Uint8>& buffer, size_t pos, T value) {
+    std::memcpy(buffer.data()+pos, &value, sizeof(T));
+}
+
+/**
+ * Reads a value from the buffer in native byte order.
+ *
+ * The position is advanced past the value.  If there are not enough bytes
+ * left in the buffer, this function returns false and does not read.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The byte position to read at
+ * @param value     The value to store the result
+ *
+ * @return true if the value was read
+ */
+template <typename T>
+static bool snapshot_get(const std::vector<Uint8>& buffer, size_t& pos, T& value) {
+    if (pos+sizeof(T) > buffer.size()) {
+        return false;
+    }
+    std::memcpy(&value, buffer.data()+pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+/**
+ * Appends the state of the given body to the buffer.
+ *
+ * @param buffer    The buffer to append to
+ * @param body      The body to record
+ */
+static void snapshot_body(std::vector<Uint8>& buffer, const b2Body* body) {
+    const b2Vec2& pos = body->GetPosition();
+    const b2Vec2& vel = body->GetLinearVelocity();
+    snapshot_put(buffer, pos.x);
+    snapshot_put(buffer, pos.y);
+    snapshot_put(buffer, body->GetAngle());
+    snapshot_put(buffer, vel.x);
+    snapshot_put(buffer, vel.y);
+    snapshot_put(buffer, body->GetAngularVelocity());
+    snapshot_put(buffer, (Uint8)(body->IsAwake() ? 1 : 0));
+}
+
+/**
+ * Returns the position of the fixture in the fixture list of its body.
+ *
+ * @param fixture   The fixture to index
+ *
+ * @return the position of the fixture in the fixture list of its body.
+ */
+static Uint16 snapshot_fixture(const b2Fixture* fixture) {
+    Uint16 index = 0;
+    for(const b2Fixture* f = fixture->GetBody()->GetFixtureList(); f != fixture; f = f->GetNext()) {
+        index++;
+    }
+    return index;
+}
+
+/**
+ * Returns the fixture at the given position in the fixture list of body.
+ *
+ * @param body      The body with the fixture
+ * @param index     The position in the fixture list
+ *
+ * @return the fixture at the given position (or nullptr if invalid)
+ */
+static b2Fixture* snapshot_fixture(b2Body* body, Uint16 index) {
+    b2Fixture* f = body->GetFixtureList();
+    for(Uint16 ii = 0; f != nullptr && ii < index; ii++) {
+        f = f->GetNext();
+    }
+    return f;
+}
+
+
 #pragma mark -
 #pragma mark Proxy Classes
 
@@ -151,6 +268,113 @@ public:
     }
 };
 
+/**
+ * A b2RayCastCallback for the closest hit of a batched query.
+ *
+ * This class is allocated on the stack and performs no allocation.
+ */
+class ClosestRayProxy : public b2RayCastCallback {
+public:
+    /** The hit to write to */
+    RaycastHit* hit;
+    /** The collision categories to consider */
+    uint16 mask;
+    
+    /**
+     * Records the fixture if it matches the mask, clipping the ray.
+     *
+     * @param  fixture  the fixture hit by the ray
+     * @param  point    the point of initial intersection
+     * @param  normal   the normal vector at the point of intersection
+     * @param  fraction the fraction along the ray
+     *
+     * @return -1 to filter, or fraction to clip the ray
+     */
+    float32 ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float32 fraction) override {
+        if ((fixture->GetFilterData().categoryBits & mask) == 0) {
+            return -1;
+        }
+        hit->obstacle = (Obstacle*)fixture->GetBody()->GetUserData();
+        hit->fixture  = fixture;
+        hit->point.set(point.x,point.y);
+        hit->normal.set(normal.x,normal.y);
+        hit->fraction = fraction;
+        return fraction;
+    }
+};
+
+/**
+ * A b2RayCastCallback for all hits of a batched query.
+ *
+ * This class is allocated on the stack and performs no allocation.
+ */
+class AllRayProxy : public b2RayCastCallback {
+public:
+    /** The hits to write to */
+    RaycastHit* hits;
+    /** The maximum number of hits */
+    size_t limit;
+    /** The number of hits so far */
+    size_t count;
+    /** The collision categories to consider */
+    uint16 mask;
+    
+    /**
+     * Records the fixture if it matches the mask, continuing the ray.
+     *
+     * @param  fixture  the fixture hit by the ray
+     * @param  point    the point of initial intersection
+     * @param  normal   the normal vector at the point of intersection
+     * @param  fraction the fraction along the ray
+     *
+     * @return -1 to filter, 0 to terminate, or 1 to continue
+     */
+    float32 ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float32 fraction) override {
+        if ((fixture->GetFilterData().categoryBits & mask) == 0) {
+            return -1;
+        }
+        RaycastHit* hit = hits+count;
+        hit->obstacle = (Obstacle*)fixture->GetBody()->GetUserData();
+        hit->fixture  = fixture;
+        hit->point.set(point.x,point.y);
+        hit->normal.set(normal.x,normal.y);
+        hit->fraction = fraction;
+        count++;
+        return count < limit ? 1 : 0;
+    }
+};
+
+/**
+ * A b2QueryCallback for a batched AABB query.
+ *
+ * This class is allocated on the stack and performs no allocation.
+ */
+class OverlapProxy : public b2QueryCallback {
+public:
+    /** The fixtures to write to */
+    b2Fixture** fixtures;
+    /** The maximum number of fixtures */
+    size_t limit;
+    /** The number of fixtures so far */
+    size_t count;
+    /** The collision categories to consider */
+    uint16 mask;
+    
+    /**
+     * Records the fixture if it matches the mask.
+     *
+     * @param  fixture  the fixture selected
+     *
+     * @return false to terminate the query.
+     */
+    bool ReportFixture(b2Fixture* fixture) override {
+        if ((fixture->GetFilterData().categoryBits & mask) != 0) {
+            fixtures[count++] = fixture;
+        }
+        return count < limit;
+    }
+};
+
 
 #pragma mark -
 #pragma mark Constructors
@@ -162,14 +386,27 @@ public:
  */
 ObstacleWorld::ObstacleWorld() :
 _world(nullptr),
+_sleepsync(true),
+_stepcount(0),
+_syncount(0),
+_awakecount(0),
+_skipcount(0),
+_grain(DEFAULT_WORLD_GRAIN),
 _collide(false),
 _filters(false),
-_destroy(false) {
+_destroy(false),
+_buffered(false),
+_solveevents(false),
+_eventmask(0xFFFF),
+_eventcap(DEFAULT_WORLD_EVENTS),
+_dropped(0),
+_latedropped(0) {
     _lockstep   = false;
     _stepssize  = DEFAULT_WORLD_STEP;
     _itvelocity = DEFAULT_WORLD_VELOC;
     _itposition = DEFAULT_WORLD_POSIT;
     _gravity = Vec2(0,DEFAULT_GRAVITY);
+    _drawscale = Vec2::ONE;
     
     onBeginContact = nullptr;
     onEndContact   = nullptr;
@@ -189,6 +426,15 @@ void ObstacleWorld::dispose() {
         delete _world;
         _world  = nullptr;
     }
+    _collide  = false;
+    _filters  = false;
+    _destroy  = false;
+    _buffered = false;
+    _events.clear();
+    _lateevents.clear();
+    _latedropped = 0;
+    _removed.clear();
+    _retained.clear();
     onBeginContact = nullptr;
     onEndContact   = nullptr;
     beforeSolve    = nullptr;
@@ -196,6 +442,7 @@ void ObstacleWorld::dispose() {
     shouldCollide  = nullptr;
     destroyFixture = nullptr;
     destroyJoint   = nullptr;
+    _pool = nullptr;
 }
 
 /**
@@ -256,8 +503,15 @@ bool ObstacleWorld::init(const Rect& bounds, const Vec2& gravity) {
  */
 void ObstacleWorld::addObstacle(const std::shared_ptr<Obstacle>& obj) {
     CUAssertLog(inBounds(obj.get()), "Obstacle is not in bounds");
+    CUAssertLog(obj->_owner == nullptr, "Obstacle is already in a world");
     _objects.push_back(obj);
     obj->activatePhysics(*_world);
+    obj->_owner = this;
+    if (dynamic_cast<ComplexObstacle*>(obj.get()) != nullptr) {
+        _complex.push_back(obj.get());
+    }
+    // Guarantee at least one synchronization
+    obj->markSync();
 }
 
 /**
@@ -277,6 +531,10 @@ void ObstacleWorld::addObstacle(const std::shared_ptr<Obstacle>& obj) {
 void ObstacleWorld::removeObstacle(Obstacle* obj) {
     for(auto it = _objects.begin(); it != _objects.end(); ++it) {
         if (it->get() == obj) {
+            releaseSync(obj);
+            if (_buffered) {
+                _removed.push_back(*it);
+            }
             obj->deactivatePhysics(*_world);
             _objects.erase(it);
             return;
@@ -298,6 +556,10 @@ void ObstacleWorld::garbageCollect() {
     size_t pos = 0;
     for(size_t ii = 0; ii < _objects.size(); ii++) {
         if (_objects[ii]->isRemoved()) {
+            releaseSync(_objects[ii].get());
+            if (_buffered) {
+                _removed.push_back(_objects[ii]);
+            }
             _objects[ii]->deactivatePhysics(*_world);
             _objects[ii] = nullptr;
         } else {
@@ -321,9 +583,19 @@ void ObstacleWorld::garbageCollect() {
 void ObstacleWorld::clear() {
     for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
         Obstacle* obj = it->get();
+        if (_buffered) {
+            _removed.push_back(*it);
+        }
         obj->deactivatePhysics(*_world);
+        obj->_owner  = nullptr;
+        obj->_linked = nullptr;
+        obj->_syncwait = false;
     }
     _objects.clear();
+    _awake.clear();
+    _complex.clear();
+    _pending.clear();
+    _synclist.clear();
 }
 
 
@@ -356,17 +628,109 @@ void ObstacleWorld::setGravity(const Vec2& gravity) {
  * physics.  The primary method is the step() method in world.  This implementation
  * works for all applications and should not need to be overwritten.
  *
+ * After the step, the world synchronizes its obstacles. Unless sleep sync
+ * is disabled, only awake, dirty, and complex obstacles are synchronized.
+ *
  * @param delta Number of seconds since last animation frame
  */
 void ObstacleWorld::update(float dt) {
+    step(dt);
+    synchronize(dt);
+}
+
+/**
+ * Advances the Box2D world without synchronizing the obstacles.
+ *
+ * This is the first half of {@link update}.  It clears the contact event
+ * buffer and steps the physics engine, but it does not call the update
+ * method of any obstacle, nor does it touch any linked scene graph node.
+ * The world is not ready to be drawn until {@link synchronize} is called.
+ *
+ * This method only touches the state of this world, so it is safe to step
+ * distinct worlds on different threads at the same time.  However, the
+ * collision, filter, and destruction callbacks are invoked on the thread
+ * that calls this method.
+ *
+ * @param dt Number of seconds since last animation frame
+ */
+void ObstacleWorld::step(float dt) {
+    // Events only last a single step, but begin with those between steps
+    _events.swap(_lateevents);
+    _lateevents.clear();
+    _dropped = _latedropped;
+    _latedropped = 0;
+    _retained.swap(_removed);
+    _removed.clear();
+    
     // Turn the physics engine crank.
     _world->Step((_lockstep ? _stepssize : dt),_itvelocity,_itposition);
+    _stepcount++;
+}
+
+/**
+ * Synchronizes the obstacles with the Box2D world.
+ *
+ * This is the second half of {@link update}.  It calls the update method
+ * of every obstacle that needs it and writes the position and angle of
+ * every linked scene graph node.
+ *
+ * @param dt Number of seconds since last animation frame
+ */
+void ObstacleWorld::synchronize(float dt) {
+    _synclist.clear();
+
+    if (!_sleepsync) {
+        for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
+            collectSync(it->get());
+        }
+        _awakecount = _synclist.size();
+    } else {
+        // Scan the bodies (not the obstacles) to avoid touching sleepers
+        for(b2Body* body = _world->GetBodyList(); body; body = body->GetNext()) {
+            if (body->IsAwake() && body->GetType() != b2_staticBody) {
+                Obstacle* obj = (Obstacle*)body->GetUserData();
+                // Components of complex obstacles are not owned by the world
+                if (obj != nullptr && obj->_owner == this) {
+                    collectSync(obj);
+                }
+            }
+        }
+        _awakecount = _synclist.size();
+        
+        // Bodies that fell asleep this step need one last synchronization
+        for(auto it = _awake.begin(); it != _awake.end(); ++it) {
+            collectSync(*it);
+        }
+        _awake.assign(_synclist.begin(),_synclist.begin()+_awakecount);
+        
+        for(auto it = _complex.begin(); it != _complex.end(); ++it) {
+            collectSync(*it);
+        }
+    }
+    
+    // Add anything dirty or moved by hand
+    for(auto it = _pending.begin(); it != _pending.end(); ++it) {
+        (*it)->_syncwait = false;
+        collectSync(*it);
+    }
+    _pending.clear();
     
     // Post process all objects after physics (this updates graphics)
-    for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
-        Obstacle* obj = it->get();
-        obj->update(dt);
+    for(auto it = _synclist.begin(); it != _synclist.end(); ++it) {
+        (*it)->update(dt);
     }
+    
+    // Batch write the linked scene graph nodes
+    for(auto it = _synclist.begin(); it != _synclist.end(); ++it) {
+        Obstacle* obj = *it;
+        if (obj->_linked != nullptr) {
+            obj->_linked->setPosition(obj->getPosition()*_drawscale);
+            obj->_linked->setAngle(obj->getAngle());
+        }
+    }
+    _syncount = _synclist.size();
+    // Computed now, as obstacles may be removed before the next query
+    _skipcount = _objects.size() > _syncount ? _objects.size()-_syncount : 0;
 }
 
 /**
@@ -386,6 +750,426 @@ bool ObstacleWorld::inBounds(Obstacle* obj) {
     return horiz && vert;
 }
 
+
+#pragma mark -
+#pragma mark Synchronization
+
+/**
+ * Adds the obstacle to the synchronization list for this step.
+ *
+ * The obstacle is stamped with the current step, so that it is only
+ * added once, no matter how many reasons it has to be synchronized.
+ *
+ * @param obj   The obstacle to synchronize
+ */
+void ObstacleWorld::collectSync(Obstacle* obj) {
+    if (obj->_syncstep != _stepcount) {
+        obj->_syncstep = _stepcount;
+        _synclist.push_back(obj);
+    }
+}
+
+/**
+ * Removes all references to the given obstacle from the synchronization lists.
+ *
+ * This method must be called before a world releases ownership of an
+ * obstacle, as the synchronization lists only store weak references.
+ *
+ * @param obj   The obstacle to forget
+ */
+void ObstacleWorld::releaseSync(Obstacle* obj) {
+    if (obj->_syncwait) {
+        _pending.erase(std::remove(_pending.begin(), _pending.end(), obj), _pending.end());
+        obj->_syncwait = false;
+    }
+    _awake.erase(std::remove(_awake.begin(), _awake.end(), obj), _awake.end());
+    _complex.erase(std::remove(_complex.begin(), _complex.end(), obj), _complex.end());
+    obj->_owner  = nullptr;
+    obj->_linked = nullptr;
+}
+
+/**
+ * Sets the scale from physics coordinates to linked scene graph nodes.
+ *
+ * The position of a linked node is the position of its obstacle times
+ * this scale.  The default scale is (1,1).  Changing the scale will
+ * immediately reposition all linked nodes.
+ *
+ * @param scale the scale from physics coordinates to linked scene graph nodes.
+ */
+void ObstacleWorld::setDrawScale(const Vec2& scale) {
+    _drawscale = scale;
+    for(auto it = _objects.begin(); it != _objects.end(); ++it) {
+        Obstacle* obj = it->get();
+        if (obj->_linked != nullptr) {
+            obj->_linked->setPosition(obj->getPosition()*_drawscale);
+        }
+    }
+}
+
+/**
+ * Links a scene graph node to the given obstacle.
+ *
+ * A linked node is positioned and rotated by the world whenever the
+ * obstacle is synchronized.  This is done in a single batch after all
+ * obstacles are updated, which is much faster than repositioning nodes
+ * with an obstacle listener.  The node position is the obstacle position
+ * times the draw scale, and so the node should be anchored at its center.
+ *
+ * The obstacle must be in this world.  Each obstacle has at most one
+ * linked node; linking a new node replaces the previous one. Passing
+ * nullptr unlinks the obstacle.
+ *
+ * @param obj   The obstacle to link
+ * @param node  The scene graph node to position
+ */
+void ObstacleWorld::linkSceneNode(Obstacle* obj, const std::shared_ptr<Node>& node) {
+    CUAssertLog(obj->_owner == this, "Obstacle is not in this world");
+    obj->_linked = node;
+    if (node != nullptr) {
+        node->setPosition(obj->getPosition()*_drawscale);
+        node->setAngle(obj->getAngle());
+    }
+}
+
+
+#pragma mark -
+#pragma mark State Snapshots
+
+/**
+ * Rebuilds the body index used by snapshots.
+ *
+ * Bodies are identified by their position in the Box2D body list.
+ */
+void ObstacleWorld::indexBodies() {
+    _snapbodies.clear();
+    _snapindex.clear();
+    Uint32 index = 0;
+    for(b2Body* body = _world->GetBodyList(); body; body = body->GetNext()) {
+        _snapbodies.push_back(body);
+        _snapindex.push_back(std::make_pair(body,index++));
+    }
+    std::sort(_snapindex.begin(), _snapindex.end());
+}
+
+/**
+ * Stores the current simulation state in the given buffer.
+ *
+ * The snapshot is a compact binary record of every body in the world:
+ * its transform, its velocities, and whether it is awake.  It also
+ * records the target of every mouse joint, and the contact impulses
+ * used by Box2D to warm start the solver. The contents of buffer are
+ * replaced, but its capacity is reused, so repeated snapshots into the
+ * same buffer do not allocate.
+ *
+ * A snapshot does not record the bodies themselves.  It can only be
+ * restored to this world (or an identical copy) with the same obstacles,
+ * added in the same order.  The data is in native byte order.
+ *
+ * Box2D does not expose the warm start impulses of joints or the sleep
+ * timers of bodies, so these are not recorded.  A restored simulation
+ * will not be bit-for-bit identical when joints are under load or when
+ * bodies are about to fall asleep.
+ *
+ * @param buffer    The buffer to store the snapshot
+ */
+void ObstacleWorld::snapshot(std::vector<Uint8>& buffer) {
+    snapshot(buffer, std::vector<Uint8>());
+}
+
+/**
+ * Stores the changes to the simulation state since base in the given buffer.
+ *
+ * The base must be a full snapshot of this world (e.g. one created by
+ * {@link snapshot(std::vector<Uint8>&)}).  The delta only stores those
+ * bodies whose state differs from the base, and the contacts that touch
+ * one of those bodies.  Mostly sleeping worlds produce very small deltas.
+ *
+ * To restore a delta snapshot, you must first restore the base (unless
+ * the world is already in that state).  If the base is not compatible
+ * with this world, this method stores a full snapshot instead.
+ *
+ * @param buffer    The buffer to store the snapshot
+ * @param base      The full snapshot to compare against
+ */
+void ObstacleWorld::snapshot(std::vector<Uint8>& buffer, const std::vector<Uint8>& base) {
+    CUAssertLog(_world, "Attempt to snapshot an uninitialized world");
+    CUAssertLog(!_world->IsLocked(), "Attempt to snapshot a world during a step");
+    CUAssertLog(&buffer != &base, "The snapshot buffer cannot be the base");
+    indexBodies();
+    Uint32 bodies = (Uint32)_snapbodies.size();
+    
+    // Check if the base is usable
+    bool delta = false;
+    if (base.size() >= SNAPSHOT_HEADER+bodies*SNAPSHOT_BODY) {
+        size_t pos = 0;
+        Uint32 magic, count, records;
+        Uint16 version, flags;
+        snapshot_get(base, pos, magic);
+        snapshot_get(base, pos, version);
+        snapshot_get(base, pos, flags);
+        snapshot_get(base, pos, count);
+        snapshot_get(base, pos, records);
+        delta = (magic == SNAPSHOT_MAGIC && version == SNAPSHOT_VERSION &&
+                 !(flags & SNAPSHOT_DELTA) && count == bodies && records == bodies);
+    }
+    
+    // Header (counts are patched at the end)
+    buffer.clear();
+    snapshot_put(buffer, (Uint32)SNAPSHOT_MAGIC);
+    snapshot_put(buffer, (Uint16)SNAPSHOT_VERSION);
+    snapshot_put(buffer, (Uint16)(delta ? SNAPSHOT_DELTA : 0));
+    snapshot_put(buffer, bodies);
+    snapshot_put(buffer, (Uint32)0);
+    snapshot_put(buffer, (Uint32)_world->GetJointCount());
+    snapshot_put(buffer, (Uint32)0);
+    
+    // Bodies
+    Uint32 records = 0;
+    _snapchanged.assign(bodies, 1);
+    for(Uint32 ii = 0; ii < bodies; ii++) {
+        size_t pos = buffer.size();
+        if (delta) {
+            snapshot_put(buffer, ii);
+            snapshot_body(buffer, _snapbodies[ii]);
+            const Uint8* prev = base.data()+SNAPSHOT_HEADER+ii*SNAPSHOT_BODY;
+            if (std::memcmp(buffer.data()+pos+sizeof(Uint32), prev, SNAPSHOT_BODY) == 0) {
+                buffer.resize(pos);
+                _snapchanged[ii] = 0;
+                continue;
+            }
+        } else {
+            snapshot_body(buffer, _snapbodies[ii]);
+        }
+        records++;
+    }
+    
+    // Joints
+    for(b2Joint* joint = _world->GetJointList(); joint; joint = joint->GetNext()) {
+        snapshot_put(buffer, (Uint8)joint->GetType());
+        if (joint->GetType() == e_mouseJoint) {
+            const b2Vec2& target = ((b2MouseJoint*)joint)->GetTarget();
+            snapshot_put(buffer, target.x);
+            snapshot_put(buffer, target.y);
+        }
+    }
+    
+    // Contacts (only touching ones have impulses)
+    Uint32 contacts = 0;
+    for(b2Contact* contact = _world->GetContactList(); contact; contact = contact->GetNext()) {
+        const b2Manifold* manifold = contact->GetManifold();
+        if (!contact->IsTouching() || manifold->pointCount == 0) {
+            continue;
+        }
+        b2Fixture* fixA = contact->GetFixtureA();
+        b2Fixture* fixB = contact->GetFixtureB();
+        auto posA = std::lower_bound(_snapindex.begin(), _snapindex.end(),
+                                     std::make_pair(fixA->GetBody(),(Uint32)0));
+        auto posB = std::lower_bound(_snapindex.begin(), _snapindex.end(),
+                                     std::make_pair(fixB->GetBody(),(Uint32)0));
+        if (!_snapchanged[posA->second] && !_snapchanged[posB->second]) {
+            // The solver cannot have touched this contact
+            continue;
+        }
+        snapshot_put(buffer, posA->second);
+        snapshot_put(buffer, snapshot_fixture(fixA));
+        snapshot_put(buffer, (Uint16)contact->GetChildIndexA());
+        snapshot_put(buffer, posB->second);
+        snapshot_put(buffer, snapshot_fixture(fixB));
+        snapshot_put(buffer, (Uint16)contact->GetChildIndexB());
+        snapshot_put(buffer, (Uint8)manifold->pointCount);
+        for(int ii = 0; ii < manifold->pointCount; ii++) {
+            snapshot_put(buffer, manifold->points[ii].id.key);
+            snapshot_put(buffer, manifold->points[ii].normalImpulse);
+            snapshot_put(buffer, manifold->points[ii].tangentImpulse);
+        }
+        contacts++;
+    }
+    
+    snapshot_set(buffer, 12, records);
+    snapshot_set(buffer, 20, contacts);
+}
+
+/**
+ * Restores the simulation state from the given snapshot.
+ *
+ * The snapshot may be either a full or a delta snapshot.  A delta only
+ * restores the bodies that changed, and so the world should be in the
+ * state of the base snapshot beforehand.
+ *
+ * Contact impulses are only restored for contacts that currently exist
+ * in the world.  When restoring a full snapshot, any contact that is not
+ * in the snapshot has its impulses cleared, so that it is treated as a
+ * new contact by the solver.  All restored obstacles are marked for
+ * synchronization at the next update.
+ *
+ * This method returns false (and does nothing) if the snapshot does not
+ * match the bodies and joints in this world, or if any of its records are
+ * truncated or out of range.
+ *
+ * @param buffer    The snapshot to restore
+ *
+ * @return true if the snapshot was restored
+ */
+bool ObstacleWorld::restore(const std::vector<Uint8>& buffer) {
+    CUAssertLog(_world, "Attempt to restore an uninitialized world");
+    CUAssertLog(!_world->IsLocked(), "Attempt to restore a world during a step");
+    size_t pos = 0;
+    Uint32 magic, bodies, records, joints, contacts;
+    Uint16 version, flags;
+    if (!snapshot_get(buffer, pos, magic) || magic != SNAPSHOT_MAGIC ||
+        !snapshot_get(buffer, pos, version) || version != SNAPSHOT_VERSION ||
+        !snapshot_get(buffer, pos, flags) || !snapshot_get(buffer, pos, bodies) ||
+        !snapshot_get(buffer, pos, records) || !snapshot_get(buffer, pos, joints) ||
+        !snapshot_get(buffer, pos, contacts)) {
+        return false;
+    }
+    
+    indexBodies();
+    bool delta = (flags & SNAPSHOT_DELTA);
+    size_t recsize = SNAPSHOT_BODY+(delta ? sizeof(Uint32) : 0);
+    if (bodies != _snapbodies.size() || joints != (Uint32)_world->GetJointCount() ||
+        pos+records*recsize > buffer.size() || (!delta && records != bodies)) {
+        return false;
+    }
+    
+    // Validate all of the records before we modify anything
+    if (delta) {
+        size_t ipos = pos;
+        for(Uint32 ii = 0; ii < records; ii++) {
+            Uint32 index;
+            if (!snapshot_get(buffer, ipos, index) || index >= bodies) {
+                return false;
+            }
+            ipos += SNAPSHOT_BODY;
+        }
+    }
+    size_t jstart = pos+records*recsize;
+    size_t jpos = jstart;
+    for(b2Joint* joint = _world->GetJointList(); joint; joint = joint->GetNext()) {
+        Uint8 type;
+        if (!snapshot_get(buffer, jpos, type) || type != (Uint8)joint->GetType()) {
+            return false;
+        }
+        jpos += (type == e_mouseJoint ? 2*sizeof(float) : 0);
+    }
+    size_t cstart = jpos;
+    for(Uint32 ii = 0; ii < contacts; ii++) {
+        Uint32 bodyA, bodyB;
+        Uint16 fixA, fixB, childA, childB;
+        Uint8 points;
+        if (!snapshot_get(buffer, jpos, bodyA) || !snapshot_get(buffer, jpos, fixA) ||
+            !snapshot_get(buffer, jpos, childA) || !snapshot_get(buffer, jpos, bodyB) ||
+            !snapshot_get(buffer, jpos, fixB) || !snapshot_get(buffer, jpos, childB) ||
+            !snapshot_get(buffer, jpos, points) || bodyA >= bodies || bodyB >= bodies) {
+            return false;
+        }
+        jpos += points*(sizeof(b2ContactID)+2*sizeof(float));
+        if (jpos > buffer.size()) {
+            return false;
+        }
+    }
+    
+    // Bodies
+    for(Uint32 ii = 0; ii < records; ii++) {
+        Uint32 index = ii;
+        float px, py, angle, vx, vy, omega;
+        Uint8 awake;
+        if ((delta && !snapshot_get(buffer, pos, index)) ||
+            !snapshot_get(buffer, pos, px) || !snapshot_get(buffer, pos, py) ||
+            !snapshot_get(buffer, pos, angle) || !snapshot_get(buffer, pos, vx) ||
+            !snapshot_get(buffer, pos, vy) || !snapshot_get(buffer, pos, omega) ||
+            !snapshot_get(buffer, pos, awake)) {
+            // Not possible after validation
+            break;
+        }
+        
+        b2Body* body = _snapbodies[index];
+        body->SetTransform(b2Vec2(px,py), angle);
+        body->SetLinearVelocity(b2Vec2(vx,vy));
+        body->SetAngularVelocity(omega);
+        body->SetAwake(awake != 0);
+        
+        Obstacle* obj = (Obstacle*)body->GetUserData();
+        if (obj != nullptr && obj->_owner == this) {
+            obj->markSync();
+        }
+    }
+    
+    // Joints
+    pos = jstart;
+    for(b2Joint* joint = _world->GetJointList(); joint; joint = joint->GetNext()) {
+        Uint8 type = 0;
+        snapshot_get(buffer, pos, type);
+        if (type == e_mouseJoint) {
+            b2Vec2 target;
+            if (snapshot_get(buffer, pos, target.x) && snapshot_get(buffer, pos, target.y)) {
+                ((b2MouseJoint*)joint)->SetTarget(target);
+            }
+        }
+    }
+    
+    // Contacts
+    if (!delta) {
+        for(b2Contact* contact = _world->GetContactList(); contact; contact = contact->GetNext()) {
+            b2Manifold* manifold = contact->GetManifold();
+            for(int ii = 0; ii < manifold->pointCount; ii++) {
+                manifold->points[ii].normalImpulse  = 0.0f;
+                manifold->points[ii].tangentImpulse = 0.0f;
+            }
+        }
+    }
+    pos = cstart;
+    for(Uint32 ii = 0; ii < contacts; ii++) {
+        Uint32 bodyA = 0, bodyB = 0;
+        Uint16 fixA = 0, fixB = 0, childA = 0, childB = 0;
+        Uint8 points = 0;
+        snapshot_get(buffer, pos, bodyA);
+        snapshot_get(buffer, pos, fixA);
+        snapshot_get(buffer, pos, childA);
+        snapshot_get(buffer, pos, bodyB);
+        snapshot_get(buffer, pos, fixB);
+        snapshot_get(buffer, pos, childB);
+        snapshot_get(buffer, pos, points);
+        size_t next = pos+points*(sizeof(b2ContactID)+2*sizeof(float));
+        
+        b2Fixture* fa = snapshot_fixture(_snapbodies[bodyA], fixA);
+        b2Fixture* fb = snapshot_fixture(_snapbodies[bodyB], fixB);
+        b2Contact* contact = nullptr;
+        if (fa != nullptr && fb != nullptr) {
+            for(b2ContactEdge* edge = _snapbodies[bodyA]->GetContactList(); edge; edge = edge->next) {
+                b2Contact* c = edge->contact;
+                if (c->GetFixtureA() == fa && c->GetFixtureB() == fb &&
+                    c->GetChildIndexA() == childA && c->GetChildIndexB() == childB) {
+                    contact = c;
+                    break;
+                }
+            }
+        }
+        
+        if (contact != nullptr) {
+            b2Manifold* manifold = contact->GetManifold();
+            for(Uint8 jj = 0; jj < points; jj++) {
+                b2ContactID cid;
+                float normal, tangent;
+                if (!snapshot_get(buffer, pos, cid.key) || !snapshot_get(buffer, pos, normal) ||
+                    !snapshot_get(buffer, pos, tangent)) {
+                    break;
+                }
+                for(int kk = 0; kk < manifold->pointCount; kk++) {
+                    if (manifold->points[kk].id.key == cid.key) {
+                        manifold->points[kk].normalImpulse  = normal;
+                        manifold->points[kk].tangentImpulse = tangent;
+                    }
+                }
+            }
+        }
+        pos = next;
+    }
+    return true;
+}
+
+
 #pragma mark -
 #pragma mark Callback Activation
 
@@ -402,8 +1186,8 @@ void ObstacleWorld::activateCollisionCallbacks(bool flag) {
         return;
     }
     
-    _world->SetContactListener(flag ? this : nullptr);
     _collide = flag;
+    resetContactListener();
 }
 
 /**
@@ -442,6 +1226,154 @@ void ObstacleWorld::activateDestructionCallbacks(bool flag) {
 }
 
 
+/**
+ * Resets the Box2D contact listener to agree with the active callbacks.
+ */
+void ObstacleWorld::resetContactListener() {
+    _world->SetContactListener(_collide || _buffered ? this : nullptr);
+}
+
+
+#pragma mark -
+#pragma mark Contact Buffering
+
+/**
+ * Activates the contact event buffer.
+ *
+ * If flag is true, the world records every begin and end contact during
+ * a step into a flat, preallocated buffer of {@link ContactEvent} values.
+ * This buffer is cleared at the start of each call to {@link update}, and
+ * may be read with {@link getContactEvents} once update returns.  Unlike
+ * the collision callbacks, it is safe to modify the world while processing
+ * these events.  Removing an obstacle ends its contacts, but the END events
+ * are not added to the current buffer.  They are reported (with nullptr
+ * fixtures) at the start of the next step.
+ *
+ * Contact buffering is independent of the collision callbacks.  If both
+ * are active, the callbacks are invoked and the events are recorded.
+ *
+ * @param flag  whether to activate the contact event buffer.
+ */
+void ObstacleWorld::activateContactBuffer(bool flag) {
+    if (_buffered == flag) {
+        return;
+    }
+    
+    _buffered = flag;
+    _events.clear();
+    _lateevents.clear();
+    _latedropped = 0;
+    if (flag) {
+        _events.reserve(_eventcap);
+        _lateevents.reserve(_eventcap);
+    } else {
+        _events.shrink_to_fit();
+        _lateevents.shrink_to_fit();
+        _removed.clear();
+        _retained.clear();
+    }
+    resetContactListener();
+}
+
+/**
+ * Sets whether the contact event buffer records solver results.
+ *
+ * If this value is true, the buffer also records a SOLVE event (with the
+ * contact impulses) each time the solver finishes with a touching contact.
+ * As this can happen several times per step for the same contact, this
+ * value is false by default.
+ *
+ * @param flag  whether the contact event buffer records solver results.
+ */
+void ObstacleWorld::setBufferingSolves(bool flag) {
+    _solveevents = flag;
+}
+
+/**
+ * Sets the maximum number of events recorded in a single step.
+ *
+ * The event buffer is preallocated to this size, and never grows during
+ * a step.  Any events past this capacity are dropped.  This method should
+ * not be called during a step.
+ *
+ * @param capacity  the maximum number of events recorded in a single step.
+ */
+void ObstacleWorld::setContactEventCapacity(size_t capacity) {
+    _eventcap = capacity;
+    if (_events.size() > capacity) {
+        _events.resize(capacity);
+    }
+    if (_lateevents.size() > capacity) {
+        _lateevents.resize(capacity);
+    }
+    if (_buffered) {
+        _events.reserve(capacity);
+        _lateevents.reserve(capacity);
+    }
+}
+
+/**
+ * Records a contact in the event buffer.
+ *
+ * The event is ignored if neither fixture matches the event mask. If the
+ * buffer is full, the event is dropped and counted.
+ *
+ * Contacts reported outside of a step (e.g. when a body is destroyed)
+ * are recorded in a separate buffer, which is delivered with the events
+ * of the next step.  This keeps the current events stable while they are
+ * being processed.
+ *
+ * @param type      The event type
+ * @param contact   The Box2D contact
+ * @param impulse   The solver impulse (nullptr unless type is SOLVE)
+ */
+void ObstacleWorld::recordContact(ContactEvent::Type type, b2Contact* contact, const b2ContactImpulse* impulse) {
+    b2Fixture* fixA = contact->GetFixtureA();
+    b2Fixture* fixB = contact->GetFixtureB();
+    uint16 bits = fixA->GetFilterData().categoryBits | fixB->GetFilterData().categoryBits;
+    if ((bits & _eventmask) == 0) {
+        return;
+    }
+    
+    // Box2D only locks the world during a step
+    bool late = !_world->IsLocked();
+    std::vector<ContactEvent>& buffer = late ? _lateevents : _events;
+    if (buffer.size() >= _eventcap) {
+        if (late) {
+            _latedropped++;
+        } else {
+            _dropped++;
+        }
+        return;
+    }
+    
+    buffer.emplace_back();
+    ContactEvent& event = buffer.back();
+    event.type = type;
+    // The fixtures of a late event are about to be destroyed
+    event.fixtureA  = late ? nullptr : fixA;
+    event.fixtureB  = late ? nullptr : fixB;
+    event.obstacleA = (Obstacle*)fixA->GetBody()->GetUserData();
+    event.obstacleB = (Obstacle*)fixB->GetBody()->GetUserData();
+    event.points = contact->GetManifold()->pointCount;
+    if (event.points > 0) {
+        b2WorldManifold manifold;
+        contact->GetWorldManifold(&manifold);
+        event.normal.set(manifold.normal.x,manifold.normal.y);
+        for(int ii = 0; ii < event.points; ii++) {
+            event.point[ii].set(manifold.points[ii].x,manifold.points[ii].y);
+        }
+    } else {
+        event.normal.setZero();
+    }
+    for(int ii = 0; ii < b2_maxManifoldPoints; ii++) {
+        bool valid = impulse != nullptr && ii < impulse->count;
+        event.normalImpulse[ii]  = valid ? impulse->normalImpulses[ii]  : 0.0f;
+        event.tangentImpulse[ii] = valid ? impulse->tangentImpulses[ii] : 0.0f;
+    }
+}
+
+
 #pragma mark -
 #pragma mark Query Functions
 
@@ -478,3 +1410,168 @@ void ObstacleWorld::rayCast(std::function<float(b2Fixture* fixture, const Vec2&
     proxy.onQuery = callback;
     _world->RayCast(&proxy, b2Vec2(point1.x,point1.y), b2Vec2(point2.x,point2.y));
 }
+
+
+#pragma mark -
+#pragma mark Batched Queries
+
+/**
+ * Ray-casts the world for the closest hit along each of the given rays.
+ *
+ * The ray ii starts at origins[ii] and ends at targets[ii].  The closest
+ * hit for that ray is written to hits[ii].  If the ray hits nothing, the
+ * fixture of that hit is nullptr.  Only fixtures whose category bits
+ * intersect the mask are considered.  As with {@link rayCast}, this
+ * ignores shapes that contain the starting point.
+ *
+ * Unlike {@link rayCast}, this method does not allocate or invoke any
+ * closures per query.  If there is a thread pool, the rays are processed
+ * in parallel.
+ *
+ * @param origins   The ray starting points
+ * @param targets   The ray ending points
+ * @param count     The number of rays
+ * @param hits      The buffer to store the hits (must have count elements)
+ * @param mask      The collision categories to consider
+ *
+ * @return the number of rays that hit a fixture
+ */
+size_t ObstacleWorld::rayCastClosest(const Vec2* origins, const Vec2* targets, size_t count,
+                                     RaycastHit* hits, uint16 mask) const {
+    auto batch = [=](size_t begin, size_t end) {
+        ClosestRayProxy proxy;
+        proxy.mask = mask;
+        for(size_t ii = begin; ii < end; ii++) {
+            RaycastHit* hit = hits+ii;
+            hit->obstacle = nullptr;
+            hit->fixture  = nullptr;
+            hit->point  = targets[ii];
+            hit->normal = Vec2::ZERO;
+            hit->fraction = 1.0f;
+            if (origins[ii] != targets[ii]) {
+                proxy.hit = hit;
+                _world->RayCast(&proxy, b2Vec2(origins[ii].x,origins[ii].y),
+                                b2Vec2(targets[ii].x,targets[ii].y));
+            }
+        }
+    };
+    if (_pool != nullptr && count > _grain) {
+        _pool->parallelFor(count, _grain, batch);
+    } else {
+        batch(0,count);
+    }
+    
+    size_t result = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        result += (hits[ii].fixture != nullptr ? 1 : 0);
+    }
+    return result;
+}
+
+/**
+ * Ray-casts the world for all hits along each of the given rays.
+ *
+ * The ray ii starts at origins[ii] and ends at targets[ii].  The hits of
+ * that ray are written to hits[ii*limit], ..., hits[ii*limit+counts[ii]-1]
+ * in no particular order.  Any hits past the limit are ignored.  Only
+ * fixtures whose category bits intersect the mask are considered.  As
+ * with {@link rayCast}, this ignores shapes that contain the starting
+ * point.
+ *
+ * Unlike {@link rayCast}, this method does not allocate or invoke any
+ * closures per query.  If there is a thread pool, the rays are processed
+ * in parallel.
+ *
+ * @param origins   The ray starting points
+ * @param targets   The ray ending points
+ * @param count     The number of rays
+ * @param hits      The buffer to store the hits (must have count*limit elements)
+ * @param limit     The maximum number of hits per ray
+ * @param counts    The buffer to store the hits per ray (must have count elements)
+ * @param mask      The collision categories to consider
+ *
+ * @return the total number of hits
+ */
+size_t ObstacleWorld::rayCastAll(const Vec2* origins, const Vec2* targets, size_t count,
+                                 RaycastHit* hits, size_t limit, size_t* counts,
+                                 uint16 mask) const {
+    auto batch = [=](size_t begin, size_t end) {
+        AllRayProxy proxy;
+        proxy.mask  = mask;
+        proxy.limit = limit;
+        for(size_t ii = begin; ii < end; ii++) {
+            proxy.hits  = hits+ii*limit;
+            proxy.count = 0;
+            if (limit > 0 && origins[ii] != targets[ii]) {
+                _world->RayCast(&proxy, b2Vec2(origins[ii].x,origins[ii].y),
+                                b2Vec2(targets[ii].x,targets[ii].y));
+            }
+            counts[ii] = proxy.count;
+        }
+    };
+    if (_pool != nullptr && count > _grain) {
+        _pool->parallelFor(count, _grain, batch);
+    } else {
+        batch(0,count);
+    }
+    
+    size_t result = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        result += counts[ii];
+    }
+    return result;
+}
+
+/**
+ * Queries the world for the fixtures that potentially overlap each box.
+ *
+ * The fixtures for boxes[ii] are written to fixtures[ii*limit], ...,
+ * fixtures[ii*limit+counts[ii]-1].  Any fixtures past the limit are
+ * ignored.  Only fixtures whose category bits intersect the mask are
+ * considered.  As with {@link queryAABB}, this test is against the
+ * fixture bounding boxes, not the fixture shapes.
+ *
+ * Unlike {@link queryAABB}, this method does not allocate or invoke any
+ * closures per query.  If there is a thread pool, the boxes are processed
+ * in parallel.
+ *
+ * @param boxes     The axis-aligned bounding boxes
+ * @param count     The number of boxes
+ * @param fixtures  The buffer to store the fixtures (must have count*limit elements)
+ * @param limit     The maximum number of fixtures per box
+ * @param counts    The buffer to store the fixtures per box (must have count elements)
+ * @param mask      The collision categories to consider
+ *
+ * @return the total number of fixtures found
+ */
+size_t ObstacleWorld::queryAABBs(const Rect* boxes, size_t count, b2Fixture** fixtures,
+                                 size_t limit, size_t* counts, uint16 mask) const {
+    auto batch = [=](size_t begin, size_t end) {
+        OverlapProxy proxy;
+        proxy.mask  = mask;
+        proxy.limit = limit;
+        b2AABB b2box;
+        for(size_t ii = begin; ii < end; ii++) {
+            const Rect& aabb = boxes[ii];
+            proxy.fixtures = fixtures+ii*limit;
+            proxy.count = 0;
+            if (limit > 0) {
+                b2box.lowerBound.Set(aabb.origin.x, aabb.origin.y);
+                b2box.upperBound.Set(aabb.origin.x+aabb.size.width, aabb.origin.y+aabb.size.height);
+                _world->QueryAABB(&proxy, b2box);
+            }
+            counts[ii] = proxy.count;
+        }
+    };
+    if (_pool != nullptr && count > _grain) {
+        _pool->parallelFor(count, _grain, batch);
+    } else {
+        batch(0,count);
+    }
+    
+    size_t result = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        result += counts[ii];
+    }
+    return result;
+}
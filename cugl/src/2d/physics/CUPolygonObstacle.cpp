@@ -120,7 +120,7 @@ void PolygonObstacle::resize(const Size& size) {
  * This must be called whenever the polygon is resized.
  */
 void PolygonObstacle::resetShapes() {
-    int ntris =  (int)_polygon.getIndices().size() / 3;
+    int ntris =  (int)_polygon.getIndexCount() / 3;
     if (_shapes != nullptr) {
         delete[] _shapes;
     }
@@ -130,7 +130,7 @@ void PolygonObstacle::resetShapes() {
     b2Vec2 triangle[3];
     for(int ii = 0; ii < ntris; ii++) {
         for(int jj = 0; jj < 3; jj++) {
-            unsigned short ind = _polygon.getIndices()[3*ii+jj];
+            Uint32 ind = _polygon.getIndex(3*ii+jj);
             Vec2 temp = _polygon.getVertices()[ind]-pos;
             triangle[jj].x = temp.x;
             triangle[jj].y = temp.y;
@@ -251,9 +251,9 @@ void PolygonObstacle::releaseFixtures() {
             _geoms[ii] = nullptr;
         }
     }
-    if (_geoms != nullptr && _fixCount != (int)_polygon.getIndices().size()/3) {
+    if (_geoms != nullptr && _fixCount != (int)_polygon.getIndexCount()/3) {
         delete[] _geoms;
-        _fixCount = (int)_polygon.getIndices().size()/3;
+        _fixCount = (int)_polygon.getIndexCount()/3;
         _geoms = new b2Fixture*[_fixCount];
     }
 }
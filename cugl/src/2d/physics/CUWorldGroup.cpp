@@ -0,0 +1,239 @@
+//
+//  CUWorldGroup.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for stepping several independent physics
+//  worlds at once.  Distinct Box2D worlds may be stepped in parallel on a
+//  thread pool, as our copy of Box2D keeps its global statistics in thread
+//  local storage and initializes its shared tables exactly once.  The group waits for
+//  every world to finish its step (a barrier) before synchronizing any of the
+//  obstacles.  That way, obstacle updates, scene graph nodes, and buffered
+//  contact events are all processed on the main thread.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#include <cugl/2d/physics/CUWorldGroup.h>
+#include <cugl/2d/physics/CUObstacleWorld.h>
+#include <cugl/util/CUThreadPool.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a new degenerate WorldGroup on the stack.
+ *
+ * The group must be initialized before use.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+WorldGroup::WorldGroup() :
+_pool(nullptr),
+_active(false),
+onStep(nullptr) {
+}
+
+/**
+ * Disposes all of the resources used by this group.
+ *
+ * The worlds are released, but not disposed.  A disposed WorldGroup can
+ * be safely reinitialized.
+ */
+void WorldGroup::dispose() {
+    _worlds.clear();
+    _pool = nullptr;
+    onStep = nullptr;
+    _active = false;
+}
+
+/**
+ * Initializes a group that steps its worlds on the given thread pool.
+ *
+ * If the thread pool is nullptr, the worlds are stepped serially on the
+ * calling thread.  The group does not take ownership of the pool, and
+ * the pool may be shared with other systems (such as the world queries).
+ *
+ * @param pool  The thread pool to step the worlds
+ *
+ * @return true if the group is initialized properly, false otherwise.
+ */
+bool WorldGroup::init(const std::shared_ptr<ThreadPool>& pool) {
+    if (_active) {
+        CUAssertLog(false, "WorldGroup is already initialized");
+        return false;
+    }
+    _pool = pool;
+    _active = true;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Worlds
+/**
+ * Adds a world to this group.
+ *
+ * The world will be stepped on the next call to {@link update}.  Adding
+ * a world that is already in the group has no effect.
+ *
+ * @param world The world to add
+ */
+void WorldGroup::addWorld(const std::shared_ptr<ObstacleWorld>& world) {
+    CUAssertLog(world != nullptr, "Attempt to add a null world");
+    if (std::find(_worlds.begin(), _worlds.end(), world) == _worlds.end()) {
+        _worlds.push_back(world);
+    }
+}
+
+/**
+ * Removes a world from this group.
+ *
+ * The world is released but not disposed.  It is safe to step it on
+ * its own after removal.
+ *
+ * @param world The world to remove
+ */
+void WorldGroup::removeWorld(const std::shared_ptr<ObstacleWorld>& world) {
+    auto it = std::find(_worlds.begin(), _worlds.end(), world);
+    if (it != _worlds.end()) {
+        _worlds.erase(it);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Physics Handling
+/**
+ * Executes a single step of every world in this group.
+ *
+ * The worlds are stepped in parallel.  This method blocks until every
+ * world has finished.  It then visits the worlds on the calling thread,
+ * in order, synchronizing the obstacles and invoking the onStep callback.
+ *
+ * @param dt Number of seconds since last animation frame
+ */
+void WorldGroup::update(float dt) {
+    // Step phase (parallel).  parallelFor is the barrier.
+    if (_pool != nullptr && _worlds.size() > 1) {
+        _pool->parallelFor(_worlds.size(), 1, [&](size_t begin, size_t end) {
+            for(size_t ii = begin; ii < end; ii++) {
+                _worlds[ii]->step(dt);
+            }
+        });
+    } else {
+        for(auto it = _worlds.begin(); it != _worlds.end(); ++it) {
+            (*it)->step(dt);
+        }
+    }
+
+    // Synchronization phase (calling thread)
+    for(auto it = _worlds.begin(); it != _worlds.end(); ++it) {
+        (*it)->synchronize(dt);
+        if (onStep != nullptr) {
+            onStep(it->get());
+        }
+    }
+}
+
+/**
+ * Removes all objects marked for removal in every world.
+ *
+ * This method must be called on the main thread, outside of a call to
+ * {@link update}.
+ */
+void WorldGroup::garbageCollect() {
+    for(auto it = _worlds.begin(); it != _worlds.end(); ++it) {
+        (*it)->garbageCollect();
+    }
+}
+
+
+#pragma mark -
+#pragma mark Debugging
+/**
+ * Returns true if stepping worlds in parallel matches stepping them serially.
+ *
+ * This method builds count pairs of worlds with the factory.  It steps
+ * one world of each pair in a group on the given pool, and the other
+ * world on its own.  After every step, it compares the full snapshots
+ * of each pair.  Any difference means that the worlds share state, and
+ * the method logs the first mismatch and returns false.
+ *
+ * The factory must build the same world (with the same obstacles added
+ * in the same order) each time it is called.
+ *
+ * @param pool      The thread pool to step the worlds
+ * @param factory   The function to build a world
+ * @param count     The number of worlds to step in parallel
+ * @param steps     The number of steps to compare
+ * @param dt        The time of each step in seconds
+ *
+ * @return true if stepping worlds in parallel matches stepping them serially.
+ */
+bool WorldGroup::checkDeterminism(const std::shared_ptr<ThreadPool>& pool,
+                                  const std::function<std::shared_ptr<ObstacleWorld>()>& factory,
+                                  size_t count, Uint32 steps, float dt) {
+    CUAssertLog(factory != nullptr, "The world factory is undefined");
+    std::shared_ptr<WorldGroup> group = WorldGroup::alloc(pool);
+    std::vector<std::shared_ptr<ObstacleWorld>> serial;
+    for(size_t ii = 0; ii < count; ii++) {
+        std::shared_ptr<ObstacleWorld> world = factory();
+        std::shared_ptr<ObstacleWorld> copy  = factory();
+        if (world == nullptr || copy == nullptr || world == copy) {
+            CULogError("The world factory did not build a new world");
+            return false;
+        }
+        group->addWorld(world);
+        serial.push_back(copy);
+    }
+    
+    std::vector<Uint8> expected;
+    std::vector<Uint8> actual;
+    for(Uint32 step = 0; step < steps; step++) {
+        group->update(dt);
+        for(size_t ii = 0; ii < count; ii++) {
+            serial[ii]->update(dt);
+            serial[ii]->snapshot(expected);
+            group->_worlds[ii]->snapshot(actual);
+            if (expected != actual) {
+                CULogError("World %zu diverged from its serial copy at step %u",ii,step);
+                return false;
+            }
+        }
+    }
+    return true;
+}
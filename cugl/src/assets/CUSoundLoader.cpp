@@ -52,6 +52,8 @@ using namespace cugl;
 #define UNKNOWN_SOURCE  "<unknown>"
 /** The default volume (MAX) */
 #define UNKNOWN_VOLUME  1.0f
+/** The default playback priority */
+#define UNKNOWN_PRIORITY  0
 
 #pragma mark -
 #pragma mark Constructor
@@ -83,14 +85,16 @@ _volume(UNKNOWN_VOLUME) {
  * @param key       The key to access the asset after loading
  * @param sound     The sound asset partially loaded
  * @param volume    The volume to set for the sound asset
+ * @param priority  The playback priority for the sound asset
  * @param callback  An optional callback for asynchronous loading
  */
 void SoundLoader::materialize(const std::string& key, const std::shared_ptr<Sound>& sound,
-                              float volume, LoaderCallback callback) {
+                              float volume, int priority, LoaderCallback callback) {
     bool success = false;
     if (sound != nullptr) {
         _assets[key] = sound;
         sound->setVolume(volume);
+        sound->setPriority(priority);
         success = true;
     }
     
@@ -128,12 +132,12 @@ bool SoundLoader::read(const std::string& key, const std::string& source, Loader
     if (_loader == nullptr || !async) {
         std::shared_ptr<Sound> sound = Sound::alloc(source);
         success = (sound != nullptr);
-        materialize(key,sound,UNKNOWN_VOLUME,callback);
+        materialize(key,sound,UNKNOWN_VOLUME,UNKNOWN_PRIORITY,callback);
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<Sound> sound = Sound::alloc(source);
             Application::get()->schedule([=](void){
-                this->materialize(key,sound,this->_volume,callback);
+                this->materialize(key,sound,this->_volume,UNKNOWN_PRIORITY,callback);
                 return false;
             });
         });
@@ -158,6 +162,10 @@ bool SoundLoader::read(const std::string& key, const std::string& source, Loader
  *
  *      "file":         The path to the asset
  *      "volume":       This default sound volume (float)
+ *      "priority":     The sound playback priority (int)
+ *      "stream":       Whether to stream the sound from its file (bool)
+ *      "prebuffer":    The number of frames to decode before streaming (int)
+ *      "compressed":   Whether to keep the sound compressed until played (bool)
  *
  * @param json      The directory entry for the asset
  * @param callback  An optional callback for asynchronous loading
@@ -174,17 +182,23 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
     
     std::string source = json->getString("file",UNKNOWN_SOURCE);
     float volume = json->getFloat("volume",UNKNOWN_VOLUME);
+    int priority = json->getInt("priority",UNKNOWN_PRIORITY);
+    bool stream  = json->getBool("stream",false);
+    Uint32 prebuffer = (Uint32)json->getInt("prebuffer",AUDIO_STREAM_PREBUFFER);
+    bool compressed  = json->getBool("compressed",false);
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<Sound> sound = Sound::alloc(source);
+        std::shared_ptr<Sound> sound = (compressed ? Sound::allocCompressed(source) :
+                                        Sound::alloc(source,stream,prebuffer));
         success = (sound != nullptr);
-        materialize(key,sound,volume,callback);
+        materialize(key,sound,volume,priority,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<Sound> sound = Sound::alloc(source);
+            std::shared_ptr<Sound> sound = (compressed ? Sound::allocCompressed(source) :
+                                            Sound::alloc(source,stream,prebuffer));
 			Application::get()->schedule([=](void) {
-                this->materialize(key,sound,volume,callback);
+                this->materialize(key,sound,volume,priority,callback);
                 return false;
             });
         });
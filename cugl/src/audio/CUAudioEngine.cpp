@@ -40,9 +40,20 @@
 #include "platform/CUAudioEngine-impl.h"
 #include "CUSoundChannel.h"
 #include "CUMusicQueue.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace cugl;
 
+/** The number of voices beyond the channel capacity (for virtual voices) */
+#define AUDIO_VIRTUAL_VOICES    64
+/** The number of milliseconds between checks for finished virtual voices */
+#define AUDIO_VIRTUAL_PERIOD    50
+/** The bits of a handle reserved for the voice index */
+#define AUDIO_HANDLE_MASK       0xffff
+/** The shift of the generation portion of a voice handle */
+#define AUDIO_HANDLE_SHIFT      16
+
 #pragma mark -
 #pragma mark Event Dispatch
 
@@ -59,24 +70,52 @@ AudioEngine* AudioEngine::_gEngine = nullptr;
  * the mixer graph for the sound effect channels.  The provided parameter
  * indicates the number of simultaneously supported sounds.
  *
+ * The block size is the number of audio frames mixed in a single pass of
+ * the audio callback.  Smaller blocks have less latency, but more CPU
+ * overhead.
+ *
  * @param channels  The maximum number of sound effect channels to support
+ * @param blocksize The number of audio frames in a mixer block
  *
  * @return true if the audio engine was successfully initialized.
  */
-bool AudioEngine::init(unsigned int channels) {
+bool AudioEngine::init(unsigned int channels, unsigned int blocksize) {
     CUAssertLog(channels, "The number of channels must be non-zero");
+    CUAssertLog(blocksize, "The block size must be non-zero");
     
-    if (!cugl::impl::AudioStart(AUDIO_FREQUENCY, channels, AUDIO_OUTPUT_CHANNELS)) {
+    if (!cugl::impl::AudioStart(AUDIO_FREQUENCY, channels, AUDIO_OUTPUT_CHANNELS, blocksize)) {
         return false;
     }
+    cugl::impl::AudioSetCacheBudget(AUDIO_CACHE_BUDGET);
     
     _capacity = channels;
+    _blocksize = blocksize;
     for(int ii = 0; ii < _capacity; ii++) {
         std::shared_ptr<SoundChannel> entity = SoundChannel::alloc(ii);
         _channels.push_back(entity);
     }
     _mqueue = MusicQueue::alloc();
     
+    // Channel 0 is at the top of the stack
+    _playing.assign(_capacity,0);
+    _freeChannels.reserve(_capacity);
+    for(int ii = _capacity-1; ii >= 0; ii--) {
+        _freeChannels.push_back(ii);
+    }
+    
+    size_t voices = _capacity+AUDIO_VIRTUAL_VOICES;
+    CUAssertLog(voices <= AUDIO_HANDLE_MASK, "Too many sound effect channels: %d", _capacity);
+    _voices.resize(voices);
+    for(size_t ii = 0; ii < voices; ii++) {
+        Voice* voice = &_voices[ii];
+        voice->handle  = 0;
+        voice->serial  = 0;
+        voice->channel = -1;
+        voice->next = (ii+1 < voices ? (Sint32)(ii+1) : -1);
+    }
+    _freeVoice = 0;
+    _virtuals  = 0;
+    
     // Initialize callbacks here
     return true;
 }
@@ -89,9 +128,20 @@ bool AudioEngine::init(unsigned int channels) {
  */
 void AudioEngine::dispose() {
     if (_capacity) {
+        if (_sweeping && Application::get()) {
+            Application::get()->unschedule(_sweeper);
+        }
+        _sweeping = false;
         _mqueue = nullptr;
         _channels.clear();
+        _effects.clear();
+        _voices.clear();
+        _playing.clear();
+        _freeChannels.clear();
+        _freeVoice = -1;
+        _virtuals  = 0;
         _capacity = 0;
+        _blocksize = 0;
         
         cugl::impl::AudioStop();
     }
@@ -145,36 +195,366 @@ void AudioEngine::gcEffect(int id, bool status) {
         return;
     }
     
-    std::string key = channel->getPrimaryKey();
-    removeKey(key);
+    Uint32 handle = channel->getPrimaryHandle();
     if (channel->attached() == 2) {
         channel->advance();
     } else {
         channel->clear();
     }
-    if (_soundCB) {
-        _soundCB(key,status);
+    
+    // Ignore a stopped sound whose voice has moved on
+    Voice* voice = getVoice(handle);
+    if (voice == nullptr || _playing[id] != handle) {
+        return;
     }
+    
+    std::string key = voice->key;
+    freeChannel(voice);
+    releaseVoice(voice);
+    realizeVirtuals();
+    notifyEffect(handle,key,status);
+}
 
+/**
+ * Returns the active voice for the given handle.
+ *
+ * If the handle is stale (or 0), this method returns nullptr.
+ *
+ * @param handle    The voice handle
+ *
+ * @return the active voice for the given handle.
+ */
+AudioEngine::Voice* AudioEngine::getVoice(Uint32 handle) {
+    Uint32 index = handle & AUDIO_HANDLE_MASK;
+    if (handle == 0 || index >= _voices.size() || _voices[index].handle != handle) {
+        return nullptr;
+    }
+    return &_voices[index];
 }
 
 /**
- * Purges this key from the list of active effects.
+ * Returns the active voice for the given handle.
  *
- * This method is not the same as stopping the channel. A channel may play a
- * little longer after the key is removed.  This is simply a clean-up method.
+ * If the handle is stale (or 0), this method returns nullptr.
  *
- * @remove key  The key to purge from the list of active effects.
+ * @param handle    The voice handle
+ *
+ * @return the active voice for the given handle.
  */
-void AudioEngine::removeKey(std::string key) {
-    _effects.erase(key);
-    for(auto it = _equeue.begin(); it != _equeue.end(); ) {
-        if (*it == key) {
-            it = _equeue.erase(it);
-            break;
-        } else {
-            it++;
+const AudioEngine::Voice* AudioEngine::getVoice(Uint32 handle) const {
+    Uint32 index = handle & AUDIO_HANDLE_MASK;
+    if (handle == 0 || index >= _voices.size() || _voices[index].handle != handle) {
+        return nullptr;
+    }
+    return &_voices[index];
+}
+
+/**
+ * Returns a fresh voice from the free list, or nullptr if there is none.
+ *
+ * The voice has a new handle, but no other attributes are set.
+ *
+ * @return a fresh voice from the free list, or nullptr if there is none.
+ */
+AudioEngine::Voice* AudioEngine::acquireVoice() {
+    if (_freeVoice == -1) {
+        return nullptr;
+    }
+    
+    Sint32 index = _freeVoice;
+    Voice* voice = &_voices[index];
+    _freeVoice = voice->next;
+    
+    // The generation is never 0, so neither is the handle
+    voice->serial = (voice->serial+1) & AUDIO_HANDLE_MASK;
+    if (voice->serial == 0) {
+        voice->serial = 1;
+    }
+    voice->handle = (voice->serial << AUDIO_HANDLE_SHIFT) | (Uint32)index;
+    voice->next = -1;
+    return voice;
+}
+
+/**
+ * Returns the voice to the free list, invalidating its handle.
+ *
+ * The voice must be virtual, so any channel must be released beforehand.
+ * This method does not call the effect listeners.
+ *
+ * @param voice     The voice to release
+ */
+void AudioEngine::releaseVoice(Voice* voice) {
+    CUAssertLog(voice->channel == -1, "Releasing a voice with an active channel");
+    if (!voice->key.empty()) {
+        auto it = _effects.find(voice->key);
+        if (it != _effects.end() && it->second == voice->handle) {
+            _effects.erase(it);
         }
+        voice->key.clear();
+    }
+    
+    _virtuals--;
+    voice->sound  = nullptr;
+    voice->handle = 0;
+    voice->next = _freeVoice;
+    _freeVoice = (Sint32)(voice-_voices.data());
+}
+
+/**
+ * Returns the voice channel to the free stack, making the voice virtual.
+ *
+ * This method does not stop the channel.  It is only bookkeeping.
+ *
+ * @param voice     The voice to update
+ */
+void AudioEngine::freeChannel(Voice* voice) {
+    Sint32 id = voice->channel;
+    _playing[id] = 0;
+    _freeChannels.push_back(id);
+    voice->channel = -1;
+    _virtuals++;
+}
+
+/**
+ * Stops the voice channel, making the voice virtual.
+ *
+ * If the voice has not started yet (because its channel was still fading
+ * out a previous sound) it is removed from the channel.  Otherwise, the
+ * channel is stopped.
+ *
+ * @param voice     The voice to update
+ */
+void AudioEngine::unbindVoice(Voice* voice) {
+    SoundChannel* channel = _channels[voice->channel].get();
+    if (channel->attached() == 2 && channel->getShadowHandle() == voice->handle) {
+        channel->clearShadow();
+    } else if (!channel->isStopped()) {
+        channel->stop();
+    }
+    freeChannel(voice);
+}
+
+/**
+ * Plays the voice on the given channel, starting at the given time.
+ *
+ * If the channel is still fading out a stopped sound, the voice will start
+ * in the next animation frame.
+ *
+ * @param voice     The voice to play
+ * @param id        The channel identifier
+ * @param time      The start position in seconds
+ */
+void AudioEngine::bindVoice(Voice* voice, Sint32 id, float time) {
+    std::shared_ptr<SoundChannel> channel = _channels[id];
+    CUAssertLog(channel->attached() == 0 || channel->isStopped(), "Channel %d is not free", id);
+    _playing[id] = voice->handle;
+    voice->channel = id;
+    
+    channel->attach(voice->handle,voice->sound,voice->volume,voice->loop);
+    channel->setRate(voice->rate);
+    if (time > 0) {
+        channel->setCurrentTime(time);
+    }
+    if (channel->attached() == 1) {
+        channel->play();
+    } else {
+        // Swap in the shadow once the stopped sound has faded
+        Uint32 handle = voice->handle;
+        Application::get()->schedule([=] {
+            if (channel->attached() == 2 && channel->getShadowHandle() == handle) {
+                channel->advance();
+            }
+            return false;
+        });
+    }
+}
+
+/**
+ * Moves the voice to a virtual voice at its current position.
+ *
+ * @param voice     The voice to make virtual
+ */
+void AudioEngine::demoteVoice(Voice* voice) {
+    voice->offset = getVoiceTime(voice);
+    voice->stamp  = SDL_GetTicks();
+    unbindVoice(voice);
+    scheduleSweep();
+}
+
+/**
+ * Attempts to give a virtual voice a channel.
+ *
+ * If there is no free channel, this method will steal the channel of the
+ * least important voice, provided that voice is less important than this
+ * one (or force is true).
+ *
+ * @param voice     The virtual voice
+ * @param force     Whether to steal a channel from a more important voice
+ *
+ * @return true if the voice now has a channel.
+ */
+bool AudioEngine::realizeVoice(Voice* voice, bool force) {
+    if (voice->paused) {
+        return false;
+    }
+    
+    // Finished voices are left for the sweep
+    float time = getVoiceTime(voice);
+    if (!voice->loop && time >= voice->sound->getDuration()) {
+        return false;
+    }
+    
+    if (_freeChannels.empty()) {
+        Voice* victim = findVictim();
+        if (victim == nullptr || !(force || outranks(voice,victim))) {
+            return false;
+        }
+        demoteVoice(victim);
+    }
+    
+    Sint32 id = _freeChannels.back();
+    _freeChannels.pop_back();
+    _virtuals--;
+    bindVoice(voice,id,time);
+    return true;
+}
+
+/**
+ * Assigns the free channels to the most important virtual voices.
+ */
+void AudioEngine::realizeVirtuals() {
+    while (_virtuals && !_freeChannels.empty()) {
+        Voice* best = nullptr;
+        for(auto it = _voices.begin(); it != _voices.end(); ++it) {
+            Voice* voice = &(*it);
+            if (voice->handle && voice->channel == -1 && !voice->paused &&
+                (voice->loop || getVoiceTime(voice) < voice->sound->getDuration()) &&
+                (best == nullptr || outranks(voice,best))) {
+                best = voice;
+            }
+        }
+        if (best == nullptr || !realizeVoice(best,false)) {
+            return;
+        }
+    }
+}
+
+/**
+ * Returns the least important voice with a channel.
+ *
+ * @return the least important voice with a channel.
+ */
+AudioEngine::Voice* AudioEngine::findVictim() {
+    Voice* victim = nullptr;
+    for(auto it = _playing.begin(); it != _playing.end(); ++it) {
+        Voice* voice = getVoice(*it);
+        if (voice != nullptr && (victim == nullptr || outranks(victim,voice))) {
+            victim = voice;
+        }
+    }
+    return victim;
+}
+
+/**
+ * Returns the current position of the voice in seconds.
+ *
+ * @param voice     The voice to query
+ *
+ * @return the current position of the voice in seconds.
+ */
+float AudioEngine::getVoiceTime(const Voice* voice) const {
+    if (voice->channel != -1) {
+        return _channels[voice->channel]->getCurrentTime();
+    }
+    
+    double time = voice->offset;
+    if (!voice->paused) {
+        time += (SDL_GetTicks()-voice->stamp)*voice->rate/1000.0;
+    }
+    double duration = voice->sound->getDuration();
+    if (voice->loop && duration > 0) {
+        time = fmod(time,duration);
+    } else if (time > duration) {
+        time = duration;
+    }
+    return (float)time;
+}
+
+/**
+ * Returns true if voice a is more important than voice b
+ *
+ * A voice is more important if it has higher priority.  For voices of
+ * equal priority, the louder voice is more important.  Paused voices are
+ * considered silent.
+ *
+ * @param a     The first voice
+ * @param b     The second voice
+ *
+ * @return true if voice a is more important than voice b
+ */
+bool AudioEngine::outranks(const Voice* a, const Voice* b) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    float avol = a->paused ? 0.0f : a->volume;
+    float bvol = b->paused ? 0.0f : b->volume;
+    return avol > bvol;
+}
+
+/**
+ * Ends all virtual voices that have played to completion.
+ *
+ * Virtual voices have no channel to report their completion. Hence this
+ * method is called periodically while there are virtual voices.
+ */
+void AudioEngine::sweepVoices() {
+    for(auto it = _voices.begin(); _virtuals && it != _voices.end(); ++it) {
+        Voice* voice = &(*it);
+        if (voice->handle && voice->channel == -1 && !voice->paused && !voice->loop &&
+            getVoiceTime(voice) >= voice->sound->getDuration()) {
+            Uint32 handle = voice->handle;
+            std::string key = voice->key;
+            releaseVoice(voice);
+            notifyEffect(handle,key,true);
+        }
+    }
+}
+
+/**
+ * Schedules {@link sweepVoices} if there are any virtual voices.
+ */
+void AudioEngine::scheduleSweep() {
+    if (_sweeping || !_virtuals || Application::get() == nullptr) {
+        return;
+    }
+    _sweeping = true;
+    _sweeper = Application::get()->schedule([] {
+        AudioEngine* engine = AudioEngine::get();
+        if (engine == nullptr) {
+            return false;
+        }
+        engine->sweepVoices();
+        if (engine->_virtuals == 0) {
+            engine->_sweeping = false;
+            return false;
+        }
+        return true;
+    }, AUDIO_VIRTUAL_PERIOD);
+}
+
+/**
+ * Calls the effect listeners for a completed voice.
+ *
+ * @param handle    The handle of the completed voice
+ * @param key       The key of the completed voice (may be empty)
+ * @param status    True if the voice terminated normally, false otherwise.
+ */
+void AudioEngine::notifyEffect(Uint32 handle, const std::string& key, bool status) {
+    if (_handleCB) {
+        _handleCB(handle,status);
+    }
+    if (_soundCB && !key.empty()) {
+        _soundCB(key,status);
     }
 }
 
@@ -192,16 +572,19 @@ void AudioEngine::removeKey(std::string key) {
  * They depend on this engine for asset management.
  *
  * The provided parameter indicates the number of simultaneously supported
- * sounds.
+ * sounds.  The block size is the number of audio frames mixed in a single
+ * pass of the audio callback.  Smaller blocks have less latency, but more
+ * CPU overhead.
  *
  * @param channels  The maximum number of sound effect channels to support
+ * @param blocksize The number of audio frames in a mixer block
  */
-void AudioEngine::start(unsigned int channels) {
+void AudioEngine::start(unsigned int channels, unsigned int blocksize) {
     if (_gEngine != nullptr) {
         return;
     }
     _gEngine = new AudioEngine();
-    if (!_gEngine->init(channels)) {
+    if (!_gEngine->init(channels,blocksize)) {
         delete _gEngine;
         _gEngine = nullptr;
         CUAssertLog(false,"Sound engine failed to initialize");
@@ -226,6 +609,35 @@ void AudioEngine::stop() {
     _gEngine = nullptr;
 }
 
+/**
+ * Returns true if the number of audio frames in a mixer block was changed.
+ *
+ * Smaller blocks have less latency, but more CPU overhead.  Changing the
+ * block size reopens the audio device.  Sound effects keep playing across
+ * the change, but the music is stopped (and the music queue cleared).
+ * The diagnostic counters are reset by a successful change.
+ *
+ * Not all platforms support this method.  If the block size cannot be
+ * changed, the old block size is kept and this method returns false.
+ *
+ * @param blocksize The number of audio frames in a mixer block
+ *
+ * @return true if the number of audio frames in a mixer block was changed.
+ */
+bool AudioEngine::setBlockSize(unsigned int blocksize) {
+    if (blocksize == _blocksize) {
+        return true;
+    } else if (blocksize == 0) {
+        return false;
+    }
+    stopMusic();
+    if (!cugl::impl::AudioSetBlockSize(blocksize)) {
+        return false;
+    }
+    _blocksize = blocksize;
+    return true;
+}
+
 
 #pragma mark -
 #pragma mark Music Management
@@ -612,17 +1024,19 @@ void AudioEngine::advanceMusicQueue(unsigned int steps) {
  * is the responsibility of the application layer to manage key usage.
  *
  * There are a limited number of channels available for sound effects.  If
- * you go over the number available, the sound will not play unless force
- * is true. In that case, it will grab the channel from the longest playing
- * sound effect.
+ * you go over the number available, the sound will steal the channel of
+ * the least important sound effect, provided that sound is less important
+ * than this one (or force is true). Otherwise, the sound will start as a
+ * virtual voice, and will be heard once a channel is available.  The sound
+ * only fails to play if there are no more voices.
  *
  * @param  key      The reference key for the sound effect
  * @param  sound    The sound effect to play
  * @param  loop     Whether to loop the sound effect continuously
  * @param  volume   The sound effect (< 0 to use asset default volume)
- * @param  force    Whether to force another sound to stop.
+ * @param  force    Whether to force another sound to lose its channel.
  *
- * @return true if there was an available channel for the sound
+ * @return true if there was an available voice for the sound
  */
 bool AudioEngine::playEffect(const std::string& key, const std::shared_ptr<Sound>& sound,
                              bool loop, float volume, bool force) {
@@ -635,48 +1049,13 @@ bool AudioEngine::playEffect(const std::string& key, const std::shared_ptr<Sound
         }
     }
     
-    bool shadow = false;
-    int audioID = -1;
-    for(auto it = _channels.begin(); audioID == -1 && it != _channels.end(); ++it) {
-        if (!(*it)->attached()) {
-            audioID = (*it)->getId();
-        }
-    }
-    
-    // Search for those queued for deletion if necessary
-    for(auto it = _channels.begin(); audioID == -1 && it != _channels.end(); ++it) {
-        if ((*it)->isStopped() && (*it)->attached() == 1) {
-            audioID = (*it)->getId();
-            shadow = true;
-        }
-    }
-    
-    if (audioID == -1) {
-        if (force) {
-            std::string altkey = _equeue.front();
-            audioID = _effects[altkey];
-            stopEffect(altkey);
-        } else {
-            // Fail if nothing available
-            CULogError("No available sound channels");
-            return false;
-        }
+    Uint32 handle = playEffect(sound,loop,volume,force);
+    if (handle == 0) {
+        return false;
     }
     
-    float vol = (volume >= 0 ? volume : sound->getVolume());
-    if (shadow) {
-        std::shared_ptr<SoundChannel> thechannel = _channels[audioID];
-        thechannel->attach(key,sound,vol,loop);
-        Application::get()->schedule([=] {
-            thechannel->advance();
-            return false;
-        });
-    } else {
-        _channels[audioID]->attach(key,sound,vol,loop);
-        _channels[audioID]->play();
-    }
-    _effects.emplace(key,audioID);
-    _equeue.push_back(key);
+    getVoice(handle)->key = key;
+    _effects.emplace(key,handle);
     return true;
 }
 
@@ -690,11 +1069,7 @@ bool AudioEngine::playEffect(const std::string& key, const std::shared_ptr<Sound
  * @return the current state of the sound effect for the given key.
  */
 AudioEngine::State AudioEngine::getEffectState(const std::string& key) const {
-    if (_effects.find(key) == _effects.end()) {
-        return State::INACTIVE;
-    }
-    int id = _effects.at(key);
-    return _channels.at(id)->isPaused() ? State::PAUSED : State::PLAYING;
+    return getEffectState(getEffectHandle(key));
 }
 
 /**
@@ -709,9 +1084,7 @@ AudioEngine::State AudioEngine::getEffectState(const std::string& key) const {
 bool AudioEngine::isEffectLoop(const std::string& key) const {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-
-    int id = _effects.at(key);
-    return _channels.at(id)->getLoop();
+    return isEffectLoop(_effects.at(key));
 }
 
 /**
@@ -725,14 +1098,7 @@ bool AudioEngine::isEffectLoop(const std::string& key) const {
  * @return the sound asset attached to the given key.
  */
 const Sound* AudioEngine::currentEffect(const std::string& key) const {
-    if (_effects.find(key) == _effects.end()) {
-        return nullptr;
-    }
-    SoundChannel* channel = _channels.at(_effects.at(key)).get();
-    if (channel->getShadow()) {
-        return channel->getShadow().get();
-    }
-    return channel->getPrimary().get();
+    return currentEffect(getEffectHandle(key));
 }
 
 /**
@@ -746,9 +1112,7 @@ const Sound* AudioEngine::currentEffect(const std::string& key) const {
 void AudioEngine::setEffectLoop(const std::string& key, bool loop) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-
-    int id = _effects.at(key);
-    _channels[id]->setLoop(loop);
+    setEffectLoop(_effects.at(key),loop);
 }
 
 /**
@@ -763,9 +1127,7 @@ void AudioEngine::setEffectLoop(const std::string& key, bool loop) {
 float AudioEngine::getEffectVolume(const std::string& key) const {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-
-    int id = _effects.at(key);
-    return _channels.at(id)->getVolume();
+    return getEffectVolume(_effects.at(key));
 }
 
 /**
@@ -779,9 +1141,40 @@ float AudioEngine::getEffectVolume(const std::string& key) const {
 void AudioEngine::setEffectVolume(const std::string& key, float volume) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
+    setEffectVolume(_effects.at(key),volume);
+}
 
-    int id = _effects.at(key);
-    _channels[id]->setVolume(volume);
+/**
+ * Returns the current playback rate of the sound effect.
+ *
+ * If the key does not correspond to a channel, this method raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ *
+ * @return the current playback rate of the sound effect
+ */
+float AudioEngine::getEffectRate(const std::string& key) const {
+    CUAssertLog(_effects.find(key) != _effects.end(),
+                "There is no active sound with key '%s'",key.c_str());
+    return getEffectRate(_effects.at(key));
+}
+
+/**
+ * Sets the current playback rate of the sound effect.
+ *
+ * A rate of 1 plays the sound at its natural speed and pitch.  A rate of 2
+ * plays it twice as fast (an octave higher), while a rate of 0.5 plays it
+ * at half speed (an octave lower).  The rate must be in the range [1/8, 8].
+ *
+ * If the key does not correspond to a channel, this method raises an error.
+ *
+ * @param  key      the reference key for the sound effect
+ * @param  rate     the current playback rate of the sound effect
+ */
+void AudioEngine::setEffectRate(const std::string& key, float rate) {
+    CUAssertLog(_effects.find(key) != _effects.end(),
+                "There is no active sound with key '%s'",key.c_str());
+    setEffectRate(_effects.at(key),rate);
 }
 
 /**
@@ -799,9 +1192,7 @@ void AudioEngine::setEffectVolume(const std::string& key, float volume) {
 float AudioEngine::getEffectDuration(const std::string& key) const {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    return _channels.at(id)->getDuration();
+    return getEffectDuration(_effects.at(key));
 }
 
 /**
@@ -821,9 +1212,7 @@ float AudioEngine::getEffectDuration(const std::string& key) const {
 float AudioEngine::getEffectElapsed(const std::string& key) const {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-
-    int id = _effects.at(key);
-    return _channels.at(id)->getCurrentTime();
+    return getEffectElapsed(_effects.at(key));
 }
 
 /**
@@ -843,10 +1232,7 @@ float AudioEngine::getEffectElapsed(const std::string& key) const {
 float AudioEngine::getEffectRemaining(const std::string& key) const {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    float duration = _channels.at(id)->getDuration();
-    return duration - _channels.at(id)->getCurrentTime();
+    return getEffectRemaining(_effects.at(key));
 }
 
 /**
@@ -865,9 +1251,7 @@ float AudioEngine::getEffectRemaining(const std::string& key) const {
 void AudioEngine::setEffectElapsed(const std::string& key, float time) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    _channels.at(id)->setCurrentTime(time);
+    setEffectElapsed(_effects.at(key),time);
 }
 
 /**
@@ -886,10 +1270,7 @@ void AudioEngine::setEffectElapsed(const std::string& key, float time) {
 void AudioEngine::setEffectRemaining(const std::string& key, float time) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    float duration = _channels.at(id)->getDuration();
-    _channels.at(id)->setCurrentTime(duration-time);
+    setEffectRemaining(_effects.at(key),time);
 }
 
 /**
@@ -904,10 +1285,7 @@ void AudioEngine::setEffectRemaining(const std::string& key, float time) {
 void AudioEngine::stopEffect(const std::string& key) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    _channels.at(id)->stop();
-    removeKey(key);
+    stopEffect(_effects.at(key));
 }
 
 /**
@@ -920,10 +1298,7 @@ void AudioEngine::stopEffect(const std::string& key) {
 void AudioEngine::pauseEffect(const std::string& key) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    CUAssertLog(!_channels.at(id)->isPaused(), "The sound for that effect is already paused");
-    _channels.at(id)->pause();
+    pauseEffect(_effects.at(key));
 }
 
 /**
@@ -936,10 +1311,7 @@ void AudioEngine::pauseEffect(const std::string& key) {
 void AudioEngine::resumeEffect(std::string key) {
     CUAssertLog(_effects.find(key) != _effects.end(),
                 "There is no active sound with key '%s'",key.c_str());
-    
-    int id = _effects.at(key);
-    CUAssertLog(_channels.at(id)->isPaused(), "The sound for that effect is not paused");
-    _channels.at(id)->resume();
+    resumeEffect(_effects.at(key));
 }
 
 /**
@@ -948,13 +1320,22 @@ void AudioEngine::resumeEffect(std::string key) {
  * You will need to add the effects again if you wish to replay them.
  */
 void AudioEngine::stopAllEffects() {
-    for(auto it = _channels.begin(); it != _channels.end(); ++it) {
-        if (!(*it)->isStopped()) {
-            (*it)->stop();
+    std::vector<std::pair<Uint32,std::string>> stopped;
+    for(auto it = _voices.begin(); it != _voices.end(); ++it) {
+        Voice* voice = &(*it);
+        if (voice->handle) {
+            if (voice->channel != -1) {
+                unbindVoice(voice);
+            }
+            stopped.push_back(std::make_pair(voice->handle,voice->key));
+            releaseVoice(voice);
         }
     }
-    _effects.clear();
-    _equeue.clear();
+    
+    // Notify once the engine is in a consistent state
+    for(auto it = stopped.begin(); it != stopped.end(); ++it) {
+        notifyEffect(it->first,it->second,false);
+    }
 }
 
 /**
@@ -963,9 +1344,9 @@ void AudioEngine::stopAllEffects() {
  * Sound effects already paused will remain paused.
  */
 void AudioEngine::pauseAllEffects() {
-    for(auto it = _channels.begin(); it != _channels.end(); ++it) {
-        if (!(*it)->isStopped() && !(*it)->isPaused()) {
-            (*it)->pause();
+    for(auto it = _voices.begin(); it != _voices.end(); ++it) {
+        if (it->handle && !it->paused) {
+            pauseEffect(it->handle);
         }
     }
 }
@@ -974,11 +1355,557 @@ void AudioEngine::pauseAllEffects() {
  * Resumes all paused sound effects.
  */
 void AudioEngine::resumeAllEffects() {
-    for(auto it = _channels.begin(); it != _channels.end(); ++it) {
-        if ((*it)->isPaused()) {
-            (*it)->resume();
+    for(auto it = _voices.begin(); it != _voices.end(); ++it) {
+        if (it->handle && it->paused) {
+            resumeEffect(it->handle);
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Sound Effect Handles
+/**
+ * Plays the given sound effect, returning a handle for the sound instance.
+ *
+ * This method is the same as the keyed version of playEffect, except that
+ * the sound is identified by the returned handle instead.  Handles are
+ * much cheaper than keys, and are preferred for rapid-fire sound effects.
+ *
+ * There are a limited number of channels available for sound effects.  If
+ * you go over the number available, the sound will steal the channel of
+ * the least important sound effect, provided that sound is less important
+ * than this one (or force is true). Otherwise, the sound will start as a
+ * virtual voice, and will be heard once a channel is available.  The sound
+ * only fails to play if there are no more voices.
+ *
+ * @param  sound    The sound effect to play
+ * @param  loop     Whether to loop the sound effect continuously
+ * @param  volume   The sound effect (< 0 to use asset default volume)
+ * @param  force    Whether to force another sound to lose its channel.
+ *
+ * @return the handle for the sound effect (0 if it failed to play)
+ */
+Uint32 AudioEngine::playEffect(const std::shared_ptr<Sound>& sound, bool loop,
+                               float volume, bool force) {
+    Voice* voice = acquireVoice();
+    if (voice == nullptr && force) {
+        // Evict the least important virtual voice
+        Voice* victim = nullptr;
+        for(auto it = _voices.begin(); it != _voices.end(); ++it) {
+            if (it->handle && it->channel == -1 && (victim == nullptr || outranks(victim,&(*it)))) {
+                victim = &(*it);
+            }
         }
+        if (victim != nullptr) {
+            stopEffect(victim->handle);
+            voice = acquireVoice();
+        }
+    }
+    if (voice == nullptr) {
+        CULogError("No available sound voices");
+        return 0;
+    }
+    
+    voice->sound  = sound;
+    voice->priority = sound->getPriority();
+    voice->volume = (volume >= 0 ? volume : sound->getVolume());
+    voice->rate   = 1.0f;
+    voice->loop   = loop;
+    voice->paused = false;
+    voice->offset = 0;
+    voice->stamp  = SDL_GetTicks();
+    voice->channel = -1;
+    
+    // Start as virtual and try to get a channel
+    _virtuals++;
+    if (!realizeVoice(voice,force)) {
+        scheduleSweep();
+    }
+    return voice->handle;
+}
+
+/**
+ * Returns the current state of the sound effect for the given handle.
+ *
+ * If there is no sound effect for the given handle, it returns
+ * State::INACTIVE.  Virtual sound effects are PLAYING (or PAUSED).
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the current state of the sound effect for the given handle.
+ */
+AudioEngine::State AudioEngine::getEffectState(Uint32 handle) const {
+    const Voice* voice = getVoice(handle);
+    if (voice == nullptr) {
+        return State::INACTIVE;
+    }
+    return voice->paused ? State::PAUSED : State::PLAYING;
+}
+
+/**
+ * Returns true if the sound effect is in a continuous loop.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return true if the sound effect is in a continuous loop.
+ */
+bool AudioEngine::isEffectLoop(Uint32 handle) const {
+    const Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    return voice->loop;
+}
+
+/**
+ * Sets whether the sound effect is in a continuous loop.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  loop     whether the sound effect is in a continuous loop
+ */
+void AudioEngine::setEffectLoop(Uint32 handle, bool loop) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    if (voice->channel != -1) {
+        _channels[voice->channel]->setLoop(loop);
+    } else {
+        // Rebase so the position does not jump
+        voice->offset = getVoiceTime(voice);
+        voice->stamp  = SDL_GetTicks();
+    }
+    voice->loop = loop;
+}
+
+/**
+ * Returns the current volume of the sound effect.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the current volume of the sound effect
+ */
+float AudioEngine::getEffectVolume(Uint32 handle) const {
+    const Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    return voice->volume;
+}
+
+/**
+ * Sets the current volume of the sound effect.
+ *
+ * Raising the volume of a virtual sound effect may allow it to steal a
+ * channel from a less important sound.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  volume   the current volume of the sound effect
+ */
+void AudioEngine::setEffectVolume(Uint32 handle, float volume) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    CUAssertLog(volume >=0 && volume <= 1, "The volume %.3f is out of range",volume);
+    float previous = voice->volume;
+    voice->volume = volume;
+    if (voice->channel != -1) {
+        _channels[voice->channel]->setVolume(volume);
+    } else if (volume > previous) {
+        realizeVoice(voice,false);
+    }
+}
+
+/**
+ * Returns the current playback rate of the sound effect.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the current playback rate of the sound effect
+ */
+float AudioEngine::getEffectRate(Uint32 handle) const {
+    const Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    return voice->rate;
+}
+
+/**
+ * Sets the current playback rate of the sound effect.
+ *
+ * A rate of 1 plays the sound at its natural speed and pitch.  A rate of 2
+ * plays it twice as fast (an octave higher), while a rate of 0.5 plays it
+ * at half speed (an octave lower).  The rate must be in the range [1/8, 8].
+ * Rates are ignored by the AVFoundation engine.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  rate     the current playback rate of the sound effect
+ */
+void AudioEngine::setEffectRate(Uint32 handle, float rate) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    CUAssertLog(rate >= 0.125f && rate <= 8.0f, "The rate %.3f is out of range",rate);
+    if (voice->channel != -1) {
+        _channels[voice->channel]->setRate(rate);
+    } else {
+        // Rebase so the position does not jump
+        voice->offset = getVoiceTime(voice);
+        voice->stamp  = SDL_GetTicks();
+    }
+    voice->rate = rate;
+}
+
+/**
+ * Returns the duration of the sound effect, in seconds.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the duration of the sound effect, in seconds.
+ */
+float AudioEngine::getEffectDuration(Uint32 handle) const {
+    const Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    return (float)voice->sound->getDuration();
+}
+
+/**
+ * Returns the elapsed time of the sound effect, in seconds
+ *
+ * The elapsed time is the current position of the sound from the beginning.
+ * It does not include any time spent on a continuous loop.  The position
+ * of a virtual sound effect is only accurate to the animation frame.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ *
+ * @return the elapsed time of the sound effect, in seconds
+ */
+float AudioEngine::getEffectElapsed(Uint32 handle) const {
+    const Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    return getVoiceTime(voice);
+}
+
+/**
+ * Sets the elapsed time of the sound effect, in seconds
+ *
+ * The elapsed time is the current position of the sound from the beginning.
+ * It does not include any time spent on a continuous loop.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ * @param  time     the new position of the sound effect
+ */
+void AudioEngine::setEffectElapsed(Uint32 handle, float time) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    if (voice->channel != -1) {
+        _channels[voice->channel]->setCurrentTime(time);
+    } else {
+        voice->offset = time;
+        voice->stamp  = SDL_GetTicks();
+    }
+}
+
+/**
+ * Stops the sound effect for the given handle, removing it.
+ *
+ * If the handle is not active, this method raises an error.  Once the
+ * sound is stopped, the handle is no longer valid.
+ *
+ * @param  handle   the handle for the sound effect
+ */
+void AudioEngine::stopEffect(Uint32 handle) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    
+    std::string key = voice->key;
+    bool physical = voice->channel != -1;
+    if (physical) {
+        unbindVoice(voice);
+    }
+    releaseVoice(voice);
+    if (physical) {
+        realizeVirtuals();
     }
+    notifyEffect(handle,key,false);
+}
+
+/**
+ * Pauses the sound effect for the given handle.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ */
+void AudioEngine::pauseEffect(Uint32 handle) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    CUAssertLog(!voice->paused, "The sound for that effect is already paused");
+    if (voice->channel != -1) {
+        SoundChannel* channel = _channels[voice->channel].get();
+        if (channel->attached() == 2) {
+            // Not started yet, so there is nothing to pause
+            demoteVoice(voice);
+            voice->paused = true;
+            realizeVirtuals();
+            return;
+        }
+        channel->pause();
+    } else {
+        voice->offset = getVoiceTime(voice);
+    }
+    voice->paused = true;
+}
+
+/**
+ * Resumes the sound effect for the given handle.
+ *
+ * If the handle is not active, this method raises an error.
+ *
+ * @param  handle   the handle for the sound effect
+ */
+void AudioEngine::resumeEffect(Uint32 handle) {
+    Voice* voice = getVoice(handle);
+    CUAssertLog(voice != nullptr, "There is no active sound with handle %u",handle);
+    CUAssertLog(voice->paused, "The sound for that effect is not paused");
+    voice->paused = false;
+    if (voice->channel != -1) {
+        _channels[voice->channel]->resume();
+    } else {
+        voice->stamp = SDL_GetTicks();
+        if (!realizeVoice(voice,false)) {
+            scheduleSweep();
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Sound Cache
+/**
+ * Returns the byte budget for decoded compressed sounds.
+ *
+ * A compressed sound (see {@link Sound#allocCompressed}) keeps its encoded
+ * file in memory, and is only decoded when it is played.  The decoded
+ * audio is kept in a cache until it exceeds this budget.  At that point
+ * the least recently played sounds are evicted.  Sounds that are currently
+ * playing are never evicted, so the cache may temporarily exceed its
+ * budget.
+ *
+ * @return the byte budget for decoded compressed sounds.
+ */
+size_t AudioEngine::getCacheBudget() const {
+    return cugl::impl::AudioGetCacheBudget();
+}
+
+/**
+ * Sets the byte budget for decoded compressed sounds.
+ *
+ * A compressed sound (see {@link Sound#allocCompressed}) keeps its encoded
+ * file in memory, and is only decoded when it is played.  The decoded
+ * audio is kept in a cache until it exceeds this budget.  At that point
+ * the least recently played sounds are evicted.  Sounds that are currently
+ * playing are never evicted, so the cache may temporarily exceed its
+ * budget.
+ *
+ * @param bytes The byte budget for decoded compressed sounds.
+ */
+void AudioEngine::setCacheBudget(size_t bytes) {
+    cugl::impl::AudioSetCacheBudget(bytes);
+}
+
+/**
+ * Returns the number of bytes of decoded compressed sounds.
+ *
+ * This is the memory currently used by the cache.  It does not include
+ * the encoded data of the compressed sounds.
+ *
+ * @return the number of bytes of decoded compressed sounds.
+ */
+size_t AudioEngine::getCacheResident() const {
+    return cugl::impl::AudioGetCacheResident();
+}
+
+/**
+ * Returns the number of plays that found their compressed sound decoded.
+ *
+ * @return the number of plays that found their compressed sound decoded.
+ */
+Uint64 AudioEngine::getCacheHits() const {
+    return cugl::impl::AudioGetCacheHits();
+}
+
+/**
+ * Returns the number of plays that had to decode their compressed sound.
+ *
+ * @return the number of plays that had to decode their compressed sound.
+ */
+Uint64 AudioEngine::getCacheMisses() const {
+    return cugl::impl::AudioGetCacheMisses();
+}
+
+
+#pragma mark -
+#pragma mark Diagnostics
+/**
+ * Returns the number of blocks mixed since the diagnostics were reset.
+ *
+ * Each block is one pass of the audio callback.  On platforms that do
+ * their own mixing, this value is always 0.
+ *
+ * @return the number of blocks mixed since the diagnostics were reset.
+ */
+Uint64 AudioEngine::getMixedBlocks() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.blocks;
+}
+
+/**
+ * Returns the number of underruns since the diagnostics were reset.
+ *
+ * An underrun is a block that took longer to mix than it takes to play.
+ * Each underrun is likely heard as a dropout.
+ *
+ * @return the number of underruns since the diagnostics were reset.
+ */
+Uint64 AudioEngine::getUnderruns() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.underruns;
+}
+
+/**
+ * Returns the number of sound effects currently assigned a channel.
+ *
+ * This does not include virtual sound effects, which are not mixed.
+ *
+ * @return the number of sound effects currently assigned a channel.
+ */
+unsigned int AudioEngine::getActiveVoices() const {
+    return (unsigned int)std::count_if(_playing.begin(), _playing.end(),
+                                       [](Uint32 handle) { return handle != 0; });
+}
+
+/**
+ * Returns the fastest time to mix a block in milliseconds.
+ *
+ * @return the fastest time to mix a block in milliseconds.
+ */
+double AudioEngine::getMixTimeMin() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.minimum/1000.0;
+}
+
+/**
+ * Returns the average time to mix a block in milliseconds.
+ *
+ * @return the average time to mix a block in milliseconds.
+ */
+double AudioEngine::getMixTimeAverage() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.blocks ? timings.total/(1000.0*timings.blocks) : 0;
+}
+
+/**
+ * Returns the slowest time to mix a block in milliseconds.
+ *
+ * @return the slowest time to mix a block in milliseconds.
+ */
+double AudioEngine::getMixTimeMax() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.maximum/1000.0;
+}
+
+/**
+ * Returns the given percentile of the time to mix a block in milliseconds.
+ *
+ * The percentile is a value in [0,100], so 50 is the median.  The mix
+ * times are kept in a logarithmic histogram, so the result is only
+ * accurate to within a fifth of its value.
+ *
+ * @param percent   The percentile to compute
+ *
+ * @return the given percentile of the time to mix a block in milliseconds.
+ */
+double AudioEngine::getMixTimePercentile(float percent) const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    Uint64 total = 0;
+    for(int ii = 0; ii < AUDIO_TIMING_BINS; ii++) {
+        total += timings.histogram[ii];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    
+    // Report the upper edge of the bin, clamped to the observed range
+    percent = std::min(std::max(percent,0.0f),100.0f);
+    Uint64 rank = (Uint64)std::ceil(percent*total/100.0);
+    Uint64 seen = 0;
+    int bin = 0;
+    for(; bin < AUDIO_TIMING_BINS-1; bin++) {
+        seen += timings.histogram[bin];
+        if (seen >= rank && seen > 0) {
+            break;
+        }
+    }
+    double micros = std::exp2((double)(bin+1)/AUDIO_TIMING_STEPS)-1;
+    micros = std::min(std::max(micros,timings.minimum),timings.maximum);
+    return micros/1000.0;
+}
+
+/**
+ * Returns the fraction of the available time spent mixing.
+ *
+ * This is the time to mix a block divided by the time to play it,
+ * smoothed over recent blocks.  A value approaching 1 means that the
+ * mixer is about to underrun.
+ *
+ * @return the fraction of the available time spent mixing.
+ */
+double AudioEngine::getMixLoad() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.load;
+}
+
+/**
+ * Returns the estimated output latency in milliseconds.
+ *
+ * This is the time between mixing a block and hearing it, as estimated
+ * from the device block size.  It does not include any latency added by
+ * the operating system or the hardware.
+ *
+ * @return the estimated output latency in milliseconds.
+ */
+double AudioEngine::getOutputLatency() const {
+    cugl::impl::AudioTimings timings;
+    cugl::impl::AudioQueryTimings(&timings);
+    return timings.latency*1000.0;
+}
+
+/**
+ * Resets the diagnostic counters.
+ *
+ * The counters are cleared by the audio thread before it mixes its next
+ * block, so they may still hold old values immediately after this call.
+ */
+void AudioEngine::resetDiagnostics() {
+    cugl::impl::AudioResetTimings();
 }
 
 
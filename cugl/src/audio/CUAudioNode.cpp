@@ -0,0 +1,942 @@
+//
+//  CUAudioNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the nodes of the software mixer graph.  Audio is
+//  pulled through the graph from an AudioOutput, which is the root of the
+//  graph.  Each node renders a block of interleaved float samples on demand.
+//  Sources are the leaves, while panners and buses combine and transform the
+//  audio of their inputs.  Every node has a gain, which is ramped across a
+//  block to prevent zipper noise.
+//
+//  The graph is independent of the audio device.  The SDL audio engine pulls
+//  from an AudioOutput in the device callback, but it is also possible to
+//  render the graph offline to a memory buffer.  This makes it possible to
+//  test (and time) the mixer without any audio device at all.
+//
+//  The mixing kernels are vectorized with SSE (or AVX2, if it is enabled by
+//  the compiler).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/audio/CUAudioNode.h>
+#include <cugl/math/CUMathBase.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#if defined CU_MATH_VECTOR_AVX2
+    #include <immintrin.h>
+#elif defined CU_MATH_VECTOR_SSE
+    #include <emmintrin.h>
+#endif
+
+/** The number of frames in the scratch buffer of a panner or bus */
+#define SCRATCH_FRAMES  256
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Mixing Kernels
+/**
+ * Adds the source samples to the destination samples.
+ *
+ * @param dst   The destination samples
+ * @param src   The source samples
+ * @param size  The number of samples
+ */
+static void mix_add(float* dst, const float* src, size_t size) {
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    for(; ii+8 <= size; ii += 8) {
+        _mm256_storeu_ps(dst+ii, _mm256_add_ps(_mm256_loadu_ps(dst+ii), _mm256_loadu_ps(src+ii)));
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    for(; ii+4 <= size; ii += 4) {
+        _mm_storeu_ps(dst+ii, _mm_add_ps(_mm_loadu_ps(dst+ii), _mm_loadu_ps(src+ii)));
+    }
+#endif
+    for(; ii < size; ii++) {
+        dst[ii] += src[ii];
+    }
+}
+
+/**
+ * Multiplies the samples by a constant gain.
+ *
+ * @param buffer    The samples to scale
+ * @param size      The number of samples
+ * @param gain      The gain factor
+ */
+static void mix_scale(float* buffer, size_t size, float gain) {
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    __m256 g = _mm256_set1_ps(gain);
+    for(; ii+8 <= size; ii += 8) {
+        _mm256_storeu_ps(buffer+ii, _mm256_mul_ps(_mm256_loadu_ps(buffer+ii), g));
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    __m128 g = _mm_set1_ps(gain);
+    for(; ii+4 <= size; ii += 4) {
+        _mm_storeu_ps(buffer+ii, _mm_mul_ps(_mm_loadu_ps(buffer+ii), g));
+    }
+#endif
+    for(; ii < size; ii++) {
+        buffer[ii] *= gain;
+    }
+}
+
+/**
+ * Multiplies the samples by a gain ramped linearly across the frames.
+ *
+ * The gain of the first frame is start, and the gain after the last frame
+ * is end.  All of the channels in a frame have the same gain.
+ *
+ * @param buffer    The samples to scale
+ * @param frames    The number of frames
+ * @param channels  The number of channels
+ * @param start     The initial gain
+ * @param end       The final gain
+ */
+static void mix_ramp(float* buffer, Uint32 frames, Uint32 channels, float start, float end) {
+    float step = (end-start)/frames;
+    size_t size = (size_t)frames*channels;
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    if (8 % channels == 0) {
+        float lanes[8];
+        for(int kk = 0; kk < 8; kk++) {
+            lanes[kk] = start+step*(kk/channels);
+        }
+        __m256 g = _mm256_loadu_ps(lanes);
+        __m256 d = _mm256_set1_ps(step*(8/channels));
+        for(; ii+8 <= size; ii += 8) {
+            _mm256_storeu_ps(buffer+ii, _mm256_mul_ps(_mm256_loadu_ps(buffer+ii), g));
+            g = _mm256_add_ps(g, d);
+        }
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    if (4 % channels == 0) {
+        float lanes[4];
+        for(int kk = 0; kk < 4; kk++) {
+            lanes[kk] = start+step*(kk/channels);
+        }
+        __m128 g = _mm_loadu_ps(lanes);
+        __m128 d = _mm_set1_ps(step*(4/channels));
+        for(; ii+4 <= size; ii += 4) {
+            _mm_storeu_ps(buffer+ii, _mm_mul_ps(_mm_loadu_ps(buffer+ii), g));
+            g = _mm_add_ps(g, d);
+        }
+    }
+#endif
+    for(; ii < size; ii++) {
+        buffer[ii] *= start+step*(ii/channels);
+    }
+}
+
+/**
+ * Converts 16-bit samples to float samples in the range [-1,1).
+ *
+ * @param dst   The destination samples
+ * @param src   The source samples
+ * @param size  The number of samples
+ */
+static void mix_convert(float* dst, const Sint16* src, size_t size) {
+    const float scale = 1.0f/32768.0f;
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    __m256 s = _mm256_set1_ps(scale);
+    for(; ii+8 <= size; ii += 8) {
+        __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src+ii)));
+        _mm256_storeu_ps(dst+ii, _mm256_mul_ps(_mm256_cvtepi32_ps(x), s));
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    __m128 s = _mm_set1_ps(scale);
+    for(; ii+8 <= size; ii += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src+ii));
+        // Sign extend by placing each sample in the high half of a word
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(dst+ii,   _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+        _mm_storeu_ps(dst+ii+4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+#endif
+    for(; ii < size; ii++) {
+        dst[ii] = src[ii]*scale;
+    }
+}
+
+/**
+ * Adds float samples to a 16-bit stream, saturating on overflow.
+ *
+ * @param dst   The 16-bit stream
+ * @param src   The float samples
+ * @param size  The number of samples
+ */
+static void mix_output(Sint16* dst, const float* src, size_t size) {
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    __m128 s  = _mm_set1_ps(32768.0f);
+    __m128 lo = _mm_set1_ps(-32768.0f);
+    __m128 hi = _mm_set1_ps(32767.0f);
+    for(; ii+8 <= size; ii += 8) {
+        // Clamp before conversion, as overflow does not saturate
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src+ii),   s), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src+ii+4), s), lo), hi);
+        __m128i x = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        __m128i y = _mm_loadu_si128((const __m128i*)(dst+ii));
+        _mm_storeu_si128((__m128i*)(dst+ii), _mm_adds_epi16(x, y));
+    }
+#endif
+    for(; ii < size; ii++) {
+        float value = std::min(std::max(src[ii]*32768.0f, -32768.0f), 32767.0f);
+        long  total = dst[ii]+std::lrint(value);
+        dst[ii] = (Sint16)std::min(std::max(total, -32768L), 32767L);
+    }
+}
+
+/**
+ * Pans mono samples into a stereo buffer.
+ *
+ * @param dst       The stereo samples
+ * @param src       The mono samples
+ * @param frames    The number of frames
+ * @param left      The gain of the left channel
+ * @param right     The gain of the right channel
+ */
+static void mix_pan_mono(float* dst, const float* src, Uint32 frames, float left, float right) {
+    Uint32 ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    __m128 g = _mm_setr_ps(left, right, left, right);
+    for(; ii+4 <= frames; ii += 4) {
+        __m128 x = _mm_loadu_ps(src+ii);
+        _mm_storeu_ps(dst+2*ii,   _mm_mul_ps(_mm_unpacklo_ps(x, x), g));
+        _mm_storeu_ps(dst+2*ii+4, _mm_mul_ps(_mm_unpackhi_ps(x, x), g));
+    }
+#endif
+    for(; ii < frames; ii++) {
+        dst[2*ii  ] = src[ii]*left;
+        dst[2*ii+1] = src[ii]*right;
+    }
+}
+
+/**
+ * Pans stereo samples into a stereo buffer.
+ *
+ * @param dst       The stereo samples
+ * @param src       The stereo samples
+ * @param frames    The number of frames
+ * @param left      The gain of the left channel
+ * @param right     The gain of the right channel
+ */
+static void mix_pan_stereo(float* dst, const float* src, Uint32 frames, float left, float right) {
+    size_t size = 2*(size_t)frames;
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    __m256 g = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+    for(; ii+8 <= size; ii += 8) {
+        _mm256_storeu_ps(dst+ii, _mm256_mul_ps(_mm256_loadu_ps(src+ii), g));
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    __m128 g = _mm_setr_ps(left, right, left, right);
+    for(; ii+4 <= size; ii += 4) {
+        _mm_storeu_ps(dst+ii, _mm_mul_ps(_mm_loadu_ps(src+ii), g));
+    }
+#endif
+    for(; ii < size; ii += 2) {
+        dst[ii  ] = src[ii  ]*left;
+        dst[ii+1] = src[ii+1]*right;
+    }
+}
+
+/**
+ * Averages stereo samples into a mono buffer.
+ *
+ * @param dst       The mono samples
+ * @param src       The stereo samples
+ * @param frames    The number of frames
+ */
+static void mix_downmix(float* dst, const float* src, Uint32 frames) {
+    Uint32 ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    __m128 h = _mm_set1_ps(0.5f);
+    for(; ii+4 <= frames; ii += 4) {
+        __m128 a = _mm_loadu_ps(src+2*ii);
+        __m128 b = _mm_loadu_ps(src+2*ii+4);
+        __m128 l = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(dst+ii, _mm_mul_ps(_mm_add_ps(l, r), h));
+    }
+#endif
+    for(; ii < frames; ii++) {
+        dst[ii] = 0.5f*(src[2*ii]+src[2*ii+1]);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Audio Node
+/**
+ * Creates a degenerate audio node.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioNode::AudioNode() :
+_channels(0),
+_sampling(0),
+_gain(1.0f),
+_ramp(-1.0f),
+_paused(false),
+_booted(false) {
+}
+
+/**
+ * Initializes this node with the given channels and sample rate.
+ *
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ *
+ * @return true if the node was initialized successfully
+ */
+bool AudioNode::init(Uint32 channels, Uint32 sampling) {
+    CUAssertLog(!_booted, "Audio node is already initialized");
+    CUAssertLog(channels, "The number of channels must be non-zero");
+    _channels = channels;
+    _sampling = sampling;
+    _gain.store(1.0f);
+    _ramp = -1.0f;
+    _paused.store(false);
+    _booted = true;
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this node.
+ *
+ * A disposed node can be safely reinitialized.
+ */
+void AudioNode::dispose() {
+    _channels = 0;
+    _sampling = 0;
+    _booted = false;
+}
+
+/**
+ * Reads up to the given number of frames into the buffer.
+ *
+ * The buffer must have room for frames*channels samples, and its
+ * contents are overwritten.  If the node produces fewer frames than
+ * requested (because it completed), the remainder of the buffer is set
+ * to silence.  A paused node produces silence for the full request.
+ *
+ * This method should only be called by the audio thread (or by an
+ * offline render).
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to read
+ *
+ * @return the number of frames actually produced
+ */
+Uint32 AudioNode::read(float* buffer, Uint32 frames) {
+    if (!frames) {
+        return 0;
+    } else if (_paused.load(std::memory_order_relaxed)) {
+        std::memset(buffer, 0, (size_t)frames*_channels*sizeof(float));
+        return frames;
+    }
+
+    Uint32 amt = fill(buffer, frames);
+    if (amt < frames) {
+        std::memset(buffer+(size_t)amt*_channels, 0, (size_t)(frames-amt)*_channels*sizeof(float));
+    }
+
+    // The first block starts at the target gain
+    float gain = _gain.load(std::memory_order_relaxed);
+    if (_ramp < 0) {
+        _ramp = gain;
+    }
+    if (gain != _ramp) {
+        mix_ramp(buffer, frames, _channels, _ramp, gain);
+        _ramp = gain;
+    } else if (gain != 1.0f) {
+        mix_scale(buffer, (size_t)amt*_channels, gain);
+    }
+    return amt;
+}
+
+
+#pragma mark -
+#pragma mark Audio Source
+/**
+ * Creates a degenerate audio source.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioSource::AudioSource() : AudioNode(),
+_pcm16(nullptr),
+_pcm32(nullptr),
+_length(0),
+_offset(0),
+_jump(-1),
+_expire(-1),
+_loop(false),
+_done(false) {
+}
+
+/**
+ * Initializes a source for the given 16-bit PCM data.
+ *
+ * @param data      The interleaved PCM data
+ * @param frames    The length of the data in frames
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ *
+ * @return true if the source was initialized successfully
+ */
+bool AudioSource::init(const Sint16* data, Uint64 frames, Uint32 channels, Uint32 sampling) {
+    if (!AudioNode::init(channels,sampling)) {
+        return false;
+    }
+    _pcm16  = data;
+    _length = frames;
+    return true;
+}
+
+/**
+ * Initializes a source for the given float PCM data.
+ *
+ * @param data      The interleaved PCM data
+ * @param frames    The length of the data in frames
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ *
+ * @return true if the source was initialized successfully
+ */
+bool AudioSource::init(const float* data, Uint64 frames, Uint32 channels, Uint32 sampling) {
+    if (!AudioNode::init(channels,sampling)) {
+        return false;
+    }
+    _pcm32  = data;
+    _length = frames;
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this source.
+ *
+ * A disposed source can be safely reinitialized.
+ */
+void AudioSource::dispose() {
+    _pcm16  = nullptr;
+    _pcm32  = nullptr;
+    _length = 0;
+    _offset.store(0);
+    _jump.store(-1);
+    _expire.store(-1);
+    _loop.store(false);
+    _done.store(false);
+    _listener = nullptr;
+    AudioNode::dispose();
+}
+
+/**
+ * Returns the current playback position in frames.
+ *
+ * @return the current playback position in frames.
+ */
+Uint64 AudioSource::getPosition() const {
+    Sint64 jump = _jump.load();
+    return (jump >= 0 ? (Uint64)jump : _offset.load());
+}
+
+/**
+ * Sets the current playback position in frames.
+ *
+ * The position takes effect on the next block.
+ *
+ * @param frame The playback position in frames
+ */
+void AudioSource::setPosition(Uint64 frame) {
+    _jump.store((Sint64)std::min(frame,_length));
+}
+
+/**
+ * Produces up to the given number of frames in the buffer.
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to produce
+ *
+ * @return the number of frames actually produced
+ */
+Uint32 AudioSource::fill(float* buffer, Uint32 frames) {
+    if (_done.load()) {
+        return 0;
+    }
+
+    Uint64 offset = _offset.load();
+    Sint64 jump = _jump.exchange(-1);
+    if (jump >= 0) {
+        offset = (Uint64)jump;
+    }
+    Sint64 expire = _expire.load();
+
+    Uint32 total = 0;
+    bool done = false;
+    while (total < frames && !done) {
+        Uint64 take = std::min((Uint64)(frames-total), _length-offset);
+        if (expire >= 0) {
+            take = std::min(take, (Uint64)(expire-total));
+        }
+
+        size_t size = (size_t)take*_channels;
+        float* output = buffer+(size_t)total*_channels;
+        if (_pcm16) {
+            mix_convert(output, _pcm16+offset*_channels, size);
+        } else if (_pcm32) {
+            std::memcpy(output, _pcm32+offset*_channels, size*sizeof(float));
+        }
+        offset += take;
+        total  += (Uint32)take;
+
+        if (expire >= 0 && total == expire) {
+            done = true;
+        } else if (offset >= _length) {
+            if (_loop.load(std::memory_order_relaxed) && _length) {
+                offset = 0;
+            } else {
+                done = true;
+            }
+        }
+    }
+
+    // Only consume the expiration if it was not changed in the meantime
+    if (expire >= 0) {
+        _expire.compare_exchange_strong(expire, expire-total);
+    }
+    _offset.store(offset);
+    if (done) {
+        _done.store(true);
+        if (_listener) {
+            _listener(this);
+        }
+    }
+    return total;
+}
+
+
+#pragma mark -
+#pragma mark Audio Panner
+/**
+ * Creates a degenerate audio panner.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioPanner::AudioPanner() : AudioNode(),
+_pan(0.0f),
+_scratch(nullptr) {
+}
+
+/**
+ * Initializes a panner with the given output channels and sample rate.
+ *
+ * @param channels  The number of output channels (1 or 2)
+ * @param sampling  The sample rate in HZ
+ *
+ * @return true if the panner was initialized successfully
+ */
+bool AudioPanner::init(Uint32 channels, Uint32 sampling) {
+    if (!AudioNode::init(channels,sampling)) {
+        return false;
+    }
+    _scratch = new float[SCRATCH_FRAMES*std::max(channels,2u)];
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this panner.
+ *
+ * A disposed panner can be safely reinitialized.
+ */
+void AudioPanner::dispose() {
+    _input = nullptr;
+    if (_scratch) {
+        delete[] _scratch;
+        _scratch = nullptr;
+    }
+    _pan.store(0.0f);
+    AudioNode::dispose();
+}
+
+/**
+ * Sets the pan value of this panner.
+ *
+ * The value -1 is hard left, and 1 is hard right.
+ *
+ * @param pan   The pan value of this panner.
+ */
+void AudioPanner::setPan(float pan) {
+    CUAssertLog(-1 <= pan && pan <= 1, "The pan value %.3f is out of range",pan);
+    _pan.store(pan, std::memory_order_relaxed);
+}
+
+/**
+ * Attaches an input to this panner, returning the previous input.
+ *
+ * The input must be mono or stereo, and must have the same sample rate
+ * as this panner.  Passing nullptr detaches the current input.
+ *
+ * @param node  The input node
+ *
+ * @return the previous input node
+ */
+std::shared_ptr<AudioNode> AudioPanner::attach(const std::shared_ptr<AudioNode>& node) {
+    CUAssertLog(!node || node->getSampling() == _sampling,
+                "Input sample rate %d does not match %d", node->getSampling(), _sampling);
+    CUAssertLog(!node || node->getChannels() <= 2 || node->getChannels() == _channels,
+                "Input has an unsupported number of channels %d", node->getChannels());
+    std::shared_ptr<AudioNode> result = node;
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(_input, result);
+    return result;
+}
+
+/**
+ * Returns the input of this panner.
+ *
+ * @return the input of this panner.
+ */
+std::shared_ptr<AudioNode> AudioPanner::getInput() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _input;
+}
+
+/**
+ * Returns true if this panner has no input, or its input has completed.
+ *
+ * @return true if this panner will produce no more audio.
+ */
+bool AudioPanner::completed() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _input == nullptr || _input->completed();
+}
+
+/**
+ * Produces up to the given number of frames in the buffer.
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to produce
+ *
+ * @return the number of frames actually produced
+ */
+Uint32 AudioPanner::fill(float* buffer, Uint32 frames) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_input == nullptr) {
+        return 0;
+    }
+
+    Uint32 inputs = _input->getChannels();
+    float pan = _pan.load(std::memory_order_relaxed);
+    if (inputs == _channels && (inputs != 2 || pan == 0)) {
+        return _input->read(buffer, frames);
+    }
+
+    float left  = std::min(1.0f, 1.0f-pan);
+    float right = std::min(1.0f, 1.0f+pan);
+    Uint32 total = 0;
+    while (total < frames) {
+        Uint32 take = std::min(frames-total, (Uint32)SCRATCH_FRAMES);
+        Uint32 amt  = _input->read(_scratch, take);
+        float* output = buffer+(size_t)total*_channels;
+        if (_channels == 2) {
+            if (inputs == 1) {
+                mix_pan_mono(output, _scratch, amt, left, right);
+            } else {
+                mix_pan_stereo(output, _scratch, amt, left, right);
+            }
+        } else if (_channels == 1 && inputs == 2) {
+            mix_downmix(output, _scratch, amt);
+        } else {
+            std::memset(output, 0, (size_t)amt*_channels*sizeof(float));
+        }
+        total += amt;
+        if (amt < take) {
+            break;
+        }
+    }
+    return total;
+}
+
+
+#pragma mark -
+#pragma mark Audio Bus
+/**
+ * Creates a degenerate audio bus.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioBus::AudioBus() : AudioNode(),
+_scratch(nullptr) {
+}
+
+/**
+ * Initializes a bus with the given channels, sample rate and slots.
+ *
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ * @param slots     The number of input slots
+ *
+ * @return true if the bus was initialized successfully
+ */
+bool AudioBus::init(Uint32 channels, Uint32 sampling, Uint32 slots) {
+    if (!AudioNode::init(channels,sampling)) {
+        return false;
+    }
+    _inputs.resize(slots,nullptr);
+    _scratch = new float[SCRATCH_FRAMES*channels];
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this bus.
+ *
+ * A disposed bus can be safely reinitialized.
+ */
+void AudioBus::dispose() {
+    _inputs.clear();
+    if (_scratch) {
+        delete[] _scratch;
+        _scratch = nullptr;
+    }
+    AudioNode::dispose();
+}
+
+/**
+ * Attaches an input to the given slot, returning the previous input.
+ *
+ * The input must have the same channels and sample rate as this bus.
+ * Passing nullptr empties the slot.
+ *
+ * @param slot  The input slot
+ * @param node  The input node
+ *
+ * @return the previous input node
+ */
+std::shared_ptr<AudioNode> AudioBus::attach(Uint32 slot, const std::shared_ptr<AudioNode>& node) {
+    CUAssertLog(slot < _inputs.size(), "Slot %d is out of range", slot);
+    CUAssertLog(!node || (node->getChannels() == _channels && node->getSampling() == _sampling),
+                "Input format does not match the bus");
+    std::shared_ptr<AudioNode> result = node;
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(_inputs[slot], result);
+    return result;
+}
+
+/**
+ * Returns the input in the given slot.
+ *
+ * @param slot  The input slot
+ *
+ * @return the input in the given slot.
+ */
+std::shared_ptr<AudioNode> AudioBus::getInput(Uint32 slot) {
+    CUAssertLog(slot < _inputs.size(), "Slot %d is out of range", slot);
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _inputs[slot];
+}
+
+/**
+ * Produces the given number of frames in the buffer.
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to produce
+ *
+ * @return the number of frames actually produced
+ */
+Uint32 AudioBus::fill(float* buffer, Uint32 frames) {
+    std::memset(buffer, 0, (size_t)frames*_channels*sizeof(float));
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto it = _inputs.begin(); it != _inputs.end(); ++it) {
+        AudioNode* node = it->get();
+        if (node == nullptr || node->completed()) {
+            continue;
+        }
+        for(Uint32 pos = 0; pos < frames; ) {
+            Uint32 take = std::min(frames-pos, (Uint32)SCRATCH_FRAMES);
+            Uint32 amt  = node->read(_scratch, take);
+            mix_add(buffer+(size_t)pos*_channels, _scratch, (size_t)amt*_channels);
+            pos += take;
+            if (amt < take) {
+                break;
+            }
+        }
+    }
+    return frames;
+}
+
+
+#pragma mark -
+#pragma mark Audio Output
+/**
+ * Creates a degenerate audio output.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioOutput::AudioOutput() :
+_channels(0),
+_sampling(0),
+_blocksize(0),
+_buffer(nullptr) {
+}
+
+/**
+ * Initializes an output with the given channels, rate and block size.
+ *
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ * @param blocksize The number of frames in a block
+ *
+ * @return true if the output was initialized successfully
+ */
+bool AudioOutput::init(Uint32 channels, Uint32 sampling, Uint32 blocksize) {
+    CUAssertLog(!_buffer, "Audio output is already initialized");
+    CUAssertLog(channels && blocksize, "The channels and block size must be non-zero");
+    _channels  = channels;
+    _sampling  = sampling;
+    _blocksize = blocksize;
+    _buffer = new float[(size_t)blocksize*channels];
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this output.
+ *
+ * A disposed output can be safely reinitialized.
+ */
+void AudioOutput::dispose() {
+    _input = nullptr;
+    if (_buffer) {
+        delete[] _buffer;
+        _buffer = nullptr;
+    }
+    _channels  = 0;
+    _sampling  = 0;
+    _blocksize = 0;
+}
+
+/**
+ * Attaches an input to this output, returning the previous input.
+ *
+ * The input must have the same channels and sample rate as this output.
+ *
+ * @param node  The input node
+ *
+ * @return the previous input node
+ */
+std::shared_ptr<AudioNode> AudioOutput::attach(const std::shared_ptr<AudioNode>& node) {
+    CUAssertLog(!node || (node->getChannels() == _channels && node->getSampling() == _sampling),
+                "Input format does not match the output");
+    std::shared_ptr<AudioNode> result = node;
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::swap(_input, result);
+    return result;
+}
+
+/**
+ * Returns the input of this output.
+ *
+ * @return the input of this output.
+ */
+std::shared_ptr<AudioNode> AudioOutput::getInput() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _input;
+}
+
+/**
+ * Renders the given number of frames to the buffer.
+ *
+ * This is the offline entry point to the mixer graph.  The buffer must
+ * have room for frames*channels samples.  The graph is processed one
+ * block at a time, exactly as it is in the device callback.
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to render
+ */
+void AudioOutput::render(float* buffer, Uint32 frames) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(Uint32 pos = 0; pos < frames; pos += _blocksize) {
+        Uint32 take = std::min(frames-pos, _blocksize);
+        float* output = buffer+(size_t)pos*_channels;
+        if (_input) {
+            _input->read(output, take);
+        } else {
+            std::memset(output, 0, (size_t)take*_channels*sizeof(float));
+        }
+    }
+}
+
+/**
+ * Mixes the graph into the given device stream.
+ *
+ * The output is added to (not written over) the existing stream.  Only
+ * the formats AUDIO_S16SYS and AUDIO_F32SYS are supported.  The 16-bit
+ * mix saturates on overflow.
+ *
+ * @param stream    The device stream
+ * @param len       The length of the stream in bytes
+ * @param format    The device format
+ */
+void AudioOutput::mix(Uint8* stream, int len, SDL_AudioFormat format) {
+    CUAssertLog(format == AUDIO_S16SYS || format == AUDIO_F32SYS,
+                "Audio format %x is not supported", format);
+    Uint32 frames = (Uint32)len/(_channels*(SDL_AUDIO_BITSIZE(format)/8));
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_input == nullptr) {
+        return;
+    }
+    for(Uint32 pos = 0; pos < frames; pos += _blocksize) {
+        Uint32 take = std::min(frames-pos, _blocksize);
+        size_t size = (size_t)take*_channels;
+        _input->read(_buffer, take);
+        if (format == AUDIO_F32SYS) {
+            mix_add(((float*)stream)+(size_t)pos*_channels, _buffer, size);
+        } else if (format == AUDIO_S16SYS) {
+            mix_output(((Sint16*)stream)+(size_t)pos*_channels, _buffer, size);
+        }
+    }
+}
@@ -0,0 +1,516 @@
+//
+//  CUAudioResampler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a node that converts the sample rate of its input.
+//  This allows sound assets to be kept at their native sample rate, and to be
+//  converted to the device rate at mix time.  As the conversion ratio may be
+//  changed at any time, this node also provides pitch (playback rate) control.
+//
+//  The default conversion is a polyphase windowed-sinc filter.  The filter
+//  coefficients are tabulated, and interpolated between phases, so the ratio
+//  does not need to be rational.  The tables for a fixed set of cutoffs are
+//  shared by all resamplers, so a rate change never rebuilds a table on the
+//  audio thread.  There is also a linear interpolation option, which is
+//  much cheaper, but has audible aliasing.  The filter kernels are vectorized
+//  with SSE (or AVX2, if it is enabled by the compiler).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/audio/CUAudioResampler.h>
+#include <cugl/math/CUMathBase.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <mutex>
+#if defined CU_MATH_VECTOR_AVX2
+    #include <immintrin.h>
+#elif defined CU_MATH_VECTOR_SSE
+    #include <emmintrin.h>
+#endif
+
+/** Half the number of filter taps (the reach of the filter on either side) */
+#define RESAMPLE_HALF       (AUDIO_RESAMPLER_TAPS/2)
+/** The number of input frames read in a single block */
+#define RESAMPLE_BLOCK      256
+/** The capacity of the input history in frames */
+#define RESAMPLE_HISTORY    (2*RESAMPLE_BLOCK+AUDIO_RESAMPLER_TAPS)
+/** The shape parameter of the Kaiser window */
+#define RESAMPLE_BETA       8.0
+/** The fraction of the Nyquist frequency passed by the filter */
+#define RESAMPLE_ROLLOFF    0.95f
+/** The minimum playback rate */
+#define RESAMPLE_RATE_MIN   0.125f
+/** The maximum playback rate */
+#define RESAMPLE_RATE_MAX   8.0f
+/** The number of filter tables per octave of decimation */
+#define RESAMPLE_BANK_STEPS 4
+/** The number of filter tables (decimating by up to 16, or four octaves) */
+#define RESAMPLE_BANK_SIZE  (4*RESAMPLE_BANK_STEPS+1)
+/** The number of coefficients in a single filter table */
+#define RESAMPLE_TABLE      ((AUDIO_RESAMPLER_PHASES+1)*AUDIO_RESAMPLER_TAPS)
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Filter Kernels
+/**
+ * Returns the zeroth order modified Bessel function of the first kind.
+ *
+ * This is used to compute the Kaiser window.
+ *
+ * @param x     The function argument
+ *
+ * @return the zeroth order modified Bessel function of the first kind.
+ */
+static double bessel_i0(double x) {
+    double sum  = 1.0;
+    double term = 1.0;
+    double half = x/2.0;
+    for(int kk = 1; term > 1e-12*sum; kk++) {
+        term *= (half/kk)*(half/kk);
+        sum  += term;
+    }
+    return sum;
+}
+
+/**
+ * Tabulates the filter coefficients for the given cutoff.
+ *
+ * The cutoff is relative to the Nyquist frequency of the input.  The table
+ * has PHASES+1 rows of TAPS coefficients.
+ *
+ * @param table     The table to store the coefficients
+ * @param cutoff    The filter cutoff
+ */
+static void resample_tabulate(float* table, double cutoff) {
+    double norm = bessel_i0(RESAMPLE_BETA);
+    for(Uint32 pp = 0; pp <= AUDIO_RESAMPLER_PHASES; pp++) {
+        float* row = table+pp*AUDIO_RESAMPLER_TAPS;
+        double frac = (double)pp/AUDIO_RESAMPLER_PHASES;
+        double sum  = 0.0;
+        for(Uint32 jj = 0; jj < AUDIO_RESAMPLER_TAPS; jj++) {
+            // Distance from the tap to the output position
+            double dist = (double)jj-(RESAMPLE_HALF-1)-frac;
+            double x = dist/RESAMPLE_HALF;
+            double window = (std::fabs(x) <= 1.0 ? bessel_i0(RESAMPLE_BETA*std::sqrt(1.0-x*x))/norm : 0.0);
+            double sinc = (dist == 0.0 ? cutoff : std::sin(M_PI*cutoff*dist)/(M_PI*dist));
+            row[jj] = (float)(sinc*window);
+            sum += row[jj];
+        }
+        // Normalize for unity gain at DC
+        for(Uint32 jj = 0; jj < AUDIO_RESAMPLER_TAPS; jj++) {
+            row[jj] = (float)(row[jj]/sum);
+        }
+    }
+}
+
+/** The filter tables shared by all resamplers, one per cutoff */
+static float* resample_bank = nullptr;
+/** The flag guarding the construction of the filter tables */
+static std::once_flag resample_built;
+
+/**
+ * Returns the filter tables shared by all resamplers.
+ *
+ * Table k has a cutoff of ROLLOFF/2^(k/STEPS), which is appropriate when
+ * decimating by up to 2^(k/STEPS).  The tables are built on the first call,
+ * so this function should first be called when a resampler is initialized,
+ * and never for the first time on the audio thread.
+ *
+ * @return the filter tables shared by all resamplers.
+ */
+static const float* resample_tables() {
+    std::call_once(resample_built, [] {
+        resample_bank = new float[RESAMPLE_BANK_SIZE*RESAMPLE_TABLE];
+        for(Uint32 kk = 0; kk < RESAMPLE_BANK_SIZE; kk++) {
+            double cutoff = RESAMPLE_ROLLOFF*std::pow(2.0,-(double)kk/RESAMPLE_BANK_STEPS);
+            resample_tabulate(resample_bank+kk*RESAMPLE_TABLE, cutoff);
+        }
+    });
+    return resample_bank;
+}
+
+/**
+ * Returns the filter table for the given conversion step.
+ *
+ * The step is the number of input frames per output frame.  The table has
+ * the largest cutoff that is no more than the ideal one for this step, so
+ * the filter never aliases.  The only exception is decimation by more than
+ * the bank supports, which uses the lowest cutoff available.
+ *
+ * @param step  The number of input frames per output frame
+ *
+ * @return the filter table for the given conversion step.
+ */
+static const float* resample_kernel(double step) {
+    Uint32 index = 0;
+    if (step > 1.0) {
+        // Round toward the lower cutoff, ignoring float error on exact steps
+        double octaves = std::log2(step)*RESAMPLE_BANK_STEPS;
+        index = (Uint32)std::min(std::ceil(octaves-1e-6),(double)RESAMPLE_BANK_SIZE-1);
+    }
+    return resample_tables()+index*RESAMPLE_TABLE;
+}
+
+/**
+ * Interpolates between two rows of filter coefficients.
+ *
+ * @param dst   The destination coefficients
+ * @param row0  The coefficients of the lower phase
+ * @param row1  The coefficients of the upper phase
+ * @param t     The interpolation factor
+ */
+static void resample_lerp(float* dst, const float* row0, const float* row1, float t) {
+#if defined CU_MATH_VECTOR_AVX2
+    __m256 vt = _mm256_set1_ps(t);
+    for(size_t ii = 0; ii < AUDIO_RESAMPLER_TAPS; ii += 8) {
+        __m256 a = _mm256_loadu_ps(row0+ii);
+        __m256 b = _mm256_loadu_ps(row1+ii);
+        _mm256_storeu_ps(dst+ii, _mm256_add_ps(a, _mm256_mul_ps(vt, _mm256_sub_ps(b, a))));
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    __m128 vt = _mm_set1_ps(t);
+    for(size_t ii = 0; ii < AUDIO_RESAMPLER_TAPS; ii += 4) {
+        __m128 a = _mm_loadu_ps(row0+ii);
+        __m128 b = _mm_loadu_ps(row1+ii);
+        _mm_storeu_ps(dst+ii, _mm_add_ps(a, _mm_mul_ps(vt, _mm_sub_ps(b, a))));
+    }
+#else
+    for(size_t ii = 0; ii < AUDIO_RESAMPLER_TAPS; ii++) {
+        dst[ii] = row0[ii]+t*(row1[ii]-row0[ii]);
+    }
+#endif
+}
+
+/**
+ * Returns the dot product of the filter coefficients and the input.
+ *
+ * @param coef  The filter coefficients
+ * @param src   The input samples (one channel)
+ *
+ * @return the dot product of the filter coefficients and the input.
+ */
+static float resample_dot(const float* coef, const float* src) {
+#if defined CU_MATH_VECTOR_AVX2
+    __m256 acc = _mm256_setzero_ps();
+    for(size_t ii = 0; ii < AUDIO_RESAMPLER_TAPS; ii += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(coef+ii), _mm256_loadu_ps(src+ii)));
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#elif defined CU_MATH_VECTOR_SSE
+    __m128 acc = _mm_setzero_ps();
+    for(size_t ii = 0; ii < AUDIO_RESAMPLER_TAPS; ii += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(coef+ii), _mm_loadu_ps(src+ii)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+#else
+    float sum = 0.0f;
+    for(size_t ii = 0; ii < AUDIO_RESAMPLER_TAPS; ii++) {
+        sum += coef[ii]*src[ii];
+    }
+    return sum;
+#endif
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a degenerate audio resampler.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioResampler::AudioResampler() : AudioNode(),
+_quality(Quality::SINC),
+_rate(1.0f),
+_kernel(nullptr),
+_history(nullptr),
+_scratch(nullptr),
+_filled(0),
+_position(0),
+_end(-1) {
+}
+
+/**
+ * Initializes a resampler with the given channels and output sample rate.
+ *
+ * @param channels  The number of audio channels
+ * @param sampling  The output sample rate in HZ
+ *
+ * @return true if the resampler was initialized successfully
+ */
+bool AudioResampler::init(Uint32 channels, Uint32 sampling) {
+    if (!AudioNode::init(channels,sampling)) {
+        return false;
+    }
+    _kernel  = resample_kernel(1.0);
+    _history = new float[RESAMPLE_HISTORY*channels];
+    _scratch = new float[RESAMPLE_BLOCK*channels];
+    reset();
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this resampler.
+ *
+ * A disposed resampler can be safely reinitialized.
+ */
+void AudioResampler::dispose() {
+    _input = nullptr;
+    _kernel = nullptr;
+    if (_history) {
+        delete[] _history;
+        _history = nullptr;
+    }
+    if (_scratch) {
+        delete[] _scratch;
+        _scratch = nullptr;
+    }
+    _quality.store(Quality::SINC);
+    _rate.store(1.0f);
+    _filled = 0;
+    _position = 0;
+    _end = -1;
+    AudioNode::dispose();
+}
+
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Sets the playback rate of the input.
+ *
+ * A rate of 1 plays the input at its natural speed.  A rate of 2 plays it
+ * twice as fast (an octave higher), while a rate of 0.5 plays it at half
+ * speed (an octave lower). The rate is clamped to the range [1/8, 8].
+ * The change takes effect at the next block.
+ *
+ * @param rate  The playback rate of the input.
+ */
+void AudioResampler::setRate(float rate) {
+    rate = std::min(std::max(rate,RESAMPLE_RATE_MIN),RESAMPLE_RATE_MAX);
+    _rate.store(rate, std::memory_order_relaxed);
+}
+
+/**
+ * Attaches an input node, returning the previous one.
+ *
+ * The input must have the same number of channels as this node.  The
+ * conversion state is reset, so the new input starts at its current
+ * position.  Passing nullptr detaches the current input.
+ *
+ * @param node  The input node
+ *
+ * @return the previous input node (or nullptr)
+ */
+std::shared_ptr<AudioNode> AudioResampler::attach(const std::shared_ptr<AudioNode>& node) {
+    CUAssertLog(node == nullptr || node->getChannels() == _channels,
+                "Input has %d channels, not %d", (node ? node->getChannels() : 0), _channels);
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::shared_ptr<AudioNode> previous = _input;
+    _input = node;
+    reset();
+    return previous;
+}
+
+/**
+ * Returns the input node (or nullptr if there is none).
+ *
+ * @return the input node (or nullptr if there is none).
+ */
+std::shared_ptr<AudioNode> AudioResampler::getInput() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _input;
+}
+
+/**
+ * Returns true if this node will produce no more audio.
+ *
+ * A resampler completes when it has no input, or when its input has
+ * completed and the remaining history has been converted.
+ *
+ * @return true if this node will produce no more audio.
+ */
+bool AudioResampler::completed() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _input == nullptr || (_end >= 0 && _position >= _end);
+}
+
+
+#pragma mark -
+#pragma mark Audio Processing
+/**
+ * Produces up to the given number of frames in the buffer.
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to produce
+ *
+ * @return the number of frames actually produced
+ */
+Uint32 AudioResampler::fill(float* buffer, Uint32 frames) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_input == nullptr) {
+        return 0;
+    }
+
+    double step = _rate.load(std::memory_order_relaxed)*_input->getSampling()/(double)_sampling;
+    Quality quality = _quality.load(std::memory_order_relaxed);
+    if (quality == Quality::SINC) {
+        // Lower the cutoff when decimating to prevent aliasing
+        _kernel = resample_kernel(step);
+    }
+
+    float coef[AUDIO_RESAMPLER_TAPS];
+    Uint32 total = 0;
+    while (total < frames) {
+        if (_end >= 0 && _position >= _end) {
+            break;
+        }
+
+        // The filter reaches RESAMPLE_HALF frames past the current frame
+        double limit = (double)_filled-RESAMPLE_HALF-1;
+        if (_position > limit) {
+            refill();
+            continue;
+        }
+
+        Uint32 count = std::min(frames-total, (Uint32)((limit-_position)/step)+1);
+        if (_end >= 0) {
+            count = std::min(count, (Uint32)std::ceil((_end-_position)/step));
+        }
+
+        float* output = buffer+(size_t)total*_channels;
+        if (step == 1.0 && _position == std::floor(_position)) {
+            // No conversion necessary
+            size_t start = (size_t)_position;
+            for(Uint32 ch = 0; ch < _channels; ch++) {
+                const float* input = _history+ch*RESAMPLE_HISTORY+start;
+                for(Uint32 ii = 0; ii < count; ii++) {
+                    output[ii*_channels+ch] = input[ii];
+                }
+            }
+            _position += count;
+        } else if (quality == Quality::LINEAR) {
+            for(Uint32 ii = 0; ii < count; ii++) {
+                size_t index = (size_t)_position;
+                float frac = (float)(_position-index);
+                for(Uint32 ch = 0; ch < _channels; ch++) {
+                    const float* input = _history+ch*RESAMPLE_HISTORY+index;
+                    *output++ = input[0]+frac*(input[1]-input[0]);
+                }
+                _position += step;
+            }
+        } else {
+            for(Uint32 ii = 0; ii < count; ii++) {
+                size_t index = (size_t)_position;
+                float phase = (float)(_position-index)*AUDIO_RESAMPLER_PHASES;
+                size_t row  = std::min((size_t)phase,(size_t)AUDIO_RESAMPLER_PHASES-1);
+                const float* row0 = _kernel+row*AUDIO_RESAMPLER_TAPS;
+                resample_lerp(coef, row0, row0+AUDIO_RESAMPLER_TAPS, phase-row);
+                for(Uint32 ch = 0; ch < _channels; ch++) {
+                    const float* input = _history+ch*RESAMPLE_HISTORY+index-(RESAMPLE_HALF-1);
+                    *output++ = resample_dot(coef, input);
+                }
+                _position += step;
+            }
+        }
+        total += count;
+    }
+    return total;
+}
+
+/**
+ * Resets the conversion state for a new input.
+ *
+ * This method must be called with the mutex held.
+ */
+void AudioResampler::reset() {
+    // Silence before the first frame lets the filter start immediately
+    std::memset(_history, 0, (size_t)RESAMPLE_HISTORY*_channels*sizeof(float));
+    _filled = RESAMPLE_HALF;
+    _position = RESAMPLE_HALF;
+    _end = -1;
+}
+
+/**
+ * Reads another block of input into the history.
+ *
+ * Older frames that are no longer needed are discarded first.  Once the
+ * input has completed, the history is padded with silence.
+ */
+void AudioResampler::refill() {
+    // Discard the frames before the reach of the filter
+    size_t first = std::min((size_t)_position-(RESAMPLE_HALF-1),(size_t)_filled);
+    if (first > 0) {
+        for(Uint32 ch = 0; ch < _channels; ch++) {
+            float* row = _history+ch*RESAMPLE_HISTORY;
+            std::memmove(row, row+first, (_filled-first)*sizeof(float));
+        }
+        _filled -= (Uint32)first;
+        _position -= first;
+        if (_end >= 0) {
+            _end -= first;
+        }
+    }
+
+    Uint32 take = std::min((Uint32)RESAMPLE_BLOCK,(Uint32)RESAMPLE_HISTORY-_filled);
+    Uint32 amt  = 0;
+    if (_end < 0) {
+        // Short reads from an active input (such as a stream underrun) are silence
+        amt = _input->read(_scratch, take);
+        if (amt < take && _input->completed()) {
+            _end = _filled+amt;
+        } else {
+            amt = take;
+        }
+    }
+
+    for(Uint32 ch = 0; ch < _channels; ch++) {
+        float* row = _history+ch*RESAMPLE_HISTORY+_filled;
+        const float* input = _scratch+ch;
+        for(Uint32 ii = 0; ii < amt; ii++) {
+            row[ii] = input[ii*_channels];
+        }
+        std::memset(row+amt, 0, (take-amt)*sizeof(float));
+    }
+    _filled += take;
+}
@@ -0,0 +1,676 @@
+//
+//  CUAudioStreamer.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a source node that streams an Ogg Vorbis file.
+//  Unlike AudioSource, the file is never decoded completely into memory.
+//  Instead, a worker thread (shared by all streams) decodes the file
+//  incrementally into a ring buffer, which is consumed by the mixer.  Only
+//  the ring buffer is resident, so this is much cheaper than a fully decoded
+//  sound for long assets like ambience.
+//
+//  The ring buffer has a single producer (the worker thread) and a single
+//  consumer (the audio thread), so it is lock-free.  The audio thread never
+//  blocks on the decoder.  If the decoder falls behind, the node produces
+//  silence and counts an underrun.
+//
+//  The decoder requires vorbisfile, which is not linked on every platform.
+//  This class is only compiled when CU_AUDIO_STREAMING is defined, which the
+//  Windows and Android projects do.  It is only used by the SDL backend, so
+//  it is never compiled with AVFoundation.  Otherwise, streaming sounds fall
+//  back to a buffer decoded completely into memory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/audio/CUAudioStreamer.h>
+#if defined (CU_AUDIO_STREAMING)
+#include <cugl/util/CUDebug.h>
+#include <SDL/SDL.h>
+#define OV_EXCLUDE_STATIC_CALLBACKS
+#include <vorbis/vorbisfile.h>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+
+/** The maximum number of frames decoded in a single step */
+#define AUDIO_STREAM_CHUNK  1024
+/** The number of milliseconds the worker sleeps when the ring is full */
+#define AUDIO_STREAM_SLEEP  5
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Vorbis Callbacks
+/**
+ * Reads data from an SDL stream on behalf of the Vorbis decoder.
+ *
+ * @param ptr       The buffer to store the data
+ * @param size      The size of each element
+ * @param nmemb     The number of elements to read
+ * @param source    The SDL stream
+ *
+ * @return the number of elements read
+ */
+static size_t stream_read(void* ptr, size_t size, size_t nmemb, void* source) {
+    return SDL_RWread((SDL_RWops*)source, ptr, size, nmemb);
+}
+
+/**
+ * Seeks an SDL stream on behalf of the Vorbis decoder.
+ *
+ * @param source    The SDL stream
+ * @param offset    The seek offset in bytes
+ * @param whence    The seek origin
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int stream_seek(void* source, ogg_int64_t offset, int whence) {
+    return SDL_RWseek((SDL_RWops*)source, offset, whence) < 0 ? -1 : 0;
+}
+
+/**
+ * Closes an SDL stream on behalf of the Vorbis decoder.
+ *
+ * @param source    The SDL stream
+ *
+ * @return 0 on success
+ */
+static int stream_close(void* source) {
+    return SDL_RWclose((SDL_RWops*)source);
+}
+
+/**
+ * Returns the position of an SDL stream on behalf of the Vorbis decoder.
+ *
+ * @param source    The SDL stream
+ *
+ * @return the position of the stream in bytes
+ */
+static long stream_tell(void* source) {
+    return (long)SDL_RWtell((SDL_RWops*)source);
+}
+
+/**
+ * Opens the given file with the Vorbis decoder.
+ *
+ * If this function fails, the decoder state is left unopened and does not
+ * need to be cleared.
+ *
+ * @param file      The path to the Ogg Vorbis file
+ * @param vorbis    The decoder state to initialize
+ *
+ * @return true if the file was opened successfully
+ */
+static bool stream_open(const std::string& file, OggVorbis_File* vorbis) {
+    SDL_RWops* source = SDL_RWFromFile(file.c_str(), "rb");
+    if (source == nullptr) {
+        CULogError("Unable to open stream %s: %s", file.c_str(), SDL_GetError());
+        return false;
+    }
+
+    ov_callbacks callbacks;
+    callbacks.read_func  = stream_read;
+    callbacks.seek_func  = stream_seek;
+    callbacks.close_func = stream_close;
+    callbacks.tell_func  = stream_tell;
+    if (ov_open_callbacks(source, vorbis, nullptr, 0, callbacks) < 0) {
+        // The decoder does not close the source on failure
+        CULogError("File %s is not an Ogg Vorbis stream", file.c_str());
+        SDL_RWclose(source);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the smallest power of two that is at least value.
+ *
+ * @param value The value to round up
+ *
+ * @return the smallest power of two that is at least value.
+ */
+static Uint64 next_pow2(Uint64 value) {
+    Uint64 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Audio Stream Decoder
+/**
+ * Creates a degenerate stream decoder.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioStreamDecoder::AudioStreamDecoder() :
+_worker(nullptr),
+_running(false) {
+}
+
+/**
+ * Initializes the stream decoder, starting its worker thread.
+ *
+ * @return true if the decoder was initialized successfully
+ */
+bool AudioStreamDecoder::init() {
+    if (_worker != nullptr) {
+        CUAssertLog(false, "Decoder is already initialized");
+        return false;
+    }
+    _running = true;
+    _worker = new std::thread([this]() { this->run(); });
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this decoder.
+ *
+ * This method stops the worker thread.  Any streamers still attached are
+ * no longer decoded.  A disposed decoder can be safely reinitialized.
+ */
+void AudioStreamDecoder::dispose() {
+    if (_worker != nullptr) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _ready.notify_all();
+        _worker->join();
+        delete _worker;
+        _worker = nullptr;
+    }
+}
+
+/**
+ * Attaches a streamer to this decoder.
+ *
+ * @param stream    The streamer to decode
+ */
+void AudioStreamDecoder::attach(AudioStreamer* stream) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _streams.push_back(stream);
+    }
+    _ready.notify_one();
+}
+
+/**
+ * Detaches a streamer from this decoder.
+ *
+ * When this method returns, the worker thread is guaranteed to no longer
+ * access the streamer.
+ *
+ * @param stream    The streamer to detach
+ */
+void AudioStreamDecoder::detach(AudioStreamer* stream) {
+    // The worker holds the lock while it decodes
+    std::lock_guard<std::mutex> lock(_mutex);
+    _streams.erase(std::remove(_streams.begin(), _streams.end(), stream), _streams.end());
+}
+
+/**
+ * Runs the worker thread until the decoder is disposed.
+ */
+void AudioStreamDecoder::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        // Visit every stream in turn so that none of them starves
+        bool busy = false;
+        for(auto it = _streams.begin(); it != _streams.end(); ++it) {
+            busy = (*it)->decode() || busy;
+        }
+        if (!busy) {
+            _ready.wait_for(lock, std::chrono::milliseconds(AUDIO_STREAM_SLEEP));
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a degenerate audio streamer.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioStreamer::AudioStreamer() : AudioSource(),
+_start(0),
+_opened(false),
+_vorbis(nullptr),
+_ring(nullptr),
+_capacity(0),
+_head(0),
+_tail(0),
+_finish(-1),
+_eof(false),
+_target(0),
+_requests(0),
+_sought(0),
+_served(0),
+_markHead(0),
+_markFrame(0),
+_markRequest(0),
+_markSerial(0),
+_markAck(0),
+_underruns(0) {
+}
+
+/**
+ * Initializes a streamer for the given Ogg Vorbis file.
+ *
+ * The format of the file should come from {@link #query}, and the prefix
+ * from {@link #preload}.  The prefix is copied into the ring buffer, and
+ * the streamer is attached to the decoder, which opens the file and
+ * resumes decoding after the prefix.  This method does not access the
+ * file.  If file is a relative path, it is relative to the working
+ * directory (as with SDL_RWFromFile).
+ *
+ * @param decoder   The decoder to service this streamer
+ * @param file      The path to the Ogg Vorbis file
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ * @param frames    The length of the file in frames
+ * @param prefix    The interleaved audio at the start of the file
+ *
+ * @return true if the streamer was initialized successfully
+ */
+bool AudioStreamer::init(const std::shared_ptr<AudioStreamDecoder>& decoder, const std::string& file,
+                         Uint32 channels, Uint32 sampling, Uint64 frames, const std::vector<float>& prefix) {
+    if (_ring != nullptr) {
+        CUAssertLog(false, "Streamer is already initialized");
+        return false;
+    } else if (decoder == nullptr) {
+        CUAssertLog(false, "Streamer requires a decoder");
+        return false;
+    } else if (!AudioNode::init(channels,sampling)) {
+        return false;
+    }
+
+    _decoder = decoder;
+    _file = file;
+    _length = frames;
+    _start  = std::min((Uint64)(prefix.size()/_channels), frames);
+
+    _capacity = next_pow2(std::max(_start, (Uint64)AUDIO_STREAM_CHUNK)*2);
+    _ring = new float[(size_t)_capacity*_channels];
+    std::memset(_ring, 0, (size_t)_capacity*_channels*sizeof(float));
+    std::memcpy(_ring, prefix.data(), (size_t)_start*_channels*sizeof(float));
+    _head.store(_start);
+
+    _decoder->attach(this);
+    return true;
+}
+
+/**
+ * Disposes all of the resources used by this streamer.
+ *
+ * This method detaches the streamer from its decoder.  A disposed
+ * streamer can be safely reinitialized.
+ */
+void AudioStreamer::dispose() {
+    if (_decoder != nullptr) {
+        _decoder->detach(this);
+        _decoder = nullptr;
+    }
+    if (_ring != nullptr) {
+        delete[] _ring;
+        _ring = nullptr;
+    }
+    if (_vorbis != nullptr) {
+        ov_clear(_vorbis);
+        delete _vorbis;
+        _vorbis = nullptr;
+    }
+    _file.clear();
+    _start = 0;
+    _opened = false;
+    _capacity = 0;
+    _head.store(0);
+    _tail.store(0);
+    _finish.store(-1);
+    _eof = false;
+    _target.store(0);
+    _requests.store(0);
+    _sought = 0;
+    _served.store(0);
+    _markHead  = 0;
+    _markFrame = 0;
+    _markRequest = 0;
+    _markSerial.store(0);
+    _markAck.store(0);
+    _underruns.store(0);
+    AudioSource::dispose();
+}
+
+/**
+ * Returns true if the file is a streamable Ogg Vorbis file.
+ *
+ * If successful, this method stores the format of the file in the given
+ * parameters.  It does not decode any audio.
+ *
+ * @param file      The path to the Ogg Vorbis file
+ * @param channels  The number of audio channels
+ * @param sampling  The sample rate in HZ
+ * @param frames    The length of the file in frames
+ *
+ * @return true if the file is a streamable Ogg Vorbis file.
+ */
+bool AudioStreamer::query(const std::string& file, Uint32& channels, Uint32& sampling, Uint64& frames) {
+    OggVorbis_File vorbis;
+    if (!stream_open(file, &vorbis)) {
+        return false;
+    }
+
+    vorbis_info* info = ov_info(&vorbis, -1);
+    ogg_int64_t total = ov_pcm_total(&vorbis, -1);
+    bool result = info != nullptr && ov_seekable(&vorbis) && total > 0;
+    if (result) {
+        channels = (Uint32)info->channels;
+        sampling = (Uint32)info->rate;
+        frames = (Uint64)total;
+    }
+    ov_clear(&vorbis);
+    return result;
+}
+
+/**
+ * Returns true if the start of the file was decoded successfully.
+ *
+ * This method decodes up to the given number of frames from the start
+ * of the file, storing them interleaved in prefix.  It is the prebuffer
+ * of any streamer for this file, and should be decoded once, when the
+ * sound is loaded.
+ *
+ * @param file      The path to the Ogg Vorbis file
+ * @param frames    The number of frames to decode
+ * @param prefix    The vector to store the audio
+ *
+ * @return true if the start of the file was decoded successfully.
+ */
+bool AudioStreamer::preload(const std::string& file, Uint32 frames, std::vector<float>& prefix) {
+    OggVorbis_File vorbis;
+    if (!stream_open(file, &vorbis)) {
+        return false;
+    }
+
+    int channels = ov_info(&vorbis, -1)->channels;
+    prefix.clear();
+    prefix.reserve((size_t)frames*channels);
+
+    bool result = true;
+    Uint32 total = 0;
+    while (result && total < frames) {
+        float** pcm = nullptr;
+        int section = 0;
+        int amt = (int)std::min(frames-total, (Uint32)AUDIO_STREAM_CHUNK);
+        long read = ov_read_float(&vorbis, &pcm, amt, &section);
+        if (read == OV_HOLE) {
+            continue;
+        } else if (read == 0) {
+            break;
+        } else if (read < 0 || ov_info(&vorbis, -1)->channels != channels) {
+            CULogError("Unable to decode the start of stream %s", file.c_str());
+            result = false;
+        } else {
+            for(long ii = 0; ii < read; ii++) {
+                for(int ch = 0; ch < channels; ch++) {
+                    prefix.push_back(pcm[ch][ii]);
+                }
+            }
+            total += (Uint32)read;
+        }
+    }
+    ov_clear(&vorbis);
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Playback Control
+/**
+ * Returns the current playback position in frames.
+ *
+ * If there is a seek in progress, this is the seek target.
+ *
+ * @return the current playback position in frames.
+ */
+Uint64 AudioStreamer::getPosition() const {
+    if (_requests.load() != _served.load()) {
+        return _target.load();
+    }
+    return _offset.load();
+}
+
+/**
+ * Sets the current playback position in frames.
+ *
+ * The seek is performed by the worker thread.  The streamer is silent
+ * until the decoder has caught up with the new position.
+ *
+ * @param frame The playback position in frames
+ */
+void AudioStreamer::setPosition(Uint64 frame) {
+    _target.store(std::min(frame,_length));
+    _requests.fetch_add(1,std::memory_order_release);
+    _decoder->wake();
+}
+
+/**
+ * Produces up to the given number of frames in the buffer.
+ *
+ * @param buffer    The buffer to store the audio
+ * @param frames    The number of frames to produce
+ *
+ * @return the number of frames actually produced
+ */
+Uint32 AudioStreamer::fill(float* buffer, Uint32 frames) {
+    if (_done.load() || _ring == nullptr) {
+        return 0;
+    }
+
+    // Adopt the most recent seek published by the decoder
+    Uint32 serial = _markSerial.load(std::memory_order_acquire);
+    if (serial != _markAck.load(std::memory_order_relaxed)) {
+        _tail.store(_markHead, std::memory_order_release);
+        _offset.store(_markFrame);
+        _served.store(_markRequest);
+        _markAck.store(serial, std::memory_order_release);
+        _decoder->wake();
+    }
+
+    // Stay silent until the decoder has caught up with a seek
+    if (_requests.load(std::memory_order_acquire) != _served.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    // The finish must be read before the head
+    Sint64 finish = _finish.load(std::memory_order_acquire);
+    Uint64 head = _head.load(std::memory_order_acquire);
+    Uint64 tail = _tail.load(std::memory_order_relaxed);
+    Sint64 expire = _expire.load();
+
+    Uint64 take = std::min((Uint64)frames, head-tail);
+    if (expire >= 0) {
+        take = std::min(take, (Uint64)expire);
+    }
+
+    // Copy the ring in at most two segments
+    Uint64 mask = _capacity-1;
+    Uint64 start = tail & mask;
+    Uint64 first = std::min(take, _capacity-start);
+    std::memcpy(buffer, _ring+start*_channels, (size_t)(first*_channels)*sizeof(float));
+    if (first < take) {
+        std::memcpy(buffer+first*_channels, _ring, (size_t)((take-first)*_channels)*sizeof(float));
+    }
+    tail += take;
+    _tail.store(tail, std::memory_order_release);
+
+    Uint64 offset = _offset.load()+take;
+    if (_length && offset >= _length) {
+        offset %= _length;
+    }
+    _offset.store(offset);
+
+    bool done = false;
+    if (expire >= 0) {
+        // Only consume the expiration if it was not changed in the meantime
+        _expire.compare_exchange_strong(expire, expire-(Sint64)take);
+        done = (take == (Uint64)expire);
+    }
+    if (finish >= 0 && tail == (Uint64)finish) {
+        done = true;
+    } else if (!done && take < frames) {
+        _underruns.fetch_add(1,std::memory_order_relaxed);
+    }
+
+    // Wake the decoder without blocking on its lock
+    _decoder->wake();
+    if (done) {
+        _done.store(true);
+        if (_listener) {
+            _listener(this);
+        }
+    }
+    return (Uint32)take;
+}
+
+
+#pragma mark -
+#pragma mark Decoding
+/**
+ * Performs a single unit of work for the decoder.
+ *
+ * This is either a pending seek, or the decoding of a chunk of audio into
+ * the ring buffer.  It returns false if there was no work to do.
+ *
+ * @return true if the decoder performed any work
+ */
+bool AudioStreamer::decode() {
+    // The file is opened here so that playback never waits on it
+    if (!_opened) {
+        _opened = true;
+        OggVorbis_File* vorbis = new OggVorbis_File();
+        if (stream_open(_file, vorbis)) {
+            _vorbis = vorbis;
+            if (_start > 0 && ov_pcm_seek(_vorbis, (ogg_int64_t)_start) < 0) {
+                CULogError("Unable to resume stream %s after the prebuffer", _file.c_str());
+                _eof = true;
+                _finish.store((Sint64)_head.load(std::memory_order_relaxed), std::memory_order_release);
+            }
+        } else {
+            delete vorbis;
+            _eof = true;
+            _finish.store((Sint64)_head.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        return true;
+    }
+
+    // A seek waits until the audio thread has adopted the previous one
+    Uint32 request = _requests.load(std::memory_order_acquire);
+    if (request != _sought) {
+        if (_markAck.load(std::memory_order_acquire) != _markSerial.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        Uint64 target = _target.load();
+        _sought = request;
+        if (_vorbis == nullptr || ov_pcm_seek(_vorbis, (ogg_int64_t)target) < 0) {
+            CULogError("Unable to seek stream to frame %llu", (unsigned long long)target);
+        }
+        _eof = false;
+        _finish.store(-1, std::memory_order_relaxed);
+        _markHead  = _head.load(std::memory_order_relaxed);
+        _markFrame = target;
+        _markRequest = request;
+        _markSerial.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    if (_eof) {
+        return false;
+    } else if (_vorbis == nullptr) {
+        // The file could not be opened, so there is nothing left to decode
+        _eof = true;
+        _finish.store((Sint64)_head.load(std::memory_order_relaxed), std::memory_order_release);
+        return true;
+    }
+
+    Uint64 head = _head.load(std::memory_order_relaxed);
+    Uint64 space = _capacity-(head-_tail.load(std::memory_order_acquire));
+    if (space < AUDIO_STREAM_CHUNK) {
+        return false;
+    }
+
+    float** pcm = nullptr;
+    int section = 0;
+    long amt = ov_read_float(_vorbis, &pcm, AUDIO_STREAM_CHUNK, &section);
+    if (amt == OV_HOLE) {
+        // Recoverable gap in the data
+        return true;
+    } else if (amt > 0 && ov_info(_vorbis, -1)->channels != (int)_channels) {
+        CULogError("Stream changed channel layout mid-file");
+        amt = OV_EBADLINK;
+    }
+
+    if (amt > 0) {
+        Uint64 mask = _capacity-1;
+        for(long ii = 0; ii < amt; ii++) {
+            float* output = _ring+((head+ii) & mask)*_channels;
+            for(Uint32 ch = 0; ch < _channels; ch++) {
+                output[ch] = pcm[ch][ii];
+            }
+        }
+        _head.store(head+amt, std::memory_order_release);
+    } else if (amt == 0 && _length && _loop.load(std::memory_order_relaxed)) {
+        // Seamless loop; the audio thread wraps its own position
+        if (ov_pcm_seek(_vorbis, 0) < 0) {
+            CULogError("Unable to loop stream");
+            _eof = true;
+            _finish.store((Sint64)head, std::memory_order_release);
+        }
+    } else {
+        if (amt < 0) {
+            CULogError("Stream decoding failed with error %ld", amt);
+        }
+        _eof = true;
+        _finish.store((Sint64)head, std::memory_order_release);
+    }
+    return true;
+}
+
+#endif /* CU_AUDIO_STREAMING */
@@ -61,6 +61,8 @@ using namespace cugl;
  */
 void Sound::dispose() {
     _source.clear();
+    _streamed = false;
+    _compressed = false;
     if (_buffer) {
         cugl::impl::AudioFreeBuffer(_buffer);
         _buffer = nullptr;
@@ -72,16 +74,46 @@ void Sound::dispose() {
  *
  * The sound will be decompressed into PCM (e.g. WAV data) which is
  * possibly large. This will be stored in a platform specific buffer.
+ * If stream is true, the sound is instead decoded incrementally on
+ * playback, with the given number of frames decoded up front.
  *
- * @param  source   the source file for the sound
+ * @param  source       the source file for the sound
+ * @param  stream       whether to stream the sound from its file
+ * @param  prebuffer    the number of frames to decode before playback
  *
  * @return true if the sound was initialized successfully
  */
-bool Sound::init(const std::string& source) {
+bool Sound::init(const std::string& source, bool stream, Uint32 prebuffer) {
     CUAssertLog(AudioEngine::get(), "AudioEngine must be initialized before loading sound assets");
 
     _source = source;
-    _buffer = cugl::impl::AudioLoadBuffer(source.c_str());
+    _streamed = stream;
+    if (stream) {
+        _buffer = cugl::impl::AudioOpenBuffer(source.c_str(), prebuffer);
+    } else {
+        _buffer = cugl::impl::AudioLoadBuffer(source.c_str());
+    }
+    return (bool)_buffer;
+}
+
+/**
+ * Initializes a new compressed sound asset for the given source file.
+ *
+ * The encoded file is kept in memory, and is only decompressed into PCM
+ * when it is played.  The decompressed data is cached by the audio engine
+ * (see {@link AudioEngine#setCacheBudget}).  This is best for short sound
+ * effects that are played infrequently.
+ *
+ * @param  source   the source file for the sound
+ *
+ * @return true if the sound was initialized successfully
+ */
+bool Sound::initCompressed(const std::string& source) {
+    CUAssertLog(AudioEngine::get(), "AudioEngine must be initialized before loading sound assets");
+    
+    _source = source;
+    _compressed = true;
+    _buffer = cugl::impl::AudioLoadCompressed(source.c_str());
     return (bool)_buffer;
 }
 
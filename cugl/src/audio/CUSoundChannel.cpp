@@ -71,11 +71,15 @@ _channel(-1),
 _player(nullptr),
 _playing(false),
 _paused(false),
+_primaryHandle(0),
 _primaryLoop(false),
 _primaryVolume(0.0f),
+_primaryRate(1.0f),
 _primaryTime(0),
+_shadowHandle(0),
 _shadowLoop(false),
 _shadowVolume(0.0f),
+_shadowRate(1.0f),
 _shadowTime(0),
 _selfdelete(false) {
 }
@@ -139,30 +143,32 @@ void SoundChannel::dispose() {
  * become the primary one.  If it already has an asset, it will become the
  * shadow asset.  Otherwise, it will raise an error.
  *
- * The channels keeps track of the key for asset management.  This is
+ * The channels keeps track of the handle for asset management.  This is
  * used by the {@link AudioEngine} for garbage collection.
  *
- * @param  key      the key for this playback instance
+ * @param  handle   the engine handle for this playback instance
  * @param  asset    the sound asset to play
  * @param  volume   the volume ot play the sound
  * @param  loop     whether to loop the sound indefinitely
  */
-void SoundChannel::attach(const std::string& key, const std::shared_ptr<Sound>& asset, float volume, bool loop) {
+void SoundChannel::attach(Uint32 handle, const std::shared_ptr<Sound>& asset, float volume, bool loop) {
     CUAssertLog(_primary == nullptr || _shadow == nullptr, "Attaching to an occupied audio channel");
     
     if (_primary == nullptr) {
         _playing = false;
         _paused  = false;
         _primary = asset;
-        _primaryKey = key;
+        _primaryHandle = handle;
         _primaryLoop = loop;
         _primaryVolume = volume;
+        _primaryRate = 1.0f;
         _primaryTime = 0;
     } else {
         _shadow = asset;
-        _shadowKey = key;
+        _shadowHandle = handle;
         _shadowLoop = loop;
         _shadowVolume = volume;
+        _shadowRate = 1.0f;
         _shadowTime = 0;
     }
     
@@ -182,15 +188,17 @@ void SoundChannel::advance() {
         _playing = false;
         _paused  = false;
         _primary = _shadow;
-        _primaryKey = _shadowKey;
+        _primaryHandle = _shadowHandle;
         _primaryLoop   = _shadowLoop;
         _primaryVolume = _shadowVolume;
+        _primaryRate   = _shadowRate;
         _primaryTime   = _shadowTime;
         
         _shadow = nullptr;
-        _shadowKey = "";
+        _shadowHandle = 0;
         _shadowLoop = false;
         _shadowVolume = 0.0;
+        _shadowRate = 1.0f;
         _shadowTime = 0;
         
         play();
@@ -212,18 +220,34 @@ void SoundChannel::clear() {
     _playing = false;
     _paused  = false;
     _primary = nullptr;
-    _primaryKey = "";
+    _primaryHandle = 0;
     _primaryLoop = false;
     _primaryVolume = 0.0;
+    _primaryRate = 1.0f;
     _primaryTime = 0;
     
     _shadow = nullptr;
-    _shadowKey = "";
+    _shadowHandle = 0;
     _shadowLoop = false;
     _shadowVolume = 0.0;
+    _shadowRate = 1.0f;
     _shadowTime = 0;
 }
 
+/**
+ * Clears the shadow asset, leaving the primary asset untouched.
+ *
+ * This is used to cancel a shadow asset before it is swapped in by
+ * {@link advance}.  If there is no shadow asset, this method does nothing.
+ */
+void SoundChannel::clearShadow() {
+    _shadow = nullptr;
+    _shadowHandle = 0;
+    _shadowLoop = false;
+    _shadowVolume = 0.0;
+    _shadowRate = 1.0f;
+    _shadowTime = 0;
+}
 
 
 #pragma mark -
@@ -242,6 +266,7 @@ void SoundChannel::play() {
     
     _playing = true;
     impl::AudioSetChannelVolume(_player,_primaryVolume);
+    impl::AudioSetChannelRate(_player,_primaryRate);
     impl::AudioPlayChannel(_player,_primary->_buffer,_primaryLoop,(Uint32)_primaryTime);
 }
 
@@ -413,20 +438,52 @@ void SoundChannel::setCurrentTime(float time, bool force) {
 void SoundChannel::setVolume(float volume) {
     CUAssertLog(_primary != nullptr, "Attempt to volume with no primary asset");
     CUAssertLog(volume >=0 && volume <= 1, "The volume %.3f is out of range",volume);
+    if (_shadow != nullptr) {
+        _shadowVolume = volume;
+        return;
+    }
     _primaryVolume = volume;
     impl::AudioSetChannelVolume(_player,volume);
 }
 
 /**
- * Returns the volume (0 to 1) of the asset being played.
+ * Sets the playback rate of the asset being played.
+ *
+ * A rate of 1 plays the asset at its natural speed and pitch.  Higher
+ * rates play faster (and higher), while lower rates play slower.
+ *
+ * If there is a shadow asset present, this method will apply to the shadow
+ * asset instead.
+ *
+ * @param  rate     the playback rate of the asset being played.
+ */
+void SoundChannel::setRate(float rate) {
+    CUAssertLog(_primary != nullptr, "Attempt to set rate with no primary asset");
+    CUAssertLog(rate > 0, "The rate %.3f is out of range",rate);
+    if (_shadow != nullptr) {
+        _shadowRate = rate;
+        return;
+    }
+    _primaryRate = rate;
+    impl::AudioSetChannelRate(_player,rate);
+}
+
+/**
+ * Sets whether the current sound should play in an indefinite loop.
+ *
+ * If loop is false, then the sound will stop at its natural loop point.
  *
  * If there is a shadow asset present, this method will apply to the shadow
  * asset instead.
  *
- * @return the volume (0 to 1) of the asset being played.
+ * @param  loop whether the current sound should play in an indefinite loop
  */
 void SoundChannel::setLoop(bool loop) {
     CUAssertLog(_primary != nullptr, "Attempt to loop with no primary asset");
+    if (_shadow != nullptr) {
+        _shadowLoop = loop;
+        return;
+    }
     _primaryLoop = loop;
     impl::AudioSetChannelLoop(_player,loop);
 }
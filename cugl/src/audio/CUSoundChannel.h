@@ -111,12 +111,14 @@ private:
     
     /** The primary asset currently attached to this player for use */
     std::shared_ptr<Sound> _primary;
-    /** The key associated with the primary asset */
-    std::string _primaryKey;
+    /** The engine handle associated with the primary asset */
+    Uint32 _primaryHandle;
     /** Whether to loop the primary asset */
     bool  _primaryLoop;
     /** The volume for the primary asset */
     float _primaryVolume;
+    /** The playback rate for the primary asset */
+    float _primaryRate;
     /** The sample frame (in the audio file) to resume the sound after a pause */
     Uint64 _primaryTime;
     /** The sample frame (in the audio file) at which the sound was paused */
@@ -124,12 +126,14 @@ private:
     
     /** A queued asset to play immediately once the current one is detached */
     std::shared_ptr<Sound> _shadow;
-    /** The key associated with the shadow asset */
-    std::string _shadowKey;
+    /** The engine handle associated with the shadow asset */
+    Uint32 _shadowHandle;
     /** Whether to loop the shadow asset */
     bool  _shadowLoop;
     /** The volume for the shadow asset */
     float _shadowVolume;
+    /** The playback rate for the shadow asset */
+    float _shadowRate;
     /** The sample frame (in the audio file) to resume the sound after a pause */
     Uint64 _shadowTime;
     
@@ -209,38 +213,15 @@ public:
      * become the primary one.  If it already has an asset, it will become the
      * shadow asset.  Otherwise, it will raise an error.
      *
-     * The channels keeps track of the key for asset management.  This is
+     * The channels keeps track of the handle for asset management.  This is
      * used by the {@link AudioEngine} for garbage collection.
      *
-     * @param  key      the key for this playback instance
+     * @param  handle   the engine handle for this playback instance
      * @param  asset    the sound asset to play
      * @param  volume   the volume ot play the sound
      * @param  loop     whether to loop the sound indefinitely
      */
-    void attach(const std::string& key, const std::shared_ptr<Sound>& asset, float volume=1.0, bool loop=false);
-    
-    /**
-     * Attaches an asset and readies it with the given volume and loop setting.
-     *
-     * A channel may have at most two assets attached: the primary and the
-     * shadow asset.  The primary asset may be played immediately.  The shadow
-     * asset cannot be played until the {@link advance} method is called.
-     *
-     * If this channel has no attached assets, then the attached asset will
-     * become the primary one.  If it already has an asset, it will become the
-     * shadow asset.  Otherwise, it will raise an error.
-     *
-     * The channels keeps track of the key for asset management.  This is
-     * used by the {@link AudioEngine} for garbage collection.
-     *
-     * @param  key      the key for this playback instance
-     * @param  asset    the sound asset to play
-     * @param  volume   the volume ot play the sound
-     * @param  loop     whether to loop the sound indefinitely
-     */
-    void attach(const char* key, const std::shared_ptr<Sound>& asset, float volume=1.0, bool loop=false) {
-        attach(std::string(key),asset,volume,loop);
-    }
+    void attach(Uint32 handle, const std::shared_ptr<Sound>& asset, float volume=1.0, bool loop=false);
     
     /**
      * Swaps in the shadow asset, provided that there is one.
@@ -257,6 +238,14 @@ public:
      */
     void clear();
     
+    /**
+     * Clears the shadow asset, leaving the primary asset untouched.
+     *
+     * This is used to cancel a shadow asset before it is swapped in by
+     * {@link advance}.  If there is no shadow asset, this method does nothing.
+     */
+    void clearShadow();
+    
     /**
      * Returns the number (0, 1, or 2) of assets attached to this channel
      *
@@ -270,11 +259,11 @@ public:
     }
     
     /**
-     * Returns the key identifier for the primary asset
+     * Returns the engine handle for the primary asset
      *
-     * @return the key identifier for the primary asset
+     * @return the engine handle for the primary asset
      */
-    const std::string& getPrimaryKey() const { return _primaryKey; }
+    Uint32 getPrimaryHandle() const { return _primaryHandle; }
     
     /**
      * Returns a reference to the primary asset
@@ -291,11 +280,11 @@ public:
     std::shared_ptr<Sound> getPrimary() { return _primary; }
     
     /**
-     * Returns the key identifier for the shadow asset
+     * Returns the engine handle for the shadow asset
      *
-     * @return the key identifier for the shadow asset
+     * @return the engine handle for the shadow asset
      */
-    const std::string& getShadowKey() const { return _shadowKey; }
+    Uint32 getShadowHandle() const { return _shadowHandle; }
     
     /**
      * Returns a reference to the shadow asset
@@ -454,6 +443,32 @@ public:
      */
     void setVolume(float volume);
     
+    /**
+     * Returns the playback rate of the asset being played.
+     *
+     * A rate of 1 plays the asset at its natural speed and pitch.  Higher
+     * rates play faster (and higher), while lower rates play slower.
+     *
+     * If there is a shadow asset present, this method will apply to the shadow
+     * asset instead.
+     *
+     * @return the playback rate of the asset being played.
+     */
+    float getRate() const { return (_shadow == nullptr ? _primaryRate : _shadowRate); }
+    
+    /**
+     * Sets the playback rate of the asset being played.
+     *
+     * A rate of 1 plays the asset at its natural speed and pitch.  Higher
+     * rates play faster (and higher), while lower rates play slower.
+     *
+     * If there is a shadow asset present, this method will apply to the shadow
+     * asset instead.
+     *
+     * @param  rate     the playback rate of the asset being played.
+     */
+    void setRate(float rate);
+    
     /**
      * Returns true if the current sound is in an indefinite loop.
      *
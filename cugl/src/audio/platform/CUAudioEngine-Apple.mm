@@ -38,6 +38,7 @@
 #include <cugl/audio/CUMusic.h>
 #include <cugl/util/CUDebug.h>
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <mutex>
 
@@ -165,6 +166,7 @@ struct AudioMixer {
     AudioPlayer* background;
     std::vector<AudioChannel*> channels;
     std::shared_ptr<cugl::ThreadPool> processor;
+    size_t budget;
 };
     
 /** The pointer to the engine root */
@@ -278,11 +280,15 @@ void InternalClearBackground() {
  * only cross-platforms options are 1 (Mono) and 2 (Stereo). Cross-platform
  * 5.1 or 7.1 sound is not supported.
  *
+ * AVAudioEngine chooses its own buffer sizes, so the block size is ignored
+ * on this platform.
+ *
  * @param frequency The default sampling frequency
  * @param input     The number of sound effect channels
  * @param output    The number of output channels
+ * @param blocksize The number of audio frames in a mixer block
  */
-bool AudioStart(int frequency, int input, int output) {
+bool AudioStart(int frequency, int input, int output, int blocksize) {
     CUAssertLog(!_engine, "Audio engine has already been started");
     _engine = new AudioMixer();
     _engine->mixer = [[AVAudioEngine alloc] init];
@@ -326,6 +332,42 @@ void AudioStop() {
     }
 }
 
+/**
+ * Returns true if the mixer block size was changed successfully
+ *
+ * AVFoundation chooses its own I/O buffer size, so this function always
+ * returns false on this platform.
+ *
+ * @param blocksize The number of audio frames in a mixer block
+ *
+ * @return true if the mixer block size was changed successfully
+ */
+bool AudioSetBlockSize(int blocksize) {
+    CULogError("The block size cannot be changed on this platform");
+    return false;
+}
+
+#pragma mark -
+#pragma mark Diagnostics
+/**
+ * Stores a snapshot of the mixer performance counters in timings
+ *
+ * AVFoundation does the mixing itself, so the snapshot is all zeroes on
+ * this platform.
+ *
+ * @param timings   The snapshot to store
+ */
+void AudioQueryTimings(AudioTimings* timings) {
+    std::memset(timings, 0, sizeof(AudioTimings));
+}
+
+/**
+ * Resets the mixer performance counters
+ *
+ * There are no counters on this platform, so this function does nothing.
+ */
+void AudioResetTimings() {}
+
 
 #pragma mark -
 #pragma mark Sound Assets
@@ -462,6 +504,35 @@ AudioBuffer* AudioLoadBuffer(const char* file) {
     }
 }
 
+/**
+ * Returns a streaming buffer for the given audio asset
+ *
+ * AVFoundation does not support streaming sound effects, so this function is
+ * the same as {@link AudioLoadBuffer}.  The prebuffer is ignored.
+ *
+ * @param file      The path (absolute or relative) for the sound asset
+ * @param prebuffer The number of frames to decode before playback
+ *
+ * @return a streaming buffer for the given audio asset
+ */
+AudioBuffer* AudioOpenBuffer(const char* file, Uint32 prebuffer) {
+    return AudioLoadBuffer(file);
+}
+
+/**
+ * Returns a compressed buffer for the given audio asset
+ *
+ * AVFoundation does not support compressed sound effects, so this function
+ * is the same as {@link AudioLoadBuffer}.
+ *
+ * @param file  The path (absolute or relative) for the sound asset
+ *
+ * @return a compressed buffer for the given audio asset
+ */
+AudioBuffer* AudioLoadCompressed(const char* file) {
+    return AudioLoadBuffer(file);
+}
+
 /**
  * Frees the given PCM buffer, releasing all resources
  *
@@ -507,6 +578,60 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
     return source->pcmb.format.sampleRate;
 }
 
+/**
+ * Sets the byte budget for decoded compressed buffers
+ *
+ * AVFoundation does not support compressed sound effects, so this budget
+ * is recorded but never used.
+ *
+ * @param bytes The byte budget for decoded compressed buffers
+ */
+void AudioSetCacheBudget(size_t bytes) {
+    _engine->budget = bytes;
+}
+
+/**
+ * Returns the byte budget for decoded compressed buffers
+ *
+ * @return the byte budget for decoded compressed buffers
+ */
+size_t AudioGetCacheBudget() {
+    return _engine->budget;
+}
+
+/**
+ * Returns the number of bytes of decoded compressed buffers
+ *
+ * AVFoundation does not support compressed sound effects, so this is 0.
+ *
+ * @return the number of bytes of decoded compressed buffers
+ */
+size_t AudioGetCacheResident() {
+    return 0;
+}
+
+/**
+ * Returns the number of plays that found their compressed buffer decoded
+ *
+ * AVFoundation does not support compressed sound effects, so this is 0.
+ *
+ * @return the number of plays that found their compressed buffer decoded
+ */
+Uint64 AudioGetCacheHits() {
+    return 0;
+}
+
+/**
+ * Returns the number of plays that had to decode their compressed buffer
+ *
+ * AVFoundation does not support compressed sound effects, so this is 0.
+ *
+ * @return the number of plays that had to decode their compressed buffer
+ */
+Uint64 AudioGetCacheMisses() {
+    return 0;
+}
+
 #pragma mark -
 #pragma mark Music Assets
 /**
@@ -853,6 +978,19 @@ void AudioSetChannelVolume(AudioChannel* player, float volume) {
     player->node.volume = volume;
 }
 
+/**
+ * Sets the playback rate for this sound channel
+ *
+ * The AVFoundation engine does not support variable playback rates, so
+ * this function does nothing.  Assets always play at their natural rate.
+ *
+ * @param player    The sound channel
+ * @param rate      The playback rate
+ */
+void AudioSetChannelRate(AudioChannel* player, float rate) {
+    // Not supported
+}
+
 /**
  * Sets the loop option for this sound channel
  *
@@ -6,6 +6,18 @@
 //  works on all platforms.  However, it gives major deprecation errors for
 //  iOS and OS X, and is not safe to use on those platforms.
 //
+//  SDL Mixer opens the audio device, decodes the assets, and streams the
+//  music.  However, sound effects do not use the SDL Mixer channels.  They
+//  are mixed by a CUGL mixer graph (see AudioNode), which is run in the
+//  post-mix stage of the SDL audio callback.
+//
+//  The main thread never changes the shape of the mixer graph directly.
+//  Instead, it posts commands to a lock-free queue, which the audio thread
+//  drains at the start of each block.  Completions travel the other way in
+//  a second queue, which is drained on the main thread every frame.  Nodes
+//  removed from the graph are sent back in that queue as well, so that the
+//  audio thread never frees memory.
+//
 //  On Apple platforms, you can switch between solutions by defining/undefining
 //  the CU_AUDIO_AVFOUNDATION compiler variable.
 //
@@ -34,13 +46,28 @@
 #include "CUAudioEngine-impl.h"
 #include <cugl/audio/CUMusic.h>
 #include <cugl/audio/CUAudioEngine.h>
+#include <cugl/audio/CUAudioNode.h>
+#include <cugl/audio/CUAudioStreamer.h>
+#include <cugl/audio/CUAudioResampler.h>
+#include <cugl/audio/CUAudioQueue.h>
+#include <cugl/base/CUApplication.h>
 #include <cugl/util/CUDebug.h>
 #include <SDL/SDL_mixer.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <string>
 #include <vector>
+#include <list>
 
-/** The mixer block size */
-// SMALLER = LESS LAG, BUT MORE CPU LOAD
-#define MIX_BLOCK_SIZE  1024
+/** The capacity of the command queue from the main thread to the audio thread */
+#define AUDIO_COMMAND_CAPACITY  1024
+/** The capacity of the event queue from the audio thread to the main thread */
+#define AUDIO_EVENT_CAPACITY    2048
+/** The milliseconds to wait for room in a full command queue */
+#define AUDIO_COMMAND_TIMEOUT   100
 
 namespace cugl {
 namespace impl {
@@ -55,8 +82,22 @@ namespace impl {
  * allows us to unify SDL mixer with AVFoundation.
  */
 typedef struct AudioBuffer {
-    /** The SDL mixer representation of a PCM Buffer */
+    /** The SDL mixer representation of a PCM Buffer (or nullptr if streamed) */
     Mix_Chunk* chunk;
+    /** The file to stream from if there is no chunk */
+    std::string file;
+    /** The audio decoded before streaming playback (interleaved) */
+    std::vector<float> prefix;
+    /** The encoded file contents (or nullptr if not compressed) */
+    Uint8* encoded;
+    /** The size of the encoded file contents in bytes */
+    size_t encsize;
+    /** The number of channels playing this buffer */
+    Uint32 pins;
+    /** Whether this buffer was freed while still pinned */
+    bool freed;
+    /** The position of the decoded chunk in the cache (if resident) */
+    std::list<AudioBuffer*>::iterator entry;
     /** The data format (e.g. bytes) of a single audio frame */
     Uint16 format;
     /** The number of audio frames in the buffer */
@@ -80,9 +121,11 @@ typedef struct AudioStream {
 /**
  * Reference to the SDL implementation of a sound channel.
  *
- * As with sound assets, SDL mixer does not carry along the audio format info
- * for each sound channel.  Therefore, we have added that in addition to the
- * channel id.  This allows us to unify SDL mixer with AVFoundation.
+ * A sound channel is a panner in a slot of the effect bus.  Each time an
+ * asset is played, a new source is attached to the panner.  As completion
+ * is detected on the audio thread, but reported on the main thread, each
+ * play has a generation number.  A completion report is ignored if the
+ * channel has moved on to another generation.
  */
 typedef struct AudioChannel {
     /** The id for this player channel */
@@ -93,6 +136,22 @@ typedef struct AudioChannel {
     Uint32 channels;
     /** The audio sample rate in HZ */
     double bitrate;
+    /** The channel volume */
+    float volume;
+    /** The channel playback rate */
+    float rate;
+    /** The panner for this channel (in the effect bus) */
+    std::shared_ptr<cugl::AudioPanner> panner;
+    /** The source for the current asset */
+    std::shared_ptr<cugl::AudioSource> source;
+    /** The resampler between source and panner (if the rates differ) */
+    std::shared_ptr<cugl::AudioResampler> resampler;
+    /** The buffer pinned by the current source (if any) */
+    struct AudioBuffer* buffer;
+    /** The generation of the current source */
+    Uint32 generation;
+    /** Whether the completion of the current source has been reported */
+    bool reported;
     /** Whether or not this channel was terminated manually */
     bool manual;
 } AudioChannel;
@@ -107,6 +166,8 @@ typedef struct AudioChannel {
 typedef struct AudioPlayer {
     /** The currently attached music asset */
     Mix_Music* music;
+    /** The generation of the current music asset */
+    std::atomic<Uint32> generation;
     /** The SDL time stamp at which the music was paused */
     Uint32 pauseTick;
     /** The SDL time stamp at which the music was started */
@@ -117,15 +178,126 @@ typedef struct AudioPlayer {
     bool manual;
 } AudioPlayer;
 
+/**
+ * A change to the mixer graph, posted from the main thread
+ *
+ * The command attaches the node to the target, which is either a channel
+ * panner (if the slot is negative) or the effect bus (otherwise).  A null
+ * node detaches the current input of the target.
+ */
+typedef struct AudioCommand {
+    /** The panner or bus to modify */
+    std::shared_ptr<cugl::AudioNode> target;
+    /** The bus slot to modify (or -1 for a panner) */
+    Sint32 slot;
+    /** The node to attach (or nullptr to detach) */
+    std::shared_ptr<cugl::AudioNode> node;
+    /** The buffer to unpin once the command is applied (if any) */
+    AudioBuffer* buffer;
+} AudioCommand;
+
+/**
+ * The types of events posted from the audio thread
+ */
+enum class AudioEventType {
+    /** A sound effect source has completed */
+    SOURCE_DONE,
+    /** The background music has completed */
+    MUSIC_DONE,
+    /** Nodes have been removed from the mixer graph */
+    RETIRED
+};
+
+/**
+ * An event posted from the audio thread
+ *
+ * Retired nodes are carried in the event so that they are released on the
+ * main thread, and never deallocated by the audio thread.
+ */
+typedef struct AudioEvent {
+    /** The event type */
+    AudioEventType type;
+    /** The channel of a completed source */
+    Uint32 channel;
+    /** The generation of a completed source or music asset */
+    Uint32 generation;
+    /** The node removed from the mixer graph (if any) */
+    std::shared_ptr<cugl::AudioNode> node;
+    /** The panner or bus the node was removed from (if any) */
+    std::shared_ptr<cugl::AudioNode> target;
+    /** The buffer to unpin, as the audio thread no longer reads it (if any) */
+    AudioBuffer* buffer;
+} AudioEvent;
+
 /**
  * Reference to the SDL mixer audio engine
  *
- * This class stores the primitive audio "graph", tracking the players and
- * channels that have been allocated so far.
+ * This class stores the mixer graph for the sound effects, tracking the
+ * players and channels that have been allocated so far.
  */
 typedef struct AudioMixer {
+    /** The music player */
     AudioPlayer* background;
+    /** The sound effect channels */
     std::vector< AudioChannel * > channels;
+    /** The root of the mixer graph */
+    std::shared_ptr<cugl::AudioOutput> output;
+    /** The bus mixing the sound effect channels */
+    std::shared_ptr<cugl::AudioBus> effects;
+#if defined (CU_AUDIO_STREAMING)
+    /** The worker thread decoding every streaming sound */
+    std::shared_ptr<cugl::AudioStreamDecoder> decoder;
+#endif
+    /** The device format */
+    Uint16 format;
+    /** The decoded compressed buffers, most recently played first */
+    std::list<AudioBuffer*> cache;
+    /** The byte budget for decoded compressed buffers */
+    size_t budget;
+    /** The number of bytes of decoded compressed buffers */
+    size_t resident;
+    /** The number of plays that found their compressed buffer decoded */
+    Uint64 hits;
+    /** The number of plays that had to decode their compressed buffer */
+    Uint64 misses;
+    /** The mixer graph changes waiting for the audio thread */
+    cugl::AudioQueue<AudioCommand> commands;
+    /** The lock held by the thread applying the mixer graph changes */
+    std::mutex applying;
+    /** The events waiting for the main thread */
+    cugl::AudioQueue<AudioEvent> events;
+    /** The scheduled callback that drains the events */
+    Uint32 poller;
+    /** The main thread */
+    SDL_threadID thread;
+    /** The device sample rate */
+    int frequency;
+    /** The number of device channels */
+    int outputs;
+    /** The requested number of frames in a device block */
+    int blocksize;
+    /** The number of bytes in a device frame */
+    Uint32 framesize;
+    /** The number of microseconds in a performance counter tick */
+    double tickrate;
+    /** The number of callback passes since the last reset */
+    std::atomic<Uint64> blocks;
+    /** The number of passes that took longer than the block they mixed */
+    std::atomic<Uint64> underruns;
+    /** The fastest pass in nanoseconds */
+    std::atomic<Uint64> mintime;
+    /** The slowest pass in nanoseconds */
+    std::atomic<Uint64> maxtime;
+    /** The total time of all passes in nanoseconds */
+    std::atomic<Uint64> totaltime;
+    /** The smoothed fraction of the block duration spent mixing */
+    std::atomic<float> load;
+    /** The number of frames in the most recent pass */
+    std::atomic<Uint32> frames;
+    /** The histogram of pass times (see AudioTimings) */
+    std::atomic<Uint64> histogram[AUDIO_TIMING_BINS];
+    /** Whether the audio thread should clear the counters */
+    std::atomic<bool> reset;
 } AudioMixer;
 
 /** The pointer to the engine root */
@@ -136,25 +308,47 @@ static AudioMixer* _engine;
 #pragma mark Internal Helpers
 
 /**
- * The SDL_Mixer callback parent for sound effects.
+ * The completion handler for sound effects.
  *
- * We needed the SDL_Mixer callback as a regular C function as SDL does not
- * play well with C++ closures.
+ * This function calls the gcEffect() method in AudioEngine.  It must be
+ * called on the main thread.
+ *
+ * @param channel   The id of the completed sound channel
  */
 void InternalChannelDone(int channel) {
     if (cugl::AudioEngine::get()) {
         AudioChannel* player = _engine->channels[channel];
         bool manual = player->manual;
         player->manual = false;
+        player->reported = true;
         cugl::AudioEngine::get()->gcEffect(channel,!manual);
     }
 }
 
 /**
- * The SDL_Mixer callback parent for music.
+ * The listener for a completed sound effect source.
  *
- * We needed the SDL_Mixer callback as a regular C function as SDL does not
- * play well with C++ closures.
+ * This function is called on the audio thread.  It posts the completion to
+ * the main thread, where it is ignored if the channel has moved on to
+ * another source.  This function neither locks nor allocates.
+ *
+ * @param channel       The id of the sound channel
+ * @param generation    The generation of the completed source
+ */
+void InternalSourceDone(Uint32 channel, Uint32 generation) {
+    AudioEvent event;
+    event.type = AudioEventType::SOURCE_DONE;
+    event.channel = channel;
+    event.generation = generation;
+    event.buffer = nullptr;
+    _engine->events.push(std::move(event));
+}
+
+/**
+ * The completion handler for music.
+ *
+ * This function calls the gcMusic() method in AudioEngine.  It must be
+ * called on the main thread.
  */
 void InternalMusicFinished() {
     if (cugl::AudioEngine::get()) {
@@ -166,6 +360,505 @@ void InternalMusicFinished() {
     }
 }
 
+/**
+ * The SDL_Mixer callback parent for music.
+ *
+ * We needed the SDL_Mixer callback as a regular C function as SDL does not
+ * play well with C++ closures.  SDL_Mixer calls this function on the main
+ * thread when the music is halted, and on the audio thread when the music
+ * completes.  In the latter case, the completion is posted to the main thread.
+ */
+void InternalMusicHook() {
+    if (SDL_ThreadID() == _engine->thread) {
+        InternalMusicFinished();
+        return;
+    }
+    
+    AudioEvent event;
+    event.type = AudioEventType::MUSIC_DONE;
+    event.channel = 0;
+    event.generation = (_engine->background ? _engine->background->generation.load() : 0);
+    event.buffer = nullptr;
+    _engine->events.push(std::move(event));
+}
+
+/**
+ * Clears the mixer performance counters
+ *
+ * This function must be called on the audio thread, or when the audio
+ * device is closed.
+ */
+void InternalClearTimings() {
+    _engine->blocks.store(0, std::memory_order_relaxed);
+    _engine->underruns.store(0, std::memory_order_relaxed);
+    _engine->mintime.store(0, std::memory_order_relaxed);
+    _engine->maxtime.store(0, std::memory_order_relaxed);
+    _engine->totaltime.store(0, std::memory_order_relaxed);
+    _engine->load.store(0, std::memory_order_relaxed);
+    _engine->frames.store(0, std::memory_order_relaxed);
+    for(int ii = 0; ii < AUDIO_TIMING_BINS; ii++) {
+        _engine->histogram[ii].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Records a pass of the audio callback in the mixer performance counters
+ *
+ * This function is called on the audio thread, which is the only thread
+ * to write the counters.  A pass is an underrun if it takes longer than
+ * the duration of the block it mixed, as the device then has to wait on
+ * the callback.  This function neither locks nor allocates.
+ *
+ * @param frames    The number of frames mixed
+ * @param ticks     The performance counter ticks spent mixing
+ */
+void InternalRecordTiming(Uint32 frames, Uint64 ticks) {
+    if (_engine->reset.exchange(false)) {
+        InternalClearTimings();
+    }
+    
+    double micros = ticks*_engine->tickrate;
+    Uint64 nanos  = (Uint64)(micros*1000);
+    Uint64 blocks = _engine->blocks.load(std::memory_order_relaxed);
+    if (blocks == 0 || nanos < _engine->mintime.load(std::memory_order_relaxed)) {
+        _engine->mintime.store(nanos, std::memory_order_relaxed);
+    }
+    if (nanos > _engine->maxtime.load(std::memory_order_relaxed)) {
+        _engine->maxtime.store(nanos, std::memory_order_relaxed);
+    }
+    _engine->totaltime.fetch_add(nanos, std::memory_order_relaxed);
+    
+    double budget = frames*1000000.0/_engine->frequency;
+    if (micros > budget) {
+        _engine->underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    float ratio = (float)(budget > 0 ? micros/budget : 0);
+    float load  = _engine->load.load(std::memory_order_relaxed);
+    load = (blocks == 0 ? ratio : load+(ratio-load)/16.0f);
+    _engine->load.store(load, std::memory_order_relaxed);
+    _engine->frames.store(frames, std::memory_order_relaxed);
+    
+    int bin = (int)(AUDIO_TIMING_STEPS*std::log2(1.0+micros));
+    bin = std::min(std::max(bin,0),AUDIO_TIMING_BINS-1);
+    _engine->histogram[bin].fetch_add(1, std::memory_order_relaxed);
+    _engine->blocks.store(blocks+1, std::memory_order_release);
+}
+
+/**
+ * Returns the PCM chunk for the given WAV file, at its native sample rate
+ *
+ * Unlike Mix_LoadWAV_RW, this function only converts the sample format to
+ * that of the device.  Mono and stereo files keep their channel layout and
+ * all files keep their sample rate, as the mixer graph converts them on
+ * playback.  The layout and rate are stored in the given parameters.
+ *
+ * This function always closes the source.
+ *
+ * @param source    The WAV file
+ * @param format    The device format
+ * @param channels  The number of device channels (updated to the chunk)
+ * @param rate      The device sample rate (updated to the chunk)
+ *
+ * @return the PCM chunk for the given WAV file, at its native sample rate
+ */
+Mix_Chunk* InternalLoadNative(SDL_RWops* source, Uint16 format, int& channels, int& rate) {
+    SDL_AudioSpec spec;
+    Uint8* data = nullptr;
+    Uint32 size = 0;
+    if (!SDL_LoadWAV_RW(source, 1, &spec, &data, &size)) {
+        return nullptr;
+    }
+    
+    int chans = (spec.channels <= 2 ? spec.channels : channels);
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                          format, chans, spec.freq) < 0) {
+        SDL_FreeWAV(data);
+        return nullptr;
+    }
+    
+    cvt.len = (int)size;
+    cvt.buf = (Uint8*)SDL_malloc((size_t)size*cvt.len_mult);
+    Mix_Chunk* chunk = (Mix_Chunk*)SDL_malloc(sizeof(Mix_Chunk));
+    if (!cvt.buf || !chunk) {
+        SDL_free(cvt.buf);
+        SDL_free(chunk);
+        SDL_FreeWAV(data);
+        return nullptr;
+    }
+    std::memcpy(cvt.buf, data, size);
+    SDL_FreeWAV(data);
+    if (SDL_ConvertAudio(&cvt) < 0) {
+        SDL_free(cvt.buf);
+        SDL_free(chunk);
+        return nullptr;
+    }
+    
+    chunk->allocated = 1;
+    chunk->abuf = cvt.buf;
+    chunk->alen = (Uint32)cvt.len_cvt;
+    chunk->volume = MIX_MAX_VOLUME;
+    channels = chans;
+    rate = spec.freq;
+    return chunk;
+}
+
+/**
+ * Returns the PCM chunk for the given encoded source
+ *
+ * WAV files are loaded at their native sample rate (and, for mono and
+ * stereo, their native layout) by {@link InternalLoadNative}.  All other
+ * files are decoded by SDL mixer, which converts them to the device spec.
+ * The layout and rate of the chunk are stored in the given parameters.
+ *
+ * This function always closes the source.
+ *
+ * @param source    The encoded source
+ * @param channels  The number of channels in the chunk
+ * @param rate      The sample rate of the chunk
+ *
+ * @return the PCM chunk for the given encoded source
+ */
+Mix_Chunk* InternalLoadChunk(SDL_RWops* source, int& channels, int& rate) {
+    Uint16 format = 0;
+    if (!source || !Mix_QuerySpec(&rate, &format, &channels)) {
+        if (source) {
+            SDL_RWclose(source);
+        }
+        return nullptr;
+    }
+    
+    // Check the header, then rewind
+    char header[12];
+    bool wave = (SDL_RWread(source, header, 1, 12) == 12 &&
+                 !std::memcmp(header, "RIFF", 4) && !std::memcmp(header+8, "WAVE", 4));
+    SDL_RWseek(source, 0, RW_SEEK_SET);
+    if (wave) {
+        return InternalLoadNative(source, format, channels, rate);
+    }
+    return Mix_LoadWAV_RW(source, 1);
+}
+
+/**
+ * Returns the PCM chunk for the given encoded data
+ *
+ * The chunk is decoded as with {@link AudioLoadBuffer}, so WAV files keep
+ * their native sample rate.  This supports any format supported by SDL
+ * mixer, including ADPCM WAV files.
+ *
+ * @param data  The encoded data
+ * @param size  The size of the encoded data in bytes
+ *
+ * @return the PCM chunk for the given encoded data
+ */
+Mix_Chunk* InternalDecodeChunk(const Uint8* data, size_t size) {
+    int channels = 0;
+    int rate = 0;
+    return InternalLoadChunk(SDL_RWFromConstMem(data, (int)size), channels, rate);
+}
+
+/**
+ * Evicts least recently played compressed buffers until within budget
+ *
+ * Buffers that are pinned by a playing channel are never evicted, so the
+ * cache may temporarily exceed its budget.
+ */
+void InternalTrimCache() {
+    auto it = _engine->cache.end();
+    while (_engine->resident > _engine->budget && it != _engine->cache.begin()) {
+        --it;
+        AudioBuffer* buffer = *it;
+        if (buffer->pins == 0) {
+            _engine->resident -= buffer->chunk->alen;
+            Mix_FreeChunk(buffer->chunk);
+            buffer->chunk = nullptr;
+            it = _engine->cache.erase(it);
+        }
+    }
+}
+
+/**
+ * Ensures the compressed buffer is decoded, and marks it as most recent
+ *
+ * This function updates the cache statistics.  It returns false if the
+ * buffer could not be decoded.
+ *
+ * @param buffer    The compressed buffer
+ *
+ * @return true if the buffer is decoded
+ */
+bool InternalFetchCache(AudioBuffer* buffer) {
+    if (buffer->chunk) {
+        _engine->hits++;
+        _engine->cache.splice(_engine->cache.begin(), _engine->cache, buffer->entry);
+        return true;
+    }
+    
+    _engine->misses++;
+    buffer->chunk = InternalDecodeChunk(buffer->encoded, buffer->encsize);
+    if (!buffer->chunk) {
+        CULogError("Unable to decode compressed sound: %s", Mix_GetError());
+        return false;
+    }
+    _engine->resident += buffer->chunk->alen;
+    _engine->cache.push_front(buffer);
+    buffer->entry = _engine->cache.begin();
+    return true;
+}
+
+/**
+ * Deletes the given buffer, releasing all resources
+ *
+ * The buffer must not be pinned by any channel.
+ *
+ * @param source    The buffer to delete
+ */
+void InternalDeleteBuffer(AudioBuffer* source) {
+    if (source->encoded) {
+        if (_engine && source->chunk) {
+            _engine->resident -= source->chunk->alen;
+            _engine->cache.erase(source->entry);
+        }
+        SDL_free(source->encoded);
+        source->encoded = nullptr;
+    }
+    if (source->chunk) {
+        Mix_FreeChunk(source->chunk);
+        source->chunk = nullptr;
+    }
+    delete source;
+}
+
+/**
+ * Releases a pin on the given buffer
+ *
+ * This function is called on the main thread once the audio thread no
+ * longer reads the buffer.  If the buffer was freed while it was pinned,
+ * it is deleted now.  Otherwise, a compressed buffer becomes eligible for
+ * eviction from the cache.
+ *
+ * @param buffer    The buffer to unpin
+ */
+void InternalReleaseBuffer(AudioBuffer* buffer) {
+    buffer->pins--;
+    if (buffer->pins == 0 && buffer->freed) {
+        InternalDeleteBuffer(buffer);
+    } else if (buffer->encoded) {
+        InternalTrimCache();
+    }
+}
+
+/**
+ * Applies the pending mixer graph changes.
+ *
+ * This function is called on the audio thread at the start of each block.
+ * Each command may retire a node, and the event queue keeps room for one
+ * completion per channel.  Commands are left in the queue if there is not
+ * enough room for their events, until the main thread has drained them.
+ *
+ * The audio thread never blocks here.  If the main thread is applying the
+ * changes itself (see {@link InternalPostCommand}), the commands are left
+ * for the next block.
+ */
+void InternalApplyCommands() {
+    std::unique_lock<std::mutex> lock(_engine->applying, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    size_t reserve  = _engine->channels.size()+1;
+    size_t capacity = _engine->events.getCapacity();
+    AudioCommand command;
+    while (capacity-_engine->events.getSize() > reserve && _engine->commands.pop(command)) {
+        AudioEvent event;
+        event.type = AudioEventType::RETIRED;
+        if (command.slot < 0) {
+            cugl::AudioPanner* panner = (cugl::AudioPanner*)command.target.get();
+            event.node = panner->attach(command.node);
+        } else {
+            cugl::AudioBus* bus = (cugl::AudioBus*)command.target.get();
+            event.node = bus->attach(command.slot,command.node);
+        }
+        event.target = std::move(command.target);
+        event.buffer = command.buffer;
+        command.node = nullptr;
+        _engine->events.push(std::move(event));
+    }
+}
+
+/**
+ * Applies a mixer graph change on the main thread.
+ *
+ * The change is applied using the locks in the graph.  The node removed is
+ * released immediately, and the buffer (if any) is unpinned.
+ *
+ * @param target    The panner or bus to modify
+ * @param slot      The bus slot to modify (or -1 for a panner)
+ * @param node      The node to attach (or nullptr to detach)
+ * @param buffer    The buffer to unpin once the change is applied
+ */
+void InternalAttachNode(const std::shared_ptr<cugl::AudioNode>& target, Sint32 slot,
+                        const std::shared_ptr<cugl::AudioNode>& node, AudioBuffer* buffer) {
+    if (slot < 0) {
+        ((cugl::AudioPanner*)target.get())->attach(node);
+    } else {
+        ((cugl::AudioBus*)target.get())->attach(slot,node);
+    }
+    if (buffer) {
+        InternalReleaseBuffer(buffer);
+    }
+}
+
+/**
+ * Posts a mixer graph change to the audio thread.
+ *
+ * If the command queue is full, this function waits for the audio thread to
+ * drain it.  If the audio thread does not respond (because the device is
+ * paused), the change is applied immediately, using the locks in the graph.
+ * The commands still in the queue are applied first, so that the changes
+ * are never reordered.
+ *
+ * The buffer (if any) is unpinned once the change is applied, as the audio
+ * thread can no longer read the node that was removed.
+ *
+ * @param target    The panner or bus to modify
+ * @param slot      The bus slot to modify (or -1 for a panner)
+ * @param node      The node to attach (or nullptr to detach)
+ * @param buffer    The buffer to unpin once the change is applied
+ */
+void InternalPostCommand(const std::shared_ptr<cugl::AudioNode>& target, Sint32 slot,
+                         const std::shared_ptr<cugl::AudioNode>& node,
+                         AudioBuffer* buffer=nullptr) {
+    AudioCommand command;
+    command.target = target;
+    command.slot = slot;
+    command.node = node;
+    command.buffer = buffer;
+    Uint32 start = SDL_GetTicks();
+    while (!_engine->commands.push(std::move(command))) {
+        if (SDL_GetTicks()-start > AUDIO_COMMAND_TIMEOUT) {
+            CULogError("Audio command queue is full; applying changes directly");
+            std::lock_guard<std::mutex> lock(_engine->applying);
+            AudioCommand pending;
+            while (_engine->commands.pop(pending)) {
+                InternalAttachNode(pending.target, pending.slot, pending.node, pending.buffer);
+            }
+            InternalAttachNode(target, slot, node, buffer);
+            return;
+        }
+        SDL_Delay(1);
+    }
+}
+
+/**
+ * Handles the events posted by the audio thread.
+ *
+ * This function is called on the main thread every animation frame.  Stale
+ * completions (for a channel or music player that has moved on) are ignored.
+ * Retired nodes are released here.
+ */
+void InternalPollEvents() {
+    AudioEvent event;
+    while (_engine && _engine->events.pop(event)) {
+        switch (event.type) {
+            case AudioEventType::SOURCE_DONE:
+                if (_engine->channels[event.channel] &&
+                    _engine->channels[event.channel]->generation == event.generation) {
+                    InternalChannelDone(event.channel);
+                }
+                break;
+            case AudioEventType::MUSIC_DONE:
+                if (_engine->background && _engine->background->music &&
+                    _engine->background->generation.load() == event.generation) {
+                    InternalMusicFinished();
+                }
+                break;
+            case AudioEventType::RETIRED:
+                if (event.buffer) {
+                    InternalReleaseBuffer(event.buffer);
+                }
+                break;
+        }
+        event.node = nullptr;
+        event.target = nullptr;
+    }
+}
+
+/**
+ * The SDL_Mixer post-mix callback
+ *
+ * This function runs the mixer graph for the sound effects, adding it to
+ * the output of SDL_Mixer.
+ *
+ * The user data argument is unused.
+ *
+ * @param stream    The device stream
+ * @param len       The length of the stream in bytes
+ */
+void InternalPostMix(void*, Uint8* stream, int len) {
+    if (_engine && _engine->output) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        InternalApplyCommands();
+        _engine->output->mix(stream, len, _engine->format);
+        Uint64 finish = SDL_GetPerformanceCounter();
+        InternalRecordTiming((Uint32)len/_engine->framesize, finish-start);
+    }
+}
+
+/**
+ * Opens the audio device with the current device format and given block size
+ *
+ * If the device does not open with exactly the same format as before, it is
+ * closed again and this function returns false.  Otherwise, the mixer
+ * callbacks are hooked to the device.
+ *
+ * @param blocksize The number of audio frames in a device block
+ *
+ * @return true if the audio device was opened successfully
+ */
+bool InternalOpenDevice(int blocksize) {
+    if (Mix_OpenAudio(_engine->frequency, _engine->format, _engine->outputs, blocksize) == -1) {
+        return false;
+    }
+    
+    int freq = 0;
+    Uint16 fmt = 0;
+    int chans = 0;
+    Mix_QuerySpec(&freq, &fmt, &chans);
+    if (freq != _engine->frequency || fmt != _engine->format || chans != _engine->outputs) {
+        Mix_CloseAudio();
+        return false;
+    }
+    
+    // SDL Mixer only plays the music
+    Mix_AllocateChannels(0);
+    Mix_HookMusicFinished(InternalMusicHook);
+    Mix_SetPostMix(InternalPostMix, nullptr);
+    return true;
+}
+
+/**
+ * Attaches the current source of the channel to its panner
+ *
+ * If the source does not match the device rate, or the channel has a
+ * playback rate other than 1, the source is attached via a resampler.
+ * Otherwise it is attached directly.
+ *
+ * @param player    The sound channel
+ */
+void InternalAttachSource(AudioChannel* player) {
+    Uint32 sampling = player->panner->getSampling();
+    if (player->source->getSampling() == sampling && player->rate == 1.0f) {
+        player->resampler = nullptr;
+        InternalPostCommand(player->panner, -1, player->source);
+        return;
+    }
+    
+    player->resampler = cugl::AudioResampler::alloc(player->source->getChannels(), sampling);
+    player->resampler->setRate(player->rate);
+    player->resampler->attach(player->source);
+    InternalPostCommand(player->panner, -1, player->resampler);
+}
+
 /**
  * Initializes the audio engine for use.
  *
@@ -183,20 +876,68 @@ void InternalMusicFinished() {
  * only cross-platforms options are 1 (Mono) and 2 (Stereo). Cross-platform
  * 5.1 or 7.1 sound is not supported.
  *
+ * The block size is the number of audio frames processed in a single pass
+ * of the audio callback.  Smaller blocks have less latency, but more CPU
+ * overhead.
+ *
  * @param frequency The default sampling frequency
  * @param input     The number of sound effect channels
  * @param output    The number of output channels
+ * @param blocksize The number of audio frames in a mixer block
  */
-bool AudioStart(int frequency, int input, int output) {
+bool AudioStart(int frequency, int input, int output, int blocksize) {
     CUAssertLog(!_engine, "Audio engine has already been started");
-    if (Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, output, MIX_BLOCK_SIZE) == -1) {
+    if (Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, output, blocksize) == -1) {
+        return false;
+    }
+    
+    // The device may not have given us what we asked for
+    int freq = 0;
+    Uint16 fmt = 0;
+    int chans = 0;
+    Mix_QuerySpec(&freq, &fmt, &chans);
+    if (fmt != AUDIO_S16SYS && fmt != AUDIO_F32SYS) {
+        CULogError("Audio device format %x is not supported",fmt);
+        Mix_CloseAudio();
         return false;
     }
+    
     _engine = new AudioMixer();
+    _engine->format  = fmt;
+    _engine->output  = cugl::AudioOutput::alloc(chans, freq, blocksize);
+    _engine->effects = cugl::AudioBus::alloc(chans, freq, input);
+    _engine->output->attach(_engine->effects);
+#if defined (CU_AUDIO_STREAMING)
+    _engine->decoder = cugl::AudioStreamDecoder::alloc();
+#endif
     _engine->channels.resize(input, nullptr);
-    Mix_AllocateChannels(input);
-    Mix_ChannelFinished(InternalChannelDone);
-    Mix_HookMusicFinished(InternalMusicFinished);
+    _engine->budget = 0;
+    _engine->resident = 0;
+    _engine->hits = 0;
+    _engine->misses = 0;
+    _engine->commands.init(AUDIO_COMMAND_CAPACITY);
+    _engine->events.init(std::max((size_t)AUDIO_EVENT_CAPACITY,
+                                  (size_t)AUDIO_COMMAND_CAPACITY+2*input));
+    _engine->thread = SDL_ThreadID();
+    _engine->frequency = freq;
+    _engine->outputs   = chans;
+    _engine->blocksize = blocksize;
+    _engine->framesize = chans*(SDL_AUDIO_BITSIZE(fmt)/8);
+    _engine->tickrate  = 1000000.0/SDL_GetPerformanceFrequency();
+    _engine->reset.store(false);
+    InternalClearTimings();
+    _engine->poller = 0;
+    if (cugl::Application::get()) {
+        _engine->poller = cugl::Application::get()->schedule([] {
+            InternalPollEvents();
+            return true;
+        }, 0, 0);
+    }
+    
+    // SDL Mixer only plays the music
+    Mix_AllocateChannels(0);
+    Mix_HookMusicFinished(InternalMusicHook);
+    Mix_SetPostMix(InternalPostMix, nullptr);
     return true;
 }
 
@@ -208,6 +949,10 @@ bool AudioStart(int frequency, int input, int output) {
  */
 void AudioStop() {
     CUAssertLog(_engine, "Audio engine is not currently active");
+    Mix_SetPostMix(nullptr, nullptr);
+    if (_engine->poller && cugl::Application::get()) {
+        cugl::Application::get()->unschedule(_engine->poller);
+    }
     if (_engine->background) {
         AudioFreeBackground(_engine->background);
     }
@@ -217,11 +962,124 @@ void AudioStop() {
         }
     }
     
+    // The audio thread is gone, so finish its work here
+    InternalApplyCommands();
+    InternalPollEvents();
+    _engine->commands.dispose();
+    _engine->events.dispose();
+    
+    // Compressed buffers outlive the engine, but not their decoded chunks
+    for(auto it = _engine->cache.begin(); it != _engine->cache.end(); ++it) {
+        Mix_FreeChunk((*it)->chunk);
+        (*it)->chunk = nullptr;
+    }
+    _engine->cache.clear();
+    
+    _engine->output = nullptr;
+    _engine->effects = nullptr;
+#if defined (CU_AUDIO_STREAMING)
+    // Retired streamers may still hold a reference to the decoder
+    _engine->decoder->dispose();
+    _engine->decoder = nullptr;
+#endif
     delete _engine;
     _engine = nullptr;
     Mix_CloseAudio();
 }
 
+/**
+ * Returns true if the mixer block size was changed successfully
+ *
+ * Changing the block size requires the audio device to be reopened.  All
+ * sound channels keep playing across the change, but the background music
+ * is halted.  If the device cannot be reopened with the new block size,
+ * it is reopened with the old one and this function returns false.
+ *
+ * The mixer performance counters are reset by a successful change.
+ *
+ * @param blocksize The number of audio frames in a mixer block
+ *
+ * @return true if the mixer block size was changed successfully
+ */
+bool AudioSetBlockSize(int blocksize) {
+    CUAssertLog(_engine, "Audio engine is not currently active");
+    if (blocksize <= 0) {
+        return false;
+    } else if (blocksize == _engine->blocksize) {
+        return true;
+    }
+    
+    // SDL Mixer cannot keep music open across a device change
+    if (_engine->background && _engine->background->music) {
+        AudioHaltBackground(_engine->background);
+    }
+    Mix_SetPostMix(nullptr, nullptr);
+    Mix_HookMusicFinished(nullptr);
+    Mix_CloseAudio();
+    
+    // The audio thread is gone, so finish its work here
+    InternalApplyCommands();
+    InternalPollEvents();
+    
+    if (InternalOpenDevice(blocksize)) {
+        _engine->blocksize = blocksize;
+        _engine->reset.store(false);
+        InternalClearTimings();
+        return true;
+    }
+    
+    CULogError("Could not reopen audio device with block size %d",blocksize);
+    if (!InternalOpenDevice(_engine->blocksize)) {
+        CULogError("Could not reopen audio device: %s",Mix_GetError());
+    }
+    return false;
+}
+
+#pragma mark -
+#pragma mark Diagnostics
+/**
+ * Stores a snapshot of the mixer performance counters in timings
+ *
+ * The counters are updated by the audio thread, and are read without
+ * locking.  Hence the snapshot may straddle a callback pass.
+ *
+ * @param timings   The snapshot to store
+ */
+void AudioQueryTimings(AudioTimings* timings) {
+    std::memset(timings, 0, sizeof(AudioTimings));
+    if (!_engine) {
+        return;
+    }
+    
+    timings->blocks = _engine->blocks.load(std::memory_order_acquire);
+    timings->underruns = _engine->underruns.load(std::memory_order_relaxed);
+    timings->minimum = _engine->mintime.load(std::memory_order_relaxed)/1000.0;
+    timings->maximum = _engine->maxtime.load(std::memory_order_relaxed)/1000.0;
+    timings->total   = _engine->totaltime.load(std::memory_order_relaxed)/1000.0;
+    timings->load    = _engine->load.load(std::memory_order_relaxed);
+    for(int ii = 0; ii < AUDIO_TIMING_BINS; ii++) {
+        timings->histogram[ii] = _engine->histogram[ii].load(std::memory_order_relaxed);
+    }
+    
+    // SDL double buffers: one block is playing while the next is mixed
+    Uint32 frames = _engine->frames.load(std::memory_order_relaxed);
+    timings->frames = (frames ? frames : (Uint32)_engine->blocksize);
+    timings->frequency = _engine->frequency;
+    timings->latency = 2.0*timings->frames/_engine->frequency;
+}
+
+/**
+ * Resets the mixer performance counters
+ *
+ * The counters are cleared by the audio thread at its next pass, so a
+ * snapshot taken immediately after this call may still hold old values.
+ */
+void AudioResetTimings() {
+    if (_engine) {
+        _engine->reset.store(true);
+    }
+}
+
 #pragma mark -
 #pragma mark Sound Assets
 /**
@@ -241,47 +1099,156 @@ void AudioStop() {
  * @return an in-memory PCM buffer for the given audio asset
  */
 AudioBuffer* AudioLoadBuffer(const char* file) {
-    Mix_Chunk* data = Mix_LoadWAV(file);
+    int chans = 0;
+    int freq = 0;
+    Mix_Chunk* data = InternalLoadChunk(SDL_RWFromFile(file, "rb"), chans, freq);
     if (!data) {
         return nullptr;
     }
     
     AudioBuffer* buffer = new AudioBuffer();
     buffer->chunk = data;
+    buffer->encoded = nullptr;
+    buffer->encsize = 0;
+    buffer->pins = 0;
+    buffer->freed = false;
+    
+    // Chunks are in the device sample format, but not necessarily its rate
+    buffer->format = _engine->format;
+    buffer->channels = chans;
+    buffer->bitrate  = freq;
+    Uint32 points = (buffer->chunk->alen / ((buffer->format & 0xFF)/8));
+    buffer->frames = (points / chans);
+    return buffer;
+}
+
+/**
+ * Returns a streaming buffer for the given audio asset
+ *
+ * A streaming buffer is not decoded into memory.  Only the prebuffer is
+ * decoded now.  Each playback of the buffer starts with the prebuffer, and
+ * decodes the rest of the file incrementally on the engine worker thread.  If file is
+ * a relative path, it will search in the asset directory.  Otherwise, it
+ * will use the full path specified.
+ *
+ * Only mono and stereo OGG Vorbis files are streamed.  Any other file falls
+ * back to {@link AudioLoadBuffer}.  So does every file when the engine is
+ * built without CU_AUDIO_STREAMING.
+ *
+ * @param file      The path (absolute or relative) for the sound asset
+ * @param prebuffer The number of frames to decode before playback
+ *
+ * @return a streaming buffer for the given audio asset
+ */
+AudioBuffer* AudioOpenBuffer(const char* file, Uint32 prebuffer) {
+#if !defined (CU_AUDIO_STREAMING)
+    (void)prebuffer;
+    return AudioLoadBuffer(file);
+#else
+    std::string path(file);
+    size_t dot = path.rfind('.');
+    std::string ext = (dot == std::string::npos ? "" : path.substr(dot+1));
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
     
-    // Get the auxiliary information.
     int freq = 0;
     Uint16 fmt = 0;
     int chans = 0;
+    Uint32 channels = 0;
+    Uint32 rate = 0;
+    Uint64 frames = 0;
+    if (ext != "ogg" || !Mix_QuerySpec(&freq, &fmt, &chans) ||
+        !cugl::AudioStreamer::query(path, channels, rate, frames)) {
+        return AudioLoadBuffer(file);
+    } else if (channels > 2 || chans > 2) {
+        CULogError("Stream %s does not match the device format; decoding into memory",file);
+        return AudioLoadBuffer(file);
+    }
     
-    // Chunks are converted to audio device format...
-    if (!Mix_QuerySpec(&freq, &fmt, &chans)) {
-        // never called Mix_OpenAudio()?!
-        buffer->format = fmt;
-        buffer->channels = 0;
-        buffer->frames = 0;
-        buffer->bitrate = 0.0;
-    } else {
-        buffer->format = fmt;
-        buffer->channels = chans;
-        buffer->bitrate  = freq;
-        Uint32 points = (buffer->chunk->alen / ((fmt & 0xFF)/8));
-        buffer->frames = (points / chans);
+    AudioBuffer* buffer = new AudioBuffer();
+    if (!cugl::AudioStreamer::preload(path, prebuffer, buffer->prefix)) {
+        delete buffer;
+        return AudioLoadBuffer(file);
+    }
+    buffer->chunk = nullptr;
+    buffer->file  = path;
+    buffer->format   = AUDIO_F32SYS;
+    buffer->channels = channels;
+    buffer->bitrate  = rate;
+    buffer->frames   = frames;
+    return buffer;
+#endif
+}
+
+/**
+ * Returns a compressed buffer for the given audio asset
+ *
+ * A compressed buffer keeps the encoded file in memory, and only decodes it
+ * to PCM when it is played.  Decoded buffers are kept in a cache, which
+ * evicts the least recently played buffers when it exceeds its budget.  If
+ * file is a relative path, it will search in the asset directory.
+ * Otherwise, it will use the full path specified.
+ *
+ * The file is decoded once when loaded to determine its length.  This
+ * function is safe to call outside of the main thread.
+ *
+ * @param file  The path (absolute or relative) for the sound asset
+ *
+ * @return a compressed buffer for the given audio asset
+ */
+AudioBuffer* AudioLoadCompressed(const char* file) {
+    SDL_RWops* source = SDL_RWFromFile(file, "rb");
+    if (!source) {
+        CULogError("Unable to open sound %s: %s", file, SDL_GetError());
+        return nullptr;
+    }
+    
+    Sint64 size = SDL_RWsize(source);
+    Uint8* data = (size > 0 ? (Uint8*)SDL_malloc((size_t)size) : nullptr);
+    bool success = data && SDL_RWread(source, data, 1, (size_t)size) == (size_t)size;
+    SDL_RWclose(source);
+    
+    int freq = 0;
+    int chans = 0;
+    Mix_Chunk* chunk = nullptr;
+    if (success) {
+        chunk = InternalLoadChunk(SDL_RWFromConstMem(data, (int)size), chans, freq);
+    }
+    if (!chunk) {
+        CULogError("Unable to decode sound %s", file);
+        SDL_free(data);
+        return nullptr;
     }
     
+    AudioBuffer* buffer = new AudioBuffer();
+    buffer->chunk   = nullptr;
+    buffer->encoded = data;
+    buffer->encsize = (size_t)size;
+    buffer->pins    = 0;
+    buffer->freed   = false;
+    buffer->format   = _engine->format;
+    buffer->channels = chans;
+    buffer->bitrate  = freq;
+    buffer->frames   = (chunk->alen / ((buffer->format & 0xFF)/8)) / chans;
+    Mix_FreeChunk(chunk);
     return buffer;
 }
 
 /**
  * Frees the given PCM buffer, releasing all resources
  *
+ * If the buffer is still being read by the audio thread (because a channel
+ * was only just halted), the resources are released once the audio thread
+ * lets go of it.
+ *
  * @param source    The PCM buffer to free
  */
 void AudioFreeBuffer(AudioBuffer* source) {
     if (source) {
-        Mix_FreeChunk(source->chunk);
-        source->chunk = nullptr;
-        delete source;
+        if (source->pins) {
+            source->freed = true;
+        } else {
+            InternalDeleteBuffer(source);
+        }
     }
 }
 
@@ -318,6 +1285,56 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
     return source->bitrate;
 }
 
+/**
+ * Sets the byte budget for decoded compressed buffers
+ *
+ * When the decoded buffers exceed this budget, the least recently played
+ * buffers are evicted.  Buffers that are currently playing are never
+ * evicted.
+ *
+ * @param bytes The byte budget for decoded compressed buffers
+ */
+void AudioSetCacheBudget(size_t bytes) {
+    _engine->budget = bytes;
+    InternalTrimCache();
+}
+
+/**
+ * Returns the byte budget for decoded compressed buffers
+ *
+ * @return the byte budget for decoded compressed buffers
+ */
+size_t AudioGetCacheBudget() {
+    return _engine->budget;
+}
+
+/**
+ * Returns the number of bytes of decoded compressed buffers
+ *
+ * @return the number of bytes of decoded compressed buffers
+ */
+size_t AudioGetCacheResident() {
+    return _engine->resident;
+}
+
+/**
+ * Returns the number of plays that found their compressed buffer decoded
+ *
+ * @return the number of plays that found their compressed buffer decoded
+ */
+Uint64 AudioGetCacheHits() {
+    return _engine->hits;
+}
+
+/**
+ * Returns the number of plays that had to decode their compressed buffer
+ *
+ * @return the number of plays that had to decode their compressed buffer
+ */
+Uint64 AudioGetCacheMisses() {
+    return _engine->misses;
+}
+
 #pragma mark -
 #pragma mark Music Assets
 /**
@@ -424,13 +1441,24 @@ cugl::Music::Type AudioGetStreamType(AudioStream* source) {
  * @return a sound channel allocated for use with the audio engine
  */
 AudioChannel* AudioAllocChannel(int channel) {
-    CUAssertLog(channel >= 0 && channel < Mix_AllocateChannels(-1),
+    CUAssertLog(channel >= 0 && channel < (int)_engine->channels.size(),
                 "Channel %d is not a valid channel",channel);
     CUAssertLog(!_engine->channels[channel], "Audio channel is already allocated");
     AudioChannel* player = new AudioChannel();
     if (player) {
         player->channel = channel;
+        player->format = 0;
+        player->channels = 0;
+        player->bitrate = 0;
+        player->volume = 1.0f;
+        player->rate = 1.0f;
+        player->generation = 0;
+        player->reported = false;
         player->manual = false;
+        player->buffer = nullptr;
+        player->panner = cugl::AudioPanner::alloc(_engine->output->getChannels(),
+                                                  _engine->output->getSampling());
+        InternalPostCommand(_engine->effects, channel, player->panner);
     }
     _engine->channels[channel] = player;
     return player;
@@ -445,7 +1473,13 @@ AudioChannel* AudioAllocChannel(int channel) {
  * @param channel   The sound channel to free
  */
 void AudioFreeChannel(AudioChannel* player) {
+    InternalPostCommand(_engine->effects, player->channel, nullptr, player->buffer);
     _engine->channels[player->channel] = nullptr;
+    player->generation++;
+    player->panner = nullptr;
+    player->source = nullptr;
+    player->resampler = nullptr;
+    player->buffer = nullptr;
     delete player;
 }
 
@@ -469,14 +1503,58 @@ void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint
     player->channels = source->channels;
     player->bitrate  = source->bitrate;
     
-    Mix_PlayChannel(player->channel, source->chunk, loop ? -1 : 0);
+    // Like SDL Mixer, playing on a busy channel halts it first
+    if (player->source) {
+        AudioHaltChannel(player);
+    }
     
-    // Adjust the byte offset if not at start
+    // Buffers are pinned until the audio thread lets go of them
+    if (source->encoded && !InternalFetchCache(source)) {
+        return;
+    }
+    source->pins++;
+    player->buffer = source;
+    if (source->encoded) {
+        InternalTrimCache();
+    }
+    
+    // Chunks are in the device sample format, but not necessarily its rate
+    std::shared_ptr<cugl::AudioSource> node;
+    Uint32 rate = (Uint32)source->bitrate;
+#if defined (CU_AUDIO_STREAMING)
+    if (!source->file.empty()) {
+        node = cugl::AudioStreamer::alloc(_engine->decoder, source->file, source->channels,
+                                          rate, source->frames, source->prefix);
+    } else
+#endif
+    if (source->format == AUDIO_S16SYS) {
+        node = cugl::AudioSource::alloc((const Sint16*)source->chunk->abuf, source->frames,
+                                        source->channels, rate);
+    } else if (source->format == AUDIO_F32SYS) {
+        node = cugl::AudioSource::alloc((const float*)source->chunk->abuf, source->frames,
+                                        source->channels, rate);
+    }
+    if (!node) {
+        CULogError("Sound asset has an unsupported format");
+        InternalReleaseBuffer(source);
+        player->buffer = nullptr;
+        return;
+    }
+    
+    Uint32 channel = player->channel;
+    Uint32 generation = ++player->generation;
+    node->setLoop(loop);
+    node->setGain(player->volume);
     if (start > 0) {
-        // Convert frame to offset
-        Uint64 offset = start*((source->format & 0xFF)/8)*source->channels;
-        Mix_SetOffset(player->channel, (int)offset);
+        node->setPosition(start);
     }
+    node->setListener([=](cugl::AudioSource*) {
+        InternalSourceDone(channel,generation);
+    });
+    
+    player->source = node;
+    player->reported = false;
+    InternalAttachSource(player);
 }
 
 /**
@@ -487,21 +1565,39 @@ void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint
  * @param player    The sound channel
  */
 void AudioHaltChannel(AudioChannel* player) {
-    player->manual = true;
-    Mix_HaltChannel(player->channel);
+    if (player->source == nullptr) {
+        return;
+    }
+    
+    // Report a pending completion as normal
+    bool report = !player->reported;
+    player->manual = !player->source->completed();
+    player->generation++;
+    InternalPostCommand(player->panner, -1, nullptr, player->buffer);
+    player->source = nullptr;
+    player->resampler = nullptr;
+    player->buffer = nullptr;
+    if (report) {
+        InternalChannelDone(player->channel);
+    }
+    player->manual = false;
 }
 
 /**
  * Halts the sound channel after the given number of milliseconds.
  *
  * Once this sound is complete, this function will call the gcEffect()
- * method in AudioEngine.
+ * method in AudioEngine.  The delay is measured in real time, and so
+ * accounts for the playback rate of the channel.
  *
  * @param player    The sound channel
  * @param millis    The number of millisecond before halting the asset
  */
 void AudioExpireChannel(AudioChannel* player, Uint32 millis) {
-    Mix_ExpireChannel(player->channel,millis);
+    if (player->source) {
+        double frames = (double)millis*player->source->getSampling()*player->rate/1000;
+        player->source->expire((Uint64)frames);
+    }
 }
 
 /**
@@ -514,7 +1610,9 @@ void AudioExpireChannel(AudioChannel* player, Uint32 millis) {
  * @param player    The sound channel
  */
 void AudioPauseChannel(AudioChannel* player) {
-    Mix_Pause(player->channel);
+    if (player->source) {
+        player->source->pause();
+    }
 }
 
 /**
@@ -526,7 +1624,9 @@ void AudioPauseChannel(AudioChannel* player) {
  * @param player    The sound channel
  */
 void AudioResumeChannel(AudioChannel* player) {
-    Mix_Resume(player->channel);
+    if (player->source) {
+        player->source->resume();
+    }
 }
 
 /**
@@ -539,7 +1639,7 @@ void AudioResumeChannel(AudioChannel* player) {
  * @return true if this channel is actively playing.
  */
 bool AudioChannelPlaying(AudioChannel* player) {
-    return (bool)Mix_Playing(player->channel);
+    return player->source != nullptr && !player->source->completed();
 }
 
 /**
@@ -553,7 +1653,7 @@ bool AudioChannelPlaying(AudioChannel* player) {
  * @return true if this channel is actively paused.
  */
 bool AudioChannelPaused(AudioChannel* player) {
-    return (bool)Mix_Paused(player->channel);
+    return AudioChannelPlaying(player) && player->source->isPaused();
 }
 
 /**
@@ -566,7 +1666,29 @@ bool AudioChannelPaused(AudioChannel* player) {
  * @param volume   The volume (0 to 1) to play the asset
  */
 void AudioSetChannelVolume(AudioChannel* player, float volume) {
-    Mix_Volume(player->channel,(int)(MIX_MAX_VOLUME*volume));
+    player->volume = volume;
+    if (player->source) {
+        player->source->setGain(volume);
+    }
+}
+
+/**
+ * Sets the playback rate for this sound channel
+ *
+ * A rate of 1 plays the asset at its natural speed and pitch.  Higher rates
+ * play faster (and higher), while lower rates play slower.  The rate applies
+ * to the current asset and to all assets played later on this channel.
+ *
+ * @param player    The sound channel
+ * @param rate      The playback rate
+ */
+void AudioSetChannelRate(AudioChannel* player, float rate) {
+    player->rate = rate;
+    if (player->resampler) {
+        player->resampler->setRate(rate);
+    } else if (player->source && rate != 1.0f) {
+        InternalAttachSource(player);
+    }
 }
 
 /**
@@ -581,7 +1703,9 @@ void AudioSetChannelVolume(AudioChannel* player, float volume) {
  * @param loop      Whether to loop the current attached asset
  */
 void AudioSetChannelLoop(AudioChannel* player, bool loop) {
-    Mix_SetLoop(player->channel, loop ? -1 : 0);
+    if (player->source) {
+        player->source->setLoop(loop);
+    }
 }
 
 /**
@@ -595,7 +1719,7 @@ void AudioSetChannelLoop(AudioChannel* player, bool loop) {
  * @return the current audio frame of the given sound channel
  */
 Uint64 AudioGetChannelFrame(AudioChannel* player) {
-    return Mix_GetOffset(player->channel);
+    return (player->source ? player->source->getPosition() : 0);
 }
 
 /**
@@ -608,8 +1732,9 @@ Uint64 AudioGetChannelFrame(AudioChannel* player) {
  * @param frame     The audio frame to jump to
  */
 void AudioSetChannelFrame(AudioChannel* player, Uint64 frame) {
-    Uint64 offset = frame*((player->format & 0xFF)/8)*player->channels;
-    Mix_SetOffset(player->channel,(int)offset);
+    if (player->source) {
+        player->source->setPosition(frame);
+    }
 }
 
 
@@ -631,8 +1756,10 @@ AudioPlayer* AudioAllocBackground() {
         AudioPlayer* player = new AudioPlayer();
         if (player) {
             player->music = nullptr;
+            player->generation = 0;
             player->pauseTick = 0;
             player->startTick = 0;
+            player->manual = false;
         }
         _engine->background = player;
     }
@@ -678,6 +1805,7 @@ void AudioPlayBackground(AudioPlayer* player, AudioStream* source, bool loop, Ui
     player->pauseTick = 0;
     player->startTime = start;
     player->music = source->music;
+    player->generation++;
     
     // Do this quietly
     int volume = Mix_VolumeMusic(0);
@@ -712,6 +1840,7 @@ void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop,
     player->pauseTick = 0;
     player->startTime = start;
     player->music = source->music;
+    player->generation++;
 
     Mix_FadeInMusic(source->music,(loop ? -1 : 0),fade);
     Mix_SetMusicPosition(start/1000.0);
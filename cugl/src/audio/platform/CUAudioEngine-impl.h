@@ -38,6 +38,11 @@
 #include <cugl/base/CUBase.h>
 #include <cugl/audio/CUMusic.h>
 
+/** The number of bins in the mixer timing histogram */
+#define AUDIO_TIMING_BINS   96
+/** The number of histogram bins per doubling of the mix time */
+#define AUDIO_TIMING_STEPS  4
+
 namespace cugl {
 namespace impl {
 
@@ -98,11 +103,16 @@ namespace impl {
      * only cross-platforms options are 1 (Mono) and 2 (Stereo). Cross-platform
      * 5.1 or 7.1 sound is not supported.
      *
+     * The block size is the number of audio frames processed in a single pass
+     * of the audio callback.  Smaller blocks have less latency, but more CPU
+     * overhead.  Not all platforms respect this value.
+     *
      * @param frequency The default sampling frequency
      * @param input     The number of sound effect channels
      * @param output    The number of output channels
+     * @param blocksize The number of audio frames in a mixer block
      */
-    bool AudioStart(int frequency, int input, int output);
+    bool AudioStart(int frequency, int input, int output, int blocksize);
     
     /**
      * Stops the audio engine preventing it from further use.
@@ -112,6 +122,74 @@ namespace impl {
      */
     void AudioStop();
     
+    /**
+     * Returns true if the mixer block size was changed successfully
+     *
+     * Changing the block size requires the audio device to be reopened.  All
+     * sound channels keep playing across the change, but the background music
+     * is halted.  If the device cannot be reopened with the new block size,
+     * it is reopened with the old one and this function returns false.
+     *
+     * Not all platforms support this function.
+     *
+     * @param blocksize The number of audio frames in a mixer block
+     *
+     * @return true if the mixer block size was changed successfully
+     */
+    bool AudioSetBlockSize(int blocksize);
+    
+#pragma mark -
+#pragma mark Diagnostics
+    /**
+     * A snapshot of the mixer performance counters
+     *
+     * Mix times are measured around each pass of the audio callback, in
+     * microseconds.  The histogram is logarithmic: bin b counts the passes
+     * whose time t satisfies b <= STEPS*log2(1+t) < b+1.  The last bin also
+     * counts every pass slower than that.
+     */
+    typedef struct AudioTimings {
+        /** The number of callback passes since the last reset */
+        Uint64 blocks;
+        /** The number of passes that took longer than the block they mixed */
+        Uint64 underruns;
+        /** The fastest pass in microseconds */
+        double minimum;
+        /** The slowest pass in microseconds */
+        double maximum;
+        /** The total time of all passes in microseconds */
+        double total;
+        /** The fraction of the block duration spent mixing (smoothed) */
+        double load;
+        /** The number of frames in the most recent pass */
+        Uint32 frames;
+        /** The sample rate of the device in HZ */
+        Uint32 frequency;
+        /** The estimated output latency in seconds */
+        double latency;
+        /** The histogram of pass times */
+        Uint64 histogram[AUDIO_TIMING_BINS];
+    } AudioTimings;
+    
+    /**
+     * Stores a snapshot of the mixer performance counters in timings
+     *
+     * The counters are updated by the audio thread, and are read without
+     * locking.  Hence the snapshot may straddle a callback pass.  On platforms
+     * without instrumentation, the snapshot is all zeroes.
+     *
+     * @param timings   The snapshot to store
+     */
+    void AudioQueryTimings(AudioTimings* timings);
+    
+    /**
+     * Resets the mixer performance counters
+     *
+     * The counters are cleared by the audio thread at its next pass, so a
+     * snapshot taken immediately after this call may still hold old values.
+     */
+    void AudioResetTimings();
+    
     
 #pragma mark -
 #pragma mark Sound Assets
@@ -133,6 +211,42 @@ namespace impl {
      */
     AudioBuffer* AudioLoadBuffer(const char* file);
     
+    /**
+     * Returns a streaming buffer for the given audio asset
+     *
+     * A streaming buffer is not decoded into memory.  Instead, each playback
+     * of the buffer decodes the file incrementally on a worker thread.  If
+     * file is a relative path, it will search in the asset directory.
+     * Otherwise, it will use the full path specified.
+     *
+     * Streaming is platform-dependent.  On platforms (or for files) that do
+     * not support it, this function is the same as {@link AudioLoadBuffer}.
+     *
+     * @param file      The path (absolute or relative) for the sound asset
+     * @param prebuffer The number of frames to decode before playback
+     *
+     * @return a streaming buffer for the given audio asset
+     */
+    AudioBuffer* AudioOpenBuffer(const char* file, Uint32 prebuffer);
+    
+    /**
+     * Returns a compressed buffer for the given audio asset
+     *
+     * A compressed buffer keeps the encoded file in memory, and only decodes
+     * it to PCM when it is played.  Decoded buffers are kept in a cache, which
+     * evicts the least recently played buffers when it exceeds its budget.
+     * If file is a relative path, it will search in the asset directory.
+     * Otherwise, it will use the full path specified.
+     *
+     * Compression is platform-dependent.  On platforms that do not support
+     * it, this function is the same as {@link AudioLoadBuffer}.
+     *
+     * @param file  The path (absolute or relative) for the sound asset
+     *
+     * @return a compressed buffer for the given audio asset
+     */
+    AudioBuffer* AudioLoadCompressed(const char* file);
+    
     /**
      * Frees the given PCM buffer, releasing all resources
      *
@@ -166,6 +280,45 @@ namespace impl {
      * @return the number of sample rate (in HZ) for the given PCM buffer
      */
     double AudioGetBufferSampleRate(AudioBuffer* source);
+    
+    /**
+     * Sets the byte budget for decoded compressed buffers
+     *
+     * When the decoded buffers exceed this budget, the least recently played
+     * buffers are evicted.  Buffers that are currently playing are never
+     * evicted.
+     *
+     * @param bytes The byte budget for decoded compressed buffers
+     */
+    void AudioSetCacheBudget(size_t bytes);
+    
+    /**
+     * Returns the byte budget for decoded compressed buffers
+     *
+     * @return the byte budget for decoded compressed buffers
+     */
+    size_t AudioGetCacheBudget();
+    
+    /**
+     * Returns the number of bytes of decoded compressed buffers
+     *
+     * @return the number of bytes of decoded compressed buffers
+     */
+    size_t AudioGetCacheResident();
+    
+    /**
+     * Returns the number of plays that found their compressed buffer decoded
+     *
+     * @return the number of plays that found their compressed buffer decoded
+     */
+    Uint64 AudioGetCacheHits();
+    
+    /**
+     * Returns the number of plays that had to decode their compressed buffer
+     *
+     * @return the number of plays that had to decode their compressed buffer
+     */
+    Uint64 AudioGetCacheMisses();
 
     
 #pragma mark -
@@ -339,6 +492,18 @@ namespace impl {
      */
     void AudioSetChannelVolume(AudioChannel* player, float volume);
 
+    /**
+     * Sets the playback rate for this sound channel
+     *
+     * A rate of 1 plays the asset at its natural speed and pitch.  Higher rates
+     * play faster (and higher), while lower rates play slower.  The rate applies
+     * to the current asset and to all assets played later on this channel.
+     *
+     * @param player    The sound channel
+     * @param rate      The playback rate
+     */
+    void AudioSetChannelRate(AudioChannel* player, float rate);
+
     /**
      * Sets the loop option for this sound channel
      *
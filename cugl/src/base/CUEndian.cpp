@@ -0,0 +1,188 @@
+//
+//  CUEndian.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the bulk byte-swapping functions for CUEndian.h.
+//  The single value functions are all inline, and live in the header.
+//
+//  The bulk functions reverse the bytes of 16 bytes at a time with a single
+//  shuffle (SSSE3 or NEON).  If the compiler only enables SSE2, the bytes are
+//  reversed with shifts and word shuffles instead.  Any remaining values are
+//  swapped one at a time.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/base/CUEndian.h>
+#include <cstring>
+
+// SSSE3 must be enabled by the compiler (e.g. -mssse3 or /arch:AVX)
+#if defined (__SSSE3__) || defined (__AVX__)
+    #define CU_ENDIAN_SSSE3
+    #include <tmmintrin.h>
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CU_ENDIAN_SSE2
+    #include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    #define CU_ENDIAN_NEON
+    #include <arm_neon.h>
+#endif
+
+/** The number of bytes swapped in a single vector operation */
+#define ENDIAN_VECTOR   16
+
+using namespace cugl;
+
+/**
+ * Copies count 16 bit values from src to dst, reversing the bytes of each
+ *
+ * Unlike marshall, this function swaps the bytes on every platform.  It is
+ * intended for converting whole arrays between byte orders.
+ *
+ * Neither array needs to be aligned.  The arrays may be the same (to swap
+ * in place), but they may not otherwise overlap.
+ *
+ * @param dst   The array to store the swapped values
+ * @param src   The array of values to swap
+ * @param count The number of values to swap
+ */
+void cugl::swapBytes16(void* dst, const void* src, size_t count) {
+    const Uint8* input = (const Uint8*)src;
+    Uint8* output = (Uint8*)dst;
+    size_t bytes = count*2;
+    size_t pos = 0;
+#if defined CU_ENDIAN_SSSE3
+    const __m128i mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        __m128i value = _mm_loadu_si128((const __m128i*)(input+pos));
+        _mm_storeu_si128((__m128i*)(output+pos), _mm_shuffle_epi8(value, mask));
+    }
+#elif defined CU_ENDIAN_SSE2
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        __m128i value = _mm_loadu_si128((const __m128i*)(input+pos));
+        value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        _mm_storeu_si128((__m128i*)(output+pos), value);
+    }
+#elif defined CU_ENDIAN_NEON
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        vst1q_u8(output+pos, vrev16q_u8(vld1q_u8(input+pos)));
+    }
+#endif
+    for(; pos < bytes; pos += 2) {
+        Uint16 value;
+        std::memcpy(&value, input+pos, 2);
+        value = SDL_Swap16(value);
+        std::memcpy(output+pos, &value, 2);
+    }
+}
+
+/**
+ * Copies count 32 bit values from src to dst, reversing the bytes of each
+ *
+ * Unlike marshall, this function swaps the bytes on every platform.  It is
+ * intended for converting whole arrays between byte orders.
+ *
+ * Neither array needs to be aligned.  The arrays may be the same (to swap
+ * in place), but they may not otherwise overlap.
+ *
+ * @param dst   The array to store the swapped values
+ * @param src   The array of values to swap
+ * @param count The number of values to swap
+ */
+void cugl::swapBytes32(void* dst, const void* src, size_t count) {
+    const Uint8* input = (const Uint8*)src;
+    Uint8* output = (Uint8*)dst;
+    size_t bytes = count*4;
+    size_t pos = 0;
+#if defined CU_ENDIAN_SSSE3
+    const __m128i mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        __m128i value = _mm_loadu_si128((const __m128i*)(input+pos));
+        _mm_storeu_si128((__m128i*)(output+pos), _mm_shuffle_epi8(value, mask));
+    }
+#elif defined CU_ENDIAN_SSE2
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        // Swap the words of each value, and then the bytes of each word
+        __m128i value = _mm_loadu_si128((const __m128i*)(input+pos));
+        value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2,3,0,1));
+        value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2,3,0,1));
+        value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        _mm_storeu_si128((__m128i*)(output+pos), value);
+    }
+#elif defined CU_ENDIAN_NEON
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        vst1q_u8(output+pos, vrev32q_u8(vld1q_u8(input+pos)));
+    }
+#endif
+    for(; pos < bytes; pos += 4) {
+        Uint32 value;
+        std::memcpy(&value, input+pos, 4);
+        value = SDL_Swap32(value);
+        std::memcpy(output+pos, &value, 4);
+    }
+}
+
+/**
+ * Copies count 64 bit values from src to dst, reversing the bytes of each
+ *
+ * Unlike marshall, this function swaps the bytes on every platform.  It is
+ * intended for converting whole arrays between byte orders.
+ *
+ * Neither array needs to be aligned.  The arrays may be the same (to swap
+ * in place), but they may not otherwise overlap.
+ *
+ * @param dst   The array to store the swapped values
+ * @param src   The array of values to swap
+ * @param count The number of values to swap
+ */
+void cugl::swapBytes64(void* dst, const void* src, size_t count) {
+    const Uint8* input = (const Uint8*)src;
+    Uint8* output = (Uint8*)dst;
+    size_t bytes = count*8;
+    size_t pos = 0;
+#if defined CU_ENDIAN_SSSE3
+    const __m128i mask = _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        __m128i value = _mm_loadu_si128((const __m128i*)(input+pos));
+        _mm_storeu_si128((__m128i*)(output+pos), _mm_shuffle_epi8(value, mask));
+    }
+#elif defined CU_ENDIAN_SSE2
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        // Reverse the words of each value, and then the bytes of each word
+        __m128i value = _mm_loadu_si128((const __m128i*)(input+pos));
+        value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0,1,2,3));
+        value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0,1,2,3));
+        value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        _mm_storeu_si128((__m128i*)(output+pos), value);
+    }
+#elif defined CU_ENDIAN_NEON
+    for(; pos+ENDIAN_VECTOR <= bytes; pos += ENDIAN_VECTOR) {
+        vst1q_u8(output+pos, vrev64q_u8(vld1q_u8(input+pos)));
+    }
+#endif
+    for(; pos < bytes; pos += 8) {
+        Uint64 value;
+        std::memcpy(&value, input+pos, 8);
+        value = SDL_Swap64(value);
+        std::memcpy(output+pos, &value, 8);
+    }
+}
@@ -0,0 +1,352 @@
+//
+//  CUAsyncFlusher.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a background thread for writing buffers to a file.
+//  It is used by the asynchronous modes of BinaryWriter and TextWriter, so
+//  that a flush does not block the writing thread on the file system.  The
+//  writers are double buffered.  They fill one buffer while this thread writes
+//  the other.  A writer only blocks (stalls) if it fills its buffer before
+//  the previous one has been written.
+//
+//  This module also provides the platform specific code to commit a stream
+//  to the storage device (e.g. fsync).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+//
+#include <cugl/io/CUAsyncFlusher.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#if defined (__WINDOWS__)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a flusher with no assigned stream.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AsyncFlusher::AsyncFlusher() :
+_stream(nullptr),
+_pending(nullptr),
+_amount(0),
+_syncing(false),
+_busy(false),
+_failed(false),
+_running(false),
+_worker(nullptr) {
+    resetStatistics();
+}
+
+/**
+ * Initializes a flusher for the given stream.
+ *
+ * This method starts the worker thread.  The stream must be open for
+ * writing, and must remain open until this flusher is disposed.
+ *
+ * @param stream    The SDL I/O stream to write to
+ *
+ * @return true if the flusher is initialized properly, false otherwise.
+ */
+bool AsyncFlusher::init(SDL_RWops* stream) {
+    if (_worker != nullptr || stream == nullptr) {
+        return false;
+    }
+    _stream  = stream;
+    _pending = nullptr;
+    _amount  = 0;
+    _syncing = false;
+    _busy    = false;
+    _failed  = false;
+    _running = true;
+    resetStatistics();
+    _worker = new std::thread([this]() { this->run(); });
+    return true;
+}
+
+/**
+ * Disposes this flusher, stopping the worker thread.
+ *
+ * This method waits for any pending write to complete.  It does not close
+ * the stream.  A disposed flusher can be safely reinitialized.
+ */
+void AsyncFlusher::dispose() {
+    if (_worker != nullptr) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _ready.notify_all();
+        _worker->join();
+        delete _worker;
+        _worker = nullptr;
+    }
+    _stream  = nullptr;
+    _pending = nullptr;
+    _amount  = 0;
+    _busy    = false;
+}
+
+
+#pragma mark -
+#pragma mark Writing
+/**
+ * Submits a buffer to be written in the background.
+ *
+ * If the previous write is still in progress, this method blocks until
+ * it completes.  The flusher takes ownership of the buffer until the next
+ * call to {@link wait} (or the next submission).  The caller must not
+ * modify or delete the buffer before then.
+ *
+ * @param buffer    The bytes to write
+ * @param amount    The number of bytes to write
+ * @param commit    Whether to commit the stream to the device afterwards
+ */
+void AsyncFlusher::submit(const char* buffer, size_t amount, bool commit) {
+    CUAssertLog(_worker, "Attempt to submit to a disposed flusher");
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        block(lock);
+        if (amount == 0 && !commit) {
+            return;
+        }
+        _pending = buffer;
+        _amount  = amount;
+        _syncing = commit;
+        _busy    = true;
+        _writes++;
+    }
+    _ready.notify_one();
+}
+
+/**
+ * Returns true if all writes since the last wait were successful.
+ *
+ * This method blocks until the pending write (if any) completes.  Once it
+ * returns, the caller has ownership of all submitted buffers again.
+ *
+ * @return true if all writes since the last wait were successful.
+ */
+bool AsyncFlusher::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    block(lock);
+    bool result = !_failed;
+    _failed = false;
+    return result;
+}
+
+/**
+ * Returns true if the worker thread is writing a buffer.
+ *
+ * This value is only a snapshot, and may change immediately.
+ *
+ * @return true if the worker thread is writing a buffer.
+ */
+bool AsyncFlusher::isBusy() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _busy;
+}
+
+/**
+ * Returns true if the stream was committed to the storage device.
+ *
+ * This flushes any buffering in the C library and asks the operating
+ * system to write the file to the device (fsync on POSIX platforms and
+ * FlushFileBuffers on Windows).  This guarantees that the data survives
+ * a crash or power failure, but it is very slow.  Streams that are not
+ * backed by a file are trivially committed.
+ *
+ * This method is synchronous.  To commit in the background, pass true to
+ * the commit argument of {@link submit}.
+ *
+ * @param stream    The SDL I/O stream to commit
+ *
+ * @return true if the stream was committed to the storage device.
+ */
+bool AsyncFlusher::commit(SDL_RWops* stream) {
+    if (stream == nullptr) {
+        return false;
+    }
+#if defined (__WINDOWS__)
+    if (stream->type == SDL_RWOPS_WINFILE) {
+        return FlushFileBuffers((HANDLE)stream->hidden.windowsio.h) != 0;
+    }
+#endif
+#ifdef HAVE_STDIO_H
+    if (stream->type == SDL_RWOPS_STDFILE) {
+        FILE* file = stream->hidden.stdio.fp;
+        if (fflush(file) != 0) {
+            return false;
+        }
+    #if defined (__WINDOWS__)
+        return _commit(_fileno(file)) == 0;
+    #else
+        return fsync(fileno(file)) == 0;
+    #endif
+    }
+#endif
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Statistics
+/**
+ * Returns the given percentile of the stall durations in ms.
+ *
+ * The percentile is a value in [0,1] (so 0.99 is the 99th percentile).
+ * The stall durations are binned by powers of two, so this value is only
+ * an upper bound (clamped to the longest stall).  If there have been no
+ * stalls, this method returns 0.
+ *
+ * @param percentile    The percentile in [0,1]
+ *
+ * @return the given percentile of the stall durations in ms.
+ */
+double AsyncFlusher::getStallPercentile(float percentile) const {
+    if (_stalls == 0) {
+        return 0;
+    }
+    percentile = std::min(std::max(percentile, 0.0f), 1.0f);
+    Uint64 target = (Uint64)(percentile*_stalls);
+    target = std::max(target, (Uint64)1);
+
+    Uint64 count = 0;
+    for(Uint32 bin = 0; bin < FLUSHER_STALL_BINS; bin++) {
+        count += _histogram[bin];
+        if (count >= target) {
+            Uint64 upper = ((Uint64)1) << bin;
+            return std::min(upper, _maxstall)/1000.0;
+        }
+    }
+    return _maxstall/1000.0;
+}
+
+/**
+ * Resets all of the statistics of this flusher.
+ */
+void AsyncFlusher::resetStatistics() {
+    _writes = 0;
+    _stalls = 0;
+    _stalltime = 0;
+    _maxstall  = 0;
+    std::memset(_histogram, 0, sizeof(_histogram));
+}
+
+/**
+ * Records a stall of the given duration.
+ *
+ * @param micros    The stall duration in microseconds
+ */
+void AsyncFlusher::record(Uint64 micros) {
+    Uint32 bin = 0;
+    while (bin < FLUSHER_STALL_BINS-1 && (((Uint64)1) << bin) <= micros) {
+        bin++;
+    }
+    _histogram[bin]++;
+    _stalls++;
+    _stalltime += micros;
+    _maxstall = std::max(_maxstall, micros);
+}
+
+/**
+ * Blocks until the worker thread is idle.
+ *
+ * This method must be called with the mutex held.  It records a stall if
+ * it has to block.
+ *
+ * @param lock  The lock holding the mutex
+ */
+void AsyncFlusher::block(std::unique_lock<std::mutex>& lock) {
+    if (!_busy) {
+        return;
+    }
+    Uint64 start = SDL_GetPerformanceCounter();
+    _idle.wait(lock, [this]() { return !_busy; });
+    Uint64 ticks = SDL_GetPerformanceCounter()-start;
+    record((ticks*1000000)/SDL_GetPerformanceFrequency());
+}
+
+/**
+ * Runs the worker thread, writing buffers as they are submitted.
+ */
+void AsyncFlusher::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _ready.wait(lock, [this]() { return _busy || !_running; });
+        if (!_busy) {
+            break;
+        }
+
+        // Write without the lock, so the writer can check on progress
+        const char* buffer = _pending;
+        size_t amount = _amount;
+        bool commit = _syncing;
+        lock.unlock();
+        bool success = true;
+        if (amount > 0) {
+            success = SDL_RWwrite(_stream, buffer, 1, amount) == amount;
+        }
+        if (success && commit) {
+            success = AsyncFlusher::commit(_stream);
+        }
+        lock.lock();
+
+        if (!success) {
+            CULogError("Unable to fully flush the writer: %s", SDL_GetError());
+            _failed = true;
+        }
+        _pending = nullptr;
+        _amount  = 0;
+        _syncing = false;
+        _busy    = false;
+        _idle.notify_all();
+    }
+}
@@ -17,6 +17,12 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A reader may also be memory mapped.  In that case, the file is never copied
+//  into a buffer.  Array reads convert directly from the mapping, and arrays
+//  in the host byte order may be viewed in place.  This is much faster for
+//  large files.  Mapping is not possible for every file (e.g. assets in an
+//  Android APK), in which case the reader falls back to buffered reads.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -54,10 +60,51 @@
 #include <cugl/util/CUDebug.h>
 #include <cugl/base/CUApplication.h>
 #include <cugl/base/CUEndian.h>
+#include <algorithm>
+#include <cstring>
+#if defined (__WINDOWS__)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 using namespace cugl;
 
 #define BUFFSIZE 1024
+/** The largest window into a memory mapped file (so offsets fit in 32 bits) */
+#define MAPPED_WINDOW 0x40000000
+
+/**
+ * Copies count elements of the given size from src to dst
+ *
+ * If swap is true, the bytes of each element are reversed.
+ *
+ * @param dst   The array to store the elements
+ * @param src   The array of elements to copy
+ * @param count The number of elements to copy
+ * @param size  The number of bytes in a single element
+ * @param swap  Whether to reverse the bytes of each element
+ */
+static void transfer(void* dst, const void* src, size_t count, unsigned int size, bool swap) {
+    if (!swap || size == 1) {
+        std::memcpy(dst, src, count*size);
+    } else if (size == 2) {
+        swapBytes16(dst, src, count);
+    } else if (size == 4) {
+        swapBytes32(dst, src, count);
+    } else {
+        swapBytes64(dst, src, count);
+    }
+}
 
 #pragma mark -
 #pragma mark Constructors
@@ -170,6 +217,66 @@ bool BinaryReader::initWithAsset(const char* file, unsigned int capacity) {
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a memory mapped reader for the given file.
+ *
+ * The file is mapped into memory, rather than read in chunks.  If the
+ * file cannot be mapped (e.g. it is empty, or the platform does not
+ * support it), the reader falls back to buffered reads with the default
+ * capacity.  Use {@link isMapped} to tell the two apart.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initMapped(const Pathname& file) {
+    _name = file.getAbsoluteName();
+    _capacity = BUFFSIZE;
+    if (map()) {
+        return true;
+    }
+    return init(file,BUFFSIZE);
+}
+
+/**
+ * Initializes a memory mapped reader for the given file.
+ *
+ * The file is mapped into memory, rather than read in chunks.  If the
+ * file cannot be mapped (e.g. it is in an Android APK), the reader falls
+ * back to buffered reads with the default capacity.  Use {@link isMapped}
+ * to tell the two apart.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initMappedWithAsset(const char* file) {
+    // Check if the path is absolute
+#if defined (__WINDOWS__)
+    bool absolute = (bool)strstr(file,":");
+#else
+    bool absolute = file[0] == '/';
+#endif
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+    
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+    _capacity = BUFFSIZE;
+    if (map()) {
+        return true;
+    }
+    return initWithAsset(file,BUFFSIZE);
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -180,15 +287,19 @@ bool BinaryReader::initWithAsset(const char* file, unsigned int capacity) {
  * if the stream has been closed.
  */
 void BinaryReader::reset() {
-    if (_stream) {
-        close();
+    bool mapped = _mapsize > 0;
+    close();
+    if (mapped && map()) {
+        return;
     }
+    
     _stream = SDL_RWFromFile(_name.c_str(), "rb");
     _ssize  = SDL_RWsize(_stream);
     _buffer = new char[_capacity];
     _bufsize = 0;
-    _bufoff  = 0;
+    _bufoff  = -1;
     _scursor = 0;
+    fill();
 }
 
 /**
@@ -198,6 +309,18 @@ void BinaryReader::reset() {
  * on a previously closed stream has no effect.
  */
 void BinaryReader::close() {
+    if (_mapping) {
+#if defined (__WINDOWS__)
+        UnmapViewOfFile(_mapping);
+#else
+        munmap(_mapping, _mapsize);
+#endif
+        // The buffer was just a window into the mapping
+        _mapping = nullptr;
+        _buffer  = nullptr;
+        _bufsize = 0;
+        _scursor = 0;
+    }
     if (_stream) {
         SDL_RWclose(_stream);
         _stream  = nullptr;
@@ -229,22 +352,50 @@ bool BinaryReader::ready(unsigned int bytes) const {
     return true;
 }
 
+/**
+ * Sets the byte order of the file.
+ *
+ * The value must be either SDL_BIG_ENDIAN or SDL_LIL_ENDIAN.  By default,
+ * all files are in network (big-endian) order.  A file in the host byte
+ * order (SDL_BYTEORDER) needs no conversion, and so its arrays may be
+ * viewed without copying.  The order may be changed at any time, and
+ * affects all subsequent reads.
+ *
+ * @param order The byte order of the file.
+ */
+void BinaryReader::setByteOrder(int order) {
+    CUAssertLog(order == SDL_BIG_ENDIAN || order == SDL_LIL_ENDIAN, "Invalid byte order %d", order);
+    _byteorder = order;
+}
+
 /**
  * Fills the storage buffer to capacity
  *
  * This cuts down on the number of reads to the file by allowing us
- * to read from the file in predefined chunks.
+ * to read from the file in predefined chunks.  If the file is memory
+ * mapped, the buffer is a window into the mapping, and this method
+ * simply slides the window forward.
  *
  * @param bytes The minimum number of bytes to ensure in the stream
  */
 void BinaryReader::fill(unsigned int bytes) {
+    if (_mapping) {
+        Sint64 start  = (_buffer-_mapping)+_bufoff;
+        Sint64 window = std::min(_ssize-start,(Sint64)MAPPED_WINDOW);
+        _buffer  = _mapping+start;
+        _bufoff  = 0;
+        _bufsize = (Uint32)window;
+        _scursor = start+window;
+        return;
+    }
+    
     if (!_bufoff || !_stream || _scursor == _ssize) {
         return;
     }
     
     if (_bufoff == -1 || _bufoff+bytes > _bufsize) {
         if (_bufoff < _bufsize) {
-            memcpy(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
+            memmove(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
             _bufsize -= _bufoff;
         } else {
             _bufsize = 0;
@@ -257,6 +408,146 @@ void BinaryReader::fill(unsigned int bytes) {
     _scursor += amt;
 }
 
+/**
+ * Returns true if the file was successfully mapped into memory
+ *
+ * The file is the one specified by the current name.  If this method
+ * fails, the reader is unchanged.
+ *
+ * @return true if the file was successfully mapped into memory
+ */
+bool BinaryReader::map() {
+#if defined (__WINDOWS__)
+    int chars = MultiByteToWideChar(CP_UTF8, 0, _name.c_str(), -1, NULL, 0);
+    if (chars <= 0) {
+        return false;
+    }
+    std::wstring wide(chars, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, _name.c_str(), -1, &wide[0], chars);
+    HANDLE file = CreateFileW(wide.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || (Uint64)size.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return false;
+    }
+    // The view keeps the mapping (and the file) open
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL) {
+        return false;
+    }
+    size_t length = (size_t)size.QuadPart;
+#else
+    int file = open(_name.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size <= 0 || (Uint64)info.st_size > SIZE_MAX) {
+        ::close(file);
+        return false;
+    }
+    // The mapping keeps the file open
+    size_t length = (size_t)info.st_size;
+    void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    madvise(view, length, MADV_SEQUENTIAL);
+#endif
+    
+    _mapping = (char*)view;
+    _mapsize = length;
+    _ssize   = (Sint64)length;
+    _scursor = 0;
+    _buffer  = _mapping;
+    _bufsize = 0;
+    _bufoff  = 0;
+    fill();
+    return true;
+}
+
+/**
+ * Reads a sequence of elements of the given size from the stream.
+ *
+ * The bytes of each element are reversed if the file byte order is not
+ * the host byte order. This method returns the number of elements read.
+ *
+ * @param buffer    The array to store the data when read
+ * @param maximum   The maximum number of elements to read from the stream
+ * @param size      The number of bytes in a single element
+ *
+ * @return the number of elements read from the stream
+ */
+size_t BinaryReader::readArray(void* buffer, size_t maximum, unsigned int size) {
+    Uint8* output = (Uint8*)buffer;
+    bool swap = _byteorder != SDL_BYTEORDER;
+    size_t total = 0;
+    while (total < maximum && ready(size)) {
+        size_t amount;
+        if (!_mapping && _bufoff >= (Sint32)_bufsize && (maximum-total)*size >= _capacity) {
+            // Large reads skip the buffer, and convert in place
+            amount = std::min(maximum-total, (size_t)(_ssize-_scursor)/size);
+            amount = SDL_RWread(_stream, output+total*size, size, amount);
+            transfer(output+total*size, output+total*size, amount, size, swap);
+            _scursor += amount*size;
+        } else {
+            if (_bufoff+size > _bufsize) {
+                fill(size);
+            }
+            amount = std::min(maximum-total, (size_t)(_bufsize-_bufoff)/size);
+            transfer(output+total*size, _buffer+_bufoff, amount, size, swap);
+            _bufoff += (Sint32)(amount*size);
+        }
+        if (amount == 0) {
+            break;
+        }
+        total += amount;
+    }
+    return total;
+}
+
+/**
+ * Views a sequence of elements of the given size in the memory mapping.
+ *
+ * This method returns 0 (and leaves data unchanged) if the stream is not
+ * mapped, if the elements need their bytes reversed, or if the current
+ * position is not aligned to the element size.
+ *
+ * @param data      The pointer to the viewed elements
+ * @param maximum   The maximum number of elements to view
+ * @param size      The number of bytes in a single element
+ *
+ * @return the number of elements viewed
+ */
+size_t BinaryReader::viewArray(const void** data, size_t maximum, unsigned int size) {
+    if (!_mapping || (size > 1 && _byteorder != SDL_BYTEORDER) || !ready(size)) {
+        return 0;
+    }
+    if (_bufoff+size > _bufsize) {
+        fill(size);
+    }
+    
+    const char* start = _buffer+_bufoff;
+    if ((uintptr_t)start % size != 0) {
+        return 0;
+    }
+    size_t amount = std::min(maximum, (size_t)(_bufsize-_bufoff)/size);
+    *data = start;
+    _bufoff += (Sint32)(amount*size);
+    return amount;
+}
+
 #pragma mark -
 #pragma mark Single Element Reads
 /**
@@ -288,8 +579,9 @@ Uint8 BinaryReader::readByte() {
 /**
  * Returns a single 16 bit signed integer from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single 16 bit signed integer from the stream
  */
@@ -299,16 +591,18 @@ Sint16 BinaryReader::readSint16() {
         fill(2);
     }
     CUAssertLog(_bufsize - _bufoff >= 2, "Too few elements remaining in stream");
-    Sint16* ref = (Sint16*)(&_buffer[_bufoff]);
+    Uint16 value;
+    std::memcpy(&value, &_buffer[_bufoff], 2);
     _bufoff += 2;
-    return marshall(*ref);
+    return (Sint16)(_byteorder == SDL_BYTEORDER ? value : SDL_Swap16(value));
 }
 
 /**
  * Returns a single 16 bit unsigned integer from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single 16 bit unsigned integer from the stream
  */
@@ -318,16 +612,18 @@ Uint16 BinaryReader::readUint16() {
         fill(2);
     }
     CUAssertLog(_bufsize - _bufoff >= 2, "Too few elements remaining in stream");
-    Uint16* ref = (Uint16*)(&_buffer[_bufoff]);
+    Uint16 value;
+    std::memcpy(&value, &_buffer[_bufoff], 2);
     _bufoff += 2;
-    return marshall(*ref);
+    return (_byteorder == SDL_BYTEORDER ? value : SDL_Swap16(value));
 }
 
 /**
  * Returns a single 32 bit signed integer from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single 32 bit signed integer from the stream
  */
@@ -337,17 +633,19 @@ Sint32 BinaryReader::readSint32() {
         fill(4);
     }
     CUAssertLog(_bufsize - _bufoff >= 4, "Too few elements remaining in stream");
-    Sint32* ref = (Sint32*)(&_buffer[_bufoff]);
+    Uint32 value;
+    std::memcpy(&value, &_buffer[_bufoff], 4);
     _bufoff += 4;
-    return marshall(*ref);
+    return (Sint32)(_byteorder == SDL_BYTEORDER ? value : SDL_Swap32(value));
 }
 
 
 /**
  * Returns a single 32 bit unsigned integer from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single 32 bit unsigned integer from the stream
  */
@@ -357,17 +655,19 @@ Uint32 BinaryReader::readUint32() {
         fill(4);
     }
     CUAssertLog(_bufsize - _bufoff >= 4, "Too few elements remaining in stream");
-    Uint32* ref = (Uint32*)(&_buffer[_bufoff]);
+    Uint32 value;
+    std::memcpy(&value, &_buffer[_bufoff], 4);
     _bufoff += 4;
-    return marshall(*ref);
+    return (_byteorder == SDL_BYTEORDER ? value : SDL_Swap32(value));
 }
 
 
 /**
  * Returns a single 32 bit signed integer from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single 32 bit signed integer from the stream
  */
@@ -377,16 +677,18 @@ Sint64 BinaryReader::readSint64() {
         fill(8);
     }
     CUAssertLog(_bufsize - _bufoff >= 8, "Too few elements remaining in stream");
-    Sint64* ref = (Sint64*)(&_buffer[_bufoff]);
+    Uint64 value;
+    std::memcpy(&value, &_buffer[_bufoff], 8);
     _bufoff += 8;
-    return marshall(*ref);
+    return (Sint64)(_byteorder == SDL_BYTEORDER ? value : SDL_Swap64(value));
 }
 
 /**
  * Returns a single 32 bit unsigned integer from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single 32 bit unsigned integer from the stream
  */
@@ -396,17 +698,19 @@ Uint64 BinaryReader::readUint64() {
         fill(8);
     }
     CUAssertLog(_bufsize - _bufoff >= 8, "Too few elements remaining in stream");
-    Uint64* ref = (Uint64*)(&_buffer[_bufoff]);
+    Uint64 value;
+    std::memcpy(&value, &_buffer[_bufoff], 8);
     _bufoff += 8;
-    return marshall(*ref);
+    return (_byteorder == SDL_BYTEORDER ? value : SDL_Swap64(value));
 }
 
 
 /**
  * Returns a single float from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single float from the stream
  */
@@ -416,17 +720,24 @@ float BinaryReader::readFloat() {
         fill(4);
     }
     CUAssertLog(_bufsize - _bufoff >= 4, "Too few elements remaining in stream");
-    float* ref = (float*)(&_buffer[_bufoff]);
+    Uint32 value;
+    std::memcpy(&value, &_buffer[_bufoff], 4);
     _bufoff += 4;
-    return marshall(*ref);
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap32(value);
+    }
+    float result;
+    std::memcpy(&result, &value, 4);
+    return result;
 }
 
 
 /**
  * Returns a single double from the stream
  *
- * The value is marshalled from network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @return a single double from the stream
  */
@@ -436,9 +747,15 @@ double BinaryReader::readDouble()  {
         fill(8);
     }
     CUAssertLog(_bufsize - _bufoff >= 8, "Too few elements remaining in stream");
-    double* ref = (double*)(&_buffer[_bufoff]);
+    Uint64 value;
+    std::memcpy(&value, &_buffer[_bufoff], 8);
     _bufoff += 8;
-    return marshall(*ref);
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap64(value);
+    }
+    double result;
+    std::memcpy(&result, &value, 8);
+    return result;
 }
 
 
@@ -458,16 +775,7 @@ double BinaryReader::readDouble()  {
  */
 size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    while (ready(1) && pos-offset < maximum) {
-        size_t available = _bufsize-_bufoff;
-        size_t wanted = maximum-(pos-offset);
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)wanted;
-    }
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 1);
 }
 
 /**
@@ -482,18 +790,9 @@ size_t BinaryReader::read(char* buffer, size_t maximum, size_t offset) {
  *
  * @return the number of bytes read from the stream
  */
-size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
+size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    while (ready(1) && pos-offset < maximum) {
-        size_t available = _bufsize-_bufoff;
-        size_t wanted = maximum-(pos-offset);
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)wanted;
-    }
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 1);
 }
 
 /**
@@ -502,8 +801,9 @@ size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -513,21 +813,7 @@ size_t BinaryReader::read(Uint8* buffer, size_t maximum, size_t offset)  {
  */
 size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 2);
 }
 
 /**
@@ -536,8 +822,9 @@ size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -545,23 +832,9 @@ size_t BinaryReader::read(Sint16* buffer, size_t maximum, size_t offset) {
  *
  * @return the number of 16 bit unsigned integers read from the stream
  */
-size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
+size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 2;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 2);
 }
 
 
@@ -571,8 +844,9 @@ size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -582,21 +856,7 @@ size_t BinaryReader::read(Uint16* buffer, size_t maximum, size_t offset)  {
  */
 size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 4);
 }
 
 /**
@@ -605,8 +865,9 @@ size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -616,21 +877,7 @@ size_t BinaryReader::read(Sint32* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 4);
 }
 
 /**
@@ -639,8 +886,9 @@ size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -650,21 +898,7 @@ size_t BinaryReader::read(Uint32* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 8);
 }
 
 /**
@@ -673,8 +907,9 @@ size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -684,21 +919,7 @@ size_t BinaryReader::read(Sint64* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 8);
 }
 
 /**
@@ -707,8 +928,9 @@ size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -718,21 +940,7 @@ size_t BinaryReader::read(Uint64* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 4;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 4);
 }
 
 /**
@@ -741,8 +949,9 @@ size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
  * The function will attempt to read up to maximum number of elements.
  * It will return the actual number of elements read (which may be 0).
  *
- * The values are marshalled from network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled from the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * @param buffer    The array to store the data when read
  * @param maximum   The maximum number of elements to read from the stream
@@ -752,20 +961,6 @@ size_t BinaryReader::read(float* buffer, size_t maximum, size_t offset) {
  */
 size_t BinaryReader::read(double* buffer, size_t maximum, size_t offset) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    unsigned int pos = (unsigned int)offset;
-    unsigned int bytes = 8;
-    while (ready(bytes) && pos-offset < maximum) {
-        size_t available = bytes*((_bufsize-_bufoff)/bytes);
-        size_t wanted = (maximum-(pos-offset))*bytes;
-        wanted = wanted < available ? wanted : available;
-        memcpy(&(buffer[pos]),&(_buffer[_bufoff]),wanted);
-        _bufoff += (Sint32)wanted;
-        pos += (unsigned int)(wanted/bytes);
-    }
-    for(int ii = (int)offset; ii < pos; ii++) {
-        buffer[ii] = marshall(buffer[ii]);
-    }
-    
-    return pos-offset;
+    return readArray(buffer+offset, maximum, 8);
 }
 
@@ -10,6 +10,10 @@
 //  long, etc.  Those types are NOT cross-platform.  For example, a long is
 //  8 bytes on Unix/OS X, but 4 bytes on Win32 platforms.
 //
+//  Arrays are converted a buffer at a time with vectorized byte swaps (see
+//  CUEndian.h).  Files may also be written in the host byte order, in which
+//  case arrays are copied without any conversion.
+//
 //  By default, this module (and every module in the io package) accesses the
 //  application save directory.  If you want to access another directory, you
 //  will need to specify an absolute path for the file name.  Keep in mind that
@@ -17,6 +21,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A writer may also be asynchronous.  An asynchronous writer is double
+//  buffered, and full buffers are written to the file on a background thread.
+//  This keeps large saves from stalling the game loop.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -54,12 +62,36 @@
 #include <cugl/base/CUApplication.h>
 #include <cugl/base/CUEndian.h>
 #include <cugl/util/CUDebug.h>
+#include <algorithm>
 #include <cstring>
 
 using namespace cugl;
 
 #define BUFFSIZE 1024
 
+/**
+ * Copies count elements of the given size from src to dst
+ *
+ * If swap is true, the bytes of each element are reversed.
+ *
+ * @param dst   The array to store the elements
+ * @param src   The array of elements to copy
+ * @param count The number of elements to copy
+ * @param size  The number of bytes in a single element
+ * @param swap  Whether to reverse the bytes of each element
+ */
+static void transfer(void* dst, const void* src, size_t count, unsigned int size, bool swap) {
+    if (!swap || size == 1) {
+        std::memcpy(dst, src, count*size);
+    } else if (size == 2) {
+        swapBytes16(dst, src, count);
+    } else if (size == 4) {
+        swapBytes32(dst, src, count);
+    } else {
+        swapBytes64(dst, src, count);
+    }
+}
+
 #pragma mark -
 #pragma mark Constructors
 
@@ -100,6 +132,7 @@ bool BinaryWriter::init(const Pathname& file) {
 bool BinaryWriter::init(const Pathname& file, unsigned int capacity) {
     CUAssertLog(capacity >= 8, "Buffer capacity is too small: %d", capacity);
     _name = file.getAbsoluteName();
+    _flusher = nullptr;
     _stream = SDL_RWFromFile(_name.c_str(), "w");
     if (!_stream) {
         CULogError("%s", SDL_GetError());
@@ -113,6 +146,57 @@ bool BinaryWriter::init(const Pathname& file, unsigned int capacity) {
     return (bool)_cbuffer;
 }
 
+/**
+ * Initializes an asynchronous writer for the given file.
+ *
+ * The writer is double buffered.  Writes fill one buffer while a
+ * background thread writes the other buffer to the file.  Hence a flush
+ * only blocks if the previous buffer has not been written yet.
+ *
+ * Each buffer will have the default capacity for writing chunks to the
+ * file.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool BinaryWriter::initAsync(const Pathname& file) {
+    return initAsync(file,BUFFSIZE);
+}
+
+/**
+ * Initializes an asynchronous writer for the given file with the specified capacity.
+ *
+ * The writer is double buffered.  Writes fill one buffer while a
+ * background thread writes the other buffer to the file.  Hence a flush
+ * only blocks if the previous buffer has not been written yet.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file      the path (absolute or relative) to the file
+ * @param capacity  the capacity of each buffer
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool BinaryWriter::initAsync(const Pathname& file, unsigned int capacity) {
+    if (!init(file,capacity)) {
+        return false;
+    }
+    _sbuffer = new char[_capacity];
+    _flusher = AsyncFlusher::alloc(_stream);
+    return _flusher != nullptr;
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -121,30 +205,102 @@ bool BinaryWriter::init(const Pathname& file, unsigned int capacity) {
  *
  * It is usually unnecessary to call this method. It is called automatically
  * when the buffer fills, or just before the file is closed.
+ *
+ * If this writer is asynchronous, the buffer is handed to the background
+ * thread and this method returns immediately (unless the previous buffer
+ * is still being written).  The data is not guaranteed to be in the file
+ * until a call to {@link sync} or {@link close}.
  */
 void BinaryWriter::flush() {
+    if (_flusher) {
+        // The spare buffer is free once the previous submission is done
+        _flusher->submit(_cbuffer, _bufoff);
+        std::swap(_cbuffer, _sbuffer);
+        _bufoff = 0;
+        return;
+    }
     size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
     CUAssertLog(amt == _bufoff, "Unable to fully flush the writer");
     _bufoff = 0;
 }
 
+/**
+ * Returns true if all data written so far is safely on the storage device.
+ *
+ * This method flushes the buffer and waits for any background writes to
+ * complete.  It then commits the file to the device (e.g. fsync), so that
+ * the data survives a crash or power failure.  This is slow, and should
+ * only be used at important save points.
+ *
+ * @return true if all data written so far is safely on the storage device.
+ */
+bool BinaryWriter::sync() {
+    CUAssertLog(_stream, "Attempt to sync a closed stream");
+    if (_flusher) {
+        _flusher->submit(_cbuffer, _bufoff, true);
+        std::swap(_cbuffer, _sbuffer);
+        _bufoff = 0;
+        return _flusher->wait();
+    }
+    size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
+    bool success = (amt == (size_t)_bufoff);
+    _bufoff = 0;
+    return AsyncFlusher::commit(_stream) && success;
+}
+
 /**
  * Closes the stream, releasing all resources
  *
  * The contents of the buffer are flushed before the file is closed.  Any
  * attempts to write to a closed stream will fail.  Calling this method
  * on a previously closed stream has no effect.
+ *
+ * If this writer is asynchronous, this method blocks until all background
+ * writes are complete.  The return value reports whether every write to
+ * the file (including those in the background) was successful.
+ *
+ * @return true if all data was successfully written to the file
  */
-void BinaryWriter::close() {
+bool BinaryWriter::close() {
+    bool success = true;
     if (_stream) {
-        flush();
-        SDL_RWclose(_stream);
+        if (_flusher) {
+            flush();
+            success = _flusher->wait();
+            _flusher->dispose();
+        } else {
+            size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
+            success = (amt == (size_t)_bufoff);
+            _bufoff = 0;
+        }
+        success = (SDL_RWclose(_stream) == 0) && success;
         _stream  = nullptr;
     }
     if (_cbuffer) {
         delete[] _cbuffer;
         _cbuffer = nullptr;
     }
+    if (_sbuffer) {
+        delete[] _sbuffer;
+        _sbuffer = nullptr;
+    }
+    return success;
+}
+
+/**
+ * Sets the byte order of the file.
+ *
+ * The value must be either SDL_BIG_ENDIAN or SDL_LIL_ENDIAN.  By default,
+ * all files are in network (big-endian) order.  Writing a file in the host
+ * byte order (SDL_BYTEORDER) needs no conversion, so arrays are copied
+ * directly.  The order may be changed at any time, and affects all
+ * subsequent writes.
+ *
+ * @param order The byte order of the file.
+ */
+void BinaryWriter::setByteOrder(int order) {
+    CUAssertLog(order == SDL_BIG_ENDIAN || order == SDL_LIL_ENDIAN, "Invalid byte order %d", order);
+    _byteorder = order;
 }
 
 
@@ -187,8 +343,9 @@ void BinaryWriter::writeUint8(Uint8 c) {
 /**
  * Writes a single 16 bit signed integer to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -202,16 +359,20 @@ void BinaryWriter::writeSint16(Sint16 n) {
         flush();
     }
     
-    Sint16* pointer = (Sint16*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint16 value = (Uint16)n;
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap16(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 2);
     _bufoff += 2;
 }
 
 /**
  * Writes a single 16 bit unsigned integer to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -225,16 +386,20 @@ void BinaryWriter::writeUint16(Uint16 n) {
         flush();
     }
     
-    Uint16* pointer = (Uint16*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint16 value = (Uint16)n;
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap16(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 2);
     _bufoff += 2;
 }
 
 /**
  * Writes a single 32 bit signed integer to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -248,16 +413,20 @@ void BinaryWriter::writeSint32(Sint32 n) {
         flush();
     }
     
-    Sint32* pointer = (Sint32*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint32 value = (Uint32)n;
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap32(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 4);
     _bufoff += 4;
 }
 
 /**
  * Writes a single 32 bit unsigned integer to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -271,16 +440,20 @@ void BinaryWriter::writeUint32(Uint32 n) {
         flush();
     }
     
-    Uint32* pointer = (Uint32*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint32 value = (Uint32)n;
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap32(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 4);
     _bufoff += 4;
 }
 
 /**
  * Writes a single 64 bit signed integer to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -294,16 +467,20 @@ void BinaryWriter::writeSint64(Sint64 n) {
         flush();
     }
     
-    Sint64* pointer = (Sint64*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint64 value = (Uint64)n;
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap64(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 8);
     _bufoff += 8;
 }
 
 /**
  * Writes a single 64 bit unsigned integer to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -317,8 +494,11 @@ void BinaryWriter::writeUint64(Uint64 n) {
         flush();
     }
     
-    Uint64* pointer = (Uint64*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint64 value = (Uint64)n;
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap64(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 8);
     _bufoff += 8;
 }
 
@@ -326,8 +506,9 @@ void BinaryWriter::writeUint64(Uint64 n) {
 /**
  * Writes a float to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -341,8 +522,12 @@ void BinaryWriter::writeFloat(float n) {
         flush();
     }
     
-    float* pointer = (float*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint32 value;
+    std::memcpy(&value, &n, 4);
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap32(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 4);
     _bufoff += 4;
 }
 
@@ -350,8 +535,9 @@ void BinaryWriter::writeFloat(float n) {
 /**
  * Writes a double to the binary file.
  *
- * The value is marshalled to network order, ensuring that the binary file
- * is compatible against all platforms.
+ * The value is marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The value is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -365,8 +551,12 @@ void BinaryWriter::writeDouble(double n) {
         flush();
     }
     
-    double* pointer = (double*)(&_cbuffer[_bufoff]);
-    *pointer = marshall(n);
+    Uint64 value;
+    std::memcpy(&value, &n, 8);
+    if (_byteorder != SDL_BYTEORDER) {
+        value = SDL_Swap64(value);
+    }
+    std::memcpy(&_cbuffer[_bufoff], &value, 8);
     _bufoff += 8;
 }
 
@@ -374,6 +564,40 @@ void BinaryWriter::writeDouble(double n) {
 
 #pragma mark -
 #pragma mark Array Writes
+/**
+ * Writes a sequence of elements of the given size to the stream.
+ *
+ * The bytes of each element are reversed if the file byte order is not
+ * the host byte order.  The elements are converted a buffer at a time,
+ * so there is no per-element work beyond the conversion itself.
+ *
+ * @param array     The array of elements to write
+ * @param length    The number of elements to write
+ * @param size      The number of bytes in a single element
+ */
+void BinaryWriter::writeArray(const void* array, size_t length, unsigned int size) {
+    const Uint8* input = (const Uint8*)array;
+    bool swap = _byteorder != SDL_BYTEORDER;
+    size_t total = 0;
+    while (total < length) {
+        size_t amount;
+        if (!_flusher && !swap && _bufoff == 0 && (length-total)*size >= _capacity) {
+            // Large writes in host order skip the buffer
+            amount = length-total;
+            size_t written = SDL_RWwrite(_stream, input+total*size, size, amount);
+            CUAssertLog(written == amount, "Unable to fully write the array");
+        } else {
+            if (_bufoff+size > _capacity) {
+                flush();
+            }
+            amount = std::min(length-total, (size_t)(_capacity-_bufoff)/size);
+            transfer(_cbuffer+_bufoff, input+total*size, amount, size, swap);
+            _bufoff += (Sint32)(amount*size);
+        }
+        total += amount;
+    }
+}
+
 /**
  * Writes an array of characters to the binary file.
  *
@@ -387,20 +611,7 @@ void BinaryWriter::writeDouble(double n) {
  */
 void BinaryWriter::write(const char* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    if (_bufoff+length > _capacity) {
-        flush();
-    }
-    while (length-pos > _capacity-_bufoff) {
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]),_capacity-_bufoff);
-        pos += _capacity-_bufoff;
-        _bufoff = _capacity;
-        flush();
-    }
-    
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), length-pos);
-    _bufoff += (Sint32)(length-pos);
+    writeArray(array+offset, length, 1);
 }
 
 /**
@@ -416,27 +627,15 @@ void BinaryWriter::write(const char* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint8* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-        
-    if (_bufoff+length > _capacity) {
-        flush();
-    }
-    while (length-pos > _capacity-_bufoff) {
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]),_capacity-_bufoff);
-        pos += _capacity-_bufoff;
-        _bufoff = _capacity;
-        flush();
-    }
-        
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), length-pos);
-    _bufoff += (Sint32)(length-pos);
+    writeArray(array+offset, length, 1);
 }
 
 /**
  * Writes an array of 16 bit signed integers to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -448,41 +647,15 @@ void BinaryWriter::write(const Uint8* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Sint16* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 2;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint16* ref = (Sint16*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint16* ref = (Sint16*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-
-    _bufoff += skip;
+    writeArray(array+offset, length, 2);
 }
 
 /**
  * Writes an array of 16 bit unsigned integers to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -494,41 +667,15 @@ void BinaryWriter::write(const Sint16* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint16* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 2;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint16* ref = (Uint16*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint16* ref = (Uint16*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 2);
 }
 
 /**
  * Writes an array of 32 bit signed integers to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -540,42 +687,16 @@ void BinaryWriter::write(const Uint16* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Sint32* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint32* ref = (Sint32*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint32* ref = (Sint32*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 4);
 }
 
 
 /**
  * Writes an array of 32 bit unsigned integers to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -587,42 +708,16 @@ void BinaryWriter::write(const Sint32* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint32* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint32* ref = (Uint32*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint32* ref = (Uint32*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 4);
 }
 
 
 /**
  * Writes an array of 64 bit signed integers to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -634,42 +729,16 @@ void BinaryWriter::write(const Uint32* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Sint64* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Sint64* ref = (Sint64*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Sint64* ref = (Sint64*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 8);
 }
 
 
 /**
  * Writes an array of 64 bit unsigned integers to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -681,42 +750,16 @@ void BinaryWriter::write(const Sint64* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const Uint64* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            Uint64* ref = (Uint64*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        Uint64* ref = (Uint64*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 8);
 }
 
 
 /**
  * Writes an array of floats to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -728,41 +771,15 @@ void BinaryWriter::write(const Uint64* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const float* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 4;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            float* ref = (float*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        float* ref = (float*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 4);
 }
 
 /**
  * Writes an array of doubles to the binary file.
  *
- * The values are marshalled to network order, ensuring that the binary
- * file is compatible against all platforms.
+ * The values are marshalled to the file byte order (network order by
+ * default), ensuring that the binary file is compatible against all
+ * platforms.
  *
  * The array is written to the internal buffer, but is not necessarily
  * flushed automatically.  It will be written when the buffer reaches
@@ -774,32 +791,5 @@ void BinaryWriter::write(const float* array, size_t length, size_t offset) {
  */
 void BinaryWriter::write(const double* array, size_t length, size_t offset) {
     CUAssertLog(_stream, "Attempt to write to a closed stream");
-    size_t pos = 0;
-    
-    unsigned int bytes = 8;
-    if (_bufoff+length*bytes > _capacity) {
-        flush();
-    }
-    while ((length-pos)*bytes > _capacity-_bufoff) {
-        unsigned int skip = bytes*((_capacity-_bufoff)/bytes);
-        memcpy(&(_cbuffer[_bufoff]), &(array[pos]),skip);
-        
-        for(int ii = 0; ii < skip; ii += bytes) {
-            double* ref = (double*)(&_cbuffer[_bufoff+ii]);
-            *ref = marshall(*ref);
-        }
-        
-        pos += skip/bytes;
-        _bufoff += skip;
-        flush();
-    }
-    
-    unsigned int skip = (unsigned int)((length-pos)*bytes);
-    memcpy(&(_cbuffer[_bufoff]), &(array[pos+offset]), skip);
-    for(int ii = 0; ii < skip; ii += bytes) {
-        double* ref = (double*)(&_cbuffer[_bufoff+ii]);
-        *ref = marshall(*ref);
-    }
-    
-    _bufoff += skip;
+    writeArray(array+offset, length, 8);
 }
@@ -13,6 +13,10 @@
 //  have proper file systems.  You should confine all files to either the asset
 //  or the save directory.
 //
+//  A writer may also be asynchronous.  An asynchronous writer is double
+//  buffered, and full buffers are written to the file on a background thread.
+//  This keeps large saves from stalling the game loop.
+//
 //  This class uses our standard shared-pointer architecture.
 //
 //  1. The constructor does not perform any initialization; it just sets all
@@ -49,6 +53,7 @@
 #include <cugl/io/CUTextWriter.h>
 #include <cugl/base/CUApplication.h>
 #include <cugl/util/CUDebug.h>
+#include <algorithm>
 #include <cstring>
 
 using namespace cugl;
@@ -95,6 +100,7 @@ bool TextWriter::init(const Pathname& file) {
 bool TextWriter::init(const Pathname& file, unsigned int capacity) {
     CUAssertLog(capacity, "The buffer capacity must be positive");
     _name = file.getAbsoluteName();
+    _flusher = nullptr;
     _stream = SDL_RWFromFile(_name.c_str(), "w");
     if (!_stream) {
         CULogError("%s", SDL_GetError());
@@ -108,6 +114,57 @@ bool TextWriter::init(const Pathname& file, unsigned int capacity) {
     return (bool)_cbuffer;
 }
 
+/**
+ * Initializes an asynchronous writer for the given file.
+ *
+ * The writer is double buffered.  Writes fill one buffer while a
+ * background thread writes the other buffer to the file.  Hence a flush
+ * only blocks if the previous buffer has not been written yet.
+ *
+ * Each buffer will have the default capacity for writing chunks to the
+ * file.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool TextWriter::initAsync(const Pathname& file) {
+    return initAsync(file,BUFFSIZE);
+}
+
+/**
+ * Initializes an asynchronous writer for the given file with the specified capacity.
+ *
+ * The writer is double buffered.  Writes fill one buffer while a
+ * background thread writes the other buffer to the file.  Hence a flush
+ * only blocks if the previous buffer has not been written yet.
+ *
+ * If the file is a relative path, this reader will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file      the path (absolute or relative) to the file
+ * @param capacity  the capacity of each buffer
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool TextWriter::initAsync(const Pathname& file, unsigned int capacity) {
+    if (!init(file,capacity)) {
+        return false;
+    }
+    _sbuffer = new char[_capacity];
+    _flusher = AsyncFlusher::alloc(_stream);
+    return _flusher != nullptr;
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -116,30 +173,86 @@ bool TextWriter::init(const Pathname& file, unsigned int capacity) {
  *
  * It is usually unnecessary to call this method. It is called automatically
  * when the buffer fills, or just before the file is closed.
+ *
+ * If this writer is asynchronous, the buffer is handed to the background
+ * thread and this method returns immediately (unless the previous buffer
+ * is still being written).  The data is not guaranteed to be in the file
+ * until a call to {@link sync} or {@link close}.
  */
 void TextWriter::flush() {
+    if (_flusher) {
+        // The spare buffer is free once the previous submission is done
+        _flusher->submit(_cbuffer, _bufoff);
+        std::swap(_cbuffer, _sbuffer);
+        _bufoff = 0;
+        return;
+    }
     size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
     CUAssertLog(amt == _bufoff, "Unable to fully flush the writer");
     _bufoff = 0;
 }
 
+/**
+ * Returns true if all data written so far is safely on the storage device.
+ *
+ * This method flushes the buffer and waits for any background writes to
+ * complete.  It then commits the file to the device (e.g. fsync), so that
+ * the data survives a crash or power failure.  This is slow, and should
+ * only be used at important save points.
+ *
+ * @return true if all data written so far is safely on the storage device.
+ */
+bool TextWriter::sync() {
+    CUAssertLog(_stream, "Attempt to sync a closed stream");
+    if (_flusher) {
+        _flusher->submit(_cbuffer, _bufoff, true);
+        std::swap(_cbuffer, _sbuffer);
+        _bufoff = 0;
+        return _flusher->wait();
+    }
+    size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
+    bool success = (amt == (size_t)_bufoff);
+    _bufoff = 0;
+    return AsyncFlusher::commit(_stream) && success;
+}
+
 /**
  * Closes the stream, releasing all resources
  *
  * The contents of the buffer are flushed before the file is closed.  Any
  * attempts to write to a closed stream will fail.  Calling this method
  * on a previously closed stream has no effect.
+ *
+ * If this writer is asynchronous, this method blocks until all background
+ * writes are complete.  The return value reports whether every write to
+ * the file (including those in the background) was successful.
+ *
+ * @return true if all data was successfully written to the file
  */
-void TextWriter::close() {
+bool TextWriter::close() {
+    bool success = true;
     if (_stream) {
-        flush();
-        SDL_RWclose(_stream);
+        if (_flusher) {
+            flush();
+            success = _flusher->wait();
+            _flusher->dispose();
+        } else {
+            size_t amt = SDL_RWwrite(_stream, _cbuffer, 1, _bufoff);
+            success = (amt == (size_t)_bufoff);
+            _bufoff = 0;
+        }
+        success = (SDL_RWclose(_stream) == 0) && success;
         _stream  = nullptr;
     }
     if (_cbuffer) {
         delete[] _cbuffer;
         _cbuffer = nullptr;
     }
+    if (_sbuffer) {
+        delete[] _sbuffer;
+        _sbuffer = nullptr;
+    }
+    return success;
 }
 
 
@@ -220,29 +333,37 @@ void TextWriter::write(const std::string& s) {
  * Writes a string (ASCII or UTF8) to the file, followed by a newline
  *
  * The newline used is a standard Unix newline '\n'. You should not expect
- * Windows-style carriage returns (e.g. '\r'). This method automatically
- * flushes the buffer when done.
+ * Windows-style carriage returns (e.g. '\r'). A synchronous writer
+ * automatically flushes the buffer when done.  An asynchronous writer
+ * only flushes when the buffer fills (or on {@link sync} or {@link close}),
+ * so that each line is not a separate background write.
  *
  * @param s  the string to write
  */
 void TextWriter::writeLine(const std::string& s) {
     write(s);
     write('\n');
-    flush();
+    if (!_flusher) {
+        flush();
+    }
 }
 
 /**
  * Writes a string (ASCII or UTF8) to the file, followed by a newline
  *
  * The newline used is a standard Unix newline '\n'. You should not expect
- * Windows-style carriage returns (e.g. '\r'). This method automatically
- * flushes the buffer when done.
+ * Windows-style carriage returns (e.g. '\r'). A synchronous writer
+ * automatically flushes the buffer when done.  An asynchronous writer
+ * only flushes when the buffer fills (or on {@link sync} or {@link close}),
+ * so that each line is not a separate background write.
  *
  * @param s  the string to write
  */
 void TextWriter::writeLine(const char* s) {
     write(s);
     write('\n');
-    flush();
+    if (!_flusher) {
+        flush();
+    }
 }
 
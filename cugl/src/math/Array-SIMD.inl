@@ -0,0 +1,661 @@
+//
+//  Array-SIMD.inl
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the vectorized kernels for the structure-of-arrays
+//  math classes (Vec2Array and Color4Array).  Each kernel works on one or two
+//  float lanes at a time, so the same kernels serve both positions and colors.
+//
+//  Unlike the Mat4 code, the instruction set is chosen at runtime.  Desktop
+//  builds target a baseline processor, but most machines that run them have
+//  AVX2.  So the AVX2 kernels are compiled with a function target attribute
+//  and only selected if SDL reports that the processor (and OS) support them.
+//  NEON is guaranteed on 64-bit ARM, so that choice is made at compile time.
+//
+//  All loads and stores are unaligned, so the arrays may be stored in any
+//  container.  The kernels do not use fused multiply-add, so that the results
+//  are identical to the scalar methods of Vec2 and Color4 (up to rounding of
+//  the color bytes at exactly one half).
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+#include <SDL/SDL.h>
+#include <cugl/math/CUColor4.h>
+
+#if defined CU_MATH_VECTOR_SSE
+    #include <immintrin.h>
+    #if defined (__GNUC__) || defined (__clang__)
+        #define CU_ARRAY_AVX2 __attribute__((target("avx2")))
+    #else
+        #define CU_ARRAY_AVX2
+    #endif
+#elif defined (__ARM_NEON) && (defined (__arm64__) || defined (__aarch64__))
+    #include <arm_neon.h>
+    #define CU_ARRAY_NEON
+#endif
+
+namespace cugl {
+
+/**
+ * The kernel table for the structure-of-arrays classes.
+ *
+ * All counts are in elements, and all strides are in 32-bit words.  Unless
+ * otherwise stated, it is safe for the destination to be the same as one
+ * of the sources.
+ */
+typedef struct {
+    /** dst = a*s + b*t */
+    void (*axpby)(float* dst, const float* a, float s, const float* b, float t, size_t n);
+    /** dst = a*s + c */
+    void (*madd)(float* dst, const float* a, float s, float c, size_t n);
+    /** dst = a*b */
+    void (*mul)(float* dst, const float* a, const float* b, size_t n);
+    /** (dx,dy) = (x*m00 + y*m01 + c0, x*m10 + y*m11 + c1) */
+    void (*linear)(float* dx, float* dy, const float* x, const float* y,
+                   float m00, float m01, float c0, float m10, float m11, float c1, size_t n);
+    /** dst = clamp(a, lo, hi) */
+    void (*clamp)(float* dst, const float* a, float lo, float hi, size_t n);
+    /** (x,y) = (x,y)/|(x,y)| when the length is not too small */
+    void (*normalize)(float* x, float* y, size_t n);
+    /** dst = ax*bx + ay*by */
+    void (*dot)(float* dst, const float* ax, const float* ay, const float* bx, const float* by, size_t n);
+    /** Writes (x,y) pairs every stride words (the destination may not alias) */
+    void (*interleave)(float* dst, size_t stride, const float* x, const float* y, size_t n);
+    /** Writes packed Color4 values every stride words (the destination may not alias) */
+    void (*pack)(Uint32* dst, size_t stride, const float* r, const float* g,
+                 const float* b, const float* a, size_t n);
+} ArrayKernels;
+
+
+#pragma mark -
+#pragma mark Scalar Kernels
+/** dst = a*s + b*t */
+static void scalar_axpby(float* dst, const float* a, float s, const float* b, float t, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        dst[ii] = a[ii]*s+b[ii]*t;
+    }
+}
+
+/** dst = a*s + c */
+static void scalar_madd(float* dst, const float* a, float s, float c, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        dst[ii] = a[ii]*s+c;
+    }
+}
+
+/** dst = a*b */
+static void scalar_mul(float* dst, const float* a, const float* b, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        dst[ii] = a[ii]*b[ii];
+    }
+}
+
+/** (dx,dy) = (x*m00 + y*m01 + c0, x*m10 + y*m11 + c1) */
+static void scalar_linear(float* dx, float* dy, const float* x, const float* y,
+                          float m00, float m01, float c0, float m10, float m11, float c1, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        float vx = x[ii];
+        float vy = y[ii];
+        dx[ii] = vx*m00+vy*m01+c0;
+        dy[ii] = vx*m10+vy*m11+c1;
+    }
+}
+
+/** dst = clamp(a, lo, hi) */
+static void scalar_clamp(float* dst, const float* a, float lo, float hi, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        dst[ii] = clampf(a[ii],lo,hi);
+    }
+}
+
+/** (x,y) = (x,y)/|(x,y)| when the length is not too small */
+static void scalar_normalize(float* x, float* y, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        float len = sqrtf(x[ii]*x[ii]+y[ii]*y[ii]);
+        if (len >= CU_MATH_FLOAT_SMALL) {
+            float inv = 1.0f/len;
+            x[ii] *= inv;
+            y[ii] *= inv;
+        }
+    }
+}
+
+/** dst = ax*bx + ay*by */
+static void scalar_dot(float* dst, const float* ax, const float* ay, const float* bx, const float* by, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        dst[ii] = ax[ii]*bx[ii]+ay[ii]*by[ii];
+    }
+}
+
+/** Writes (x,y) pairs every stride words */
+static void scalar_interleave(float* dst, size_t stride, const float* x, const float* y, size_t n) {
+    for(size_t ii = 0; ii < n; ii++) {
+        dst[ii*stride  ] = x[ii];
+        dst[ii*stride+1] = y[ii];
+    }
+}
+
+/** Writes packed Color4 values every stride words */
+static void scalar_pack(Uint32* dst, size_t stride, const float* r, const float* g,
+                        const float* b, const float* a, size_t n) {
+    Color4 c;
+    for(size_t ii = 0; ii < n; ii++) {
+        c.r = COLOR_FLOAT_TO_BYTE(clampf(r[ii],0.0f,1.0f));
+        c.g = COLOR_FLOAT_TO_BYTE(clampf(g[ii],0.0f,1.0f));
+        c.b = COLOR_FLOAT_TO_BYTE(clampf(b[ii],0.0f,1.0f));
+        c.a = COLOR_FLOAT_TO_BYTE(clampf(a[ii],0.0f,1.0f));
+        dst[ii*stride] = c.rgba;
+    }
+}
+
+/** The scalar kernel table (the fallback on all platforms) */
+static const ArrayKernels SCALAR_KERNELS = {
+    scalar_axpby, scalar_madd, scalar_mul, scalar_linear, scalar_clamp,
+    scalar_normalize, scalar_dot, scalar_interleave, scalar_pack
+};
+
+
+#if defined CU_MATH_VECTOR_SSE
+#pragma mark -
+#pragma mark SSE2 Kernels
+/** dst = a*s + b*t */
+static void sse_axpby(float* dst, const float* a, float s, const float* b, float t, size_t n) {
+    __m128 vs = _mm_set1_ps(s);
+    __m128 vt = _mm_set1_ps(t);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        __m128 va = _mm_mul_ps(_mm_loadu_ps(a+ii),vs);
+        __m128 vb = _mm_mul_ps(_mm_loadu_ps(b+ii),vt);
+        _mm_storeu_ps(dst+ii,_mm_add_ps(va,vb));
+    }
+    scalar_axpby(dst+ii,a+ii,s,b+ii,t,n-ii);
+}
+
+/** dst = a*s + c */
+static void sse_madd(float* dst, const float* a, float s, float c, size_t n) {
+    __m128 vs = _mm_set1_ps(s);
+    __m128 vc = _mm_set1_ps(c);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        _mm_storeu_ps(dst+ii,_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a+ii),vs),vc));
+    }
+    scalar_madd(dst+ii,a+ii,s,c,n-ii);
+}
+
+/** dst = a*b */
+static void sse_mul(float* dst, const float* a, const float* b, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        _mm_storeu_ps(dst+ii,_mm_mul_ps(_mm_loadu_ps(a+ii),_mm_loadu_ps(b+ii)));
+    }
+    scalar_mul(dst+ii,a+ii,b+ii,n-ii);
+}
+
+/** (dx,dy) = (x*m00 + y*m01 + c0, x*m10 + y*m11 + c1) */
+static void sse_linear(float* dx, float* dy, const float* x, const float* y,
+                       float m00, float m01, float c0, float m10, float m11, float c1, size_t n) {
+    __m128 a00 = _mm_set1_ps(m00);
+    __m128 a01 = _mm_set1_ps(m01);
+    __m128 a10 = _mm_set1_ps(m10);
+    __m128 a11 = _mm_set1_ps(m11);
+    __m128 b0  = _mm_set1_ps(c0);
+    __m128 b1  = _mm_set1_ps(c1);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        __m128 vx = _mm_loadu_ps(x+ii);
+        __m128 vy = _mm_loadu_ps(y+ii);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx,a00),_mm_mul_ps(vy,a01)),b0);
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx,a10),_mm_mul_ps(vy,a11)),b1);
+        _mm_storeu_ps(dx+ii,rx);
+        _mm_storeu_ps(dy+ii,ry);
+    }
+    scalar_linear(dx+ii,dy+ii,x+ii,y+ii,m00,m01,c0,m10,m11,c1,n-ii);
+}
+
+/** dst = clamp(a, lo, hi) */
+static void sse_clamp(float* dst, const float* a, float lo, float hi, size_t n) {
+    __m128 vlo = _mm_set1_ps(lo);
+    __m128 vhi = _mm_set1_ps(hi);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        _mm_storeu_ps(dst+ii,_mm_min_ps(_mm_max_ps(_mm_loadu_ps(a+ii),vlo),vhi));
+    }
+    scalar_clamp(dst+ii,a+ii,lo,hi,n-ii);
+}
+
+/** (x,y) = (x,y)/|(x,y)| when the length is not too small */
+static void sse_normalize(float* x, float* y, size_t n) {
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 small = _mm_set1_ps(CU_MATH_FLOAT_SMALL);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        __m128 vx = _mm_loadu_ps(x+ii);
+        __m128 vy = _mm_loadu_ps(y+ii);
+        __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx,vx),_mm_mul_ps(vy,vy)));
+        __m128 mask = _mm_cmpge_ps(len,small);
+        __m128 inv = _mm_div_ps(one,len);
+        inv = _mm_or_ps(_mm_and_ps(mask,inv),_mm_andnot_ps(mask,one));
+        _mm_storeu_ps(x+ii,_mm_mul_ps(vx,inv));
+        _mm_storeu_ps(y+ii,_mm_mul_ps(vy,inv));
+    }
+    scalar_normalize(x+ii,y+ii,n-ii);
+}
+
+/** dst = ax*bx + ay*by */
+static void sse_dot(float* dst, const float* ax, const float* ay, const float* bx, const float* by, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        __m128 vx = _mm_mul_ps(_mm_loadu_ps(ax+ii),_mm_loadu_ps(bx+ii));
+        __m128 vy = _mm_mul_ps(_mm_loadu_ps(ay+ii),_mm_loadu_ps(by+ii));
+        _mm_storeu_ps(dst+ii,_mm_add_ps(vx,vy));
+    }
+    scalar_dot(dst+ii,ax+ii,ay+ii,bx+ii,by+ii,n-ii);
+}
+
+/** Writes (x,y) pairs every stride words */
+static void sse_interleave(float* dst, size_t stride, const float* x, const float* y, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        __m128 vx = _mm_loadu_ps(x+ii);
+        __m128 vy = _mm_loadu_ps(y+ii);
+        __m128 lo = _mm_unpacklo_ps(vx,vy);
+        __m128 hi = _mm_unpackhi_ps(vx,vy);
+        if (stride == 2) {
+            _mm_storeu_ps(dst+2*ii  ,lo);
+            _mm_storeu_ps(dst+2*ii+4,hi);
+        } else {
+            _mm_storel_pi((__m64*)(dst+(ii  )*stride),lo);
+            _mm_storeh_pi((__m64*)(dst+(ii+1)*stride),lo);
+            _mm_storel_pi((__m64*)(dst+(ii+2)*stride),hi);
+            _mm_storeh_pi((__m64*)(dst+(ii+3)*stride),hi);
+        }
+    }
+    scalar_interleave(dst+ii*stride,stride,x+ii,y+ii,n-ii);
+}
+
+/**
+ * Returns the four floats converted to color bytes (in 32-bit lanes)
+ *
+ * @param v The floats to convert
+ *
+ * @return the four floats converted to color bytes (in 32-bit lanes)
+ */
+static inline __m128i sse_byte(__m128 v) {
+    v = _mm_min_ps(_mm_max_ps(v,_mm_setzero_ps()),_mm_set1_ps(1.0f));
+    v = _mm_add_ps(_mm_mul_ps(v,_mm_set1_ps(255.0f)),_mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(v);
+}
+
+/** Writes packed Color4 values every stride words (x86 is little-endian) */
+static void sse_pack(Uint32* dst, size_t stride, const float* r, const float* g,
+                     const float* b, const float* a, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        __m128i rgba = sse_byte(_mm_loadu_ps(r+ii));
+        rgba = _mm_or_si128(rgba,_mm_slli_epi32(sse_byte(_mm_loadu_ps(g+ii)), 8));
+        rgba = _mm_or_si128(rgba,_mm_slli_epi32(sse_byte(_mm_loadu_ps(b+ii)),16));
+        rgba = _mm_or_si128(rgba,_mm_slli_epi32(sse_byte(_mm_loadu_ps(a+ii)),24));
+        if (stride == 1) {
+            _mm_storeu_si128((__m128i*)(dst+ii),rgba);
+        } else {
+            Uint32 temp[4];
+            _mm_storeu_si128((__m128i*)temp,rgba);
+            for(size_t jj = 0; jj < 4; jj++) {
+                dst[(ii+jj)*stride] = temp[jj];
+            }
+        }
+    }
+    scalar_pack(dst+ii*stride,stride,r+ii,g+ii,b+ii,a+ii,n-ii);
+}
+
+/** The SSE2 kernel table */
+static const ArrayKernels SSE_KERNELS = {
+    sse_axpby, sse_madd, sse_mul, sse_linear, sse_clamp,
+    sse_normalize, sse_dot, sse_interleave, sse_pack
+};
+
+
+#pragma mark -
+#pragma mark AVX2 Kernels
+/** dst = a*s + b*t */
+CU_ARRAY_AVX2 static void avx2_axpby(float* dst, const float* a, float s, const float* b, float t, size_t n) {
+    __m256 vs = _mm256_set1_ps(s);
+    __m256 vt = _mm256_set1_ps(t);
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        __m256 va = _mm256_mul_ps(_mm256_loadu_ps(a+ii),vs);
+        __m256 vb = _mm256_mul_ps(_mm256_loadu_ps(b+ii),vt);
+        _mm256_storeu_ps(dst+ii,_mm256_add_ps(va,vb));
+    }
+    scalar_axpby(dst+ii,a+ii,s,b+ii,t,n-ii);
+}
+
+/** dst = a*s + c */
+CU_ARRAY_AVX2 static void avx2_madd(float* dst, const float* a, float s, float c, size_t n) {
+    __m256 vs = _mm256_set1_ps(s);
+    __m256 vc = _mm256_set1_ps(c);
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        _mm256_storeu_ps(dst+ii,_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(a+ii),vs),vc));
+    }
+    scalar_madd(dst+ii,a+ii,s,c,n-ii);
+}
+
+/** dst = a*b */
+CU_ARRAY_AVX2 static void avx2_mul(float* dst, const float* a, const float* b, size_t n) {
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        _mm256_storeu_ps(dst+ii,_mm256_mul_ps(_mm256_loadu_ps(a+ii),_mm256_loadu_ps(b+ii)));
+    }
+    scalar_mul(dst+ii,a+ii,b+ii,n-ii);
+}
+
+/** (dx,dy) = (x*m00 + y*m01 + c0, x*m10 + y*m11 + c1) */
+CU_ARRAY_AVX2 static void avx2_linear(float* dx, float* dy, const float* x, const float* y,
+                                      float m00, float m01, float c0, float m10, float m11, float c1, size_t n) {
+    __m256 a00 = _mm256_set1_ps(m00);
+    __m256 a01 = _mm256_set1_ps(m01);
+    __m256 a10 = _mm256_set1_ps(m10);
+    __m256 a11 = _mm256_set1_ps(m11);
+    __m256 b0  = _mm256_set1_ps(c0);
+    __m256 b1  = _mm256_set1_ps(c1);
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        __m256 vx = _mm256_loadu_ps(x+ii);
+        __m256 vy = _mm256_loadu_ps(y+ii);
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx,a00),_mm256_mul_ps(vy,a01)),b0);
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx,a10),_mm256_mul_ps(vy,a11)),b1);
+        _mm256_storeu_ps(dx+ii,rx);
+        _mm256_storeu_ps(dy+ii,ry);
+    }
+    scalar_linear(dx+ii,dy+ii,x+ii,y+ii,m00,m01,c0,m10,m11,c1,n-ii);
+}
+
+/** dst = clamp(a, lo, hi) */
+CU_ARRAY_AVX2 static void avx2_clamp(float* dst, const float* a, float lo, float hi, size_t n) {
+    __m256 vlo = _mm256_set1_ps(lo);
+    __m256 vhi = _mm256_set1_ps(hi);
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        _mm256_storeu_ps(dst+ii,_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(a+ii),vlo),vhi));
+    }
+    scalar_clamp(dst+ii,a+ii,lo,hi,n-ii);
+}
+
+/** (x,y) = (x,y)/|(x,y)| when the length is not too small */
+CU_ARRAY_AVX2 static void avx2_normalize(float* x, float* y, size_t n) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 small = _mm256_set1_ps(CU_MATH_FLOAT_SMALL);
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        __m256 vx = _mm256_loadu_ps(x+ii);
+        __m256 vy = _mm256_loadu_ps(y+ii);
+        __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx,vx),_mm256_mul_ps(vy,vy)));
+        __m256 mask = _mm256_cmp_ps(len,small,_CMP_GE_OQ);
+        __m256 inv = _mm256_blendv_ps(one,_mm256_div_ps(one,len),mask);
+        _mm256_storeu_ps(x+ii,_mm256_mul_ps(vx,inv));
+        _mm256_storeu_ps(y+ii,_mm256_mul_ps(vy,inv));
+    }
+    scalar_normalize(x+ii,y+ii,n-ii);
+}
+
+/** dst = ax*bx + ay*by */
+CU_ARRAY_AVX2 static void avx2_dot(float* dst, const float* ax, const float* ay,
+                                   const float* bx, const float* by, size_t n) {
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        __m256 vx = _mm256_mul_ps(_mm256_loadu_ps(ax+ii),_mm256_loadu_ps(bx+ii));
+        __m256 vy = _mm256_mul_ps(_mm256_loadu_ps(ay+ii),_mm256_loadu_ps(by+ii));
+        _mm256_storeu_ps(dst+ii,_mm256_add_ps(vx,vy));
+    }
+    scalar_dot(dst+ii,ax+ii,ay+ii,bx+ii,by+ii,n-ii);
+}
+
+/**
+ * Returns the eight floats converted to color bytes (in 32-bit lanes)
+ *
+ * @param v The floats to convert
+ *
+ * @return the eight floats converted to color bytes (in 32-bit lanes)
+ */
+CU_ARRAY_AVX2 static inline __m256i avx2_byte(__m256 v) {
+    v = _mm256_min_ps(_mm256_max_ps(v,_mm256_setzero_ps()),_mm256_set1_ps(1.0f));
+    v = _mm256_add_ps(_mm256_mul_ps(v,_mm256_set1_ps(255.0f)),_mm256_set1_ps(0.5f));
+    return _mm256_cvttps_epi32(v);
+}
+
+/** Writes packed Color4 values every stride words (x86 is little-endian) */
+CU_ARRAY_AVX2 static void avx2_pack(Uint32* dst, size_t stride, const float* r, const float* g,
+                                    const float* b, const float* a, size_t n) {
+    size_t ii = 0;
+    for(; ii+8 <= n; ii += 8) {
+        __m256i rgba = avx2_byte(_mm256_loadu_ps(r+ii));
+        rgba = _mm256_or_si256(rgba,_mm256_slli_epi32(avx2_byte(_mm256_loadu_ps(g+ii)), 8));
+        rgba = _mm256_or_si256(rgba,_mm256_slli_epi32(avx2_byte(_mm256_loadu_ps(b+ii)),16));
+        rgba = _mm256_or_si256(rgba,_mm256_slli_epi32(avx2_byte(_mm256_loadu_ps(a+ii)),24));
+        if (stride == 1) {
+            _mm256_storeu_si256((__m256i*)(dst+ii),rgba);
+        } else {
+            Uint32 temp[8];
+            _mm256_storeu_si256((__m256i*)temp,rgba);
+            for(size_t jj = 0; jj < 8; jj++) {
+                dst[(ii+jj)*stride] = temp[jj];
+            }
+        }
+    }
+    scalar_pack(dst+ii*stride,stride,r+ii,g+ii,b+ii,a+ii,n-ii);
+}
+
+/** The AVX2 kernel table (interleaving is store bound, so it stays SSE) */
+static const ArrayKernels AVX2_KERNELS = {
+    avx2_axpby, avx2_madd, avx2_mul, avx2_linear, avx2_clamp,
+    avx2_normalize, avx2_dot, sse_interleave, avx2_pack
+};
+
+
+#elif defined CU_ARRAY_NEON
+#pragma mark -
+#pragma mark NEON Kernels
+/** dst = a*s + b*t */
+static void neon_axpby(float* dst, const float* a, float s, const float* b, float t, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        float32x4_t va = vmulq_n_f32(vld1q_f32(a+ii),s);
+        float32x4_t vb = vmulq_n_f32(vld1q_f32(b+ii),t);
+        vst1q_f32(dst+ii,vaddq_f32(va,vb));
+    }
+    scalar_axpby(dst+ii,a+ii,s,b+ii,t,n-ii);
+}
+
+/** dst = a*s + c */
+static void neon_madd(float* dst, const float* a, float s, float c, size_t n) {
+    float32x4_t vc = vdupq_n_f32(c);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        vst1q_f32(dst+ii,vaddq_f32(vmulq_n_f32(vld1q_f32(a+ii),s),vc));
+    }
+    scalar_madd(dst+ii,a+ii,s,c,n-ii);
+}
+
+/** dst = a*b */
+static void neon_mul(float* dst, const float* a, const float* b, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        vst1q_f32(dst+ii,vmulq_f32(vld1q_f32(a+ii),vld1q_f32(b+ii)));
+    }
+    scalar_mul(dst+ii,a+ii,b+ii,n-ii);
+}
+
+/** (dx,dy) = (x*m00 + y*m01 + c0, x*m10 + y*m11 + c1) */
+static void neon_linear(float* dx, float* dy, const float* x, const float* y,
+                        float m00, float m01, float c0, float m10, float m11, float c1, size_t n) {
+    float32x4_t b0 = vdupq_n_f32(c0);
+    float32x4_t b1 = vdupq_n_f32(c1);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        float32x4_t vx = vld1q_f32(x+ii);
+        float32x4_t vy = vld1q_f32(y+ii);
+        float32x4_t rx = vaddq_f32(vaddq_f32(vmulq_n_f32(vx,m00),vmulq_n_f32(vy,m01)),b0);
+        float32x4_t ry = vaddq_f32(vaddq_f32(vmulq_n_f32(vx,m10),vmulq_n_f32(vy,m11)),b1);
+        vst1q_f32(dx+ii,rx);
+        vst1q_f32(dy+ii,ry);
+    }
+    scalar_linear(dx+ii,dy+ii,x+ii,y+ii,m00,m01,c0,m10,m11,c1,n-ii);
+}
+
+/** dst = clamp(a, lo, hi) */
+static void neon_clamp(float* dst, const float* a, float lo, float hi, size_t n) {
+    float32x4_t vlo = vdupq_n_f32(lo);
+    float32x4_t vhi = vdupq_n_f32(hi);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        vst1q_f32(dst+ii,vminq_f32(vmaxq_f32(vld1q_f32(a+ii),vlo),vhi));
+    }
+    scalar_clamp(dst+ii,a+ii,lo,hi,n-ii);
+}
+
+/** (x,y) = (x,y)/|(x,y)| when the length is not too small */
+static void neon_normalize(float* x, float* y, size_t n) {
+    float32x4_t one = vdupq_n_f32(1.0f);
+    float32x4_t small = vdupq_n_f32(CU_MATH_FLOAT_SMALL);
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        float32x4_t vx = vld1q_f32(x+ii);
+        float32x4_t vy = vld1q_f32(y+ii);
+        float32x4_t len = vsqrtq_f32(vaddq_f32(vmulq_f32(vx,vx),vmulq_f32(vy,vy)));
+        uint32x4_t mask = vcgeq_f32(len,small);
+        float32x4_t inv = vbslq_f32(mask,vdivq_f32(one,len),one);
+        vst1q_f32(x+ii,vmulq_f32(vx,inv));
+        vst1q_f32(y+ii,vmulq_f32(vy,inv));
+    }
+    scalar_normalize(x+ii,y+ii,n-ii);
+}
+
+/** dst = ax*bx + ay*by */
+static void neon_dot(float* dst, const float* ax, const float* ay, const float* bx, const float* by, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        float32x4_t vx = vmulq_f32(vld1q_f32(ax+ii),vld1q_f32(bx+ii));
+        float32x4_t vy = vmulq_f32(vld1q_f32(ay+ii),vld1q_f32(by+ii));
+        vst1q_f32(dst+ii,vaddq_f32(vx,vy));
+    }
+    scalar_dot(dst+ii,ax+ii,ay+ii,bx+ii,by+ii,n-ii);
+}
+
+/** Writes (x,y) pairs every stride words */
+static void neon_interleave(float* dst, size_t stride, const float* x, const float* y, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        float32x4x2_t pair;
+        pair.val[0] = vld1q_f32(x+ii);
+        pair.val[1] = vld1q_f32(y+ii);
+        if (stride == 2) {
+            vst2q_f32(dst+2*ii,pair);
+        } else {
+            float32x4x2_t zip = vzipq_f32(pair.val[0],pair.val[1]);
+            vst1_f32(dst+(ii  )*stride,vget_low_f32(zip.val[0]));
+            vst1_f32(dst+(ii+1)*stride,vget_high_f32(zip.val[0]));
+            vst1_f32(dst+(ii+2)*stride,vget_low_f32(zip.val[1]));
+            vst1_f32(dst+(ii+3)*stride,vget_high_f32(zip.val[1]));
+        }
+    }
+    scalar_interleave(dst+ii*stride,stride,x+ii,y+ii,n-ii);
+}
+
+/**
+ * Returns the four floats converted to color bytes (in 32-bit lanes)
+ *
+ * @param v The floats to convert
+ *
+ * @return the four floats converted to color bytes (in 32-bit lanes)
+ */
+static inline uint32x4_t neon_byte(float32x4_t v) {
+    v = vminq_f32(vmaxq_f32(v,vdupq_n_f32(0.0f)),vdupq_n_f32(1.0f));
+    v = vaddq_f32(vmulq_n_f32(v,255.0f),vdupq_n_f32(0.5f));
+    return vcvtq_u32_f32(v);
+}
+
+/** Writes packed Color4 values every stride words (ARM is little-endian) */
+static void neon_pack(Uint32* dst, size_t stride, const float* r, const float* g,
+                      const float* b, const float* a, size_t n) {
+    size_t ii = 0;
+    for(; ii+4 <= n; ii += 4) {
+        uint32x4_t rgba = neon_byte(vld1q_f32(r+ii));
+        rgba = vorrq_u32(rgba,vshlq_n_u32(neon_byte(vld1q_f32(g+ii)), 8));
+        rgba = vorrq_u32(rgba,vshlq_n_u32(neon_byte(vld1q_f32(b+ii)),16));
+        rgba = vorrq_u32(rgba,vshlq_n_u32(neon_byte(vld1q_f32(a+ii)),24));
+        if (stride == 1) {
+            vst1q_u32(dst+ii,rgba);
+        } else {
+            Uint32 temp[4];
+            vst1q_u32(temp,rgba);
+            for(size_t jj = 0; jj < 4; jj++) {
+                dst[(ii+jj)*stride] = temp[jj];
+            }
+        }
+    }
+    scalar_pack(dst+ii*stride,stride,r+ii,g+ii,b+ii,a+ii,n-ii);
+}
+
+/** The NEON kernel table */
+static const ArrayKernels NEON_KERNELS = {
+    neon_axpby, neon_madd, neon_mul, neon_linear, neon_clamp,
+    neon_normalize, neon_dot, neon_interleave, neon_pack
+};
+#endif
+
+
+#pragma mark -
+#pragma mark Dispatch
+/**
+ * Returns the best kernel table for this processor.
+ *
+ * This function queries the processor, so it should only be called once.
+ *
+ * @return the best kernel table for this processor.
+ */
+static const ArrayKernels* array_select() {
+#if defined CU_MATH_VECTOR_SSE
+    if (SDL_HasAVX2()) {
+        return &AVX2_KERNELS;
+    } else if (SDL_HasSSE2()) {
+        return &SSE_KERNELS;
+    }
+#elif defined CU_ARRAY_NEON
+    return &NEON_KERNELS;
+#endif
+    return &SCALAR_KERNELS;
+}
+
+/**
+ * Returns the kernel table for this processor.
+ *
+ * The table is chosen the first time this function is called.
+ *
+ * @return the kernel table for this processor.
+ */
+static const ArrayKernels* array_kernels() {
+    static const ArrayKernels* kernels = array_select();
+    return kernels;
+}
+
+}
@@ -43,6 +43,11 @@
 #include <cugl/math/CUAffine2.h>
 #include <cugl/util/CUStrings.h>
 #include <cugl/math/CUMat4.h>
+#if defined CU_MATH_VECTOR_AVX2
+    #include <immintrin.h>
+#elif defined CU_MATH_VECTOR_SSE
+    #include <xmmintrin.h>
+#endif
 
 using namespace cugl;
 
@@ -576,6 +581,63 @@ Vec2* Affine2::transform(const Affine2& aff, const Vec2& point, Vec2* dst) {
     return dst;
 }
 
+/**
+ * Transforms the array of points and stores the result in output.
+ *
+ * The output array must have room for size elements.  It is safe for
+ * output to be the same as input (to transform the points in place),
+ * but the arrays may not otherwise overlap.
+ *
+ * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+ * than transforming the points one at a time.
+ *
+ * @param aff       The affine transform.
+ * @param input     The points to transform.
+ * @param size      The number of points to transform.
+ * @param output    The array to store the transformed points.
+ *
+ * @return A reference to output for chaining
+ */
+Vec2* Affine2::transform(const Affine2& aff, const Vec2* input, size_t size, Vec2* output) {
+    CUAssertLog(output || !size, "Destination array is null");
+    const float* src = reinterpret_cast<const float*>(input);
+    float* dst = reinterpret_cast<float*>(output);
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    // Four points per register: (x0, y0, x1, y1, x2, y2, x3, y3)
+    __m256 cx = _mm256_setr_ps(aff.m[0], aff.m[2], aff.m[0], aff.m[2],
+                               aff.m[0], aff.m[2], aff.m[0], aff.m[2]);
+    __m256 cy = _mm256_setr_ps(aff.m[1], aff.m[3], aff.m[1], aff.m[3],
+                               aff.m[1], aff.m[3], aff.m[1], aff.m[3]);
+    __m256 ct = _mm256_setr_ps(aff.offset.x, aff.offset.y, aff.offset.x, aff.offset.y,
+                               aff.offset.x, aff.offset.y, aff.offset.x, aff.offset.y);
+    for(; ii+4 <= size; ii += 4) {
+        __m256 v = _mm256_loadu_ps(src+2*ii);
+        __m256 x = _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 0, 0));
+        __m256 y = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 1, 1));
+        _mm256_storeu_ps(dst+2*ii, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, x), _mm256_mul_ps(cy, y)), ct));
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    // Two points per register: (x0, y0, x1, y1)
+    __m128 cx = _mm_setr_ps(aff.m[0], aff.m[2], aff.m[0], aff.m[2]);
+    __m128 cy = _mm_setr_ps(aff.m[1], aff.m[3], aff.m[1], aff.m[3]);
+    __m128 ct = _mm_setr_ps(aff.offset.x, aff.offset.y, aff.offset.x, aff.offset.y);
+    for(; ii+2 <= size; ii += 2) {
+        __m128 v = _mm_loadu_ps(src+2*ii);
+        __m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+        _mm_storeu_ps(dst+2*ii, _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, x), _mm_mul_ps(cy, y)), ct));
+    }
+#endif
+    for(; ii < size; ii++) {
+        float x = src[2*ii];
+        float y = src[2*ii+1];
+        dst[2*ii  ] = aff.m[0]*x+aff.m[1]*y+aff.offset.x;
+        dst[2*ii+1] = aff.m[2]*x+aff.m[3]*y+aff.offset.y;
+    }
+    return output;
+}
+
 /**
  * Transforms the rectangle and stores the result in dst.
  *
@@ -0,0 +1,383 @@
+//
+//  CUColor4Array.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for a structure-of-arrays collection of
+//  colors.  It is the companion to Vec2Array, and is intended for particle
+//  systems and procedural meshes that fade or tint thousands of vertices each
+//  frame.  The color channels are stored as floats in separate arrays, so that
+//  the bulk operations can process 4 (SSE2, NEON) or 8 (AVX2) colors at once.
+//
+//  The instruction set is chosen at runtime the first time that a bulk
+//  operation is used.  The results are the same as the Color4f methods.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+#include <cugl/util/CUDebug.h>
+#include <cugl/math/CUColor4Array.h>
+#include <cugl/renderer/CUVertex.h>
+#include "Array-SIMD.inl"
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Setters
+/**
+ * Sets this array to a copy of the given colors.
+ *
+ * @param colors    The colors to copy
+ * @param size      The number of colors to copy
+ *
+ * @return This array, after assignment
+ */
+Color4Array& Color4Array::set(const Color4f* colors, size_t size) {
+    CUAssertLog(colors || !size, "Source array is null");
+    resize(size);
+    for(size_t ii = 0; ii < size; ii++) {
+        _r[ii] = colors[ii].r;
+        _g[ii] = colors[ii].g;
+        _b[ii] = colors[ii].b;
+        _a[ii] = colors[ii].a;
+    }
+    return *this;
+}
+
+/**
+ * Sets this array to a copy of the given colors.
+ *
+ * The colors are converted to floats in the range [0,1].
+ *
+ * @param colors    The colors to copy
+ * @param size      The number of colors to copy
+ *
+ * @return This array, after assignment
+ */
+Color4Array& Color4Array::set(const Color4* colors, size_t size) {
+    CUAssertLog(colors || !size, "Source array is null");
+    resize(size);
+    for(size_t ii = 0; ii < size; ii++) {
+        _r[ii] = COLOR_BYTE_TO_FLOAT(colors[ii].r);
+        _g[ii] = COLOR_BYTE_TO_FLOAT(colors[ii].g);
+        _b[ii] = COLOR_BYTE_TO_FLOAT(colors[ii].b);
+        _a[ii] = COLOR_BYTE_TO_FLOAT(colors[ii].a);
+    }
+    return *this;
+}
+
+/**
+ * Sets every element of this array to the given color.
+ *
+ * The size of this array is unchanged.
+ *
+ * @param c     The color value
+ *
+ * @return This array, after assignment
+ */
+Color4Array& Color4Array::fill(const Color4f& c) {
+    std::fill(_r.begin(),_r.end(),c.r);
+    std::fill(_g.begin(),_g.end(),c.g);
+    std::fill(_b.begin(),_b.end(),c.b);
+    std::fill(_a.begin(),_a.end(),c.a);
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Element Access
+/**
+ * Resizes this array to hold size colors.
+ *
+ * New colors are initialized to clear.
+ *
+ * @param size  The new number of colors
+ */
+void Color4Array::resize(size_t size) {
+    _r.resize(size,0.0f);
+    _g.resize(size,0.0f);
+    _b.resize(size,0.0f);
+    _a.resize(size,0.0f);
+}
+
+/**
+ * Reserves room for at least capacity colors.
+ *
+ * @param capacity  The number of colors to reserve
+ */
+void Color4Array::reserve(size_t capacity) {
+    _r.reserve(capacity);
+    _g.reserve(capacity);
+    _b.reserve(capacity);
+    _a.reserve(capacity);
+}
+
+/**
+ * Removes all colors from this array.
+ */
+void Color4Array::clear() {
+    _r.clear();
+    _g.clear();
+    _b.clear();
+    _a.clear();
+}
+
+/**
+ * Removes the element at the given position, replacing it with the last.
+ *
+ * This is the standard way to kill a particle in O(1) time.  It does not
+ * preserve the order of the elements.
+ *
+ * @param index The position to remove
+ */
+void Color4Array::swapRemove(size_t index) {
+    CUAssertLog(index < _r.size(), "Index %zu is out of bounds", index);
+    _r[index] = _r.back(); _r.pop_back();
+    _g[index] = _g.back(); _g.pop_back();
+    _b[index] = _b.back(); _b.pop_back();
+    _a[index] = _a.back(); _a.pop_back();
+}
+
+
+#pragma mark -
+#pragma mark Arithmetic
+/**
+ * Adds the given color to every element of this array.
+ *
+ * The channels are clamped to [0,1].  Alpha is only added if the
+ * parameter alpha is true.
+ *
+ * @param c         The color to add
+ * @param alpha     Whether to add the alpha value
+ *
+ * @return This array, after the addition
+ */
+Color4Array& Color4Array::add(const Color4f& c, bool alpha) {
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    kernels->madd(_r.data(),_r.data(),1.0f,c.r,size);
+    kernels->madd(_g.data(),_g.data(),1.0f,c.g,size);
+    kernels->madd(_b.data(),_b.data(),1.0f,c.b,size);
+    if (alpha) {
+        kernels->madd(_a.data(),_a.data(),1.0f,c.a,size);
+    }
+    return clamp(Color4f::CLEAR,Color4f::WHITE);
+}
+
+/**
+ * Adds the elements of the given array to this one.
+ *
+ * The channels are clamped to [0,1].  Alpha is only added if the
+ * parameter alpha is true.  The arrays must be the same size.
+ *
+ * @param other     The array to add
+ * @param alpha     Whether to add the alpha values
+ *
+ * @return This array, after the addition
+ */
+Color4Array& Color4Array::add(const Color4Array& other, bool alpha) {
+    CUAssertLog(other.size() == size(), "Array sizes do not match");
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    kernels->axpby(_r.data(),_r.data(),1.0f,other._r.data(),1.0f,size);
+    kernels->axpby(_g.data(),_g.data(),1.0f,other._g.data(),1.0f,size);
+    kernels->axpby(_b.data(),_b.data(),1.0f,other._b.data(),1.0f,size);
+    if (alpha) {
+        kernels->axpby(_a.data(),_a.data(),1.0f,other._a.data(),1.0f,size);
+    }
+    return clamp(Color4f::CLEAR,Color4f::WHITE);
+}
+
+/**
+ * Subtracts the given color from every element of this array.
+ *
+ * The channels are clamped to [0,1].  Alpha is only subtracted if the
+ * parameter alpha is true.
+ *
+ * @param c         The color to subtract
+ * @param alpha     Whether to subtract the alpha value
+ *
+ * @return This array, after the subtraction
+ */
+Color4Array& Color4Array::subtract(const Color4f& c, bool alpha) {
+    return add(Color4f(-c.r,-c.g,-c.b,-c.a),alpha);
+}
+
+/**
+ * Scales every element of this array uniformly by s.
+ *
+ * The channels are clamped to [0,1].  Alpha is only scaled if the
+ * parameter alpha is true.  Scaling alpha alone is the standard way
+ * to fade particles.
+ *
+ * @param s         The scale factor
+ * @param alpha     Whether to scale the alpha value
+ *
+ * @return This array, after the scaling
+ */
+Color4Array& Color4Array::scale(float s, bool alpha) {
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    kernels->madd(_r.data(),_r.data(),s,0.0f,size);
+    kernels->madd(_g.data(),_g.data(),s,0.0f,size);
+    kernels->madd(_b.data(),_b.data(),s,0.0f,size);
+    if (alpha) {
+        kernels->madd(_a.data(),_a.data(),s,0.0f,size);
+    }
+    return clamp(Color4f::CLEAR,Color4f::WHITE);
+}
+
+/**
+ * Tints every element of this array by the given color.
+ *
+ * This is the component-wise product.  Alpha is only tinted if the
+ * parameter alpha is true.
+ *
+ * @param c         The color to tint by
+ * @param alpha     Whether to tint the alpha value
+ *
+ * @return This array, after the tinting
+ */
+Color4Array& Color4Array::scale(const Color4f& c, bool alpha) {
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    kernels->madd(_r.data(),_r.data(),c.r,0.0f,size);
+    kernels->madd(_g.data(),_g.data(),c.g,0.0f,size);
+    kernels->madd(_b.data(),_b.data(),c.b,0.0f,size);
+    if (alpha) {
+        kernels->madd(_a.data(),_a.data(),c.a,0.0f,size);
+    }
+    return *this;
+}
+
+/**
+ * Clamps every element of this array to the given range.
+ *
+ * @param min   The minimum value
+ * @param max   The maximum value
+ *
+ * @return This array, after the clamping
+ */
+Color4Array& Color4Array::clamp(const Color4f& min, const Color4f& max) {
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    kernels->clamp(_r.data(),_r.data(),min.r,max.r,size);
+    kernels->clamp(_g.data(),_g.data(),min.g,max.g,size);
+    kernels->clamp(_b.data(),_b.data(),min.b,max.b,size);
+    kernels->clamp(_a.data(),_a.data(),min.a,max.a,size);
+    return *this;
+}
+
+/**
+ * Linearly interpolates every element of this array with the other.
+ *
+ * If alpha is 0, the elements are unchanged.  If alpha is 1, the elements
+ * are the elements of other.  If alpha is outside of the range 0 to 1, it
+ * is clamped to the nearest value.  The arrays must be the same size.
+ *
+ * @param other The other end of the line segment
+ * @param alpha The interpolation value
+ *
+ * @return This array, after the interpolation
+ */
+Color4Array& Color4Array::lerp(const Color4Array& other, float alpha) {
+    CUAssertLog(other.size() == size(), "Array sizes do not match");
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    float x = clampf(alpha,0,1);
+    kernels->axpby(_r.data(),_r.data(),1.0f-x,other._r.data(),x,size);
+    kernels->axpby(_g.data(),_g.data(),1.0f-x,other._g.data(),x,size);
+    kernels->axpby(_b.data(),_b.data(),1.0f-x,other._b.data(),x,size);
+    kernels->axpby(_a.data(),_a.data(),1.0f-x,other._a.data(),x,size);
+    return clamp(Color4f::CLEAR,Color4f::WHITE);
+}
+
+/**
+ * Premultiplies every element of this array with its alpha.
+ *
+ * This class does not store whether the colors are already premultiplied.
+ * Hence premultiplying twice will have a compounding effect.
+ *
+ * @return This array, after premultiplication
+ */
+Color4Array& Color4Array::premultiply() {
+    const ArrayKernels* kernels = array_kernels();
+    size_t size = _r.size();
+    kernels->mul(_r.data(),_r.data(),_a.data(),size);
+    kernels->mul(_g.data(),_g.data(),_a.data(),size);
+    kernels->mul(_b.data(),_b.data(),_a.data(),size);
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Copies this array into the given array of colors.
+ *
+ * The channels are clamped to [0,1] and converted to bytes.  The output
+ * array must have room for {@link size} elements.
+ *
+ * @param output    The array to store the colors
+ *
+ * @return A reference to output for chaining
+ */
+Color4* Color4Array::pack(Color4* output) const {
+    CUAssertLog(output || empty(), "Destination array is null");
+    array_kernels()->pack(reinterpret_cast<Uint32*>(output),1,
+                          _r.data(),_g.data(),_b.data(),_a.data(),_r.size());
+    return output;
+}
+
+/**
+ * Copies this array into the colors of the given vertices.
+ *
+ * Only the vertex colors are modified.  The channels are clamped to
+ * [0,1] and converted to bytes.  The output array must have room for
+ * {@link size} elements.
+ *
+ * @param output    The vertices to store the colors
+ *
+ * @return A reference to output for chaining
+ */
+Vertex2* Color4Array::pack(Vertex2* output) const {
+    CUAssertLog(output || empty(), "Destination array is null");
+    if (empty()) {
+        return output;
+    }
+    Uint32* start = &(output->color.rgba);
+    array_kernels()->pack(start,sizeof(Vertex2)/sizeof(Uint32),
+                          _r.data(),_g.data(),_b.data(),_a.data(),_r.size());
+    return output;
+}
+
+/**
+ * Returns this array as a vector of Color4 objects.
+ *
+ * @return this array as a vector of Color4 objects.
+ */
+Color4Array::operator std::vector<Color4>() const {
+    std::vector<Color4> result(_r.size());
+    pack(result.data());
+    return result;
+}
@@ -40,6 +40,7 @@
 
 #include <cugl/math/CUCubicSpline.h>
 #include <cugl/math/CUPolynomial.h>
+#include <cugl/math/CUFixedPolynomial.h>
 
 using namespace std;
 using namespace cugl;
@@ -421,14 +422,14 @@ void CubicSpline::setClosed(bool flag) {
  * @return the spline point for parameter tp
  */
 Vec2 CubicSpline::getPoint(int segment, float tp) const {
-    CUAssertLog(segment >= 0 && segment < _size, "Illegal spline segment");
+    CUAssertLog(segment >= 0 && segment <= _size, "Illegal spline segment");
     CUAssertLog(tp >= 0.0f && tp <= 1.0f, "Illegal segment parameter");
     
     if (segment == _size) {
         return _points[3 * segment];
     }
     
-    int index = 6 * segment;
+    int index = 3 * segment;
     float sp = (1 - tp);
     float a = sp*sp;
     float d = tp*tp;
@@ -869,9 +870,6 @@ float CubicSpline::nearestParameter(const Vec2& point) const {
     
     for (int ii = 0; ii < _size; ii++) {
         Vec2 pair = getProjectionFast(point, ii);
-        if (pair.x == -1) {
-            pair = getProjectionSlow(point, ii);
-        }
         if (smin == -1 || pair.y < dmin) {
             tmin = pair.x; dmin = pair.y; smin = ii;
         }
@@ -991,7 +989,7 @@ void CubicSpline::subdivide(const vector<Vec2>& src, int soff, float tp,
  * @param  point    the point to project
  * @param  segment  the bezier segment to project upon
  */
-Polynomial CubicSpline::getProjectionPolynomial(const Vec2& point, int segment) const {
+QuinticPolynomial CubicSpline::getProjectionPolynomial(const Vec2& point, int segment) const {
     CUAssertLog(segment >= 0 && segment < _size, "Illegal spline segment");
     
     Vec2 a = _points[3 * segment + 3] - 3 * _points[3 * segment + 2] + 3 * _points[3 * segment + 1] - _points[3 * segment];
@@ -999,13 +997,13 @@ Polynomial CubicSpline::getProjectionPolynomial(const Vec2& point, int segment)
     Vec2 c = 3 * (_points[3 * segment + 1] - _points[3 * segment]);
     Vec2 p = _points[3 * segment] - point;
     
-    Polynomial result(5);
-    result[0] = 3.0f*a.dot(a);                  // Q5
-    result[1] = 5.0f*a.dot(b);					// Q4
-    result[2] = 4.0f*a.dot(c) + 2.0f*b.dot(b);	// Q3
-    result[3] = 3.0f*b.dot(c) + 3.0f*a.dot(p);	// Q2
-    result[4] = c.dot(c) + 2.0f*b.dot(p);       // Q1
-    result[5] = c.dot(p);                       // Q0
+    QuinticPolynomial result;
+    result.c[0] = 3.0f*a.dot(a);                    // Q5
+    result.c[1] = 5.0f*a.dot(b);                    // Q4
+    result.c[2] = 4.0f*a.dot(c) + 2.0f*b.dot(b);    // Q3
+    result.c[3] = 3.0f*b.dot(c) + 3.0f*a.dot(p);    // Q2
+    result.c[4] = c.dot(c) + 2.0f*b.dot(p);         // Q1
+    result.c[5] = c.dot(p);                         // Q0
     return result;
 }
 
@@ -1018,8 +1016,9 @@ Polynomial CubicSpline::getProjectionPolynomial(const Vec2& point, int segment)
  * This version does not use the projection polynomial.  Instead, it picks
  * a parameter resolution and walks the entire length of the curve.  The
  * result is both slow and inexact (as the actual point may be in-between
- * chose parameters). This version is only picked when getProjectionFast
- * fails because of an error with root finding.
+ * chose parameters). This version is no longer used by nearestParameter,
+ * as the root finder of getProjectionFast cannot fail.  It is kept as a
+ * reference for the accuracy of that method.
  *
  * The value returned is a pair of the parameter, and its distance value.
  * This allows us to compare this result to other segments, picking the
@@ -1070,9 +1069,9 @@ Vec2 CubicSpline::getProjectionSlow(const Vec2& point, int segment) const {
  * best value for the entire spline.
  *
  * This algorithm uses the projection polynomial, and searches for roots to
- * find the best (max of 5) candidates.  However, root finding may fail,
- * do to singularities in Bairstow's Method.  If the root finder fails, then
- * the first element of the pair will be -1 (an invalid parameter).
+ * find the best (max of 5) candidates.  The roots are found with
+ * {@link QuinticPolynomial}, which does not allocate memory and cannot
+ * fail (unlike the Bairstow's Method of {@link Polynomial}).
  *
  * @param  point    the point to project
  * @param  segment  the bezier segment to project upon
@@ -1080,45 +1079,28 @@ Vec2 CubicSpline::getProjectionSlow(const Vec2& point, int segment) const {
  * @return the parameterization of the nearest point on the spline.
  */
 Vec2 CubicSpline::getProjectionFast(const Vec2& point, int segment) const {
-    vector<float> roots;
-    
-    Polynomial poly = getProjectionPolynomial(point, segment);
-    
-    float epsilon = 1.0f / (1 << (MAX_DEPTH + 1));
-    bool success = poly.roots(roots, epsilon);
-    if (!success) {
-        // This will kick us to the slow method
-        return Vec2(-1, 0);
-    }
+    float roots[5];
+    QuinticPolynomial poly = getProjectionPolynomial(point, segment);
+    int count = poly.roots(roots, 0.0f, 1.0f);
     
+    // Compare the end points
     Vec2 result;
-    
-    // Now compare the candidates
     result.x = 0.0f;
-    Vec2 compare = getPoint(segment,1.0f) - point;
+    Vec2 compare = getPoint(segment,0.0f) - point;
     result.y = compare.lengthSquared();
     
-    float t = 1.0f;
     compare = getPoint(segment,1.0f) - point;
     float d = compare.lengthSquared();
     if (d < result.y) {
-        result.set(t, d);
+        result.set(1.0f, d);
     }
     
     // Check the roots
-    int RESOLUTION = (1 << MAX_DEPTH);
-    for (auto it = roots.begin(); it != roots.end(); ++it) {
-        float r = *it;
-        if (r != nanf("") && r > 0 && r < 1) {
-            // Convert to nearest step.
-            t = r*RESOLUTION;
-            t = roundf(t);
-            t /= RESOLUTION;
-            compare = getPoint(segment,t) - point;
-            d = compare.lengthSquared();
-            if (d < result.y) {
-                result.set(t, d);
-            }
+    for (int ii = 0; ii < count; ii++) {
+        compare = getPoint(segment,roots[ii]) - point;
+        d = compare.lengthSquared();
+        if (d < result.y) {
+            result.set(roots[ii], d);
         }
     }
     
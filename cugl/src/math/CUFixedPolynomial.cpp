@@ -0,0 +1,433 @@
+//
+//  CUFixedPolynomial.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a polynomial whose degree is fixed at compile time.
+//  Unlike Polynomial, it does not allocate any memory, and its root finder
+//  cannot fail.  The primary purpose of this class is to support the
+//  projection queries of CubicSpline, which solve a quintic for every
+//  segment.  However, we provide it publicly in case it is useful for other
+//  applications.
+//
+//  The batch evaluation methods are vectorized with SSE (or AVX2, if it is
+//  enabled by the compiler).
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#include <cugl/math/CUFixedPolynomial.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#if defined CU_MATH_VECTOR_AVX2
+    #include <immintrin.h>
+#elif defined CU_MATH_VECTOR_SSE
+    #include <xmmintrin.h>
+#endif
+
+/** Maximum number of iterations for the Newton-bisection hybrid */
+#define MAX_ITERATIONS  100
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Evaluation
+/**
+ * Evaluates this polynomial on each of the given values.
+ *
+ * This method is vectorized, and is much faster than calling
+ * {@link evaluate} on each value.  The output array must have room for
+ * count elements.  It is safe for output to be the same as input.
+ *
+ * @param input     The values to evaluate
+ * @param output    The array to store the results
+ * @param count     The number of values
+ *
+ * @return A reference to output for chaining
+ */
+template <int D>
+float* FixedPolynomial<D>::evaluate(const float* input, float* output, size_t count) const {
+    CUAssertLog(output || !count, "Destination array is null");
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    __m256 coeffs[D+1];
+    for(int kk = 0; kk <= D; kk++) {
+        coeffs[kk] = _mm256_set1_ps(c[kk]);
+    }
+    for(; ii+8 <= count; ii += 8) {
+        __m256 x = _mm256_loadu_ps(input+ii);
+        __m256 r = coeffs[0];
+        for(int kk = 1; kk <= D; kk++) {
+            r = _mm256_add_ps(_mm256_mul_ps(r, x), coeffs[kk]);
+        }
+        _mm256_storeu_ps(output+ii, r);
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    __m128 coeffs[D+1];
+    for(int kk = 0; kk <= D; kk++) {
+        coeffs[kk] = _mm_set1_ps(c[kk]);
+    }
+    for(; ii+4 <= count; ii += 4) {
+        __m128 x = _mm_loadu_ps(input+ii);
+        __m128 r = coeffs[0];
+        for(int kk = 1; kk <= D; kk++) {
+            r = _mm_add_ps(_mm_mul_ps(r, x), coeffs[kk]);
+        }
+        _mm_storeu_ps(output+ii, r);
+    }
+#endif
+    for(; ii < count; ii++) {
+        output[ii] = evaluate(input[ii]);
+    }
+    return output;
+}
+
+/**
+ * Evaluates each polynomial on the corresponding value.
+ *
+ * That is, output[i] is polys[i] evaluated at input[i].  To evaluate many
+ * polynomials at the same value, simply fill the input with that value.
+ * This method is vectorized, and is much faster than calling
+ * {@link evaluate} on each polynomial.  The output array must have room
+ * for count elements.  It is safe for output to be the same as input.
+ *
+ * @param polys     The polynomials to evaluate
+ * @param input     The values to evaluate
+ * @param output    The array to store the results
+ * @param count     The number of polynomials
+ *
+ * @return A reference to output for chaining
+ */
+template <int D>
+float* FixedPolynomial<D>::evaluate(const FixedPolynomial* polys, const float* input,
+                                    float* output, size_t count) {
+    CUAssertLog(output || !count, "Destination array is null");
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_AVX2
+    // Gather the k-th coefficient of eight consecutive polynomials
+    const int stride = (int)(sizeof(FixedPolynomial)/sizeof(float));
+    __m256i offsets = _mm256_setr_epi32(0, stride, 2*stride, 3*stride,
+                                        4*stride, 5*stride, 6*stride, 7*stride);
+    for(; ii+8 <= count; ii += 8) {
+        const float* base = polys[ii].c;
+        __m256 x = _mm256_loadu_ps(input+ii);
+        __m256 r = _mm256_i32gather_ps(base, offsets, 4);
+        for(int kk = 1; kk <= D; kk++) {
+            r = _mm256_add_ps(_mm256_mul_ps(r, x), _mm256_i32gather_ps(base+kk, offsets, 4));
+        }
+        _mm256_storeu_ps(output+ii, r);
+    }
+#elif defined CU_MATH_VECTOR_SSE
+    for(; ii+4 <= count; ii += 4) {
+        const FixedPolynomial* p = polys+ii;
+        __m128 x = _mm_loadu_ps(input+ii);
+        __m128 r = _mm_setr_ps(p[0].c[0], p[1].c[0], p[2].c[0], p[3].c[0]);
+        for(int kk = 1; kk <= D; kk++) {
+            __m128 k = _mm_setr_ps(p[0].c[kk], p[1].c[kk], p[2].c[kk], p[3].c[kk]);
+            r = _mm_add_ps(_mm_mul_ps(r, x), k);
+        }
+        _mm_storeu_ps(output+ii, r);
+    }
+#endif
+    for(; ii < count; ii++) {
+        output[ii] = polys[ii].evaluate(input[ii]);
+    }
+    return output;
+}
+
+
+#pragma mark -
+#pragma mark Root Finding
+/**
+ * Returns the number of real roots of this polynomial in [min,max].
+ *
+ * The roots are stored in the array in ascending order.  The array must
+ * have room for D elements.  Roots within epsilon of each other are
+ * reported once, so a root of higher multiplicity is only reported once.
+ * If this polynomial is 0, this method returns 0.
+ *
+ * @param roots     The array to store the roots
+ * @param min       The start of the interval
+ * @param max       The end of the interval
+ * @param epsilon   The error tolerance for the root values
+ *
+ * @return the number of real roots of this polynomial in [min,max].
+ */
+template <int D>
+int FixedPolynomial<D>::roots(float* roots, float min, float max, float epsilon) const {
+    CUAssertLog(min <= max, "The interval [%f,%f] is empty", min, max);
+    double values[D];
+    int count = solve(values,min,max,epsilon);
+    for(int ii = 0; ii < count; ii++) {
+        roots[ii] = (float)values[ii];
+    }
+    return count;
+}
+
+/**
+ * Returns the number of real roots of this polynomial.
+ *
+ * The roots are stored in the array in ascending order.  The array must
+ * have room for D elements.  Roots within epsilon of each other are
+ * reported once, so a root of higher multiplicity is only reported once.
+ * If this polynomial is 0, this method returns 0.
+ *
+ * @param roots     The array to store the roots
+ * @param epsilon   The error tolerance for the root values
+ *
+ * @return the number of real roots of this polynomial.
+ */
+template <int D>
+int FixedPolynomial<D>::roots(float* roots, float epsilon) const {
+    int lead = 0;
+    while (lead < D && c[lead] == 0) {
+        lead++;
+    }
+    if (lead == D) {
+        return 0;
+    }
+
+    // Cauchy's bound on the roots
+    double bound = 0;
+    for(int ii = lead+1; ii <= D; ii++) {
+        bound = std::max(bound,std::abs((double)c[ii]/c[lead]));
+    }
+    bound += 1;
+
+    double values[D];
+    int count = solve(values,-bound,bound,epsilon);
+    for(int ii = 0; ii < count; ii++) {
+        roots[ii] = (float)values[ii];
+    }
+    return count;
+}
+
+/**
+ * Computes the real roots in [min,max] of each polynomial.
+ *
+ * The roots of polys[i] are stored in ascending order starting at
+ * roots[D*i], and the number of roots is stored in counts[i].  Hence the
+ * roots array must have room for D*count elements.
+ *
+ * @param polys     The polynomials to solve
+ * @param count     The number of polynomials
+ * @param roots     The array to store the roots
+ * @param counts    The array to store the number of roots
+ * @param min       The start of the interval
+ * @param max       The end of the interval
+ * @param epsilon   The error tolerance for the root values
+ */
+template <int D>
+void FixedPolynomial<D>::roots(const FixedPolynomial* polys, size_t count, float* roots, int* counts,
+                               float min, float max, float epsilon) {
+    CUAssertLog((roots && counts) || !count, "Destination array is null");
+    for(size_t ii = 0; ii < count; ii++) {
+        counts[ii] = polys[ii].roots(roots+D*ii,min,max,epsilon);
+    }
+}
+
+/**
+ * Returns the number of real roots of this linear polynomial in [min,max].
+ *
+ * The root of a linear polynomial is exact, so there is no error tolerance.
+ *
+ * @param roots     The array to store the roots
+ * @param min       The start of the interval
+ * @param max       The end of the interval
+ *
+ * @return the number of real roots of this polynomial in [min,max].
+ */
+template <>
+int FixedPolynomial<1>::solve(double* roots, double min, double max, double) const {
+    if (c[0] == 0) {
+        return 0;
+    }
+    double root = -(double)c[1]/(double)c[0];
+    if (root < min || root > max) {
+        return 0;
+    }
+    roots[0] = root;
+    return 1;
+}
+
+/**
+ * Returns the number of real roots of this quadratic polynomial in [min,max].
+ *
+ * This method uses the numerically stable form of the quadratic formula.
+ *
+ * @param roots     The array to store the roots
+ * @param min       The start of the interval
+ * @param max       The end of the interval
+ * @param epsilon   The error tolerance for the root values
+ *
+ * @return the number of real roots of this polynomial in [min,max].
+ */
+template <>
+int FixedPolynomial<2>::solve(double* roots, double min, double max, double epsilon) const {
+    if (c[0] == 0) {
+        FixedPolynomial<1> lower(c+1);
+        return lower.solve(roots,min,max,epsilon);
+    }
+    double a = c[0];
+    double b = c[1];
+    double k = c[2];
+    double disc  = b*b-4*a*k;
+    double error = FLT_EPSILON*(b*b+4*std::abs(a*k));
+    if (disc < -error) {
+        return 0;
+    } else if (disc <= error) {
+        // A double root (up to the precision of the coefficients)
+        double root = -b/(2*a);
+        if (root < min || root > max) {
+            return 0;
+        }
+        roots[0] = root;
+        return 1;
+    }
+
+    double q  = -0.5*(b+(b < 0 ? -1 : 1)*sqrt(disc));
+    double r1 = q/a;
+    double r2 = k/q;
+    if (r1 > r2) {
+        std::swap(r1,r2);
+    }
+    int count = 0;
+    if (r1 >= min && r1 <= max) {
+        roots[count++] = r1;
+    }
+    if (r2 >= min && r2 <= max && (count == 0 || r2-roots[0] > epsilon)) {
+        roots[count++] = r2;
+    }
+    return count;
+}
+
+/**
+ * Returns the number of real roots of this polynomial in [min,max].
+ *
+ * The roots of the derivative divide the interval into pieces on which
+ * this polynomial is monotone.  Each piece with a sign change has exactly
+ * one root, which is found with a safeguarded Newton-bisection hybrid.
+ *
+ * The roots are stored in the array in ascending order, and the array
+ * must have room for D elements.  If this polynomial is 0, this method
+ * returns 0.
+ *
+ * @param roots     The array to store the roots
+ * @param min       The start of the interval
+ * @param max       The end of the interval
+ * @param epsilon   The error tolerance for the root values
+ *
+ * @return the number of real roots of this polynomial in [min,max].
+ */
+template <int D>
+int FixedPolynomial<D>::solve(double* roots, double min, double max, double epsilon) const {
+    if (c[0] == 0) {
+        FixedPolynomial<D-1> lower(c+1);
+        return lower.solve(roots,min,max,epsilon);
+    }
+
+    // The critical points (and the end points)
+    FixedPolynomial<D-1> deriv = derivative();
+    double points[D+1];
+    int pcount = deriv.solve(points+1,min,max,epsilon)+2;
+    points[0] = min;
+    points[pcount-1] = max;
+
+    // A critical value is negligible if it is within the precision of the coefficients
+    double values[D+1];
+    bool small[D+1];
+    for(int ii = 0; ii < pcount; ii++) {
+        double x = points[ii];
+        double bound = std::abs((double)c[0]);
+        for(int jj = 1; jj <= D; jj++) {
+            bound = bound*std::abs(x)+std::abs((double)c[jj]);
+        }
+        values[ii] = evaluate(x);
+        small[ii]  = std::abs(values[ii]) <= FLT_EPSILON*bound;
+    }
+
+    int count = 0;
+    auto append = [&](double root) {
+        if (count == 0 || root-roots[count-1] > epsilon) {
+            roots[count++] = root;
+        }
+    };
+
+    for(int ii = 0; ii < pcount; ii++) {
+        if (values[ii] == 0) {
+            append(points[ii]);
+        } else if (small[ii] && ii > 0 && ii+1 < pcount && values[ii-1] != 0 && values[ii+1] != 0 &&
+                   (values[ii-1] < 0) == (values[ii] < 0) && (values[ii+1] < 0) == (values[ii] < 0)) {
+            // An extremum that touches zero is a root of even multiplicity
+            append(points[ii]);
+        }
+        if (ii+1 == pcount || values[ii] == 0 || values[ii+1] == 0 || (values[ii] < 0) == (values[ii+1] < 0)) {
+            continue;
+        }
+
+        // Newton-bisection, with f(lo) < 0 < f(hi)
+        double lo = values[ii] < 0 ? points[ii] : points[ii+1];
+        double hi = values[ii] < 0 ? points[ii+1] : points[ii];
+        double x  = 0.5*(lo+hi);
+        double dxold = std::abs(hi-lo);
+        double dx = dxold;
+        double fx = evaluate(x);
+        double df = deriv.evaluate(x);
+        for(int jj = 0; jj < MAX_ITERATIONS && fx != 0; jj++) {
+            if (((x-hi)*df-fx)*((x-lo)*df-fx) > 0 || std::abs(2*fx) > std::abs(dxold*df)) {
+                dxold = dx;
+                dx = 0.5*(hi-lo);
+                x  = lo+dx;
+            } else {
+                dxold = dx;
+                dx = fx/df;
+                x -= dx;
+            }
+            if (std::abs(dx) < epsilon) {
+                break;
+            }
+            fx = evaluate(x);
+            df = deriv.evaluate(x);
+            if (fx < 0) {
+                lo = x;
+            } else {
+                hi = x;
+            }
+        }
+        append(x);
+    }
+    return count;
+}
+
+#pragma mark -
+#pragma mark Instantiations
+namespace cugl {
+    template class FixedPolynomial<1>;
+    template class FixedPolynomial<2>;
+    template class FixedPolynomial<3>;
+    template class FixedPolynomial<4>;
+    template class FixedPolynomial<5>;
+}
@@ -1422,6 +1422,8 @@ const Mat4 Mat4::ONE(1.0f, 1.0f, 1.0f, 1.0f,
 #pragma mark Vectorization
 #if defined CU_MATH_VECTOR_APPLE
     #include "Mat4-Apple.inl"
+#elif defined CU_MATH_VECTOR_AVX2
+    #include "Mat4-AVX2.inl"
 #elif defined CU_MATH_VECTOR_SSE
     #include "Mat4-SSE.inl"
 #elif defined CU_MATH_VECTOR_NEON64
@@ -1431,4 +1433,105 @@ const Mat4 Mat4::ONE(1.0f, 1.0f, 1.0f, 1.0f,
 #endif
 
 
+#pragma mark -
+#pragma mark Batch Operations
+/**
+ * Transforms the array of points by the given matrix.
+ *
+ * The points are treated as points, which means that translation is
+ * applied to the result.  The result is stored in output, which must have
+ * room for size elements.  It is safe for output to be the same as input
+ * (to transform the points in place), but the arrays may not otherwise
+ * overlap.
+ *
+ * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+ * than transforming the points one at a time.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The points to transform.
+ * @param size      The number of points to transform.
+ * @param output    The array to store the transformed points.
+ *
+ * @return A reference to output for chaining
+ */
+Vec2* Mat4::transform(const Mat4& mat, const Vec2* input, size_t size, Vec2* output) {
+    CUAssertLog(output || !size, "Destination array is null");
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    ii = mat4_batch(mat, input, size, output);
+#endif
+    for(; ii < size; ii++) {
+        float x = input[ii].x;
+        float y = input[ii].y;
+        output[ii].x = mat.m[0]*x+mat.m[4]*y+mat.m[12];
+        output[ii].y = mat.m[1]*x+mat.m[5]*y+mat.m[13];
+    }
+    return output;
+}
 
+/**
+ * Transforms the array of points by the given matrix.
+ *
+ * The points are treated as points, which means that translation is
+ * applied to the result.  The result is stored in output, which must have
+ * room for size elements.  It is safe for output to be the same as input
+ * (to transform the points in place), but the arrays may not otherwise
+ * overlap.
+ *
+ * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+ * than transforming the points one at a time.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The points to transform.
+ * @param size      The number of points to transform.
+ * @param output    The array to store the transformed points.
+ *
+ * @return A reference to output for chaining
+ */
+Vec3* Mat4::transform(const Mat4& mat, const Vec3* input, size_t size, Vec3* output) {
+    CUAssertLog(output || !size, "Destination array is null");
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    ii = mat4_batch(mat, input, size, output);
+#endif
+    for(; ii < size; ii++) {
+        float x = input[ii].x;
+        float y = input[ii].y;
+        float z = input[ii].z;
+        output[ii].x = mat.m[0]*x+mat.m[4]*y+mat.m[8]*z+mat.m[12];
+        output[ii].y = mat.m[1]*x+mat.m[5]*y+mat.m[9]*z+mat.m[13];
+        output[ii].z = mat.m[2]*x+mat.m[6]*y+mat.m[10]*z+mat.m[14];
+    }
+    return output;
+}
+
+/**
+ * Transforms the array of vectors by the given matrix.
+ *
+ * The vectors are treated as is.  Hence whether or not translation is
+ * applied depends on the value of w.  The result is stored in output,
+ * which must have room for size elements.  It is safe for output to be
+ * the same as input (to transform the vectors in place), but the arrays
+ * may not otherwise overlap.
+ *
+ * On SSE and AVX2 platforms, this method is vectorized.  It is much faster
+ * than transforming the vectors one at a time.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The vectors to transform.
+ * @param size      The number of vectors to transform.
+ * @param output    The array to store the transformed vectors.
+ *
+ * @return A reference to output for chaining
+ */
+Vec4* Mat4::transform(const Mat4& mat, const Vec4* input, size_t size, Vec4* output) {
+    CUAssertLog(output || !size, "Destination array is null");
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    ii = mat4_batch(mat, input, size, output);
+#endif
+    for(; ii < size; ii++) {
+        transform(mat, input[ii], output+ii);
+    }
+    return output;
+}
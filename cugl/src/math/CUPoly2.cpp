@@ -49,6 +49,7 @@
 #include <sstream>
 #include <cmath>
 #include <iterator>
+#include <limits>
 #include <cugl/math/CUMat4.h>
 #include <cugl/math/CUAffine2.h>
 
@@ -132,6 +133,234 @@ public:
 };
 
 
+#pragma mark -
+#pragma mark Spatial Index
+
+/** The number of primitives (triangles or segments) before we build a grid */
+#define GRID_THRESHOLD  32
+/** The maximum number of grid cells along either axis */
+#define GRID_MAX_DIM    256
+
+/**
+ * Returns the point on the line segment a-b nearest to the given point.
+ *
+ * @param point The point to check
+ * @param a     The start of the line segment
+ * @param b     The end of the line segment
+ *
+ * @return the point on the line segment a-b nearest to the given point.
+ */
+static Vec2 segment_nearest(const Vec2& point, const Vec2& a, const Vec2& b) {
+    Vec2 d = b-a;
+    float len2 = d.lengthSquared();
+    if (len2 == 0) {
+        return a;
+    }
+    float t = (point-a).dot(d)/len2;
+    t = (t < 0 ? 0 : (t > 1 ? 1 : t));
+    return a+d*t;
+}
+
+/**
+ * Returns the parameter of the first segment where it crosses the second.
+ *
+ * The parameter is the value t such that p0+t*(p1-p0) is the crossing.  If
+ * the segments do not cross (or are parallel) this function returns -1.
+ *
+ * @param p0    The start of the first line segment
+ * @param p1    The end of the first line segment
+ * @param q0    The start of the second line segment
+ * @param q1    The end of the second line segment
+ *
+ * @return the parameter of the first segment where it crosses the second.
+ */
+static float segment_crossing(const Vec2& p0, const Vec2& p1, const Vec2& q0, const Vec2& q1) {
+    Vec2 r = p1-p0;
+    Vec2 s = q1-q0;
+    float denom = r.cross(s);
+    if (-CU_MATH_EPSILON < denom && denom < CU_MATH_EPSILON) {
+        return -1;
+    }
+    Vec2 w = q0-p0;
+    float t = w.cross(s)/denom;
+    float u = w.cross(r)/denom;
+    if (t < -CU_MATH_EPSILON || t > 1+CU_MATH_EPSILON ||
+        u < -CU_MATH_EPSILON || u > 1+CU_MATH_EPSILON) {
+        return -1;
+    }
+    return (t < 0 ? 0 : (t > 1 ? 1 : t));
+}
+
+/**
+ * Stores the boundary edges of the polygon mesh in the given buffer.
+ *
+ * For a PATH, the edges are the segments of the path.  For a SOLID, they
+ * are the triangle edges that belong to exactly one triangle.  The edges
+ * are stored as pairs of indices.
+ *
+ * @param indices   The polygon indices
+ * @param type      The polygon type
+ * @param edges     The buffer to store the edges
+ */
+template <typename T>
+static void boundary_edges(const std::vector<T>& indices, Poly2::Type type,
+                           std::vector<Uint32>& edges) {
+    edges.clear();
+    if (type == Poly2::Type::PATH) {
+        edges.assign(indices.begin(), indices.begin()+(indices.size() & ~(size_t)1));
+        return;
+    } else if (type != Poly2::Type::SOLID) {
+        return;
+    }
+    
+    // Sort the undirected edges so that shared edges are adjacent
+    size_t tris = indices.size()/3;
+    std::vector<std::pair<Uint64,Uint32>> keys;
+    keys.reserve(3*tris);
+    for(size_t ii = 0; ii < 3*tris; ii++) {
+        Uint32 a = indices[ii];
+        Uint32 b = indices[ii % 3 == 2 ? ii-2 : ii+1];
+        Uint64 key = (a < b) ? (((Uint64)a << 32) | b) : (((Uint64)b << 32) | a);
+        keys.push_back(std::make_pair(key,(Uint32)ii));
+    }
+    std::sort(keys.begin(), keys.end());
+    
+    for(size_t ii = 0; ii < keys.size(); ) {
+        size_t jj = ii+1;
+        while (jj < keys.size() && keys[jj].first == keys[ii].first) {
+            jj++;
+        }
+        if (jj == ii+1) {
+            Uint32 pos = keys[ii].second;
+            edges.push_back(indices[pos]);
+            edges.push_back(indices[pos % 3 == 2 ? pos-2 : pos+1]);
+        }
+        ii = jj;
+    }
+}
+
+/**
+ * This class is a uniform grid over the triangles and edges of a polygon.
+ *
+ * Each cell stores the triangles (for a SOLID polygon) and the boundary
+ * edges whose bounding boxes overlap it.  The cell contents are stored in
+ * compressed form: the items of cell ii are the entries from start[ii] to
+ * start[ii+1] of the item list.
+ *
+ * Once built, this class is immutable.  That is why copies of a polygon
+ * may safely share it.
+ */
+class Poly2::Accelerator {
+public:
+    /** The bounding box of the grid */
+    Rect bounds;
+    /** The number of grid columns */
+    int cols;
+    /** The number of grid rows */
+    int rows;
+    /** The number of columns per unit of width */
+    float xscale;
+    /** The number of rows per unit of height */
+    float yscale;
+    
+    /** The offsets of each cell into the triangle list */
+    std::vector<Uint32> triStart;
+    /** The triangles (as triangle indices) of each cell */
+    std::vector<Uint32> triItems;
+    
+    /** The boundary edges, as pairs of vertex indices */
+    std::vector<Uint32> edges;
+    /** The offsets of each cell into the edge list */
+    std::vector<Uint32> edgeStart;
+    /** The edges (as edge indices) of each cell */
+    std::vector<Uint32> edgeItems;
+    /** The length of the longest boundary edge */
+    float maxEdge;
+    
+    /** The convex hull of a SOLID polygon (used by incident) */
+    std::vector<Vec2> hull;
+    
+    /**
+     * Returns the grid column for the given x-coordinate
+     *
+     * The value is clamped to the grid.
+     *
+     * @param x The x-coordinate
+     *
+     * @return the grid column for the given x-coordinate
+     */
+    int column(float x) const {
+        float c = (x-bounds.origin.x)*xscale;
+        return (c < 0 ? 0 : (c >= cols ? cols-1 : (int)c));
+    }
+
+    /**
+     * Returns the grid row for the given y-coordinate
+     *
+     * The value is clamped to the grid.
+     *
+     * @param y The y-coordinate
+     *
+     * @return the grid row for the given y-coordinate
+     */
+    int row(float y) const {
+        float r = (y-bounds.origin.y)*yscale;
+        return (r < 0 ? 0 : (r >= rows ? rows-1 : (int)r));
+    }
+
+    /**
+     * Assigns the given primitives to the cells that they overlap.
+     *
+     * Each primitive is a group of arity consecutive indices.  A primitive
+     * is assigned to every cell overlapping its bounding box.
+     *
+     * @param vertices  The polygon vertices
+     * @param prims     The primitive indices
+     * @param count     The number of primitives
+     * @param arity     The number of indices per primitive
+     * @param start     The buffer to store the cell offsets
+     * @param items     The buffer to store the cell contents
+     */
+    template <typename T>
+    void fill(const std::vector<Vec2>& vertices, const T* prims, size_t count, int arity,
+              std::vector<Uint32>& start, std::vector<Uint32>& items) {
+        std::vector<int> span(4*count);
+        start.assign(cols*rows+1,0);
+        for(size_t ii = 0; ii < count; ii++) {
+            Vec2 lo = vertices[prims[arity*ii]];
+            Vec2 hi = lo;
+            for(int jj = 1; jj < arity; jj++) {
+                const Vec2& v = vertices[prims[arity*ii+jj]];
+                lo.x = std::min(lo.x,v.x); lo.y = std::min(lo.y,v.y);
+                hi.x = std::max(hi.x,v.x); hi.y = std::max(hi.y,v.y);
+            }
+            int* box = span.data()+4*ii;
+            box[0] = column(lo.x); box[1] = column(hi.x);
+            box[2] = row(lo.y);    box[3] = row(hi.y);
+            for(int yy = box[2]; yy <= box[3]; yy++) {
+                for(int xx = box[0]; xx <= box[1]; xx++) {
+                    start[yy*cols+xx+1]++;
+                }
+            }
+        }
+        for(size_t ii = 1; ii < start.size(); ii++) {
+            start[ii] += start[ii-1];
+        }
+        
+        items.resize(start.back());
+        std::vector<Uint32> next(start.begin(),start.end()-1);
+        for(size_t ii = 0; ii < count; ii++) {
+            const int* box = span.data()+4*ii;
+            for(int yy = box[2]; yy <= box[3]; yy++) {
+                for(int xx = box[0]; xx <= box[1]; xx++) {
+                    items[next[yy*cols+xx]++] = (Uint32)ii;
+                }
+            }
+        }
+    }
+};
+
+
 #pragma mark -
 #pragma mark Static Constructors
 
@@ -178,7 +407,7 @@ Poly2* Poly2::createLine(const Vec2& origin, const Vec2& dest, Poly2* dst) {
     dst->_vertices.push_back(origin);
     dst->_vertices.push_back(dest);
     
-    dst->_indices.clear();
+    dst->resetIndices();
     dst->_indices.push_back(0);
     dst->_indices.push_back(1);
     
@@ -251,6 +480,7 @@ Poly2* Poly2::createTriangle(const Vec2& a, const Vec2& b, const Vec2& c, Poly2*
     dst->_vertices.push_back(b);
     dst->_vertices.push_back(c);
     
+    dst->resetIndices();
     if (solid) {
         dst->_indices.resize(3,0);
         dst->_indices[0] = 0;
@@ -353,6 +583,7 @@ Poly2* Poly2::createEllipse(const Vec2& center, const Size& size, unsigned int s
         dst->_vertices[ii] = vert;
     }
     
+    dst->resetIndices();
     if (solid) {
         dst->_vertices.push_back(center);
         dst->_indices.resize(3*segments,0);
@@ -395,7 +626,7 @@ Poly2* Poly2::createEllipse(const Vec2& center, const Size& size, unsigned int s
  */
 Poly2& Poly2::set(const vector<Vec2>& vertices) {
     _vertices.assign(vertices.begin(),vertices.end());
-    _indices.clear();
+    resetIndices();
     _type = Type::UNDEFINED;
     computeBounds();
     return *this;
@@ -420,12 +651,42 @@ Poly2& Poly2::set(const vector<Vec2>& vertices) {
  */
 Poly2& Poly2::set(const vector<Vec2>& vertices, const vector<unsigned short>& indices) {
     _vertices.assign(vertices.begin(),vertices.end());
+    resetIndices();
     _indices.assign(indices.begin(),indices.end());
     computeType();
     computeBounds();
     return *this;
 }
 
+/**
+ * Sets the polygon to have the given vertices and indices.
+ *
+ * A valid list of indices must only refer to vertices in the vertex array.
+ * That is, the indices should all be non-negative, and each value should be
+ * less than the number of vertices.
+ *
+ * This assignment will also assign a type according to the multiplicity of the
+ * indices.  If the number of indices is three times the number of vertices,
+ * the type will be SOLID.  If it is two times the number of vertices, the
+ * type will be PATH.  Otherwise, the type will be UNDEFINED.
+ *
+ * The indices are stored in 16 bits unless they do not fit, in which case
+ * this polygon is {@link isWide wide}.
+ *
+ * @param vertices  The vector of vertices (as Vec2) in this polygon
+ * @param indices   The vector of indices for the rendering
+ *
+ * @return This polygon, returned for chaining
+ */
+Poly2& Poly2::set(const vector<Vec2>& vertices, const vector<Uint32>& indices) {
+    _vertices.assign(vertices.begin(),vertices.end());
+    resetIndices();
+    appendIndices(indices.data(), indices.size());
+    computeType();
+    computeBounds();
+    return *this;
+}
+
 /**
  * Sets the polygon to have the given vertices
  *
@@ -444,7 +705,7 @@ Poly2& Poly2::set(const vector<Vec2>& vertices, const vector<unsigned short>& in
 Poly2& Poly2::set(const vector<float>& vertices) {
     vector<Vec2>* ref = (vector<Vec2>*)&vertices;
     _vertices.assign(ref->begin(),ref->end());
-    _indices.clear();
+    resetIndices();
     _type = Type::UNDEFINED;
     computeBounds();
     return *this;
@@ -476,6 +737,7 @@ Poly2& Poly2::set(const vector<float>& vertices) {
 Poly2& Poly2::set(const vector<float>& vertices, const vector<unsigned short>& indices) {
     vector<Vec2>* ref = (vector<Vec2>*)&vertices;
     _vertices.assign(ref->begin(),ref->end());
+    resetIndices();
     _indices.assign(indices.begin(),indices.end());
     computeType();
     computeBounds();
@@ -497,7 +759,7 @@ Poly2& Poly2::set(const vector<float>& vertices, const vector<unsigned short>& i
  */
 Poly2& Poly2::set(Vec2* vertices, int vertsize, int voffset) {
     _vertices.assign(vertices+voffset,vertices+voffset+vertsize);
-    _indices.clear();
+    resetIndices();
     _type = Type::UNDEFINED;
     computeBounds();
     return *this;
@@ -529,12 +791,49 @@ Poly2& Poly2::set(Vec2* vertices, int vertsize, int voffset) {
 Poly2& Poly2::set(Vec2* vertices, int vertsize, unsigned short* indices, int indxsize,
                   int voffset, int ioffset) {
     _vertices.assign(vertices+voffset,vertices+voffset+vertsize);
+    resetIndices();
     _indices.assign(indices+ioffset, indices+ioffset+indxsize);
     computeType();
     computeBounds();
     return *this;
 }
 
+/**
+ * Sets the polygon to have the given vertices and indices.
+ *
+ * A valid list of indices must only refer to vertices in the vertex array.
+ * That is, the indices should all be non-negative, and each value should be
+ * less than the number of vertices.
+ *
+ * This assignment will also assign a type according to the multiplicity of the
+ * indices.  If the number of indices is three times the number of vertices,
+ * the type will be SOLID.  If it is two times the number of vertices, the
+ * type will be PATH.  Otherwise, the type will be UNDEFINED.
+ *
+ * This method returns a reference to this polygon for chaining.
+ *
+ * The indices are stored in 16 bits unless they do not fit, in which case
+ * this polygon is {@link isWide wide}.
+ *
+ * @param vertices  The array of vertices (as Vec2) in this polygon
+ * @param vertsize  The number of elements to use from vertices
+ * @param indices   The array of indices for the rendering
+ * @param indxsize  The number of elements to use for the indices
+ * @param voffset   The offset in vertices to start the polygon
+ * @param ioffset   The offset in indices to start from
+ *
+ * @return This polygon, returned for chaining
+ */
+Poly2& Poly2::set(Vec2* vertices, int vertsize, Uint32* indices, int indxsize,
+                  int voffset, int ioffset) {
+    _vertices.assign(vertices+voffset,vertices+voffset+vertsize);
+    resetIndices();
+    appendIndices(indices+ioffset, indxsize);
+    computeType();
+    computeBounds();
+    return *this;
+}
+
 /**
  * Creates a copy of the given polygon.
  *
@@ -546,8 +845,11 @@ Poly2& Poly2::set(Vec2* vertices, int vertsize, unsigned short* indices, int ind
 Poly2& Poly2::set(const Poly2& poly) {
     _vertices.assign(poly._vertices.begin(),poly._vertices.end());
     _indices.assign(poly._indices.begin(),poly._indices.end());
+    _wideindices.assign(poly._wideindices.begin(),poly._wideindices.end());
+    _wide = poly._wide;
     _bounds = poly._bounds;
     _type = poly._type;
+    _accel = std::atomic_load(&poly._accel);
     return *this;
 }
 
@@ -576,6 +878,7 @@ Poly2& Poly2::set(const Rect& rect, bool solid) {
     _vertices[2] = Vec2(rect.origin.x+rect.size.width, rect.origin.y+rect.size.height);
     _vertices[3] = Vec2(rect.origin.x, rect.origin.y+rect.size.height);
     
+    resetIndices();
     if (solid) {
         _indices.resize(6,0);
         _indices[0] = 0;
@@ -598,6 +901,7 @@ Poly2& Poly2::set(const Rect& rect, bool solid) {
         _type = Type::PATH;
     }
     _bounds = rect;
+    _accel = nullptr;
     return *this;
 }
 
@@ -622,11 +926,40 @@ Poly2& Poly2::set(const Rect& rect, bool solid) {
  * @return This polygon, returned for chaining
  */
 Poly2& Poly2::setIndices(const vector<unsigned short>& indices) {
+    resetIndices();
     _indices.assign(indices.begin(), indices.end());
     computeType();
     return *this;
 }
 
+/**
+ * Sets the indices for this polygon to the ones given.
+ *
+ * A valid list of indices must only refer to vertices in the vertex array.
+ * That is, the indices should all be non-negative, and each value should be
+ * less than the number of vertices.
+ *
+ * This assignment will also assign a type according to the multiplicity of the
+ * indices.  If the number of indices is three times the number of vertices,
+ * the type will be SOLID.  If it is two times the number of vertices, the
+ * type will be PATH.  Otherwise, the type will be UNDEFINED.
+ *
+ * This method returns a reference to this polygon for chaining.
+ *
+ * The indices are stored in 16 bits unless they do not fit, in which case
+ * this polygon is {@link isWide wide}.
+ *
+ * @param indices   The vector of indices for the shape
+ *
+ * @return This polygon, returned for chaining
+ */
+Poly2& Poly2::setIndices(const vector<Uint32>& indices) {
+    resetIndices();
+    appendIndices(indices.data(), indices.size());
+    computeType();
+    return *this;
+}
+
 /**
  * Sets the indices for this polygon to the ones given.
  *
@@ -650,11 +983,44 @@ Poly2& Poly2::setIndices(const vector<unsigned short>& indices) {
  * @return This polygon, returned for chaining
  */
 Poly2& Poly2::setIndices(unsigned short* indices, int indxsize, int ioffset) {
+    resetIndices();
     _indices.assign(indices+ioffset, indices+ioffset+indxsize);
     computeType();
     return *this;
 }
 
+/**
+ * Sets the indices for this polygon to the ones given.
+ *
+ * A valid list of indices must only refer to vertices in the vertex array.
+ * That is, the indices should all be non-negative, and each value should be
+ * less than the number of vertices.
+ *
+ * The provided array is copied.  The polygon does not retain a reference.
+ *
+ * This assignment will also assign a type according to the multiplicity of the
+ * indices.  If the number of indices is three times the number of vertices,
+ * the type will be SOLID.  If it is two times the number of vertices, the
+ * type will be PATH.  Otherwise, the type will be UNDEFINED.
+ *
+ * This method returns a reference to this polygon for chaining.
+ *
+ * The indices are stored in 16 bits unless they do not fit, in which case
+ * this polygon is {@link isWide wide}.
+ *
+ * @param indices   The array of indices for the rendering
+ * @param indxsize  The number of elements to use for the indices
+ * @param ioffset   The offset in indices to start from
+ *
+ * @return This polygon, returned for chaining
+ */
+Poly2& Poly2::setIndices(Uint32* indices, int indxsize, int ioffset) {
+    resetIndices();
+    appendIndices(indices+ioffset, indxsize);
+    computeType();
+    return *this;
+}
+
 /**
  * Returns true if the indices are in the proper normal form.
  *
@@ -675,11 +1041,11 @@ Poly2& Poly2::setIndices(unsigned short* indices, int indxsize, int ioffset) {
 bool Poly2::isStandardized() {
     bool result;
     if (_type == Type::SOLID) {
-        result = (_indices.size() % 3 == 0);
+        result = (getIndexCount() % 3 == 0);
     } else if (_type == Type::PATH) {
-        result = (_indices.size() % 2 == 0);
+        result = (getIndexCount() % 2 == 0);
     } else {
-        result = _indices.empty();
+        result = getIndexCount() == 0;
     }
     return result;
 }
@@ -705,16 +1071,16 @@ bool Poly2::isStandardized() {
 bool Poly2::isValid() {
     bool result;
     if (_type == Type::SOLID) {
-        result = (_indices.size() % 3 == 0);
+        result = (getIndexCount() % 3 == 0);
     } else if (_type == Type::PATH) {
-        result = (_indices.size() % 2 == 0);
+        result = (getIndexCount() % 2 == 0);
     } else {
-        result = _indices.empty();
+        result = getIndexCount() == 0;
     }
     
     if (result) {
-        for(int ii = 0; result && ii < _indices.size(); ii++) {
-            result = (_indices[ii] < _vertices.size());
+        for(size_t ii = 0; result && ii < getIndexCount(); ii++) {
+            result = (getIndex(ii) < _vertices.size());
         }
     }
     
@@ -1018,10 +1384,26 @@ bool Poly2::contains(const Vec2& point) const {
     if (_type != Type::SOLID) {
         return false;
     }
+    
+    const Accelerator* accel = getAccelerator();
     bool inside = false;
-    for(int ii = 0; !inside && 3*ii < _indices.size(); ii++) {
-        Vec2 tmp = getBarycentric(point,ii);
-        inside = (0 <= tmp.x && tmp.x <= 1 && 0 <= tmp.y && tmp.y <= 1);
+    if (accel == nullptr) {
+        for(Uint32 ii = 0; !inside && 3*ii < getIndexCount(); ii++) {
+            Vec2 tmp = getBarycentric(point,ii);
+            inside = (0 <= tmp.x && 0 <= tmp.y && tmp.x+tmp.y <= 1);
+        }
+        return inside;
+    }
+    
+    const Rect& box = accel->bounds;
+    if (point.x < box.origin.x || point.x > box.origin.x+box.size.width ||
+        point.y < box.origin.y || point.y > box.origin.y+box.size.height) {
+        return false;
+    }
+    int cell = accel->row(point.y)*accel->cols+accel->column(point.x);
+    for(Uint32 ii = accel->triStart[cell]; !inside && ii < accel->triStart[cell+1]; ii++) {
+        Vec2 tmp = getBarycentric(point,accel->triItems[ii]);
+        inside = (0 <= tmp.x && 0 <= tmp.y && tmp.x+tmp.y <= 1);
     }
     return inside;
 }
@@ -1047,16 +1429,45 @@ bool Poly2::incident(const Vec2& point, float variance) const {
         return false;
     }
     
+    const Accelerator* accel = getAccelerator();
     if (_type == Type::PATH) {
         bool touches = false;
-        for(int ii = 0; !touches && 2*ii < _indices.size(); ii++) {
-            touches = onsegment(point, _vertices[_indices[2*ii]], _vertices[_indices[2*ii+1]], variance);
+        if (accel == nullptr) {
+            for(size_t ii = 0; !touches && 2*ii < getIndexCount(); ii++) {
+                touches = onsegment(point, _vertices[getIndex(2*ii)], _vertices[getIndex(2*ii+1)], variance);
+            }
+            return touches;
+        }
+        
+        // The tolerance region of onsegment is an ellipse about the segment
+        float reach = sqrtf(accel->maxEdge*variance/2+variance*variance/4);
+        reach = std::max(reach,variance);
+        int x0 = accel->column(point.x-reach);
+        int x1 = accel->column(point.x+reach);
+        int y0 = accel->row(point.y-reach);
+        int y1 = accel->row(point.y+reach);
+        for(int yy = y0; !touches && yy <= y1; yy++) {
+            for(int xx = x0; !touches && xx <= x1; xx++) {
+                int cell = yy*accel->cols+xx;
+                for(Uint32 ii = accel->edgeStart[cell]; !touches && ii < accel->edgeStart[cell+1]; ii++) {
+                    Uint32 edge = accel->edgeItems[ii];
+                    touches = onsegment(point, _vertices[accel->edges[2*edge]],
+                                        _vertices[accel->edges[2*edge+1]], variance);
+                }
+            }
         }
         return touches;
     }
     
     // SOLID
-    std::vector<Vec2> hull = convexHull();
+    std::vector<Vec2> local;
+    if (accel == nullptr) {
+        local = convexHull();
+    }
+    const std::vector<Vec2>& hull = (accel == nullptr ? local : accel->hull);
+    if (hull.empty()) {
+        return false;
+    }
     
     bool touches = false;
     for(int ii = 0; !touches && ii+1 < hull.size(); ii++) {
@@ -1067,6 +1478,288 @@ bool Poly2::incident(const Vec2& point, float variance) const {
 }
 
 
+/**
+ * Returns the distance from the point to the nearest boundary edge.
+ *
+ * If the polygon is a PATH, the edges are the segments of the path.  If
+ * it is SOLID, the edges are the boundary edges of the triangulation
+ * (those that belong to exactly one triangle).  This method returns -1
+ * if the polygon has no edges.
+ *
+ * If nearest is not null, it will store the point on the boundary that
+ * is closest to the given point.  If edge is not null, it must be an
+ * array of size two, and it will store the indices of the edge end points.
+ *
+ * @param  point    The point to test
+ * @param  nearest  The point to store the nearest boundary point
+ * @param  edge     The array to store the nearest edge indices
+ *
+ * @return the distance from the point to the nearest boundary edge.
+ */
+float Poly2::nearestEdge(const Vec2& point, Vec2* nearest, Uint32* edge) const {
+    const Accelerator* accel = getAccelerator();
+    std::vector<Uint32> local;
+    if (accel == nullptr) {
+        if (_wide) {
+            boundary_edges(_wideindices, _type, local);
+        } else {
+            boundary_edges(_indices, _type, local);
+        }
+    }
+    const std::vector<Uint32>& edges = (accel == nullptr ? local : accel->edges);
+    if (edges.empty()) {
+        return -1;
+    }
+    
+    float best = -1;
+    Uint32 bestedge = 0;
+    Vec2 bestpoint;
+    auto visit = [&](Uint32 ii) {
+        Vec2 p = segment_nearest(point, _vertices[edges[2*ii]], _vertices[edges[2*ii+1]]);
+        float d = p.distanceSquared(point);
+        if (best < 0 || d < best) {
+            best = d;
+            bestedge = ii;
+            bestpoint = p;
+        }
+    };
+    
+    if (accel == nullptr) {
+        for(Uint32 ii = 0; 2*ii < edges.size(); ii++) {
+            visit(ii);
+        }
+    } else {
+        // Search the grid in rings about the point until nothing closer remains
+        int cx = accel->column(point.x);
+        int cy = accel->row(point.y);
+        float cellw = 1.0f/accel->xscale;
+        float cellh = 1.0f/accel->yscale;
+        int limit = std::max(accel->cols,accel->rows);
+        for(int rr = 0; rr <= limit; rr++) {
+            for(int yy = cy-rr; yy <= cy+rr; yy++) {
+                if (yy < 0 || yy >= accel->rows) {
+                    continue;
+                }
+                int step = (yy == cy-rr || yy == cy+rr) ? 1 : 2*rr;
+                for(int xx = cx-rr; xx <= cx+rr; xx += std::max(step,1)) {
+                    if (xx < 0 || xx >= accel->cols) {
+                        continue;
+                    }
+                    int cell = yy*accel->cols+xx;
+                    for(Uint32 ii = accel->edgeStart[cell]; ii < accel->edgeStart[cell+1]; ii++) {
+                        visit(accel->edgeItems[ii]);
+                    }
+                }
+            }
+            
+            // Distance to the nearest unvisited cell (sides off the grid do not count)
+            float bound = std::numeric_limits<float>::max();
+            const Vec2& origin = accel->bounds.origin;
+            if (cx-rr > 0) {
+                bound = std::min(bound, point.x-(origin.x+(cx-rr)*cellw));
+            }
+            if (cx+rr < accel->cols-1) {
+                bound = std::min(bound, origin.x+(cx+rr+1)*cellw-point.x);
+            }
+            if (cy-rr > 0) {
+                bound = std::min(bound, point.y-(origin.y+(cy-rr)*cellh));
+            }
+            if (cy+rr < accel->rows-1) {
+                bound = std::min(bound, origin.y+(cy+rr+1)*cellh-point.y);
+            }
+            if (best >= 0 && (bound <= 0 || best <= bound*bound)) {
+                break;
+            }
+        }
+    }
+    
+    if (nearest != nullptr) {
+        *nearest = bestpoint;
+    }
+    if (edge != nullptr) {
+        edge[0] = edges[2*bestedge];
+        edge[1] = edges[2*bestedge+1];
+    }
+    return sqrtf(best);
+}
+
+/**
+ * Returns true if the given line segment crosses the polygon boundary.
+ *
+ * The boundary edges are the same as those for {@link nearestEdge}.  If
+ * hit is not null, it will store the boundary crossing that is closest to
+ * start.  Hence this method can be used as a ray cast against the shape.
+ *
+ * @param  start    The start of the line segment
+ * @param  end      The end of the line segment
+ * @param  hit      The point to store the first crossing
+ *
+ * @return true if the given line segment crosses the polygon boundary.
+ */
+bool Poly2::intersects(const Vec2& start, const Vec2& end, Vec2* hit) const {
+    const Accelerator* accel = getAccelerator();
+    std::vector<Uint32> local;
+    if (accel == nullptr) {
+        if (_wide) {
+            boundary_edges(_wideindices, _type, local);
+        } else {
+            boundary_edges(_indices, _type, local);
+        }
+    }
+    const std::vector<Uint32>& edges = (accel == nullptr ? local : accel->edges);
+    
+    float best = 2;
+    auto visit = [&](Uint32 ii) {
+        float t = segment_crossing(start, end, _vertices[edges[2*ii]], _vertices[edges[2*ii+1]]);
+        if (t >= 0 && t < best) {
+            best = t;
+        }
+    };
+    
+    if (accel == nullptr) {
+        for(Uint32 ii = 0; 2*ii < edges.size(); ii++) {
+            visit(ii);
+        }
+    } else if (!edges.empty()) {
+        // Clip the segment to the grid
+        Vec2 dir = end-start;
+        const Rect& box = accel->bounds;
+        float lo[2] = { box.origin.x, box.origin.y };
+        float hi[2] = { box.origin.x+box.size.width, box.origin.y+box.size.height };
+        float org[2] = { start.x, start.y };
+        float vec[2] = { dir.x, dir.y };
+        float t0 = 0;
+        float t1 = 1;
+        for(int axis = 0; axis < 2 && t0 <= t1; axis++) {
+            if (vec[axis] == 0) {
+                if (org[axis] < lo[axis] || org[axis] > hi[axis]) {
+                    t0 = 2;
+                }
+            } else {
+                float ta = (lo[axis]-org[axis])/vec[axis];
+                float tb = (hi[axis]-org[axis])/vec[axis];
+                t0 = std::max(t0,std::min(ta,tb));
+                t1 = std::min(t1,std::max(ta,tb));
+            }
+        }
+        
+        if (t0 <= t1) {
+            // Walk the cells along the segment, stopping once a crossing precedes the next cell
+            Vec2 entry = start+dir*t0;
+            int cx = accel->column(entry.x);
+            int cy = accel->row(entry.y);
+            int stepx = (dir.x > 0 ? 1 : (dir.x < 0 ? -1 : 0));
+            int stepy = (dir.y > 0 ? 1 : (dir.y < 0 ? -1 : 0));
+            float cellw = 1.0f/accel->xscale;
+            float cellh = 1.0f/accel->yscale;
+            float inf = std::numeric_limits<float>::max();
+            float nextx = stepx == 0 ? inf : (box.origin.x+(cx+(stepx > 0))*cellw-start.x)/dir.x;
+            float nexty = stepy == 0 ? inf : (box.origin.y+(cy+(stepy > 0))*cellh-start.y)/dir.y;
+            float deltax = stepx == 0 ? inf : cellw/fabsf(dir.x);
+            float deltay = stepy == 0 ? inf : cellh/fabsf(dir.y);
+            while (true) {
+                int cell = cy*accel->cols+cx;
+                for(Uint32 ii = accel->edgeStart[cell]; ii < accel->edgeStart[cell+1]; ii++) {
+                    visit(accel->edgeItems[ii]);
+                }
+                float exit = std::min(nextx,nexty);
+                if (best <= exit || exit > t1) {
+                    break;
+                }
+                if (nextx < nexty) {
+                    cx += stepx;
+                    nextx += deltax;
+                } else {
+                    cy += stepy;
+                    nexty += deltay;
+                }
+                if (cx < 0 || cx >= accel->cols || cy < 0 || cy >= accel->rows) {
+                    break;
+                }
+            }
+        }
+    }
+    
+    if (best > 1) {
+        return false;
+    }
+    if (hit != nullptr) {
+        *hit = start+(end-start)*best;
+    }
+    return true;
+}
+
+/**
+ * Builds the spatial index for the geometry queries.
+ *
+ * The geometry queries ({@link contains}, {@link incident}, {@link
+ * nearestEdge}, and {@link intersects}) use a uniform grid over the
+ * triangles and the boundary edges of a large polygon.  The grid is
+ * built the first time that it is needed, and it is discarded whenever
+ * the polygon is modified.  Small polygons are simply scanned instead.
+ *
+ * The index is published atomically, so the queries may be performed on
+ * several threads at once.  If several threads need the index at the
+ * same time, they may each build it, but only the first one is kept.
+ * Calling this method first avoids that wasted work, and forces the index
+ * to be built regardless of the polygon size.  Copies of this polygon
+ * share the index until either one is modified.  It is never safe to
+ * modify a polygon while another thread is querying it.
+ */
+void Poly2::accelerate() const {
+    if (_vertices.empty() || std::atomic_load(&_accel) != nullptr) {
+        return;
+    }
+    
+    std::shared_ptr<Accelerator> accel = std::make_shared<Accelerator>();
+    if (_wide) {
+        boundary_edges(_wideindices, _type, accel->edges);
+    } else {
+        boundary_edges(_indices, _type, accel->edges);
+    }
+    size_t tris = (_type == Type::SOLID ? getIndexCount()/3 : 0);
+    size_t segs = accel->edges.size()/2;
+    
+    // Recompute the bounds, as at() may have moved a vertex
+    Vec2 lo = _vertices[0];
+    Vec2 hi = lo;
+    for(auto it = _vertices.begin()+1; it != _vertices.end(); ++it) {
+        lo.x = std::min(lo.x,it->x); lo.y = std::min(lo.y,it->y);
+        hi.x = std::max(hi.x,it->x); hi.y = std::max(hi.y,it->y);
+    }
+    
+    // Aim for about one primitive per cell
+    float width  = std::max(hi.x-lo.x,CU_MATH_EPSILON);
+    float height = std::max(hi.y-lo.y,CU_MATH_EPSILON);
+    accel->bounds.set(lo.x,lo.y,width,height);
+    float count  = (float)std::max(std::max(tris,segs),(size_t)1);
+    int cols = (int)ceilf(sqrtf(count*width/height));
+    int rows = (int)ceilf(count/cols);
+    accel->cols = std::min(std::max(cols,1),GRID_MAX_DIM);
+    accel->rows = std::min(std::max(rows,1),GRID_MAX_DIM);
+    accel->xscale = accel->cols/width;
+    accel->yscale = accel->rows/height;
+    
+    if (_wide) {
+        accel->fill(_vertices, _wideindices.data(), tris, 3, accel->triStart, accel->triItems);
+    } else {
+        accel->fill(_vertices, _indices.data(), tris, 3, accel->triStart, accel->triItems);
+    }
+    accel->fill(_vertices, accel->edges.data(), segs, 2, accel->edgeStart, accel->edgeItems);
+    accel->maxEdge = 0;
+    for(size_t ii = 0; ii < segs; ii++) {
+        float len = _vertices[accel->edges[2*ii]].distance(_vertices[accel->edges[2*ii+1]]);
+        accel->maxEdge = std::max(accel->maxEdge,len);
+    }
+    if (_type == Type::SOLID) {
+        accel->hull = convexHull();
+    }
+    
+    // Keep the first index if another thread built one at the same time
+    std::shared_ptr<Accelerator> expected;
+    std::atomic_compare_exchange_strong(&_accel, &expected, accel);
+}
+
 #pragma mark -
 #pragma mark Internal Helpers
 
@@ -1077,6 +1770,7 @@ bool Poly2::incident(const Vec2& point, float variance) const {
  * this polygon.  It is recomputed whenever the vertices are set.
  */
 void Poly2::computeBounds() {
+    _accel = nullptr;
     float minx, maxx;
     float miny, maxy;
     
@@ -1112,7 +1806,8 @@ void Poly2::computeBounds() {
  * type will be PATH.  Otherwise, the type will be UNDEFINED.
  */
 void Poly2::computeType() {
-    int n = (int)_indices.size();
+    _accel = nullptr;
+    int n = (int)getIndexCount();
     int k = (int)_vertices.size();
     if (n % 2 == 0 && (n == 2*k || n == 2*k-2)) {
         _type = Type::PATH;
@@ -1133,10 +1828,10 @@ void Poly2::computeType() {
  *
  * This method is not defined if the polygon is not SOLID.
  */
-Vec2 Poly2::getBarycentric(const Vec2& point, unsigned short index) const {
-    Vec2 a = _vertices[_indices[3*index  ]];
-    Vec2 b = _vertices[_indices[3*index+1]];
-    Vec2 c = _vertices[_indices[3*index+2]];
+Vec2 Poly2::getBarycentric(const Vec2& point, Uint32 index) const {
+    Vec2 a = _vertices[getIndex(3*index)];
+    Vec2 b = _vertices[getIndex(3*index+1)];
+    Vec2 c = _vertices[getIndex(3*index+2)];
     
     float det = (b.y-c.y)*(a.x-c.x)+(c.x-b.x)*(a.y-c.y);
     Vec2 result;
@@ -1146,3 +1841,92 @@ Vec2 Poly2::getBarycentric(const Vec2& point, unsigned short index) const {
     result.y /= det;
     return result;
 }
+
+/**
+ * Returns the spatial index for this polygon, building it if necessary.
+ *
+ * This method returns nullptr if the polygon is too small to benefit
+ * from an index (and the index was not forced by {@link accelerate}).
+ *
+ * @return the spatial index for this polygon, building it if necessary.
+ */
+const Poly2::Accelerator* Poly2::getAccelerator() const {
+    std::shared_ptr<Accelerator> accel = std::atomic_load(&_accel);
+    if (accel == nullptr) {
+        size_t count = (_type == Type::SOLID ? getIndexCount()/3 : getIndexCount()/2);
+        if (count < GRID_THRESHOLD) {
+            return nullptr;
+        }
+        accelerate();
+        accel = std::atomic_load(&_accel);
+    }
+    // Once published, the index is only replaced by a modification
+    return accel.get();
+}
+
+/**
+ * Moves the indices of this polygon to the wide (32 bit) list.
+ *
+ * This method does nothing if the polygon is already wide.
+ */
+void Poly2::widen() {
+    if (!_wide) {
+        _wideindices.assign(_indices.begin(), _indices.end());
+        _indices.clear();
+        _indices.shrink_to_fit();
+        _wide = true;
+    }
+}
+
+/**
+ * Moves the indices of this polygon to the 16 bit list.
+ *
+ * This method does nothing if the polygon is not wide.  Otherwise, it
+ * requires that the polygon have at most 65536 vertices.
+ */
+void Poly2::narrow() {
+    if (_wide) {
+        CUAssertLog(_vertices.size() <= 65536,
+                    "Polygon has too many vertices for 16 bit indices: %d", (int)_vertices.size());
+        _indices.assign(_wideindices.begin(), _wideindices.end());
+        _wideindices.clear();
+        _wideindices.shrink_to_fit();
+        _wide = false;
+    }
+}
+
+/**
+ * Reserves room for the given number of additional indices.
+ *
+ * The polygon is widened first if its vertices no longer fit in 16 bit
+ * indices.  Hence this method should be called after the vertices for
+ * the new indices have been added.
+ *
+ * @param count The number of indices to reserve
+ */
+void Poly2::reserveIndices(size_t count) {
+    if (_vertices.size() > 65536) {
+        widen();
+    }
+    if (_wide) {
+        _wideindices.reserve(_wideindices.size()+count);
+    } else {
+        _indices.reserve(_indices.size()+count);
+    }
+}
+
+/**
+ * Appends the given indices to this polygon, widening it if necessary.
+ *
+ * The value offset is added to every index.
+ *
+ * @param indices   The array of indices to append
+ * @param count     The number of indices to append
+ * @param offset    The amount to add to each index
+ */
+void Poly2::appendIndices(const Uint32* indices, size_t count, Uint32 offset) {
+    reserveIndices(count);
+    for(size_t ii = 0; ii < count; ii++) {
+        pushIndex(indices[ii]+offset);
+    }
+}
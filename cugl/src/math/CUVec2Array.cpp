@@ -0,0 +1,385 @@
+//
+//  CUVec2Array.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for a structure-of-arrays collection of 2d
+//  vectors.  Particle systems and procedural meshes apply the same operation
+//  to thousands of points each frame.  Looping over a std::vector<Vec2> and
+//  calling the Vec2 methods one at a time wastes most of the vector unit.
+//  This class stores the x and y coordinates in separate arrays, so that the
+//  bulk operations can process 4 (SSE2, NEON) or 8 (AVX2) points at once.
+//
+//  The instruction set is chosen at runtime the first time that a bulk
+//  operation is used.  The results are the same as the Vec2 methods.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+#include <cugl/util/CUDebug.h>
+#include <cugl/math/CUVec2Array.h>
+#include <cugl/math/CUAffine2.h>
+#include <cugl/math/CUMat4.h>
+#include <cugl/renderer/CUVertex.h>
+#include "Array-SIMD.inl"
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Setters
+/**
+ * Sets this array to a copy of the given vectors.
+ *
+ * @param points    The vectors to copy
+ * @param size      The number of vectors to copy
+ *
+ * @return This array, after assignment
+ */
+Vec2Array& Vec2Array::set(const Vec2* points, size_t size) {
+    CUAssertLog(points || !size, "Source array is null");
+    _x.resize(size);
+    _y.resize(size);
+    for(size_t ii = 0; ii < size; ii++) {
+        _x[ii] = points[ii].x;
+        _y[ii] = points[ii].y;
+    }
+    return *this;
+}
+
+/**
+ * Sets every element of this array to the given vector.
+ *
+ * The size of this array is unchanged.
+ *
+ * @param v     The vector value
+ *
+ * @return This array, after assignment
+ */
+Vec2Array& Vec2Array::fill(const Vec2& v) {
+    std::fill(_x.begin(),_x.end(),v.x);
+    std::fill(_y.begin(),_y.end(),v.y);
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Element Access
+/**
+ * Removes the element at the given position, replacing it with the last.
+ *
+ * This is the standard way to kill a particle in O(1) time.  It does not
+ * preserve the order of the elements.
+ *
+ * @param index The position to remove
+ */
+void Vec2Array::swapRemove(size_t index) {
+    CUAssertLog(index < _x.size(), "Index %zu is out of bounds", index);
+    _x[index] = _x.back();
+    _y[index] = _y.back();
+    _x.pop_back();
+    _y.pop_back();
+}
+
+
+#pragma mark -
+#pragma mark Arithmetic
+/**
+ * Adds the given vector to every element of this array.
+ *
+ * @param v     The vector to add
+ *
+ * @return This array, after the addition
+ */
+Vec2Array& Vec2Array::add(const Vec2& v) {
+    const ArrayKernels* kernels = array_kernels();
+    kernels->madd(_x.data(),_x.data(),1.0f,v.x,_x.size());
+    kernels->madd(_y.data(),_y.data(),1.0f,v.y,_y.size());
+    return *this;
+}
+
+/**
+ * Adds the elements of the given array to this one.
+ *
+ * The arrays must be the same size.
+ *
+ * @param other The array to add
+ *
+ * @return This array, after the addition
+ */
+Vec2Array& Vec2Array::add(const Vec2Array& other) {
+    return add(other,1.0f);
+}
+
+/**
+ * Adds the elements of the given array, scaled by s, to this one.
+ *
+ * This is the standard Euler step (e.g. add the velocities times dt to
+ * the positions).  The arrays must be the same size.
+ *
+ * @param other The array to add
+ * @param s     The scale factor
+ *
+ * @return This array, after the addition
+ */
+Vec2Array& Vec2Array::add(const Vec2Array& other, float s) {
+    CUAssertLog(other.size() == size(), "Array sizes do not match");
+    const ArrayKernels* kernels = array_kernels();
+    kernels->axpby(_x.data(),_x.data(),1.0f,other._x.data(),s,_x.size());
+    kernels->axpby(_y.data(),_y.data(),1.0f,other._y.data(),s,_y.size());
+    return *this;
+}
+
+/**
+ * Subtracts the given vector from every element of this array.
+ *
+ * @param v     The vector to subtract
+ *
+ * @return This array, after the subtraction
+ */
+Vec2Array& Vec2Array::subtract(const Vec2& v) {
+    const ArrayKernels* kernels = array_kernels();
+    kernels->madd(_x.data(),_x.data(),1.0f,-v.x,_x.size());
+    kernels->madd(_y.data(),_y.data(),1.0f,-v.y,_y.size());
+    return *this;
+}
+
+/**
+ * Subtracts the elements of the given array from this one.
+ *
+ * The arrays must be the same size.
+ *
+ * @param other The array to subtract
+ *
+ * @return This array, after the subtraction
+ */
+Vec2Array& Vec2Array::subtract(const Vec2Array& other) {
+    return add(other,-1.0f);
+}
+
+/**
+ * Scales every element of this array uniformly by s.
+ *
+ * @param s     The scale factor
+ *
+ * @return This array, after the scaling
+ */
+Vec2Array& Vec2Array::scale(float s) {
+    return scale(Vec2(s,s));
+}
+
+/**
+ * Scales every element of this array nonuniformly by v.
+ *
+ * @param v     The scale factor
+ *
+ * @return This array, after the scaling
+ */
+Vec2Array& Vec2Array::scale(const Vec2& v) {
+    const ArrayKernels* kernels = array_kernels();
+    kernels->madd(_x.data(),_x.data(),v.x,0.0f,_x.size());
+    kernels->madd(_y.data(),_y.data(),v.y,0.0f,_y.size());
+    return *this;
+}
+
+/**
+ * Clamps every element of this array to the given range.
+ *
+ * @param min   The minimum value
+ * @param max   The maximum value
+ *
+ * @return This array, after the clamping
+ */
+Vec2Array& Vec2Array::clamp(const Vec2& min, const Vec2& max) {
+    CUAssertLog(min.x <= max.x && min.y <= max.y, "Minimum is greater than maximum");
+    const ArrayKernels* kernels = array_kernels();
+    kernels->clamp(_x.data(),_x.data(),min.x,max.x,_x.size());
+    kernels->clamp(_y.data(),_y.data(),min.y,max.y,_y.size());
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Linear Algebra
+/**
+ * Normalizes every element of this array.
+ *
+ * As with {@link Vec2#normalize}, an element that is too close to the
+ * origin is left unchanged.
+ *
+ * @return This array, after normalization
+ */
+Vec2Array& Vec2Array::normalize() {
+    array_kernels()->normalize(_x.data(),_y.data(),_x.size());
+    return *this;
+}
+
+/**
+ * Rotates every element of this array by the angle around the origin.
+ *
+ * @param angle The angle to rotate by (in radians)
+ *
+ * @return This array, after the rotation
+ */
+Vec2Array& Vec2Array::rotate(float angle) {
+    Vec2 r = Vec2::forAngle(angle);
+    array_kernels()->linear(_x.data(),_y.data(),_x.data(),_y.data(),
+                            r.x,-r.y,0.0f,r.y,r.x,0.0f,_x.size());
+    return *this;
+}
+
+/**
+ * Rotates every element of this array by the angle around the given point.
+ *
+ * @param angle The angle to rotate by (in radians)
+ * @param point The point to rotate around
+ *
+ * @return This array, after the rotation
+ */
+Vec2Array& Vec2Array::rotate(float angle, const Vec2& point) {
+    // Three passes, so that the result matches Vec2 exactly
+    subtract(point);
+    rotate(angle);
+    return add(point);
+}
+
+/**
+ * Linearly interpolates every element of this array with the other.
+ *
+ * If alpha is 0, the elements are unchanged.  If alpha is 1, the elements
+ * are the elements of other.  The arrays must be the same size.
+ *
+ * @param other The other end of the line segment
+ * @param alpha The interpolation value
+ *
+ * @return This array, after the interpolation
+ */
+Vec2Array& Vec2Array::lerp(const Vec2Array& other, float alpha) {
+    CUAssertLog(other.size() == size(), "Array sizes do not match");
+    const ArrayKernels* kernels = array_kernels();
+    kernels->axpby(_x.data(),_x.data(),1.0f-alpha,other._x.data(),alpha,_x.size());
+    kernels->axpby(_y.data(),_y.data(),1.0f-alpha,other._y.data(),alpha,_y.size());
+    return *this;
+}
+
+/**
+ * Stores the dot products of this array with the other in output.
+ *
+ * The arrays must be the same size.  The output array must have room
+ * for {@link size} elements.
+ *
+ * @param other     The array to dot with this one
+ * @param output    The array to store the dot products
+ *
+ * @return A reference to output for chaining
+ */
+float* Vec2Array::dot(const Vec2Array& other, float* output) const {
+    CUAssertLog(other.size() == size(), "Array sizes do not match");
+    CUAssertLog(output || empty(), "Destination array is null");
+    array_kernels()->dot(output,_x.data(),_y.data(),other._x.data(),other._y.data(),_x.size());
+    return output;
+}
+
+
+#pragma mark -
+#pragma mark Transforms
+/**
+ * Transforms every element of this array by the given affine transform.
+ *
+ * @param aff   The affine transform
+ *
+ * @return This array, after the transform
+ */
+Vec2Array& Vec2Array::transform(const Affine2& aff) {
+    array_kernels()->linear(_x.data(),_y.data(),_x.data(),_y.data(),
+                            aff.m[0],aff.m[1],aff.offset.x,
+                            aff.m[2],aff.m[3],aff.offset.y,_x.size());
+    return *this;
+}
+
+/**
+ * Transforms every element of this array by the given matrix.
+ *
+ * The elements are treated as points (as in {@link Mat4#transform}),
+ * which means that translation is applied to the result.
+ *
+ * @param mat   The transform matrix
+ *
+ * @return This array, after the transform
+ */
+Vec2Array& Vec2Array::transform(const Mat4& mat) {
+    array_kernels()->linear(_x.data(),_y.data(),_x.data(),_y.data(),
+                            mat.m[0],mat.m[4],mat.m[12],
+                            mat.m[1],mat.m[5],mat.m[13],_x.size());
+    return *this;
+}
+
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Copies this array into the given array of vectors.
+ *
+ * The output array must have room for {@link size} elements.
+ *
+ * @param output    The array to store the vectors
+ *
+ * @return A reference to output for chaining
+ */
+Vec2* Vec2Array::pack(Vec2* output) const {
+    CUAssertLog(output || empty(), "Destination array is null");
+    array_kernels()->interleave(reinterpret_cast<float*>(output),2,
+                                _x.data(),_y.data(),_x.size());
+    return output;
+}
+
+/**
+ * Copies this array into the positions of the given vertices.
+ *
+ * Only the vertex positions are modified.  The output array must have
+ * room for {@link size} elements.
+ *
+ * @param output    The vertices to store the positions
+ *
+ * @return A reference to output for chaining
+ */
+Vertex2* Vec2Array::pack(Vertex2* output) const {
+    CUAssertLog(output || empty(), "Destination array is null");
+    if (empty()) {
+        return output;
+    }
+    float* start = reinterpret_cast<float*>(&(output->position));
+    array_kernels()->interleave(start,sizeof(Vertex2)/sizeof(float),
+                                _x.data(),_y.data(),_x.size());
+    return output;
+}
+
+/**
+ * Returns this array as a vector of Vec2 objects.
+ *
+ * @return this array as a vector of Vec2 objects.
+ */
+Vec2Array::operator std::vector<Vec2>() const {
+    std::vector<Vec2> result(_x.size());
+    pack(result.data());
+    return result;
+}
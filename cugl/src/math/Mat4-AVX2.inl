@@ -0,0 +1,376 @@
+//
+//  Mat4-AVX2.inl
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides vectorized support for matrix multiplication on AVX2
+//  platforms.  It is an extension of the SSE module, and is chosen instead of
+//  that module when the compiler targets AVX2 (e.g. -mavx2 or /arch:AVX2).
+//  A 256-bit register holds two matrix columns, which halves the work of the
+//  element-wise operations and of matrix multiplication.  The batch kernels
+//  transform twice as many vectors per instruction as the SSE versions.
+//
+//  As with the SSE module, all loads and stores are unaligned.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  This module is based on an original file from GamePlay3D: http://gameplay3d.org.
+//  It has been modified to support the CUGL framework.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#include <immintrin.h>
+
+/**
+ * Loads the given column of the matrix into an SSE register
+ *
+ * @param mat   The matrix
+ * @param col   The column index
+ *
+ * @return the SSE register for the column
+ */
+static inline __m128 mat4_col(const Mat4& mat, int col) {
+    return _mm_loadu_ps(mat.m+4*col);
+}
+
+/**
+ * Loads the given column of the matrix into both halves of an AVX register
+ *
+ * @param mat   The matrix
+ * @param col   The column index
+ *
+ * @return the AVX register for the column
+ */
+static inline __m256 mat4_dup(const Mat4& mat, int col) {
+    __m128 c = _mm_loadu_ps(mat.m+4*col);
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(c), c, 1);
+}
+
+/**
+ * Returns the product of the matrix columns with the given vector
+ *
+ * This is the transform of the vector (as a column) by the matrix.
+ *
+ * @param c0    The first matrix column
+ * @param c1    The second matrix column
+ * @param c2    The third matrix column
+ * @param c3    The fourth matrix column
+ * @param vec   The vector to transform
+ *
+ * @return the product of the matrix columns with the given vector
+ */
+static inline __m128 mat4_apply(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 vec) {
+    __m128 e0 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 e1 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 e2 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 e3 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, e0), _mm_mul_ps(c1, e1)),
+                      _mm_add_ps(_mm_mul_ps(c2, e2), _mm_mul_ps(c3, e3)));
+}
+
+/**
+ * Returns the product of the matrix columns with two vectors at once
+ *
+ * The columns are duplicated in both halves of the registers.  The two
+ * vectors are the two halves of vecs.
+ *
+ * @param c0    The first matrix column (duplicated)
+ * @param c1    The second matrix column (duplicated)
+ * @param c2    The third matrix column (duplicated)
+ * @param c3    The fourth matrix column (duplicated)
+ * @param vecs  The two vectors to transform
+ *
+ * @return the product of the matrix columns with two vectors at once
+ */
+static inline __m256 mat4_apply2(__m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 vecs) {
+    __m256 e0 = _mm256_permute_ps(vecs, _MM_SHUFFLE(0, 0, 0, 0));
+    __m256 e1 = _mm256_permute_ps(vecs, _MM_SHUFFLE(1, 1, 1, 1));
+    __m256 e2 = _mm256_permute_ps(vecs, _MM_SHUFFLE(2, 2, 2, 2));
+    __m256 e3 = _mm256_permute_ps(vecs, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c0, e0), _mm256_mul_ps(c1, e1)),
+                         _mm256_add_ps(_mm256_mul_ps(c2, e2), _mm256_mul_ps(c3, e3)));
+}
+
+/**
+ * Adds a scalar to each component of mat and stores the result in dst.
+ *
+ * @param mat       The matrix to add to.
+ * @param scalar    The scalar value to add.
+ * @param dst       A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::add(const Mat4& mat, float scalar, Mat4* dst) {
+    __m256 s = _mm256_set1_ps(scalar);
+    _mm256_storeu_ps(dst->m,   _mm256_add_ps(_mm256_loadu_ps(mat.m),   s));
+    _mm256_storeu_ps(dst->m+8, _mm256_add_ps(_mm256_loadu_ps(mat.m+8), s));
+    return dst;
+}
+
+/**
+ * Adds the specified matrices and stores the result in dst.
+ *
+ * @param m1    The first matrix.
+ * @param m2    The second matrix.
+ * @param dst   The destination matrix to add to.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::add(const Mat4& m1, const Mat4& m2, Mat4* dst) {
+    _mm256_storeu_ps(dst->m,   _mm256_add_ps(_mm256_loadu_ps(m1.m),   _mm256_loadu_ps(m2.m)));
+    _mm256_storeu_ps(dst->m+8, _mm256_add_ps(_mm256_loadu_ps(m1.m+8), _mm256_loadu_ps(m2.m+8)));
+    return dst;
+}
+
+/**
+ * Subtracts a scalar from each component of mat and stores the result in dst.
+ *
+ * @param mat       The matrix to subtract from.
+ * @param scalar    The scalar value to subtract.
+ * @param dst       A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::subtract(const Mat4& mat, float scalar, Mat4* dst) {
+    __m256 s = _mm256_set1_ps(scalar);
+    _mm256_storeu_ps(dst->m,   _mm256_sub_ps(_mm256_loadu_ps(mat.m),   s));
+    _mm256_storeu_ps(dst->m+8, _mm256_sub_ps(_mm256_loadu_ps(mat.m+8), s));
+    return dst;
+}
+
+/**
+ * Subtracts the matrix m2 from m1 and stores the result in dst.
+ *
+ * @param m1    The first matrix.
+ * @param m2    The second matrix.
+ * @param dst   A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::subtract(const Mat4& m1, const Mat4& m2, Mat4* dst) {
+    _mm256_storeu_ps(dst->m,   _mm256_sub_ps(_mm256_loadu_ps(m1.m),   _mm256_loadu_ps(m2.m)));
+    _mm256_storeu_ps(dst->m+8, _mm256_sub_ps(_mm256_loadu_ps(m1.m+8), _mm256_loadu_ps(m2.m+8)));
+    return dst;
+}
+
+/**
+ * Multiplies the specified matrix by a scalar and stores the result in dst.
+ *
+ * @param mat       The matrix.
+ * @param scalar    The scalar value.
+ * @param dst       A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::multiply(const Mat4& mat, float scalar, Mat4* dst) {
+    __m256 s = _mm256_set1_ps(scalar);
+    _mm256_storeu_ps(dst->m,   _mm256_mul_ps(_mm256_loadu_ps(mat.m),   s));
+    _mm256_storeu_ps(dst->m+8, _mm256_mul_ps(_mm256_loadu_ps(mat.m+8), s));
+    return dst;
+}
+
+/**
+ * Multiplies m1 by the matrix m2 and stores the result in dst.
+ *
+ * The matrix m2 is on the right.  This means that it corresponds to
+ * an subsequent transform, when looking at a sequence of transforms.
+ *
+ * @param m1    The first matrix to multiply.
+ * @param m2    The second matrix to multiply.
+ * @param dst   A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::multiply(const Mat4& m1, const Mat4& m2, Mat4* dst) {
+    // Load everything first, as dst may be m1 or m2
+    __m256 b0 = mat4_dup(m2, 0);
+    __m256 b1 = mat4_dup(m2, 1);
+    __m256 b2 = mat4_dup(m2, 2);
+    __m256 b3 = mat4_dup(m2, 3);
+    __m256 a01 = _mm256_loadu_ps(m1.m);
+    __m256 a23 = _mm256_loadu_ps(m1.m+8);
+    
+    _mm256_storeu_ps(dst->m,   mat4_apply2(b0, b1, b2, b3, a01));
+    _mm256_storeu_ps(dst->m+8, mat4_apply2(b0, b1, b2, b3, a23));
+    return dst;
+}
+
+/**
+ * Negates m1 and stores the result in dst.
+ *
+ * @param m1    The matrix to negate.
+ * @param dst   A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::negate(const Mat4& mat, Mat4* dst) {
+    __m256 z = _mm256_setzero_ps();
+    _mm256_storeu_ps(dst->m,   _mm256_sub_ps(z, _mm256_loadu_ps(mat.m)));
+    _mm256_storeu_ps(dst->m+8, _mm256_sub_ps(z, _mm256_loadu_ps(mat.m+8)));
+    return dst;
+}
+
+/**
+ * Transposes m1 and stores the result in dst.
+ *
+ * Transposing a matrix swaps columns and rows. This allows to transform
+ * a vector by multiplying it on the left. If the matrix is orthonormal,
+ * this is also the inverse.
+ *
+ * @param m1    The matrix to negate.
+ * @param dst   A matrix to store the result in.
+ *
+ * @return A reference to dst for chaining
+ */
+Mat4* Mat4::transpose(const Mat4& m1, Mat4* dst) {
+    __m128 c0 = mat4_col(m1, 0);
+    __m128 c1 = mat4_col(m1, 1);
+    __m128 c2 = mat4_col(m1, 2);
+    __m128 c3 = mat4_col(m1, 3);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(dst->m,    c0);
+    _mm_storeu_ps(dst->m+4,  c1);
+    _mm_storeu_ps(dst->m+8,  c2);
+    _mm_storeu_ps(dst->m+12, c3);
+    return dst;
+}
+
+/**
+ * Transforms the vector by the given matrix, and stores the result in dst.
+ *
+ * The vector is treated as is.  Hence whether or not translation is applied
+ * depends on the value of w.
+ *
+ * @param mat   The transform matrix.
+ * @param vec   The vector to transform.
+ * @param dst   A vector to store the transformed point in.
+ *
+ * @return A reference to dst for chaining
+ */
+Vec4* Mat4::transform(const Mat4& mat, const Vec4& vec, Vec4* dst) {
+    __m128 v = _mm_loadu_ps(&vec.x);
+    v = mat4_apply(mat4_col(mat, 0), mat4_col(mat, 1), mat4_col(mat, 2), mat4_col(mat, 3), v);
+    _mm_storeu_ps(&dst->x, v);
+    return dst;
+}
+
+
+#pragma mark -
+#pragma mark Batch Kernels
+/**
+ * Transforms the array of points, returning the number transformed
+ *
+ * The kernel transforms as many points as it can efficiently.  The caller
+ * is responsible for transforming any remaining points.
+ *
+ * @param mat       The transform matrix
+ * @param input     The points to transform
+ * @param size      The number of points
+ * @param output    The array to store the transformed points
+ *
+ * @return the number of points transformed
+ */
+static size_t mat4_batch(const Mat4& mat, const Vec2* input, size_t size, Vec2* output) {
+    // Four points per register: (x0, y0, x1, y1, x2, y2, x3, y3)
+    __m256 cx = _mm256_setr_ps(mat.m[0],  mat.m[1],  mat.m[0],  mat.m[1],
+                               mat.m[0],  mat.m[1],  mat.m[0],  mat.m[1]);
+    __m256 cy = _mm256_setr_ps(mat.m[4],  mat.m[5],  mat.m[4],  mat.m[5],
+                               mat.m[4],  mat.m[5],  mat.m[4],  mat.m[5]);
+    __m256 ct = _mm256_setr_ps(mat.m[12], mat.m[13], mat.m[12], mat.m[13],
+                               mat.m[12], mat.m[13], mat.m[12], mat.m[13]);
+    
+    const float* src = reinterpret_cast<const float*>(input);
+    float* dst = reinterpret_cast<float*>(output);
+    size_t ii = 0;
+    for(; ii+8 <= size; ii += 8) {
+        __m256 v0 = _mm256_loadu_ps(src+2*ii);
+        __m256 v1 = _mm256_loadu_ps(src+2*ii+8);
+        __m256 x0 = _mm256_permute_ps(v0, _MM_SHUFFLE(2, 2, 0, 0));
+        __m256 y0 = _mm256_permute_ps(v0, _MM_SHUFFLE(3, 3, 1, 1));
+        __m256 x1 = _mm256_permute_ps(v1, _MM_SHUFFLE(2, 2, 0, 0));
+        __m256 y1 = _mm256_permute_ps(v1, _MM_SHUFFLE(3, 3, 1, 1));
+        _mm256_storeu_ps(dst+2*ii,   _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, x0), _mm256_mul_ps(cy, y0)), ct));
+        _mm256_storeu_ps(dst+2*ii+8, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, x1), _mm256_mul_ps(cy, y1)), ct));
+    }
+    return ii;
+}
+
+/**
+ * Transforms the array of points, returning the number transformed
+ *
+ * The kernel transforms as many points as it can efficiently.  The caller
+ * is responsible for transforming any remaining points.
+ *
+ * Three-element vectors do not pack into AVX registers, so this kernel is
+ * the same as the SSE one.
+ *
+ * @param mat       The transform matrix
+ * @param input     The points to transform
+ * @param size      The number of points
+ * @param output    The array to store the transformed points
+ *
+ * @return the number of points transformed
+ */
+static size_t mat4_batch(const Mat4& mat, const Vec3* input, size_t size, Vec3* output) {
+    __m128 c0 = mat4_col(mat, 0);
+    __m128 c1 = mat4_col(mat, 1);
+    __m128 c2 = mat4_col(mat, 2);
+    __m128 c3 = mat4_col(mat, 3);
+    for(size_t ii = 0; ii < size; ii++) {
+        // Read all three components before writing (output may be input)
+        __m128 x = _mm_set1_ps(input[ii].x);
+        __m128 y = _mm_set1_ps(input[ii].y);
+        __m128 z = _mm_set1_ps(input[ii].z);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)),
+                              _mm_add_ps(_mm_mul_ps(c2, z), c3));
+        _mm_storel_pi(reinterpret_cast<__m64*>(&output[ii].x), r);
+        _mm_store_ss(&output[ii].z, _mm_movehl_ps(r, r));
+    }
+    return size;
+}
+
+/**
+ * Transforms the array of vectors, returning the number transformed
+ *
+ * The kernel transforms as many vectors as it can efficiently.  The caller
+ * is responsible for transforming any remaining vectors.
+ *
+ * @param mat       The transform matrix
+ * @param input     The vectors to transform
+ * @param size      The number of vectors
+ * @param output    The array to store the transformed vectors
+ *
+ * @return the number of vectors transformed
+ */
+static size_t mat4_batch(const Mat4& mat, const Vec4* input, size_t size, Vec4* output) {
+    __m256 c0 = mat4_dup(mat, 0);
+    __m256 c1 = mat4_dup(mat, 1);
+    __m256 c2 = mat4_dup(mat, 2);
+    __m256 c3 = mat4_dup(mat, 3);
+    size_t ii = 0;
+    for(; ii+2 <= size; ii += 2) {
+        __m256 v = _mm256_loadu_ps(&input[ii].x);
+        _mm256_storeu_ps(&output[ii].x, mat4_apply2(c0, c1, c2, c3, v));
+    }
+    return ii;
+}
@@ -5,7 +5,12 @@
 //  This module provides vectorized support for matrix multiplication on SSE
 //  (e.g. Windows) platforms.  Profiling tests show that it is really not that
 //  much slower than non-vectorized computation because of the small size of
-//  the matrix.
+//  the matrix.  The real gains are in the batch transforms at the bottom.
+//
+//  All loads and stores are unaligned.  On modern processors these are just
+//  as fast as aligned loads when the data happens to be aligned.  But it means
+//  that Mat4 and Vec4 do not need to be 16-byte aligned, which is something
+//  that we cannot guarantee for objects on the heap (before C++17).
 //
 //  Because math objects are intended to be on the stack, we do not provide
 //  any shared pointer support in this class.
@@ -35,6 +40,53 @@
 //  Author: Walker White
 //  Version: 6/12/16
 
+#include <xmmintrin.h>
+
+/**
+ * Loads the given column of the matrix into an SSE register
+ *
+ * @param mat   The matrix
+ * @param col   The column index
+ *
+ * @return the SSE register for the column
+ */
+static inline __m128 mat4_col(const Mat4& mat, int col) {
+    return _mm_loadu_ps(mat.m+4*col);
+}
+
+/**
+ * Stores an SSE register in the given column of the matrix
+ *
+ * @param mat   The matrix
+ * @param col   The column index
+ * @param value The column value
+ */
+static inline void mat4_store(Mat4* mat, int col, __m128 value) {
+    _mm_storeu_ps(mat->m+4*col, value);
+}
+
+/**
+ * Returns the product of the matrix columns with the given vector
+ *
+ * This is the transform of the vector (as a column) by the matrix.
+ *
+ * @param c0    The first matrix column
+ * @param c1    The second matrix column
+ * @param c2    The third matrix column
+ * @param c3    The fourth matrix column
+ * @param vec   The vector to transform
+ *
+ * @return the product of the matrix columns with the given vector
+ */
+static inline __m128 mat4_apply(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 vec) {
+    __m128 e0 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 e1 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 e2 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 e3 = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, e0), _mm_mul_ps(c1, e1)),
+                      _mm_add_ps(_mm_mul_ps(c2, e2), _mm_mul_ps(c3, e3)));
+}
+
 /**
  * Adds a scalar to each component of mat and stores the result in dst.
  *
@@ -46,10 +98,9 @@
  */
 Mat4* Mat4::add(const Mat4& mat, float scalar, Mat4* dst) {
     __m128 s = _mm_set1_ps(scalar);
-    dst->col[0] = _mm_add_ps(mat.col[0], s);
-    dst->col[1] = _mm_add_ps(mat.col[1], s);
-    dst->col[2] = _mm_add_ps(mat.col[2], s);
-    dst->col[3] = _mm_add_ps(mat.col[3], s);
+    for(int ii = 0; ii < 4; ii++) {
+        mat4_store(dst, ii, _mm_add_ps(mat4_col(mat, ii), s));
+    }
     return dst;
 }
 
@@ -63,10 +114,9 @@ Mat4* Mat4::add(const Mat4& mat, float scalar, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::add(const Mat4& m1, const Mat4& m2, Mat4* dst) {
-    dst->col[0] = _mm_add_ps(m1.col[0], m2.col[0]);
-    dst->col[1] = _mm_add_ps(m1.col[1], m2.col[1]);
-    dst->col[2] = _mm_add_ps(m1.col[2], m2.col[2]);
-    dst->col[3] = _mm_add_ps(m1.col[3], m2.col[3]);
+    for(int ii = 0; ii < 4; ii++) {
+        mat4_store(dst, ii, _mm_add_ps(mat4_col(m1, ii), mat4_col(m2, ii)));
+    }
     return dst;
 }
 
@@ -81,10 +131,9 @@ Mat4* Mat4::add(const Mat4& m1, const Mat4& m2, Mat4* dst) {
  */
 Mat4* Mat4::subtract(const Mat4& mat, float scalar, Mat4* dst) {
     __m128 s = _mm_set1_ps(scalar);
-    dst->col[0] = _mm_sub_ps(mat.col[0], s);
-    dst->col[1] = _mm_sub_ps(mat.col[1], s);
-    dst->col[2] = _mm_sub_ps(mat.col[2], s);
-    dst->col[3] = _mm_sub_ps(mat.col[3], s);
+    for(int ii = 0; ii < 4; ii++) {
+        mat4_store(dst, ii, _mm_sub_ps(mat4_col(mat, ii), s));
+    }
     return dst;
 }
 
@@ -98,10 +147,9 @@ Mat4* Mat4::subtract(const Mat4& mat, float scalar, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::subtract(const Mat4& m1, const Mat4& m2, Mat4* dst) {
-    dst->col[0] = _mm_sub_ps(m1.col[0], m2.col[0]);
-    dst->col[1] = _mm_sub_ps(m1.col[1], m2.col[1]);
-    dst->col[2] = _mm_sub_ps(m1.col[2], m2.col[2]);
-    dst->col[3] = _mm_sub_ps(m1.col[3], m2.col[3]);
+    for(int ii = 0; ii < 4; ii++) {
+        mat4_store(dst, ii, _mm_sub_ps(mat4_col(m1, ii), mat4_col(m2, ii)));
+    }
     return dst;
 }
 
@@ -116,10 +164,9 @@ Mat4* Mat4::subtract(const Mat4& m1, const Mat4& m2, Mat4* dst) {
  */
 Mat4* Mat4::multiply(const Mat4& mat, float scalar, Mat4* dst) {
     __m128 s = _mm_set1_ps(scalar);
-    dst->col[0] = _mm_mul_ps(mat.col[0], s);
-    dst->col[1] = _mm_mul_ps(mat.col[1], s);
-    dst->col[2] = _mm_mul_ps(mat.col[2], s);
-    dst->col[3] = _mm_mul_ps(mat.col[3], s);
+    for(int ii = 0; ii < 4; ii++) {
+        mat4_store(dst, ii, _mm_mul_ps(mat4_col(mat, ii), s));
+    }
     return dst;
 }
 
@@ -136,86 +183,21 @@ Mat4* Mat4::multiply(const Mat4& mat, float scalar, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::multiply(const Mat4& m1, const Mat4& m2, Mat4* dst) {
-    __m128 dst0, dst1, dst2, dst3;
-    {
-		__m128 col = m1.col[0];
-        __m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-        __m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-        __m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-        __m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-        
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst0 = a2;
-    }
-    
-    {
-		__m128 col = m1.col[1];
-		__m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-		__m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-		__m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-		__m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst1 = a2;
-    }
-    
-    {
-		__m128 col = m1.col[2];
-		__m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-		__m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-		__m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-		__m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
-
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst2 = a2;
-    }
+    // Load everything first, as dst may be m1 or m2
+    __m128 b0 = mat4_col(m2, 0);
+    __m128 b1 = mat4_col(m2, 1);
+    __m128 b2 = mat4_col(m2, 2);
+    __m128 b3 = mat4_col(m2, 3);
     
-    {
-		__m128 col = m1.col[3];
-		__m128 e0 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0));
-		__m128 e1 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1));
-		__m128 e2 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2));
-		__m128 e3 = _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128 dst0 = mat4_apply(b0, b1, b2, b3, mat4_col(m1, 0));
+    __m128 dst1 = mat4_apply(b0, b1, b2, b3, mat4_col(m1, 1));
+    __m128 dst2 = mat4_apply(b0, b1, b2, b3, mat4_col(m1, 2));
+    __m128 dst3 = mat4_apply(b0, b1, b2, b3, mat4_col(m1, 3));
 
-        __m128 v0 = _mm_mul_ps(m2.col[0], e0);
-        __m128 v1 = _mm_mul_ps(m2.col[1], e1);
-        __m128 v2 = _mm_mul_ps(m2.col[2], e2);
-        __m128 v3 = _mm_mul_ps(m2.col[3], e3);
-        
-        __m128 a0 = _mm_add_ps(v0, v1);
-        __m128 a1 = _mm_add_ps(v2, v3);
-        __m128 a2 = _mm_add_ps(a0, a1);
-        
-        dst3 = a2;
-    }
-    dst->col[0] = dst0;
-    dst->col[1] = dst1;
-    dst->col[2] = dst2;
-    dst->col[3] = dst3;
+    mat4_store(dst, 0, dst0);
+    mat4_store(dst, 1, dst1);
+    mat4_store(dst, 2, dst2);
+    mat4_store(dst, 3, dst3);
     return dst;
 }
 
@@ -229,10 +211,9 @@ Mat4* Mat4::multiply(const Mat4& m1, const Mat4& m2, Mat4* dst) {
  */
 Mat4* Mat4::negate(const Mat4& mat, Mat4* dst) {
     __m128 z = _mm_setzero_ps();
-    dst->col[0] = _mm_sub_ps(z, mat.col[0]);
-    dst->col[1] = _mm_sub_ps(z, mat.col[1]);
-    dst->col[2] = _mm_sub_ps(z, mat.col[2]);
-    dst->col[3] = _mm_sub_ps(z, mat.col[3]);
+    for(int ii = 0; ii < 4; ii++) {
+        mat4_store(dst, ii, _mm_sub_ps(z, mat4_col(mat, ii)));
+    }
     return dst;
 }
 
@@ -249,15 +230,15 @@ Mat4* Mat4::negate(const Mat4& mat, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Mat4* Mat4::transpose(const Mat4& m1, Mat4* dst) {
-    __m128 tmp0 = _mm_shuffle_ps(m1.col[0], m1.col[1], 0x44);
-    __m128 tmp2 = _mm_shuffle_ps(m1.col[0], m1.col[1], 0xEE);
-    __m128 tmp1 = _mm_shuffle_ps(m1.col[2], m1.col[3], 0x44);
-    __m128 tmp3 = _mm_shuffle_ps(m1.col[2], m1.col[3], 0xEE);
-    
-    dst->col[0] = _mm_shuffle_ps(tmp0, tmp1, 0x88);
-    dst->col[1] = _mm_shuffle_ps(tmp0, tmp1, 0xDD);
-    dst->col[2] = _mm_shuffle_ps(tmp2, tmp3, 0x88);
-    dst->col[3] = _mm_shuffle_ps(tmp2, tmp3, 0xDD);
+    __m128 c0 = mat4_col(m1, 0);
+    __m128 c1 = mat4_col(m1, 1);
+    __m128 c2 = mat4_col(m1, 2);
+    __m128 c3 = mat4_col(m1, 3);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    mat4_store(dst, 0, c0);
+    mat4_store(dst, 1, c1);
+    mat4_store(dst, 2, c2);
+    mat4_store(dst, 3, c3);
     return dst;
 }
 
@@ -274,14 +255,102 @@ Mat4* Mat4::transpose(const Mat4& m1, Mat4* dst) {
  * @return A reference to dst for chaining
  */
 Vec4* Mat4::transform(const Mat4& mat, const Vec4& vec, Vec4* dst) {
-    __m128 col1 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(0, 0, 0, 0));
-    __m128 col2 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(1, 1, 1, 1));
-    __m128 col3 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(2, 2, 2, 2));
-    __m128 col4 = _mm_shuffle_ps(vec.v, vec.v, _MM_SHUFFLE(3, 3, 3, 3));
-    
-    dst->v = _mm_add_ps(
-                        _mm_add_ps(_mm_mul_ps(mat.col[0], col1), _mm_mul_ps(mat.col[1], col2)),
-                        _mm_add_ps(_mm_mul_ps(mat.col[2], col3), _mm_mul_ps(mat.col[3], col4))
-                        );
+    __m128 v = _mm_loadu_ps(&vec.x);
+    v = mat4_apply(mat4_col(mat, 0), mat4_col(mat, 1), mat4_col(mat, 2), mat4_col(mat, 3), v);
+    _mm_storeu_ps(&dst->x, v);
     return dst;
-}
\ No newline at end of file
+}
+
+
+#pragma mark -
+#pragma mark Batch Kernels
+/**
+ * Transforms the array of points, returning the number transformed
+ *
+ * The kernel transforms as many points as it can efficiently.  The caller
+ * is responsible for transforming any remaining points.
+ *
+ * @param mat       The transform matrix
+ * @param input     The points to transform
+ * @param size      The number of points
+ * @param output    The array to store the transformed points
+ *
+ * @return the number of points transformed
+ */
+static size_t mat4_batch(const Mat4& mat, const Vec2* input, size_t size, Vec2* output) {
+    // Two points per register: (x0, y0, x1, y1)
+    __m128 cx = _mm_setr_ps(mat.m[0],  mat.m[1],  mat.m[0],  mat.m[1]);
+    __m128 cy = _mm_setr_ps(mat.m[4],  mat.m[5],  mat.m[4],  mat.m[5]);
+    __m128 ct = _mm_setr_ps(mat.m[12], mat.m[13], mat.m[12], mat.m[13]);
+    
+    const float* src = reinterpret_cast<const float*>(input);
+    float* dst = reinterpret_cast<float*>(output);
+    size_t ii = 0;
+    for(; ii+4 <= size; ii += 4) {
+        __m128 v0 = _mm_loadu_ps(src+2*ii);
+        __m128 v1 = _mm_loadu_ps(src+2*ii+4);
+        __m128 x0 = _mm_shuffle_ps(v0, v0, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y0 = _mm_shuffle_ps(v0, v0, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 x1 = _mm_shuffle_ps(v1, v1, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y1 = _mm_shuffle_ps(v1, v1, _MM_SHUFFLE(3, 3, 1, 1));
+        _mm_storeu_ps(dst+2*ii,   _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, x0), _mm_mul_ps(cy, y0)), ct));
+        _mm_storeu_ps(dst+2*ii+4, _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, x1), _mm_mul_ps(cy, y1)), ct));
+    }
+    return ii;
+}
+
+/**
+ * Transforms the array of points, returning the number transformed
+ *
+ * The kernel transforms as many points as it can efficiently.  The caller
+ * is responsible for transforming any remaining points.
+ *
+ * @param mat       The transform matrix
+ * @param input     The points to transform
+ * @param size      The number of points
+ * @param output    The array to store the transformed points
+ *
+ * @return the number of points transformed
+ */
+static size_t mat4_batch(const Mat4& mat, const Vec3* input, size_t size, Vec3* output) {
+    __m128 c0 = mat4_col(mat, 0);
+    __m128 c1 = mat4_col(mat, 1);
+    __m128 c2 = mat4_col(mat, 2);
+    __m128 c3 = mat4_col(mat, 3);
+    for(size_t ii = 0; ii < size; ii++) {
+        // Read all three components before writing (output may be input)
+        __m128 x = _mm_set1_ps(input[ii].x);
+        __m128 y = _mm_set1_ps(input[ii].y);
+        __m128 z = _mm_set1_ps(input[ii].z);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)),
+                              _mm_add_ps(_mm_mul_ps(c2, z), c3));
+        _mm_storel_pi(reinterpret_cast<__m64*>(&output[ii].x), r);
+        _mm_store_ss(&output[ii].z, _mm_movehl_ps(r, r));
+    }
+    return size;
+}
+
+/**
+ * Transforms the array of vectors, returning the number transformed
+ *
+ * The kernel transforms as many vectors as it can efficiently.  The caller
+ * is responsible for transforming any remaining vectors.
+ *
+ * @param mat       The transform matrix
+ * @param input     The vectors to transform
+ * @param size      The number of vectors
+ * @param output    The array to store the transformed vectors
+ *
+ * @return the number of vectors transformed
+ */
+static size_t mat4_batch(const Mat4& mat, const Vec4* input, size_t size, Vec4* output) {
+    __m128 c0 = mat4_col(mat, 0);
+    __m128 c1 = mat4_col(mat, 1);
+    __m128 c2 = mat4_col(mat, 2);
+    __m128 c3 = mat4_col(mat, 3);
+    for(size_t ii = 0; ii < size; ii++) {
+        __m128 v = _mm_loadu_ps(&input[ii].x);
+        _mm_storeu_ps(&output[ii].x, mat4_apply(c0, c1, c2, c3, v));
+    }
+    return size;
+}
@@ -0,0 +1,798 @@
+//
+//  CUComplexTriangulator.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for a triangulator that supports holes.  Unlike
+//  SimpleTriangulator (which uses ear clipping, and is quadratic in practice),
+//  this triangulator runs in O(n log n) time.  It first partitions the polygon
+//  into y-monotone pieces with a sweep line, and then triangulates each piece
+//  in linear time.  Optionally, it refines the result into a constrained
+//  Delaunay triangulation by edge flipping.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  The monotone partition follows the presentation in "Computational Geometry:
+//  Algorithms and Applications" by de Berg, Cheong, van Kreveld, and Overmars.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#include <cugl/math/polygon/CUComplexTriangulator.h>
+#include <cugl/util/CUDebug.h>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+
+/** Side of the left chain of a monotone polygon */
+#define CHAIN_LEFT  0
+/** Side of the right chain of a monotone polygon */
+#define CHAIN_RIGHT 1
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Geometry
+/**
+ * Returns twice the signed area of the triangle abc.
+ *
+ * The value is positive if the triangle is counter-clockwise, negative if
+ * it is clockwise, and zero if the points are colinear.  The computation is
+ * done in double precision for robustness.
+ *
+ * @param a     The first vertex
+ * @param b     The second vertex
+ * @param c     The third vertex
+ *
+ * @return twice the signed area of the triangle abc.
+ */
+static double orient(const Vec2& a, const Vec2& b, const Vec2& c) {
+    return ((double)b.x-a.x)*((double)c.y-a.y)-((double)b.y-a.y)*((double)c.x-a.x);
+}
+
+/**
+ * Returns true if d is strictly inside the circumcircle of abc.
+ *
+ * The triangle abc must be counter-clockwise.  Points that are (nearly)
+ * cocircular are not considered inside, so that edge flipping terminates.
+ *
+ * @param a     The first triangle vertex
+ * @param b     The second triangle vertex
+ * @param c     The third triangle vertex
+ * @param d     The point to test
+ *
+ * @return true if d is strictly inside the circumcircle of abc.
+ */
+static bool incircle(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d) {
+    double adx = (double)a.x-d.x; double ady = (double)a.y-d.y;
+    double bdx = (double)b.x-d.x; double bdy = (double)b.y-d.y;
+    double cdx = (double)c.x-d.x; double cdy = (double)c.y-d.y;
+    double alift = adx*adx+ady*ady;
+    double blift = bdx*bdx+bdy*bdy;
+    double clift = cdx*cdx+cdy*cdy;
+    double det  = alift*(bdx*cdy-cdx*bdy)+blift*(cdx*ady-adx*cdy)+clift*(adx*bdy-bdx*ady);
+    double perm = (alift*(fabs(bdx*cdy)+fabs(cdx*bdy))+
+                   blift*(fabs(cdx*ady)+fabs(adx*cdy))+
+                   clift*(fabs(adx*bdy)+fabs(bdx*ady)));
+    return det > 1e-10*perm;
+}
+
+/**
+ * Returns true if edge a is strictly to the left of edge b
+ *
+ * Edges are identified by the index of their first vertex.  The index -1
+ * identifies the query point of the owning triangulator.
+ *
+ * Both edges must cross the sweep line.  Hence the edge whose upper vertex
+ * is lower in the sweep order has that vertex within the vertical span of
+ * the other edge, and we only need to test which side it is on.
+ *
+ * @param a     The first edge
+ * @param b     The second edge
+ *
+ * @return true if edge a is strictly to the left of edge b
+ */
+bool ComplexTriangulator::EdgeOrder::operator()(int a, int b) const {
+    if (a == b) {
+        return false;
+    }
+    const std::vector<Vec2>& input = owner->_input;
+    const std::vector<int>& next = owner->_next;
+    if (a < 0 || b < 0) {
+        // The query point against an edge.  A downward edge has its right on the left.
+        int e = (a < 0 ? b : a);
+        int au = (owner->isAbove(e,next[e]) ? e : next[e]);
+        int al = (au == e ? next[e] : e);
+        double s = orient(input[au],input[al],owner->_query);
+        return (a < 0 ? s < 0 : s > 0);
+    }
+
+    int au = (owner->isAbove(a,next[a]) ? a : next[a]);
+    int al = (au == a ? next[a] : a);
+    int bu = (owner->isAbove(b,next[b]) ? b : next[b]);
+    int bl = (bu == b ? next[b] : b);
+    if (owner->isAbove(bu,au)) {
+        double s = orient(input[bu],input[bl],input[au]);
+        if (s == 0) {
+            s = orient(input[bu],input[bl],input[al]);
+        }
+        return (s == 0 ? a < b : s < 0);
+    }
+    double s = orient(input[au],input[al],input[bu]);
+    if (s == 0) {
+        s = orient(input[au],input[al],input[bl]);
+    }
+    return (s == 0 ? a < b : s > 0);
+}
+
+
+#pragma mark -
+#pragma mark Initialization
+/**
+ * Adds a hole to the polygon.
+ *
+ * The hole should lie inside the outer boundary, and should not intersect
+ * it or any other hole.
+ *
+ * The vertex data is copied.  The triangulator does not retain any
+ * references to the original data.
+ *
+ * This method resets all interal data.  You will need to reperform the
+ * calculation before accessing data.
+ *
+ * @param points    The vertices of the hole
+ */
+void ComplexTriangulator::addHole(const std::vector<Vec2>& points) {
+    CUAssertLog(!_loops.empty(), "The outer boundary must be set before any holes");
+    reset();
+    _input.reserve(_input.size()+points.size());
+    std::copy(points.begin(),points.end(),std::back_inserter(_input));
+    _loops.push_back(points.size());
+}
+
+
+#pragma mark -
+#pragma mark Calculation
+/**
+ * Performs a triangulation of the current vertex data.
+ */
+void ComplexTriangulator::calculate() {
+    reset();
+    computeLoops();
+    if (_sorted.size() >= 3) {
+        computeDiagonals();
+        computeTriangulation();
+        trimColinear();
+        if (_delaunay) {
+            computeDelaunay();
+        }
+    }
+    _calculated = true;
+}
+
+/**
+ * Links the vertex loops with the interior of the polygon on the left.
+ *
+ * The outer boundary is oriented counter-clockwise, while the holes are
+ * oriented clockwise.  Loops with fewer than three vertices are ignored.
+ */
+void ComplexTriangulator::computeLoops() {
+    int vcount = (int)_input.size();
+    _next.assign(vcount,-1);
+    _prev.assign(vcount,-1);
+    _sorted.reserve(vcount);
+
+    int start = 0;
+    for(size_t ii = 0; ii < _loops.size(); ii++) {
+        int size = (int)_loops[ii];
+        if (size >= 3) {
+            double area = 0;
+            for(int jj = 0; jj < size; jj++) {
+                const Vec2& p1 = _input[start+jj];
+                const Vec2& p2 = _input[start+(jj+1) % size];
+                area += (double)p1.x*p2.y-(double)p2.x*p1.y;
+            }
+
+            // The boundary is counter-clockwise, the holes clockwise
+            bool forward = (ii == 0 ? area >= 0 : area <= 0);
+            for(int jj = 0; jj < size; jj++) {
+                int curr = start+jj;
+                int succ = start+(jj+1) % size;
+                if (forward) {
+                    _next[curr] = succ;
+                    _prev[succ] = curr;
+                } else {
+                    _next[succ] = curr;
+                    _prev[curr] = succ;
+                }
+                _sorted.push_back(curr);
+            }
+        }
+        start += size;
+    }
+
+    std::sort(_sorted.begin(), _sorted.end(), [this](int a, int b) { return isAbove(a,b); });
+}
+
+/**
+ * Classifies the vertex at the given index for the sweep line.
+ *
+ * @param index The vertex index
+ *
+ * @return the classification for the vertex at the given index
+ */
+ComplexTriangulator::VertexType ComplexTriangulator::classifyVertex(int index) const {
+    int prev = _prev[index];
+    int next = _next[index];
+    bool above1 = isAbove(prev,index);
+    bool above2 = isAbove(next,index);
+    if (above1 == above2) {
+        bool convex = orient(_input[prev],_input[index],_input[next]) > 0;
+        if (above1) {
+            return convex ? VertexType::END : VertexType::MERGE;
+        }
+        return convex ? VertexType::START : VertexType::SPLIT;
+    }
+    return VertexType::REGULAR;
+}
+
+/**
+ * Returns the edge in the sweep status directly to the left of a vertex.
+ *
+ * The edge is identified by the index of its first vertex.  If there is
+ * no such edge (which only happens for invalid input), this method
+ * returns -1.
+ *
+ * @param status  The sweep status
+ * @param index   The vertex index
+ *
+ * @return the edge in the sweep status directly to the left of a vertex.
+ */
+int ComplexTriangulator::findLeftEdge(std::set<int,EdgeOrder>& status, int index) {
+    _query = _input[index];
+    auto it = status.lower_bound(-1);
+    if (it == status.begin()) {
+        return -1;
+    }
+    --it;
+    return *it;
+}
+
+/**
+ * Partitions the polygon into y-monotone pieces.
+ *
+ * This method performs the sweep, recording the diagonals that split
+ * the polygon in the attribute _diagonals.
+ */
+void ComplexTriangulator::computeDiagonals() {
+    EdgeOrder order;
+    order.owner = this;
+    std::set<int,EdgeOrder> status(order);
+
+    int vcount = (int)_input.size();
+    _types.resize(vcount,VertexType::REGULAR);
+    for(auto it = _sorted.begin(); it != _sorted.end(); ++it) {
+        _types[*it] = classifyVertex(*it);
+    }
+    _helper.assign(vcount,-1);
+    _position.assign(vcount,status.end());
+
+    for(auto it = _sorted.begin(); it != _sorted.end(); ++it) {
+        int curr = *it;
+        int prev = _prev[curr];
+        int left;
+        switch (_types[curr]) {
+            case VertexType::START:
+                _position[curr] = status.insert(curr).first;
+                _helper[curr] = curr;
+                break;
+            case VertexType::END:
+                if (_helper[prev] >= 0 && _types[_helper[prev]] == VertexType::MERGE) {
+                    _diagonals.push_back(curr);
+                    _diagonals.push_back(_helper[prev]);
+                }
+                if (_position[prev] != status.end()) {
+                    status.erase(_position[prev]);
+                    _position[prev] = status.end();
+                }
+                break;
+            case VertexType::SPLIT:
+                left = findLeftEdge(status,curr);
+                if (left >= 0) {
+                    _diagonals.push_back(curr);
+                    _diagonals.push_back(_helper[left]);
+                    _helper[left] = curr;
+                }
+                _position[curr] = status.insert(curr).first;
+                _helper[curr] = curr;
+                break;
+            case VertexType::MERGE:
+                if (_helper[prev] >= 0 && _types[_helper[prev]] == VertexType::MERGE) {
+                    _diagonals.push_back(curr);
+                    _diagonals.push_back(_helper[prev]);
+                }
+                if (_position[prev] != status.end()) {
+                    status.erase(_position[prev]);
+                    _position[prev] = status.end();
+                }
+                left = findLeftEdge(status,curr);
+                if (left >= 0) {
+                    if (_types[_helper[left]] == VertexType::MERGE) {
+                        _diagonals.push_back(curr);
+                        _diagonals.push_back(_helper[left]);
+                    }
+                    _helper[left] = curr;
+                }
+                break;
+            case VertexType::REGULAR:
+                if (isAbove(prev,curr)) {
+                    // Interior is to the right
+                    if (_helper[prev] >= 0 && _types[_helper[prev]] == VertexType::MERGE) {
+                        _diagonals.push_back(curr);
+                        _diagonals.push_back(_helper[prev]);
+                    }
+                    if (_position[prev] != status.end()) {
+                        status.erase(_position[prev]);
+                        _position[prev] = status.end();
+                    }
+                    _position[curr] = status.insert(curr).first;
+                    _helper[curr] = curr;
+                } else {
+                    left = findLeftEdge(status,curr);
+                    if (left >= 0) {
+                        if (_types[_helper[left]] == VertexType::MERGE) {
+                            _diagonals.push_back(curr);
+                            _diagonals.push_back(_helper[left]);
+                        }
+                        _helper[left] = curr;
+                    }
+                }
+                break;
+        }
+    }
+    _position.clear();
+}
+
+/**
+ * Triangulates each monotone piece of the partition.
+ *
+ * This method walks the faces of the planar graph formed by the polygon
+ * edges and the diagonals, triangulating each in linear time.
+ */
+void ComplexTriangulator::computeTriangulation() {
+    int vcount = (int)_input.size();
+
+    // Build the incidence lists (compressed by vertex)
+    std::vector<int> offset(vcount+1,0);
+    for(auto it = _sorted.begin(); it != _sorted.end(); ++it) {
+        offset[*it+1] += 2;
+    }
+    for(size_t ii = 0; ii < _diagonals.size(); ii++) {
+        offset[_diagonals[ii]+1]++;
+    }
+    for(int ii = 0; ii < vcount; ii++) {
+        offset[ii+1] += offset[ii];
+    }
+
+    // Targets of each incidence.  Reversed boundary edges are negated (-1-v).
+    std::vector<int> target(offset[vcount]);
+    std::vector<int> fill(offset.begin(),offset.end()-1);
+    for(auto it = _sorted.begin(); it != _sorted.end(); ++it) {
+        target[fill[*it]++] = _next[*it];
+        target[fill[*it]++] = -1-_prev[*it];
+    }
+    for(size_t ii = 0; ii < _diagonals.size(); ii += 2) {
+        int a = _diagonals[ii];
+        int b = _diagonals[ii+1];
+        target[fill[a]++] = b;
+        target[fill[b]++] = a;
+    }
+
+    // Sort each list counter-clockwise by angle
+    std::vector<std::pair<double,int>> scratch;
+    for(int ii = 0; ii < vcount; ii++) {
+        int beg = offset[ii];
+        int end = offset[ii+1];
+        if (end-beg > 2) {
+            scratch.clear();
+            for(int jj = beg; jj < end; jj++) {
+                const Vec2& p = _input[target[jj] < 0 ? -1-target[jj] : target[jj]];
+                double angle = atan2((double)p.y-_input[ii].y,(double)p.x-_input[ii].x);
+                scratch.push_back(std::make_pair(angle,target[jj]));
+            }
+            std::sort(scratch.begin(),scratch.end());
+            for(int jj = beg; jj < end; jj++) {
+                target[jj] = scratch[jj-beg].second;
+            }
+        }
+    }
+
+    // Walk the faces with the interior on the left
+    std::vector<bool> visited(offset[vcount],false);
+    std::vector<int> face;
+    std::vector<int> stack;
+    std::vector<int> chain;
+    _output.reserve(3*_sorted.size());
+    for(int ii = 0; ii < vcount; ii++) {
+        for(int jj = offset[ii]; jj < offset[ii+1]; jj++) {
+            if (visited[jj] || target[jj] < 0) {
+                continue;
+            }
+            face.clear();
+            int curr = ii;
+            int edge = jj;
+            bool valid = true;
+            do {
+                visited[edge] = true;
+                face.push_back(curr);
+                int succ = target[edge];
+
+                // Find the reverse incidence, and turn clockwise from it
+                int beg = offset[succ];
+                int end = offset[succ+1];
+                int back = -1;
+                for(int kk = beg; kk < end && back < 0; kk++) {
+                    if (target[kk] == curr || target[kk] == -1-curr) {
+                        back = kk;
+                    }
+                }
+                edge = (back < 0 ? -1 : (back == beg ? end-1 : back-1));
+                curr = succ;
+                valid = (edge >= 0 && target[edge] >= 0 && (edge == jj || !visited[edge]));
+            } while (valid && edge != jj);
+
+            if (valid) {
+                triangulateMonotone(face, stack, chain);
+            }
+        }
+    }
+}
+
+/**
+ * Triangulates a single y-monotone polygon.
+ *
+ * The polygon is given as a list of vertex indices in counter-clockwise
+ * order.  The triangles are appended to the output.
+ *
+ * @param face  The vertex indices of the monotone polygon
+ * @param stack A scratch buffer for the triangulation
+ * @param chain A scratch buffer for the triangulation
+ */
+void ComplexTriangulator::triangulateMonotone(const std::vector<int>& face, std::vector<int>& stack,
+                                              std::vector<int>& chain) {
+    int size = (int)face.size();
+    if (size < 3) {
+        return;
+    } else if (size == 3) {
+        _output.push_back(face[0]);
+        _output.push_back(face[1]);
+        _output.push_back(face[2]);
+        return;
+    }
+
+    int top = 0;
+    int bot = 0;
+    for(int ii = 1; ii < size; ii++) {
+        if (isAbove(face[ii],face[top])) {
+            top = ii;
+        }
+        if (isAbove(face[bot],face[ii])) {
+            bot = ii;
+        }
+    }
+
+    // Merge the two chains in sweep order, tagging the side in the low bit
+    chain.clear();
+    chain.push_back(2*face[top]+CHAIN_LEFT);
+    int lpos = (top+1) % size;
+    int rpos = (top+size-1) % size;
+    while (lpos != bot || rpos != bot) {
+        if (rpos == bot || (lpos != bot && isAbove(face[lpos],face[rpos]))) {
+            chain.push_back(2*face[lpos]+CHAIN_LEFT);
+            lpos = (lpos+1) % size;
+        } else {
+            chain.push_back(2*face[rpos]+CHAIN_RIGHT);
+            rpos = (rpos+size-1) % size;
+        }
+    }
+    chain.push_back(2*face[bot]+CHAIN_RIGHT);
+
+    stack.clear();
+    stack.push_back(chain[0]);
+    stack.push_back(chain[1]);
+    for(int ii = 2; ii < size-1; ii++) {
+        int curr = chain[ii] >> 1;
+        int side = chain[ii] & 1;
+        if (side != (stack.back() & 1)) {
+            // Fan to everything on the opposite chain
+            for(size_t jj = stack.size()-1; jj > 0; jj--) {
+                int a = stack[jj] >> 1;
+                int b = stack[jj-1] >> 1;
+                _output.push_back(curr);
+                _output.push_back(side == CHAIN_LEFT ? a : b);
+                _output.push_back(side == CHAIN_LEFT ? b : a);
+            }
+            stack.clear();
+            stack.push_back(chain[ii-1]);
+            stack.push_back(chain[ii]);
+        } else {
+            // Clip ears along the same chain
+            int last = stack.back();
+            stack.pop_back();
+            while (!stack.empty()) {
+                int a = stack.back() >> 1;
+                int b = last >> 1;
+                double area = (side == CHAIN_LEFT ? orient(_input[a],_input[b],_input[curr]) :
+                                                    orient(_input[curr],_input[b],_input[a]));
+                if (area <= 0) {
+                    break;
+                }
+                _output.push_back(side == CHAIN_LEFT ? a : curr);
+                _output.push_back(b);
+                _output.push_back(side == CHAIN_LEFT ? curr : a);
+                last = stack.back();
+                stack.pop_back();
+            }
+            stack.push_back(last);
+            stack.push_back(chain[ii]);
+        }
+    }
+
+    // The bottom vertex closes the remaining fan
+    int curr = chain[size-1] >> 1;
+    int side = 1-(stack.back() & 1);
+    for(size_t jj = stack.size()-1; jj > 0; jj--) {
+        int a = stack[jj] >> 1;
+        int b = stack[jj-1] >> 1;
+        _output.push_back(curr);
+        _output.push_back(side == CHAIN_LEFT ? a : b);
+        _output.push_back(side == CHAIN_LEFT ? b : a);
+    }
+}
+
+/**
+ * Refines the triangulation into a constrained Delaunay triangulation.
+ *
+ * This method uses Lawson's edge flipping algorithm.  Only edges shared
+ * by two triangles are flipped, so the boundary and holes are preserved.
+ */
+void ComplexTriangulator::computeDelaunay() {
+    int slots = (int)_output.size();
+
+    // Match each directed edge with its reverse
+    std::vector<int> adjacent(slots,-1);
+    std::unordered_map<Uint64,int> edges;
+    edges.reserve(slots);
+    for(int ii = 0; ii < slots; ii++) {
+        Uint64 a = _output[ii];
+        Uint64 b = _output[ii % 3 == 2 ? ii-2 : ii+1];
+        auto it = edges.find((b << 32) | a);
+        if (it != edges.end()) {
+            adjacent[ii] = it->second;
+            adjacent[it->second] = ii;
+            edges.erase(it);
+        } else {
+            edges[(a << 32) | b] = ii;
+        }
+    }
+
+    std::vector<int> pending;
+    pending.reserve(slots);
+    for(int ii = 0; ii < slots; ii++) {
+        if (adjacent[ii] > ii) {
+            pending.push_back(ii);
+        }
+    }
+
+    while (!pending.empty()) {
+        int slot1 = pending.back();
+        pending.pop_back();
+        int slot2 = adjacent[slot1];
+        if (slot2 < 0) {
+            continue;
+        }
+
+        // Triangle (a,b,c) is across edge ab from triangle (b,a,d)
+        int tri1 = slot1-slot1 % 3;
+        int tri2 = slot2-slot2 % 3;
+        int k1 = slot1 % 3;
+        int k2 = slot2 % 3;
+        unsigned int a = _output[tri1+k1];
+        unsigned int b = _output[tri1+(k1+1) % 3];
+        unsigned int c = _output[tri1+(k1+2) % 3];
+        unsigned int d = _output[tri2+(k2+2) % 3];
+        if (!incircle(_input[a],_input[b],_input[c],_input[d])) {
+            continue;
+        }
+        if (orient(_input[c],_input[a],_input[d]) <= 0 || orient(_input[d],_input[b],_input[c]) <= 0) {
+            continue;
+        }
+
+        int nbc = adjacent[tri1+(k1+1) % 3];
+        int nca = adjacent[tri1+(k1+2) % 3];
+        int nad = adjacent[tri2+(k2+1) % 3];
+        int ndb = adjacent[tri2+(k2+2) % 3];
+
+        // Flip to (c,a,d) and (d,b,c)
+        _output[tri1  ] = c; _output[tri1+1] = a; _output[tri1+2] = d;
+        _output[tri2  ] = d; _output[tri2+1] = b; _output[tri2+2] = c;
+        adjacent[tri1  ] = nca; adjacent[tri1+1] = nad; adjacent[tri1+2] = tri2+2;
+        adjacent[tri2  ] = ndb; adjacent[tri2+1] = nbc; adjacent[tri2+2] = tri1+2;
+        if (nca >= 0) { adjacent[nca] = tri1;   }
+        if (nad >= 0) { adjacent[nad] = tri1+1; }
+        if (ndb >= 0) { adjacent[ndb] = tri2;   }
+        if (nbc >= 0) { adjacent[nbc] = tri2+1; }
+
+        pending.push_back(tri1);
+        pending.push_back(tri1+1);
+        pending.push_back(tri2);
+        pending.push_back(tri2+1);
+    }
+}
+
+/**
+ * Removes degenerate triangles from the current triangulation.
+ *
+ * Colinear vertices may produce triangles with no area.  This will crash
+ * OpenGL, so we remove them.
+ */
+void ComplexTriangulator::trimColinear() {
+    size_t keep = 0;
+    for(size_t ii = 0; ii+2 < _output.size(); ii += 3) {
+        const Vec2& p1 = _input[_output[ii  ]];
+        const Vec2& p2 = _input[_output[ii+1]];
+        const Vec2& p3 = _input[_output[ii+2]];
+        if (fabs(orient(p1,p2,p3)) >= 0.0000001f) {
+            _output[keep  ] = _output[ii  ];
+            _output[keep+1] = _output[ii+1];
+            _output[keep+2] = _output[ii+2];
+            keep += 3;
+        }
+    }
+    _output.resize(keep);
+}
+
+#pragma mark -
+#pragma mark Materialization
+/**
+ * Returns a list of indices representing the triangulation.
+ *
+ * The indices represent positions in the original vertex list, followed
+ * by the vertices of each hole.  If you have modified that list, these
+ * indices may no longer be valid.
+ *
+ * The triangulator does not retain a reference to the returned list; it
+ * is safe to modify it.
+ *
+ * The list uses 16 bit indices, so the number of vertices may not exceed
+ * 65536.  Use the buffer version of this method for larger meshes.
+ *
+ * If the calculation is not yet performed, this method will return the
+ * empty list.
+ *
+ * @return a list of indices representing the triangulation.
+ */
+std::vector<unsigned short> ComplexTriangulator::getTriangulation() {
+    std::vector<unsigned short> result;
+    getTriangulation(result);
+    return result;
+}
+
+/**
+ * Stores the triangulation indices in the given buffer.
+ *
+ * The indices represent positions in the original vertex list, followed
+ * by the vertices of each hole.  If you have modified that list, these
+ * indices may no longer be valid.
+ *
+ * The indices will be appended to the provided vector. You should clear
+ * the vector first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @return the number of elements added to the buffer
+ */
+size_t ComplexTriangulator::getTriangulation(std::vector<Uint32>& buffer) {
+    if (_calculated) {
+        buffer.reserve(buffer.size()+_output.size());
+        std::copy(_output.begin(), _output.end(),std::back_inserter(buffer));
+        return _output.size();
+    }
+    return 0;
+}
+
+/**
+ * Stores the triangulation indices in the given 16-bit buffer.
+ *
+ * This version is for meshes that are known to be small, and which should
+ * be stored compactly (e.g. for upload to a 16-bit index buffer).  The
+ * number of vertices (including holes) may not exceed 65536.
+ *
+ * The indices will be appended to the provided vector. You should clear
+ * the vector first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @return the number of elements added to the buffer
+ */
+size_t ComplexTriangulator::getTriangulation(std::vector<unsigned short>& buffer) {
+    if (_calculated) {
+        CUAssertLog(_input.size() <= 65536, "Vertex count %d exceeds the index range", (int)_input.size());
+        buffer.reserve(buffer.size()+_output.size());
+        for(auto it = _output.begin(); it != _output.end(); ++it) {
+            buffer.push_back((unsigned short)*it);
+        }
+        return _output.size();
+    }
+    return 0;
+}
+
+/**
+ * Returns a polygon representing the triangulation.
+ *
+ * The polygon contains the original vertices (followed by those of the
+ * holes) together with the new indices defining a solid shape.  The
+ * triangulator does not maintain references to this polygon and it is
+ * safe to modify it.
+ *
+ * If the calculation is not yet performed, this method will return the
+ * empty polygon.
+ *
+ * @return a polygon representing the triangulation.
+ */
+Poly2 ComplexTriangulator::getPolygon() {
+    Poly2 poly;
+    if (_calculated) {
+        getPolygon(&poly);
+    }
+    return poly;
+}
+
+/**
+ * Stores the triangulation in the given buffer.
+ *
+ * This method will add both the original vertices (followed by those of
+ * the holes), and the corresponding indices to the new buffer.  If the
+ * buffer is not empty, the indices will be adjusted accordingly. You
+ * should clear the buffer first if you do not want to preserve the
+ * original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @param buffer    The buffer to store the triangulated polygon
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* ComplexTriangulator::getPolygon(Poly2* buffer) {
+    CUAssertLog(buffer, "Destination buffer is null");
+    if (_calculated) {
+        size_t offset = buffer->_vertices.size();
+        buffer->_vertices.reserve(offset+_input.size());
+        std::copy(_input.begin(),_input.end(),std::back_inserter(buffer->_vertices));
+
+        buffer->appendIndices(_output.data(), _output.size(), (Uint32)offset);
+        buffer->_type = Poly2::Type::SOLID;
+        buffer->computeBounds();
+    }
+    return buffer;
+}
@@ -8,6 +8,11 @@
 //  a simple math class.  By separating this out as a factory, we allow ourselves
 //  the option of moving these calculations to a worker thread if necessary.
 //
+//  The approximation also produces an arc-length table and a bounding volume
+//  hierarchy over the subdivided curve.  These support fast queries for path
+//  following, such as the point at a given distance along the spline, or the
+//  point on the spline nearest to a given position.
+//
 //  Because math objects are intended to be on the stack, we do not provide
 //  any shared pointer support in this class.
 //
@@ -34,14 +39,125 @@
 //  Version: 6/22/16
 
 #include <cugl/math/polygon/CUCubicSplineApproximator.h>
+#include <cugl/math/CUFixedPolynomial.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUThreadPool.h>
 #include <iterator>
+#include <algorithm>
+#include <limits>
 
 /** Tolerance to identify a point as "smooth" */
 #define SMOOTH_TOLERANCE    0.0001f
+/** The number of spline segments assigned to a thread at a time */
+#define SEGMENT_GRAIN       16
+/** The maximum number of beziers in a leaf of the bounding volume hierarchy */
+#define BOUNDS_LEAF         4
+/** The maximum depth of the bounding volume hierarchy search */
+#define BOUNDS_STACK        64
 
 using namespace cugl;
 
+/**
+ * Returns the parameter of the point on the bezier nearest the given point.
+ *
+ * The parameter is relative to the bezier, and is in the range [0,1].  The
+ * candidates are the end points and the roots of the projection polynomial
+ * (see {@link CubicSpline#getProjectionPolynomial}).  This solve is exact,
+ * so it does not depend on how flat the approximation criterion makes the
+ * beziers.  The squared distance to the nearest point is stored in dist.
+ *
+ * @param  src      the four control points of the bezier
+ * @param  point    the point to project
+ * @param  dist     pointer to store the squared distance
+ *
+ * @return the parameter of the point on the bezier nearest the given point.
+ */
+static float nearest_on_bezier(const Vec2* src, const Vec2& point, float* dist) {
+    // Power basis, relative to the point
+    Vec2 c = 3*(src[1]-src[0]);
+    Vec2 b = 3*(src[2]-src[1])-c;
+    Vec2 a = src[3]-src[0]-c-b;
+    Vec2 d = src[0]-point;
+    
+    // The derivative of the squared distance (halved)
+    QuinticPolynomial poly;
+    poly.c[0] = 3.0f*a.dot(a);
+    poly.c[1] = 5.0f*a.dot(b);
+    poly.c[2] = 4.0f*a.dot(c) + 2.0f*b.dot(b);
+    poly.c[3] = 3.0f*b.dot(c) + 3.0f*a.dot(d);
+    poly.c[4] = c.dot(c) + 2.0f*b.dot(d);
+    poly.c[5] = c.dot(d);
+    
+    float roots[5];
+    int count = poly.roots(roots, 0.0f, 1.0f);
+    
+    float u = 0;
+    float best = d.lengthSquared();
+    float end = (a+b+c+d).lengthSquared();
+    if (end < best) {
+        best = end; u = 1;
+    }
+    for(int ii = 0; ii < count; ii++) {
+        float t = roots[ii];
+        float value = (((a*t+b)*t+c)*t+d).lengthSquared();
+        if (value < best) {
+            best = value; u = t;
+        }
+    }
+    *dist = best;
+    return u;
+}
+
+/**
+ * Returns the arc length of the given bezier.
+ *
+ * The length is the integral of the speed |B'(t)| over [0,1].  It is
+ * computed with 5-point Gauss-Legendre quadrature, which is exact for
+ * polynomials of degree 9.  The speed of a cubic is the square root of a
+ * quartic, so this is very accurate for the beziers of an approximation.
+ *
+ * @param  src      the four control points of the bezier
+ *
+ * @return the arc length of the given bezier.
+ */
+static float bezier_length(const Vec2* src) {
+    // The quadrature nodes and weights, mapped to [0,1]
+    static const float NODES[5] = {
+        0.0469100770f, 0.2307653449f, 0.5f, 0.7692346551f, 0.9530899230f
+    };
+    static const float WEIGHTS[5] = {
+        0.1184634425f, 0.2393143352f, 0.2844444444f, 0.2393143352f, 0.1184634425f
+    };
+    
+    // Power basis (as in nearest_on_bezier)
+    Vec2 c = 3*(src[1]-src[0]);
+    Vec2 b = 3*(src[2]-src[1])-c;
+    Vec2 a = src[3]-src[0]-c-b;
+    float result = 0;
+    for(int ii = 0; ii < 5; ii++) {
+        float t = NODES[ii];
+        result += WEIGHTS[ii]*((3*a*t+2*b)*t+c).length();
+    }
+    return result;
+}
+
+/**
+ * Returns the squared distance from the point to the given box.
+ *
+ * This value is 0 if the point is inside of the box.
+ *
+ * @param  min      the bottom left corner of the box
+ * @param  max      the top right corner of the box
+ * @param  point    the point to measure
+ *
+ * @return the squared distance from the point to the given box.
+ */
+static float box_distance(const Vec2& min, const Vec2& max, const Vec2& point) {
+    float dx = std::max(0.0f,std::max(min.x-point.x,point.x-max.x));
+    float dy = std::max(0.0f,std::max(min.y-point.y,point.y-max.y));
+    return dx*dx+dy*dy;
+}
+
 #pragma mark Calculation
 /**
  * Performs an approximation of the current spline
@@ -60,21 +176,69 @@ using namespace cugl;
  *
  * @param  criterion    the stopping condition criterion
  * @param  tolerance    the error tolerance of the stopping condition
- *
- * @return a list of vertices approximating this spline
  */
 void CubicSplineApproximator::calculate(Criterion criterion, float tolerance) {
+    calculate(nullptr, criterion, tolerance);
+}
+
+/**
+ * Performs an approximation of the current spline in parallel.
+ *
+ * This method is the same as {@link calculate(Criterion,float)}, except
+ * that the spline segments are divided among the threads of the pool.
+ * Each segment is subdivided independently, so the result is identical
+ * to the serial calculation.  This method blocks until the calculation
+ * is complete.  If pool is nullptr, the calculation is serial.
+ *
+ * The calculation uses a reference to the spline; it does not copy it.
+ * The spline should not be modified until this method returns.
+ *
+ * @param  pool         the thread pool to perform the calculation
+ * @param  criterion    the stopping condition criterion
+ * @param  tolerance    the error tolerance of the stopping condition
+ */
+void CubicSplineApproximator::calculate(const std::shared_ptr<ThreadPool>& pool,
+                                        Criterion criterion, float tolerance) {
     reset();
     if (!_spline) { return; }
     
-    for (int ii = 0; ii < _spline->_size; ii++) {
-        generate(_spline->_points, (3 * ii), (float)ii, tolerance, criterion, 0);
+    size_t size = _spline->_size;
+    const Vec2* src = _spline->_points.data();
+    if (pool == nullptr || size <= SEGMENT_GRAIN) {
+        for (size_t ii = 0; ii < size; ii++) {
+            generate(src+3*ii, (float)ii, tolerance, criterion, 0, _pointbuff, _parambuff);
+        }
+    } else {
+        // Chunks are aligned to the grain, so each one has its own buffers
+        size_t chunks = (size+SEGMENT_GRAIN-1)/SEGMENT_GRAIN;
+        std::vector<std::vector<Vec2>>  points(chunks);
+        std::vector<std::vector<float>> params(chunks);
+        pool->parallelFor(size, SEGMENT_GRAIN, [&](size_t begin, size_t end) {
+            size_t chunk = begin/SEGMENT_GRAIN;
+            for (size_t ii = begin; ii < end; ii++) {
+                generate(src+3*ii, (float)ii, tolerance, criterion, 0,
+                         points[chunk], params[chunk]);
+            }
+        });
+        
+        size_t total = 0;
+        for(auto it = params.begin(); it != params.end(); ++it) {
+            total += it->size();
+        }
+        _pointbuff.reserve(3*total+1);
+        _parambuff.reserve(total+1);
+        for(size_t ii = 0; ii < chunks; ii++) {
+            _pointbuff.insert(_pointbuff.end(), points[ii].begin(), points[ii].end());
+            _parambuff.insert(_parambuff.end(), params[ii].begin(), params[ii].end());
+        }
     }
     
     // Push back last point and parameter
     _pointbuff.push_back(_spline->_points[3 * _spline->_size]);
     _parambuff.push_back((float)_spline->_size);
     _closed = _spline->_closed;
+    computeLengths();
+    computeBounds();
     _calculated = true;
 }
 
@@ -82,38 +246,41 @@ void CubicSplineApproximator::calculate(Criterion criterion, float tolerance) {
  * Generates data via recursive use of de Castlejau's
  *
  * This method is the recursive helper for calculate(). It performs
- * de Castlejau's algorithm and stores the data in the buffer.  You
- * will never call this method directly.
+ * de Castlejau's algorithm and stores the data in the buffers.  The
+ * subdivided beziers are kept on the stack, so this method does not
+ * allocate any memory other than the buffers.  You will never call this
+ * method directly.
  *
- * @param  src          the control point list for the bezier
- * @param  soff         the offset into the control point list
+ * @param  src          the four control points of the bezier
  * @param  tp           the parameter to split at
  * @param  tolerance    the error tolerance of the stopping condition
  * @param  criterion    the stopping condition criterion
  * @param  depth        the current depth of the recursive call
+ * @param  points       the buffer to store the control points
+ * @param  params       the buffer to store the parameters
  *
  * @return The number of (anchor) points generated by this recursive call.
  */
-int CubicSplineApproximator::generate(const std::vector<Vec2>& src, int soff, float tp,
-                                      float tolerance, CubicSplineApproximator::Criterion criterion,
-                                      int depth) {
+int CubicSplineApproximator::generate(const Vec2* src, float tp, float tolerance,
+                                      CubicSplineApproximator::Criterion criterion, int depth,
+                                      std::vector<Vec2>& points, std::vector<float>& params) {
     // Do not go to far
-    bool terminate = (depth >= 8) || (soff >= src.size() - 1);
+    bool terminate = (depth >= 8);
         
     // Check if we are at the bottom level
     if (!terminate && criterion == CubicSplineApproximator::Criterion::SPACING) {
-        Vec2 temp0 = src[soff + 3] - src[soff];             // p3 - p0
+        Vec2 temp0 = src[3] - src[0];                       // p3 - p0
         terminate = temp0.length() < tolerance;
     }
     else if (!terminate && (criterion == CubicSplineApproximator::Criterion::DISTANCE ||
                                 criterion == CubicSplineApproximator::Criterion::FLAT)) {
-        Vec2 temp0 = src[soff + 3] - src[soff];             // p3 - p0
+        Vec2 temp0 = src[3] - src[0];                       // p3 - p0
         float leng = 1.0f;
         if (criterion == CubicSplineApproximator::Criterion::FLAT) {
             leng = temp0.length();
         }
             
-        Vec2 temp1 = src[soff + 1] - src[soff];             // p1 - p0
+        Vec2 temp1 = src[1] - src[0];                       // p1 - p0
         temp1.normalize();
         float scale = temp0.dot(temp1);
         temp1 *= scale;
@@ -121,8 +288,8 @@ int CubicSplineApproximator::generate(const std::vector<Vec2>& src, int soff, fl
             
         terminate = (temp0.length() < tolerance*leng);
     
-        temp0 = src[soff] - src[soff + 3];                  // p0 - p3
-        temp1 = src[soff + 2] - src[soff + 3];              // p2 - p3
+        temp0 = src[0] - src[3];                            // p0 - p3
+        temp1 = src[2] - src[3];                            // p2 - p3
         temp1.normalize();
         scale = temp0.dot(temp1);
         temp1 *= scale;
@@ -134,24 +301,258 @@ int CubicSplineApproximator::generate(const std::vector<Vec2>& src, int soff, fl
     // Add the first point if terminating.
     int result = 0;
     if (terminate) {
-        _parambuff.push_back(tp);
-        _pointbuff.push_back(src[soff]);
-        _pointbuff.push_back(src[soff + 1]);
-        _pointbuff.push_back(src[soff + 2]);
+        params.push_back(tp);
+        points.push_back(src[0]);
+        points.push_back(src[1]);
+        points.push_back(src[2]);
         return 1;
     }
-        
-    std::vector<Vec2> left;
-    std::vector<Vec2> rght;
-    CubicSpline::subdivide(src, soff, 0.5, left, rght);
+    
+    // Subdivide at the midpoint (as in CubicSpline::subdivide)
+    Vec2 left[4];
+    Vec2 rght[4];
+    Vec2 h = 0.5f*src[1] + 0.5f*src[2];
+    left[0] = src[0];
+    left[1] = 0.5f*src[0] + 0.5f*src[1];
+    left[2] = 0.5f*left[1] + 0.5f*h;
+    rght[3] = src[3];
+    rght[2] = 0.5f*src[2] + 0.5f*src[3];
+    rght[1] = 0.5f*h + 0.5f*rght[2];
+    rght[0] = 0.5f*left[2] + 0.5f*rght[1];
+    left[3] = rght[0];
         
     // Recursive calls
     float sp = tp + 1.0f / (1 << (depth + 1));
-    result =  generate(left, 0, tp, tolerance, criterion, depth + 1);
-    result += generate(rght, 0, sp, tolerance, criterion, depth + 1);
+    result =  generate(left, tp, tolerance, criterion, depth + 1, points, params);
+    result += generate(rght, sp, tolerance, criterion, depth + 1, points, params);
     return result;
 }
 
+/**
+ * Computes the arc-length table for the approximation.
+ *
+ * The length of each bezier is its integrated speed (see bezier_length).
+ * This does not depend on how flat the approximation criterion makes the
+ * beziers.
+ */
+void CubicSplineApproximator::computeLengths() {
+    size_t count = _parambuff.size();
+    _lengthbuff.resize(count);
+    if (count == 0) {
+        return;
+    }
+    
+    float total = 0;
+    _lengthbuff[0] = 0;
+    for(size_t ii = 1; ii < count; ii++) {
+        total += bezier_length(&(_pointbuff[3*(ii-1)]));
+        _lengthbuff[ii] = total;
+    }
+}
+
+/**
+ * Computes the bounding volume hierarchy for the approximation.
+ *
+ * The beziers of the approximation are ordered along the curve, so the
+ * hierarchy is built by repeatedly splitting the range of beziers in half.
+ */
+void CubicSplineApproximator::computeBounds() {
+    _bounds.clear();
+    if (_parambuff.size() < 2) {
+        return;
+    }
+    Uint32 count = (Uint32)_parambuff.size()-1;
+    _bounds.reserve(2*(count/BOUNDS_LEAF)+1);
+    buildBounds(0, count);
+}
+
+/**
+ * Returns the position of the node covering the given range of beziers.
+ *
+ * This method is the recursive helper for {@link computeBounds}.  It
+ * appends the node and all of its descendants to the hierarchy.
+ *
+ * @param  begin    the first bezier in the range
+ * @param  end      the bezier after the last one in the range
+ *
+ * @return the position of the node covering the given range of beziers.
+ */
+Uint32 CubicSplineApproximator::buildBounds(Uint32 begin, Uint32 end) {
+    Uint32 pos = (Uint32)_bounds.size();
+    _bounds.push_back(Bounds());
+    
+    Bounds node;
+    node.begin = begin;
+    node.end = end;
+    node.right = 0;
+    if (end-begin <= BOUNDS_LEAF) {
+        node.min = _pointbuff[3*begin];
+        node.max = node.min;
+        for(Uint32 ii = 3*begin+1; ii <= 3*end; ii++) {
+            const Vec2& v = _pointbuff[ii];
+            node.min.x = std::min(node.min.x,v.x); node.min.y = std::min(node.min.y,v.y);
+            node.max.x = std::max(node.max.x,v.x); node.max.y = std::max(node.max.y,v.y);
+        }
+    } else {
+        Uint32 mid = begin+(end-begin)/2;
+        buildBounds(begin, mid);
+        node.right = buildBounds(mid, end);
+        
+        // Recursion may reallocate the hierarchy
+        const Bounds& left = _bounds[pos+1];
+        const Bounds& rght = _bounds[node.right];
+        node.min.x = std::min(left.min.x,rght.min.x); node.min.y = std::min(left.min.y,rght.min.y);
+        node.max.x = std::max(left.max.x,rght.max.x); node.max.y = std::max(left.max.y,rght.max.y);
+    }
+    _bounds[pos] = node;
+    return pos;
+}
+
+
+#pragma mark -
+#pragma mark Queries
+/**
+ * Returns the arc length from the start of the spline to the parameter.
+ *
+ * The parameter is clamped to the range of the spline.  This method
+ * performs a binary search of the arc-length table, and interpolates
+ * within a bezier of the approximation.  If calculate has not been
+ * called, this method returns 0.
+ *
+ * @param  tp   the parameter to measure to
+ *
+ * @return the arc length from the start of the spline to the parameter.
+ */
+float CubicSplineApproximator::getArcLength(float tp) const {
+    if (_lengthbuff.size() < 2 || tp <= _parambuff.front()) {
+        return 0.0f;
+    } else if (tp >= _parambuff.back()) {
+        return _lengthbuff.back();
+    }
+    
+    // Parameters are strictly increasing, so this is a proper interval
+    size_t pos = std::upper_bound(_parambuff.begin(), _parambuff.end(), tp)-_parambuff.begin()-1;
+    float s = (tp-_parambuff[pos])/(_parambuff[pos+1]-_parambuff[pos]);
+    return _lengthbuff[pos]+s*(_lengthbuff[pos+1]-_lengthbuff[pos]);
+}
+
+/**
+ * Returns the parameter at the given arc length along the spline.
+ *
+ * This is the inverse of {@link getArcLength}.  It allows a unit to move
+ * along the spline at constant speed.  The length is clamped to the range
+ * [0,{@link getLength}].  If calculate has not been called, this method
+ * returns 0.
+ *
+ * @param  length   the arc length from the start of the spline
+ *
+ * @return the parameter at the given arc length along the spline.
+ */
+float CubicSplineApproximator::getParameter(float length) const {
+    if (_lengthbuff.size() < 2 || length <= 0) {
+        return _parambuff.empty() ? 0.0f : _parambuff.front();
+    } else if (length >= _lengthbuff.back()) {
+        return _parambuff.back();
+    }
+    
+    // The upper bound skips any beziers of length zero
+    size_t pos = std::upper_bound(_lengthbuff.begin(), _lengthbuff.end(), length)-_lengthbuff.begin()-1;
+    float s = (length-_lengthbuff[pos])/(_lengthbuff[pos+1]-_lengthbuff[pos]);
+    return _parambuff[pos]+s*(_parambuff[pos+1]-_parambuff[pos]);
+}
+
+/**
+ * Returns the point at the given arc length along the spline.
+ *
+ * This method is the same as evaluating the spline at the parameter
+ * {@link getParameter}.  If calculate has not been called, this method
+ * returns the start of the spline.
+ *
+ * @param  length   the arc length from the start of the spline
+ *
+ * @return the point at the given arc length along the spline.
+ */
+Vec2 CubicSplineApproximator::getPointAtLength(float length) const {
+    CUAssertLog(_spline, "No spline data");
+    return _spline->getPoint(getParameter(length));
+}
+
+/**
+ * Returns the parameter of the point on the spline nearest the given point.
+ *
+ * This method uses the bounding volume hierarchy of the approximation to
+ * skip every bezier that cannot contain the nearest point, and then solves
+ * the projection polynomial of the remaining ones.  Hence it is much faster
+ * than {@link CubicSpline#nearestParameter}, which solves a polynomial for
+ * every segment of the spline.  The result is exact for every criterion.
+ * If calculate has not been called, this method falls back to that slower
+ * method.
+ *
+ * @param  point    the point to project
+ *
+ * @return the parameter of the point on the spline nearest the given point.
+ */
+float CubicSplineApproximator::nearestParameter(const Vec2& point) const {
+    if (!_calculated) {
+        CUAssertLog(_spline, "No spline data");
+        return _spline->nearestParameter(point);
+    } else if (_bounds.empty()) {
+        return _parambuff.empty() ? 0.0f : _parambuff.front();
+    }
+    
+    float best = std::numeric_limits<float>::infinity();
+    float result = 0;
+    Uint32 stack[BOUNDS_STACK];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        Uint32 pos = stack[--top];
+        const Bounds& node = _bounds[pos];
+        if (box_distance(node.min, node.max, point) >= best) {
+            continue;
+        }
+        
+        if (node.right == 0) {
+            for(Uint32 ii = node.begin; ii < node.end; ii++) {
+                float dist;
+                float u = nearest_on_bezier(&(_pointbuff[3*ii]), point, &dist);
+                if (dist < best) {
+                    best = dist;
+                    result = _parambuff[ii]+u*(_parambuff[ii+1]-_parambuff[ii]);
+                }
+            }
+        } else {
+            // Search the nearer child first
+            const Bounds& left = _bounds[pos+1];
+            const Bounds& rght = _bounds[node.right];
+            CUAssertLog(top+2 <= BOUNDS_STACK, "Bounding volume hierarchy is too deep");
+            if (box_distance(left.min, left.max, point) < box_distance(rght.min, rght.max, point)) {
+                stack[top++] = node.right;
+                stack[top++] = pos+1;
+            } else {
+                stack[top++] = pos+1;
+                stack[top++] = node.right;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the point on the spline nearest the given point.
+ *
+ * This method is the same as evaluating the spline at the parameter
+ * {@link nearestParameter}.  See that method for the performance details.
+ *
+ * @param  point    the point to project
+ *
+ * @return the point on the spline nearest the given point.
+ */
+Vec2 CubicSplineApproximator::nearestPoint(const Vec2& point) const {
+    CUAssertLog(_spline, "No spline data");
+    return _spline->getPoint(nearestParameter(point));
+}
+
 #pragma mark -
 #pragma mark Materialization
 /**
@@ -178,18 +579,18 @@ Poly2 CubicSplineApproximator::getPath() const {
 
     int amt = (size-1)/3;
     poly._vertices.reserve(amt);
-    poly._indices.reserve(2*amt);
+    poly.reserveIndices(2*amt);
     
     for(int ii = 0; 3*ii < size-1; ii++) {
         poly._vertices.push_back(points->at(3*ii));
-        poly._indices.push_back(ii);
-        poly._indices.push_back(ii+1);
+        poly.pushIndex(ii);
+        poly.pushIndex(ii+1);
     }
     if (isClosed()) {
-        poly._indices.pop_back();
-        poly._indices.push_back(0);
+        poly.popIndex();
+        poly.pushIndex(0);
     } else {
-        poly._vertices.push_back(points->at(size));
+        poly._vertices.push_back(points->at(size-1));
     }
     
     poly.setType(Poly2::Type::PATH);
@@ -227,18 +628,18 @@ Poly2* CubicSplineApproximator::getPath(Poly2* buffer) const {
     
     int amt = (size-1)/3;
     buffer->_vertices.reserve(buffer->_vertices.size()+amt);
-    buffer->_indices.reserve(buffer->_indices.size()+2*amt);
+    buffer->reserveIndices(2*amt);
     
     for(int ii = 0; 3*ii < size-1; ii++) {
         buffer->_vertices.push_back(points->at(3*ii));
-        buffer->_indices.push_back(ii+offs  );
-        buffer->_indices.push_back(ii+offs+1);
+        buffer->pushIndex(ii+offs  );
+        buffer->pushIndex(ii+offs+1);
     }
     if (isClosed()) {
-        buffer->_indices.pop_back();
-        buffer->_indices.push_back(offs);
+        buffer->popIndex();
+        buffer->pushIndex(offs);
     } else {
-        buffer->_vertices.push_back(points->at(size));
+        buffer->_vertices.push_back(points->at(size-1));
     }
 
     buffer->setType(Poly2::Type::PATH);
@@ -412,17 +813,17 @@ Poly2* CubicSplineApproximator::getTangents(Poly2* buffer) {
 
     int amt = (size-1)/3;
     buffer->_vertices.reserve(buffer->_vertices.size()+size);
-    buffer->_indices.reserve(buffer->_indices.size()+4*amt);
+    buffer->reserveIndices(4*amt);
 
     // Just copy all of the control points.
     std::copy(points->begin(),points->end(),std::back_inserter(buffer->_vertices));
 
     // And now draw lines between them.
     for(int ii = 0; 3*ii < size-1; ii++) {
-        buffer->_indices.push_back(3*ii+offs  );
-        buffer->_indices.push_back(3*ii+offs+1);
-        buffer->_indices.push_back(3*ii+offs+2);
-        buffer->_indices.push_back(3*ii+offs+3);
+        buffer->pushIndex(3*ii+offs  );
+        buffer->pushIndex(3*ii+offs+1);
+        buffer->pushIndex(3*ii+offs+2);
+        buffer->pushIndex(3*ii+offs+3);
     }
 
     buffer->setType(Poly2::Type::PATH);
@@ -541,7 +942,7 @@ Poly2* CubicSplineApproximator::getNormals(Poly2* buffer) {
         
     int amt = (size-1)/3;
     buffer->_vertices.reserve(buffer->_vertices.size()+2*amt);
-    buffer->_indices.reserve( buffer->_indices.size()+ 2*amt);
+    buffer->reserveIndices(2*amt);
     
     Vec2 temp;
     // Add two distinct vertices and a line
@@ -550,8 +951,8 @@ Poly2* CubicSplineApproximator::getNormals(Poly2* buffer) {
         temp.perp() += points->at(3*ii);
         buffer->_vertices.push_back(points->at(3*ii));
         buffer->_vertices.push_back(temp);
-        buffer->_indices.push_back(2*ii+offs  );
-        buffer->_indices.push_back(2*ii+offs+1);
+        buffer->pushIndex(2*ii+offs  );
+        buffer->pushIndex(2*ii+offs+1);
     }
     
     buffer->setType(Poly2::Type::PATH);
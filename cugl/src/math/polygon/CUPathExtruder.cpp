@@ -43,12 +43,15 @@
 
 #include <cugl/math/polygon/CUPathExtruder.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUThreadPool.h>
 #include <iterator>
 
 /** The number of segments to use in a rounded joint */
 #define JOINT_PRECISION 10
 /** The number of segments to use in a rounded cap */
 #define CAP_PRECISION   10
+/** The number of dead input vertices before an incremental extrusion is compacted */
+#define COMPACT_THRESHOLD 64
 
 namespace cugl {
 
@@ -115,11 +118,85 @@ public:
     unsigned int ppos;
     /** The previous previous vertex index */
     unsigned int p2pos;
+    /** The vertex index of the first segment */
+    unsigned int spos;
 };
 }
 
 using namespace cugl;
 
+/**
+ * Returns the angle of the joint between the previous and current segment.
+ *
+ * @param data  The data necessary to run the Kivy algorithm.
+ *
+ * @return the angle of the joint between the previous and current segment.
+ */
+static float joint_angle(const KivyData* data) {
+    return atan2(data->c.x * data->pc.y - data->c.y * data->pc.x,
+                 data->c.x * data->pc.x + data->c.y * data->pc.y);
+}
+
+/**
+ * Returns the number of vertices in the joint before the current segment.
+ *
+ * This is the number of vertices that {@link PathExtruder#makeJoint} will
+ * create.  It is 0 if no joint is necessary.
+ *
+ * @param data  The data necessary to run the Kivy algorithm.
+ *
+ * @return the number of vertices in the joint before the current segment.
+ */
+static unsigned int joint_size(const KivyData* data) {
+    if (data->index == 0 || data->joint == PathJoint::NONE) {
+        return 0;
+    }
+    float jangle = joint_angle(data);
+    if (jangle == 0) {
+        return 0;
+    }
+    
+    float s, t;
+    switch (data->joint) {
+        case PathJoint::BEVEL:
+            return 1;
+        case PathJoint::ROUND:
+            return JOINT_PRECISION;
+        case PathJoint::MITRE:
+            if (jangle < 0) {
+                return Vec2::doesLineIntersect(data->p1, data->p2, data->v1, data->v2, &s, &t) ? 2 : 0;
+            }
+            return Vec2::doesLineIntersect(data->p3, data->p4, data->v3, data->v4, &s, &t) ? 2 : 0;
+        case PathJoint::NONE:
+            // Nothing to do
+            break;
+    }
+    return 0;
+}
+
+/**
+ * Copies the extruded indices to the given buffer, shifting them.
+ *
+ * The indices are copied from position ifront on.  They are shifted so
+ * that the vertex at vfront is written as offset.  The buffer may be either
+ * 16 or 32 bits, provided that the shifted indices fit.
+ *
+ * @param source    The extruded indices
+ * @param ifront    The position of the first index to copy
+ * @param vfront    The vertex for the first copied index
+ * @param offset    The value to write for vfront
+ * @param indices   The buffer to store the shifted indices
+ */
+template <typename T>
+static void shift_indices(const std::vector<Uint32>& source, Uint32 ifront, Uint32 vfront,
+                          Uint32 offset, T* indices) {
+    // Unsigned arithmetic wraps, so this is safe even if vfront > offset
+    Uint32 shift = offset-vfront;
+    for(auto it = source.begin()+ifront; it != source.end(); ++it) {
+        *indices++ = (T)(*it+shift);
+    }
+}
+
 #pragma mark -
 #pragma mark Initialization
 /**
@@ -142,7 +219,26 @@ void PathExtruder::set(const Poly2& poly) {
                 "The polygon is not a path");
     reset();
     _input = poly._vertices;
-    _closed = poly._indices.size() == poly._vertices.size()*2;
+    _closed = poly.getIndexCount() == poly._vertices.size()*2;
+}
+
+/**
+ * Clears all internal data, but still maintains the initial vertex data.
+ *
+ * If this extruder is performing an incremental extrusion, this method
+ * ends it.  The vertex data is the current (live) path.
+ */
+void PathExtruder::reset() {
+    if (_infront > 0) {
+        _input.erase(_input.begin(), _input.begin()+_infront);
+    }
+    _calculated = false;
+    _incremental = false;
+    _outverts.clear();
+    _outindx.clear();
+    _segments.clear();
+    _infront = _segfront = 0;
+    _bodyverts = _bodyindx = 0;
 }
 
 #pragma mark -
@@ -172,12 +268,11 @@ void PathExtruder::set(const Poly2& poly) {
  * @param cap       The extrusion cap type.
  */
 void PathExtruder::calculate(float stroke, PathJoint joint, PathCap cap) {
+    reset();
     if (_input.size() == 0) {
         _calculated = true;
         return;
     }
-        _outverts.clear();
-    _outindx.clear();
     
     // Closed paths have no cap;
     if (_closed && _input.size() > 2) {
@@ -201,7 +296,7 @@ void PathExtruder::calculate(float stroke, PathJoint joint, PathCap cap) {
     // Iterate through the path
     data.angle = data.sangle = 0;
     data.pangle = data.pangle2 = 0;
-    data.pos = data.ppos = data.p2pos = 0;
+    data.pos = data.ppos = data.p2pos = data.spos = 0;
     int mod = (int)_input.size();
     for(int ii = 0; ii < count-1; ii++) {
         Vec2 a = _input[  ii   % mod];
@@ -213,7 +308,7 @@ void PathExtruder::calculate(float stroke, PathJoint joint, PathCap cap) {
     }
     
     // Process the caps
-    makeCaps(count, &data);
+    makeCaps(_input[0], _input[count-1], &data);
     
     // If closed, make one last joint
     if (_closed && mod > 2) {
@@ -294,6 +389,21 @@ unsigned int PathExtruder::computeSize(PathJoint joint, PathCap cap,
  * @param data  The data necessary to run the Kivy algorithm.
  */
 void PathExtruder::makeSegment(const Vec2& a, const Vec2& b, KivyData* data) {
+    computeSegment(a, b, data);
+    makeQuad(data);
+}
+
+/**
+ * Computes the extruded line segment from a to b without creating it.
+ *
+ * This method updates the algorithm state (including the previous
+ * segment), but does not modify _outvert or _outindx.
+ *
+ * @param a     The start of the line segment
+ * @param b     The end of the line segment.
+ * @param data  The data necessary to run the Kivy algorithm.
+ */
+void PathExtruder::computeSegment(const Vec2& a, const Vec2& b, KivyData* data) {
     if (data->index > 0 && data->joint != PathJoint::NONE) {
         data->pc = data->c;
         data->p1 = data->v1; data->p2 = data->v2;
@@ -322,7 +432,17 @@ void PathExtruder::makeSegment(const Vec2& a, const Vec2& b, KivyData* data) {
         data->s1 = data->v1; data->s4 = data->v4;
         data->sangle = data->angle;
     }
-    
+}
+
+/**
+ * Creates the rectangle for the most recently computed segment.
+ *
+ * The new vertices are appended to _outvert, while the new _indices are
+ * appended to _outindx.
+ *
+ * @param data  The data necessary to run the Kivy algorithm.
+ */
+void PathExtruder::makeQuad(KivyData* data) {
     // Add the indices
     _outindx.push_back(data->pos  );
     _outindx.push_back(data->pos+1);
@@ -356,8 +476,7 @@ bool PathExtruder::makeJoint(const Vec2& a, KivyData* data) {
     }
     
     // calculate the angle of the previous and current segment
-    float jangle = atan2(data->c.x * data->pc.y - data->c.y * data->pc.x,
-                         data->c.x * data->pc.x + data->c.y * data->pc.y);
+    float jangle = joint_angle(data);
     
     // in case of the angle is NULL, avoid the generation
     if (jangle == 0) {
@@ -392,13 +511,12 @@ bool PathExtruder::makeJoint(const Vec2& a, KivyData* data) {
  * @return true if a joint was successfully created.
  */
 bool PathExtruder::makeMitreJoint(const Vec2& a, float jangle, KivyData* data) {
-    _outverts.push_back(a);
-    
-    // Indices depend on angle
+    // Indices depend on angle (only add a if there is an intersection)
     if (jangle < 0) {
         float s, t;
         if (Vec2::doesLineIntersect(data->p1, data->p2, data->v1, data->v2, &s,&t)) {
             Vec2 temp = data->p1 + s*(data->p2-data->p1);
+            _outverts.push_back(a);
             _outverts.push_back(temp);
             _outindx.push_back(data->pos    );
             _outindx.push_back(data->pos+1  );
@@ -413,6 +531,7 @@ bool PathExtruder::makeMitreJoint(const Vec2& a, float jangle, KivyData* data) {
         float s, t;
         if (Vec2::doesLineIntersect(data->p3, data->p4, data->v3, data->v4, &s, &t)) {
             Vec2 temp = data->p3 + s*(data->p4-data->p3);
+            _outverts.push_back(a);
             _outverts.push_back(temp);
             _outindx.push_back(data->pos    );
             _outindx.push_back(data->pos+1  );
@@ -514,18 +633,17 @@ bool PathExtruder::makeRoundJoint(const Vec2& a, float jangle, KivyData* data) {
  * The new vertices are appended to _outvert, while the new _indices are
  * appended to _outindx.
  *
- * @param count     The number of generating points in the path.
+ * @param start     The first generating point in the path.
+ * @param end       The last generating point in the path.
  * @param data      The data necessary to run the Kivy algorithm.
- *
- * @return true if a joint was successfully created.
  */
-void PathExtruder::makeCaps(int count, KivyData* data) {
+void PathExtruder::makeCaps(const Vec2& start, const Vec2& end, KivyData* data) {
     switch (data->cap) {
         case PathCap::SQUARE:
-            makeSquareCaps(count, data);
+            makeSquareCaps(data);
             break;
         case PathCap::ROUND:
-            makeRoundCaps(count, data);
+            makeRoundCaps(start, end, data);
             break;
         case PathCap::NONE:
             // Nothing to do.
@@ -539,12 +657,9 @@ void PathExtruder::makeCaps(int count, KivyData* data) {
  * The new vertices are appended to _outvert, while the new _indices are
  * appended to _outindx.
  *
- * @param count     The number of generating points in the path.
  * @param data      The data necessary to run the Kivy algorithm.
- *
- * @return true if a joint was successfully created.
  */
-void PathExtruder::makeSquareCaps(int count, KivyData* data) {
+void PathExtruder::makeSquareCaps(KivyData* data) {
     // cap end
     Vec2 temp = Vec2(cos(data->angle) * data->stroke,
                      sin(data->angle) * data->stroke);
@@ -563,10 +678,10 @@ void PathExtruder::makeSquareCaps(int count, KivyData* data) {
                 sin(data->sangle) * data->stroke);
     _outverts.push_back(data->s1-temp);
     _outverts.push_back(data->s4-temp);
-    _outindx.push_back(0);
-    _outindx.push_back(3);
+    _outindx.push_back(data->spos);
+    _outindx.push_back(data->spos + 3);
     _outindx.push_back(data->pos + 1 );
-    _outindx.push_back(0);
+    _outindx.push_back(data->spos);
     _outindx.push_back(data->pos);
     _outindx.push_back(data->pos + 1 );
     data->pos += 2;
@@ -578,18 +693,17 @@ void PathExtruder::makeSquareCaps(int count, KivyData* data) {
  * The new vertices are appended to _outvert, while the new _indices are
  * appended to _outindx.
  *
- * @param count     The number of generating points in the path.
+ * @param start     The first generating point in the path.
+ * @param end       The last generating point in the path.
  * @param data      The data necessary to run the Kivy algorithm.
- *
- * @return true if a joint was successfully created.
  */
-void PathExtruder::makeRoundCaps(int count, KivyData* data) {
+void PathExtruder::makeRoundCaps(const Vec2& start, const Vec2& end, KivyData* data) {
     // cap start
     float a1 = data->sangle - M_PI_2;
     float a2 = data->sangle + M_PI_2;
     float step = (a1 - a2) / (float)CAP_PRECISION;
     unsigned int opos = data->pos;
-    data->c = _input[0];
+    data->c = start;
     _outverts.push_back(data->c);
     data->pos += 1;
     for(int i = 0; i < CAP_PRECISION - 1; i++) {
@@ -598,7 +712,7 @@ void PathExtruder::makeRoundCaps(int count, KivyData* data) {
         _outverts.push_back(data->c+temp);
         if (i == 0) {
             _outindx.push_back(opos);
-            _outindx.push_back(0);
+            _outindx.push_back(data->spos);
             _outindx.push_back(data->pos);
         } else {
             _outindx.push_back(opos);
@@ -610,14 +724,14 @@ void PathExtruder::makeRoundCaps(int count, KivyData* data) {
     
     _outindx.push_back(opos );
     _outindx.push_back(data->pos-1);
-    _outindx.push_back(3);
+    _outindx.push_back(data->spos+3);
     
     // cap end
     a1 = data->angle - M_PI_2;
     a2 = data->angle + M_PI_2;
     step = (a2 - a1) / (float)CAP_PRECISION;
     opos = data->pos;
-    data->c = _input[count-1];
+    data->c = end;
     _outverts.push_back(data->c);
     data->pos += 1;
     for(int i = 0; i < CAP_PRECISION - 1; i++) {
@@ -661,8 +775,7 @@ bool PathExtruder::makeLastJoint(KivyData* data) {
     Vec2 temp1, temp2;
 
     data->ppos = 0;
-    float jangle = atan2(data->c.x * data->pc.y - data->c.y * data->pc.x,
-                         data->c.x * data->pc.x + data->c.y * data->pc.y);
+    float jangle = joint_angle(data);
     
     switch (data->joint) {
         case PathJoint::BEVEL:
@@ -692,6 +805,301 @@ bool PathExtruder::makeLastJoint(KivyData* data) {
 }
 
 
+#pragma mark -
+#pragma mark Incremental Calculation
+/**
+ * Starts an incremental extrusion of the current vertex data.
+ *
+ * This method extrudes the current vertex data, just like {@link calculate}.
+ * However, it also retains enough information to update the extrusion
+ * when a point is added or removed at either end of the path.  Use the
+ * methods {@link pushBack}, {@link popFront}, and {@link popBack} to
+ * modify the path.  Each of these methods takes amortized constant time,
+ * and the result is the same extrusion that calculate would produce for
+ * the new path (though the vertices may be in a different order).
+ *
+ * Incremental extrusion is only supported for open paths.  The stroke,
+ * joint, and cap are fixed until the extrusion is restarted.  Any call
+ * to {@link set}, {@link reset}, or {@link calculate} ends the
+ * incremental extrusion.
+ *
+ * @param stroke    The stroke width of the extrusion
+ * @param joint     The extrusion joint type.
+ * @param cap       The extrusion cap type.
+ */
+void PathExtruder::begin(float stroke, PathJoint joint, PathCap cap) {
+    CUAssertLog(!_closed || _input.size() <= 2,
+                "Incremental extrusion does not support closed paths");
+    reset();
+    _closed = false;
+    _stroke = stroke;
+    _joint  = joint;
+    _cap    = cap;
+    _incremental = true;
+    for(size_t ii = 1; ii < _input.size(); ii++) {
+        appendSegment(ii);
+    }
+    makeIncrementalCaps();
+    _calculated = true;
+}
+
+/**
+ * Appends a point to the end of an incremental extrusion.
+ *
+ * This adds a new segment (and joint) to the extrusion, and moves the
+ * end cap.  It takes amortized constant time.
+ *
+ * @param point The point to append
+ */
+void PathExtruder::pushBack(const Vec2& point) {
+    CUAssertLog(_incremental, "The extruder is not in incremental mode");
+    trimCaps();
+    _input.push_back(point);
+    if (_input.size()-_infront > 1) {
+        appendSegment(_input.size()-1);
+    }
+    makeIncrementalCaps();
+}
+
+/**
+ * Removes the first point of an incremental extrusion.
+ *
+ * This removes the first segment (and the joint after it), and moves
+ * the start cap.  It takes amortized constant time.  This is the
+ * appropriate way to shorten a trail.
+ */
+void PathExtruder::popFront() {
+    CUAssertLog(_incremental, "The extruder is not in incremental mode");
+    CUAssertLog(_input.size() > _infront, "The path is empty");
+    trimCaps();
+    _infront++;
+    if (_segments.size() > _segfront) {
+        _segfront++;
+        if (_segments.size() > _segfront) {
+            // The joint before the new first segment is now dead
+            Segment* first = &(_segments[_segfront]);
+            first->vjoint = first->vquad;
+            first->ijoint = first->iquad;
+        }
+    }
+    if (_input.size() == _infront ||
+        (_infront >= COMPACT_THRESHOLD && 2*_infront >= _input.size())) {
+        compact();
+    }
+    makeIncrementalCaps();
+}
+
+/**
+ * Removes the last point of an incremental extrusion.
+ *
+ * This removes the last segment (and the joint before it), and moves
+ * the end cap.  It takes constant time.
+ */
+void PathExtruder::popBack() {
+    CUAssertLog(_incremental, "The extruder is not in incremental mode");
+    CUAssertLog(_input.size() > _infront, "The path is empty");
+    trimCaps();
+    if (_segments.size() > _segfront) {
+        const Segment& last = _segments.back();
+        _outverts.resize(last.vjoint);
+        _outindx.resize(last.ijoint);
+        _segments.pop_back();
+        _bodyverts = _outverts.size();
+        _bodyindx  = _outindx.size();
+    }
+    _input.pop_back();
+    if (_input.size() == _infront) {
+        compact();
+    }
+    makeIncrementalCaps();
+}
+
+/**
+ * Appends the segment ending at the given input position.
+ *
+ * The segment starts at the previous input vertex.  If there is a live
+ * segment before it, this method also creates the joint between them.
+ * The joint is placed before the segment in the output buffers.
+ *
+ * @param index The input position of the segment end
+ */
+void PathExtruder::appendSegment(size_t index) {
+    KivyData data;
+    data.stroke = _stroke;
+    data.joint = _joint;
+    data.cap = _cap;
+    data.angle = data.sangle = 0;
+    data.pangle = data.pangle2 = 0;
+    data.pos = data.ppos = data.p2pos = data.spos = 0;
+    
+    Segment seg;
+    seg.vjoint = (Uint32)_outverts.size();
+    seg.ijoint = (Uint32)_outindx.size();
+    
+    // Restore the state of the previous segment (if any)
+    Uint32 prev = 0;
+    if (_segments.size() > _segfront) {
+        prev = _segments.back().vquad;
+        data.index = 1;
+        data.c = _input[index-1]-_input[index-2];
+        data.angle = atan2(data.c.y, data.c.x);
+        data.v1 = _outverts[prev  ];
+        data.v2 = _outverts[prev+1];
+        data.v3 = _outverts[prev+2];
+        data.v4 = _outverts[prev+3];
+    } else {
+        data.index = 0;
+    }
+    
+    computeSegment(_input[index-1], _input[index], &data);
+    
+    // The joint goes first, so we need to know its size
+    unsigned int jsize = joint_size(&data);
+    data.p2pos = prev;
+    data.ppos  = seg.vjoint+jsize;
+    data.pos   = seg.vjoint;
+    if (jsize > 0) {
+        makeJoint(_input[index-1], &data);
+    }
+    CUAssertLog(data.pos == data.ppos, "Joint size mismatch");
+    
+    seg.vquad = (Uint32)_outverts.size();
+    seg.iquad = (Uint32)_outindx.size();
+    data.pos  = seg.vquad;
+    makeQuad(&data);
+    _segments.push_back(seg);
+}
+
+/**
+ * Removes the caps from the end of the output buffers.
+ */
+void PathExtruder::trimCaps() {
+    _outverts.resize(_bodyverts);
+    _outindx.resize(_bodyindx);
+}
+
+/**
+ * Appends the caps for the live path to the end of the output buffers.
+ */
+void PathExtruder::makeIncrementalCaps() {
+    _bodyverts = _outverts.size();
+    _bodyindx  = _outindx.size();
+    if (_cap == PathCap::NONE || _segments.size() == _segfront) {
+        return;
+    }
+    
+    KivyData data;
+    data.stroke = _stroke;
+    data.joint = _joint;
+    data.cap = _cap;
+    
+    const Segment& first = _segments[_segfront];
+    const Segment& last  = _segments.back();
+    size_t size = _input.size();
+    Vec2 start = _input[_infront];
+    Vec2 end = _input[size-1];
+    
+    Vec2 temp = _input[_infront+1]-start;
+    data.sangle = atan2(temp.y, temp.x);
+    temp = end-_input[size-2];
+    data.angle  = atan2(temp.y, temp.x);
+    data.s1 = _outverts[first.vquad  ];
+    data.s4 = _outverts[first.vquad+3];
+    data.v2 = _outverts[last.vquad+1];
+    data.v3 = _outverts[last.vquad+2];
+    data.spos = first.vquad;
+    data.ppos = last.vquad;
+    data.pos  = (unsigned int)_bodyverts;
+    makeCaps(start, end, &data);
+}
+
+/**
+ * Removes all data for vertices popped from the front of the path.
+ *
+ * This method is linear in the size of the path, but it is only called
+ * when at least half of the input is dead.  Hence it takes amortized
+ * constant time.  The caps must be trimmed before calling this method.
+ */
+void PathExtruder::compact() {
+    Uint32 vbase = getFrontVertex();
+    Uint32 ibase = getFrontIndex();
+    _outverts.erase(_outverts.begin(), _outverts.begin()+vbase);
+    _outindx.erase(_outindx.begin(), _outindx.begin()+ibase);
+    for(auto it = _outindx.begin(); it != _outindx.end(); ++it) {
+        *it -= vbase;
+    }
+    
+    _segments.erase(_segments.begin(), _segments.begin()+_segfront);
+    for(auto it = _segments.begin(); it != _segments.end(); ++it) {
+        it->vjoint -= vbase; it->vquad -= vbase;
+        it->ijoint -= ibase; it->iquad -= ibase;
+    }
+    _input.erase(_input.begin(), _input.begin()+_infront);
+    _bodyverts = _outverts.size();
+    _bodyindx  = _outindx.size();
+    _segfront = 0;
+    _infront = 0;
+}
+
+/**
+ * Returns the position of the first live output vertex.
+ *
+ * @return the position of the first live output vertex.
+ */
+Uint32 PathExtruder::getFrontVertex() const {
+    if (!_incremental) {
+        return 0;
+    }
+    return (Uint32)(_segments.size() > _segfront ? _segments[_segfront].vjoint : _bodyverts);
+}
+
+/**
+ * Returns the position of the first live output index.
+ *
+ * @return the position of the first live output index.
+ */
+Uint32 PathExtruder::getFrontIndex() const {
+    if (!_incremental) {
+        return 0;
+    }
+    return (Uint32)(_segments.size() > _segfront ? _segments[_segfront].ijoint : _bodyindx);
+}
+
+
+#pragma mark -
+#pragma mark Batch Calculation
+/**
+ * Extrudes a batch of paths, storing the results in outputs.
+ *
+ * Each polygon in inputs must be a path.  As with {@link set}, a path is
+ * closed if the number of indices is twice the number of vertices.  Each
+ * path is extruded with the given stroke, joint, and cap, and the result
+ * is stored at the same position in outputs.  The outputs are resized to
+ * match the inputs, but any existing polygons are reused.
+ *
+ * The batch is divided among the threads of the pool (see {@link
+ * ThreadPool#parallelBatch}), with each chunk using its own extruder.
+ * This method blocks until the batch is complete.
+ *
+ * @param pool      The thread pool to perform the batch (may be nullptr)
+ * @param inputs    The paths to extrude
+ * @param outputs   The buffer to store the extruded polygons
+ * @param stroke    The stroke width of the extrusion
+ * @param joint     The extrusion joint type.
+ * @param cap       The extrusion end cap type.
+ */
+void PathExtruder::extrude(const std::shared_ptr<ThreadPool>& pool,
+                           const std::vector<Poly2>& inputs, std::vector<Poly2>& outputs,
+                           float stroke, PathJoint joint, PathCap cap) {
+    outputs.resize(inputs.size());
+    ThreadPool::parallelBatch<PathExtruder>(pool, inputs.size(), [&](PathExtruder& factory, size_t ii) {
+        factory.set(inputs[ii]);
+        factory.calculate(stroke,joint,cap);
+        outputs[ii].clear();
+        factory.getPolygon(&outputs[ii]);
+    });
+}
+
 #pragma mark -
 #pragma mark Materialization
 /**
@@ -709,10 +1117,7 @@ bool PathExtruder::makeLastJoint(KivyData* data) {
 Poly2 PathExtruder::getPolygon() {
     Poly2 poly;
     if (_calculated) {
-        poly._vertices = _outverts;
-        poly._indices  = _outindx;
-        poly._type = Poly2::Type::SOLID;
-        poly.computeBounds();
+        getPolygon(&poly);
     }
     return poly;
 }
@@ -725,7 +1130,8 @@ Poly2 PathExtruder::getPolygon() {
  * will be adjusted accordingly. You should clear the buffer first if
  * you do not want to preserve the original data.
  *
- * If the calculation is not yet performed, this method will do nothing.
+ * If the calculation is not yet performed, or the extrusion is empty, this
+ * method will do nothing.
  *
  * @param buffer    The buffer to store the extruded polygon
  *
@@ -733,22 +1139,80 @@ Poly2 PathExtruder::getPolygon() {
  */
 Poly2* PathExtruder::getPolygon(Poly2* buffer) {
     CUAssertLog(buffer, "Destination buffer is null");
-    if (_calculated) {
-        if (buffer->_vertices.size() == 0) {
-            buffer->_vertices = _outverts;
-            buffer->_indices  = _outindx;
+    // A popped incremental path may have no vertices left
+    if (getVertexCount() > 0) {
+        size_t voffset = buffer->_vertices.size();
+        buffer->_vertices.resize(voffset+getVertexCount());
+        std::copy(_outverts.begin()+getFrontVertex(), _outverts.end(),
+                  buffer->_vertices.begin()+voffset);
+        if (buffer->_vertices.size() > 65536) {
+            buffer->widen();
+        }
+        if (buffer->_wide) {
+            size_t ioffset = buffer->_wideindices.size();
+            buffer->_wideindices.resize(ioffset+getIndexCount());
+            shift_indices(_outindx, getFrontIndex(), getFrontVertex(), (Uint32)voffset,
+                          buffer->_wideindices.data()+ioffset);
         } else {
-            int offset = (int)buffer->_vertices.size();
-            buffer->_vertices.reserve(offset+_outverts.size());
-            std::copy(_outverts.begin(),_outverts.end(),std::back_inserter(buffer->_vertices));
-            
-            buffer->_indices.reserve(buffer->_indices.size()+_outindx.size());
-            for(auto it = _outindx.begin(); it != _outindx.end(); ++it) {
-                buffer->_indices.push_back(offset+*it);
-            }
+            size_t ioffset = buffer->_indices.size();
+            buffer->_indices.resize(ioffset+getIndexCount());
+            shift_indices(_outindx, getFrontIndex(), getFrontVertex(), (Uint32)voffset,
+                          buffer->_indices.data()+ioffset);
         }
         buffer->_type = Poly2::Type::SOLID;
         buffer->computeBounds();
     }
     return buffer;
+}
+
+/**
+ * Stores the path extrusion in the given vertex and index buffers.
+ *
+ * This method does not allocate any memory.  The vertex buffer must have
+ * room for {@link getVertexCount} elements, while the index buffer must
+ * have room for {@link getIndexCount} elements.  The value offset is added
+ * to every index.  This allows the extrusion to be written to the end of
+ * a larger mesh, such as the buffer of a {@link SpriteBatch}.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @param vertices  The buffer to store the extruded vertices
+ * @param indices   The buffer to store the extruded indices
+ * @param offset    The amount to add to each index
+ *
+ * @return the number of vertices written
+ */
+size_t PathExtruder::getPolygon(Vec2* vertices, Uint32* indices, Uint32 offset) const {
+    if (!_calculated) {
+        return 0;
+    }
+    Uint32 vfront = getFrontVertex();
+    Uint32 ifront = getFrontIndex();
+    CUAssertLog(vertices || _outverts.size() == vfront, "Vertex buffer is null");
+    CUAssertLog(indices  || _outindx.size()  == ifront, "Index buffer is null");
+    std::copy(_outverts.begin()+vfront, _outverts.end(), vertices);
+    shift_indices(_outindx, ifront, vfront, offset, indices);
+    return _outverts.size()-vfront;
+}
+
+/**
+ * Returns the number of vertices in the path extrusion.
+ *
+ * If the calculation is not yet performed, this method will return 0.
+ *
+ * @return the number of vertices in the path extrusion.
+ */
+size_t PathExtruder::getVertexCount() const {
+    return _calculated ? _outverts.size()-getFrontVertex() : 0;
+}
+
+/**
+ * Returns the number of indices in the path extrusion.
+ *
+ * If the calculation is not yet performed, this method will return 0.
+ *
+ * @return the number of indices in the path extrusion.
+ */
+size_t PathExtruder::getIndexCount() const {
+    return _calculated ? _outindx.size()-getFrontIndex() : 0;
 }
\ No newline at end of file
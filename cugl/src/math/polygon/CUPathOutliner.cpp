@@ -33,8 +33,10 @@
 
 #include <cugl/math/polygon/CUPathOutliner.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUThreadPool.h>
 #include <iterator>
 
+
 using namespace cugl;
 
 #pragma mark Calculation
@@ -68,14 +70,14 @@ void PathOutliner::calculate(PathTraversal traversal) {
         }
         case PathTraversal::INTERIOR:
         {
-            std::vector<unsigned short> indx;
+            std::vector<Uint32> indx;
             _triangulator.set(_input);
             _triangulator.calculate();
             _triangulator.getTriangulation(indx);
             
             _output.reserve((int)(2*indx.size()));
-            for(int ii = 0; ii < indx.size(); ii++) {
-                int next = (ii % 3 == 2 ? ii-2 : ii+1);
+            for(size_t ii = 0; ii < indx.size(); ii++) {
+                size_t next = (ii % 3 == 2 ? ii-2 : ii+1);
                 _output.push_back(indx[ii  ]);
                 _output.push_back(indx[next]);
             }
@@ -89,6 +91,37 @@ void PathOutliner::calculate(PathTraversal traversal) {
     _calculated = true;
 }
 
+#pragma mark -
+#pragma mark Batch Calculation
+/**
+ * Outlines a batch of polygons, storing the results in outputs.
+ *
+ * Each polygon in inputs is outlined with the given traversal using only
+ * its vertex data, and the result is stored at the same position in
+ * outputs.  The outputs are resized to match the inputs, but any existing
+ * polygons are reused.
+ *
+ * The batch is divided among the threads of the pool (see {@link
+ * ThreadPool#parallelBatch}), with each chunk using its own outliner.
+ * This method blocks until the batch is complete.
+ *
+ * @param pool      The thread pool to perform the batch (may be nullptr)
+ * @param inputs    The polygons to outline
+ * @param outputs   The buffer to store the outlined polygons
+ * @param traversal The traversal type.
+ */
+void PathOutliner::outline(const std::shared_ptr<ThreadPool>& pool,
+                           const std::vector<Poly2>& inputs, std::vector<Poly2>& outputs,
+                           PathTraversal traversal) {
+    outputs.resize(inputs.size());
+    ThreadPool::parallelBatch<PathOutliner>(pool, inputs.size(), [&](PathOutliner& factory, size_t ii) {
+        factory.set(inputs[ii]);
+        factory.calculate(traversal);
+        outputs[ii].clear();
+        factory.getPolygon(&outputs[ii]);
+    });
+}
+
 #pragma mark -
 #pragma mark Materialization
 /**
@@ -100,6 +133,9 @@ void PathOutliner::calculate(PathTraversal traversal) {
  * The outliner does not retain a reference to the returned list; it
  * is safe to modify it.
  *
+ * The list uses 16 bit indices, so the number of vertices may not exceed
+ * 65536.  Use the buffer version of this method for larger meshes.
+ *
  * If the calculation is not yet performed, this method will return the
  * empty list.
  *
@@ -110,9 +146,7 @@ void PathOutliner::calculate(PathTraversal traversal) {
 
 std::vector<unsigned short> PathOutliner::getPath() {
     std::vector<unsigned short> result;
-    if (_calculated) {
-        result.assign(_output.begin(), _output.end());
-    }
+    getPath(result);
     return result;
 }
 
@@ -129,7 +163,7 @@ std::vector<unsigned short> PathOutliner::getPath() {
  *
  * @return the number of elements added to the buffer
  */
-size_t PathOutliner::getPath(std::vector<unsigned short>& buffer) {
+size_t PathOutliner::getPath(std::vector<Uint32>& buffer) {
     if (_calculated) {
         buffer.reserve(buffer.size()+_output.size());
         std::copy(_output.begin(), _output.end(),std::back_inserter(buffer));
@@ -138,6 +172,32 @@ size_t PathOutliner::getPath(std::vector<unsigned short>& buffer) {
     return 0;
 }
 
+/**
+ * Stores the path outline indices in the given 16-bit buffer.
+ *
+ * This version is for meshes that are known to be small, and which should
+ * be stored compactly (e.g. for upload to a 16-bit index buffer).  The
+ * number of vertices may not exceed 65536.
+ *
+ * The indices will be appended to the provided vector. You should clear
+ * the vector first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @return the number of elements added to the buffer
+ */
+size_t PathOutliner::getPath(std::vector<unsigned short>& buffer) {
+    if (_calculated) {
+        CUAssertLog(_input.size() <= 65536, "Vertex count %d exceeds the index range", (int)_input.size());
+        buffer.reserve(buffer.size()+_output.size());
+        for(auto it = _output.begin(); it != _output.end(); ++it) {
+            buffer.push_back((unsigned short)*it);
+        }
+        return _output.size();
+    }
+    return 0;
+}
+
 /**
  * Returns a polygon representing the path outline.
  *
@@ -154,7 +214,7 @@ Poly2 PathOutliner::getPolygon() {
     Poly2 poly;
     if (_calculated) {
         poly._vertices = _input;
-        poly._indices  = _output;
+        poly.appendIndices(_output.data(), _output.size());
         poly._type = Poly2::Type::PATH;
         poly.computeBounds();
     }
@@ -180,16 +240,14 @@ Poly2* PathOutliner::getPolygon(Poly2* buffer) {
     if (_calculated) {
         if (buffer->_vertices.size() == 0) {
             buffer->_vertices = _input;
-            buffer->_indices  = _output;
+            buffer->resetIndices();
+            buffer->appendIndices(_output.data(), _output.size());
         } else {
             int offset = (int)buffer->_vertices.size();
             buffer->_vertices.reserve(offset+_input.size());
             std::copy(_input.begin(),_input.end(),std::back_inserter(buffer->_vertices));
             
-            buffer->_indices.reserve(buffer->_indices.size()+_output.size());
-            for(auto it = _output.begin(); it != _output.end(); ++it) {
-                buffer->_indices.push_back(offset+*it);
-            }
+            buffer->appendIndices(_output.data(), _output.size(), (Uint32)offset);
         }
         buffer->_type = Poly2::Type::PATH;
         buffer->computeBounds();
@@ -0,0 +1,1466 @@
+//
+//  CUPolyClipper.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a factory for boolean operations (union, intersection,
+//  difference, and exclusive-or) on polygons, as well as for offsetting
+//  (inflating or deflating) polygons.  This is the basis for destructible
+//  terrain, where an explosion is subtracted from the affected polygons.
+//
+//  The calculation is performed on an integer grid, in the style of Vatti's
+//  clipping algorithm.  The plane is divided into scanbeams at every vertex.
+//  Crossing edges are split at their (snapped) intersection points, so that
+//  the edges within a scanbeam are ordered.  The active edges then carry
+//  their winding numbers from one scanline to the next, and the result is
+//  assembled from the edges that bound the boolean operation.
+//
+//  Because math objects are intended to be on the stack, we do not provide
+//  any shared pointer support in this class.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/19/26
+
+#include <cugl/math/polygon/CUPolyClipper.h>
+#include <cugl/math/polygon/CUComplexTriangulator.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+
+/** The maximum number of times to split crossing edges (snapping can create new crossings) */
+#define SPLIT_PASSES    4
+/** The largest grid coordinate (in absolute value) supported by the clipper */
+#define CLIP_RANGE      0x20000000LL
+/** The maximum error of a round joint, as a fraction of the offset */
+#define ARC_TOLERANCE   0.005
+/** The minimum error of a round joint, in grid units */
+#define ARC_MINIMUM     0.25
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Helpers
+/**
+ * Returns the grid coordinate for the given value
+ *
+ * @param value The value in grid units
+ *
+ * @return the grid coordinate for the given value
+ */
+static Sint64 snap_value(double value) {
+    CUAssertLog(std::abs(value) < (double)CLIP_RANGE, "Value %f is out of the clipper range", value);
+    return (Sint64)std::llround(value);
+}
+
+/**
+ * Returns true if the given boolean operation includes the given point.
+ *
+ * @param op        The boolean operation
+ * @param subject   Whether the point is inside the subject
+ * @param clip      Whether the point is inside the clip
+ *
+ * @return true if the given boolean operation includes the given point.
+ */
+static bool is_included(ClipOperation op, bool subject, bool clip) {
+    switch (op) {
+        case ClipOperation::UNION:
+            return subject || clip;
+        case ClipOperation::INTERSECTION:
+            return subject && clip;
+        case ClipOperation::DIFFERENCE:
+            return subject && !clip;
+        case ClipOperation::XOR:
+            return subject != clip;
+    }
+    return false;
+}
+
+/**
+ * Returns true if the fill rule includes the given winding number.
+ *
+ * @param rule  The fill rule
+ * @param wind  The winding number
+ *
+ * @return true if the fill rule includes the given winding number.
+ */
+static bool is_filled(FillRule rule, int wind) {
+    switch (rule) {
+        case FillRule::EVEN_ODD:
+            return (wind % 2) != 0;
+        case FillRule::NON_ZERO:
+            return wind != 0;
+        case FillRule::POSITIVE:
+            return wind > 0;
+    }
+    return false;
+}
+
+/**
+ * Appends the closed loops formed by the given directed edges.
+ *
+ * The edges are pairs of indices into the vertex list.  The edges are
+ * linked head to tail.  If the edges do not form a closed loop, the loop
+ * is closed when it can no longer be extended.
+ *
+ * @param edges     The directed edges
+ * @param vertices  The vertex positions
+ * @param output    The buffer to store the loop vertices
+ * @param loops     The buffer to store the loop sizes
+ */
+static void chain_edges(std::vector<std::pair<Uint32,Uint32>>& edges,
+                        const std::vector<Vec2>& vertices,
+                        std::vector<Vec2>& output, std::vector<size_t>& loops) {
+    std::sort(edges.begin(),edges.end());
+    size_t vcount = vertices.size();
+    std::vector<size_t> head(vcount+1,0);
+    for(auto it = edges.begin(); it != edges.end(); ++it) {
+        head[it->first+1]++;
+    }
+    for(size_t ii = 0; ii < vcount; ii++) {
+        head[ii+1] += head[ii];
+    }
+    std::vector<size_t> cursor(head.begin(),head.end()-1);
+    for(size_t ii = 0; ii < vcount; ii++) {
+        while (cursor[ii] < head[ii+1]) {
+            size_t size = 0;
+            Uint32 curr = (Uint32)ii;
+            size_t edge = cursor[ii]++;
+            output.push_back(vertices[curr]);
+            size++;
+            curr = edges[edge].second;
+            while (curr != ii && cursor[curr] < head[curr+1]) {
+                output.push_back(vertices[curr]);
+                size++;
+                edge = cursor[curr]++;
+                curr = edges[edge].second;
+            }
+            if (curr != ii) {
+                output.push_back(vertices[curr]);
+                size++;
+            }
+            loops.push_back(size);
+        }
+    }
+}
+
+/**
+ * Appends the outlines of the given polygon to the buffers.
+ *
+ * If the polygon is SOLID, the outlines are the boundary edges of the
+ * triangulation.  If it is a PATH, the outlines are the index segments.
+ * Otherwise, the vertices are a single outline.
+ *
+ * @param poly      The polygon to extract
+ * @param output    The buffer to store the outline vertices
+ * @param loops     The buffer to store the outline sizes
+ */
+static void extract_loops(const Poly2& poly, std::vector<Vec2>& output, std::vector<size_t>& loops) {
+    const std::vector<Vec2>& vertices = poly.getVertices();
+    size_t count = poly.getIndexCount();
+    std::vector<std::pair<Uint32,Uint32>> edges;
+    switch (poly.getType()) {
+        case Poly2::Type::SOLID:
+        {
+            // Orient every triangle counter-clockwise, keyed by undirected edge
+            std::vector<std::pair<std::pair<Uint32,Uint32>,int>> keys;
+            keys.reserve(count);
+            for(size_t ii = 0; ii+2 < count; ii += 3) {
+                Uint32 a = poly.getIndex(ii);
+                Uint32 b = poly.getIndex(ii+1);
+                Uint32 c = poly.getIndex(ii+2);
+                float area = (vertices[b]-vertices[a]).cross(vertices[c]-vertices[a]);
+                if (area == 0) {
+                    continue;
+                } else if (area < 0) {
+                    std::swap(b,c);
+                }
+                Uint32 tri[3] = { a, b, c };
+                for(int jj = 0; jj < 3; jj++) {
+                    Uint32 s = tri[jj];
+                    Uint32 t = tri[(jj+1)%3];
+                    keys.push_back(std::make_pair(std::make_pair(std::min(s,t),std::max(s,t)),s < t ? 1 : -1));
+                }
+            }
+
+            // Interior edges cancel out
+            std::sort(keys.begin(),keys.end());
+            for(size_t ii = 0; ii < keys.size(); ) {
+                size_t jj = ii;
+                int net = 0;
+                while (jj < keys.size() && keys[jj].first == keys[ii].first) {
+                    net += keys[jj].second;
+                    jj++;
+                }
+                std::pair<Uint32,Uint32> edge = keys[ii].first;
+                if (net < 0) {
+                    std::swap(edge.first,edge.second);
+                }
+                for(int kk = 0; kk < std::abs(net); kk++) {
+                    edges.push_back(edge);
+                }
+                ii = jj;
+            }
+            chain_edges(edges,vertices,output,loops);
+        }
+            break;
+        case Poly2::Type::PATH:
+            for(size_t ii = 0; ii+1 < count; ii += 2) {
+                if (poly.getIndex(ii) != poly.getIndex(ii+1)) {
+                    edges.push_back(std::make_pair(poly.getIndex(ii),poly.getIndex(ii+1)));
+                }
+            }
+            chain_edges(edges,vertices,output,loops);
+            break;
+        case Poly2::Type::UNDEFINED:
+            if (vertices.size() >= 3) {
+                std::copy(vertices.begin(),vertices.end(),std::back_inserter(output));
+                loops.push_back(vertices.size());
+            }
+            break;
+    }
+}
+
+/**
+ * Returns the x-coordinate of the given edge at height y.
+ *
+ * The value is exact at the end points of the edge.
+ *
+ * @param bot   The bottom of the edge
+ * @param top   The top of the edge
+ * @param y     The height to evaluate
+ *
+ * @return the x-coordinate of the given edge at height y.
+ */
+template <typename T>
+static double edge_x(const T& bot, const T& top, Sint64 y) {
+    if (y <= bot.y) {
+        return (double)bot.x;
+    } else if (y >= top.y) {
+        return (double)top.x;
+    }
+    return (double)bot.x+(double)(top.x-bot.x)*(double)(y-bot.y)/(double)(top.y-bot.y);
+}
+
+/**
+ * Returns the signed orientation of the points a, b, c
+ *
+ * The value is positive if the points turn left, negative if they turn
+ * right, and 0 if they are colinear.
+ *
+ * @param a     The first point
+ * @param b     The second point
+ * @param c     The third point
+ *
+ * @return the signed orientation of the points a, b, c
+ */
+template <typename T>
+static int orient(const T& a, const T& b, const T& c) {
+    Sint64 p1 = (b.x-a.x)*(c.y-a.y);
+    Sint64 p2 = (b.y-a.y)*(c.x-a.x);
+    return p1 > p2 ? 1 : (p1 < p2 ? -1 : 0);
+}
+
+/**
+ * Returns the clockwise angle from the vector r to the vector c.
+ *
+ * The value is in the range (0,2pi].  In particular, the angle from a
+ * vector to itself is 2pi.
+ *
+ * @param rx    The x-coordinate of r
+ * @param ry    The y-coordinate of r
+ * @param cx    The x-coordinate of c
+ * @param cy    The y-coordinate of c
+ *
+ * @return the clockwise angle from the vector r to the vector c.
+ */
+static double clockwise_angle(Sint64 rx, Sint64 ry, Sint64 cx, Sint64 cy) {
+    double cross = (double)rx*(double)cy-(double)ry*(double)cx;
+    double dot = (double)rx*(double)cx+(double)ry*(double)cy;
+    double angle = -atan2(cross,dot);
+    return angle <= 0 ? angle+2*M_PI : angle;
+}
+
+/**
+ * Removes the duplicate and colinear points from the given loop.
+ *
+ * This also removes any spikes from the loop.
+ *
+ * @param points    The loop to simplify
+ */
+template <typename T>
+static void simplify_loop(std::vector<T>& points) {
+    size_t size = 0;
+    for(size_t ii = 0; ii < points.size(); ii++) {
+        T p = points[ii];
+        bool keep = true;
+        while (keep && size > 0) {
+            const T& q = points[size-1];
+            if (q.x == p.x && q.y == p.y) {
+                keep = false;
+            } else if (size > 1 && orient(points[size-2],q,p) == 0) {
+                size--;
+            } else {
+                break;
+            }
+        }
+        if (keep) {
+            points[size++] = p;
+        }
+    }
+    points.resize(size);
+
+    // Now check the wrap around
+    size_t first = 0;
+    bool changed = true;
+    while (changed && size-first >= 3) {
+        changed = false;
+        const T& a = points[size-2];
+        const T& b = points[size-1];
+        const T& c = points[first];
+        const T& d = points[first+1];
+        if (b.x == c.x && b.y == c.y) {
+            size--;
+            changed = true;
+        } else if (orient(a,b,c) == 0) {
+            size--;
+            changed = true;
+        } else if (orient(b,c,d) == 0) {
+            first++;
+            changed = true;
+        }
+    }
+    if (size-first < 3) {
+        points.clear();
+    } else {
+        points.erase(points.begin()+size,points.end());
+        points.erase(points.begin(),points.begin()+first);
+    }
+}
+
+/**
+ * Returns twice the signed area of the given loop.
+ *
+ * @param points    The loop vertices
+ * @param size      The number of vertices
+ *
+ * @return twice the signed area of the given loop.
+ */
+template <typename T>
+static double loop_area(const T* points, size_t size) {
+    double area = 0;
+    for(size_t ii = 0; ii < size; ii++) {
+        const T& a = points[ii];
+        const T& b = points[(ii+1) % size];
+        area += (double)(a.x*b.y-a.y*b.x);
+    }
+    return area;
+}
+
+/**
+ * Returns the classification of a point with respect to a loop.
+ *
+ * The point is given in doubled coordinates, so that it may be the midpoint
+ * of two grid points.  The result is 1 if the point is inside, 0 if it is
+ * outside, and -1 if it is on the boundary.
+ *
+ * @param qx        The doubled x-coordinate of the point
+ * @param qy        The doubled y-coordinate of the point
+ * @param points    The loop vertices
+ * @param size      The number of vertices
+ *
+ * @return the classification of a point with respect to a loop.
+ */
+template <typename T>
+static int classify_point(Sint64 qx, Sint64 qy, const T* points, size_t size) {
+    bool inside = false;
+    for(size_t ii = 0; ii < size; ii++) {
+        const T& a = points[ii];
+        const T& b = points[(ii+1) % size];
+        Sint64 ax = 2*a.x, ay = 2*a.y;
+        Sint64 bx = 2*b.x, by = 2*b.y;
+        Sint64 p1 = (bx-ax)*(qy-ay);
+        Sint64 p2 = (by-ay)*(qx-ax);
+        if (p1 == p2 && std::min(ax,bx) <= qx && qx <= std::max(ax,bx) &&
+            std::min(ay,by) <= qy && qy <= std::max(ay,by)) {
+            return -1;
+        }
+        if ((ay > qy) != (by > qy)) {
+            bool right = by > ay ? p1 > p2 : p1 < p2;
+            if (right) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside ? 1 : 0;
+}
+
+
+#pragma mark -
+#pragma mark Initialization
+/**
+ * Sets the subject polygon for this clipper.
+ *
+ * The outlines are extracted according to the polygon type.  If the
+ * polygon is SOLID, the outlines are the boundary edges of the
+ * triangulation (those edges that belong to exactly one triangle).  If
+ * it is a PATH, the outlines are the index segments, and any path that is
+ * open is treated as closed.  Otherwise, the vertices are treated as a
+ * single outline.
+ *
+ * This method resets all interal data.  You will need to reperform the
+ * calculation before accessing data.
+ *
+ * @param poly  The subject polygon
+ */
+void PolyClipper::setSubject(const Poly2& poly) {
+    reset();
+    _subject.clear();
+    _subloops.clear();
+    extract_loops(poly,_subject,_subloops);
+}
+
+/**
+ * Adds an outline to the subject polygon.
+ *
+ * The outline is closed, and may have either orientation.  This method
+ * resets all interal data.  You will need to reperform the calculation
+ * before accessing data.
+ *
+ * @param points    The vertices of the outline
+ */
+void PolyClipper::addSubject(const std::vector<Vec2>& points) {
+    reset();
+    if (points.empty()) {
+        return;
+    }
+    _subject.reserve(_subject.size()+points.size());
+    std::copy(points.begin(),points.end(),std::back_inserter(_subject));
+    _subloops.push_back(points.size());
+}
+
+/**
+ * Sets the clip polygon for this clipper.
+ *
+ * The outlines are extracted as described in {@link setSubject}.
+ *
+ * This method resets all interal data.  You will need to reperform the
+ * calculation before accessing data.
+ *
+ * @param poly  The clip polygon
+ */
+void PolyClipper::setClip(const Poly2& poly) {
+    reset();
+    _clip.clear();
+    _cliploops.clear();
+    extract_loops(poly,_clip,_cliploops);
+}
+
+/**
+ * Adds an outline to the clip polygon.
+ *
+ * The outline is closed, and may have either orientation.  This method
+ * resets all interal data.  You will need to reperform the calculation
+ * before accessing data.
+ *
+ * @param points    The vertices of the outline
+ */
+void PolyClipper::addClip(const std::vector<Vec2>& points) {
+    reset();
+    if (points.empty()) {
+        return;
+    }
+    _clip.reserve(_clip.size()+points.size());
+    std::copy(points.begin(),points.end(),std::back_inserter(_clip));
+    _cliploops.push_back(points.size());
+}
+
+
+#pragma mark -
+#pragma mark Calculation
+/**
+ * Performs a boolean operation on the subject and clip polygons.
+ *
+ * The fill rule determines which points are inside of the subject and
+ * the clip polygons.  Using {@link ClipOperation#UNION} with an empty
+ * clip polygon will simplify the subject polygon, removing any self-
+ * intersections.
+ *
+ * @param op    The boolean operation
+ * @param rule  The fill rule for the subject and clip polygons
+ */
+void PolyClipper::calculate(ClipOperation op, FillRule rule) {
+    reset();
+    _edges.clear();
+    _horizontals.clear();
+    std::vector<GridPoint> points;
+    points.reserve(std::max(_subject.size(),_clip.size()));
+    for(auto it = _subject.begin(); it != _subject.end(); ++it) {
+        points.push_back(toGrid(*it));
+    }
+    computeEdges(points,_subloops,false);
+    points.clear();
+    for(auto it = _clip.begin(); it != _clip.end(); ++it) {
+        points.push_back(toGrid(*it));
+    }
+    computeEdges(points,_cliploops,true);
+    solve(op,rule);
+    computeRegions();
+    _calculated = true;
+}
+
+/**
+ * Performs an offset of the subject polygon.
+ *
+ * If delta is positive, the polygon is grown by that distance (so holes
+ * will shrink).  If it is negative, the polygon is shrunk.  The joint
+ * determines the shape of the convex corners.  For a mitre joint, the
+ * limit is the maximum distance of the corner from the original vertex,
+ * as a multiple of delta.  A corner exceeding this limit is beveled.
+ * The other joints ignore this value.  The value {@link PathJoint#NONE}
+ * is treated as a bevel joint.
+ *
+ * The subject polygon is first simplified with the non-zero fill rule.
+ * The clip polygon is ignored.
+ *
+ * @param delta The distance to offset the outlines
+ * @param joint The shape of the convex corners
+ * @param limit The mitre limit
+ */
+void PolyClipper::offset(float delta, PathJoint joint, float limit) {
+    reset();
+    _edges.clear();
+    _horizontals.clear();
+    std::vector<GridPoint> points;
+    points.reserve(_subject.size());
+    for(auto it = _subject.begin(); it != _subject.end(); ++it) {
+        points.push_back(toGrid(*it));
+    }
+    computeEdges(points,_subloops,false);
+    solve(ClipOperation::UNION,FillRule::NON_ZERO);
+
+    // The simplified loops have the interior on the left
+    double gdelta = (double)delta*_precision;
+    if (gdelta != 0 && !_gridloops.empty()) {
+        std::vector<size_t> loops;
+        loops.reserve(_gridloops.size());
+        points.clear();
+        size_t pos = 0;
+        for(auto it = _gridloops.begin(); it != _gridloops.end(); ++it) {
+            loops.push_back(offsetLoop(_gridverts.data()+pos,*it,gdelta,joint,limit,points));
+            pos += *it;
+        }
+        _edges.clear();
+        _horizontals.clear();
+        computeEdges(points,loops,false);
+        solve(ClipOperation::UNION,FillRule::POSITIVE);
+    }
+    computeRegions();
+    _calculated = true;
+}
+
+
+#pragma mark -
+#pragma mark Materialization
+/**
+ * Returns the outlines of the result.
+ *
+ * The outer boundaries are counter-clockwise, while the holes are
+ * clockwise.  Each outer boundary is followed by the holes inside of it.
+ * If the calculation is not yet performed, this method will return the
+ * empty list.
+ *
+ * @return the outlines of the result.
+ */
+std::vector<std::vector<Vec2>> PolyClipper::getOutlines() const {
+    std::vector<std::vector<Vec2>> result;
+    getOutlines(result);
+    return result;
+}
+
+/**
+ * Stores the outlines of the result in the given buffer.
+ *
+ * The outer boundaries are counter-clockwise, while the holes are
+ * clockwise.  Each outer boundary is followed by the holes inside of it.
+ * The outlines will be appended to the buffer.  You should clear the
+ * buffer first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @param buffer    The buffer to store the outlines
+ *
+ * @return the number of outlines added to the buffer
+ */
+size_t PolyClipper::getOutlines(std::vector<std::vector<Vec2>>& buffer) const {
+    if (_calculated) {
+        buffer.reserve(buffer.size()+_outloops.size());
+        size_t pos = 0;
+        for(auto it = _outloops.begin(); it != _outloops.end(); ++it) {
+            buffer.emplace_back(_output.begin()+pos,_output.begin()+pos+*it);
+            pos += *it;
+        }
+        return _outloops.size();
+    }
+    return 0;
+}
+
+/**
+ * Returns a wireframe polygon of the result outlines.
+ *
+ * The polygon is a PATH, with each outline closed.  The resulting polygon
+ * may be used as the subject or clip of another clipper.  If the
+ * calculation is not yet performed, this method will return the empty
+ * polygon.
+ *
+ * @return a wireframe polygon of the result outlines.
+ */
+Poly2 PolyClipper::getPath() const {
+    Poly2 poly;
+    getPath(&poly);
+    return poly;
+}
+
+/**
+ * Stores a wireframe polygon of the result outlines in the buffer.
+ *
+ * The polygon is a PATH, with each outline closed.  The vertices (and
+ * indices) will be appended to the the Poly2 if it is not empty.  You
+ * should clear the Poly2 first if you do not want to preserve the
+ * original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @param buffer    The buffer to store the wireframe polygon
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* PolyClipper::getPath(Poly2* buffer) const {
+    CUAssertLog(buffer, "Destination buffer is null");
+    if (_calculated) {
+        size_t offset = buffer->_vertices.size();
+        buffer->_vertices.reserve(offset+_output.size());
+        std::copy(_output.begin(),_output.end(),std::back_inserter(buffer->_vertices));
+
+        buffer->reserveIndices(2*_output.size());
+        for(auto it = _outloops.begin(); it != _outloops.end(); ++it) {
+            for(size_t ii = 0; ii < *it; ii++) {
+                buffer->pushIndex((Uint32)(offset+ii));
+                buffer->pushIndex((Uint32)(offset+(ii+1) % *it));
+            }
+            offset += *it;
+        }
+        buffer->_type = Poly2::Type::PATH;
+        buffer->computeBounds();
+    }
+    return buffer;
+}
+
+/**
+ * Returns a solid polygon of the result.
+ *
+ * Each region of the result is triangulated with a {@link ComplexTriangulator}.
+ * If the calculation is not yet performed, this method will return the
+ * empty polygon.
+ *
+ * @return a solid polygon of the result.
+ */
+Poly2 PolyClipper::getPolygon() const {
+    Poly2 poly;
+    getPolygon(&poly);
+    return poly;
+}
+
+/**
+ * Stores a solid polygon of the result in the buffer.
+ *
+ * Each region of the result is triangulated with a {@link ComplexTriangulator}.
+ * The vertices (and indices) will be appended to the the Poly2 if it is
+ * not empty.  You should clear the Poly2 first if you do not want to
+ * preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @param buffer    The buffer to store the solid polygon
+ *
+ * @return a reference to the buffer for chaining.
+ */
+Poly2* PolyClipper::getPolygon(Poly2* buffer) const {
+    CUAssertLog(buffer, "Destination buffer is null");
+    if (_calculated) {
+        ComplexTriangulator triangulator;
+        std::vector<Vec2> outline;
+        size_t loop = 0;
+        size_t pos  = 0;
+        for(auto it = _outgroups.begin(); it != _outgroups.end(); ++it) {
+            for(size_t ii = 0; ii < *it; ii++) {
+                outline.assign(_output.begin()+pos,_output.begin()+pos+_outloops[loop]);
+                pos += _outloops[loop++];
+                if (ii == 0) {
+                    triangulator.set(outline);
+                } else {
+                    triangulator.addHole(outline);
+                }
+            }
+            triangulator.calculate();
+            triangulator.getPolygon(buffer);
+        }
+    }
+    return buffer;
+}
+
+
+#pragma mark -
+#pragma mark Internal Data Generation
+/**
+ * Returns the grid point for the given vertex.
+ *
+ * @param point The vertex in world coordinates
+ *
+ * @return the grid point for the given vertex.
+ */
+PolyClipper::GridPoint PolyClipper::toGrid(const Vec2& point) const {
+    GridPoint result;
+    result.x = snap_value((double)point.x*_precision);
+    result.y = snap_value((double)point.y*_precision);
+    return result;
+}
+
+/**
+ * Appends the edges of the given outlines to the calculation.
+ *
+ * Horizontal edges do not change the winding number of any scanbeam, so
+ * they are stored separately.  They are only needed to split the edges
+ * that cross them.
+ *
+ * @param points    The vertices of the outlines
+ * @param loops     The number of vertices in each outline
+ * @param clip      Whether the outlines belong to the clip polygon
+ */
+void PolyClipper::computeEdges(const std::vector<GridPoint>& points, const std::vector<size_t>& loops,
+                               bool clip) {
+    size_t pos = 0;
+    for(auto it = loops.begin(); it != loops.end(); ++it) {
+        for(size_t ii = 0; ii < *it; ii++) {
+            const GridPoint& a = points[pos+ii];
+            const GridPoint& b = points[pos+(ii+1) % *it];
+            Edge edge;
+            if (a.y == b.y) {
+                if (a.x != b.x) {
+                    edge.bot = a.x < b.x ? a : b;
+                    edge.top = a.x < b.x ? b : a;
+                    edge.wind = 0;
+                    edge.clip = clip;
+                    _horizontals.push_back(edge);
+                }
+                continue;
+            } else if (a.y < b.y) {
+                edge.bot = a;
+                edge.top = b;
+                edge.wind = -1;
+            } else {
+                edge.bot = b;
+                edge.top = a;
+                edge.wind = 1;
+            }
+            edge.clip = clip;
+            _edges.push_back(edge);
+        }
+        pos += *it;
+    }
+}
+
+/**
+ * Splits the edges of the calculation at their intersection points.
+ *
+ * This method sweeps the scanbeams, and finds every pair of edges that
+ * changes order within a scanbeam (or at a scanline that is not a vertex
+ * of either edge).  Both edges are split at their intersection point,
+ * snapped to the grid.  An edge is also split where it crosses the interior
+ * of a horizontal edge, as the winding numbers change there.  The active
+ * edges stay sorted from one scanbeam to the next, so each scanbeam is only
+ * an insertion sort of a nearly sorted list.  Snapping can (rarely) create
+ * new intersections, so this method should be called until it returns false.
+ *
+ * @return true if any edges were split
+ */
+bool PolyClipper::splitEdges() {
+    size_t ecount = _edges.size();
+    std::vector<Sint64> ys;
+    ys.reserve(2*ecount);
+    for(auto it = _edges.begin(); it != _edges.end(); ++it) {
+        ys.push_back(it->bot.y);
+        ys.push_back(it->top.y);
+    }
+    std::sort(ys.begin(),ys.end());
+    ys.erase(std::unique(ys.begin(),ys.end()),ys.end());
+
+    std::vector<size_t> order(ecount);
+    for(size_t ii = 0; ii < ecount; ii++) {
+        order[ii] = ii;
+    }
+    std::sort(order.begin(),order.end(),[this](size_t a, size_t b) {
+        return _edges[a].bot.y < _edges[b].bot.y;
+    });
+    std::sort(_horizontals.begin(),_horizontals.end(),[](const Edge& a, const Edge& b) {
+        return a.bot.y < b.bot.y;
+    });
+
+    // Find every pair that changes order in a scanbeam
+    std::vector<double> xa(ecount);
+    std::vector<double> xb(ecount);
+    std::vector<size_t> active;
+    std::vector<std::pair<size_t,GridPoint>> splits;
+    auto below = [&](size_t a, size_t b) {
+        return xa[a] < xa[b] || (xa[a] == xa[b] && xb[a] < xb[b]);
+    };
+    size_t next = 0;
+    size_t flat = 0;
+    for(size_t kk = 0; kk+1 < ys.size(); kk++) {
+        Sint64 ya = ys[kk];
+        Sint64 yb = ys[kk+1];
+        active.erase(std::remove_if(active.begin(),active.end(),[this,ya](size_t e) {
+            return _edges[e].top.y <= ya;
+        }),active.end());
+
+        // The active edges are still sorted by their position at ya
+        size_t old = active.size();
+        for(auto it = active.begin(); it != active.end(); ++it) {
+            xa[*it] = xb[*it];
+            xb[*it] = edge_x(_edges[*it].bot,_edges[*it].top,yb);
+        }
+
+        // Split the edges passing through a horizontal edge
+        while (flat < _horizontals.size() && _horizontals[flat].bot.y < ya) {
+            flat++;
+        }
+        for(; flat < _horizontals.size() && _horizontals[flat].bot.y == ya; flat++) {
+            double x0 = (double)_horizontals[flat].bot.x;
+            double x1 = (double)_horizontals[flat].top.x;
+            auto it = std::upper_bound(active.begin(),active.begin()+old,x0,[&](double x, size_t e) {
+                return x < xa[e];
+            });
+            for(; it != active.begin()+old && xa[*it] < x1; ++it) {
+                GridPoint p;
+                p.x = snap_value(xa[*it]);
+                p.y = ya;
+                splits.push_back(std::make_pair(*it,p));
+            }
+        }
+
+        // Edges that touch at ya and swap there cross at that point
+        for(size_t ii = 1; ii < old; ii++) {
+            size_t key = active[ii];
+            size_t jj = ii;
+            while (jj > 0 && below(key,active[jj-1])) {
+                size_t left = active[jj-1];
+                GridPoint p;
+                p.x = snap_value(xa[key]);
+                p.y = ya;
+                splits.push_back(std::make_pair(left,p));
+                splits.push_back(std::make_pair(key,p));
+                active[jj] = left;
+                jj--;
+            }
+            active[jj] = key;
+        }
+
+        // Merge in the edges that start at ya
+        while (next < ecount && _edges[order[next]].bot.y <= ya) {
+            size_t e = order[next++];
+            xa[e] = edge_x(_edges[e].bot,_edges[e].top,ya);
+            xb[e] = edge_x(_edges[e].bot,_edges[e].top,yb);
+            active.push_back(e);
+        }
+        std::sort(active.begin()+old,active.end(),below);
+        std::inplace_merge(active.begin(),active.begin()+old,active.end(),below);
+
+        // Each swap in the insertion sort is a crossing
+        for(size_t ii = 1; ii < active.size(); ii++) {
+            size_t key = active[ii];
+            size_t jj = ii;
+            while (jj > 0 && xb[active[jj-1]] > xb[key]) {
+                size_t left = active[jj-1];
+                double da = xa[key]-xa[left];
+                double db = xb[left]-xb[key];
+                double t  = da/(da+db);
+                GridPoint p;
+                p.x = snap_value(xa[left]+t*(xb[left]-xa[left]));
+                p.y = snap_value(ya+t*(yb-ya));
+                splits.push_back(std::make_pair(left,p));
+                splits.push_back(std::make_pair(key,p));
+                active[jj] = left;
+                jj--;
+            }
+            active[jj] = key;
+        }
+    }
+    if (splits.empty()) {
+        return false;
+    }
+
+    std::sort(splits.begin(),splits.end(),[](const std::pair<size_t,GridPoint>& a,
+                                             const std::pair<size_t,GridPoint>& b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        return a.second.y < b.second.y || (a.second.y == b.second.y && a.second.x < b.second.x);
+    });
+
+    // Replace each split edge with its pieces
+    bool changed = false;
+    std::vector<Edge> edges;
+    std::vector<GridPoint> points;
+    edges.reserve(ecount+splits.size());
+    size_t pos = 0;
+    for(size_t ii = 0; ii < ecount; ii++) {
+        const Edge& edge = _edges[ii];
+        if (pos == splits.size() || splits[pos].first != ii) {
+            edges.push_back(edge);
+            continue;
+        }
+        points.clear();
+        points.push_back(edge.bot);
+        size_t start = pos;
+        while (pos < splits.size() && splits[pos].first == ii) {
+            pos++;
+        }
+        if (edge.top.x < edge.bot.x) {
+            // Points at the same height must follow the direction of the edge
+            for(size_t jj = start; jj < pos; ) {
+                size_t kk = jj;
+                while (kk < pos && splits[kk].second.y == splits[jj].second.y) {
+                    kk++;
+                }
+                for(size_t ll = kk; ll > jj; ll--) {
+                    points.push_back(splits[ll-1].second);
+                }
+                jj = kk;
+            }
+        } else {
+            for(size_t jj = start; jj < pos; jj++) {
+                points.push_back(splits[jj].second);
+            }
+        }
+        points.push_back(edge.top);
+
+        size_t added = 0;
+        for(size_t jj = 0; jj+1 < points.size(); jj++) {
+            const GridPoint& a = points[jj];
+            const GridPoint& b = points[jj+1];
+            if (a.y == b.y) {
+                // Horizontal pieces do not affect the winding number
+                if (a.x != b.x) {
+                    Edge piece;
+                    piece.bot  = a.x < b.x ? a : b;
+                    piece.top  = a.x < b.x ? b : a;
+                    piece.wind = 0;
+                    piece.clip = edge.clip;
+                    _horizontals.push_back(piece);
+                    changed = true;
+                }
+                continue;
+            }
+            Edge piece;
+            piece.bot  = a;
+            piece.top  = b;
+            piece.wind = edge.wind;
+            piece.clip = edge.clip;
+            edges.push_back(piece);
+            added++;
+        }
+        if (added != 1) {
+            changed = true;
+        }
+    }
+    _edges.swap(edges);
+    return changed;
+}
+
+/**
+ * Computes the pieces of the result boundary.
+ *
+ * This method sweeps the scanlines at the vertices of the edges.  The
+ * edges do not cross between scanlines, so the active edges keep their
+ * order, and each one keeps the winding numbers of the region to its right.
+ * At a scanline, only the edges through a vertex are reordered, and only
+ * their winding numbers change.  Each edge is a piece of the result
+ * boundary from one vertex to the next if it separates an included region
+ * from an excluded one.  The horizontal pieces are the spans between two
+ * vertices on a scanline where the region just below is included and the
+ * region just above is not (or vice versa).
+ *
+ * @param op    The boolean operation
+ * @param rule  The fill rule for the subject and clip polygons
+ */
+void PolyClipper::computePieces(ClipOperation op, FillRule rule) {
+    _pieces.clear();
+    size_t ecount = _edges.size();
+    std::vector<size_t> starts(ecount);
+    std::vector<size_t> stops(ecount);
+    for(size_t ii = 0; ii < ecount; ii++) {
+        starts[ii] = ii;
+        stops[ii]  = ii;
+    }
+    std::sort(starts.begin(),starts.end(),[this](size_t a, size_t b) {
+        const GridPoint& p = _edges[a].bot;
+        const GridPoint& q = _edges[b].bot;
+        return p.y < q.y || (p.y == q.y && p.x < q.x);
+    });
+    std::sort(stops.begin(),stops.end(),[this](size_t a, size_t b) {
+        return _edges[a].top.y < _edges[b].top.y;
+    });
+
+    // The winding numbers to the right of each edge, and its open piece
+    std::vector<int> wsubj(ecount,0);
+    std::vector<int> wclip(ecount,0);
+    std::vector<GridPoint> anchor(ecount);
+    std::vector<int> sides(ecount,0);
+    auto included = [&](int subject, int clip) {
+        return is_included(op,is_filled(rule,subject),is_filled(rule,clip));
+    };
+    // Compares the directions of two edges leaving the same vertex
+    auto turn = [this](size_t a, size_t b) {
+        const Edge& ea = _edges[a];
+        const Edge& eb = _edges[b];
+        Sint64 p1 = (ea.top.x-ea.bot.x)*(eb.top.y-eb.bot.y);
+        Sint64 p2 = (ea.top.y-ea.bot.y)*(eb.top.x-eb.bot.x);
+        return p1 < p2 ? -1 : (p1 > p2 ? 1 : 0);
+    };
+    auto leftof = [&](size_t a, size_t b) {
+        int result = turn(a,b);
+        return result < 0 || (result == 0 && a < b);
+    };
+
+    std::vector<size_t> active;
+    std::vector<size_t> update;
+    std::vector<size_t> bundle;
+    std::vector<Sint64> xs;
+    std::vector<size_t> bounds;
+    std::vector<bool> inside;
+    size_t snext = 0;
+    size_t tnext = 0;
+    Piece piece;
+    while (snext < ecount || tnext < ecount) {
+        Sint64 y = snext < ecount ? _edges[starts[snext]].bot.y : _edges[stops[tnext]].top.y;
+        if (tnext < ecount) {
+            y = std::min(y,_edges[stops[tnext]].top.y);
+        }
+
+        // The vertices on this scanline
+        xs.clear();
+        size_t sfirst = snext;
+        while (snext < ecount && _edges[starts[snext]].bot.y == y) {
+            xs.push_back(_edges[starts[snext++]].bot.x);
+        }
+        while (tnext < ecount && _edges[stops[tnext]].top.y == y) {
+            xs.push_back(_edges[stops[tnext++]].top.x);
+        }
+        std::sort(xs.begin(),xs.end());
+        xs.erase(std::unique(xs.begin(),xs.end()),xs.end());
+
+        // Find the active edges through each vertex, and close their pieces
+        bounds.clear();
+        inside.clear();
+        for(auto it = xs.begin(); it != xs.end(); ++it) {
+            GridPoint p;
+            p.x = *it;
+            p.y = y;
+            auto lo = std::partition_point(active.begin(),active.end(),[&](size_t e) {
+                return orient(_edges[e].bot,_edges[e].top,p) < 0;
+            });
+            auto hi = std::partition_point(lo,active.end(),[&](size_t e) {
+                return orient(_edges[e].bot,_edges[e].top,p) == 0;
+            });
+            for(auto jt = lo; jt != hi; ++jt) {
+                if (sides[*jt]) {
+                    piece.from = sides[*jt] > 0 ? anchor[*jt] : p;
+                    piece.to   = sides[*jt] > 0 ? p : anchor[*jt];
+                    piece.edge = (int)*jt;
+                    _pieces.push_back(piece);
+                }
+            }
+            bounds.push_back(lo-active.begin());
+            bounds.push_back(hi-active.begin());
+            if (hi != lo) {
+                inside.push_back(included(wsubj[*(hi-1)],wclip[*(hi-1)]));
+            } else if (lo != active.begin()) {
+                inside.push_back(included(wsubj[*(lo-1)],wclip[*(lo-1)]));
+            } else {
+                inside.push_back(included(0,0));
+            }
+        }
+
+        // Replace the edges through each vertex with the edges above it
+        update.clear();
+        size_t fresh = sfirst;
+        size_t last = 0;
+        for(size_t ii = 0; ii < xs.size(); ii++) {
+            GridPoint p;
+            p.x = xs[ii];
+            p.y = y;
+            size_t lo = bounds[2*ii];
+            size_t hi = bounds[2*ii+1];
+            std::copy(active.begin()+last,active.begin()+lo,std::back_inserter(update));
+            last = hi;
+
+            bundle.clear();
+            for(size_t jj = lo; jj < hi; jj++) {
+                if (_edges[active[jj]].top.y > y) {
+                    bundle.push_back(active[jj]);
+                }
+            }
+            while (fresh < snext && _edges[starts[fresh]].bot.x == p.x) {
+                bundle.push_back(starts[fresh++]);
+            }
+            std::sort(bundle.begin(),bundle.end(),leftof);
+
+            // Colinear edges share a single piece
+            int subject = update.empty() ? 0 : wsubj[update.back()];
+            int clip = update.empty() ? 0 : wclip[update.back()];
+            bool left = included(subject,clip);
+            for(size_t jj = 0; jj < bundle.size(); jj++) {
+                size_t e = bundle[jj];
+                if (_edges[e].clip) {
+                    clip += _edges[e].wind;
+                } else {
+                    subject += _edges[e].wind;
+                }
+                wsubj[e] = subject;
+                wclip[e] = clip;
+                anchor[e] = p;
+                sides[e] = 0;
+                if (jj+1 == bundle.size() || turn(e,bundle[jj+1]) != 0) {
+                    bool right = included(subject,clip);
+                    sides[e] = left == right ? 0 : (left ? 1 : -1);
+                    left = right;
+                }
+                update.push_back(e);
+            }
+
+            // The region to the right changes across the scanline
+            if (left != inside[ii] && ii+1 < xs.size()) {
+                piece.from.y = y;
+                piece.to.y = y;
+                piece.from.x = left ? p.x : xs[ii+1];
+                piece.to.x = left ? xs[ii+1] : p.x;
+                piece.edge = -1;
+                _pieces.push_back(piece);
+            }
+        }
+        std::copy(active.begin()+last,active.end(),std::back_inserter(update));
+        active.swap(update);
+    }
+}
+
+/**
+ * Links the pieces of the result boundary into outlines.
+ *
+ * At a vertex shared by several outlines, the link turns as far left as
+ * possible.  Consecutive pieces of the same edge are merged, and colinear
+ * vertices are removed.
+ */
+void PolyClipper::computeLoops() {
+    _gridverts.clear();
+    _gridloops.clear();
+    size_t pcount = _pieces.size();
+    std::vector<size_t> order(pcount);
+    for(size_t ii = 0; ii < pcount; ii++) {
+        order[ii] = ii;
+    }
+    auto before = [this](size_t a, size_t b) {
+        const GridPoint& p = _pieces[a].from;
+        const GridPoint& q = _pieces[b].from;
+        return p.x < q.x || (p.x == q.x && p.y < q.y);
+    };
+    std::sort(order.begin(),order.end(),before);
+
+    std::vector<bool> used(pcount,false);
+    std::vector<size_t> loop;
+    std::vector<GridPoint> points;
+    for(size_t start = 0; start < pcount; start++) {
+        if (used[start]) {
+            continue;
+        }
+        loop.clear();
+        loop.push_back(start);
+        used[start] = true;
+        size_t curr = start;
+        while (true) {
+            const Piece& piece = _pieces[curr];
+            Sint64 rx = piece.from.x-piece.to.x;
+            Sint64 ry = piece.from.y-piece.to.y;
+
+            // Find the outgoing pieces at this vertex
+            size_t lo = 0;
+            size_t hi = pcount;
+            while (lo < hi) {
+                size_t mid = (lo+hi)/2;
+                const GridPoint& p = _pieces[order[mid]].from;
+                if (p.x < piece.to.x || (p.x == piece.to.x && p.y < piece.to.y)) {
+                    lo = mid+1;
+                } else {
+                    hi = mid;
+                }
+            }
+
+            // Take the sharpest turn (the start piece closes the loop)
+            size_t best = pcount;
+            double angle = 0;
+            for(size_t ii = lo; ii < pcount; ii++) {
+                const Piece& out = _pieces[order[ii]];
+                if (out.from.x != piece.to.x || out.from.y != piece.to.y) {
+                    break;
+                } else if (used[order[ii]] && order[ii] != start) {
+                    continue;
+                }
+                double turn = clockwise_angle(rx,ry,out.to.x-out.from.x,out.to.y-out.from.y);
+                if (best == pcount || turn < angle) {
+                    best = order[ii];
+                    angle = turn;
+                }
+            }
+            if (best == pcount || best == start) {
+                break;
+            }
+            used[best] = true;
+            loop.push_back(best);
+            curr = best;
+        }
+
+        // Merge the pieces of the same edge
+        points.clear();
+        for(size_t ii = 0; ii < loop.size(); ii++) {
+            const Piece& piece = _pieces[loop[ii]];
+            const Piece& prev  = _pieces[loop[ii == 0 ? loop.size()-1 : ii-1]];
+            if (piece.edge < 0 || piece.edge != prev.edge) {
+                points.push_back(piece.from);
+            }
+        }
+        simplify_loop(points);
+        if (points.size() >= 3 && loop_area(points.data(),points.size()) != 0) {
+            std::copy(points.begin(),points.end(),std::back_inserter(_gridverts));
+            _gridloops.push_back(points.size());
+        }
+    }
+}
+
+/**
+ * Sorts the result outlines into regions, and converts them to world space.
+ *
+ * Each hole is assigned to the smallest outer boundary containing it.
+ */
+void PolyClipper::computeRegions() {
+    _output.clear();
+    _outloops.clear();
+    _outgroups.clear();
+
+    size_t lcount = _gridloops.size();
+    std::vector<size_t> offsets(lcount,0);
+    std::vector<double> areas(lcount,0);
+    std::vector<Sint64> bounds(4*lcount,0);
+    std::vector<size_t> outers;
+    for(size_t ii = 0; ii < lcount; ii++) {
+        offsets[ii] = ii == 0 ? 0 : offsets[ii-1]+_gridloops[ii-1];
+        const GridPoint* points = _gridverts.data()+offsets[ii];
+        areas[ii] = loop_area(points,_gridloops[ii]);
+        Sint64* box = bounds.data()+4*ii;
+        box[0] = box[2] = points[0].x;
+        box[1] = box[3] = points[0].y;
+        for(size_t jj = 1; jj < _gridloops[ii]; jj++) {
+            box[0] = std::min(box[0],points[jj].x);
+            box[1] = std::min(box[1],points[jj].y);
+            box[2] = std::max(box[2],points[jj].x);
+            box[3] = std::max(box[3],points[jj].y);
+        }
+        if (areas[ii] > 0) {
+            outers.push_back(ii);
+        }
+    }
+
+    // Assign each hole to the smallest outer boundary containing it
+    std::vector<long> parent(lcount,-1);
+    for(size_t ii = 0; ii < lcount; ii++) {
+        if (areas[ii] > 0) {
+            continue;
+        }
+        const GridPoint* hole = _gridverts.data()+offsets[ii];
+        size_t size = _gridloops[ii];
+        double best = 0;
+        for(auto it = outers.begin(); it != outers.end(); ++it) {
+            const Sint64* box = bounds.data()+4*(*it);
+            const Sint64* ibox = bounds.data()+4*ii;
+            if (ibox[0] < box[0] || ibox[1] < box[1] || ibox[2] > box[2] || ibox[3] > box[3]) {
+                continue;
+            } else if (parent[ii] >= 0 && areas[*it] >= best) {
+                continue;
+            }
+
+            // Test the vertices, and then the midpoints, until one is not on the boundary
+            const GridPoint* outer = _gridverts.data()+offsets[*it];
+            int result = -1;
+            for(size_t jj = 0; result < 0 && jj < 2*size; jj++) {
+                const GridPoint& a = hole[(jj/2) % size];
+                const GridPoint& b = hole[(jj/2+(jj % 2)) % size];
+                result = classify_point(a.x+b.x,a.y+b.y,outer,_gridloops[*it]);
+            }
+            if (result != 0) {
+                parent[ii] = (long)*it;
+                best = areas[*it];
+            }
+        }
+    }
+
+    // Convert the regions to world space
+    float factor = 1.0f/_precision;
+    std::vector<size_t> children;
+    for(auto it = outers.begin(); it != outers.end(); ++it) {
+        children.clear();
+        children.push_back(*it);
+        for(size_t ii = 0; ii < lcount; ii++) {
+            if (parent[ii] == (long)*it) {
+                children.push_back(ii);
+            }
+        }
+        for(auto jt = children.begin(); jt != children.end(); ++jt) {
+            const GridPoint* points = _gridverts.data()+offsets[*jt];
+            for(size_t jj = 0; jj < _gridloops[*jt]; jj++) {
+                _output.push_back(Vec2(points[jj].x*factor,points[jj].y*factor));
+            }
+            _outloops.push_back(_gridloops[*jt]);
+        }
+        _outgroups.push_back(children.size());
+    }
+}
+
+/**
+ * Performs a boolean operation on the current edges.
+ *
+ * The result is stored in the grid buffers.
+ *
+ * @param op    The boolean operation
+ * @param rule  The fill rule for the subject and clip polygons
+ */
+void PolyClipper::solve(ClipOperation op, FillRule rule) {
+    for(int ii = 0; ii < SPLIT_PASSES && splitEdges(); ii++) { }
+    computePieces(op,rule);
+    computeLoops();
+}
+
+/**
+ * Appends the offset of the given outline to the buffer.
+ *
+ * The offset is not simplified, and may intersect itself.  However, the
+ * winding number of the result is positive exactly on the offset region.
+ *
+ * @param points    The vertices of the outline
+ * @param size      The number of vertices in the outline
+ * @param delta     The offset distance (in grid units)
+ * @param joint     The shape of the convex corners
+ * @param limit     The mitre limit
+ * @param buffer    The buffer to store the offset outline
+ *
+ * @return the number of vertices added to the buffer
+ */
+size_t PolyClipper::offsetLoop(const GridPoint* points, size_t size, double delta,
+                               PathJoint joint, double limit, std::vector<GridPoint>& buffer) {
+    if (size < 3) {
+        return 0;
+    }
+
+    // The outward normals (the interior is on the left)
+    std::vector<double> normals(2*size);
+    for(size_t ii = 0; ii < size; ii++) {
+        const GridPoint& a = points[ii];
+        const GridPoint& b = points[(ii+1) % size];
+        double dx = (double)(b.x-a.x);
+        double dy = (double)(b.y-a.y);
+        double len = sqrt(dx*dx+dy*dy);
+        normals[2*ii  ] =  dy/len;
+        normals[2*ii+1] = -dx/len;
+    }
+
+    size_t start = buffer.size();
+    auto append = [&](double x, double y) {
+        GridPoint p;
+        p.x = snap_value(x);
+        p.y = snap_value(y);
+        buffer.push_back(p);
+    };
+
+    double radius = std::abs(delta);
+    for(size_t ii = 0; ii < size; ii++) {
+        size_t prev = ii == 0 ? size-1 : ii-1;
+        double px = (double)points[ii].x;
+        double py = (double)points[ii].y;
+        double n1x = normals[2*prev], n1y = normals[2*prev+1];
+        double n2x = normals[2*ii  ], n2y = normals[2*ii+1];
+        double sinA = n1x*n2y-n1y*n2x;
+        double cosA = n1x*n2x+n1y*n2y;
+
+        if (cosA > 0 && std::abs(sinA)*radius < 0.5) {
+            // Nearly straight
+            append(px+n1x*delta,py+n1y*delta);
+        } else if (sinA*delta < 0) {
+            // Concave corner; the winding number removes the overlap
+            append(px+n1x*delta,py+n1y*delta);
+            append(px,py);
+            append(px+n2x*delta,py+n2y*delta);
+        } else {
+            switch (joint) {
+                case PathJoint::MITRE:
+                    if (limit > 0 && 1+cosA >= 2/(limit*limit)) {
+                        double scale = delta/(1+cosA);
+                        append(px+(n1x+n2x)*scale,py+(n1y+n2y)*scale);
+                    } else {
+                        append(px+n1x*delta,py+n1y*delta);
+                        append(px+n2x*delta,py+n2y*delta);
+                    }
+                    break;
+                case PathJoint::ROUND:
+                {
+                    double tolerance = std::max(radius*ARC_TOLERANCE,ARC_MINIMUM);
+                    double step = tolerance >= radius ? M_PI : 2*acos(1-tolerance/radius);
+                    double theta = atan2(sinA,cosA);
+                    int steps = std::max(1,(int)ceil(std::abs(theta)/step));
+                    double c = cos(theta/steps);
+                    double s = sin(theta/steps);
+                    double vx = n1x*delta;
+                    double vy = n1y*delta;
+                    append(px+vx,py+vy);
+                    for(int jj = 0; jj < steps; jj++) {
+                        double tx = vx*c-vy*s;
+                        vy = vx*s+vy*c;
+                        vx = tx;
+                        append(px+vx,py+vy);
+                    }
+                }
+                    break;
+                case PathJoint::BEVEL:
+                case PathJoint::NONE:
+                    append(px+n1x*delta,py+n1y*delta);
+                    append(px+n2x*delta,py+n2y*delta);
+                    break;
+            }
+        }
+    }
+    return buffer.size()-start;
+}
@@ -37,6 +37,7 @@
 
 #include <cugl/math/polygon/CUSimpleTriangulator.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUThreadPool.h>
 #include <iterator>
 
 /** Computes the previous index in a vector, treating it as a circular queue */
@@ -59,12 +60,12 @@ void SimpleTriangulator::calculate() {
     _naive.resize(vcount,0);
     
     if (areVerticesClockwise(_input)) {
-        for (short i = 0; i < vcount; i++) {
+        for (int i = 0; i < vcount; i++) {
             _naive[i] = i;
         }
     } else {
         for (int i = 0, n = vcount - 1; i < vcount; i++) {
-            _naive[i] = (short)(n - i); // Reversed.
+            _naive[i] = (Uint32)(n - i); // Reversed.
         }
     }
     
@@ -204,7 +205,7 @@ bool SimpleTriangulator::isEarTip(int earTipIndex) {
  * @return a candidate ear-tip triangle
  */
 int SimpleTriangulator::findEarTip() {
-    for (int ii = 0; ii < _naive.size(); ii++) {
+    for (int ii = 0; ii < (int)_naive.size(); ii++) {
         if (isEarTip(ii)) {
             return ii;
         }
@@ -218,7 +219,7 @@ int SimpleTriangulator::findEarTip() {
     // Algorithmica (1998), http://citeseerx.ist.psu.edu/viewdoc/summary?doi=10.1.1.115.291
     
     // Return a convex or tangential vertex if one exists.
-    for (int ii = 0; ii < _naive.size(); ii++) {
+    for (int ii = 0; ii < (int)_naive.size(); ii++) {
         if (_types[ii] != VertexType::CONCAVE) {
             return ii;
         }
@@ -261,7 +262,7 @@ void SimpleTriangulator::computeTriangulation() {
         
         // The type of the two vertices adjacent to the clipped vertex may have changed.
         int prevIndex = PREV(earTipIndex, _naive);
-        int nextIndex = earTipIndex == _naive.size() ? 0 : earTipIndex;
+        int nextIndex = earTipIndex == (int)_naive.size() ? 0 : earTipIndex;
         _types[prevIndex] = classifyVertex(prevIndex);
         _types[nextIndex] = classifyVertex(nextIndex);
     }
@@ -286,7 +287,7 @@ void SimpleTriangulator::computeTriangulation() {
  */
 void SimpleTriangulator::trimColinear() {
     int colinear = 0;
-    for(int ii = 0; ii < _naive.size()/3-colinear; ii++) {
+    for(int ii = 0; ii < (int)_naive.size()/3-colinear; ii++) {
         float t1 = _input[_naive[3*ii  ]].x*(_input[_naive[3*ii+1]].y-_input[_naive[3*ii+2]].y);
         float t2 = _input[_naive[3*ii+1]].x*(_input[_naive[3*ii+2]].y-_input[_naive[3*ii  ]].y);
         float t3 = _input[_naive[3*ii+2]].x*(_input[_naive[3*ii  ]].y-_input[_naive[3*ii+1]].y);
@@ -303,6 +304,34 @@ void SimpleTriangulator::trimColinear() {
     }
 }
 
+#pragma mark -
+#pragma mark Batch Calculation
+/**
+ * Triangulates a batch of polygons, storing the results in outputs.
+ *
+ * Each polygon in inputs is triangulated using only its vertex data, and
+ * the result is stored at the same position in outputs.  The outputs are
+ * resized to match the inputs, but any existing polygons are reused.
+ *
+ * The batch is divided among the threads of the pool (see {@link
+ * ThreadPool#parallelBatch}), with each chunk using its own triangulator.
+ * This method blocks until the batch is complete.
+ *
+ * @param pool      The thread pool to perform the batch (may be nullptr)
+ * @param inputs    The polygons to triangulate
+ * @param outputs   The buffer to store the triangulated polygons
+ */
+void SimpleTriangulator::triangulate(const std::shared_ptr<ThreadPool>& pool,
+                                     const std::vector<Poly2>& inputs, std::vector<Poly2>& outputs) {
+    outputs.resize(inputs.size());
+    ThreadPool::parallelBatch<SimpleTriangulator>(pool, inputs.size(), [&](SimpleTriangulator& factory, size_t ii) {
+        factory.set(inputs[ii]);
+        factory.calculate();
+        outputs[ii].clear();
+        factory.getPolygon(&outputs[ii]);
+    });
+}
+
 #pragma mark -
 #pragma mark Materialization
 /**
@@ -314,6 +343,9 @@ void SimpleTriangulator::trimColinear() {
  * The triangulator does not retain a reference to the returned list; it
  * is safe to modify it.
  *
+ * The list uses 16 bit indices, so the number of vertices may not exceed
+ * 65536.  Use the buffer version of this method for larger meshes.
+ *
  * If the calculation is not yet performed, this method will return the
  * empty list.
  *
@@ -323,9 +355,7 @@ void SimpleTriangulator::trimColinear() {
  */
 std::vector<unsigned short> SimpleTriangulator::getTriangulation() {
     std::vector<unsigned short> result;
-    if (_calculated) {
-        result.assign(_output.begin(), _output.end());
-    }
+    getTriangulation(result);
     return result;
 }
 
@@ -342,7 +372,7 @@ std::vector<unsigned short> SimpleTriangulator::getTriangulation() {
  *
  * @return the number of elements added to the buffer
  */
-size_t SimpleTriangulator::getTriangulation(std::vector<unsigned short>& buffer) {
+size_t SimpleTriangulator::getTriangulation(std::vector<Uint32>& buffer) {
     if (_calculated) {
         buffer.reserve(buffer.size()+_output.size());
         std::copy(_output.begin(), _output.end(),std::back_inserter(buffer));
@@ -351,6 +381,32 @@ size_t SimpleTriangulator::getTriangulation(std::vector<unsigned short>& buffer)
     return 0;
 }
 
+/**
+ * Stores the triangulation indices in the given 16-bit buffer.
+ *
+ * This version is for meshes that are known to be small, and which should
+ * be stored compactly (e.g. for upload to a 16-bit index buffer).  The
+ * number of vertices may not exceed 65536.
+ *
+ * The indices will be appended to the provided vector. You should clear
+ * the vector first if you do not want to preserve the original data.
+ *
+ * If the calculation is not yet performed, this method will do nothing.
+ *
+ * @return the number of elements added to the buffer
+ */
+size_t SimpleTriangulator::getTriangulation(std::vector<unsigned short>& buffer) {
+    if (_calculated) {
+        CUAssertLog(_input.size() <= 65536, "Vertex count %d exceeds the index range", (int)_input.size());
+        buffer.reserve(buffer.size()+_output.size());
+        for(auto it = _output.begin(); it != _output.end(); ++it) {
+            buffer.push_back((unsigned short)*it);
+        }
+        return _output.size();
+    }
+    return 0;
+}
+
 /**
  * Returns a polygon representing the triangulation.
  *
@@ -367,7 +423,7 @@ Poly2 SimpleTriangulator::getPolygon() {
     Poly2 poly;
     if (_calculated) {
         poly._vertices = _input;
-        poly._indices  = _output;
+        poly.appendIndices(_output.data(), _output.size());
         poly._type = Poly2::Type::SOLID;
         poly.computeBounds();
     }
@@ -393,16 +449,14 @@ Poly2* SimpleTriangulator::getPolygon(Poly2* buffer) {
     if (_calculated) {
         if (buffer->_vertices.size() == 0) {
             buffer->_vertices = _input;
-            buffer->_indices  = _output;
+            buffer->resetIndices();
+            buffer->appendIndices(_output.data(), _output.size());
         } else {
             int offset = (int)buffer->_vertices.size();
             buffer->_vertices.reserve(offset+_input.size());
             std::copy(_input.begin(),_input.end(),std::back_inserter(buffer->_vertices));
             
-            buffer->_indices.reserve(buffer->_indices.size()+_output.size());
-            for(auto it = _output.begin(); it != _output.end(); ++it) {
-                buffer->_indices.push_back(offset+*it);
-            }
+            buffer->appendIndices(_output.data(), _output.size(), (Uint32)offset);
         }
         buffer->_type = Poly2::Type::SOLID;
         buffer->computeBounds();
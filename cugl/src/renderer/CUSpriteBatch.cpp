@@ -764,6 +764,40 @@ void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int
     }
 }
 
+/**
+ * Fills the triangulated vertices with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other fill methods.  The texture no longer needs to be
+ * drawn uniformly over the shape.
+ *
+ * The triangulation will be determined by the given indices. If necessary,
+ * these can be generated via one of the triangulation factories
+ * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                       const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                       const Mat4& transform, bool tint) {
+    setCommand(GL_TRIANGLES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,true,tint);
+    
+    for(unsigned int ii = 1; ii <= count; ii++) {
+        _vertData[_vertSize-ii].position *= transform;
+    }
+}
+
 /**
  * Fills the triangulated vertices with the current texture.
  *
@@ -799,6 +833,41 @@ void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int
     }
 }
 
+/**
+ * Fills the triangulated vertices with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other fill methods.  The texture no longer needs to be
+ * drawn uniformly over the shape. The transform will be applied to the
+ * vertex positions directly in world space.
+ *
+ * The triangulation will be determined by the given indices. If necessary,
+ * these can be generated via one of the triangulation factories
+ * {@link SimpleTriangulator} or {@link ComplexTriangulator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::fill(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                       const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                       const Affine2& transform, bool tint) {
+    setCommand(GL_TRIANGLES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,true,tint);
+    
+    for(unsigned int ii = 1; ii <= count; ii++) {
+        _vertData[_vertSize-ii].position *= transform;
+    }
+}
+
 #pragma mark -
 #pragma mark Outlines
 /**
@@ -1153,6 +1222,41 @@ void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned
     }
 }
 
+/**
+ * Outlines the vertex path with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other outline methods.  The texture no longer needs to be
+ * drawn uniformly over the wireframe. The transform will be applied to the
+ * vertex positions directly in world space.
+ *
+ * The vertex path will be determined by the provided indices. The indices
+ * should be a multiple of two, preferably generated by the factories
+ * {@link PathOutliner} or {@link CubicSplineApproximator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                          const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                          const Mat4& transform, bool tint) {
+    setCommand(GL_LINES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,false,tint);
+    
+    for(unsigned int ii = 1; ii <= count; ii++) {
+        _vertData[_vertSize-ii].position *= transform;
+    }
+}
+
 /**
  * Outlines the vertex path with the current texture.
  *
@@ -1188,6 +1292,41 @@ void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned
     }
 }
 
+/**
+ * Outlines the vertex path with the current texture.
+ *
+ * This method provides more fine tuned control over texture coordinates
+ * that the other outline methods.  The texture no longer needs to be
+ * drawn uniformly over the wireframe. The transform will be applied to the
+ * vertex positions directly in world space.
+ *
+ * The vertex path will be determined by the provided indices. The indices
+ * should be a multiple of two, preferably generated by the factories
+ * {@link PathOutliner} or {@link CubicSplineApproximator}.
+ *
+ * The vertices use their own color values.  However, if tint is true, these
+ * values will be tinted (i.e. multiplied) by the current active color.
+ *
+ * @param vertices  The array of vertices
+ * @param vsize     The size of the vertex array
+ * @param voffset   The first element of the vertex array
+ * @param indices   The triangulation array
+ * @param isize     The size of the index array
+ * @param ioffset   The first element of the index array
+ * @param transform The coordinate transform
+ * @param tint      Whether to tint with the active color
+ */
+void SpriteBatch::outline(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                          const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                          const Affine2& transform, bool tint) {
+    setCommand(GL_LINES);
+    unsigned int count = prepare(vertices,vsize,voffset,indices,isize,ioffset,false,tint);
+    
+    for(unsigned int ii = 1; ii <= count; ii++) {
+        _vertData[_vertSize-ii].position *= transform;
+    }
+}
+
 #pragma mark -
 #pragma mark Convenience Methods
 /**
@@ -1384,6 +1523,35 @@ bool SpriteBatch::validateBuffer(GLuint buffer, const char* message) {
     return true;
 }
 
+/**
+ * Reserves room in the drawing buffer for a mesh of the given size.
+ *
+ * If the mesh does not fit in the remaining space, the buffer is flushed.
+ * If the mesh is larger than the entire buffer, the buffer is grown to
+ * fit it.  Hence a single mesh may exceed the capacity of this sprite
+ * batch (the capacity is only the size at which the batch is flushed).
+ *
+ * @param vsize     The number of vertices to add
+ * @param isize     The number of indices to add
+ */
+void SpriteBatch::reserve(unsigned int vsize, unsigned int isize) {
+    if (_vertSize+vsize > _vertMax || _indxSize+isize > _indxMax) {
+        flush();
+    }
+    
+    // The buffer is empty now, so there is nothing to copy
+    if (vsize > _vertMax) {
+        delete[] _vertData;
+        _vertMax  = vsize;
+        _vertData = new Vertex2[_vertMax];
+    }
+    if (isize > _indxMax) {
+        delete[] _indxData;
+        _indxMax  = isize;
+        _indxData = new GLuint[_indxMax];
+    }
+}
+
 /**
  * Returns the number of vertices added to the drawing buffer.
  *
@@ -1396,9 +1564,7 @@ bool SpriteBatch::validateBuffer(GLuint buffer, const char* message) {
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::prepare(const Rect& rect, bool solid) {
-    if (_vertSize+4 > _vertMax ||  _indxSize+8 > _indxMax) {
-        flush();
-    }
+    reserve(4,8);
     
     Poly2 poly(rect, solid);
     unsigned int vstart = _vertSize;
@@ -1439,12 +1605,9 @@ unsigned int SpriteBatch::prepare(const Rect& rect, bool solid) {
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::prepare(const Poly2& poly, bool solid) {
-    CUAssertLog((solid ? poly.getIndices().size() % 3 : poly.getIndices().size() % 2) == 0,
-                "Polynomial has the wrong number of indices: %d", (int)poly.getIndices().size());
-    if (_vertSize+poly.getVertices().size() > _vertMax ||
-        _indxSize+poly.getIndices().size()  > _indxMax) {
-        flush();
-    }
+    CUAssertLog((solid ? poly.getIndexCount() % 3 : poly.getIndexCount() % 2) == 0,
+                "Polynomial has the wrong number of indices: %d", (int)poly.getIndexCount());
+    reserve((unsigned int)poly.getVertices().size(),(unsigned int)poly.getIndexCount());
     
     unsigned int vstart = _vertSize;
     int ii = 0;
@@ -1462,9 +1625,16 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, bool solid) {
     
     int jj = 0;
     unsigned int istart = _indxSize;
-    for(auto it = poly.getIndices().begin(); it != poly.getIndices().end(); ++it) {
-        _indxData[istart+jj] = vstart+(*it);
-        jj++;
+    if (poly.isWide()) {
+        for(auto it = poly.getWideIndices().begin(); it != poly.getWideIndices().end(); ++it) {
+            _indxData[istart+jj] = vstart+(*it);
+            jj++;
+        }
+    } else {
+        for(auto it = poly.getIndices().begin(); it != poly.getIndices().end(); ++it) {
+            _indxData[istart+jj] = vstart+(*it);
+            jj++;
+        }
     }
     
     _vertSize += ii;
@@ -1494,9 +1664,7 @@ unsigned int SpriteBatch::prepare(const Vertex2* vertices, unsigned int vsize, u
                                   bool solid, bool tint) {
     CUAssertLog((solid ? isize % 3 : isize % 2) == 0,
                 "Vertex mesh has the wrong number of indices: %d", isize);
-    if (_vertSize+vsize > _vertMax || _indxSize+isize  > _indxMax) {
-        flush();
-    }
+    reserve(vsize,isize);
     
     int ii = 0;
     unsigned int vstart = _vertSize;
@@ -1519,6 +1687,51 @@ unsigned int SpriteBatch::prepare(const Vertex2* vertices, unsigned int vsize, u
     return ii;
 }
 
+/**
+ * Returns the number of vertices added to the drawing buffer.
+ *
+ * This method adds the given vertices and indices to the drawing buffer,
+ * but does not draw them.  You must call flush() to draw the mesh.
+ *
+ * @param vertices  The vertices to add to the buffer
+ * @param vsize     The number of vertices to add
+ * @param voffset   The position of the first vertex to add
+ * @param indices   The indices to add to the buffer
+ * @param isize     The number of indices to add
+ * @param ioffset   The position of the first index to add
+ * @param solid     Whether the vertex mesh is to be filled
+ * @param tint      Whether to tint with the active color
+ *
+ * @return the number of vertices added to the drawing buffer.
+ */
+unsigned int SpriteBatch::prepare(const Vertex2* vertices, unsigned int vsize, unsigned int voffset,
+                                  const Uint32* indices, unsigned int isize, unsigned int ioffset,
+                                  bool solid, bool tint) {
+    CUAssertLog((solid ? isize % 3 : isize % 2) == 0,
+                "Vertex mesh has the wrong number of indices: %d", isize);
+    reserve(vsize,isize);
+    
+    unsigned int ii = 0;
+    unsigned int vstart = _vertSize;
+    Vertex2 temp;
+    for(unsigned int kk = voffset; ii < vsize; ii++) {
+        _vertData[vstart+ii] = vertices[kk+ii];
+        if (tint) {
+            _vertData[vstart+ii].color *= _color;
+        }
+    }
+    
+    unsigned int jj = 0;
+    unsigned int istart = _indxSize;
+    for(unsigned int kk = ioffset; jj < isize; jj++) {
+        _indxData[istart+jj] = vstart+indices[kk+jj];
+    }
+    
+    _vertSize += ii;
+    _indxSize += jj;
+    return ii;
+}
+
 
 
 
@@ -33,6 +33,8 @@
 //  Version: 11/29/16
 //
 #include <cugl/util/CUThreadPool.h>
+#include <algorithm>
+#include <atomic>
 
 using namespace cugl;
 
@@ -160,6 +162,79 @@ void ThreadPool::addTask(const std::function<void()> &task){
     _taskCondition.notify_one();
 }
 
+/**
+ * Executes the given function over a range in parallel, blocking until done.
+ *
+ * The range [0,count) is split into chunks of grain elements, and the
+ * function is called once per chunk with the bounds [begin,end) of that
+ * chunk.  The chunks are shared between the worker threads and the calling
+ * thread, so this method makes progress even if all of the workers are
+ * busy with other tasks (e.g. asset loading).  It is also safe to call
+ * this method from within a task of this pool.
+ *
+ * This method returns only when every chunk has been processed. The
+ * function must be safe to call concurrently on disjoint ranges.  If the
+ * pool is stopped, or there is only one chunk, the function is executed
+ * on the calling thread.
+ *
+ * @param count The number of elements to process
+ * @param grain The maximum number of elements in a chunk
+ * @param body  The function to call on each chunk
+ */
+void ThreadPool::parallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max(grain,(size_t)1);
+    size_t chunks = (count+grain-1)/grain;
+    if (chunks == 1 || _stop || _workers.empty()) {
+        body(0,count);
+        return;
+    }
+    
+    // Shared state, as queued tasks may outlive this call
+    struct Batch {
+        std::function<void(size_t, size_t)> body;
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t count;
+        size_t grain;
+        size_t chunks;
+    };
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->body   = body;
+    batch->next   = 0;
+    batch->done   = 0;
+    batch->count  = count;
+    batch->grain  = grain;
+    batch->chunks = chunks;
+    
+    std::function<void()> work = [batch]() {
+        size_t chunk;
+        while ((chunk = batch->next.fetch_add(1)) < batch->chunks) {
+            size_t begin = chunk*batch->grain;
+            size_t end = std::min(begin+batch->grain,batch->count);
+            batch->body(begin,end);
+            if (batch->done.fetch_add(1)+1 == batch->chunks) {
+                std::unique_lock<std::mutex> lk(batch->mutex);
+                batch->finished.notify_all();
+            }
+        }
+    };
+    
+    size_t helpers = std::min(chunks-1,_workers.size());
+    for(size_t ii = 0; ii < helpers; ii++) {
+        addTask(work);
+    }
+    work();
+    
+    std::unique_lock<std::mutex> lk(batch->mutex);
+    batch->finished.wait(lk, [&batch] { return batch->done.load() == batch->chunks; });
+}
+
 /**
  * Stop the thread pool, marking it for shut down.
  *